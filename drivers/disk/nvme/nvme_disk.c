@@ -182,6 +182,16 @@ static int nvme_disk_ioctl(struct disk_info *disk, uint8_t cmd, void *buff)
 
 		*(uint32_t *)buff = nvme_namespace_get_sector_size(ns);
 
+		break;
+	case DISK_IOCTL_GET_MAX_XFER_SECTORS:
+		if (!buff) {
+			ret = -EINVAL;
+			break;
+		}
+
+		*(uint32_t *)buff = ns->ctrlr->max_xfer_size /
+			nvme_namespace_get_sector_size(ns);
+
 		break;
 	case DISK_IOCTL_CTRL_SYNC:
 		ret = nvme_disk_flush(ns);
@@ -194,12 +204,83 @@ static int nvme_disk_ioctl(struct disk_info *disk, uint8_t cmd, void *buff)
 	return ret;
 }
 
+#if defined(CONFIG_DISK_ACCESS_RTIO)
+static void nvme_disk_submit_cb(void *arg, const struct nvme_completion *cpl)
+{
+	struct disk_request *req = arg;
+	int ret = 0;
+
+	if (cpl == NULL) {
+		ret = -ETIMEDOUT;
+	} else if (nvme_completion_is_error(cpl)) {
+		nvme_completion_print(cpl);
+		ret = -EIO;
+	}
+
+	req->done(req, ret);
+}
+
+static int nvme_disk_submit(struct disk_info *disk, struct disk_request *req)
+{
+	struct nvme_namespace *ns = CONTAINER_OF(disk->name,
+						 struct nvme_namespace, name[0]);
+	struct nvme_request *request;
+	int ret;
+
+	if ((req->op != DISK_REQUEST_SYNC) &&
+	    !NVME_IS_BUFFER_DWORD_ALIGNED(req->buf)) {
+		LOG_WRN("Data buffer pointer needs to be 4-bytes aligned");
+		return -EINVAL;
+	}
+
+	nvme_lock(disk->dev);
+
+	if (req->op == DISK_REQUEST_SYNC) {
+		request = nvme_allocate_request_null(nvme_disk_submit_cb, req);
+	} else {
+		request = nvme_allocate_request_vaddr(
+			req->buf, req->num_sector * nvme_namespace_get_sector_size(ns),
+			nvme_disk_submit_cb, req);
+	}
+
+	if (request == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	switch (req->op) {
+	case DISK_REQUEST_READ:
+		nvme_namespace_read_cmd(&request->cmd, ns->id,
+					req->start_sector, req->num_sector);
+		break;
+	case DISK_REQUEST_WRITE:
+		nvme_namespace_write_cmd(&request->cmd, ns->id,
+					 req->start_sector, req->num_sector);
+		break;
+	default:
+		nvme_namespace_flush_cmd(&request->cmd, ns->id);
+		break;
+	}
+
+	/* The completion callback runs from the queue interrupt, without
+	 * the lock, so that several requests are in progress at once.
+	 */
+	ret = nvme_cmd_qpair_submit_request(ns->ctrlr->ioq, request);
+out:
+	nvme_unlock(disk->dev);
+	return ret;
+}
+#endif
+
 static const struct disk_operations nvme_disk_ops = {
 	.init = nvme_disk_init,
 	.status = nvme_disk_status,
 	.read = nvme_disk_read,
 	.write = nvme_disk_write,
 	.ioctl = nvme_disk_ioctl,
+#if defined(CONFIG_DISK_ACCESS_RTIO)
+	.submit = nvme_disk_submit,
+#endif
 };
 
 int nvme_namespace_disk_setup(struct nvme_namespace *ns,
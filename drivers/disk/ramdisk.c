@@ -105,6 +105,32 @@ static int disk_ram_access_ioctl(struct disk_info *disk, uint8_t cmd, void *buff
 	return 0;
 }
 
+#if defined(CONFIG_DISK_ACCESS_RTIO)
+/* Copying is as fast as it gets, requests complete right away */
+static int disk_ram_access_submit(struct disk_info *disk, struct disk_request *req)
+{
+	int rc;
+
+	switch (req->op) {
+	case DISK_REQUEST_READ:
+		rc = disk_ram_access_read(disk, req->buf, req->start_sector, req->num_sector);
+		break;
+	case DISK_REQUEST_WRITE:
+		rc = disk_ram_access_write(disk, req->buf, req->start_sector, req->num_sector);
+		break;
+	case DISK_REQUEST_SYNC:
+		rc = 0;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	req->done(req, rc);
+
+	return 0;
+}
+#endif
+
 static int disk_ram_init(const struct device *dev)
 {
 	struct disk_info *info = dev->data;
@@ -120,6 +146,9 @@ static const struct disk_operations ram_disk_ops = {
 	.read = disk_ram_access_read,
 	.write = disk_ram_access_write,
 	.ioctl = disk_ram_access_ioctl,
+#if defined(CONFIG_DISK_ACCESS_RTIO)
+	.submit = disk_ram_access_submit,
+#endif
 };
 
 #define DT_DRV_COMPAT zephyr_ram_disk
@@ -45,6 +45,9 @@ enum json_tokens {
 	JSON_TOK_FLOAT = '1',
 	JSON_TOK_OPAQUE = '2',
 	JSON_TOK_OBJ_ARRAY = '3',
+	/* float and double values, only for encoding */
+	JSON_TOK_FLOAT_FP = 'F',
+	JSON_TOK_DOUBLE_FP = 'D',
 	JSON_TOK_TRUE = 't',
 	JSON_TOK_FALSE = 'f',
 	JSON_TOK_NULL = 'n',
@@ -91,9 +94,9 @@ struct json_obj_descr {
 
 	/* Valid values here (enum json_tokens): JSON_TOK_STRING,
 	 * JSON_TOK_NUMBER, JSON_TOK_TRUE, JSON_TOK_FALSE,
-	 * JSON_TOK_OBJECT_START, JSON_TOK_ARRAY_START.  (All others
-	 * ignored.) Maximum value is '}' (125), so this has to be 7 bits
-	 * long.
+	 * JSON_TOK_OBJECT_START, JSON_TOK_ARRAY_START, JSON_TOK_FLOAT_FP,
+	 * JSON_TOK_DOUBLE_FP.  (All others ignored.) Maximum value is '}'
+	 * (125), so this has to be 7 bits long.
 	 */
 	uint32_t type : 7;
 
@@ -127,6 +130,59 @@ struct json_obj_descr {
 typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
 				   void *data);
 
+#if defined(CONFIG_JSON_LIBRARY)
+
+struct json_obj_stream_frame {
+	/* Object: field descriptors. Array: element descriptor */
+	const struct json_obj_descr *descr;
+	/* Object: number of fields. Array: maximum number of elements */
+	size_t descr_len;
+	/* Object: struct holding the fields. Array: struct holding the
+	 * element count, or NULL for the elements of an array of arrays.
+	 */
+	void *val;
+	union {
+		struct {
+			int64_t decoded;
+			int8_t field;
+			uint8_t next;
+		} obj;
+		struct {
+			void *field;
+			size_t *elements;
+			size_t elem_size;
+		} arr;
+	};
+	uint8_t state;
+};
+
+/**
+ * @brief State of a streaming object parser
+ *
+ * See json_obj_stream_parse_init(). The fields are private to the parser.
+ */
+struct json_obj_stream {
+	const struct json_obj_descr *descr;
+	size_t descr_len;
+	void *val;
+	char *buf;
+	size_t buf_size;
+	size_t buf_used;
+	size_t tok_start;
+	struct json_obj_token *capture;
+	const char *literal;
+	int64_t result;
+	uint16_t skip;
+	uint8_t depth;
+	uint8_t lex;
+	uint8_t lex_count;
+	uint8_t literal_type;
+	bool overflow;
+	struct json_obj_stream_frame frames[CONFIG_JSON_LIBRARY_STREAM_MAX_DEPTH];
+};
+
+#endif /* CONFIG_JSON_LIBRARY */
+
 #define Z_ALIGN_SHIFT(type)	(__alignof__(type) == 1 ? 0 : \
 				 __alignof__(type) == 2 ? 1 : \
 				 __alignof__(type) == 4 ? 2 : 3)
@@ -140,6 +196,8 @@ typedef int (*json_append_bytes_t)(const char *bytes, size_t len,
  * @param type_ Token type for JSON value corresponding to a primitive
  * type. Must be one of: JSON_TOK_STRING for strings, JSON_TOK_NUMBER
  * for numbers, JSON_TOK_TRUE (or JSON_TOK_FALSE) for booleans.
+ * JSON_TOK_FLOAT_FP and JSON_TOK_DOUBLE_FP encode float and double
+ * fields, see @kconfig{CONFIG_JSON_LIBRARY_FP_SUPPORT}.
  *
  * Here's an example of use:
  *
@@ -689,6 +747,50 @@ int json_arr_separate_object_parse_init(struct json_obj *json, char *payload, si
 int json_arr_separate_parse_object(struct json_obj *json, const struct json_obj_descr *descr,
 				   size_t descr_len, void *val);
 
+#if defined(CONFIG_JSON_LIBRARY)
+
+/**
+ * @brief Initialize the streaming parse of an object
+ *
+ * The object is then given to json_obj_stream_parse() in pieces of any size,
+ * as they are received, and decoded according to @a descr as
+ * json_obj_parse() would.
+ *
+ * The input is not kept, so strings, opaque values, floats and raw arrays
+ * are copied to @a buf and the decoded fields point there. Keys and numbers
+ * are also assembled in @a buf while they are parsed, so it must be large
+ * enough for the longest of them in addition to the decoded values.
+ *
+ * @param stream Parser state
+ * @param descr Pointer to the descriptor array
+ * @param descr_len Number of elements in the descriptor array. Must be less
+ * than 63.
+ * @param val Pointer to the struct to hold the decoded values
+ * @param buf Buffer holding the decoded strings
+ * @param buf_size Size of @a buf
+ */
+void json_obj_stream_parse_init(struct json_obj_stream *stream,
+				const struct json_obj_descr *descr, size_t descr_len,
+				void *val, char *buf, size_t buf_size);
+
+/**
+ * @brief Parse the next piece of an object
+ *
+ * Once the object has been parsed or an error has been found, the rest of
+ * the input is ignored and the same value is returned again.
+ *
+ * @param stream Parser state, initialized with json_obj_stream_parse_init()
+ * @param data Next bytes of the JSON-encoded object
+ * @param len Number of bytes in @a data
+ *
+ * @return -EAGAIN if the object is not complete yet, bitmap of decoded
+ * fields once it is (as returned by json_obj_parse()), -ENOMEM if @a buf or
+ * the nesting depth was too small, or another negative error code.
+ */
+int64_t json_obj_stream_parse(struct json_obj_stream *stream, const char *data, size_t len);
+
+#endif /* CONFIG_JSON_LIBRARY */
+
 /**
  * @brief Escapes the string so it can be used to encode JSON objects
  *
@@ -801,6 +903,48 @@ int json_obj_encode(const struct json_obj_descr *descr, size_t descr_len,
 int json_arr_encode(const struct json_obj_descr *descr, const void *val,
 		    json_append_bytes_t append_bytes, void *data);
 
+/**
+ * @brief Encodes an object, passing the output on in blocks
+ *
+ * The output is gathered in @a buf and given to @a flush each time the
+ * buffer is full, then once more with the rest. @a flush can send it to a
+ * socket, add it to a net_buf chain or write it to a file, without
+ * handling every small fragment or holding the whole document.
+ *
+ * @param descr Pointer to the descriptor array
+ * @param descr_len Number of elements in the descriptor array
+ * @param val Struct holding the values
+ * @param flush Function consuming a block of output
+ * @param data Data pointer to be passed to the flush callback function.
+ * @param buf Buffer gathering the output
+ * @param buf_size Size of @a buf, in bytes
+ *
+ * @return 0 if object has been successfully encoded. A negative value
+ * indicates an error, including one returned by @a flush.
+ */
+int json_obj_encode_buffered(const struct json_obj_descr *descr, size_t descr_len,
+			     const void *val, json_append_bytes_t flush,
+			     void *data, char *buf, size_t buf_size);
+
+/**
+ * @brief Encodes an array, passing the output on in blocks
+ *
+ * @param descr Pointer to the descriptor array
+ * @param val Struct holding the values
+ * @param flush Function consuming a block of output
+ * @param data Data pointer to be passed to the flush callback function.
+ * @param buf Buffer gathering the output
+ * @param buf_size Size of @a buf, in bytes
+ *
+ * @return 0 if array has been successfully encoded. A negative value
+ * indicates an error, including one returned by @a flush.
+ *
+ * @see json_obj_encode_buffered
+ */
+int json_arr_encode_buffered(const struct json_obj_descr *descr, const void *val,
+			     json_append_bytes_t flush, void *data,
+			     char *buf, size_t buf_size);
+
 #ifdef __cplusplus
 }
 #endif
@@ -49,6 +49,8 @@ extern "C" {
 #define DISK_IOCTL_GET_ERASE_BLOCK_SZ		4
 /** Commit any cached read/writes to disk */
 #define DISK_IOCTL_CTRL_SYNC			5
+/** Get the largest number of sectors of a single request */
+#define DISK_IOCTL_GET_MAX_XFER_SECTORS		6
 
 /**
  * @brief Possible return bitmasks for disk_status()
@@ -65,6 +67,59 @@ extern "C" {
 
 struct disk_operations;
 
+/**
+ * @brief Possible operations of a disk_request
+ */
+
+/** Read sectors */
+#define DISK_REQUEST_READ		0
+/** Write sectors */
+#define DISK_REQUEST_WRITE		1
+/** Commit any cached writes to disk, like DISK_IOCTL_CTRL_SYNC */
+#define DISK_REQUEST_SYNC		2
+
+/**
+ * @brief Asynchronous disk request
+ *
+ * Started with the submit operation of a disk. Several requests may be in
+ * progress at once, they complete in any order.
+ */
+struct disk_request {
+	/** DISK_REQUEST_* operation */
+	uint8_t op;
+	/** Buffer to read to or to write from, unused by a sync */
+	uint8_t *buf;
+	/** First sector, unused by a sync */
+	uint32_t start_sector;
+	/** Number of sectors, unused by a sync */
+	uint32_t num_sector;
+	/**
+	 * Called by the driver once the request is complete, possibly from
+	 * an interrupt, with 0 or a negative errno code.
+	 */
+	void (*done)(struct disk_request *req, int result);
+};
+
+/**
+ * @brief Disk block cache statistics
+ *
+ * @see disk_access_cache_stats_get()
+ */
+struct disk_cache_stats {
+	/** Sectors read from the cache */
+	uint32_t hits;
+	/** Sectors read from the disk because they weren't cached */
+	uint32_t misses;
+	/** Sectors read ahead into the cache */
+	uint32_t read_ahead;
+	/** Sectors written from the cache to the disk */
+	uint32_t write_backs;
+	/** Sectors of the disk currently cached */
+	uint32_t cached;
+	/** Cached sectors not yet written to the disk */
+	uint32_t dirty;
+};
+
 /**
  * @brief Disk info
  */
@@ -77,6 +132,22 @@ struct disk_info {
 	const struct disk_operations *ops;
 	/** Device associated to this disk */
 	const struct device *dev;
+#if defined(CONFIG_DISK_CACHE) || defined(__DOXYGEN__)
+	/** Internally used lock serializing the accesses to the disk */
+	struct k_mutex lock;
+	/** Internally used block cache state */
+	struct {
+		uint32_t sector_size;
+		uint32_t sector_count;
+		/* Sector following the previous read, to detect sequential reads */
+		uint32_t next_sector;
+		struct disk_cache_stats stats;
+#if defined(CONFIG_DISK_ACCESS_RTIO)
+		struct k_work read_ahead_work;
+		uint32_t read_ahead_sector;
+#endif
+	} cache;
+#endif
 };
 
 /**
@@ -90,6 +161,13 @@ struct disk_operations {
 	int (*write)(struct disk_info *disk, const uint8_t *data_buf,
 		     uint32_t start_sector, uint32_t num_sector);
 	int (*ioctl)(struct disk_info *disk, uint8_t cmd, void *buff);
+	/**
+	 * Optional, start a request without waiting for its completion. The
+	 * done callback isn't called if an error is returned, -ENOMEM or
+	 * -EBUSY if the disk is out of resources for now, the request is then
+	 * submitted again later.
+	 */
+	int (*submit)(struct disk_info *disk, struct disk_request *req);
 };
 
 /**
@@ -0,0 +1,302 @@
+/*  KVS: log-structured key-value store in flash
+ *
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef ZEPHYR_INCLUDE_FS_KVS_H_
+#define ZEPHYR_INCLUDE_FS_KVS_H_
+
+#include <sys/types.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/toolchain.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Key-Value Store (KVS)
+ * @defgroup kvs Key-Value Store (KVS)
+ * @since 3.7
+ * @version 0.1.0
+ * @ingroup file_system_storage
+ * @{
+ * @}
+ */
+
+/**
+ * @brief Key-Value Store Data Structures
+ * @defgroup kvs_data_structures Key-Value Store Data Structures
+ * @ingroup kvs
+ * @{
+ */
+
+/**
+ * @brief Key-Value Store statistics
+ *
+ * The write amplification caused by garbage collection is
+ * (written + moved) / written.
+ */
+struct kvs_stats {
+	/** Number of keys stored */
+	uint32_t keys;
+	/** Number of sectors garbage collected */
+	uint32_t gc_count;
+	/** Number of garbage collections a write had to do itself */
+	uint32_t blocking_count;
+	/** Lowest erase count of the sectors */
+	uint32_t erase_count_min;
+	/** Highest erase count of the sectors */
+	uint32_t erase_count_max;
+	/** Bytes written by writes, records and their headers */
+	uint64_t written;
+	/** Bytes moved by garbage collection, records and their headers */
+	uint64_t moved;
+};
+
+/** @cond INTERNAL_HIDDEN */
+/* State of a sector, as found at mount and kept up to date */
+struct kvs_sector {
+	/* Order in which the sectors in use were opened */
+	uint32_t seq;
+	/* Number of times the sector was erased */
+	uint32_t erase_count;
+	/* Bytes taken by the records of the sector still in use */
+	uint32_t live;
+	uint8_t state;
+};
+
+/* Entry of the hash index of the keys */
+struct kvs_index_entry {
+	/* Hash of the key */
+	uint32_t hash;
+	/* Address of the newest record of the key */
+	uint32_t addr;
+};
+/** @endcond */
+
+/**
+ * @brief Key-Value Store file system structure
+ */
+struct kvs_fs {
+	/** File system offset in flash */
+	off_t offset;
+	/** File system is split into sectors, each sector must be multiple of erase-block-size */
+	uint32_t sector_size;
+	/** Number of sectors in the file system */
+	uint16_t sector_count;
+	/** Flash device runtime structure */
+	const struct device *flash_device;
+	/** Flash memory parameters structure */
+	const struct flash_parameters *flash_parameters;
+	/** Flag indicating if the file system is initialized */
+	bool ready;
+	/** Mutex */
+	struct k_mutex kvs_lock;
+	/** Sector records are written to */
+	uint16_t head;
+	/** Number of sectors that are erased or can be erased */
+	uint16_t free_count;
+	/** Record write address, relative to @p offset */
+	uint32_t wra;
+	/** Sequence number of the last sector opened */
+	uint32_t seq;
+	/** Statistics, see kvs_stats_get() */
+	struct kvs_stats stats;
+	/** Sectors of the file system */
+	struct kvs_sector sectors[CONFIG_KVS_MAX_SECTORS];
+	/** Hash index of the keys, built at mount */
+	struct kvs_index_entry index[CONFIG_KVS_INDEX_SIZE];
+#if CONFIG_KVS_BACKGROUND_GC
+	/** Background garbage collection work */
+	struct k_work gc_work;
+#endif
+};
+
+/**
+ * @brief Entry of a batch of writes
+ *
+ * An entry with a NULL @p data deletes the key.
+ */
+struct kvs_batch_entry {
+	/** Key of the entry */
+	const void *key;
+	/** Length of the key */
+	size_t key_len;
+	/** Data to write, NULL to delete the key */
+	const void *data;
+	/** Number of bytes of data to write */
+	size_t len;
+};
+
+/**
+ * @}
+ */
+
+/**
+ * @brief Key-Value Store APIs
+ * @defgroup kvs_high_level_api Key-Value Store APIs
+ * @ingroup kvs
+ * @{
+ */
+
+/**
+ * @brief Mount a KVS file system onto the flash device specified in @p fs.
+ *
+ * Walks the records of the file system once and builds the hash index of the keys in RAM.
+ *
+ * The file system structure must be zeroed before it is mounted for the first time, e.g. by
+ * being statically allocated, apart from the fields set by the caller. It can then be mounted
+ * again.
+ *
+ * @param fs Pointer to file system
+ * @retval 0 Success
+ * @retval -ENOSPC if the file system holds more keys than the index can take
+ * @retval -ERRNO errno code if error
+ */
+int kvs_mount(struct kvs_fs *fs);
+
+/**
+ * @brief Clear the KVS file system from flash.
+ *
+ * @param fs Pointer to file system
+ * @retval 0 Success
+ * @retval -ERRNO errno code if error
+ */
+int kvs_clear(struct kvs_fs *fs);
+
+/**
+ * @brief Write an entry to the file system.
+ *
+ * A @p len of 0 stores an empty entry, use kvs_delete() to remove a key.
+ *
+ * @param fs Pointer to file system
+ * @param key Key of the entry
+ * @param key_len Length of the key, 1 to @kconfig{CONFIG_KVS_KEY_MAX_LEN}
+ * @param data Pointer to the data to be written
+ * @param len Number of bytes to be written
+ *
+ * @return Number of bytes written. On success, it will be equal to the number of bytes requested
+ * to be written. When a rewrite of the same data already stored is attempted, nothing is written
+ * to flash, thus 0 is returned. On error, returns negative value of errno.h defined error codes.
+ */
+ssize_t kvs_write(struct kvs_fs *fs, const void *key, size_t key_len, const void *data,
+		  size_t len);
+
+/**
+ * @brief Delete an entry from the file system
+ *
+ * @param fs Pointer to file system
+ * @param key Key of the entry
+ * @param key_len Length of the key
+ * @retval 0 Success, also when there is no entry with @p key
+ * @retval -ERRNO errno code if error
+ */
+int kvs_delete(struct kvs_fs *fs, const void *key, size_t key_len);
+
+/**
+ * @brief Write several entries to the file system at once.
+ *
+ * Either all the entries are written, or, when the write is interrupted by an error or a power
+ * loss, none of them. The records of the batch are written to a single sector, so together they
+ * have to fit in a sector. Readers see the entries once all of them are written.
+ *
+ * @param fs Pointer to file system
+ * @param entries Entries to write or delete, applied in order
+ * @param count Number of entries, at most @kconfig{CONFIG_KVS_BATCH_MAX_ENTRIES}
+ * @retval 0 Success
+ * @retval -EINVAL if there are too many entries or they do not fit in a sector
+ * @retval -ERRNO errno code if error
+ */
+int kvs_write_batch(struct kvs_fs *fs, const struct kvs_batch_entry *entries, size_t count);
+
+/**
+ * @brief Read an entry from the file system.
+ *
+ * @param fs Pointer to file system
+ * @param key Key of the entry
+ * @param key_len Length of the key
+ * @param data Pointer to data buffer
+ * @param len Number of bytes to be read
+ *
+ * @return Number of bytes read. On success, it will be equal to the number of bytes requested
+ * to be read. When the return value is larger than the number of bytes requested to read this
+ * indicates not all bytes were read, and more data is available. On error, returns negative
+ * value of errno.h defined error codes.
+ */
+ssize_t kvs_read(struct kvs_fs *fs, const void *key, size_t key_len, void *data, size_t len);
+
+/**
+ * @brief Callback for kvs_walk()
+ *
+ * @param key Key of the entry, followed by a NUL character
+ * @param key_len Length of the key
+ * @param addr Address of the entry, to be passed to kvs_read_addr()
+ * @param len Length of the entry data
+ * @param param Parameter passed to kvs_walk()
+ *
+ * @return 0 to continue walking, any other value to stop
+ */
+typedef int (*kvs_walk_cb_t)(const void *key, size_t key_len, uint32_t addr, size_t len,
+			     void *param);
+
+/**
+ * @brief Walk all the entries of the file system.
+ *
+ * Entries are walked in the order of the index, not in the order they were written, and without
+ * reading the file system other than for their keys. The file system is not locked while
+ * @p cb runs, it can write to the file system: entries written meanwhile may or may not be
+ * walked, entries deleted meanwhile are not walked.
+ *
+ * @param fs Pointer to file system
+ * @param cb Callback called for each entry
+ * @param param Parameter passed to @p cb
+ *
+ * @return 0 on success, the value returned by @p cb if it stopped the walk. On error, returns
+ * negative value of errno.h defined error codes.
+ */
+int kvs_walk(struct kvs_fs *fs, kvs_walk_cb_t cb, void *param);
+
+/**
+ * @brief Read an entry from the file system by its address.
+ *
+ * Reads the data of an entry walked by kvs_walk() without looking it up. Entries can move when
+ * the file system is written or garbage collected: the record at @p addr is only read while it
+ * is still the one of @p key, otherwise @p key is looked up as by kvs_read().
+ *
+ * @param fs Pointer to file system
+ * @param key Key of the entry, as passed to the kvs_walk() callback
+ * @param key_len Length of the key
+ * @param addr Address of the entry, as passed to the kvs_walk() callback
+ * @param data Pointer to data buffer
+ * @param len Number of bytes to be read
+ *
+ * @return Number of bytes read, see kvs_read(). -ENOENT if there is no entry with @p key. On
+ * error, returns negative value of errno.h defined error codes.
+ */
+ssize_t kvs_read_addr(struct kvs_fs *fs, const void *key, size_t key_len, uint32_t addr,
+		      void *data, size_t len);
+
+/**
+ * @brief Get the statistics of the file system.
+ *
+ * The garbage collection statistics are counted from the last kvs_mount().
+ *
+ * @param fs Pointer to file system
+ * @param stats Filled with the statistics
+ * @retval 0 Success
+ * @retval -ERRNO errno code if error
+ */
+int kvs_stats_get(struct kvs_fs *fs, struct kvs_stats *stats);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_FS_KVS_H_ */
@@ -33,6 +33,46 @@ extern "C" {
  * @{
  */
 
+/**
+ * @brief Non-volatile Storage garbage collection statistics
+ *
+ * The write amplification caused by garbage collection is
+ * (written + moved) / written.
+ */
+struct nvs_gc_stats {
+	/** Number of sectors garbage collected */
+	uint32_t count;
+	/** Number of garbage collections nvs_write() had to do or finish itself */
+	uint32_t blocking_count;
+	/** Total time spent garbage collecting, in microseconds */
+	uint64_t time_us;
+	/** Longest time garbage collection held the file system, in microseconds */
+	uint32_t max_time_us;
+	/** Bytes written by nvs_write(), data and allocation table entries */
+	uint64_t written;
+	/** Bytes moved by garbage collection, data and allocation table entries */
+	uint64_t moved;
+};
+
+/** @cond INTERNAL_HIDDEN */
+/* Progress of the garbage collection of a sector */
+struct nvs_gc_state {
+	/* Sector being garbage collected */
+	uint32_t sec_addr;
+	/* Next ate to walk */
+	uint32_t addr;
+	/* Last ate walked */
+	uint32_t prev_addr;
+	/* Last ate of the sector */
+	uint32_t stop_addr;
+	/* Space needed to copy the entries still in use */
+	uint32_t need;
+	/* Largest data of an entry still in use */
+	uint32_t max;
+	uint8_t phase;
+};
+/** @endcond */
+
 /**
  * @brief Non-volatile Storage File system structure
  */
@@ -62,6 +102,18 @@ struct nvs_fs {
 #if CONFIG_NVS_LOOKUP_CACHE
 	uint32_t lookup_cache[CONFIG_NVS_LOOKUP_CACHE_SIZE];
 #endif
+#if CONFIG_NVS_BACKGROUND_GC
+	/** Background garbage collection work */
+	struct k_work gc_work;
+	/** Background garbage collection progress */
+	struct nvs_gc_state gc;
+	/** Write sector found not worth garbage collecting early */
+	uint16_t gc_skip_sector;
+#endif
+#if CONFIG_NVS_GC_STATS
+	/** Garbage collection statistics */
+	struct nvs_gc_stats gc_stats;
+#endif
 };
 
 /**
@@ -78,6 +130,10 @@ struct nvs_fs {
 /**
  * @brief Mount an NVS file system onto the flash device specified in @p fs.
  *
+ * The file system structure must be zeroed before it is mounted for the first time, e.g. by
+ * being statically allocated, apart from the fields set by the caller. It can then be mounted
+ * again.
+ *
  * @param fs Pointer to file system
  * @retval 0 Success
  * @retval -ERRNO errno code if error
@@ -153,6 +209,67 @@ ssize_t nvs_read(struct nvs_fs *fs, uint16_t id, void *data, size_t len);
  */
 ssize_t nvs_read_hist(struct nvs_fs *fs, uint16_t id, void *data, size_t len, uint16_t cnt);
 
+/**
+ * @brief Callback for nvs_walk()
+ *
+ * @param id Id of the entry
+ * @param addr Address of the entry, to be passed to nvs_read_addr()
+ * @param len Length of the entry data, 0 if the entry was deleted
+ * @param param Parameter passed to nvs_walk()
+ *
+ * @return 0 to continue walking, any other value to stop
+ */
+typedef int (*nvs_walk_cb_t)(uint16_t id, uint32_t addr, size_t len, void *param);
+
+/**
+ * @brief Walk all the entries of the file system.
+ *
+ * Entries are walked from the newest to the oldest in a single pass over the
+ * file system. Entries that were written several times are walked once per
+ * write, only the first one walked holds the current data. The file system is
+ * locked during the walk, @p cb must not write to it.
+ *
+ * @param fs Pointer to file system
+ * @param cb Callback called for each entry
+ * @param param Parameter passed to @p cb
+ *
+ * @return 0 on success, the value returned by @p cb if it stopped the walk. On error, returns
+ * negative value of errno.h defined error codes.
+ */
+int nvs_walk(struct nvs_fs *fs, nvs_walk_cb_t cb, void *param);
+
+/**
+ * @brief Read an entry from the file system by its address.
+ *
+ * Reads the data of an entry walked by nvs_walk() without looking it up. Entries can move when
+ * the file system is written or garbage collected, the entry at @p addr is checked to still be
+ * the one with @p id. On -ENOENT, the entry has to be looked up with nvs_read().
+ *
+ * @param fs Pointer to file system
+ * @param id Id of the entry to be read
+ * @param addr Address of the entry, as passed to the nvs_walk() callback
+ * @param data Pointer to data buffer
+ * @param len Number of bytes to be read
+ *
+ * @return Number of bytes read, see nvs_read(). -ENOENT if there is no entry with @p id at
+ * @p addr. On error, returns negative value of errno.h defined error codes.
+ */
+ssize_t nvs_read_addr(struct nvs_fs *fs, uint16_t id, uint32_t addr, void *data, size_t len);
+
+/**
+ * @brief Get the garbage collection statistics of the file system.
+ *
+ * Requires @kconfig{CONFIG_NVS_GC_STATS}. The statistics are counted from the
+ * last nvs_mount().
+ *
+ * @param fs Pointer to file system
+ * @param stats Filled with the statistics
+ * @retval 0 Success
+ * @retval -ENOTSUP if @kconfig{CONFIG_NVS_GC_STATS} is not enabled
+ * @retval -ERRNO errno code if error
+ */
+int nvs_gc_stats_get(struct nvs_fs *fs, struct nvs_gc_stats *stats);
+
 /**
  * @brief Calculate the available free space in the file system.
  *
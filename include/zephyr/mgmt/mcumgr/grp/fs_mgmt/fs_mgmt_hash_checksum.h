@@ -29,6 +29,28 @@ extern "C" {
 typedef int (*fs_mgmt_hash_checksum_handler_fn)(struct fs_file_t *file, uint8_t *output,
 						size_t *out_len, size_t len);
 
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD) || defined(__DOXYGEN__)
+/**
+ * @brief Functions calculating a hash/checksum of a file while it is uploaded.
+ *
+ * Only one calculation is in progress at a time, the functions are called with
+ * the file management lock held.
+ */
+struct fs_mgmt_hash_checksum_upload_api {
+	/** Starts a new calculation, discarding any previous one. */
+	int (*start)(void);
+
+	/** Adds the next data of the file to the calculation. */
+	int (*update)(const uint8_t *data, size_t len);
+
+	/** Finishes the calculation and stores the hash/checksum to output. */
+	int (*finish)(uint8_t *output);
+
+	/** Hash/checksum of the last finished calculation, output_size bytes. */
+	uint8_t *output;
+};
+#endif
+
 /**
  * @brief A collection of handlers for an entire hash/checksum group.
  */
@@ -47,6 +69,11 @@ struct fs_mgmt_hash_checksum_group {
 
 	/** Hash/checksum function pointer. */
 	fs_mgmt_hash_checksum_handler_fn function;
+
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD) || defined(__DOXYGEN__)
+	/** Calculation during file upload, NULL if not supported. */
+	const struct fs_mgmt_hash_checksum_upload_api *upload;
+#endif
 };
 
 /** @typedef fs_mgmt_hash_checksum_list_cb
@@ -90,6 +117,32 @@ const struct fs_mgmt_hash_checksum_group *fs_mgmt_hash_checksum_find_handler(con
  */
 void fs_mgmt_hash_checksum_find_handlers(fs_mgmt_hash_checksum_list_cb cb, void *user_data);
 
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD) || defined(__DOXYGEN__)
+/**
+ * @brief Starts the calculation of all hash/checksum types supporting it on uploaded data.
+ *
+ * @return 0 on success, negative error code on failure.
+ */
+int fs_mgmt_hash_checksum_upload_start(void);
+
+/**
+ * @brief Adds the next uploaded data to the calculations.
+ *
+ * @param data	Uploaded data.
+ * @param len	Length of data.
+ *
+ * @return 0 on success, negative error code on failure.
+ */
+int fs_mgmt_hash_checksum_upload_update(const uint8_t *data, size_t len);
+
+/**
+ * @brief Finishes the calculations once the whole file has been uploaded.
+ *
+ * @return 0 on success, negative error code on failure.
+ */
+int fs_mgmt_hash_checksum_upload_finish(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
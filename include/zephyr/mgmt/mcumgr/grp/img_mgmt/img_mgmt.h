@@ -214,6 +214,12 @@ struct img_mgmt_upload_action {
 	bool proceed;
 	/** Whether to erase the destination flash area. */
 	bool erase;
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW
+	/** Whether the data is ahead of the next expected offset and is to be held until the
+	 *  data before it has been received.
+	 */
+	bool defer;
+#endif
 #ifdef CONFIG_MCUMGR_GRP_IMG_VERBOSE_ERR
 	/** "rsn" string to be sent as explanation for "rc" code */
 	const char *rc_rsn;
@@ -94,6 +94,8 @@ struct img_gr_upload {
 	size_t upload_header_size;
 	/** Image slot num */
 	uint32_t image_num;
+	/** Upload requests to keep in flight, as allowed by the server */
+	uint32_t window;
 };
 
 /**
@@ -144,6 +146,12 @@ int img_mgmt_client_upload_init(struct img_mgmt_client *client, size_t image_siz
 /**
  * @brief Upload part of image.
  *
+ * The data is sent in chunks that fit the SMP buffers. If the server allows it, up to
+ * CONFIG_MCUMGR_GRP_IMG_CLIENT_UPLOAD_WINDOW chunks are sent without waiting for the
+ * responses. The offset in @p res_buf is where the next call must continue the upload from;
+ * it is past the end of @p data when the server already has more data, e.g. when an upload
+ * session is resumed, and before it when the server lost the upload.
+ *
  * @param client	IMG mgmt client object
  * @param data		Pointer to data.
  * @param length	Length of data
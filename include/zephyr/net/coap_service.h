@@ -44,6 +44,13 @@ struct coap_service_data {
 	int sock_fd;
 	struct coap_observer observers[CONFIG_COAP_SERVICE_OBSERVERS];
 	struct coap_pending pending[CONFIG_COAP_SERVICE_PENDING_MESSAGES];
+#if CONFIG_COAP_SERVER_DISPATCH_TABLE_SIZE > 0
+	/* Slice of the server dispatch table holding this service's resources */
+	uint16_t dispatch_start;
+	uint16_t dispatch_exact;
+	uint16_t dispatch_wildcard;
+	bool dispatch_indexed;
+#endif
 };
 
 struct coap_service {
@@ -240,6 +240,14 @@ struct dns_resolve_context {
 		 * cannot be used to find correct pending query.
 		 */
 		uint16_t query_hash;
+
+#if defined(CONFIG_DNS_RESOLVER_COALESCE_QUERIES)
+		/** Pending query for the same name and type whose answer is
+		 * shared with this one. NULL if this query sent its own
+		 * request.
+		 */
+		struct dns_pending_query *leader;
+#endif
 	} queries[CONFIG_DNS_NUM_CONCUR_QUERIES];
 
 	/** Is this context in use */
@@ -455,6 +463,33 @@ static inline int dns_cancel_addr_info(uint16_t dns_id)
 	return dns_resolve_cancel(dns_resolve_get_default(), dns_id);
 }
 
+/**
+ * @brief DNS resolver statistics.
+ */
+struct dns_resolve_stats {
+	/** Lookups answered from the cache */
+	uint32_t cache_hit;
+
+	/** Lookups that were not in the cache */
+	uint32_t cache_miss;
+
+	/** Lookups failed from a cached negative answer */
+	uint32_t cache_negative_hit;
+
+	/** Background queries sent to refresh cache entries */
+	uint32_t cache_prefetch;
+
+	/** Queries that shared the request of a pending query */
+	uint32_t coalesced;
+};
+
+/**
+ * @brief Get DNS resolver statistics.
+ *
+ * @param stats Structure to fill with the current counters.
+ */
+void dns_resolve_get_stats(struct dns_resolve_stats *stats);
+
 /**
  * @}
  */
@@ -215,6 +215,9 @@ struct http_client_internal_data {
 
 	/** HTTP socket */
 	int sock;
+
+	/** Request was sent on a persistent connection */
+	bool persistent;
 };
 
 /**
@@ -324,6 +327,102 @@ struct http_request {
 int http_client_req(int sock, struct http_request *req,
 		    int32_t timeout, void *user_data);
 
+#if defined(CONFIG_HTTP_CLIENT)
+/**
+ * HTTP/1.1 persistent connection. Several requests can be sent over the
+ * same socket, either one after the other or pipelined, in which case the
+ * responses are parsed in the order the requests were sent.
+ */
+struct http_client_conn {
+	/** Requests sent and awaiting their response, oldest first */
+	struct http_request *pending[CONFIG_HTTP_CLIENT_PIPELINE_DEPTH];
+
+	/** Start of the next response, received along with the previous one */
+	const uint8_t *carry;
+
+	/** Length of the data pointed to by carry */
+	size_t carry_len;
+
+	/** Socket of the connection */
+	int sock;
+
+	/** Index of the oldest request in pending */
+	uint8_t pending_head;
+
+	/** Number of requests in pending */
+	uint8_t pending_count;
+
+	/** False once the server asked to close the connection, with
+	 * Connection: close or an HTTP/1.0 response without keep-alive, or
+	 * the connection failed. The socket must then be closed and a new
+	 * connection established for further requests.
+	 */
+	bool keep_alive;
+};
+
+/**
+ * @brief Initialize a persistent connection for an already connected
+ * socket. The socket remains owned by the caller.
+ *
+ * @param conn Connection to initialize.
+ * @param sock Socket id of the connection.
+ */
+void http_client_conn_init(struct http_client_conn *conn, int sock);
+
+/**
+ * @brief Send a HTTP request on a persistent connection without waiting
+ * for its response. Up to @kconfig{CONFIG_HTTP_CLIENT_PIPELINE_DEPTH}
+ * requests can be outstanding, their responses are then received with
+ * http_client_conn_recv(). Only idempotent requests, like GET or HEAD,
+ * should be pipelined, as the server may close the connection before
+ * answering all of them.
+ *
+ * @param conn Persistent connection.
+ * @param req HTTP request information, which must remain valid until its
+ *        response was received.
+ * @param user_data User specified data that is passed to the callback.
+ *
+ * @return <0 if error, >=0 amount of data sent to the server
+ * @retval -EBUSY Too many requests are awaiting their response.
+ * @retval -ENOTCONN The connection cannot be reused.
+ */
+int http_client_conn_send(struct http_client_conn *conn,
+			  struct http_request *req, void *user_data);
+
+/**
+ * @brief Receive the response to the oldest request sent on a persistent
+ * connection. The callbacks of that request are called as with
+ * http_client_req().
+ *
+ * @note Data received past the end of the response is kept in the receive
+ * buffer of the request, so the buffer must not be modified until the
+ * response to the next request was received.
+ *
+ * @param conn Persistent connection.
+ * @param timeout Max timeout to wait for the data, in milliseconds.
+ *
+ * @return <0 if error, >=0 amount of data received for the response
+ * @retval -ENOENT No request is awaiting a response.
+ */
+int http_client_conn_recv(struct http_client_conn *conn, int32_t timeout);
+
+/**
+ * @brief Do a HTTP request on a persistent connection, like
+ * http_client_req(). Responses to previously pipelined requests are
+ * received first.
+ *
+ * @param conn Persistent connection.
+ * @param req HTTP request information
+ * @param timeout Max timeout to wait for each response, in milliseconds.
+ * @param user_data User specified data that is passed to the callback.
+ *
+ * @return <0 if error, >=0 amount of data sent to the server
+ */
+int http_client_conn_req(struct http_client_conn *conn,
+			 struct http_request *req, int32_t timeout,
+			 void *user_data);
+#endif /* CONFIG_HTTP_CLIENT */
+
 #ifdef __cplusplus
 }
 #endif
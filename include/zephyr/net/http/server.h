@@ -0,0 +1,242 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/** @file
+ * @brief HTTP server API
+ *
+ * An event driven HTTP/1.1 server serving the resources defined with
+ * @ref HTTP_RESOURCE_DEFINE for the services defined with
+ * @ref HTTP_SERVICE_DEFINE.
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_HTTP_SERVER_H_
+#define ZEPHYR_INCLUDE_NET_HTTP_SERVER_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/net/http/method.h>
+#include <zephyr/net/http/parser.h>
+#include <zephyr/net/http/service.h>
+#include <zephyr/net/socket.h>
+
+#if defined(CONFIG_FILE_SYSTEM)
+#include <zephyr/fs/fs.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief HTTP server API
+ * @defgroup http_server HTTP server API
+ * @ingroup networking
+ * @{
+ */
+
+/** Type of an HTTP resource, selects the structure holding its details. */
+enum http_resource_type {
+	/** Data known at build time, @ref http_resource_detail_static */
+	HTTP_RESOURCE_TYPE_STATIC,
+	/** File streamed from a file system, @ref http_resource_detail_static_fs */
+	HTTP_RESOURCE_TYPE_STATIC_FS,
+	/** Data exchanged with application callbacks, @ref http_resource_detail_dynamic */
+	HTTP_RESOURCE_TYPE_DYNAMIC,
+};
+
+/**
+ * @brief Details common to all HTTP resources.
+ *
+ * The @p detail pointer given to @ref HTTP_RESOURCE_DEFINE must point to one
+ * of the structures starting with this one, matching @p type.
+ */
+struct http_resource_detail {
+	/** Bitmask of the accepted methods, BIT(HTTP_GET) | BIT(HTTP_POST)... */
+	uint32_t bitmask_of_supported_http_methods;
+	/** Type of the resource */
+	enum http_resource_type type;
+	/** Value of the Content-Encoding header, or NULL */
+	const char *content_encoding;
+	/** Value of the Content-Type header, or NULL */
+	const char *content_type;
+};
+
+/** Resource served from memory. */
+struct http_resource_detail_static {
+	/** Common resource details */
+	struct http_resource_detail common;
+	/** Response body, sent without being copied */
+	const void *static_data;
+	/** Length of the response body */
+	size_t static_data_len;
+};
+
+/** Resource streamed from a file. */
+struct http_resource_detail_static_fs {
+	/** Common resource details */
+	struct http_resource_detail common;
+	/** Absolute path of the file */
+	const char *fs_path;
+};
+
+struct http_client_ctx;
+
+/** Status of the request data passed to a dynamic resource. */
+enum http_data_status {
+	/** The request was aborted, no response is sent */
+	HTTP_SERVER_DATA_ABORTED = -1,
+	/** More request data follows */
+	HTTP_SERVER_DATA_MORE = 0,
+	/** Last call for this request, the response follows */
+	HTTP_SERVER_DATA_FINAL = 1,
+};
+
+/**
+ * @typedef http_resource_request_cb_t
+ * @brief Callback receiving the request body of a dynamic resource.
+ *
+ * Called with each piece of the body as it is received, and one last time
+ * with @ref HTTP_SERVER_DATA_FINAL once the request is complete.
+ *
+ * @param client Connection the request was received on.
+ * @param status Status of the request data.
+ * @param data Request body data.
+ * @param len Length of @p data.
+ * @param user_data User data of the resource.
+ *
+ * @return 0 to go on, negative to answer with 500 Internal Server Error.
+ */
+typedef int (*http_resource_request_cb_t)(struct http_client_ctx *client,
+					  enum http_data_status status,
+					  const uint8_t *data, size_t len,
+					  void *user_data);
+
+/**
+ * @typedef http_resource_response_cb_t
+ * @brief Callback producing the response body of a dynamic resource.
+ *
+ * Called each time the connection can take more data. Each call produces
+ * one chunk of the chunked response, so the callback must not block.
+ *
+ * @param client Connection the response is sent on.
+ * @param buf Buffer to write the next part of the body to.
+ * @param len Size of @p buf.
+ * @param user_data User data of the resource.
+ *
+ * @return Number of bytes written to @p buf, 0 at the end of the body, or
+ *         negative to abort the response and close the connection.
+ */
+typedef int (*http_resource_response_cb_t)(struct http_client_ctx *client,
+					   uint8_t *buf, size_t len,
+					   void *user_data);
+
+/** Resource handled by the application, the response is sent chunked. */
+struct http_resource_detail_dynamic {
+	/** Common resource details */
+	struct http_resource_detail common;
+	/** Request body callback, can be NULL */
+	http_resource_request_cb_t request_cb;
+	/** Response body callback */
+	http_resource_response_cb_t response_cb;
+	/** User data passed to the callbacks */
+	void *user_data;
+};
+
+/**
+ * @brief HTTP server connection.
+ *
+ * One entry of the connection pool. Its size is the memory used by each
+ * connection.
+ */
+struct http_client_ctx {
+	/** Socket of the connection, -1 when the entry is free */
+	int fd;
+
+	/** Service the connection was accepted for */
+	const struct http_service_desc *service;
+
+	/** Resource of the request being handled, or NULL */
+	const struct http_resource_detail *resource;
+
+	/** Request parser */
+	struct http_parser parser;
+
+	/** Received data not parsed yet */
+	uint8_t buffer[CONFIG_HTTP_SERVER_CLIENT_BUFFER_SIZE];
+
+	/** Response data waiting to be sent */
+	uint8_t tx_buffer[CONFIG_HTTP_SERVER_CLIENT_BUFFER_SIZE];
+
+	/** Request URL */
+	char url_buffer[CONFIG_HTTP_SERVER_MAX_URL_LENGTH];
+
+	/** Data waiting to be sent, from @ref tx_buffer or a static resource */
+	struct iovec tx_iov[2];
+
+#if defined(CONFIG_FILE_SYSTEM)
+	/** File of the static file system resource being sent */
+	struct fs_file_t file;
+#endif
+
+	/** Uptime of the last activity, in milliseconds */
+	int64_t last_activity;
+
+	/** Number of bytes in @ref buffer */
+	size_t data_len;
+
+	/** Length of the URL in @ref url_buffer */
+	size_t url_len;
+
+	/** Status code of the response */
+	uint16_t status;
+
+	/** Number of used entries in @ref tx_iov */
+	uint8_t tx_iovcnt;
+
+	/** The whole request was received */
+	bool message_complete : 1;
+
+	/** The whole response is in @ref tx_iov */
+	bool response_complete : 1;
+
+	/** The connection stays open after the response */
+	bool keep_alive : 1;
+
+	/** The connection waits to be writable */
+	bool tx_blocked : 1;
+};
+
+/**
+ * @brief Start the HTTP server.
+ *
+ * Open the listening socket of every service and start serving requests.
+ *
+ * @return 0 on success, -EALREADY if the server is running, or a negative
+ *         error code.
+ */
+int http_server_start(void);
+
+/**
+ * @brief Stop the HTTP server.
+ *
+ * Close every connection and listening socket.
+ *
+ * @return 0 on success, -EALREADY if the server is not running.
+ */
+int http_server_stop(void);
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ZEPHYR_INCLUDE_NET_HTTP_SERVER_H_ */
@@ -235,6 +235,15 @@ struct lwm2m_ctx {
 	 */
 	bool buffer_client_messages;
 #endif
+	/** Number of notifications sent */
+	uint32_t notify_sent;
+
+	/** Number of resource changes carried by a notification which was
+	 *  already scheduled, instead of causing one of their own. See
+	 *  @kconfig{CONFIG_LWM2M_ENGINE_NOTIFY_COALESCE_WINDOW}.
+	 */
+	uint32_t notify_merged;
+
 	/** Current index of Security Object used for server credentials */
 	int sec_obj_inst;
 
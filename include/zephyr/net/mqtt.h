@@ -465,6 +465,19 @@ struct mqtt_transport {
 #endif
 };
 
+#if CONFIG_MQTT_INFLIGHT_WINDOW > 0
+/** @brief Outgoing QoS 1 or QoS 2 publish message awaiting acknowledgment. */
+struct mqtt_inflight {
+	/** Internal. Parameters of the publish message, a message id of 0
+	 *  marks an unused entry. Topic and payload are not copied.
+	 */
+	struct mqtt_publish_param param;
+
+	/** Internal. PUBREC was received, the message now awaits PUBCOMP. */
+	bool released;
+};
+#endif /* CONFIG_MQTT_INFLIGHT_WINDOW > 0 */
+
 /** @brief MQTT internal state. */
 struct mqtt_internal {
 	/** Internal. Mutex to protect access to the client instance. */
@@ -483,6 +496,16 @@ struct mqtt_internal {
 
 	/** Internal. Remaining payload length to read. */
 	uint32_t remaining_payload;
+
+#if CONFIG_MQTT_INFLIGHT_WINDOW > 0
+	/** Internal. Outgoing publish messages awaiting acknowledgment,
+	 *  retransmitted when the client reconnects.
+	 */
+	struct mqtt_inflight inflight[CONFIG_MQTT_INFLIGHT_WINDOW];
+
+	/** Internal. Last message id assigned to an outgoing publish. */
+	uint16_t last_message_id;
+#endif /* CONFIG_MQTT_INFLIGHT_WINDOW > 0 */
 };
 
 /**
@@ -568,6 +591,11 @@ struct mqtt_client {
  *
  * @note Shall be called to initialize client structure, before setting any
  *       client parameters and before connecting to broker.
+ *
+ * @note With @kconfig{CONFIG_MQTT_INFLIGHT_WINDOW} enabled, this also empties
+ *       the in-flight window: QoS 1 and QoS 2 messages not acknowledged yet
+ *       are not retransmitted anymore. Call it again only to start a new
+ *       session, reconnect with mqtt_connect() to resume the current one.
  */
 void mqtt_client_init(struct mqtt_client *client);
 
@@ -617,11 +645,44 @@ int mqtt_connect(struct mqtt_client *client);
  * @param[in] param Parameters to be used for the publish message.
  *                  Shall not be NULL.
  *
+ * @note With @kconfig{CONFIG_MQTT_INFLIGHT_WINDOW} enabled, QoS 1 and QoS 2
+ *       messages are tracked until acknowledged by the broker and
+ *       retransmitted on reconnection, so the topic and payload buffers
+ *       shall remain valid until @ref MQTT_EVT_PUBACK or
+ *       @ref MQTT_EVT_PUBCOMP is received. A message id of 0 is then
+ *       replaced by a free one, which @p param does not return: use
+ *       @ref mqtt_publish_batch to learn it.
+ *
  * @return 0 or a negative error code (errno.h) indicating reason of failure.
+ * @retval -EBUSY The in-flight window is full.
  */
 int mqtt_publish(struct mqtt_client *client,
 		 const struct mqtt_publish_param *param);
 
+/**
+ * @brief API to publish several messages with a single transport write.
+ *
+ * The messages are encoded back to back into the transmit buffer and sent
+ * with one scatter-gather write per @kconfig{CONFIG_MQTT_PUBLISH_BATCH_SIZE}
+ * messages, or earlier if the transmit buffer is full. Payloads are not
+ * copied.
+ *
+ * @param[in] client Client instance for which the procedure is requested.
+ *                   Shall not be NULL.
+ * @param[in,out] param Array of parameters of the publish messages.
+ *                      Shall not be NULL. The message id of each message
+ *                      published is set to the one it was sent with.
+ * @param[in] count Number of messages in @p param.
+ *
+ * @note The notes of @ref mqtt_publish apply to each message.
+ *
+ * @return Number of messages published, which is less than @p count if the
+ *         in-flight window became full, or a negative error code (errno.h)
+ *         if no message could be published.
+ */
+int mqtt_publish_batch(struct mqtt_client *client,
+		       struct mqtt_publish_param *param, size_t count);
+
 /**
  * @brief API used by client to send acknowledgment on receiving QoS1 publish
  *        message. Should be called on reception of @ref MQTT_EVT_PUBLISH with
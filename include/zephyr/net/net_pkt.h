@@ -266,6 +266,15 @@ struct net_pkt {
 	uint16_t vlan_tci;
 #endif /* CONFIG_NET_VLAN */
 
+#if defined(CONFIG_NET_CHKSUM_COPY)
+	/* Checksum of the last payload_chksum_len bytes of the packet,
+	 * calculated while the payload was copied into the packet. Zero
+	 * length means that no such checksum is available.
+	 */
+	uint16_t payload_chksum;
+	uint16_t payload_chksum_len;
+#endif /* CONFIG_NET_CHKSUM_COPY */
+
 #if defined(NET_PKT_HAS_CONTROL_BLOCK)
 	/* TODO: Evolve this into a union of orthogonal
 	 *       control block declarations if further L2
@@ -979,6 +988,47 @@ static inline void net_pkt_set_vlan_tci(struct net_pkt *pkt, uint16_t tci)
 }
 #endif
 
+#if defined(CONFIG_NET_CHKSUM_COPY)
+static inline uint16_t net_pkt_payload_chksum(struct net_pkt *pkt)
+{
+	return pkt->payload_chksum;
+}
+
+static inline uint16_t net_pkt_payload_chksum_len(struct net_pkt *pkt)
+{
+	return pkt->payload_chksum_len;
+}
+
+static inline void net_pkt_set_payload_chksum(struct net_pkt *pkt,
+					      uint16_t chksum, uint16_t len)
+{
+	pkt->payload_chksum = chksum;
+	pkt->payload_chksum_len = len;
+}
+#else
+static inline uint16_t net_pkt_payload_chksum(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline uint16_t net_pkt_payload_chksum_len(struct net_pkt *pkt)
+{
+	ARG_UNUSED(pkt);
+
+	return 0;
+}
+
+static inline void net_pkt_set_payload_chksum(struct net_pkt *pkt,
+					      uint16_t chksum, uint16_t len)
+{
+	ARG_UNUSED(pkt);
+	ARG_UNUSED(chksum);
+	ARG_UNUSED(len);
+}
+#endif /* CONFIG_NET_CHKSUM_COPY */
+
 #if defined(CONFIG_NET_PKT_TIMESTAMP) || defined(CONFIG_NET_PKT_TXTIME)
 static inline struct net_ptp_time *net_pkt_timestamp(struct net_pkt *pkt)
 {
@@ -2092,6 +2142,27 @@ int net_pkt_copy(struct net_pkt *pkt_dst,
 		 struct net_pkt *pkt_src,
 		 size_t length);
 
+/**
+ * @brief Copy data from a packet into another one and calculate the
+ *        Internet checksum of the copied data at the same time.
+ *
+ * @details Works like net_pkt_copy() but the data is read only once. The
+ *          returned checksum can be stored with
+ *          net_pkt_set_payload_chksum() so that it is not recalculated
+ *          when the transport checksum is computed.
+ *
+ * @param pkt_dst Destination network packet.
+ * @param pkt_src Source network packet.
+ * @param length  Length of data to be copied.
+ * @param chksum  Checksum of the copied data (not complemented, host
+ *                byte order).
+ *
+ * @return 0 on success, negative errno code otherwise.
+ */
+int net_pkt_copy_chksum(struct net_pkt *pkt_dst,
+			struct net_pkt *pkt_src,
+			size_t length, uint16_t *chksum);
+
 /**
  * @brief Clone pkt and its buffer. The cloned packet will be allocated on
  *        the same pool as the original one.
@@ -2203,6 +2274,24 @@ int net_pkt_read_be32(struct net_pkt *pkt, uint32_t *data);
  */
 int net_pkt_write(struct net_pkt *pkt, const void *data, size_t length);
 
+/**
+ * @brief Write data into a net_pkt and calculate its Internet checksum
+ *
+ * @details Works like net_pkt_write() but the data is summed while it is
+ *          copied, so that it is read only once. The returned checksum can
+ *          be stored with net_pkt_set_payload_chksum().
+ *
+ * @param pkt    The network packet where to write
+ * @param data   Data to be written
+ * @param length Length of the data to be written
+ * @param chksum Checksum of the written data (not complemented, host
+ *               byte order)
+ *
+ * @return 0 on success, negative errno code otherwise.
+ */
+int net_pkt_write_chksum(struct net_pkt *pkt, const void *data, size_t length,
+			 uint16_t *chksum);
+
 /* Write uint8_t data into a net_pkt. */
 static inline int net_pkt_write_u8(struct net_pkt *pkt, uint8_t data)
 {
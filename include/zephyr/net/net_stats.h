@@ -274,6 +274,16 @@ struct net_stats_tc {
 	} recv[NET_TC_RX_STATS_COUNT];
 };
 
+/**
+ * @brief TX flow queueing statistics
+ */
+struct net_stats_tx_fq {
+	/** Number of packets currently waiting in the flow queues */
+	net_stats_t queued;
+
+	/** Number of packets dropped because their flow was full */
+	net_stats_t drop;
+};
 
 /**
  * @brief Power management statistics
@@ -347,6 +357,11 @@ struct net_stats {
 	struct net_stats_tc tc;
 #endif
 
+#if defined(CONFIG_NET_STATISTICS_TX_FQ)
+	/** TX flow queueing statistics */
+	struct net_stats_tx_fq tx_fq;
+#endif
+
 #if defined(CONFIG_NET_PKT_TXTIME_STATS)
 	/** Network packet TX time statistics */
 	struct net_stats_tx_time tx_time;
@@ -82,6 +82,10 @@ struct zsock_pollfd {
 #define ZSOCK_MSG_DONTWAIT 0x40
 /** zsock_recv: block until the full amount of data can be returned */
 #define ZSOCK_MSG_WAITALL 0x100
+/** zsock_send: more data will follow, the data may be held back to be sent
+ *  together with the next write (TLS sockets with a write buffer only).
+ */
+#define ZSOCK_MSG_MORE 0x8000
 /** @} */
 
 /**
@@ -240,6 +244,16 @@ struct zsock_pollfd {
  *  will take place in consecutive send()/recv() call.
  */
 #define TLS_DTLS_HANDSHAKE_ON_CONNECT 18
+/** Socket option to combine small writes on a TLS socket into full TLS
+ *  records. It accepts and returns an integer, 0 (the default) to disable
+ *  and 1 to enable. When enabled, data written to the socket is held for up
+ *  to CONFIG_NET_SOCKETS_TLS_WRITE_BUFFER_DELAY milliseconds, or until the
+ *  write buffer is full, before it is encrypted and sent. Setting TCP_NODELAY
+ *  on the socket pushes out any held data and disables the delay, only
+ *  writes flagged with ZSOCK_MSG_MORE are held then. Requires
+ *  CONFIG_NET_SOCKETS_TLS_WRITE_BUFFER_SIZE to be non-zero.
+ */
+#define TLS_WRITE_BUFFER 19
 
 /* Valid values for @ref TLS_PEER_VERIFY option */
 #define TLS_PEER_VERIFY_NONE 0     /**< Peer verification disabled. */
@@ -1055,6 +1069,8 @@ static inline char *inet_ntop(sa_family_t family, const void *src, char *dst,
 #define MSG_DONTWAIT ZSOCK_MSG_DONTWAIT
 /** POSIX wrapper for @ref ZSOCK_MSG_WAITALL */
 #define MSG_WAITALL ZSOCK_MSG_WAITALL
+/** POSIX wrapper for @ref ZSOCK_MSG_MORE */
+#define MSG_MORE ZSOCK_MSG_MORE
 
 /** POSIX wrapper for @ref ZSOCK_SHUT_RD */
 #define SHUT_RD ZSOCK_SHUT_RD
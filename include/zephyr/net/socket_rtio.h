@@ -0,0 +1,182 @@
+/**
+ * @file
+ * @brief RTIO socket I/O device
+ *
+ * Lets BSD sockets be driven through an RTIO context, next to the other
+ * RTIO devices, instead of from threads blocking in zsock_* calls.
+ */
+
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_NET_SOCKET_RTIO_H_
+#define ZEPHYR_INCLUDE_NET_SOCKET_RTIO_H_
+
+/**
+ * @brief RTIO socket I/O device
+ * @defgroup bsd_socket_rtio RTIO socket I/O device
+ * @ingroup networking
+ * @{
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/rtio/rtio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Number of poll events a socket I/O device can wait on
+ *
+ * Receiving and sending each wait on one event of the socket.
+ */
+#define ZSOCK_RTIO_POLL_EVENTS 2
+
+/**
+ * @brief Private data of a socket I/O device
+ *
+ * Defined with @ref ZSOCK_RTIO_IODEV_DEFINE, the fields are internal.
+ */
+struct zsock_rtio_iodev_data {
+	/** @cond INTERNAL_HIDDEN */
+	/* Runs the submitted operations */
+	struct k_work_delayable work;
+	/* Runs the submitted operations once the socket is ready */
+	struct k_work_poll poll_work;
+	struct k_poll_event events[ZSOCK_RTIO_POLL_EVENTS];
+	struct k_mutex lock;
+	/* Submitted receive and accept operations */
+	struct rtio_mpsc rx_q;
+	/* Submitted send and connect operations */
+	struct rtio_mpsc tx_q;
+	/* Operations waiting for the socket */
+	struct rtio_iodev_sqe *rx;
+	struct rtio_iodev_sqe *tx;
+	/* Bytes of the current send already sent */
+	uint32_t tx_offset;
+	int sock;
+	bool stream : 1;
+	/* A multishot read saw the end of the stream or an error */
+	bool rx_closed : 1;
+	/** @endcond */
+};
+
+/** @cond INTERNAL_HIDDEN */
+extern const struct rtio_iodev_api zsock_rtio_iodev_api;
+/** @endcond */
+
+/**
+ * @brief Statically define a socket I/O device
+ *
+ * The device is bound to a socket with zsock_rtio_iodev_attach(). It then
+ * handles the following submissions:
+ *
+ * - @ref RTIO_OP_RX: receive into the buffer, or into a buffer of the
+ *   RTIO mempool with rtio_sqe_prep_read_with_pool() and
+ *   rtio_sqe_prep_read_multishot(). The result is the number of bytes
+ *   received, 0 at the end of the stream.
+ * - @ref RTIO_OP_TX and @ref RTIO_OP_TINY_TX: send the whole buffer. The
+ *   result is the number of bytes sent.
+ * - @ref RTIO_OP_SOCK_ACCEPT: accept a connection, see
+ *   zsock_rtio_sqe_prep_accept(). The result is the new socket.
+ * - @ref RTIO_OP_SOCK_CONNECT: connect the socket, see
+ *   zsock_rtio_sqe_prep_connect().
+ *
+ * One receive or accept and one send or connect are in progress at a
+ * time, further submissions are queued in order. A multishot read keeps
+ * completing until canceled, or until it completed once with the end of
+ * the stream or an error.
+ *
+ * @param name Name of the I/O device
+ */
+#define ZSOCK_RTIO_IODEV_DEFINE(name)                                                              \
+	static struct zsock_rtio_iodev_data _zsock_rtio_iodev_data_##name = {                      \
+		.sock = -1,                                                                        \
+	};                                                                                         \
+	RTIO_IODEV_DEFINE(name, &zsock_rtio_iodev_api, &_zsock_rtio_iodev_data_##name)
+
+/**
+ * @brief Bind a socket I/O device to a socket
+ *
+ * The socket is switched to non-blocking mode. Offloaded sockets are not
+ * supported.
+ *
+ * @param iodev I/O device defined with @ref ZSOCK_RTIO_IODEV_DEFINE
+ * @param sock Socket
+ *
+ * @retval 0 on success
+ * @retval -EBUSY if the device is already bound to a socket
+ * @retval -ENOTSUP if the socket is offloaded
+ * @retval <0 other negative error code if the socket can't be used
+ */
+int zsock_rtio_iodev_attach(const struct rtio_iodev *iodev, int sock);
+
+/**
+ * @brief Unbind a socket I/O device from its socket
+ *
+ * Submissions still queued complete with -ECANCELED, multishot reads stop
+ * without completing. Must be called before the socket is closed, after
+ * which the device can be bound again.
+ *
+ * @param iodev I/O device defined with @ref ZSOCK_RTIO_IODEV_DEFINE
+ */
+void zsock_rtio_iodev_detach(const struct rtio_iodev *iodev);
+
+/**
+ * @brief Prepare a socket accept submission
+ *
+ * @param sqe Submission to prepare
+ * @param iodev Listening socket I/O device
+ * @param addr Filled with the address of the peer, can be NULL
+ * @param addrlen Size of @p addr
+ * @param userdata User data of the completion
+ */
+static inline void zsock_rtio_sqe_prep_accept(struct rtio_sqe *sqe,
+					      const struct rtio_iodev *iodev,
+					      struct sockaddr *addr, socklen_t addrlen,
+					      void *userdata)
+{
+	memset(sqe, 0, sizeof(struct rtio_sqe));
+	sqe->op = RTIO_OP_SOCK_ACCEPT;
+	sqe->iodev = iodev;
+	sqe->addr = addr;
+	sqe->addr_len = addrlen;
+	sqe->userdata = userdata;
+}
+
+/**
+ * @brief Prepare a socket connect submission
+ *
+ * @param sqe Submission to prepare
+ * @param iodev Socket I/O device
+ * @param addr Address to connect to, must stay valid until completion
+ * @param addrlen Length of @p addr
+ * @param userdata User data of the completion
+ */
+static inline void zsock_rtio_sqe_prep_connect(struct rtio_sqe *sqe,
+					       const struct rtio_iodev *iodev,
+					       const struct sockaddr *addr, socklen_t addrlen,
+					       void *userdata)
+{
+	memset(sqe, 0, sizeof(struct rtio_sqe));
+	sqe->op = RTIO_OP_SOCK_CONNECT;
+	sqe->iodev = iodev;
+	sqe->addr = (void *)addr;
+	sqe->addr_len = addrlen;
+	sqe->userdata = userdata;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ZEPHYR_INCLUDE_NET_SOCKET_RTIO_H_ */
@@ -280,6 +280,19 @@ struct rtio_sqe {
 
 		/** OP_I2C_CONFIGURE */
 		uint32_t i2c_config;
+
+		/** OP_SOCK_ACCEPT, OP_SOCK_CONNECT */
+		struct {
+			uint32_t addr_len; /**< Length of the socket address */
+			void *addr; /**< Socket address, struct sockaddr */
+		};
+
+		/** OP_DISK_READ, OP_DISK_WRITE */
+		struct {
+			uint32_t disk_num_sector; /**< Number of sectors */
+			uint8_t *disk_buf; /**< Buffer to use */
+			uint32_t disk_start_sector; /**< First sector */
+		};
 	};
 };
 
@@ -480,6 +493,21 @@ struct rtio_iodev {
 /** An operation to configure I2C buses */
 #define RTIO_OP_I2C_CONFIGURE (RTIO_OP_I2C_RECOVER+1)
 
+/** An operation to accept a connection on a socket */
+#define RTIO_OP_SOCK_ACCEPT (RTIO_OP_I2C_CONFIGURE+1)
+
+/** An operation to connect a socket */
+#define RTIO_OP_SOCK_CONNECT (RTIO_OP_SOCK_ACCEPT+1)
+
+/** An operation to read sectors of a disk */
+#define RTIO_OP_DISK_READ (RTIO_OP_SOCK_CONNECT+1)
+
+/** An operation to write sectors of a disk */
+#define RTIO_OP_DISK_WRITE (RTIO_OP_DISK_READ+1)
+
+/** An operation to commit the cached writes of a disk */
+#define RTIO_OP_DISK_SYNC (RTIO_OP_DISK_WRITE+1)
+
 /**
  * @brief Prepare a nop (no op) submission
  */
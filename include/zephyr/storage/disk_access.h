@@ -107,6 +107,21 @@ int disk_access_write(const char *pdrv, const uint8_t *data_buf,
  */
 int disk_access_ioctl(const char *pdrv, uint8_t cmd, void *buff);
 
+/**
+ * @brief Get the block cache statistics of a disk
+ *
+ * The counters are reset when the disk is registered. The cached and dirty
+ * figures describe the cache at the time of the call.
+ *
+ * @param[in] pdrv          Disk name
+ * @param[out] stats        Filled with the statistics
+ *
+ * @retval 0 on success
+ * @retval -EINVAL if the disk isn't registered
+ * @retval -ENOTSUP if @kconfig{CONFIG_DISK_CACHE} is disabled
+ */
+int disk_access_cache_stats_get(const char *pdrv, struct disk_cache_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,196 @@
+/**
+ * @file
+ * @brief RTIO disk I/O device
+ *
+ * Lets several reads and writes of a disk be in progress at once, submitted
+ * to an RTIO context, instead of one at a time from threads blocking in the
+ * disk_access_* calls.
+ */
+
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_INCLUDE_STORAGE_DISK_ACCESS_RTIO_H_
+#define ZEPHYR_INCLUDE_STORAGE_DISK_ACCESS_RTIO_H_
+
+/**
+ * @brief RTIO disk I/O device
+ * @defgroup disk_access_rtio RTIO disk I/O device
+ * @ingroup disk_access_interface
+ * @{
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/disk.h>
+#include <zephyr/rtio/rtio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct disk_access_rtio_data;
+
+/** @cond INTERNAL_HIDDEN */
+/* A request to the disk, made of one or several merged submissions */
+struct disk_access_rtio_req {
+	struct disk_request req;
+	struct disk_access_rtio_data *data;
+	uint8_t count;
+	struct rtio_iodev_sqe *sqes[CONFIG_DISK_ACCESS_RTIO_MERGE_MAX];
+};
+/** @endcond */
+
+/**
+ * @brief Private data of a disk I/O device
+ *
+ * Defined with @ref DISK_ACCESS_RTIO_IODEV_DEFINE, the fields but the
+ * statistics are internal.
+ */
+struct disk_access_rtio_data {
+	/** Number of submissions handled */
+	uint32_t submissions;
+	/** Number of disk requests they were merged into */
+	uint32_t requests;
+	/** @cond INTERNAL_HIDDEN */
+	const char *name;
+	struct disk_info *disk;
+	uint32_t sector_size;
+	/* Largest number of sectors of a request, 0 if unlimited */
+	uint32_t max_sectors;
+	struct k_work work;
+	/* Submitted operations */
+	struct rtio_mpsc queue;
+	/* Submission taken from the queue, waiting for a free request */
+	struct rtio_iodev_sqe *next;
+	/* Request the disk was out of resources for, to submit again */
+	struct disk_access_rtio_req *retry;
+	/* Bitmap of the requests in progress */
+	atomic_t busy;
+	struct disk_access_rtio_req *reqs;
+	uint8_t queue_depth;
+	/** @endcond */
+};
+
+/** @cond INTERNAL_HIDDEN */
+extern const struct rtio_iodev_api disk_access_rtio_iodev_api;
+void disk_access_rtio_work_handler(struct k_work *work);
+/** @endcond */
+
+/**
+ * @brief Statically define a disk I/O device
+ *
+ * The device handles the following submissions:
+ *
+ * - @ref RTIO_OP_DISK_READ: read sectors, see disk_access_rtio_sqe_prep_read().
+ * - @ref RTIO_OP_DISK_WRITE: write sectors, see
+ *   disk_access_rtio_sqe_prep_write().
+ * - @ref RTIO_OP_DISK_SYNC: commit the cached writes, like
+ *   @ref DISK_IOCTL_CTRL_SYNC, see disk_access_rtio_sqe_prep_sync().
+ *
+ * Up to @p queue_depth requests are in progress at once on disks which
+ * start requests without waiting for their completion and aren't behind the
+ * block cache, the others run one request at a time from a work queue. Submissions which continue the
+ * previous one, reading or writing the next sectors from the next bytes of
+ * the same buffer, are merged into a single request of up to
+ * @kconfig{CONFIG_DISK_ACCESS_RTIO_MERGE_MAX} submissions, and no more
+ * sectors than the disk reports with @ref DISK_IOCTL_GET_MAX_XFER_SECTORS.
+ * Requests the disk is out of resources for are submitted again once one of
+ * the requests in progress completes. Independent
+ * submissions complete in any order, chain them to order them.
+ *
+ * @param name Name of the I/O device
+ * @param disk_name Name of the disk, as given to disk_access_init()
+ * @param queue_depth Number of requests in progress at once, 1 to 32
+ */
+#define DISK_ACCESS_RTIO_IODEV_DEFINE(name, disk_name, queue_depth)                                \
+	BUILD_ASSERT(((queue_depth) > 0) && ((queue_depth) <= 32),                                 \
+		     "Queue depth must be between 1 and 32");                                      \
+	static struct disk_access_rtio_req _disk_access_rtio_reqs_##name[queue_depth];             \
+	static struct disk_access_rtio_data _disk_access_rtio_data_##name = {                      \
+		.name = (disk_name),                                                               \
+		.work = Z_WORK_INITIALIZER(disk_access_rtio_work_handler),                         \
+		.queue = RTIO_MPSC_INIT((_disk_access_rtio_data_##name.queue)),                    \
+		.reqs = _disk_access_rtio_reqs_##name,                                             \
+		.queue_depth = (queue_depth),                                                      \
+	};                                                                                         \
+	RTIO_IODEV_DEFINE(name, &disk_access_rtio_iodev_api, &_disk_access_rtio_data_##name)
+
+/**
+ * @brief Prepare a disk read submission
+ *
+ * @param sqe Submission to prepare
+ * @param iodev Disk I/O device
+ * @param buf Buffer to read to
+ * @param start_sector First sector to read
+ * @param num_sector Number of sectors to read
+ * @param userdata User data of the completion
+ */
+static inline void disk_access_rtio_sqe_prep_read(struct rtio_sqe *sqe,
+						  const struct rtio_iodev *iodev, uint8_t *buf,
+						  uint32_t start_sector, uint32_t num_sector,
+						  void *userdata)
+{
+	memset(sqe, 0, sizeof(struct rtio_sqe));
+	sqe->op = RTIO_OP_DISK_READ;
+	sqe->iodev = iodev;
+	sqe->disk_buf = buf;
+	sqe->disk_start_sector = start_sector;
+	sqe->disk_num_sector = num_sector;
+	sqe->userdata = userdata;
+}
+
+/**
+ * @brief Prepare a disk write submission
+ *
+ * @param sqe Submission to prepare
+ * @param iodev Disk I/O device
+ * @param buf Buffer to write, must stay valid until completion
+ * @param start_sector First sector to write
+ * @param num_sector Number of sectors to write
+ * @param userdata User data of the completion
+ */
+static inline void disk_access_rtio_sqe_prep_write(struct rtio_sqe *sqe,
+						   const struct rtio_iodev *iodev,
+						   const uint8_t *buf, uint32_t start_sector,
+						   uint32_t num_sector, void *userdata)
+{
+	memset(sqe, 0, sizeof(struct rtio_sqe));
+	sqe->op = RTIO_OP_DISK_WRITE;
+	sqe->iodev = iodev;
+	sqe->disk_buf = (uint8_t *)buf;
+	sqe->disk_start_sector = start_sector;
+	sqe->disk_num_sector = num_sector;
+	sqe->userdata = userdata;
+}
+
+/**
+ * @brief Prepare a disk sync submission
+ *
+ * The sync doesn't wait for the other submissions in progress, chain it to
+ * the writes it must follow.
+ *
+ * @param sqe Submission to prepare
+ * @param iodev Disk I/O device
+ * @param userdata User data of the completion
+ */
+static inline void disk_access_rtio_sqe_prep_sync(struct rtio_sqe *sqe,
+						  const struct rtio_iodev *iodev, void *userdata)
+{
+	memset(sqe, 0, sizeof(struct rtio_sqe));
+	sqe->op = RTIO_OP_DISK_SYNC;
+	sqe->iodev = iodev;
+	sqe->userdata = userdata;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* ZEPHYR_INCLUDE_STORAGE_DISK_ACCESS_RTIO_H_ */
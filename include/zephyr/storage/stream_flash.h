@@ -25,6 +25,9 @@
 
 #include <stdbool.h>
 #include <zephyr/drivers/flash.h>
+#ifdef CONFIG_STREAM_FLASH_ASYNC
+#include <zephyr/kernel.h>
+#endif
 
 #ifdef __cplusplus
 extern "C" {
@@ -47,6 +50,27 @@ extern "C" {
  */
 typedef int (*stream_flash_callback_t)(uint8_t *buf, size_t len, size_t offset);
 
+struct stream_flash_ctx;
+
+/**
+ * @typedef stream_flash_async_callback_t
+ *
+ * @brief Signature for callback invoked after a buffer is programmed in the
+ * background.
+ *
+ * @details Functions of this type are invoked from the stream flash work queue
+ * once a buffer has been erased, written and verified, or once writing it
+ * failed. After a failure the buffers still queued are dropped, and the error
+ * is returned by the next call to stream_flash_buffered_write().
+ *
+ * @param ctx The context the buffer belongs to.
+ * @param offset The offset the buffer was written to.
+ * @param len The length of the buffer.
+ * @param result 0 on success, negative errno code on fail.
+ */
+typedef void (*stream_flash_async_callback_t)(struct stream_flash_ctx *ctx, size_t offset,
+					      size_t len, int result);
+
 /**
  * @brief Structure for stream flash context
  *
@@ -65,6 +89,21 @@ struct stream_flash_ctx {
 #ifdef CONFIG_STREAM_FLASH_ERASE
 	off_t last_erased_page_start_offset; /* Last erased offset */
 #endif
+#ifdef CONFIG_STREAM_FLASH_ASYNC
+	struct {
+		uint8_t *bufs; /* Write buffers, NULL when not enabled */
+		size_t count; /* Number of write buffers */
+		size_t fill; /* Buffer being filled */
+		stream_flash_async_callback_t callback; /* Callback invoked after write op */
+		struct k_work work; /* Writes the queued buffers */
+		struct k_sem done; /* Given when a queued buffer is written */
+		struct k_spinlock lock; /* Protects the fields below */
+		size_t next; /* Next buffer to write */
+		size_t queued; /* Number of bytes queued for writing */
+		bool flushing; /* No data follows the queued bytes */
+		int error; /* Error which stopped the writes */
+	} async;
+#endif
 };
 
 /**
@@ -93,7 +132,8 @@ int stream_flash_init(struct stream_flash_ctx *ctx, const struct device *fdev,
  *
  * @param ctx context
  *
- * @return Number of payload bytes written to flash.
+ * @return Number of payload bytes written to flash. Bytes queued for writing
+ *         in the background are not counted.
  */
 size_t stream_flash_bytes_written(struct stream_flash_ctx *ctx);
 
@@ -119,6 +159,54 @@ size_t stream_flash_bytes_written(struct stream_flash_ctx *ctx);
 int stream_flash_buffered_write(struct stream_flash_ctx *ctx, const uint8_t *data,
 				size_t len, bool flush);
 
+/**
+ * @brief Write to flash in the background.
+ *
+ * Makes @ref stream_flash_buffered_write return as soon as a full buffer is
+ * queued for writing, while a free buffer remains to be filled. The queued
+ * buffers are erased, written and verified in order by a dedicated work
+ * queue. When @kconfig{CONFIG_STREAM_FLASH_ERASE} is enabled, the page
+ * following the written data is erased ahead of time while the next buffer is
+ * filled.
+ *
+ * The verification callback given to @ref stream_flash_init is invoked from
+ * the work queue. A write with the flush set to true waits for all the queued
+ * buffers to be written. The writes must be flushed, or
+ * @ref stream_flash_async_wait called, before the context is re-initialized
+ * or its memory reused.
+ *
+ * This function must be called after @ref stream_flash_init, before writing
+ * any data.
+ *
+ * @note Requires @kconfig{CONFIG_STREAM_FLASH_ASYNC}.
+ *
+ * @param ctx context
+ * @param bufs @p count write buffers of the length given to
+ *             @ref stream_flash_init, used instead of the buffer given to it
+ * @param count Number of write buffers, at least 2
+ * @param cb Callback to be invoked after each buffer is written, or NULL
+ *
+ * @retval 0 on success
+ * @retval -EFAULT if @p ctx or @p bufs is NULL
+ * @retval -EINVAL if @p count is less than 2
+ * @retval -EBUSY if data has already been written
+ */
+int stream_flash_async_enable(struct stream_flash_ctx *ctx, uint8_t *bufs, size_t count,
+			      stream_flash_async_callback_t cb);
+
+/**
+ * @brief Wait for the buffers queued for writing in the background.
+ *
+ * Data left in the buffer being filled is not written.
+ *
+ * @note Requires @kconfig{CONFIG_STREAM_FLASH_ASYNC}.
+ *
+ * @param ctx context
+ *
+ * @return non-negative on success, negative errno code of a failed write
+ */
+int stream_flash_async_wait(struct stream_flash_ctx *ctx);
+
 /**
  * @brief Erase the flash page to which a given offset belongs.
  *
@@ -8,7 +8,7 @@
 #include <ctype.h>
 #include <errno.h>
 #include <limits.h>
-#include <zephyr/sys/printk.h>
+#include <zephyr/sys/math_extras.h>
 #include <zephyr/sys/util.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -537,6 +537,10 @@ static ptrdiff_t get_elem_size(const struct json_obj_descr *descr)
 	switch (descr->type) {
 	case JSON_TOK_NUMBER:
 		return sizeof(int32_t);
+	case JSON_TOK_FLOAT_FP:
+		return sizeof(float);
+	case JSON_TOK_DOUBLE_FP:
+		return sizeof(double);
 	case JSON_TOK_OPAQUE:
 	case JSON_TOK_FLOAT:
 	case JSON_TOK_OBJ_ARRAY:
@@ -661,12 +665,48 @@ static int arr_data_parse(struct json_obj *obj, struct json_obj_token *val)
 	return -EINVAL;
 }
 
+/*
+ * Find the descriptor of a field that has not been decoded yet. Objects are
+ * usually encoded in descriptor order, so the search starts at @next, the
+ * field following the last decoded one, and names are only compared when
+ * their lengths match.
+ */
+static int descr_find(const struct json_obj_descr *descr, size_t descr_len,
+		      const char *key, size_t key_len, int64_t decoded,
+		      size_t next)
+{
+	size_t i = next;
+	size_t n;
+
+	for (n = 0; n < descr_len; n++, i++) {
+		if (i >= descr_len) {
+			i = 0;
+		}
+
+		if (descr[i].field_name_len != key_len) {
+			continue;
+		}
+
+		/* Field has been decoded already, skip */
+		if (decoded & ((int64_t)1 << i)) {
+			continue;
+		}
+
+		if (memcmp(key, descr[i].field_name, key_len) == 0) {
+			return (int)i;
+		}
+	}
+
+	return -ENOENT;
+}
+
 static int64_t obj_parse(struct json_obj *obj, const struct json_obj_descr *descr,
 			 size_t descr_len, void *val)
 {
 	struct json_obj_key_value kv;
 	int64_t decoded_fields = 0;
-	size_t i;
+	size_t next = 0;
+	int i;
 	int ret;
 
 	while (!obj_next(obj, &kv)) {
@@ -674,42 +714,28 @@ static int64_t obj_parse(struct json_obj *obj, const struct json_obj_descr *desc
 			return decoded_fields;
 		}
 
-		for (i = 0; i < descr_len; i++) {
-			void *decode_field = (char *)val + descr[i].offset;
-
-			/* Field has been decoded already, skip */
-			if (decoded_fields & ((int64_t)1 << i)) {
-				continue;
-			}
-
-			/* Check if it's the i-th field */
-			if (kv.key_len != descr[i].field_name_len) {
-				continue;
-			}
+		i = descr_find(descr, descr_len, kv.key, kv.key_len,
+			       decoded_fields, next);
 
-			if (memcmp(kv.key, descr[i].field_name,
-				   descr[i].field_name_len)) {
-				continue;
-			}
-
-			/* Store the decoded value */
-			ret = decode_value(obj, &descr[i], &kv.value,
-					   decode_field, val);
+		/* Skip field, if no descriptor was found */
+		if (i < 0) {
+			ret = skip_field(obj, &kv);
 			if (ret < 0) {
 				return ret;
 			}
 
-			decoded_fields |= (int64_t)1<<i;
-			break;
+			continue;
 		}
 
-		/* Skip field, if no descriptor was found */
-		if (i >= descr_len) {
-			ret = skip_field(obj, &kv);
-			if (ret < 0) {
-				return ret;
-			}
+		/* Store the decoded value */
+		ret = decode_value(obj, &descr[i], &kv.value,
+				   (char *)val + descr[i].offset, val);
+		if (ret < 0) {
+			return ret;
 		}
+
+		decoded_fields |= (int64_t)1 << i;
+		next = i + 1;
 	}
 
 	return -EINVAL;
@@ -738,45 +764,566 @@ int json_arr_parse(char *payload, size_t len,
 	struct json_obj arr;
 	int ret;
 
-	ret = arr_init(&arr, payload, len);
-	if (ret < 0) {
-		return ret;
+	ret = arr_init(&arr, payload, len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	void *ptr = (char *)val + descr->offset;
+
+	return arr_parse(&arr, descr->array.element_descr,
+			 descr->array.n_elements, ptr, val);
+}
+
+
+int json_arr_separate_object_parse_init(struct json_obj *json, char *payload, size_t len)
+{
+	return arr_init(json, payload, len);
+}
+
+int json_arr_separate_parse_object(struct json_obj *json, const struct json_obj_descr *descr,
+			  size_t descr_len, void *val)
+{
+	struct json_token tok;
+
+	if (!lexer_next(&json->lex, &tok)) {
+		return -EINVAL;
+	}
+
+	if (tok.type == JSON_TOK_ARRAY_END) {
+		return 0;
+	} else if (tok.type == JSON_TOK_COMMA) {
+		if (!lexer_next(&json->lex, &tok)) {
+			return -EINVAL;
+		}
+	}
+
+	if (tok.type != JSON_TOK_OBJECT_START) {
+		return -EINVAL;
+	}
+
+	return obj_parse(json, descr, descr_len, val);
+}
+
+enum stream_lex {
+	STREAM_LEX_NONE,
+	STREAM_LEX_STRING,
+	STREAM_LEX_ESCAPE,
+	STREAM_LEX_UNICODE,
+	STREAM_LEX_NUMBER,
+	STREAM_LEX_LITERAL,
+};
+
+enum stream_state {
+	STREAM_OBJ_KEY_OR_END,
+	STREAM_OBJ_KEY,
+	STREAM_OBJ_COLON,
+	STREAM_OBJ_VALUE,
+	STREAM_OBJ_COMMA_OR_END,
+	STREAM_ARR_VALUE_OR_END,
+	STREAM_ARR_VALUE,
+	STREAM_ARR_COMMA_OR_END,
+};
+
+static void stream_append(struct json_obj_stream *stream, char chr)
+{
+	if (stream->buf_used < stream->buf_size) {
+		stream->buf[stream->buf_used++] = chr;
+	} else {
+		stream->overflow = true;
+	}
+}
+
+static void stream_token_begin(struct json_obj_stream *stream)
+{
+	stream->tok_start = stream->buf_used;
+	stream->overflow = false;
+}
+
+static void stream_token_append(struct json_obj_stream *stream, char chr)
+{
+	/* Nothing is kept from skipped values */
+	if (stream->skip == 0) {
+		stream_append(stream, chr);
+	}
+}
+
+static void stream_token_drop(struct json_obj_stream *stream)
+{
+	stream->buf_used = stream->tok_start;
+}
+
+static struct json_obj_stream_frame *stream_push(struct json_obj_stream *stream,
+						 const struct json_obj_descr *descr,
+						 size_t descr_len, void *val,
+						 enum stream_state state)
+{
+	struct json_obj_stream_frame *frame;
+
+	if (stream->depth == ARRAY_SIZE(stream->frames)) {
+		return NULL;
+	}
+
+	frame = &stream->frames[stream->depth++];
+	frame->descr = descr;
+	frame->descr_len = descr_len;
+	frame->val = val;
+	frame->state = state;
+
+	return frame;
+}
+
+static int stream_push_obj(struct json_obj_stream *stream,
+			   const struct json_obj_descr *descr,
+			   size_t descr_len, void *val)
+{
+	struct json_obj_stream_frame *frame;
+
+	frame = stream_push(stream, descr, descr_len, val,
+			    STREAM_OBJ_KEY_OR_END);
+	if (frame == NULL) {
+		return -ENOMEM;
+	}
+
+	frame->obj.decoded = 0;
+	frame->obj.next = 0;
+
+	return 0;
+}
+
+static int stream_push_arr(struct json_obj_stream *stream,
+			   const struct json_obj_descr *elem_descr,
+			   size_t max_elements, void *field, void *val)
+{
+	struct json_obj_stream_frame *frame;
+	size_t *elements = (size_t *)((char *)val + elem_descr->offset);
+	ptrdiff_t elem_size;
+
+	/* For nested arrays, skip parent descriptor to get elements. Each
+	 * element then holds its own element count.
+	 */
+	if (elem_descr->type == JSON_TOK_ARRAY_START) {
+		elem_descr = elem_descr->array.element_descr;
+		val = NULL;
+	}
+
+	elem_size = get_elem_size(elem_descr);
+
+	__ASSERT_NO_MSG(elem_size > 0);
+
+	frame = stream_push(stream, elem_descr, max_elements, val,
+			    STREAM_ARR_VALUE_OR_END);
+	if (frame == NULL) {
+		return -ENOMEM;
+	}
+
+	*elements = 0;
+	frame->arr.field = field;
+	frame->arr.elements = elements;
+	frame->arr.elem_size = elem_size;
+
+	return 0;
+}
+
+static int stream_pop(struct json_obj_stream *stream)
+{
+	stream->depth--;
+
+	if (stream->depth == 0) {
+		stream->result = stream->frames[0].obj.decoded;
+	}
+
+	return 0;
+}
+
+/*
+ * Decode a value, or start decoding it for objects and arrays. Strings and
+ * other values referenced by the decoded struct stay in the buffer.
+ */
+static int stream_value(struct json_obj_stream *stream,
+			const struct json_obj_descr *descr,
+			struct json_token *value, void *field, void *val)
+{
+	bool keep = false;
+	int ret;
+
+	if (descr == NULL) {
+		stream_token_drop(stream);
+
+		if (value->type == JSON_TOK_OBJECT_START ||
+		    value->type == JSON_TOK_ARRAY_START) {
+			stream->skip = 1;
+		}
+
+		return element_token(value->type);
+	}
+
+	if (!equivalent_types(value->type, descr->type)) {
+		return -EINVAL;
+	}
+
+	switch (descr->type) {
+	case JSON_TOK_OBJECT_START:
+		return stream_push_obj(stream, descr->object.sub_descr,
+				       descr->object.sub_descr_len, field);
+	case JSON_TOK_ARRAY_START:
+		return stream_push_arr(stream, descr->array.element_descr,
+				       descr->array.n_elements, field, val);
+	case JSON_TOK_OBJ_ARRAY:
+		/* The array is copied as it is skipped, brackets included */
+		stream->capture = field;
+		stream->capture->start = &stream->buf[stream->buf_used];
+		stream->skip = 1;
+		return 0;
+	case JSON_TOK_STRING:
+	case JSON_TOK_OPAQUE:
+	case JSON_TOK_FLOAT:
+		keep = true;
+		break;
+	default:
+		break;
+	}
+
+	/* decode_value() terminates strings in place */
+	stream_append(stream, '\0');
+	if (stream->overflow) {
+		return -ENOMEM;
+	}
+
+	value->start = &stream->buf[stream->tok_start];
+	value->end = &stream->buf[stream->buf_used - 1];
+
+	ret = decode_value(NULL, descr, value, field, val);
+
+	if (!keep) {
+		stream_token_drop(stream);
+	}
+
+	return ret;
+}
+
+static int stream_token(struct json_obj_stream *stream, enum json_tokens type)
+{
+	struct json_obj_stream_frame *frame;
+	struct json_token value = { .type = type };
+	void *field;
+	int i;
+
+	if (stream->skip > 0) {
+		switch (type) {
+		case JSON_TOK_OBJECT_START:
+		case JSON_TOK_ARRAY_START:
+			if (stream->skip == UINT16_MAX) {
+				return -ENOMEM;
+			}
+
+			stream->skip++;
+			break;
+		case JSON_TOK_OBJECT_END:
+		case JSON_TOK_ARRAY_END:
+			stream->skip--;
+			break;
+		default:
+			break;
+		}
+
+		return 0;
+	}
+
+	if (stream->depth == 0) {
+		if (type != JSON_TOK_OBJECT_START) {
+			return -EINVAL;
+		}
+
+		return stream_push_obj(stream, stream->descr,
+				       stream->descr_len, stream->val);
+	}
+
+	frame = &stream->frames[stream->depth - 1];
+
+	switch (frame->state) {
+	case STREAM_OBJ_KEY_OR_END:
+		if (type == JSON_TOK_OBJECT_END) {
+			return stream_pop(stream);
+		}
+
+		__fallthrough;
+	case STREAM_OBJ_KEY:
+		if (type != JSON_TOK_STRING) {
+			return -EINVAL;
+		}
+
+		if (stream->overflow) {
+			return -ENOMEM;
+		}
+
+		frame->obj.field = descr_find(frame->descr, frame->descr_len,
+					      &stream->buf[stream->tok_start],
+					      stream->buf_used - stream->tok_start,
+					      frame->obj.decoded,
+					      frame->obj.next);
+		frame->state = STREAM_OBJ_COLON;
+		stream_token_drop(stream);
+
+		return 0;
+	case STREAM_OBJ_COLON:
+		if (type != JSON_TOK_COLON) {
+			return -EINVAL;
+		}
+
+		frame->state = STREAM_OBJ_VALUE;
+
+		return 0;
+	case STREAM_OBJ_VALUE:
+		frame->state = STREAM_OBJ_COMMA_OR_END;
+
+		i = frame->obj.field;
+		if (i < 0) {
+			return stream_value(stream, NULL, &value, NULL, NULL);
+		}
+
+		frame->obj.decoded |= (int64_t)1 << i;
+		frame->obj.next = i + 1;
+
+		return stream_value(stream, &frame->descr[i], &value,
+				    (char *)frame->val + frame->descr[i].offset,
+				    frame->val);
+	case STREAM_OBJ_COMMA_OR_END:
+		if (type == JSON_TOK_COMMA) {
+			frame->state = STREAM_OBJ_KEY;
+			return 0;
+		}
+
+		if (type == JSON_TOK_OBJECT_END) {
+			return stream_pop(stream);
+		}
+
+		return -EINVAL;
+	case STREAM_ARR_VALUE_OR_END:
+		if (type == JSON_TOK_ARRAY_END) {
+			return stream_pop(stream);
+		}
+
+		__fallthrough;
+	case STREAM_ARR_VALUE:
+		frame->state = STREAM_ARR_COMMA_OR_END;
+
+		if (*frame->arr.elements == frame->descr_len) {
+			return -ENOSPC;
+		}
+
+		field = frame->arr.field;
+		frame->arr.field = (char *)field + frame->arr.elem_size;
+		(*frame->arr.elements)++;
+
+		return stream_value(stream, frame->descr, &value, field,
+				    frame->val != NULL ? frame->val : field);
+	case STREAM_ARR_COMMA_OR_END:
+		if (type == JSON_TOK_COMMA) {
+			frame->state = STREAM_ARR_VALUE;
+			return 0;
+		}
+
+		if (type == JSON_TOK_ARRAY_END) {
+			return stream_pop(stream);
+		}
+
+		return -EINVAL;
+	default:
+		return -EINVAL;
+	}
+}
+
+static void stream_literal(struct json_obj_stream *stream, const char *rest,
+			   enum json_tokens type)
+{
+	stream->lex = STREAM_LEX_LITERAL;
+	stream->literal = rest;
+	stream->literal_type = type;
+}
+
+static int stream_lex_start(struct json_obj_stream *stream, int chr)
+{
+	if (isspace(chr) != 0) {
+		return 0;
+	}
+
+	stream_token_begin(stream);
+
+	switch (chr) {
+	case '}':
+	case '{':
+	case '[':
+	case ']':
+	case ',':
+	case ':':
+		return stream_token(stream, (enum json_tokens)chr);
+	case '"':
+		stream->lex = STREAM_LEX_STRING;
+		return 0;
+	case 't':
+		stream_literal(stream, "rue", JSON_TOK_TRUE);
+		return 0;
+	case 'f':
+		stream_literal(stream, "alse", JSON_TOK_FALSE);
+		return 0;
+	case 'n':
+		stream_literal(stream, "ull", JSON_TOK_NULL);
+		return 0;
+	default:
+		if (chr == '-' || isdigit(chr) != 0) {
+			stream->lex = STREAM_LEX_NUMBER;
+			stream_token_append(stream, chr);
+			return 0;
+		}
+
+		return -EINVAL;
+	}
+}
+
+/*
+ * Returns 0 once the character has been consumed, or 1 if it ended the
+ * previous token and has to be parsed again.
+ */
+static int stream_lex(struct json_obj_stream *stream, int chr)
+{
+	int ret;
+
+	switch (stream->lex) {
+	case STREAM_LEX_STRING:
+		if (chr == '"') {
+			stream->lex = STREAM_LEX_NONE;
+			return stream_token(stream, JSON_TOK_STRING);
+		}
+
+		if (chr == '\\') {
+			stream->lex = STREAM_LEX_ESCAPE;
+		}
+
+		break;
+	case STREAM_LEX_ESCAPE:
+		switch (chr) {
+		case '"':
+		case '\\':
+		case '/':
+		case 'b':
+		case 'f':
+		case 'n':
+		case 'r':
+		case 't':
+			stream->lex = STREAM_LEX_STRING;
+			break;
+		case 'u':
+			stream->lex = STREAM_LEX_UNICODE;
+			stream->lex_count = 4;
+			break;
+		default:
+			return -EINVAL;
+		}
+
+		break;
+	case STREAM_LEX_UNICODE:
+		if (isxdigit(chr) == 0) {
+			return -EINVAL;
+		}
+
+		if (--stream->lex_count == 0) {
+			stream->lex = STREAM_LEX_STRING;
+		}
+
+		break;
+	case STREAM_LEX_NUMBER:
+		if (isdigit(chr) != 0 || chr == '.') {
+			break;
+		}
+
+		stream->lex = STREAM_LEX_NONE;
+
+		ret = stream_token(stream, JSON_TOK_NUMBER);
+		if (ret < 0) {
+			return ret;
+		}
+
+		return 1;
+	case STREAM_LEX_LITERAL:
+		if (chr != *stream->literal) {
+			return -EINVAL;
+		}
+
+		stream->literal++;
+		if (*stream->literal != '\0') {
+			return 0;
+		}
+
+		stream->lex = STREAM_LEX_NONE;
+
+		return stream_token(stream, stream->literal_type);
+	default:
+		return stream_lex_start(stream, chr);
+	}
+
+	stream_token_append(stream, chr);
+
+	return 0;
+}
+
+static int stream_capture(struct json_obj_stream *stream, char chr)
+{
+	stream_append(stream, chr);
+	if (stream->overflow) {
+		return -ENOMEM;
 	}
 
-	void *ptr = (char *)val + descr->offset;
+	if (stream->skip == 0) {
+		stream->capture->length = &stream->buf[stream->buf_used] -
+					  stream->capture->start;
+		stream->capture = NULL;
+	}
 
-	return arr_parse(&arr, descr->array.element_descr,
-			 descr->array.n_elements, ptr, val);
+	return 0;
 }
 
-
-int json_arr_separate_object_parse_init(struct json_obj *json, char *payload, size_t len)
+void json_obj_stream_parse_init(struct json_obj_stream *stream,
+				const struct json_obj_descr *descr, size_t descr_len,
+				void *val, char *buf, size_t buf_size)
 {
-	return arr_init(json, payload, len);
+	__ASSERT_NO_MSG(descr_len < (sizeof(stream->result) * CHAR_BIT - 1));
+
+	memset(stream, 0, sizeof(*stream));
+
+	stream->descr = descr;
+	stream->descr_len = descr_len;
+	stream->val = val;
+	stream->buf = buf;
+	stream->buf_size = buf_size;
+	stream->lex = STREAM_LEX_NONE;
+	stream->result = -EAGAIN;
 }
 
-int json_arr_separate_parse_object(struct json_obj *json, const struct json_obj_descr *descr,
-			  size_t descr_len, void *val)
+int64_t json_obj_stream_parse(struct json_obj_stream *stream, const char *data, size_t len)
 {
-	struct json_token tok;
+	int ret;
 
-	if (!lexer_next(&json->lex, &tok)) {
-		return -EINVAL;
-	}
+	while (len > 0 && stream->result == -EAGAIN) {
+		ret = stream_lex(stream, (unsigned char)*data);
+		if (ret > 0) {
+			continue;
+		}
 
-	if (tok.type == JSON_TOK_ARRAY_END) {
-		return 0;
-	} else if (tok.type == JSON_TOK_COMMA) {
-		if (!lexer_next(&json->lex, &tok)) {
-			return -EINVAL;
+		if (ret == 0 && stream->capture != NULL) {
+			ret = stream_capture(stream, *data);
 		}
-	}
 
-	if (tok.type != JSON_TOK_OBJECT_START) {
-		return -EINVAL;
+		if (ret < 0) {
+			stream->result = ret;
+			break;
+		}
+
+		data++;
+		len--;
 	}
 
-	return obj_parse(json, descr, descr_len, val);
+	return stream->result;
 }
 
 static char escape_as(char chr)
@@ -805,22 +1352,39 @@ static int json_escape_internal(const char *str,
 				json_append_bytes_t append_bytes,
 				void *data)
 {
+	const char *run = str;
 	const char *cur;
-	int ret = 0;
+	int ret;
 
-	for (cur = str; ret == 0 && *cur; cur++) {
+	/* Characters not needing escaping are appended in runs */
+	for (cur = str; *cur; cur++) {
 		char escaped = escape_as(*cur);
+		char bytes[2] = { '\\', escaped };
+
+		if (!escaped) {
+			continue;
+		}
 
-		if (escaped) {
-			char bytes[2] = { '\\', escaped };
+		if (cur > run) {
+			ret = append_bytes(run, cur - run, data);
+			if (ret < 0) {
+				return ret;
+			}
+		}
 
-			ret = append_bytes(bytes, 2, data);
-		} else {
-			ret = append_bytes(cur, 1, data);
+		ret = append_bytes(bytes, 2, data);
+		if (ret < 0) {
+			return ret;
 		}
+
+		run = cur + 1;
 	}
 
-	return ret;
+	if (cur > run) {
+		return append_bytes(run, cur - run, data);
+	}
+
+	return 0;
 }
 
 size_t json_calc_escaped_len(const char *str, size_t len)
@@ -877,6 +1441,385 @@ ssize_t json_escape(char *str, size_t *len, size_t buf_size)
 	return 0;
 }
 
+static const char digit_pairs[] =
+	"0001020304050607080910111213141516171819"
+	"2021222324252627282930313233343536373839"
+	"4041424344454647484950515253545556575859"
+	"6061626364656667686970717273747576777879"
+	"8081828384858687888990919293949596979899";
+
+/* Write the decimal digits of num to buf, returns their number */
+static int u32_to_str(char *buf, uint32_t num)
+{
+	char tmp[10];
+	char *pos = &tmp[sizeof(tmp)];
+	int len;
+
+	while (num >= 100) {
+		const char *pair = &digit_pairs[(num % 100) * 2];
+
+		num /= 100;
+		*--pos = pair[1];
+		*--pos = pair[0];
+	}
+
+	if (num >= 10) {
+		*--pos = digit_pairs[num * 2 + 1];
+		*--pos = digit_pairs[num * 2];
+	} else {
+		*--pos = '0' + num;
+	}
+
+	len = &tmp[sizeof(tmp)] - pos;
+	memcpy(buf, pos, len);
+
+	return len;
+}
+
+static int i32_to_str(char *buf, int32_t num)
+{
+	if (num < 0) {
+		buf[0] = '-';
+		return 1 + u32_to_str(&buf[1], 0U - (uint32_t)num);
+	}
+
+	return u32_to_str(buf, num);
+}
+
+static size_t i32_len(int32_t num)
+{
+	uint32_t abs = num < 0 ? 0U - (uint32_t)num : (uint32_t)num;
+	size_t len = num < 0 ? 2 : 1;
+
+	while (abs >= 10) {
+		abs /= 10;
+		len++;
+	}
+
+	return len;
+}
+
+/* Longest output of fp_to_str(): sign, "0.", 5 zeros and 17 digits */
+#define FP_STR_MAX_LEN 25
+
+#if defined(CONFIG_JSON_LIBRARY_FP_SUPPORT)
+
+/*
+ * Floating point numbers are written with the Grisu2 algorithm (Florian
+ * Loitsch, "Printing Floating-Point Numbers Quickly and Accurately with
+ * Integers"). The digits always read back to the same number, and are the
+ * shortest ones doing so for all but a tiny fraction of the inputs.
+ */
+
+struct diy_fp {
+	uint64_t f;
+	int e;
+};
+
+/* Normalized 10^-348, 10^-340, ..., 10^340 */
+static const uint64_t cached_powers_f[] = {
+	0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+	0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+	0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+	0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+	0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+	0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+	0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+	0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+	0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+	0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+	0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+	0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+	0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+	0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+	0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+	0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+	0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+	0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+	0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+	0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+	0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+	0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+	0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+	0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+	0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+	0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+	0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+	0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+	0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL,
+};
+
+static const int16_t cached_powers_e[] = {
+	-1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+	-954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+	-688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+	-422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+	-157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+	109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+	375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+	641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+	907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+static const uint64_t pow10_u64[] = {
+	1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL,
+	10000000ULL, 100000000ULL, 1000000000ULL, 10000000000ULL,
+	100000000000ULL, 1000000000000ULL, 10000000000000ULL,
+	100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+	100000000000000000ULL, 1000000000000000000ULL,
+	10000000000000000000ULL,
+};
+
+static struct diy_fp diy_fp_normalize(struct diy_fp x)
+{
+	int shift = u64_count_leading_zeros(x.f);
+
+	x.f <<= shift;
+	x.e -= shift;
+
+	return x;
+}
+
+/* Upper 64 bits of the product, rounded */
+static struct diy_fp diy_fp_mul(struct diy_fp x, struct diy_fp y)
+{
+	uint64_t a = x.f >> 32;
+	uint64_t b = x.f & UINT32_MAX;
+	uint64_t c = y.f >> 32;
+	uint64_t d = y.f & UINT32_MAX;
+	uint64_t ac = a * c;
+	uint64_t bc = b * c;
+	uint64_t ad = a * d;
+	uint64_t bd = b * d;
+	uint64_t tmp = (bd >> 32) + (ad & UINT32_MAX) + (bc & UINT32_MAX);
+	struct diy_fp r;
+
+	tmp += 1U << 31;
+
+	r.f = ac + (ad >> 32) + (bc >> 32) + (tmp >> 32);
+	r.e = x.e + y.e + 64;
+
+	return r;
+}
+
+static void grisu_round(char *buf, int len, uint64_t delta, uint64_t rest,
+			uint64_t ten_kappa, uint64_t wp_w)
+{
+	while (rest < wp_w && delta - rest >= ten_kappa &&
+	       (rest + ten_kappa < wp_w ||
+		wp_w - rest > rest + ten_kappa - wp_w)) {
+		buf[len - 1]--;
+		rest += ten_kappa;
+	}
+}
+
+static int grisu_digits(struct diy_fp w, struct diy_fp mp, uint64_t delta,
+			char *buf, int *k)
+{
+	const int shift = -mp.e;
+	const uint64_t one = (uint64_t)1 << shift;
+	const uint64_t wp_w = mp.f - w.f;
+	uint32_t p1 = (uint32_t)(mp.f >> shift);
+	uint64_t p2 = mp.f & (one - 1);
+	uint64_t rest;
+	int kappa = 1;
+	int len = 0;
+	uint32_t d;
+
+	while (kappa < 10 && p1 >= pow10_u64[kappa]) {
+		kappa++;
+	}
+
+	while (kappa > 0) {
+		d = p1 / (uint32_t)pow10_u64[kappa - 1];
+		p1 %= (uint32_t)pow10_u64[kappa - 1];
+
+		if (d != 0 || len != 0) {
+			buf[len++] = '0' + d;
+		}
+
+		kappa--;
+
+		rest = ((uint64_t)p1 << shift) + p2;
+		if (rest <= delta) {
+			*k += kappa;
+			grisu_round(buf, len, delta, rest,
+				    pow10_u64[kappa] << shift, wp_w);
+			return len;
+		}
+	}
+
+	while (true) {
+		p2 *= 10;
+		delta *= 10;
+		d = (uint32_t)(p2 >> shift);
+
+		if (d != 0 || len != 0) {
+			buf[len++] = '0' + d;
+		}
+
+		p2 &= one - 1;
+		kappa--;
+
+		if (p2 < delta) {
+			*k += kappa;
+			grisu_round(buf, len, delta, p2, one,
+				    -kappa < (int)ARRAY_SIZE(pow10_u64) ?
+				    wp_w * pow10_u64[-kappa] : 0);
+			return len;
+		}
+	}
+}
+
+/*
+ * Digits of f * 2^e, the value is then buf * 10^k. The lower boundary is
+ * closer when f is a power of two above the smallest normal exponent.
+ */
+static int grisu2(uint64_t f, int e, bool lower_closer, char *buf, int *k)
+{
+	struct diy_fp v = { .f = f, .e = e };
+	struct diy_fp mp = { .f = (f << 1) + 1, .e = e - 1 };
+	struct diy_fp mm;
+	struct diy_fp c;
+	double dk;
+	int index;
+
+	if (lower_closer) {
+		mm.f = (f << 2) - 1;
+		mm.e = e - 2;
+	} else {
+		mm.f = (f << 1) - 1;
+		mm.e = e - 1;
+	}
+
+	mp = diy_fp_normalize(mp);
+	mm.f <<= mm.e - mp.e;
+	mm.e = mp.e;
+
+	/* Cached power bringing the upper boundary exponent to [-60, -32] */
+	dk = (-61 - mp.e) * 0.30102999566398114 + 347;
+	index = (int)dk;
+	if (index < dk) {
+		index++;
+	}
+
+	index = (index >> 3) + 1;
+	*k = 348 - index * 8;
+
+	c.f = cached_powers_f[index];
+	c.e = cached_powers_e[index];
+
+	v = diy_fp_mul(diy_fp_normalize(v), c);
+	mp = diy_fp_mul(mp, c);
+	mm = diy_fp_mul(mm, c);
+	mm.f++;
+	mp.f--;
+
+	return grisu_digits(v, mp, mp.f - mm.f, buf, k);
+}
+
+/* Lay out buf * 10^k as ECMAScript Number.prototype.toString() does */
+static int fp_layout(char *buf, int len, int k)
+{
+	int kk = len + k;
+
+	if (len <= kk && kk <= 21) {
+		memset(&buf[len], '0', kk - len);
+		return kk;
+	}
+
+	if (kk > 0 && kk <= 21) {
+		memmove(&buf[kk + 1], &buf[kk], len - kk);
+		buf[kk] = '.';
+		return len + 1;
+	}
+
+	if (kk > -6 && kk <= 0) {
+		memmove(&buf[2 - kk], buf, len);
+		buf[0] = '0';
+		buf[1] = '.';
+		memset(&buf[2], '0', -kk);
+		return len + 2 - kk;
+	}
+
+	if (len > 1) {
+		memmove(&buf[2], &buf[1], len - 1);
+		buf[1] = '.';
+		len++;
+	}
+
+	buf[len++] = 'e';
+	buf[len++] = kk > 0 ? '+' : '-';
+
+	return len + u32_to_str(&buf[len], kk > 0 ? kk - 1 : 1 - kk);
+}
+
+static int fp_to_str(char *buf, enum json_tokens type, const void *ptr)
+{
+	bool lower_closer;
+	bool negative;
+	uint32_t bits32;
+	uint64_t bits;
+	uint64_t frac;
+	int biased;
+	int len;
+	int k;
+
+	if (type == JSON_TOK_FLOAT_FP) {
+		memcpy(&bits32, ptr, sizeof(bits32));
+		negative = bits32 >> 31;
+		biased = (bits32 >> 23) & 0xff;
+		frac = bits32 & BIT_MASK(23);
+
+		if (biased == 0xff) {
+			return -EINVAL;
+		}
+
+		lower_closer = frac == 0 && biased > 1;
+		frac |= biased != 0 ? BIT(23) : 0;
+		biased = MAX(biased, 1) - 150;
+	} else {
+		memcpy(&bits, ptr, sizeof(bits));
+		negative = bits >> 63;
+		biased = (bits >> 52) & 0x7ff;
+		frac = bits & BIT64_MASK(52);
+
+		if (biased == 0x7ff) {
+			return -EINVAL;
+		}
+
+		lower_closer = frac == 0 && biased > 1;
+		frac |= biased != 0 ? BIT64(52) : 0;
+		biased = MAX(biased, 1) - 1075;
+	}
+
+	if (negative) {
+		*buf++ = '-';
+	}
+
+	if (frac == 0) {
+		buf[0] = '0';
+		return negative + 1;
+	}
+
+	len = grisu2(frac, biased, lower_closer, buf, &k);
+
+	return negative + fp_layout(buf, len, k);
+}
+
+#else
+
+static int fp_to_str(char *buf, enum json_tokens type, const void *ptr)
+{
+	ARG_UNUSED(buf);
+	ARG_UNUSED(type);
+	ARG_UNUSED(ptr);
+
+	return -ENOTSUP;
+}
+
+#endif /* CONFIG_JSON_LIBRARY_FP_SUPPORT */
+
 static int encode(const struct json_obj_descr *descr, const void *val,
 		  json_append_bytes_t append_bytes, void *data);
 
@@ -964,17 +1907,22 @@ static int num_encode(const int32_t *num, json_append_bytes_t append_bytes,
 		      void *data)
 {
 	char buf[3 * sizeof(int32_t)];
+
+	return append_bytes(buf, i32_to_str(buf, *num), data);
+}
+
+static int fp_encode(enum json_tokens type, const void *num,
+		     json_append_bytes_t append_bytes, void *data)
+{
+	char buf[FP_STR_MAX_LEN];
 	int ret;
 
-	ret = snprintk(buf, sizeof(buf), "%d", *num);
+	ret = fp_to_str(buf, type, num);
 	if (ret < 0) {
 		return ret;
 	}
-	if (ret >= (int)sizeof(buf)) {
-		return -ENOMEM;
-	}
 
-	return append_bytes(buf, (size_t)ret, data);
+	return append_bytes(buf, ret, data);
 }
 
 static int float_ascii_encode(struct json_obj_token *num, json_append_bytes_t append_bytes,
@@ -1034,6 +1982,9 @@ static int encode(const struct json_obj_descr *descr, const void *val,
 		return num_encode(ptr, append_bytes, data);
 	case JSON_TOK_FLOAT:
 		return float_ascii_encode(ptr, append_bytes, data);
+	case JSON_TOK_FLOAT_FP:
+	case JSON_TOK_DOUBLE_FP:
+		return fp_encode(descr->type, ptr, append_bytes, data);
 	case JSON_TOK_OPAQUE:
 		return opaque_string_encode(ptr, append_bytes, data);
 	default:
@@ -1128,41 +2079,190 @@ int json_arr_encode_buf(const struct json_obj_descr *descr, const void *val,
 	return json_arr_encode(descr, val, append_bytes_to_buf, &appender);
 }
 
-static int measure_bytes(const char *bytes, size_t len, void *data)
+struct buffered_writer {
+	json_append_bytes_t flush;
+	void *data;
+	char *buf;
+	size_t size;
+	size_t used;
+};
+
+/* Gather the output and pass it on in blocks of the buffer size */
+static int append_bytes_buffered(const char *bytes, size_t len, void *data)
 {
-	ssize_t *total = data;
+	struct buffered_writer *writer = data;
+	size_t n;
+	int ret;
+
+	while (len > 0) {
+		n = MIN(len, writer->size - writer->used);
+		memcpy(&writer->buf[writer->used], bytes, n);
+		writer->used += n;
+		bytes += n;
+		len -= n;
 
-	*total += (ssize_t)len;
+		if (writer->used == writer->size) {
+			ret = writer->flush(writer->buf, writer->used,
+					    writer->data);
+			if (ret < 0) {
+				return ret;
+			}
 
-	ARG_UNUSED(bytes);
+			writer->used = 0;
+		}
+	}
 
 	return 0;
 }
 
-ssize_t json_calc_encoded_len(const struct json_obj_descr *descr,
-			      size_t descr_len, const void *val)
+static int buffered_finish(struct buffered_writer *writer, int ret)
 {
-	ssize_t total = 0;
-	int ret;
-
-	ret = json_obj_encode(descr, descr_len, val, measure_bytes, &total);
-	if (ret < 0) {
+	if (ret < 0 || writer->used == 0) {
 		return ret;
 	}
 
+	return writer->flush(writer->buf, writer->used, writer->data);
+}
+
+int json_obj_encode_buffered(const struct json_obj_descr *descr, size_t descr_len,
+			     const void *val, json_append_bytes_t flush,
+			     void *data, char *buf, size_t buf_size)
+{
+	struct buffered_writer writer = {
+		.flush = flush,
+		.data = data,
+		.buf = buf,
+		.size = buf_size,
+	};
+
+	__ASSERT_NO_MSG(buf_size > 0);
+
+	return buffered_finish(&writer,
+			       json_obj_encode(descr, descr_len, val,
+					       append_bytes_buffered, &writer));
+}
+
+int json_arr_encode_buffered(const struct json_obj_descr *descr, const void *val,
+			     json_append_bytes_t flush, void *data,
+			     char *buf, size_t buf_size)
+{
+	struct buffered_writer writer = {
+		.flush = flush,
+		.data = data,
+		.buf = buf,
+		.size = buf_size,
+	};
+
+	__ASSERT_NO_MSG(buf_size > 0);
+
+	return buffered_finish(&writer,
+			       json_arr_encode(descr, val,
+					       append_bytes_buffered, &writer));
+}
+
+/*
+ * The encoded length is computed from the values, following the structure
+ * of encode() without producing the output.
+ */
+static ssize_t value_len(const struct json_obj_descr *descr, const void *val);
+
+static ssize_t obj_len(const struct json_obj_descr *descr, size_t descr_len,
+		       const void *val)
+{
+	/* Braces and commas */
+	ssize_t total = descr_len > 0 ? descr_len + 1 : 2;
+	ssize_t len;
+	size_t i;
+
+	for (i = 0; i < descr_len; i++) {
+		len = value_len(&descr[i], val);
+		if (len < 0) {
+			return len;
+		}
+
+		/* Quoted key and colon */
+		total += json_calc_escaped_len(descr[i].field_name,
+					       descr[i].field_name_len) + 3;
+		total += len;
+	}
+
 	return total;
 }
 
-ssize_t json_calc_encoded_arr_len(const struct json_obj_descr *descr,
-				  const void *val)
+static ssize_t arr_len(const struct json_obj_descr *elem_descr,
+		       const void *field, const void *val)
 {
-	ssize_t total = 0;
-	int ret;
+	size_t n_elem = *(size_t *)((char *)val + elem_descr->offset);
+	ssize_t total = n_elem > 0 ? n_elem + 1 : 2;
+	ptrdiff_t elem_size;
+	ssize_t len;
+	size_t i;
 
-	ret = json_arr_encode(descr, val, measure_bytes, &total);
-	if (ret < 0) {
-		return ret;
+	/* For nested arrays, skip parent descriptor to get elements */
+	if (elem_descr->type == JSON_TOK_ARRAY_START) {
+		elem_descr = elem_descr->array.element_descr;
+	}
+
+	elem_size = get_elem_size(elem_descr);
+
+	for (i = 0; i < n_elem; i++) {
+		/* See arr_encode() */
+		len = value_len(elem_descr, (char *)field - elem_descr->offset);
+		if (len < 0) {
+			return len;
+		}
+
+		total += len;
+		field = (char *)field + elem_size;
 	}
 
 	return total;
 }
+
+static ssize_t value_len(const struct json_obj_descr *descr, const void *val)
+{
+	const void *ptr = (const char *)val + descr->offset;
+
+	switch (descr->type) {
+	case JSON_TOK_FALSE:
+	case JSON_TOK_TRUE:
+		return *(const bool *)ptr ? 4 : 5;
+	case JSON_TOK_STRING: {
+		const char *str = *(const char **)ptr;
+
+		return json_calc_escaped_len(str, strlen(str)) + 2;
+	}
+	case JSON_TOK_ARRAY_START:
+		return arr_len(descr->array.element_descr, ptr, val);
+	case JSON_TOK_OBJECT_START:
+		return obj_len(descr->object.sub_descr,
+			       descr->object.sub_descr_len, ptr);
+	case JSON_TOK_NUMBER:
+		return i32_len(*(const int32_t *)ptr);
+	case JSON_TOK_FLOAT:
+		return ((const struct json_obj_token *)ptr)->length;
+	case JSON_TOK_OPAQUE:
+		return ((const struct json_obj_token *)ptr)->length + 2;
+	case JSON_TOK_FLOAT_FP:
+	case JSON_TOK_DOUBLE_FP: {
+		char buf[FP_STR_MAX_LEN];
+
+		return fp_to_str(buf, descr->type, ptr);
+	}
+	default:
+		return -EINVAL;
+	}
+}
+
+ssize_t json_calc_encoded_len(const struct json_obj_descr *descr,
+			      size_t descr_len, const void *val)
+{
+	return obj_len(descr, descr_len, val);
+}
+
+ssize_t json_calc_encoded_arr_len(const struct json_obj_descr *descr,
+				  const void *val)
+{
+	return arr_len(descr->array.element_descr,
+		       (const char *)val + descr->offset, val);
+}
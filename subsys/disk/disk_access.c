@@ -13,6 +13,9 @@
 #include <errno.h>
 #include <zephyr/device.h>
 
+#include "disk_access_priv.h"
+#include "disk_cache.h"
+
 #define LOG_LEVEL CONFIG_DISK_LOG_LEVEL
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(disk);
@@ -60,7 +63,14 @@ int disk_access_init(const char *pdrv)
 
 	if ((disk != NULL) && (disk->ops != NULL) &&
 				(disk->ops->init != NULL)) {
+#if defined(CONFIG_DISK_CACHE)
+		k_mutex_lock(&disk->lock, K_FOREVER);
+		disk_cache_reset(disk);
+		rc = disk->ops->init(disk);
+		k_mutex_unlock(&disk->lock);
+#else
 		rc = disk->ops->init(disk);
+#endif
 	}
 
 	return rc;
@@ -87,7 +97,13 @@ int disk_access_read(const char *pdrv, uint8_t *data_buf,
 
 	if ((disk != NULL) && (disk->ops != NULL) &&
 				(disk->ops->read != NULL)) {
+#if defined(CONFIG_DISK_CACHE)
+		k_mutex_lock(&disk->lock, K_FOREVER);
+		rc = disk_cache_read(disk, data_buf, start_sector, num_sector);
+		k_mutex_unlock(&disk->lock);
+#else
 		rc = disk->ops->read(disk, data_buf, start_sector, num_sector);
+#endif
 	}
 
 	return rc;
@@ -101,7 +117,13 @@ int disk_access_write(const char *pdrv, const uint8_t *data_buf,
 
 	if ((disk != NULL) && (disk->ops != NULL) &&
 				(disk->ops->write != NULL)) {
+#if defined(CONFIG_DISK_CACHE)
+		k_mutex_lock(&disk->lock, K_FOREVER);
+		rc = disk_cache_write(disk, data_buf, start_sector, num_sector);
+		k_mutex_unlock(&disk->lock);
+#else
 		rc = disk->ops->write(disk, data_buf, start_sector, num_sector);
+#endif
 	}
 
 	return rc;
@@ -114,12 +136,43 @@ int disk_access_ioctl(const char *pdrv, uint8_t cmd, void *buf)
 
 	if ((disk != NULL) && (disk->ops != NULL) &&
 				(disk->ops->ioctl != NULL)) {
+#if defined(CONFIG_DISK_CACHE)
+		k_mutex_lock(&disk->lock, K_FOREVER);
+		rc = (cmd == DISK_IOCTL_CTRL_SYNC) ? disk_cache_sync(disk) : 0;
+		if (rc == 0) {
+			rc = disk->ops->ioctl(disk, cmd, buf);
+		}
+		k_mutex_unlock(&disk->lock);
+#else
 		rc = disk->ops->ioctl(disk, cmd, buf);
+#endif
 	}
 
 	return rc;
 }
 
+int disk_access_cache_stats_get(const char *pdrv, struct disk_cache_stats *stats)
+{
+#if defined(CONFIG_DISK_CACHE)
+	struct disk_info *disk = disk_access_get_di(pdrv);
+
+	if (disk == NULL) {
+		return -EINVAL;
+	}
+
+	k_mutex_lock(&disk->lock, K_FOREVER);
+	disk_cache_stats(disk, stats);
+	k_mutex_unlock(&disk->lock);
+
+	return 0;
+#else
+	ARG_UNUSED(pdrv);
+	ARG_UNUSED(stats);
+
+	return -ENOTSUP;
+#endif
+}
+
 int disk_access_register(struct disk_info *disk)
 {
 	int rc = 0;
@@ -137,6 +190,11 @@ int disk_access_register(struct disk_info *disk)
 		goto reg_err;
 	}
 
+#if defined(CONFIG_DISK_CACHE)
+	k_mutex_init(&disk->lock);
+	disk_cache_attach(disk);
+#endif
+
 	/*  append to the disk list */
 	sys_dlist_append(&disk_access_list, &disk->node);
 	LOG_DBG("disk interface(%s) registered", disk->name);
@@ -166,5 +224,12 @@ int disk_access_unregister(struct disk_info *disk)
 	LOG_DBG("disk interface(%s) unregistered", disk->name);
 unreg_err:
 	k_mutex_unlock(&mutex);
+
+#if defined(CONFIG_DISK_CACHE)
+	if (rc == 0) {
+		disk_cache_detach(disk);
+	}
+#endif
+
 	return rc;
 }
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_SUBSYS_DISK_DISK_ACCESS_PRIV_H_
+#define ZEPHYR_SUBSYS_DISK_DISK_ACCESS_PRIV_H_
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/disk.h>
+
+struct disk_info *disk_access_get_di(const char *name);
+
+/* Runs work on the work queue of the RTIO disk I/O devices */
+void disk_access_rtio_work_submit(struct k_work *work);
+
+#endif /* ZEPHYR_SUBSYS_DISK_DISK_ACCESS_PRIV_H_ */
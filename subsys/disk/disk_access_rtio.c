@@ -0,0 +1,277 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/rtio/rtio.h>
+#include <zephyr/storage/disk_access.h>
+#include <zephyr/storage/disk_access_rtio.h>
+#include <zephyr/sys/atomic.h>
+
+#include "disk_access_priv.h"
+
+#define LOG_LEVEL CONFIG_DISK_LOG_LEVEL
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(disk);
+
+/*
+ * Submissions are queued by the I/O device and turned into disk requests
+ * from a work queue, merging the submissions which continue each other.
+ * Disks with a submit operation complete the requests on their own, possibly
+ * from an interrupt, the others run them synchronously through the disk
+ * access API. A request completing frees its slot, and resumes the work if
+ * a submission waits for one, or if a request the disk was out of resources
+ * for waits to be submitted again.
+ */
+
+static K_KERNEL_STACK_DEFINE(disk_rtio_stack, CONFIG_DISK_ACCESS_RTIO_STACK_SIZE);
+static struct k_work_q disk_rtio_workq;
+
+void disk_access_rtio_work_submit(struct k_work *work)
+{
+	k_work_submit_to_queue(&disk_rtio_workq, work);
+}
+
+static struct disk_access_rtio_req *disk_rtio_req_alloc(struct disk_access_rtio_data *data)
+{
+	for (uint8_t i = 0; i < data->queue_depth; i++) {
+		if (!atomic_test_and_set_bit(&data->busy, i)) {
+			data->reqs[i].data = data;
+			return &data->reqs[i];
+		}
+	}
+
+	return NULL;
+}
+
+static void disk_rtio_done(struct disk_request *r, int result)
+{
+	struct disk_access_rtio_req *req = CONTAINER_OF(r, struct disk_access_rtio_req, req);
+	struct disk_access_rtio_data *data = req->data;
+
+	for (uint8_t i = 0; i < req->count; i++) {
+		if (result == 0) {
+			rtio_iodev_sqe_ok(req->sqes[i], 0);
+		} else {
+			rtio_iodev_sqe_err(req->sqes[i], result);
+		}
+	}
+
+	atomic_clear_bit(&data->busy, req - data->reqs);
+
+	if ((data->next != NULL) || (data->retry != NULL)) {
+		k_work_submit_to_queue(&disk_rtio_workq, &data->work);
+	}
+}
+
+static struct rtio_iodev_sqe *disk_rtio_pop(struct disk_access_rtio_data *data)
+{
+	struct rtio_mpsc_node *node = rtio_mpsc_pop(&data->queue);
+
+	return node == NULL ? NULL : CONTAINER_OF(node, struct rtio_iodev_sqe, q);
+}
+
+static bool disk_rtio_mergeable(struct disk_access_rtio_data *data,
+				const struct disk_access_rtio_req *req,
+				const struct rtio_sqe *sqe)
+{
+	return (req->count < CONFIG_DISK_ACCESS_RTIO_MERGE_MAX) &&
+	       ((data->max_sectors == 0) ||
+		(req->req.num_sector + sqe->disk_num_sector <= data->max_sectors)) &&
+	       (req->req.op != DISK_REQUEST_SYNC) &&
+	       (sqe->op == (req->req.op == DISK_REQUEST_READ ? RTIO_OP_DISK_READ
+							      : RTIO_OP_DISK_WRITE)) &&
+	       (sqe->disk_start_sector == req->req.start_sector + req->req.num_sector) &&
+	       (sqe->disk_buf == &req->req.buf[req->req.num_sector * data->sector_size]);
+}
+
+static int disk_rtio_prepare(struct disk_access_rtio_req *req, struct rtio_iodev_sqe *iodev_sqe)
+{
+	const struct rtio_sqe *sqe = &iodev_sqe->sqe;
+
+	switch (sqe->op) {
+	case RTIO_OP_DISK_READ:
+		req->req.op = DISK_REQUEST_READ;
+		break;
+	case RTIO_OP_DISK_WRITE:
+		req->req.op = DISK_REQUEST_WRITE;
+		break;
+	case RTIO_OP_DISK_SYNC:
+		req->req.op = DISK_REQUEST_SYNC;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	/* The disk requests don't carry the following submissions of a transaction */
+	if (sqe->flags & RTIO_SQE_TRANSACTION) {
+		return -ENOTSUP;
+	}
+
+	req->req.buf = sqe->disk_buf;
+	req->req.start_sector = sqe->disk_start_sector;
+	req->req.num_sector = sqe->disk_num_sector;
+	req->req.done = disk_rtio_done;
+	req->sqes[0] = iodev_sqe;
+	req->count = 1;
+
+	return 0;
+}
+
+static void disk_rtio_retry(struct disk_access_rtio_data *data, struct disk_access_rtio_req *req)
+{
+	/* Set before looking for the requests in progress, see disk_rtio_done().
+	 * The disk frees its resources as its requests complete, the request is
+	 * submitted again after one of them, or right away if none is left.
+	 */
+	data->retry = req;
+
+	if (atomic_get(&data->busy) == BIT(req - data->reqs)) {
+		k_work_submit_to_queue(&disk_rtio_workq, &data->work);
+	}
+}
+
+static void disk_rtio_start(struct disk_access_rtio_data *data, struct disk_access_rtio_req *req)
+{
+	const struct disk_request *r = &req->req;
+	int rc;
+
+	/* The block cache sits behind disk_access_read() and disk_access_write() */
+	if ((data->disk->ops->submit != NULL) && !IS_ENABLED(CONFIG_DISK_CACHE)) {
+		rc = data->disk->ops->submit(data->disk, &req->req);
+		if ((rc == -ENOMEM) || (rc == -EBUSY)) {
+			disk_rtio_retry(data, req);
+		} else if (rc != 0) {
+			disk_rtio_done(&req->req, rc);
+		}
+		return;
+	}
+
+	switch (r->op) {
+	case DISK_REQUEST_READ:
+		rc = disk_access_read(data->name, r->buf, r->start_sector, r->num_sector);
+		break;
+	case DISK_REQUEST_WRITE:
+		rc = disk_access_write(data->name, r->buf, r->start_sector, r->num_sector);
+		break;
+	default:
+		rc = disk_access_ioctl(data->name, DISK_IOCTL_CTRL_SYNC, NULL);
+		break;
+	}
+
+	disk_rtio_done(&req->req, rc);
+}
+
+static bool disk_rtio_attach(struct disk_access_rtio_data *data)
+{
+	if (data->disk == NULL) {
+		data->disk = disk_access_get_di(data->name);
+		if (data->disk == NULL) {
+			return false;
+		}
+
+		/* Submissions aren't merged if the sector size is unknown */
+		if (disk_access_ioctl(data->name, DISK_IOCTL_GET_SECTOR_SIZE,
+				      &data->sector_size) != 0) {
+			data->sector_size = 0;
+		}
+
+		/* Disks which don't report a transfer limit have none */
+		if (disk_access_ioctl(data->name, DISK_IOCTL_GET_MAX_XFER_SECTORS,
+				      &data->max_sectors) != 0) {
+			data->max_sectors = 0;
+		}
+	}
+
+	return true;
+}
+
+void disk_access_rtio_work_handler(struct k_work *work)
+{
+	struct disk_access_rtio_data *data = CONTAINER_OF(work, struct disk_access_rtio_data, work);
+	struct disk_access_rtio_req *req;
+	struct rtio_iodev_sqe *iodev_sqe;
+	int rc;
+
+	if (!disk_rtio_attach(data)) {
+		LOG_ERR("disk %s not found", data->name);
+		while ((iodev_sqe = disk_rtio_pop(data)) != NULL) {
+			rtio_iodev_sqe_err(iodev_sqe, -ENODEV);
+		}
+		return;
+	}
+
+	if (data->retry != NULL) {
+		req = data->retry;
+		data->retry = NULL;
+
+		disk_rtio_start(data, req);
+		if (data->retry != NULL) {
+			return;
+		}
+	}
+
+	while ((data->next != NULL) || ((data->next = disk_rtio_pop(data)) != NULL)) {
+		/* Set before looking for a free request, see disk_rtio_done() */
+		req = disk_rtio_req_alloc(data);
+		if (req == NULL) {
+			return;
+		}
+
+		iodev_sqe = data->next;
+		data->next = NULL;
+
+		rc = disk_rtio_prepare(req, iodev_sqe);
+		if (rc != 0) {
+			atomic_clear_bit(&data->busy, req - data->reqs);
+			rtio_iodev_sqe_err(iodev_sqe, rc);
+			continue;
+		}
+
+		while ((data->sector_size != 0) && ((iodev_sqe = disk_rtio_pop(data)) != NULL)) {
+			if (!disk_rtio_mergeable(data, req, &iodev_sqe->sqe)) {
+				data->next = iodev_sqe;
+				break;
+			}
+
+			req->sqes[req->count++] = iodev_sqe;
+			req->req.num_sector += iodev_sqe->sqe.disk_num_sector;
+		}
+
+		data->submissions += req->count;
+		data->requests++;
+
+		disk_rtio_start(data, req);
+		if (data->retry != NULL) {
+			return;
+		}
+	}
+}
+
+static void disk_rtio_submit(struct rtio_iodev_sqe *iodev_sqe)
+{
+	struct disk_access_rtio_data *data = iodev_sqe->sqe.iodev->data;
+
+	rtio_mpsc_push(&data->queue, &iodev_sqe->q);
+	k_work_submit_to_queue(&disk_rtio_workq, &data->work);
+}
+
+const struct rtio_iodev_api disk_access_rtio_iodev_api = {
+	.submit = disk_rtio_submit,
+};
+
+static int disk_rtio_init(void)
+{
+	k_work_queue_start(&disk_rtio_workq, disk_rtio_stack,
+			   K_KERNEL_STACK_SIZEOF(disk_rtio_stack),
+			   CONFIG_DISK_ACCESS_RTIO_THREAD_PRIO, NULL);
+	k_thread_name_set(&disk_rtio_workq.thread, "disk_rtio");
+
+	return 0;
+}
+
+SYS_INIT(disk_rtio_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -0,0 +1,525 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/dlist.h>
+#include <zephyr/sys/util.h>
+
+#include "disk_access_priv.h"
+#include "disk_cache.h"
+
+#define LOG_LEVEL CONFIG_DISK_LOG_LEVEL
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(disk);
+
+/*
+ * Larger requests go straight to the disk, so that streaming a file doesn't
+ * evict the file system metadata from the cache.
+ */
+#define DISK_CACHE_BYPASS_SECTORS MAX(1, CONFIG_DISK_CACHE_BLOCKS / 4)
+
+struct disk_cache_block {
+	/* Node in the LRU list */
+	sys_dnode_t lru;
+	/* Node in the hash bucket of the sector, when the block is in use */
+	sys_dnode_t hash;
+	/* NULL if the block is free */
+	struct disk_info *disk;
+	uint32_t sector;
+	bool dirty;
+	uint8_t data[CONFIG_DISK_CACHE_BLOCK_SIZE] __aligned(4);
+};
+
+static struct disk_cache_block blocks[CONFIG_DISK_CACHE_BLOCKS];
+static sys_dlist_t buckets[CONFIG_DISK_CACHE_BLOCKS];
+/* Most recently used block first, free blocks last */
+static sys_dlist_t lru;
+
+/*
+ * Protects the lists and the content of the blocks. It isn't held across
+ * disk accesses: a block is only written to its disk while it is dirty, and
+ * dirty blocks are only touched by users of their own disk, which the disk
+ * lock serializes.
+ */
+static K_MUTEX_DEFINE(cache_lock);
+
+#if CONFIG_DISK_CACHE_READ_AHEAD > 0
+static uint8_t read_ahead_buf[CONFIG_DISK_CACHE_READ_AHEAD * CONFIG_DISK_CACHE_BLOCK_SIZE]
+	__aligned(4);
+/*
+ * Not a mutex: a disk read ahead may read another disk, e.g. the loopback
+ * disk reading its backing file, which must not reuse the buffer.
+ */
+static atomic_t read_ahead_busy;
+#endif
+
+static sys_dlist_t *cache_bucket(struct disk_info *disk, uint32_t sector)
+{
+	return &buckets[(sector ^ ((uintptr_t)disk >> 4)) % ARRAY_SIZE(buckets)];
+}
+
+static struct disk_cache_block *cache_find(struct disk_info *disk, uint32_t sector)
+{
+	struct disk_cache_block *blk;
+
+	SYS_DLIST_FOR_EACH_CONTAINER(cache_bucket(disk, sector), blk, hash) {
+		if ((blk->disk == disk) && (blk->sector == sector)) {
+			return blk;
+		}
+	}
+
+	return NULL;
+}
+
+static void cache_touch(struct disk_cache_block *blk)
+{
+	sys_dlist_remove(&blk->lru);
+	sys_dlist_prepend(&lru, &blk->lru);
+}
+
+static void cache_release(struct disk_cache_block *blk)
+{
+	sys_dlist_remove(&blk->hash);
+	blk->disk = NULL;
+	blk->dirty = false;
+	sys_dlist_remove(&blk->lru);
+	sys_dlist_append(&lru, &blk->lru);
+}
+
+/* Called and returns with cache_lock held, which is released meanwhile */
+static int cache_write_back(struct disk_info *disk, struct disk_cache_block *blk)
+{
+	int rc;
+
+	k_mutex_unlock(&cache_lock);
+	rc = disk->ops->write(disk, blk->data, blk->sector, 1);
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	if (rc == 0) {
+		blk->dirty = false;
+		disk->cache.stats.write_backs++;
+	} else {
+		LOG_ERR("%s: write back of sector %u failed: %d", disk->name, blk->sector, rc);
+	}
+
+	return rc;
+}
+
+/*
+ * Maps a block to a sector which isn't cached, evicting the least recently
+ * used clean block. Dirty blocks of the other disks can't be written back
+ * without taking their lock, so only dirty blocks of this disk are written
+ * back when all blocks are dirty. Returns NULL if no block can be evicted.
+ */
+static struct disk_cache_block *cache_claim(struct disk_info *disk, uint32_t sector)
+{
+	struct disk_cache_block *blk, *victim = NULL;
+	sys_dnode_t *node;
+
+	for (node = sys_dlist_peek_tail(&lru); node != NULL;
+	     node = sys_dlist_peek_prev(&lru, node)) {
+		blk = CONTAINER_OF(node, struct disk_cache_block, lru);
+		if (!blk->dirty) {
+			victim = blk;
+			break;
+		}
+		if ((victim == NULL) && (blk->disk == disk)) {
+			victim = blk;
+		}
+	}
+
+	if ((victim == NULL) ||
+	    (victim->dirty && (cache_write_back(disk, victim) != 0))) {
+		return NULL;
+	}
+
+	if (victim->disk != NULL) {
+		sys_dlist_remove(&victim->hash);
+	}
+
+	victim->disk = disk;
+	victim->sector = sector;
+	sys_dlist_append(cache_bucket(disk, sector), &victim->hash);
+	cache_touch(victim);
+
+	return victim;
+}
+
+/* Copies sectors read from the disk into the cache, with cache_lock held */
+static void cache_fill(struct disk_info *disk, const uint8_t *buf, uint32_t start_sector,
+		       uint32_t num_sector)
+{
+	struct disk_cache_block *blk;
+
+	for (uint32_t i = 0; i < num_sector; i++) {
+		blk = cache_claim(disk, start_sector + i);
+		if (blk == NULL) {
+			break;
+		}
+
+		memcpy(blk->data, &buf[i * disk->cache.sector_size], disk->cache.sector_size);
+	}
+}
+
+/* Returns the number of sectors from start_sector which aren't cached */
+static uint32_t cache_missing(struct disk_info *disk, uint32_t start_sector, uint32_t max)
+{
+	uint32_t num = 0;
+
+	while ((num < max) && (cache_find(disk, start_sector + num) == NULL)) {
+		num++;
+	}
+
+	return num;
+}
+
+static void cache_read_ahead(struct disk_info *disk, uint32_t start_sector)
+{
+#if CONFIG_DISK_CACHE_READ_AHEAD > 0
+	uint32_t num_sector;
+
+	if (start_sector >= disk->cache.sector_count) {
+		return;
+	}
+
+	if (!atomic_cas(&read_ahead_busy, 0, 1)) {
+		return;
+	}
+
+	num_sector = MIN(CONFIG_DISK_CACHE_READ_AHEAD, disk->cache.sector_count - start_sector);
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+	num_sector = cache_missing(disk, start_sector, num_sector);
+	k_mutex_unlock(&cache_lock);
+
+	if ((num_sector > 0) &&
+	    (disk->ops->read(disk, read_ahead_buf, start_sector, num_sector) == 0)) {
+		k_mutex_lock(&cache_lock, K_FOREVER);
+		cache_fill(disk, read_ahead_buf, start_sector, num_sector);
+		disk->cache.stats.read_ahead += num_sector;
+		k_mutex_unlock(&cache_lock);
+	}
+
+	atomic_set(&read_ahead_busy, 0);
+#endif
+}
+
+#if defined(CONFIG_DISK_ACCESS_RTIO)
+static void cache_read_ahead_handler(struct k_work *work)
+{
+	struct disk_info *disk = CONTAINER_OF(work, struct disk_info, cache.read_ahead_work);
+
+	k_mutex_lock(&disk->lock, K_FOREVER);
+	cache_read_ahead(disk, disk->cache.read_ahead_sector);
+	k_mutex_unlock(&disk->lock);
+}
+#endif
+
+/* Returns true if the disk can be cached, probing it on the first access */
+static bool cache_probe(struct disk_info *disk)
+{
+	uint32_t sector_size;
+	uint32_t sector_count;
+
+	if (disk->cache.sector_size == 0) {
+		if ((disk->ops->ioctl == NULL) ||
+		    (disk->ops->ioctl(disk, DISK_IOCTL_GET_SECTOR_SIZE, &sector_size) != 0) ||
+		    (disk->ops->ioctl(disk, DISK_IOCTL_GET_SECTOR_COUNT, &sector_count) != 0) ||
+		    (sector_size == 0)) {
+			/* Likely not initialized yet, probe again on the next access */
+			return false;
+		}
+
+		if (sector_size > CONFIG_DISK_CACHE_BLOCK_SIZE) {
+			LOG_WRN("%s: %u byte sectors are too large to be cached", disk->name,
+				sector_size);
+		}
+
+		disk->cache.sector_size = sector_size;
+		disk->cache.sector_count = sector_count;
+	}
+
+	return disk->cache.sector_size <= CONFIG_DISK_CACHE_BLOCK_SIZE;
+}
+
+/* Writes the dirty sectors of a disk, then drops all its sectors */
+static void cache_drop(struct disk_info *disk)
+{
+	struct disk_cache_block *blk;
+
+	if (disk_cache_sync(disk) != 0) {
+		LOG_WRN("%s: dropping sectors which couldn't be written", disk->name);
+	}
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+	ARRAY_FOR_EACH(blocks, n) {
+		blk = &blocks[n];
+		if (blk->disk == disk) {
+			cache_release(blk);
+		}
+	}
+	k_mutex_unlock(&cache_lock);
+}
+
+void disk_cache_attach(struct disk_info *disk)
+{
+	memset(&disk->cache, 0, sizeof(disk->cache));
+	disk->cache.next_sector = UINT32_MAX;
+#if defined(CONFIG_DISK_ACCESS_RTIO)
+	k_work_init(&disk->cache.read_ahead_work, cache_read_ahead_handler);
+#endif
+}
+
+void disk_cache_detach(struct disk_info *disk)
+{
+#if defined(CONFIG_DISK_ACCESS_RTIO)
+	struct k_work_sync sync;
+
+	/* The read ahead takes the disk lock */
+	(void)k_work_cancel_sync(&disk->cache.read_ahead_work, &sync);
+#endif
+
+	k_mutex_lock(&disk->lock, K_FOREVER);
+	cache_drop(disk);
+	k_mutex_unlock(&disk->lock);
+}
+
+void disk_cache_reset(struct disk_info *disk)
+{
+	cache_drop(disk);
+
+	/* The medium may have changed, probe it again on the next access */
+	disk->cache.sector_size = 0;
+	disk->cache.sector_count = 0;
+	disk->cache.next_sector = UINT32_MAX;
+}
+
+int disk_cache_read(struct disk_info *disk, uint8_t *buf, uint32_t start_sector,
+		    uint32_t num_sector)
+{
+	uint32_t sector_size;
+	struct disk_cache_block *blk;
+	uint32_t i = 0;
+	uint32_t num;
+	int rc;
+
+	if (!cache_probe(disk)) {
+		return disk->ops->read(disk, buf, start_sector, num_sector);
+	}
+
+	sector_size = disk->cache.sector_size;
+
+	if ((start_sector >= disk->cache.sector_count) ||
+	    (num_sector > disk->cache.sector_count - start_sector)) {
+		return -EINVAL;
+	}
+
+	if (num_sector > DISK_CACHE_BYPASS_SECTORS) {
+		rc = disk->ops->read(disk, buf, start_sector, num_sector);
+		if (rc != 0) {
+			return rc;
+		}
+
+		/* The disk is behind the cache for the dirty sectors */
+		k_mutex_lock(&cache_lock, K_FOREVER);
+		ARRAY_FOR_EACH(blocks, n) {
+			blk = &blocks[n];
+			if ((blk->disk == disk) && blk->dirty && (blk->sector >= start_sector) &&
+			    (blk->sector - start_sector < num_sector)) {
+				memcpy(&buf[(blk->sector - start_sector) * sector_size], blk->data,
+				       sector_size);
+			}
+		}
+		k_mutex_unlock(&cache_lock);
+
+		disk->cache.next_sector = start_sector + num_sector;
+
+		return 0;
+	}
+
+	while (i < num_sector) {
+		k_mutex_lock(&cache_lock, K_FOREVER);
+
+		blk = cache_find(disk, start_sector + i);
+		if (blk != NULL) {
+			memcpy(&buf[i * sector_size], blk->data, sector_size);
+			cache_touch(blk);
+			disk->cache.stats.hits++;
+			k_mutex_unlock(&cache_lock);
+			i++;
+			continue;
+		}
+
+		/* Read all the consecutive sectors which aren't cached at once */
+		num = cache_missing(disk, start_sector + i, num_sector - i);
+		disk->cache.stats.misses += num;
+		k_mutex_unlock(&cache_lock);
+
+		rc = disk->ops->read(disk, &buf[i * sector_size], start_sector + i, num);
+		if (rc != 0) {
+			return rc;
+		}
+
+		k_mutex_lock(&cache_lock, K_FOREVER);
+		cache_fill(disk, &buf[i * sector_size], start_sector + i, num);
+		k_mutex_unlock(&cache_lock);
+
+		i += num;
+	}
+
+	if (start_sector == disk->cache.next_sector) {
+#if defined(CONFIG_DISK_ACCESS_RTIO)
+		/* Read ahead from the disk work queue, without holding up the reader */
+		disk->cache.read_ahead_sector = start_sector + num_sector;
+		disk_access_rtio_work_submit(&disk->cache.read_ahead_work);
+#else
+		cache_read_ahead(disk, start_sector + num_sector);
+#endif
+	}
+
+	disk->cache.next_sector = start_sector + num_sector;
+
+	return 0;
+}
+
+int disk_cache_write(struct disk_info *disk, const uint8_t *buf, uint32_t start_sector,
+		     uint32_t num_sector)
+{
+	uint32_t sector_size;
+	struct disk_cache_block *blk;
+	int rc;
+
+	if (!cache_probe(disk)) {
+		return disk->ops->write(disk, buf, start_sector, num_sector);
+	}
+
+	sector_size = disk->cache.sector_size;
+
+	if ((start_sector >= disk->cache.sector_count) ||
+	    (num_sector > disk->cache.sector_count - start_sector)) {
+		return -EINVAL;
+	}
+
+	if (num_sector > DISK_CACHE_BYPASS_SECTORS) {
+		rc = disk->ops->write(disk, buf, start_sector, num_sector);
+
+		/* Keep the cached sectors in line with the disk */
+		k_mutex_lock(&cache_lock, K_FOREVER);
+		ARRAY_FOR_EACH(blocks, n) {
+			blk = &blocks[n];
+			if ((blk->disk != disk) || (blk->sector < start_sector) ||
+			    (blk->sector - start_sector >= num_sector)) {
+				continue;
+			}
+
+			if (rc == 0) {
+				memcpy(blk->data, &buf[(blk->sector - start_sector) * sector_size],
+				       sector_size);
+				blk->dirty = false;
+			} else {
+				cache_release(blk);
+			}
+		}
+		k_mutex_unlock(&cache_lock);
+
+		return rc;
+	}
+
+	for (uint32_t i = 0; i < num_sector; i++) {
+		k_mutex_lock(&cache_lock, K_FOREVER);
+
+		blk = cache_find(disk, start_sector + i);
+		if (blk == NULL) {
+			blk = cache_claim(disk, start_sector + i);
+		}
+
+		if (blk != NULL) {
+			memcpy(blk->data, &buf[i * sector_size], sector_size);
+			blk->dirty = true;
+			cache_touch(blk);
+			k_mutex_unlock(&cache_lock);
+			continue;
+		}
+
+		k_mutex_unlock(&cache_lock);
+
+		rc = disk->ops->write(disk, &buf[i * sector_size], start_sector + i, 1);
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+int disk_cache_sync(struct disk_info *disk)
+{
+	struct disk_cache_block *blk, *next;
+	int rc = 0;
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	do {
+		next = NULL;
+		ARRAY_FOR_EACH(blocks, n) {
+			blk = &blocks[n];
+			if ((blk->disk == disk) && blk->dirty &&
+			    ((next == NULL) || (blk->sector < next->sector))) {
+				next = blk;
+			}
+		}
+	} while ((next != NULL) && ((rc = cache_write_back(disk, next)) == 0));
+
+	k_mutex_unlock(&cache_lock);
+
+	return rc;
+}
+
+void disk_cache_stats(struct disk_info *disk, struct disk_cache_stats *stats)
+{
+	struct disk_cache_block *blk;
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	*stats = disk->cache.stats;
+	stats->cached = 0;
+	stats->dirty = 0;
+
+	ARRAY_FOR_EACH(blocks, n) {
+		blk = &blocks[n];
+		if (blk->disk == disk) {
+			stats->cached++;
+			stats->dirty += blk->dirty ? 1 : 0;
+		}
+	}
+
+	k_mutex_unlock(&cache_lock);
+}
+
+static int disk_cache_init(void)
+{
+	struct disk_cache_block *blk;
+
+	sys_dlist_init(&lru);
+
+	for (size_t i = 0; i < ARRAY_SIZE(buckets); i++) {
+		sys_dlist_init(&buckets[i]);
+	}
+
+	ARRAY_FOR_EACH(blocks, n) {
+		blk = &blocks[n];
+		sys_dnode_init(&blk->hash);
+		sys_dlist_append(&lru, &blk->lru);
+	}
+
+	return 0;
+}
+
+SYS_INIT(disk_cache_init, PRE_KERNEL_1, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef ZEPHYR_SUBSYS_DISK_DISK_CACHE_H_
+#define ZEPHYR_SUBSYS_DISK_DISK_CACHE_H_
+
+#include <zephyr/drivers/disk.h>
+
+/*
+ * Block cache shared by all disks. All the functions but disk_cache_detach()
+ * must be called with the lock of the disk held.
+ */
+
+/* Resets the cache state of a disk being registered */
+void disk_cache_attach(struct disk_info *disk);
+
+/* Writes the dirty sectors of a disk and drops all its sectors */
+void disk_cache_detach(struct disk_info *disk);
+
+/* Like disk_cache_detach(), and forgets the geometry of the disk */
+void disk_cache_reset(struct disk_info *disk);
+
+int disk_cache_read(struct disk_info *disk, uint8_t *buf, uint32_t start_sector,
+		    uint32_t num_sector);
+
+int disk_cache_write(struct disk_info *disk, const uint8_t *buf, uint32_t start_sector,
+		     uint32_t num_sector);
+
+/* Writes the dirty sectors of a disk in ascending order */
+int disk_cache_sync(struct disk_info *disk);
+
+void disk_cache_stats(struct disk_info *disk, struct disk_cache_stats *stats);
+
+#endif /* ZEPHYR_SUBSYS_DISK_DISK_CACHE_H_ */
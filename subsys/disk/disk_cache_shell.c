@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/shell/shell.h>
+#include <zephyr/storage/disk_access.h>
+
+static int cmd_disk_cache_stats(const struct shell *sh, size_t argc, char **argv)
+{
+	struct disk_cache_stats stats;
+	uint64_t reads;
+	uint32_t permille = 0;
+	int rc;
+
+	rc = disk_access_cache_stats_get(argv[1], &stats);
+	if (rc != 0) {
+		shell_error(sh, "No statistics for disk %s: %d", argv[1], rc);
+		return rc;
+	}
+
+	reads = (uint64_t)stats.hits + stats.misses;
+	if (reads != 0) {
+		permille = (uint32_t)(stats.hits * 1000ULL / reads);
+	}
+
+	shell_print(sh, "Hits:        %u", stats.hits);
+	shell_print(sh, "Misses:      %u", stats.misses);
+	shell_print(sh, "Hit rate:    %u.%u%%", permille / 10, permille % 10);
+	shell_print(sh, "Read ahead:  %u", stats.read_ahead);
+	shell_print(sh, "Write backs: %u", stats.write_backs);
+	shell_print(sh, "Cached:      %u", stats.cached);
+	shell_print(sh, "Dirty:       %u", stats.dirty);
+
+	return 0;
+}
+
+static int cmd_disk_cache_sync(const struct shell *sh, size_t argc, char **argv)
+{
+	int rc;
+
+	rc = disk_access_ioctl(argv[1], DISK_IOCTL_CTRL_SYNC, NULL);
+	if (rc != 0) {
+		shell_error(sh, "Failed to sync disk %s: %d", argv[1], rc);
+	}
+
+	return rc;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_disk_cache,
+	/* Alphabetically sorted. */
+	SHELL_CMD_ARG(stats, NULL, "Show the cache statistics of a disk\n"
+		      "Usage: stats <disk>", cmd_disk_cache_stats, 2, 0),
+	SHELL_CMD_ARG(sync, NULL, "Write the dirty cached sectors of a disk\n"
+		      "Usage: sync <disk>", cmd_disk_cache_sync, 2, 0),
+	SHELL_SUBCMD_SET_END /* Array terminated. */
+);
+
+SHELL_CMD_REGISTER(disk_cache, &sub_disk_cache, "Disk block cache commands", NULL);
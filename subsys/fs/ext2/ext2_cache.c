@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+#include "ext2.h"
+#include "ext2_struct.h"
+#include "ext2_cache.h"
+
+LOG_MODULE_DECLARE(ext2);
+
+/* Inode cache -------------------------------------------------------------- */
+
+#if defined(CONFIG_EXT2_INODE_CACHE)
+
+static struct ext2_icache_entry *icache_entry(struct ext2_data *fs, uint32_t ino)
+{
+	return &fs->icache[ino % CONFIG_EXT2_INODE_CACHE_SIZE];
+}
+
+bool ext2_icache_fetch(struct ext2_data *fs, uint32_t ino, struct ext2_inode *inode)
+{
+	struct ext2_icache_entry *entry = icache_entry(fs, ino);
+
+	if (entry->ino != ino) {
+		return false;
+	}
+
+	inode->i_mode = entry->i_mode;
+	inode->i_links_count = entry->i_links_count;
+	inode->i_size = entry->i_size;
+	inode->i_blocks = entry->i_blocks;
+	memcpy(inode->i_block, entry->i_block, sizeof(inode->i_block));
+#if defined(CONFIG_EXT2_EXTENT_CACHE)
+	memcpy(inode->extents, entry->extents, sizeof(inode->extents));
+#endif
+
+	LOG_DBG("inode %d cached", ino);
+	return true;
+}
+
+void ext2_icache_store(struct ext2_data *fs, struct ext2_inode *inode)
+{
+	struct ext2_icache_entry *entry = icache_entry(fs, inode->i_id);
+
+	entry->ino = inode->i_id;
+	entry->i_mode = inode->i_mode;
+	entry->i_links_count = inode->i_links_count;
+	entry->i_size = inode->i_size;
+	entry->i_blocks = inode->i_blocks;
+	memcpy(entry->i_block, inode->i_block, sizeof(entry->i_block));
+#if defined(CONFIG_EXT2_EXTENT_CACHE)
+	memcpy(entry->extents, inode->extents, sizeof(entry->extents));
+#endif
+}
+
+void ext2_icache_store_extents(struct ext2_data *fs, struct ext2_inode *inode)
+{
+#if defined(CONFIG_EXT2_EXTENT_CACHE)
+	struct ext2_icache_entry *entry = icache_entry(fs, inode->i_id);
+
+	if (entry->ino == inode->i_id) {
+		memcpy(entry->extents, inode->extents, sizeof(entry->extents));
+	}
+#endif
+}
+
+void ext2_icache_invalidate(struct ext2_data *fs, uint32_t ino)
+{
+	struct ext2_icache_entry *entry = icache_entry(fs, ino);
+
+	if (entry->ino == ino) {
+		entry->ino = 0;
+	}
+}
+
+#endif /* CONFIG_EXT2_INODE_CACHE */
+
+/* Directory entry cache ---------------------------------------------------- */
+
+#if defined(CONFIG_EXT2_DENTRY_CACHE)
+
+static struct ext2_dcache_entry *dcache_entry(struct ext2_data *fs, uint32_t dir,
+					      const char *name, size_t len)
+{
+	/* FNV-1a over the directory inode and the name */
+	uint32_t hash = 2166136261U ^ dir;
+
+	for (size_t i = 0; i < len; i++) {
+		hash = (hash ^ (uint8_t)name[i]) * 16777619U;
+	}
+
+	return &fs->dcache[hash % CONFIG_EXT2_DENTRY_CACHE_SIZE];
+}
+
+static bool dcache_match(struct ext2_dcache_entry *entry, uint32_t dir, const char *name,
+			 size_t len)
+{
+	return (entry->dir == dir) && (entry->name_len == len) &&
+	       (memcmp(entry->name, name, len) == 0);
+}
+
+bool ext2_dcache_lookup(struct ext2_data *fs, uint32_t dir, const char *name, size_t len,
+			uint32_t *ino, uint32_t *offset)
+{
+	struct ext2_dcache_entry *entry;
+
+	if (len > EXT2_DCACHE_NAME_LEN) {
+		return false;
+	}
+
+	entry = dcache_entry(fs, dir, name, len);
+	if (!dcache_match(entry, dir, name, len)) {
+		return false;
+	}
+
+	*ino = entry->ino;
+	*offset = entry->offset;
+	return true;
+}
+
+void ext2_dcache_add(struct ext2_data *fs, uint32_t dir, const char *name, size_t len,
+		     uint32_t ino, uint32_t offset)
+{
+	struct ext2_dcache_entry *entry;
+
+	if (len > EXT2_DCACHE_NAME_LEN) {
+		return;
+	}
+
+	entry = dcache_entry(fs, dir, name, len);
+	entry->dir = dir;
+	entry->ino = ino;
+	entry->offset = offset;
+	entry->name_len = len;
+	memcpy(entry->name, name, len);
+}
+
+void ext2_dcache_invalidate(struct ext2_data *fs, uint32_t dir, const char *name, size_t len)
+{
+	struct ext2_dcache_entry *entry;
+
+	if (len > EXT2_DCACHE_NAME_LEN) {
+		return;
+	}
+
+	entry = dcache_entry(fs, dir, name, len);
+	if (dcache_match(entry, dir, name, len)) {
+		entry->dir = 0;
+	}
+}
+
+void ext2_dcache_invalidate_dir(struct ext2_data *fs, uint32_t dir)
+{
+	for (int i = 0; i < CONFIG_EXT2_DENTRY_CACHE_SIZE; i++) {
+		if (fs->dcache[i].dir == dir) {
+			fs->dcache[i].dir = 0;
+		}
+	}
+}
+
+#endif /* CONFIG_EXT2_DENTRY_CACHE */
+
+/* Extents ------------------------------------------------------------------ */
+
+#if defined(CONFIG_EXT2_EXTENT_CACHE)
+
+uint32_t ext2_extent_lookup(struct ext2_inode *inode, uint32_t block)
+{
+	struct ext2_extent *ext;
+
+	for (int i = 0; i < CONFIG_EXT2_EXTENT_CACHE_SIZE; i++) {
+		ext = &inode->extents[i];
+
+		if ((block >= ext->e_block) && (block - ext->e_block < ext->e_len)) {
+			return ext->e_start + (block - ext->e_block);
+		}
+	}
+
+	return 0;
+}
+
+void ext2_extent_add(struct ext2_inode *inode, uint32_t block, uint32_t disk_block)
+{
+	struct ext2_extent *ext;
+
+	for (int i = 0; i < CONFIG_EXT2_EXTENT_CACHE_SIZE; i++) {
+		ext = &inode->extents[i];
+
+		if (ext->e_len == 0) {
+			continue;
+		}
+
+		if ((block >= ext->e_block) && (block - ext->e_block < ext->e_len)) {
+			return;
+		}
+
+		if ((block == ext->e_block + ext->e_len) &&
+		    (disk_block == ext->e_start + ext->e_len)) {
+			ext->e_len++;
+			return;
+		}
+	}
+
+	ext = &inode->extents[inode->extent_next];
+	ext->e_block = block;
+	ext->e_start = disk_block;
+	ext->e_len = 1;
+
+	inode->extent_next = (inode->extent_next + 1) % CONFIG_EXT2_EXTENT_CACHE_SIZE;
+}
+
+void ext2_extent_clear(struct ext2_inode *inode)
+{
+	memset(inode->extents, 0, sizeof(inode->extents));
+	inode->extent_next = 0;
+}
+
+#endif /* CONFIG_EXT2_EXTENT_CACHE */
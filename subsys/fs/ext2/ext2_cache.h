@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __EXT2_CACHE_H__
+#define __EXT2_CACHE_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "ext2_struct.h"
+
+/* Caches of the data read while looking files up.
+ *
+ * The inode cache holds the inodes as they were last read from or written to
+ * the inode table. The directory entry cache holds the results of the lookups
+ * of names in directories. The extents hold the disk blocks of inode blocks
+ * which are found through indirect blocks.
+ *
+ * When a cache is disabled, its functions do nothing and its lookups fail.
+ */
+
+#if defined(CONFIG_EXT2_INODE_CACHE)
+
+/**
+ * @brief Fill the inode with its cached copy
+ *
+ * @retval true if the inode was cached
+ * @retval false otherwise
+ */
+bool ext2_icache_fetch(struct ext2_data *fs, uint32_t ino, struct ext2_inode *inode);
+
+/**
+ * @brief Cache the inode, as it has been read from or written to the disk
+ */
+void ext2_icache_store(struct ext2_data *fs, struct ext2_inode *inode);
+
+/**
+ * @brief Save the extents of the inode in its cached copy, if it is cached
+ */
+void ext2_icache_store_extents(struct ext2_data *fs, struct ext2_inode *inode);
+
+/**
+ * @brief Drop the cached copy of the inode
+ */
+void ext2_icache_invalidate(struct ext2_data *fs, uint32_t ino);
+
+#else
+
+static inline bool ext2_icache_fetch(struct ext2_data *fs, uint32_t ino,
+				     struct ext2_inode *inode)
+{
+	return false;
+}
+
+static inline void ext2_icache_store(struct ext2_data *fs, struct ext2_inode *inode)
+{
+}
+
+static inline void ext2_icache_store_extents(struct ext2_data *fs, struct ext2_inode *inode)
+{
+}
+
+static inline void ext2_icache_invalidate(struct ext2_data *fs, uint32_t ino)
+{
+}
+
+#endif /* CONFIG_EXT2_INODE_CACHE */
+
+#if defined(CONFIG_EXT2_DENTRY_CACHE)
+
+/**
+ * @brief Look a name up in the directory entry cache
+ *
+ * @param fs File system data
+ * @param dir Inode number of the directory
+ * @param name Name of the entry
+ * @param len Length of the name
+ * @param ino Set to the inode of the entry, 0 if the directory has no such entry
+ * @param offset Set to the offset of the entry in the directory
+ *
+ * @retval true if the result of the lookup was cached
+ * @retval false otherwise
+ */
+bool ext2_dcache_lookup(struct ext2_data *fs, uint32_t dir, const char *name, size_t len,
+			uint32_t *ino, uint32_t *offset);
+
+/**
+ * @brief Cache the result of the lookup of a name in a directory
+ *
+ * @param ino Inode of the entry, 0 if the directory has no such entry
+ */
+void ext2_dcache_add(struct ext2_data *fs, uint32_t dir, const char *name, size_t len,
+		     uint32_t ino, uint32_t offset);
+
+/**
+ * @brief Drop the cached lookup of a name in a directory
+ */
+void ext2_dcache_invalidate(struct ext2_data *fs, uint32_t dir, const char *name, size_t len);
+
+/**
+ * @brief Drop all the cached lookups in a directory
+ *
+ * Must be called when entries of the directory are removed, renamed or moved.
+ */
+void ext2_dcache_invalidate_dir(struct ext2_data *fs, uint32_t dir);
+
+#else
+
+static inline bool ext2_dcache_lookup(struct ext2_data *fs, uint32_t dir, const char *name,
+				      size_t len, uint32_t *ino, uint32_t *offset)
+{
+	return false;
+}
+
+static inline void ext2_dcache_add(struct ext2_data *fs, uint32_t dir, const char *name,
+				   size_t len, uint32_t ino, uint32_t offset)
+{
+}
+
+static inline void ext2_dcache_invalidate(struct ext2_data *fs, uint32_t dir, const char *name,
+					  size_t len)
+{
+}
+
+static inline void ext2_dcache_invalidate_dir(struct ext2_data *fs, uint32_t dir)
+{
+}
+
+#endif /* CONFIG_EXT2_DENTRY_CACHE */
+
+#if defined(CONFIG_EXT2_EXTENT_CACHE)
+
+/**
+ * @brief Get the disk block of an inode block from the extents of the inode
+ *
+ * @retval >0 disk block
+ * @retval 0 when the inode block isn't in the extents
+ */
+uint32_t ext2_extent_lookup(struct ext2_inode *inode, uint32_t block);
+
+/**
+ * @brief Add the disk block of an inode block to the extents of the inode
+ *
+ * The block extends the run it follows, or starts a new run replacing the
+ * oldest one.
+ */
+void ext2_extent_add(struct ext2_inode *inode, uint32_t block, uint32_t disk_block);
+
+/**
+ * @brief Drop the extents of the inode
+ *
+ * Must be called when blocks of the inode are removed.
+ */
+void ext2_extent_clear(struct ext2_inode *inode);
+
+#else
+
+static inline uint32_t ext2_extent_lookup(struct ext2_inode *inode, uint32_t block)
+{
+	return 0;
+}
+
+static inline void ext2_extent_add(struct ext2_inode *inode, uint32_t block,
+				   uint32_t disk_block)
+{
+}
+
+static inline void ext2_extent_clear(struct ext2_inode *inode)
+{
+}
+
+#endif /* CONFIG_EXT2_EXTENT_CACHE */
+
+#endif /* __EXT2_CACHE_H__ */
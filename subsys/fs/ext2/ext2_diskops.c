@@ -18,6 +18,7 @@
 #include "ext2_impl.h"
 #include "ext2_diskops.h"
 #include "ext2_bitmap.h"
+#include "ext2_cache.h"
 
 LOG_MODULE_DECLARE(ext2);
 
@@ -376,6 +377,12 @@ static int32_t get_itable_entry(struct ext2_data *fs, uint32_t ino)
 
 int ext2_fetch_inode(struct ext2_data *fs, uint32_t ino, struct ext2_inode *inode)
 {
+	if (ext2_icache_fetch(fs, ino, inode)) {
+		inode->i_fs = fs;
+		inode->flags = 0;
+		inode->i_id = ino;
+		return 0;
+	}
 
 	int32_t itable_offset = get_itable_entry(fs, ino);
 
@@ -393,6 +400,9 @@ int ext2_fetch_inode(struct ext2_data *fs, uint32_t ino, struct ext2_inode *inod
 	inode->i_fs = fs;
 	inode->flags = 0;
 	inode->i_id = ino;
+	ext2_extent_clear(inode);
+
+	ext2_icache_store(fs, inode);
 
 	LOG_DBG("mode:%d size:%d links:%d", dino->i_mode, dino->i_size, dino->i_links_count);
 	return 0;
@@ -444,6 +454,26 @@ static int fetch_level_blocks(struct ext2_inode *inode, uint32_t offsets[4], int
 	return fetch_level_blocks(inode, offsets, lvl + 1, max_lvl, try_current);
 }
 
+#if defined(CONFIG_EXT2_EXTENT_CACHE)
+/* Fetch the block of an inode found in its extents, without its indirect blocks. */
+static int fetch_extent_block(struct ext2_inode *inode, uint32_t block, uint32_t disk_block)
+{
+	ext2_inode_drop_blocks(inode);
+
+	inode->blocks[0] = ext2_get_block(inode->i_fs, disk_block);
+	if (inode->blocks[0] == NULL) {
+		return -ENOENT;
+	}
+
+	inode->block_lvl = 0;
+	inode->block_num = block;
+	inode->flags |= INODE_FETCHED_BLOCK | INODE_FETCHED_EXTENT;
+
+	LOG_DBG("[ino:%d fetch]\t extent block:%d num:%d", inode->i_id, block, disk_block);
+	return 0;
+}
+#endif
+
 int ext2_fetch_inode_block(struct ext2_inode *inode, uint32_t block)
 {
 	/* Check if correct inode block is cached. */
@@ -460,16 +490,43 @@ int ext2_fetch_inode_block(struct ext2_inode *inode, uint32_t block)
 
 	max_lvl = get_level_offsets(fs, block, offsets);
 
+#if defined(CONFIG_EXT2_EXTENT_CACHE)
+	/* Levels above the block fetched from an extent weren't fetched */
+	if (inode->flags & INODE_FETCHED_EXTENT) {
+		try_current = false;
+	}
+
+	/* Use the extents only if some indirect block would have to be read */
+	if ((max_lvl > 0) &&
+	    !(try_current && (inode->block_lvl == max_lvl) &&
+	      (memcmp(offsets, inode->offsets, max_lvl * sizeof(uint32_t)) == 0))) {
+		uint32_t disk_block = ext2_extent_lookup(inode, block);
+
+		if (disk_block != 0) {
+			ret = fetch_extent_block(inode, block, disk_block);
+			if (ret < 0) {
+				ext2_inode_drop_blocks(inode);
+			}
+			return ret;
+		}
+	}
+#endif
+
 	ret = fetch_level_blocks(inode, offsets, 0, max_lvl, try_current);
 	if (ret < 0) {
 		ext2_inode_drop_blocks(inode);
 		return ret;
 	}
 
+	if ((max_lvl > 0) && (inode->blocks[max_lvl]->flags & EXT2_BLOCK_ASSIGNED)) {
+		ext2_extent_add(inode, block, inode->blocks[max_lvl]->num);
+	}
+
 	memcpy(inode->offsets, offsets, MAX_OFFSETS_SIZE * sizeof(uint32_t));
 	inode->block_lvl = max_lvl;
 	inode->block_num = block;
 	inode->flags |= INODE_FETCHED_BLOCK;
+	inode->flags &= ~INODE_FETCHED_EXTENT;
 
 	LOG_DBG("[ino:%d fetch]\t Lvl:%d {%d, %d, %d, %d}", inode->i_id, inode->block_lvl,
 			inode->offsets[0], inode->offsets[1], inode->offsets[2], inode->offsets[3]);
@@ -667,6 +724,12 @@ int64_t ext2_inode_remove_blocks(struct ext2_inode *inode, uint32_t first)
 	uint32_t offsets[4];
 	struct ext2_data *fs = inode->i_fs;
 
+	/* Removed blocks must not be found in the extents anymore */
+	ext2_extent_clear(inode);
+	if (inode->flags & INODE_FETCHED_EXTENT) {
+		ext2_inode_drop_blocks(inode);
+	}
+
 	max_lvl = get_level_offsets(inode->i_fs, first, offsets);
 
 	if (all_zero(&offsets[1], max_lvl)) {
@@ -830,7 +893,15 @@ int ext2_commit_inode(struct ext2_inode *inode)
 	/* fill dinode */
 	fill_disk_inode(dino, inode);
 
-	return ext2_write_block(fs, fs->bgroup.inode_table);
+	int ret = ext2_write_block(fs, fs->bgroup.inode_table);
+
+	if (ret < 0) {
+		ext2_icache_invalidate(fs, inode->i_id);
+		return ret;
+	}
+
+	ext2_icache_store(fs, inode);
+	return 0;
 }
 
 int ext2_commit_inode_block(struct ext2_inode *inode)
@@ -843,9 +914,12 @@ int ext2_commit_inode_block(struct ext2_inode *inode)
 
 	LOG_DBG("inode:%d current_blk:%d", inode->i_id, inode->block_num);
 
-	ret = alloc_level_blocks(inode);
-	if (ret < 0) {
-		return ret;
+	/* Blocks are found in the extents only once they are allocated */
+	if (!(inode->flags & INODE_FETCHED_EXTENT)) {
+		ret = alloc_level_blocks(inode);
+		if (ret < 0) {
+			return ret;
+		}
 	}
 	ret = ext2_write_block(inode->i_fs, inode_current_block(inode));
 	return ret;
@@ -860,6 +934,8 @@ int ext2_clear_inode(struct ext2_data *fs, uint32_t ino)
 		return itable_offset;
 	}
 
+	ext2_icache_invalidate(fs, ino);
+
 	memset(&BGROUP_INODE_TABLE(&fs->bgroup)[itable_offset], 0, sizeof(struct ext2_disk_inode));
 	ret = ext2_write_block(fs, fs->bgroup.inode_table);
 	return ret;
@@ -1113,6 +1189,11 @@ int ext2_free_inode(struct ext2_data *fs, uint32_t ino, bool directory)
 		return rc;
 	}
 
+	/* The inode number may be given to a new directory */
+	if (directory) {
+		ext2_dcache_invalidate_dir(fs, ino);
+	}
+
 	rc = ext2_bitmap_unset(BGROUP_INODE_BITMAP(&fs->bgroup), bitmap_off, fs->block_size);
 	if (rc < 0) {
 		return rc;
@@ -16,6 +16,7 @@
 #include "ext2_struct.h"
 #include "ext2_diskops.h"
 #include "ext2_bitmap.h"
+#include "ext2_cache.h"
 
 LOG_MODULE_REGISTER(ext2, CONFIG_EXT2_LOG_LEVEL);
 
@@ -402,7 +403,7 @@ int ext2_close_struct(struct ext2_data *fs)
 /* Functions needed by lookup inode */
 static const char *skip_slash(const char *str);
 static char *strchrnul(const char *str, const char c);
-static int64_t find_dir_entry(struct ext2_inode *inode, const char *name, size_t len,
+static int64_t lookup_dir_entry(struct ext2_inode *inode, const char *name, size_t len,
 		uint32_t *r_offset);
 
 int ext2_lookup_inode(struct ext2_data *fs, struct ext2_lookup_args *args)
@@ -448,7 +449,7 @@ int ext2_lookup_inode(struct ext2_data *fs, struct ext2_lookup_args *args)
 		/* Search in current directory */
 		uint32_t dir_off = 0;
 		/* using 64 bit value to don't lose any information on error */
-		int64_t ino = find_dir_entry(cur_dir, name_buf, len, &dir_off);
+		int64_t ino = lookup_dir_entry(cur_dir, name_buf, len, &dir_off);
 
 		const char *next_path = skip_slash(end);
 		bool last_entry = next_path[0] == '\0';
@@ -598,12 +599,43 @@ static int64_t find_dir_entry(struct ext2_inode *inode, const char *name, size_t
 		k_heap_free(&direntry_heap, de);
 	}
 
-	return -EINVAL;
+	return -ENOENT;
 success:
 	k_heap_free(&direntry_heap, de);
 	return (int64_t)ino;
 }
 
+/**
+ * @brief Find inode, going through the directory entry cache
+ *
+ * @return Inode number or negative error code
+ */
+static int64_t lookup_dir_entry(struct ext2_inode *inode, const char *name, size_t len,
+		uint32_t *r_offset)
+{
+	struct ext2_data *fs = inode->i_fs;
+	uint32_t ino, offset;
+	int64_t ret;
+
+	if (ext2_dcache_lookup(fs, inode->i_id, name, len, &ino, &offset)) {
+		if (ino == 0) {
+			return -ENOENT;
+		}
+		*r_offset = offset;
+		return ino;
+	}
+
+	ret = find_dir_entry(inode, name, len, &offset);
+	if (ret > 0) {
+		ext2_dcache_add(fs, inode->i_id, name, len, ret, offset);
+		*r_offset = offset;
+	} else if (ret == -ENOENT) {
+		/* Remember that the name isn't in the directory */
+		ext2_dcache_add(fs, inode->i_id, name, len, 0, 0);
+	}
+	return ret;
+}
+
 /* Inode operations --------------------------------------------------------- */
 
 ssize_t ext2_inode_read(struct ext2_inode *inode, void *buf, uint32_t offset, size_t nbytes)
@@ -887,6 +919,7 @@ static int ext2_create_inode(struct ext2_data *fs, struct ext2_inode *parent,
 	inode->i_mode = type == FS_DIR_ENTRY_FILE ? EXT2_DEF_FILE_MODE : EXT2_DEF_DIR_MODE;
 	inode->i_links_count = 0;
 	memset(inode->i_block, 0, 15 * 4);
+	ext2_extent_clear(inode);
 
 	if (type == FS_DIR_ENTRY_DIR) {
 		/* Block group current block is already fetched. We don't have to do it again.
@@ -942,6 +975,9 @@ static int ext2_add_direntry(struct ext2_inode *dir, struct ext2_direntry *entry
 		return -EINVAL;
 	}
 
+	/* The name may be cached as missing from the directory */
+	ext2_dcache_invalidate(dir->i_fs, dir->i_id, entry->de_name, entry->de_name_len);
+
 	/* Find last entry */
 	/* get last block and start from first entry on that block */
 	int last_blk = (dir->i_size / block_size) - 1;
@@ -1143,6 +1179,9 @@ static int ext2_del_direntry(struct ext2_inode *parent, uint32_t offset)
 	uint32_t blk = offset / block_size;
 	uint32_t blk_off = offset % block_size;
 
+	/* Entries may move to other offsets */
+	ext2_dcache_invalidate_dir(parent->i_fs, parent->i_id);
+
 	rc = ext2_fetch_inode_block(parent, blk);
 	if (rc < 0) {
 		return rc;
@@ -1164,6 +1203,7 @@ static int ext2_del_direntry(struct ext2_inode *parent, uint32_t offset)
 			 */
 			parent->i_block[blk] = parent->i_block[last_blk];
 			parent->i_block[last_blk] = 0;
+			ext2_extent_clear(parent);
 
 			/* Free removed block */
 			rc = ext2_free_block(parent->i_fs, old_blk);
@@ -1346,6 +1386,9 @@ int ext2_replace_file(struct ext2_lookup_args *args_from, struct ext2_lookup_arg
 	uint32_t to_blk = to_offset / block_size;
 	uint32_t to_blk_off = to_offset % block_size;
 
+	/* The destination entry will point to another inode */
+	ext2_dcache_invalidate_dir(args_to->parent->i_fs, args_to->parent->i_id);
+
 	rc = ext2_fetch_inode_block(args_to->parent, to_blk);
 	if (rc < 0) {
 		return rc;
@@ -1391,6 +1434,7 @@ int ext2_move_file(struct ext2_lookup_args *args_from, struct ext2_lookup_args *
 		/* If new name fits in old entry, then just copy it there */
 		if (reclen - sizeof(struct ext2_disk_direntry) >= args_to->name_len) {
 			LOG_DBG("Old entry is modified to hold new name");
+			ext2_dcache_invalidate_dir(fparent->i_fs, fparent->i_id);
 			ext2_set_disk_direntry_namelen(de, args_to->name_len);
 			ext2_set_disk_direntry_name(de, args_to->path + args_to->name_pos,
 					args_to->name_len);
@@ -1521,6 +1565,9 @@ int ext2_inode_drop(struct ext2_inode *inode)
 			if (rc < 0) {
 				return rc;
 			}
+		} else {
+			/* Keep the extents for the next time the inode is used */
+			ext2_icache_store_extents(fs, inode);
 		}
 
 		k_mem_slab_free(&inode_struct_slab, (void *)inode);
@@ -1540,6 +1587,7 @@ void ext2_inode_drop_blocks(struct ext2_inode *inode)
 {
 	for (int i = 0; i < 4; ++i) {
 		ext2_drop_block(inode->blocks[i]);
+		inode->blocks[i] = NULL;
 	}
-	inode->flags &= ~INODE_FETCHED_BLOCK;
+	inode->flags &= ~(INODE_FETCHED_BLOCK | INODE_FETCHED_EXTENT);
 }
@@ -163,6 +163,15 @@ struct ext2_bgroup {
 /* Flags for inode */
 #define INODE_FETCHED_BLOCK BIT(0)
 #define INODE_REMOVE BIT(1)
+/* Fetched block was found in the extents, its indirect blocks aren't fetched */
+#define INODE_FETCHED_EXTENT BIT(2)
+
+/* Run of inode blocks stored in consecutive disk blocks */
+struct ext2_extent {
+	uint32_t e_block; /* first inode block of the run */
+	uint32_t e_start; /* disk block of the first inode block */
+	uint32_t e_len;   /* number of blocks, 0 if unused */
+};
 
 struct ext2_inode {
 	struct ext2_data *i_fs;      /* pointer to file system data */
@@ -180,6 +189,11 @@ struct ext2_inode {
 	uint32_t block_num;        /* relative number of fetched block */
 	uint32_t offsets[4];       /* offsets describing path to fetched block */
 	struct ext2_block *blocks[4];   /* fetched blocks for each level */
+
+#if defined(CONFIG_EXT2_EXTENT_CACHE)
+	struct ext2_extent extents[CONFIG_EXT2_EXTENT_CACHE_SIZE];
+	uint8_t extent_next;       /* extent replaced by the next new run */
+#endif
 };
 
 static inline struct ext2_block *inode_current_block(struct ext2_inode *inode)
@@ -226,6 +240,31 @@ struct ext2_backend_ops {
 
 #define MAX_INODES (CONFIG_MAX_FILES + 2)
 
+/* Copy of an inode, as written on the disk */
+struct ext2_icache_entry {
+	uint32_t ino;              /* inode number, 0 if unused */
+	uint16_t i_mode;
+	uint16_t i_links_count;
+	uint32_t i_size;
+	uint32_t i_blocks;
+	uint32_t i_block[15];
+#if defined(CONFIG_EXT2_EXTENT_CACHE)
+	struct ext2_extent extents[CONFIG_EXT2_EXTENT_CACHE_SIZE];
+#endif
+};
+
+/* Longest name kept in the directory entry cache */
+#define EXT2_DCACHE_NAME_LEN 27
+
+/* Result of the lookup of a name in a directory */
+struct ext2_dcache_entry {
+	uint32_t dir;              /* inode of the directory, 0 if unused */
+	uint32_t ino;              /* inode of the entry, 0 if there is no such entry */
+	uint32_t offset;           /* offset of the entry in the directory */
+	uint8_t name_len;
+	char name[EXT2_DCACHE_NAME_LEN];
+};
+
 struct ext2_data {
 	struct ext2_superblock sblock; /* superblock */
 	struct ext2_bgroup bgroup;     /* block group */
@@ -243,6 +282,13 @@ struct ext2_data {
 	void *backend; /* pointer to implementation specific resource */
 	const struct ext2_backend_ops *backend_ops;
 	uint8_t flags;
+
+#if defined(CONFIG_EXT2_INODE_CACHE)
+	struct ext2_icache_entry icache[CONFIG_EXT2_INODE_CACHE_SIZE];
+#endif
+#if defined(CONFIG_EXT2_DENTRY_CACHE)
+	struct ext2_dcache_entry dcache[CONFIG_EXT2_DENTRY_CACHE_SIZE];
+#endif
 };
 
 #endif /* __EXT2_STRUCT_H__ */
@@ -0,0 +1,1627 @@
+/*  KVS: log-structured key-value store in flash
+ *
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/drivers/flash.h>
+#include <string.h>
+#include <errno.h>
+#include <zephyr/fs/kvs.h>
+#include <zephyr/sys/crc.h>
+#include "kvs_priv.h"
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(fs_kvs, CONFIG_KVS_LOG_LEVEL);
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_KVS_INDEX_SIZE), "KVS index size must be a power of 2");
+
+#define KVS_INDEX_MASK (CONFIG_KVS_INDEX_SIZE - 1)
+
+/* Index changes made by a record, to take them back if its value turns out to be incomplete */
+struct kvs_undo {
+	int slot;
+	/* address and record size the entry had, KVS_INDEX_EMPTY if the key was added */
+	uint32_t addr;
+	uint32_t size;
+};
+
+/* Mount scratch, the keys of the records are read to look them up */
+struct kvs_scan {
+	uint8_t key[CONFIG_KVS_KEY_MAX_LEN];
+	/* records of the batch being read, applied once its commit record is read */
+	uint32_t batch[CONFIG_KVS_BATCH_MAX_ENTRIES];
+	uint16_t batch_count;
+	bool in_batch;
+};
+
+/* Record body writer, the key and the value are written through it one after the other */
+struct kvs_writer {
+	uint32_t addr;
+	size_t fill;
+	uint8_t buf[KVS_BLOCK_SIZE];
+};
+
+/* basic routines */
+/* FNV-1a, the hash of a key can be calculated a block at a time */
+#define KVS_HASH_INIT 0x811c9dc5
+
+static uint32_t kvs_hash_update(uint32_t hash, const void *data, size_t len)
+{
+	const uint8_t *data8 = (const uint8_t *)data;
+
+	for (size_t i = 0; i < len; i++) {
+		hash ^= data8[i];
+		hash *= 0x01000193;
+	}
+
+	return hash;
+}
+
+/* kvs_al_size returns size aligned to fs->write_block_size */
+static inline size_t kvs_al_size(struct kvs_fs *fs, size_t len)
+{
+	size_t write_block_size = fs->flash_parameters->write_block_size;
+
+	if (write_block_size <= 1U) {
+		return len;
+	}
+	return (len + (write_block_size - 1U)) & ~(write_block_size - 1U);
+}
+
+/* size a record takes in flash */
+static inline uint32_t kvs_rec_size(struct kvs_fs *fs, size_t key_len, size_t len)
+{
+	return KVS_HDR_SIZE + kvs_al_size(fs, key_len + len);
+}
+
+static inline uint32_t kvs_sector_addr(struct kvs_fs *fs, uint16_t sector)
+{
+	return (uint32_t)sector * fs->sector_size;
+}
+
+static inline uint16_t kvs_addr_sector(struct kvs_fs *fs, uint32_t addr)
+{
+	return addr / fs->sector_size;
+}
+
+static inline uint32_t kvs_sector_end(struct kvs_fs *fs, uint32_t addr)
+{
+	return kvs_sector_addr(fs, kvs_addr_sector(fs, addr)) + fs->sector_size;
+}
+
+static bool kvs_is_erased(struct kvs_fs *fs, const void *data, size_t len)
+{
+	const uint8_t *data8 = (const uint8_t *)data;
+
+	for (size_t i = 0; i < len; i++) {
+		if (data8[i] != fs->flash_parameters->erase_value) {
+			return false;
+		}
+	}
+
+	return true;
+}
+/* end basic routines */
+
+/* flash routines */
+static int kvs_flash_rd(struct kvs_fs *fs, uint32_t addr, void *data, size_t len)
+{
+	return flash_read(fs->flash_device, fs->offset + addr, data, len);
+}
+
+/* len has to be a multiple of the write block size */
+static int kvs_flash_wrt(struct kvs_fs *fs, uint32_t addr, const void *data, size_t len)
+{
+	return flash_write(fs->flash_device, fs->offset + addr, data, len);
+}
+
+static int kvs_writer_put(struct kvs_fs *fs, struct kvs_writer *wr, const void *data, size_t len)
+{
+	const uint8_t *data8 = (const uint8_t *)data;
+	size_t write_block_size = fs->flash_parameters->write_block_size;
+	size_t blen, wlen;
+	int rc;
+
+	while (len) {
+		if (!wr->fill && len >= write_block_size) {
+			/* whole write blocks are written as they are */
+			blen = len & ~(write_block_size - 1U);
+			wlen = blen;
+			rc = kvs_flash_wrt(fs, wr->addr, data8, wlen);
+			if (rc) {
+				return rc;
+			}
+		} else {
+			blen = MIN(len, sizeof(wr->buf) - wr->fill);
+			memcpy(&wr->buf[wr->fill], data8, blen);
+			wr->fill += blen;
+			if (wr->fill < sizeof(wr->buf)) {
+				return 0;
+			}
+
+			/* the buffer holds data put before, it is written from
+			 * wr->addr on as a whole
+			 */
+			wlen = sizeof(wr->buf);
+			rc = kvs_flash_wrt(fs, wr->addr, wr->buf, wlen);
+			if (rc) {
+				return rc;
+			}
+			wr->fill = 0;
+		}
+
+		wr->addr += wlen;
+		data8 += blen;
+		len -= blen;
+	}
+
+	return 0;
+}
+
+static int kvs_writer_flush(struct kvs_fs *fs, struct kvs_writer *wr)
+{
+	size_t len;
+
+	if (!wr->fill) {
+		return 0;
+	}
+
+	len = kvs_al_size(fs, wr->fill);
+	(void)memset(&wr->buf[wr->fill], fs->flash_parameters->erase_value, len - wr->fill);
+	wr->fill = 0;
+
+	return kvs_flash_wrt(fs, wr->addr, wr->buf, len);
+}
+
+/* kvs_flash_cmp compares the data in flash at addr to data,
+ * returns 0 if equal, 1 if not equal, errcode if error
+ */
+static int kvs_flash_cmp(struct kvs_fs *fs, uint32_t addr, const void *data, size_t len)
+{
+	const uint8_t *data8 = (const uint8_t *)data;
+	uint8_t buf[KVS_BLOCK_SIZE];
+	size_t bytes_to_cmp;
+	int rc;
+
+	while (len) {
+		bytes_to_cmp = MIN(sizeof(buf), len);
+		rc = kvs_flash_rd(fs, addr, buf, bytes_to_cmp);
+		if (rc) {
+			return rc;
+		}
+		if (memcmp(data8, buf, bytes_to_cmp)) {
+			return 1;
+		}
+		len -= bytes_to_cmp;
+		addr += bytes_to_cmp;
+		data8 += bytes_to_cmp;
+	}
+
+	return 0;
+}
+/* end flash routines */
+
+/* sector routines */
+/* erase a sector and write its format header */
+static int kvs_sector_erase(struct kvs_fs *fs, uint16_t sector)
+{
+	struct kvs_sector *sec = &fs->sectors[sector];
+	struct kvs_format_hdr hdr;
+	int rc;
+
+	LOG_DBG("Erasing sector %u", sector);
+
+	rc = flash_erase(fs->flash_device, fs->offset + kvs_sector_addr(fs, sector),
+			 fs->sector_size);
+	if (rc) {
+		return rc;
+	}
+
+	sec->erase_count++;
+
+	hdr.magic = KVS_MAGIC;
+	hdr.erase_count = sec->erase_count;
+	hdr.sector_size = fs->sector_size;
+	hdr.crc32 = crc32_ieee((const uint8_t *)&hdr, offsetof(struct kvs_format_hdr, crc32));
+
+	rc = kvs_flash_wrt(fs, kvs_sector_addr(fs, sector), &hdr, sizeof(hdr));
+	if (rc) {
+		return rc;
+	}
+
+	sec->state = KVS_SECTOR_FREE;
+
+	return 0;
+}
+
+/* take the free sector erased the fewest times and start writing records to it */
+static int kvs_sector_open(struct kvs_fs *fs)
+{
+	struct kvs_open_hdr hdr = {0};
+	struct kvs_sector *sec;
+	uint16_t sector = fs->sector_count;
+	int rc;
+
+	for (uint16_t i = 0; i < fs->sector_count; i++) {
+		if (fs->sectors[i].state == KVS_SECTOR_USED) {
+			continue;
+		}
+
+		if ((sector == fs->sector_count) ||
+		    (fs->sectors[i].erase_count < fs->sectors[sector].erase_count)) {
+			sector = i;
+		}
+	}
+
+	if (sector == fs->sector_count) {
+		return -ENOSPC;
+	}
+
+	sec = &fs->sectors[sector];
+	if (sec->state == KVS_SECTOR_BLANK) {
+		rc = kvs_sector_erase(fs, sector);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	hdr.seq = fs->seq + 1;
+	hdr.crc32 = crc32_ieee((const uint8_t *)&hdr, offsetof(struct kvs_open_hdr, crc32));
+
+	rc = kvs_flash_wrt(fs, kvs_sector_addr(fs, sector) + KVS_HDR_SIZE, &hdr, sizeof(hdr));
+	if (rc) {
+		/* the open header may be partly written */
+		sec->state = KVS_SECTOR_BLANK;
+		return rc;
+	}
+
+	fs->seq = hdr.seq;
+	sec->seq = hdr.seq;
+	sec->live = 0;
+	sec->state = KVS_SECTOR_USED;
+	fs->free_count--;
+
+	fs->head = sector;
+	fs->wra = kvs_sector_addr(fs, sector) + KVS_DATA_OFFSET;
+
+	return 0;
+}
+
+/* the sector in use opened first, fs->sector_count if there is none */
+static uint16_t kvs_sector_oldest(struct kvs_fs *fs)
+{
+	uint16_t sector = fs->sector_count;
+
+	for (uint16_t i = 0; i < fs->sector_count; i++) {
+		if (fs->sectors[i].state != KVS_SECTOR_USED) {
+			continue;
+		}
+
+		if ((sector == fs->sector_count) || (fs->sectors[i].seq < fs->sectors[sector].seq)) {
+			sector = i;
+		}
+	}
+
+	return sector;
+}
+
+static uint32_t kvs_head_room(struct kvs_fs *fs)
+{
+	if (fs->sectors[fs->head].state != KVS_SECTOR_USED) {
+		return 0;
+	}
+
+	return kvs_sector_addr(fs, fs->head) + fs->sector_size - fs->wra;
+}
+
+/* nothing is written to the head sector anymore */
+static void kvs_head_close(struct kvs_fs *fs)
+{
+	fs->wra = kvs_sector_addr(fs, fs->head) + fs->sector_size;
+}
+
+static inline void kvs_live_add(struct kvs_fs *fs, uint32_t addr, uint32_t size)
+{
+	fs->sectors[kvs_addr_sector(fs, addr)].live += size;
+}
+
+static inline void kvs_live_sub(struct kvs_fs *fs, uint32_t addr, uint32_t size)
+{
+	fs->sectors[kvs_addr_sector(fs, addr)].live -= size;
+}
+/* end sector routines */
+
+/* record routines */
+/* kvs_rec_read reads the record header at addr and checks it against its key.
+ * The key is copied to key when it is not NULL. plain_crc, when not NULL, is
+ * set to the crc32 of the header without the batch flags.
+ * returns 0 if the record is valid, 1 if the header is erased, -EBADMSG if
+ * the record is not valid, errcode if error
+ */
+static int kvs_rec_read(struct kvs_fs *fs, uint32_t addr, struct kvs_rec *rec, uint8_t *key,
+			uint32_t *hash, uint32_t *plain_crc)
+{
+	uint8_t buf[KVS_BLOCK_SIZE];
+	struct kvs_rec plain;
+	const uint8_t *p;
+	size_t avail, chunk;
+	uint32_t crc, pcrc, h;
+	uint8_t type;
+	int rc;
+
+	avail = MIN(sizeof(buf), kvs_sector_end(fs, addr) - addr);
+	rc = kvs_flash_rd(fs, addr, buf, avail);
+	if (rc) {
+		return rc;
+	}
+
+	if (kvs_is_erased(fs, buf, KVS_HDR_SIZE)) {
+		return 1;
+	}
+
+	memcpy(rec, buf, sizeof(*rec));
+
+	type = rec->type & KVS_REC_TYPE_MASK;
+	if ((type < KVS_REC_DATA) || (type > KVS_REC_COMMIT) ||
+	    (rec->key_len > CONFIG_KVS_KEY_MAX_LEN) ||
+	    (kvs_rec_size(fs, rec->key_len, rec->len) > kvs_sector_end(fs, addr) - addr)) {
+		return -EBADMSG;
+	}
+
+	plain = *rec;
+	plain.type = type;
+	crc = crc32_ieee(buf, offsetof(struct kvs_rec, crc32));
+	pcrc = crc32_ieee((const uint8_t *)&plain, offsetof(struct kvs_rec, crc32));
+	h = KVS_HASH_INIT;
+
+	p = &buf[KVS_HDR_SIZE];
+	avail -= KVS_HDR_SIZE;
+	for (size_t pos = 0; pos < rec->key_len; pos += chunk) {
+		if (!avail) {
+			avail = MIN(sizeof(buf), rec->key_len - pos);
+			rc = kvs_flash_rd(fs, addr + KVS_HDR_SIZE + pos, buf, avail);
+			if (rc) {
+				return rc;
+			}
+			p = buf;
+		}
+
+		chunk = MIN(avail, rec->key_len - pos);
+		crc = crc32_ieee_update(crc, p, chunk);
+		pcrc = crc32_ieee_update(pcrc, p, chunk);
+		h = kvs_hash_update(h, p, chunk);
+		if (key) {
+			memcpy(&key[pos], p, chunk);
+		}
+
+		p += chunk;
+		avail -= chunk;
+	}
+
+	if (crc != rec->crc32) {
+		return -EBADMSG;
+	}
+
+	*hash = h;
+	if (plain_crc) {
+		*plain_crc = pcrc;
+	}
+
+	return 0;
+}
+
+/* kvs_rec_val_check checks the value of the record at addr against its crc.
+ * returns 0 if it is intact, -EBADMSG if not, errcode if error
+ */
+static int kvs_rec_val_check(struct kvs_fs *fs, uint32_t addr, const struct kvs_rec *rec)
+{
+	uint8_t buf[KVS_BLOCK_SIZE];
+	uint32_t crc = 0;
+	size_t chunk;
+	int rc;
+
+	addr += KVS_HDR_SIZE + rec->key_len;
+	for (size_t pos = 0; pos < rec->len; pos += chunk) {
+		chunk = MIN(sizeof(buf), rec->len - pos);
+		rc = kvs_flash_rd(fs, addr + pos, buf, chunk);
+		if (rc) {
+			return rc;
+		}
+		crc = crc32_ieee_update(crc, buf, chunk);
+	}
+
+	return (crc == rec->val_crc32) ? 0 : -EBADMSG;
+}
+
+/* kvs_rec_key_cmp reads the header of the record at addr and compares its key
+ * to key, returns 0 if equal, 1 if not equal, errcode if error
+ */
+static int kvs_rec_key_cmp(struct kvs_fs *fs, uint32_t addr, struct kvs_rec *rec,
+			   const void *key, size_t key_len)
+{
+	uint8_t buf[KVS_BLOCK_SIZE];
+	size_t len;
+	int rc;
+
+	/* short keys are read along with the header */
+	len = MIN(sizeof(buf), KVS_HDR_SIZE + key_len);
+	len = MIN(len, kvs_sector_end(fs, addr) - addr);
+	rc = kvs_flash_rd(fs, addr, buf, len);
+	if (rc) {
+		return rc;
+	}
+
+	memcpy(rec, buf, sizeof(*rec));
+	if (rec->key_len != key_len) {
+		return 1;
+	}
+
+	len -= KVS_HDR_SIZE;
+	if (memcmp(&buf[KVS_HDR_SIZE], key, len)) {
+		return 1;
+	}
+
+	return kvs_flash_cmp(fs, addr + KVS_HDR_SIZE + len, (const uint8_t *)key + len,
+			     key_len - len);
+}
+
+/* record written or moved, only to be called once it is completely written */
+static void kvs_rec_done(struct kvs_fs *fs, uint32_t size)
+{
+	fs->wra += size;
+}
+
+/* write a record at the write address, the caller makes sure it fits */
+static int kvs_rec_wrt(struct kvs_fs *fs, struct kvs_rec *rec, const void *key,
+		       const void *data, uint32_t *addr)
+{
+	struct kvs_writer wr;
+	uint32_t size;
+	int rc;
+
+	rec->reserved = 0;
+	rec->crc32 = crc32_ieee((const uint8_t *)rec, offsetof(struct kvs_rec, crc32));
+	rec->crc32 = crc32_ieee_update(rec->crc32, key, rec->key_len);
+
+	/* the header is written first, a record whose header is erased was not
+	 * written at all.
+	 */
+	rc = kvs_flash_wrt(fs, fs->wra, rec, sizeof(*rec));
+	if (!rc) {
+		wr.addr = fs->wra + KVS_HDR_SIZE;
+		wr.fill = 0;
+		rc = kvs_writer_put(fs, &wr, key, rec->key_len);
+	}
+	if (!rc) {
+		rc = kvs_writer_put(fs, &wr, data, rec->len);
+	}
+	if (!rc) {
+		rc = kvs_writer_flush(fs, &wr);
+	}
+	if (rc) {
+		/* nothing is written after a record that may be incomplete */
+		kvs_head_close(fs);
+		return rc;
+	}
+
+	size = kvs_rec_size(fs, rec->key_len, rec->len);
+	*addr = fs->wra;
+	kvs_rec_done(fs, size);
+	fs->stats.written += size;
+
+	return 0;
+}
+
+/* copy the record at addr to the write address, the caller makes sure it fits */
+static int kvs_rec_move(struct kvs_fs *fs, uint32_t addr, const struct kvs_rec *rec,
+			uint32_t plain_crc, uint32_t *new_addr)
+{
+	uint8_t buf[KVS_BLOCK_SIZE];
+	struct kvs_writer wr;
+	struct kvs_rec plain;
+	size_t len, chunk;
+	uint32_t size;
+	int rc;
+
+	/* the copy of a record of a batch is a record of its own */
+	plain = *rec;
+	plain.type &= KVS_REC_TYPE_MASK;
+	plain.crc32 = plain_crc;
+
+	rc = kvs_flash_wrt(fs, fs->wra, &plain, sizeof(plain));
+
+	wr.addr = fs->wra + KVS_HDR_SIZE;
+	wr.fill = 0;
+	len = rec->key_len + rec->len;
+	for (size_t pos = 0; !rc && (pos < len); pos += chunk) {
+		chunk = MIN(sizeof(buf), len - pos);
+		rc = kvs_flash_rd(fs, addr + KVS_HDR_SIZE + pos, buf, chunk);
+		if (!rc) {
+			rc = kvs_writer_put(fs, &wr, buf, chunk);
+		}
+	}
+	if (!rc) {
+		rc = kvs_writer_flush(fs, &wr);
+	}
+	if (rc) {
+		kvs_head_close(fs);
+		return rc;
+	}
+
+	size = kvs_rec_size(fs, rec->key_len, rec->len);
+	*new_addr = fs->wra;
+	kvs_rec_done(fs, size);
+	fs->stats.moved += size;
+
+	return 0;
+}
+/* end record routines */
+
+/* index routines */
+/* kvs_index_find looks a key up, returns its index slot and reads the header
+ * of its record, -ENOENT if the key is not found, errcode if error
+ */
+static int kvs_index_find(struct kvs_fs *fs, uint32_t hash, const void *key, size_t key_len,
+			  struct kvs_rec *rec)
+{
+	struct kvs_index_entry *entry;
+	uint32_t slot;
+	int rc;
+
+	for (uint32_t i = 0; i < CONFIG_KVS_INDEX_SIZE; i++) {
+		slot = (hash + i) & KVS_INDEX_MASK;
+		entry = &fs->index[slot];
+
+		if (entry->addr == KVS_INDEX_EMPTY) {
+			break;
+		}
+
+		if ((entry->addr == KVS_INDEX_DELETED) || (entry->hash != hash)) {
+			continue;
+		}
+
+		rc = kvs_rec_key_cmp(fs, entry->addr, rec, key, key_len);
+		if (rc < 0) {
+			return rc;
+		}
+		if (rc == 0) {
+			return slot;
+		}
+	}
+
+	return -ENOENT;
+}
+
+/* index slot of the record at addr, -ENOENT if the record is not in use */
+static int kvs_index_find_addr(struct kvs_fs *fs, uint32_t hash, uint32_t addr)
+{
+	uint32_t slot;
+
+	for (uint32_t i = 0; i < CONFIG_KVS_INDEX_SIZE; i++) {
+		slot = (hash + i) & KVS_INDEX_MASK;
+
+		if (fs->index[slot].addr == KVS_INDEX_EMPTY) {
+			break;
+		}
+
+		if (fs->index[slot].addr == addr) {
+			return slot;
+		}
+	}
+
+	return -ENOENT;
+}
+
+/* add a key that is not in the index, returns its slot or -ENOSPC */
+static int kvs_index_insert(struct kvs_fs *fs, uint32_t hash, uint32_t addr)
+{
+	struct kvs_index_entry *entry;
+	uint32_t slot;
+
+	for (uint32_t i = 0; i < CONFIG_KVS_INDEX_SIZE; i++) {
+		slot = (hash + i) & KVS_INDEX_MASK;
+		entry = &fs->index[slot];
+
+		if (entry->addr >= KVS_INDEX_DELETED) {
+			entry->hash = hash;
+			entry->addr = addr;
+			fs->stats.keys++;
+			return slot;
+		}
+	}
+
+	return -ENOSPC;
+}
+
+/* Entries never move, so that kvs_walk() can release the file system between
+ * them. A removed entry is marked deleted, unless no lookup has to go past it.
+ */
+static void kvs_index_remove(struct kvs_fs *fs, uint32_t slot)
+{
+	fs->index[slot].addr = KVS_INDEX_DELETED;
+	fs->stats.keys--;
+
+	if (fs->index[(slot + 1) & KVS_INDEX_MASK].addr != KVS_INDEX_EMPTY) {
+		return;
+	}
+
+	while (fs->index[slot].addr == KVS_INDEX_DELETED) {
+		fs->index[slot].addr = KVS_INDEX_EMPTY;
+		slot = (slot - 1) & KVS_INDEX_MASK;
+	}
+}
+
+/* point the index to the record rec written at addr, slot and old are the
+ * index slot and the record header of the key if it was found.
+ */
+static int kvs_index_update(struct kvs_fs *fs, int slot, uint32_t hash, uint32_t addr,
+			    const struct kvs_rec *old, const struct kvs_rec *rec,
+			    struct kvs_undo *undo)
+{
+	bool delete = ((rec->type & KVS_REC_TYPE_MASK) == KVS_REC_DELETE);
+	uint32_t old_addr = KVS_INDEX_EMPTY;
+	uint32_t old_size = 0;
+
+	if (slot >= 0) {
+		old_addr = fs->index[slot].addr;
+		old_size = kvs_rec_size(fs, old->key_len, old->len);
+		kvs_live_sub(fs, old_addr, old_size);
+
+		if (delete) {
+			kvs_index_remove(fs, slot);
+			return 0;
+		}
+
+		fs->index[slot].addr = addr;
+	} else {
+		if (delete) {
+			return 0;
+		}
+
+		slot = kvs_index_insert(fs, hash, addr);
+		if (slot < 0) {
+			LOG_ERR("Index full");
+			return slot;
+		}
+	}
+
+	kvs_live_add(fs, addr, kvs_rec_size(fs, rec->key_len, rec->len));
+
+	if (undo) {
+		undo->slot = slot;
+		undo->addr = old_addr;
+		undo->size = old_size;
+	}
+
+	return 0;
+}
+
+/* take back the index changes of the data record rec */
+static void kvs_index_undo(struct kvs_fs *fs, const struct kvs_undo *undo,
+			   const struct kvs_rec *rec)
+{
+	struct kvs_index_entry *entry = &fs->index[undo->slot];
+
+	kvs_live_sub(fs, entry->addr, kvs_rec_size(fs, rec->key_len, rec->len));
+
+	if (undo->addr == KVS_INDEX_EMPTY) {
+		kvs_index_remove(fs, undo->slot);
+		return;
+	}
+
+	entry->addr = undo->addr;
+	kvs_live_add(fs, undo->addr, undo->size);
+}
+
+/* look the key of the record rec written at addr up and point the index to it */
+static int kvs_index_apply(struct kvs_fs *fs, uint32_t hash, const void *key, uint32_t addr,
+			   const struct kvs_rec *rec, struct kvs_undo *undo)
+{
+	struct kvs_rec old;
+	int slot;
+
+	slot = kvs_index_find(fs, hash, key, rec->key_len, &old);
+	if ((slot < 0) && (slot != -ENOENT)) {
+		return slot;
+	}
+
+	return kvs_index_update(fs, slot, hash, addr, &old, rec, undo);
+}
+/* end index routines */
+
+/* garbage collection: copy the records still in use of the oldest sector to
+ * the free sector erased the fewest times, which becomes the head sector, and
+ * erase the oldest sector. Records are only ever copied to a newer sector, so
+ * the newest record of a key stays the newest, and a deleted key has no
+ * record older than its delete record left once that is dropped.
+ */
+static int kvs_gc(struct kvs_fs *fs)
+{
+	uint16_t victim = kvs_sector_oldest(fs);
+	uint32_t addr, end, hash, plain_crc, size, new_addr;
+	struct kvs_rec rec;
+	int slot, rc;
+
+	if (victim == fs->sector_count) {
+		return -ENOSPC;
+	}
+
+	LOG_DBG("Garbage collecting sector %u", victim);
+
+	rc = kvs_sector_open(fs);
+	if (rc) {
+		return rc;
+	}
+
+	addr = kvs_sector_addr(fs, victim) + KVS_DATA_OFFSET;
+	end = kvs_sector_addr(fs, victim) + fs->sector_size;
+
+	/* the records after the last one in use don't need to be read */
+	while ((fs->sectors[victim].live > 0) && (end - addr >= KVS_HDR_SIZE)) {
+		rc = kvs_rec_read(fs, addr, &rec, NULL, &hash, &plain_crc);
+		if ((rc == 1) || (rc == -EBADMSG)) {
+			break;
+		}
+		if (rc) {
+			return rc;
+		}
+
+		size = kvs_rec_size(fs, rec.key_len, rec.len);
+
+		if ((rec.type & KVS_REC_TYPE_MASK) == KVS_REC_DATA) {
+			slot = kvs_index_find_addr(fs, hash, addr);
+			if (slot >= 0) {
+				rc = kvs_rec_move(fs, addr, &rec, plain_crc, &new_addr);
+				if (rc) {
+					return rc;
+				}
+
+				fs->index[slot].addr = new_addr;
+				kvs_live_sub(fs, addr, size);
+				kvs_live_add(fs, new_addr, size);
+			}
+		}
+
+		addr += size;
+	}
+
+	fs->sectors[victim].state = KVS_SECTOR_BLANK;
+	fs->sectors[victim].seq = 0;
+	fs->sectors[victim].live = 0;
+	fs->free_count++;
+	fs->stats.gc_count++;
+
+	return kvs_sector_erase(fs, victim);
+}
+
+/* make room for size bytes of records in the head sector */
+static int kvs_reserve(struct kvs_fs *fs, uint32_t size)
+{
+	int rc;
+
+	for (uint32_t i = 0; i <= fs->sector_count; i++) {
+		if (kvs_head_room(fs) >= size) {
+			return 0;
+		}
+
+		/* one sector always stays free, for the garbage collection to copy to */
+		if (fs->free_count > 1) {
+			rc = kvs_sector_open(fs);
+		} else {
+			fs->stats.blocking_count++;
+			rc = kvs_gc(fs);
+		}
+
+		if (rc) {
+			return rc;
+		}
+	}
+
+	return -ENOSPC;
+}
+
+#ifdef CONFIG_KVS_BACKGROUND_GC
+static K_KERNEL_STACK_DEFINE(kvs_gc_stack, CONFIG_KVS_BACKGROUND_GC_STACK_SIZE);
+static struct k_work_q kvs_gc_workq;
+
+/* check if the head sector is running out of space while the only free
+ * sector left is the one kept for garbage collection. Garbage collecting a
+ * sector that is mostly in use takes an erase without freeing much space, it
+ * is left to the writes, which only do it once they have to.
+ */
+static bool kvs_gc_bg_needed(struct kvs_fs *fs)
+{
+	uint32_t threshold, capacity;
+	uint16_t oldest;
+
+	threshold = fs->sector_size * CONFIG_KVS_BACKGROUND_GC_THRESHOLD / 100U;
+	if ((fs->free_count > 1) || (kvs_head_room(fs) >= threshold)) {
+		return false;
+	}
+
+	oldest = kvs_sector_oldest(fs);
+	if ((oldest == fs->sector_count) || (oldest == fs->head)) {
+		return false;
+	}
+
+	capacity = fs->sector_size - KVS_DATA_OFFSET;
+
+	return (capacity - fs->sectors[oldest].live) >=
+	       (fs->sector_size * CONFIG_KVS_BACKGROUND_GC_MIN_FREED / 100U);
+}
+
+static void kvs_gc_bg_check(struct kvs_fs *fs)
+{
+	if (kvs_gc_bg_needed(fs)) {
+		(void)k_work_submit_to_queue(&kvs_gc_workq, &fs->gc_work);
+	}
+}
+
+static void kvs_gc_bg_work(struct k_work *work)
+{
+	struct kvs_fs *fs = CONTAINER_OF(work, struct kvs_fs, gc_work);
+	int rc;
+
+	k_mutex_lock(&fs->kvs_lock, K_FOREVER);
+
+	if (fs->ready && kvs_gc_bg_needed(fs)) {
+		rc = kvs_gc(fs);
+		if (rc) {
+			LOG_ERR("Background gc failed: %d", rc);
+		}
+	}
+
+	k_mutex_unlock(&fs->kvs_lock);
+}
+
+static int kvs_gc_workq_init(void)
+{
+	k_work_queue_start(&kvs_gc_workq, kvs_gc_stack,
+			   K_KERNEL_STACK_SIZEOF(kvs_gc_stack),
+			   CONFIG_KVS_BACKGROUND_GC_THREAD_PRIO, NULL);
+	k_thread_name_set(&kvs_gc_workq.thread, "kvs_gc");
+
+	return 0;
+}
+
+SYS_INIT(kvs_gc_workq_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+#endif /* CONFIG_KVS_BACKGROUND_GC */
+
+/* apply the records of the batch read, once its commit record is read */
+static int kvs_scan_commit(struct kvs_fs *fs, struct kvs_scan *scan)
+{
+	struct kvs_rec rec;
+	uint32_t hash;
+	int rc;
+
+	for (uint16_t i = 0; i < scan->batch_count; i++) {
+		rc = kvs_rec_read(fs, scan->batch[i], &rec, scan->key, &hash, NULL);
+		if (rc) {
+			return (rc < 0) ? rc : -EIO;
+		}
+
+		rc = kvs_index_apply(fs, hash, scan->key, scan->batch[i], &rec, NULL);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+/* add the records of a sector to the index, returns the address the next
+ * record of the sector would be written to, or the end of the sector when its
+ * records end with one that is not complete.
+ */
+static int kvs_sector_scan(struct kvs_fs *fs, uint16_t sector, struct kvs_scan *scan,
+			   uint32_t *wra)
+{
+	uint32_t addr = kvs_sector_addr(fs, sector) + KVS_DATA_OFFSET;
+	uint32_t end = kvs_sector_addr(fs, sector) + fs->sector_size;
+	uint32_t last = KVS_INDEX_EMPTY;
+	struct kvs_rec rec, last_rec;
+	struct kvs_undo undo;
+	uint32_t hash;
+	uint8_t type;
+	int rc;
+
+	/* a batch is written to a single sector */
+	scan->in_batch = false;
+
+	while (end - addr >= KVS_HDR_SIZE) {
+		rc = kvs_rec_read(fs, addr, &rec, scan->key, &hash, NULL);
+		if (rc == 1) {
+			break;
+		}
+		if (rc == -EBADMSG) {
+			LOG_DBG("Invalid record at %x", addr);
+			addr = end;
+			break;
+		}
+		if (rc) {
+			return rc;
+		}
+
+		/* the previous record is followed by this one, so it is complete */
+		last = KVS_INDEX_EMPTY;
+		type = rec.type & KVS_REC_TYPE_MASK;
+
+		if (type == KVS_REC_COMMIT) {
+			if (scan->in_batch && (rec.count == scan->batch_count)) {
+				rc = kvs_scan_commit(fs, scan);
+			}
+			scan->in_batch = false;
+		} else if (rec.type & KVS_REC_BATCH) {
+			if (rec.type & KVS_REC_BATCH_FIRST) {
+				scan->in_batch = true;
+				scan->batch_count = 0;
+			}
+
+			if (scan->in_batch && (scan->batch_count < ARRAY_SIZE(scan->batch))) {
+				scan->batch[scan->batch_count++] = addr;
+			} else {
+				scan->in_batch = false;
+			}
+		} else {
+			/* any batch before this record was interrupted */
+			scan->in_batch = false;
+
+			rc = kvs_index_apply(fs, hash, scan->key, addr, &rec, &undo);
+			if (type == KVS_REC_DATA) {
+				last = addr;
+				last_rec = rec;
+			}
+		}
+
+		if (rc) {
+			return rc;
+		}
+
+		addr += kvs_rec_size(fs, rec.key_len, rec.len);
+	}
+
+	/* The write of the value of the last record can have been interrupted.
+	 * Nothing is written after such a record, it would no longer be checked.
+	 */
+	if (last != KVS_INDEX_EMPTY) {
+		rc = kvs_rec_val_check(fs, last, &last_rec);
+		if (rc == -EBADMSG) {
+			LOG_DBG("Incomplete record at %x", last);
+			kvs_index_undo(fs, &undo, &last_rec);
+			addr = end;
+		} else if (rc) {
+			return rc;
+		}
+	}
+
+	*wra = addr;
+
+	return 0;
+}
+
+static int kvs_startup(struct kvs_fs *fs)
+{
+	struct {
+		struct kvs_format_hdr format;
+		struct kvs_open_hdr open;
+	} hdr;
+	struct kvs_scan scan;
+	struct kvs_sector *sec;
+	uint32_t max_erase_count = 0;
+	uint32_t prev_seq, wra;
+	uint16_t sector;
+	int rc;
+
+	fs->seq = 0;
+	fs->free_count = 0;
+	fs->head = 0;
+	fs->wra = 0;
+	memset(&fs->stats, 0, sizeof(fs->stats));
+	memset(fs->index, 0xff, sizeof(fs->index));
+
+	for (uint16_t i = 0; i < fs->sector_count; i++) {
+		sec = &fs->sectors[i];
+		sec->state = KVS_SECTOR_BLANK;
+		sec->seq = 0;
+		sec->live = 0;
+		/* not known until all the sectors were read */
+		sec->erase_count = UINT32_MAX;
+
+		rc = kvs_flash_rd(fs, kvs_sector_addr(fs, i), &hdr, sizeof(hdr));
+		if (rc) {
+			return rc;
+		}
+
+		if ((hdr.format.magic == KVS_MAGIC) && (hdr.format.sector_size == fs->sector_size) &&
+		    (hdr.format.crc32 == crc32_ieee((const uint8_t *)&hdr.format,
+						    offsetof(struct kvs_format_hdr, crc32)))) {
+			sec->erase_count = hdr.format.erase_count;
+			max_erase_count = MAX(max_erase_count, sec->erase_count);
+
+			if (kvs_is_erased(fs, &hdr.open, sizeof(hdr.open))) {
+				sec->state = KVS_SECTOR_FREE;
+			} else if (hdr.open.crc32 ==
+				   crc32_ieee((const uint8_t *)&hdr.open,
+					      offsetof(struct kvs_open_hdr, crc32))) {
+				sec->state = KVS_SECTOR_USED;
+				sec->seq = hdr.open.seq;
+				fs->seq = MAX(fs->seq, sec->seq);
+			}
+		}
+
+		if (sec->state != KVS_SECTOR_USED) {
+			fs->free_count++;
+		}
+	}
+
+	/* sectors that lost their format header were erased at least as many
+	 * times as the others, as far as wear leveling is concerned.
+	 */
+	for (uint16_t i = 0; i < fs->sector_count; i++) {
+		if (fs->sectors[i].erase_count == UINT32_MAX) {
+			fs->sectors[i].erase_count = max_erase_count;
+		}
+	}
+
+	/* A sector is always kept free, except while a garbage collection
+	 * copies records to it. The newest sector then only holds copies of
+	 * records of the oldest one, which was not erased yet.
+	 */
+	if (!fs->free_count) {
+		sector = 0;
+		for (uint16_t i = 1; i < fs->sector_count; i++) {
+			if (fs->sectors[i].seq > fs->sectors[sector].seq) {
+				sector = i;
+			}
+		}
+
+		LOG_INF("Restarting interrupted garbage collection");
+		fs->sectors[sector].state = KVS_SECTOR_BLANK;
+		fs->sectors[sector].seq = 0;
+		fs->free_count++;
+
+		rc = kvs_sector_erase(fs, sector);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	/* add the records to the index from the oldest sector on */
+	prev_seq = 0;
+	while (true) {
+		sector = fs->sector_count;
+		for (uint16_t i = 0; i < fs->sector_count; i++) {
+			sec = &fs->sectors[i];
+			if ((sec->state == KVS_SECTOR_USED) && (sec->seq > prev_seq) &&
+			    ((sector == fs->sector_count) || (sec->seq < fs->sectors[sector].seq))) {
+				sector = i;
+			}
+		}
+
+		if (sector == fs->sector_count) {
+			break;
+		}
+
+		rc = kvs_sector_scan(fs, sector, &scan, &wra);
+		if (rc) {
+			return rc;
+		}
+
+		fs->head = sector;
+		fs->wra = wra;
+		prev_seq = fs->sectors[sector].seq;
+	}
+
+	return 0;
+}
+
+int kvs_clear(struct kvs_fs *fs)
+{
+	int rc;
+#ifdef CONFIG_KVS_BACKGROUND_GC
+	struct k_work_sync sync;
+#endif
+
+	if (!fs->ready) {
+		LOG_ERR("KVS not initialized");
+		return -EACCES;
+	}
+
+	k_mutex_lock(&fs->kvs_lock, K_FOREVER);
+	/* kvs needs to be reinitialized after clearing */
+	fs->ready = false;
+	k_mutex_unlock(&fs->kvs_lock);
+
+#ifdef CONFIG_KVS_BACKGROUND_GC
+	(void)k_work_cancel_sync(&fs->gc_work, &sync);
+#endif
+
+	for (uint16_t i = 0; i < fs->sector_count; i++) {
+		rc = flash_erase(fs->flash_device, fs->offset + kvs_sector_addr(fs, i),
+				 fs->sector_size);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+int kvs_mount(struct kvs_fs *fs)
+{
+	int rc;
+	struct flash_pages_info info;
+	size_t write_block_size;
+#ifdef CONFIG_KVS_BACKGROUND_GC
+	struct k_work_sync sync;
+
+	/* the file system might be mounted again, with gc work still queued.
+	 * The work is initialized by a successful mount and only queued while
+	 * the file system is ready.
+	 */
+	if (fs->ready) {
+		(void)k_work_cancel_sync(&fs->gc_work, &sync);
+	}
+	k_work_init(&fs->gc_work, kvs_gc_bg_work);
+#endif
+
+	fs->ready = false;
+	k_mutex_init(&fs->kvs_lock);
+
+	fs->flash_parameters = flash_get_parameters(fs->flash_device);
+	if (fs->flash_parameters == NULL) {
+		LOG_ERR("Could not obtain flash parameters");
+		return -EINVAL;
+	}
+
+	write_block_size = flash_get_write_block_size(fs->flash_device);
+
+	/* check that the write block size is supported */
+	if ((write_block_size == 0) || (KVS_HDR_SIZE % write_block_size)) {
+		LOG_ERR("Unsupported write block size");
+		return -EINVAL;
+	}
+
+	/* check that sector size is a multiple of pagesize */
+	rc = flash_get_page_info_by_offs(fs->flash_device, fs->offset, &info);
+	if (rc) {
+		LOG_ERR("Unable to get page info");
+		return -EINVAL;
+	}
+	if (!fs->sector_size || (fs->sector_size % info.size) ||
+	    (fs->sector_size <= KVS_DATA_OFFSET)) {
+		LOG_ERR("Invalid sector size");
+		return -EINVAL;
+	}
+
+	/* check the number of sectors, one of them is kept free */
+	if ((fs->sector_count < 2) || (fs->sector_count > CONFIG_KVS_MAX_SECTORS)) {
+		LOG_ERR("Configuration error - sector count");
+		return -EINVAL;
+	}
+
+	rc = kvs_startup(fs);
+	if (rc) {
+		return rc;
+	}
+
+	/* kvs is ready for use */
+	fs->ready = true;
+
+	LOG_INF("%d Sectors of %d bytes", fs->sector_count, fs->sector_size);
+	LOG_INF("%u keys, write address %x", fs->stats.keys, fs->wra);
+
+	return 0;
+}
+
+static int kvs_key_check(struct kvs_fs *fs, const void *key, size_t key_len)
+{
+	if (!fs->ready) {
+		LOG_ERR("KVS not initialized");
+		return -EACCES;
+	}
+
+	if ((key == NULL) || (key_len == 0) || (key_len > CONFIG_KVS_KEY_MAX_LEN)) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+ssize_t kvs_write(struct kvs_fs *fs, const void *key, size_t key_len, const void *data,
+		  size_t len)
+{
+	struct kvs_rec rec = {0};
+	struct kvs_rec old;
+	uint32_t hash, addr, size;
+	int slot, rc;
+
+	rc = kvs_key_check(fs, key, key_len);
+	if (rc) {
+		return rc;
+	}
+
+	size = kvs_rec_size(fs, key_len, len);
+	if ((len > UINT16_MAX) || (len && !data) ||
+	    (size > fs->sector_size - KVS_DATA_OFFSET)) {
+		return -EINVAL;
+	}
+
+	rec.type = KVS_REC_DATA;
+	rec.key_len = key_len;
+	rec.len = len;
+	rec.val_crc32 = crc32_ieee(data, len);
+	hash = kvs_hash_update(KVS_HASH_INIT, key, key_len);
+
+	k_mutex_lock(&fs->kvs_lock, K_FOREVER);
+
+	slot = kvs_index_find(fs, hash, key, key_len, &old);
+	if (slot >= 0) {
+		/* nothing is written if the data is unchanged */
+		if ((old.len == len) && (old.val_crc32 == rec.val_crc32)) {
+			rc = kvs_flash_cmp(fs, fs->index[slot].addr + KVS_HDR_SIZE + key_len,
+					   data, len);
+			if (rc <= 0) {
+				goto end;
+			}
+		}
+	} else if (slot != -ENOENT) {
+		rc = slot;
+		goto end;
+	} else if (fs->stats.keys == CONFIG_KVS_INDEX_SIZE) {
+		rc = -ENOSPC;
+		goto end;
+	}
+
+	rc = kvs_reserve(fs, size);
+	if (rc) {
+		goto end;
+	}
+
+	rc = kvs_rec_wrt(fs, &rec, key, data, &addr);
+	if (rc) {
+		goto end;
+	}
+
+	/* a garbage collection may have moved the old record, not its slot */
+	rc = kvs_index_update(fs, slot, hash, addr, &old, &rec, NULL);
+	if (rc) {
+		goto end;
+	}
+
+	rc = len;
+
+#ifdef CONFIG_KVS_BACKGROUND_GC
+	kvs_gc_bg_check(fs);
+#endif
+end:
+	k_mutex_unlock(&fs->kvs_lock);
+	return rc;
+}
+
+int kvs_delete(struct kvs_fs *fs, const void *key, size_t key_len)
+{
+	struct kvs_rec rec = {0};
+	struct kvs_rec old;
+	uint32_t hash, addr;
+	int slot, rc;
+
+	rc = kvs_key_check(fs, key, key_len);
+	if (rc) {
+		return rc;
+	}
+
+	rec.type = KVS_REC_DELETE;
+	rec.key_len = key_len;
+	hash = kvs_hash_update(KVS_HASH_INIT, key, key_len);
+
+	k_mutex_lock(&fs->kvs_lock, K_FOREVER);
+
+	slot = kvs_index_find(fs, hash, key, key_len, &old);
+	if (slot < 0) {
+		rc = (slot == -ENOENT) ? 0 : slot;
+		goto end;
+	}
+
+	rc = kvs_reserve(fs, kvs_rec_size(fs, key_len, 0));
+	if (rc) {
+		goto end;
+	}
+
+	rc = kvs_rec_wrt(fs, &rec, key, NULL, &addr);
+	if (rc) {
+		goto end;
+	}
+
+	rc = kvs_index_update(fs, slot, hash, addr, &old, &rec, NULL);
+
+#ifdef CONFIG_KVS_BACKGROUND_GC
+	kvs_gc_bg_check(fs);
+#endif
+end:
+	k_mutex_unlock(&fs->kvs_lock);
+	return rc;
+}
+
+int kvs_write_batch(struct kvs_fs *fs, const struct kvs_batch_entry *entries, size_t count)
+{
+	uint32_t addr[CONFIG_KVS_BATCH_MAX_ENTRIES];
+	const struct kvs_batch_entry *entry;
+	struct kvs_rec rec, old;
+	uint32_t size, new_keys, hash;
+	int slot, rc;
+
+	if (!fs->ready) {
+		LOG_ERR("KVS not initialized");
+		return -EACCES;
+	}
+
+	if (count > CONFIG_KVS_BATCH_MAX_ENTRIES) {
+		return -EINVAL;
+	}
+
+	/* the records of the batch and the commit record go to a single sector */
+	size = KVS_HDR_SIZE;
+	for (size_t i = 0; i < count; i++) {
+		entry = &entries[i];
+
+		rc = kvs_key_check(fs, entry->key, entry->key_len);
+		if (rc) {
+			return rc;
+		}
+
+		if (entry->data) {
+			if (entry->len > UINT16_MAX) {
+				return -EINVAL;
+			}
+			size += kvs_rec_size(fs, entry->key_len, entry->len);
+		} else {
+			size += kvs_rec_size(fs, entry->key_len, 0);
+		}
+	}
+
+	if (size > fs->sector_size - KVS_DATA_OFFSET) {
+		return -EINVAL;
+	}
+
+	if (!count) {
+		return 0;
+	}
+
+	k_mutex_lock(&fs->kvs_lock, K_FOREVER);
+
+	/* the keys added must fit in the index, keys written twice count twice */
+	new_keys = 0;
+	for (size_t i = 0; i < count; i++) {
+		entry = &entries[i];
+		if (!entry->data) {
+			continue;
+		}
+
+		hash = kvs_hash_update(KVS_HASH_INIT, entry->key, entry->key_len);
+		slot = kvs_index_find(fs, hash, entry->key, entry->key_len, &old);
+		if (slot == -ENOENT) {
+			new_keys++;
+		} else if (slot < 0) {
+			rc = slot;
+			goto end;
+		}
+	}
+
+	if (fs->stats.keys + new_keys > CONFIG_KVS_INDEX_SIZE) {
+		rc = -ENOSPC;
+		goto end;
+	}
+
+	rc = kvs_reserve(fs, size);
+	if (rc) {
+		goto end;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		entry = &entries[i];
+
+		memset(&rec, 0, sizeof(rec));
+		rec.type = (entry->data ? KVS_REC_DATA : KVS_REC_DELETE) | KVS_REC_BATCH;
+		if (i == 0) {
+			rec.type |= KVS_REC_BATCH_FIRST;
+		}
+		rec.key_len = entry->key_len;
+		rec.len = entry->data ? entry->len : 0;
+		rec.val_crc32 = crc32_ieee(entry->data, rec.len);
+
+		rc = kvs_rec_wrt(fs, &rec, entry->key, entry->data, &addr[i]);
+		if (rc) {
+			goto end;
+		}
+	}
+
+	memset(&rec, 0, sizeof(rec));
+	rec.type = KVS_REC_COMMIT;
+	rec.count = count;
+
+	rc = kvs_rec_wrt(fs, &rec, NULL, NULL, &size);
+	if (rc) {
+		goto end;
+	}
+
+	/* the batch is complete in flash, the index can point to its records */
+	for (size_t i = 0; i < count; i++) {
+		entry = &entries[i];
+
+		memset(&rec, 0, sizeof(rec));
+		rec.type = entry->data ? KVS_REC_DATA : KVS_REC_DELETE;
+		rec.key_len = entry->key_len;
+		rec.len = entry->data ? entry->len : 0;
+		hash = kvs_hash_update(KVS_HASH_INIT, entry->key, entry->key_len);
+
+		rc = kvs_index_apply(fs, hash, entry->key, addr[i], &rec, NULL);
+		if (rc) {
+			goto end;
+		}
+	}
+
+#ifdef CONFIG_KVS_BACKGROUND_GC
+	kvs_gc_bg_check(fs);
+#endif
+end:
+	k_mutex_unlock(&fs->kvs_lock);
+	return rc;
+}
+
+ssize_t kvs_read(struct kvs_fs *fs, const void *key, size_t key_len, void *data, size_t len)
+{
+	struct kvs_rec rec;
+	uint32_t hash;
+	int slot, rc;
+
+	rc = kvs_key_check(fs, key, key_len);
+	if (rc) {
+		return rc;
+	}
+
+	hash = kvs_hash_update(KVS_HASH_INIT, key, key_len);
+
+	k_mutex_lock(&fs->kvs_lock, K_FOREVER);
+
+	slot = kvs_index_find(fs, hash, key, key_len, &rec);
+	if (slot < 0) {
+		rc = slot;
+		goto end;
+	}
+
+	rc = kvs_flash_rd(fs, fs->index[slot].addr + KVS_HDR_SIZE + key_len, data,
+			  MIN(len, rec.len));
+	if (rc) {
+		goto end;
+	}
+
+	rc = rec.len;
+end:
+	k_mutex_unlock(&fs->kvs_lock);
+	return rc;
+}
+
+ssize_t kvs_read_addr(struct kvs_fs *fs, const void *key, size_t key_len, uint32_t addr,
+		      void *data, size_t len)
+{
+	struct kvs_rec rec;
+	uint32_t hash;
+	int slot, rc;
+
+	rc = kvs_key_check(fs, key, key_len);
+	if (rc) {
+		return rc;
+	}
+
+	if (addr >= kvs_sector_addr(fs, fs->sector_count) - KVS_HDR_SIZE) {
+		return -EINVAL;
+	}
+
+	hash = kvs_hash_update(KVS_HASH_INIT, key, key_len);
+
+	k_mutex_lock(&fs->kvs_lock, K_FOREVER);
+
+	/* the record at addr is only used while it is the one of the key,
+	 * once it was written again or moved the key is looked up.
+	 */
+	slot = kvs_index_find_addr(fs, hash, addr);
+	if (slot >= 0) {
+		rc = kvs_rec_key_cmp(fs, addr, &rec, key, key_len);
+		if (rc < 0) {
+			goto end;
+		}
+		if (rc) {
+			slot = -ENOENT;
+		}
+	}
+
+	if (slot < 0) {
+		slot = kvs_index_find(fs, hash, key, key_len, &rec);
+		if (slot < 0) {
+			rc = slot;
+			goto end;
+		}
+		addr = fs->index[slot].addr;
+	}
+
+	if (kvs_rec_size(fs, key_len, rec.len) > kvs_sector_end(fs, addr) - addr) {
+		rc = -EBADMSG;
+		goto end;
+	}
+
+	rc = kvs_flash_rd(fs, addr + KVS_HDR_SIZE + key_len, data, MIN(len, rec.len));
+	if (rc) {
+		goto end;
+	}
+
+	rc = rec.len;
+end:
+	k_mutex_unlock(&fs->kvs_lock);
+	return rc;
+}
+
+int kvs_walk(struct kvs_fs *fs, kvs_walk_cb_t cb, void *param)
+{
+	uint8_t key[CONFIG_KVS_KEY_MAX_LEN + 1];
+	struct kvs_rec rec;
+	uint32_t addr, hash;
+	int rc;
+
+	if (!fs->ready) {
+		LOG_ERR("KVS not initialized");
+		return -EACCES;
+	}
+
+	for (uint32_t i = 0; i < CONFIG_KVS_INDEX_SIZE; i++) {
+		k_mutex_lock(&fs->kvs_lock, K_FOREVER);
+
+		addr = fs->index[i].addr;
+		if (addr >= KVS_INDEX_DELETED) {
+			k_mutex_unlock(&fs->kvs_lock);
+			continue;
+		}
+
+		rc = kvs_rec_read(fs, addr, &rec, key, &hash, NULL);
+
+		k_mutex_unlock(&fs->kvs_lock);
+
+		if (rc) {
+			return (rc < 0) ? rc : -EIO;
+		}
+
+		/* keys that are strings can be used as they are */
+		key[rec.key_len] = '\0';
+
+		rc = cb(key, rec.key_len, addr, rec.len, param);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+int kvs_stats_get(struct kvs_fs *fs, struct kvs_stats *stats)
+{
+	if (!fs->ready) {
+		LOG_ERR("KVS not initialized");
+		return -EACCES;
+	}
+
+	k_mutex_lock(&fs->kvs_lock, K_FOREVER);
+
+	*stats = fs->stats;
+	stats->erase_count_min = UINT32_MAX;
+	stats->erase_count_max = 0;
+	for (uint16_t i = 0; i < fs->sector_count; i++) {
+		stats->erase_count_min = MIN(stats->erase_count_min, fs->sectors[i].erase_count);
+		stats->erase_count_max = MAX(stats->erase_count_max, fs->sectors[i].erase_count);
+	}
+
+	k_mutex_unlock(&fs->kvs_lock);
+
+	return 0;
+}
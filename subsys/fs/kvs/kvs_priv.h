@@ -0,0 +1,95 @@
+/*  KVS: log-structured key-value store in flash
+ *
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef __KVS_PRIV_H_
+#define __KVS_PRIV_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Layout of a sector:
+ *   - format header, written when the sector is erased
+ *   - open header, written when the sector starts being used
+ *   - records, one after the other
+ *
+ * A record is a header followed by the key and the value. The header is
+ * written first, its crc covers the header and the key, the crc of the value
+ * is in the header. A record is followed by another one only once it is
+ * completely written, so only the value of the last record of a sector has
+ * to be checked to detect an interrupted write.
+ */
+#define KVS_MAGIC 0x4b565331 /* "KVS1" */
+
+/* Size of the sector and record headers, write block sizes must divide it */
+#define KVS_HDR_SIZE 16
+
+/* Offset of the first record in a sector */
+#define KVS_DATA_OFFSET (2 * KVS_HDR_SIZE)
+
+#define KVS_BLOCK_SIZE 64
+
+/*
+ * Sector states
+ */
+#define KVS_SECTOR_BLANK 0 /* to be erased before use */
+#define KVS_SECTOR_FREE 1  /* erased and formatted */
+#define KVS_SECTOR_USED 2  /* opened, holds records */
+
+/*
+ * Record types, the flags mark the records of a batch
+ */
+#define KVS_REC_DATA 0x01
+#define KVS_REC_DELETE 0x02
+#define KVS_REC_COMMIT 0x03
+#define KVS_REC_TYPE_MASK 0x0f
+#define KVS_REC_BATCH 0x10
+#define KVS_REC_BATCH_FIRST 0x20
+
+/*
+ * Index entry addresses that are not records
+ */
+#define KVS_INDEX_EMPTY 0xFFFFFFFF
+#define KVS_INDEX_DELETED 0xFFFFFFFE
+
+/* Written when a sector is erased */
+struct kvs_format_hdr {
+	uint32_t magic;
+	uint32_t erase_count;
+	uint32_t sector_size;
+	uint32_t crc32;	/* crc32 of the fields above */
+} __packed;
+
+/* Written when a sector starts being used */
+struct kvs_open_hdr {
+	uint32_t seq;	/* sectors are opened in increasing order */
+	uint32_t reserved[2];
+	uint32_t crc32;	/* crc32 of the fields above */
+} __packed;
+
+/* Record header */
+struct kvs_rec {
+	uint8_t type;	/* KVS_REC_* */
+	uint8_t key_len;
+	uint16_t len;	/* value length */
+	uint32_t val_crc32; /* crc32 of the value */
+	uint16_t count;	/* commit: number of records of the batch */
+	uint16_t reserved;
+	uint32_t crc32;	/* crc32 of the fields above and the key */
+} __packed;
+
+BUILD_ASSERT(sizeof(struct kvs_format_hdr) == KVS_HDR_SIZE);
+BUILD_ASSERT(sizeof(struct kvs_open_hdr) == KVS_HDR_SIZE);
+BUILD_ASSERT(sizeof(struct kvs_rec) == KVS_HDR_SIZE);
+BUILD_ASSERT(offsetof(struct kvs_rec, crc32) == KVS_HDR_SIZE - sizeof(uint32_t),
+	     "crc32 must be the last member");
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __KVS_PRIV_H_ */
@@ -562,6 +562,11 @@ static int nvs_sector_close(struct nvs_fs *fs)
 
 	fs->data_wra = fs->ate_wra & ADDR_SECT_MASK;
 
+#ifdef CONFIG_NVS_BACKGROUND_GC
+	/* the skipped sector was measured for the previous write sector */
+	fs->gc_skip_sector = UINT16_MAX;
+#endif
+
 	return 0;
 }
 
@@ -579,26 +584,70 @@ static int nvs_add_gc_done_ate(struct nvs_fs *fs)
 	return nvs_flash_ate_wrt(fs, &gc_done_ate);
 }
 
-/* garbage collection: the address ate_wra has been updated to the new sector
- * that has just been started. The data to gc is in the sector after this new
- * sector.
+/* check if the ate read at gc_prev_addr in the sector being garbage collected
+ * is the most recent one of its id and is not a deleted item, in which case it
+ * needs to be copied.
+ * return 1 if copy is needed, 0 if not, errorcode on error.
  */
-static int nvs_gc(struct nvs_fs *fs)
+static int nvs_gc_ate_live(struct nvs_fs *fs, uint32_t gc_prev_addr,
+			   const struct nvs_ate *gc_ate)
+{
+	int rc;
+	struct nvs_ate wlk_ate;
+	uint32_t wlk_addr, wlk_prev_addr;
+
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	wlk_addr = fs->lookup_cache[nvs_lookup_cache_pos(gc_ate->id)];
+
+	if (wlk_addr == NVS_LOOKUP_CACHE_NO_ADDR) {
+		wlk_addr = fs->ate_wra;
+	}
+#else
+	wlk_addr = fs->ate_wra;
+#endif
+	do {
+		wlk_prev_addr = wlk_addr;
+		rc = nvs_prev_ate(fs, &wlk_addr, &wlk_ate);
+		if (rc) {
+			return rc;
+		}
+		/* if ate with same id is reached we might need to copy.
+		 * only consider valid wlk_ate's. Something wrong might
+		 * have been written that has the same ate but is
+		 * invalid, don't consider these as a match.
+		 */
+		if ((wlk_ate.id == gc_ate->id) &&
+		    (nvs_ate_valid(fs, &wlk_ate))) {
+			break;
+		}
+	} while (wlk_addr != fs->ate_wra);
+
+	/* if walk has reached the same address as gc_addr copy is
+	 * needed unless it is a deleted item.
+	 */
+	return (wlk_prev_addr == gc_prev_addr) && gc_ate->len;
+}
+
+/* start the garbage collection of the sector at sec_addr.
+ * return 1 if the sector is closed and its ate's need to be walked, 0 if the
+ * sector is not closed and can just be erased, errorcode on error.
+ */
+static int nvs_gc_start(struct nvs_fs *fs, struct nvs_gc_state *gc,
+			uint32_t sec_addr)
 {
 	int rc;
-	struct nvs_ate close_ate, gc_ate, wlk_ate;
-	uint32_t sec_addr, gc_addr, gc_prev_addr, wlk_addr, wlk_prev_addr,
-	      data_addr, stop_addr;
+	struct nvs_ate close_ate;
 	size_t ate_size;
 
 	ate_size = nvs_al_size(fs, sizeof(struct nvs_ate));
 
-	sec_addr = (fs->ate_wra & ADDR_SECT_MASK);
-	nvs_sector_advance(fs, &sec_addr);
-	gc_addr = sec_addr + fs->sector_size - ate_size;
+	gc->sec_addr = sec_addr;
+	gc->addr = sec_addr + fs->sector_size - ate_size;
+	gc->need = 0U;
+	gc->max = 0U;
 
 	/* if the sector is not closed don't do gc */
-	rc = nvs_flash_ate_rd(fs, gc_addr, &close_ate);
+	rc = nvs_flash_ate_rd(fs, gc->addr, &close_ate);
 	if (rc < 0) {
 		/* flash error */
 		return rc;
@@ -606,24 +655,50 @@ static int nvs_gc(struct nvs_fs *fs)
 
 	rc = nvs_ate_cmp_const(&close_ate, fs->flash_parameters->erase_value);
 	if (!rc) {
-		goto gc_done;
+		gc->stop_addr = gc->addr;
+		gc->prev_addr = gc->addr;
+		return 0;
 	}
 
-	stop_addr = gc_addr - ate_size;
+	gc->stop_addr = gc->addr - ate_size;
+	gc->prev_addr = NVS_GC_NO_ADDR;
 
 	if (nvs_close_ate_valid(fs, &close_ate)) {
-		gc_addr &= ADDR_SECT_MASK;
-		gc_addr += close_ate.offset;
+		gc->addr &= ADDR_SECT_MASK;
+		gc->addr += close_ate.offset;
 	} else {
-		rc = nvs_recover_last_ate(fs, &gc_addr);
+		rc = nvs_recover_last_ate(fs, &gc->addr);
 		if (rc) {
 			return rc;
 		}
 	}
 
-	do {
-		gc_prev_addr = gc_addr;
-		rc = nvs_prev_ate(fs, &gc_addr, &gc_ate);
+	return 1;
+}
+
+/* walk at most cnt ate's of the sector being garbage collected. The entries
+ * that are still in use are copied to the write sector, or when copy is false
+ * only the space needed to copy them is added up in gc->need.
+ * return 1 if there are ate's left to walk, 0 when done, errorcode on error.
+ */
+static int nvs_gc_walk(struct nvs_fs *fs, struct nvs_gc_state *gc, bool copy,
+		       uint32_t cnt)
+{
+	int rc;
+	struct nvs_ate gc_ate;
+	uint32_t data_addr, size;
+	size_t ate_size;
+
+	ate_size = nvs_al_size(fs, sizeof(struct nvs_ate));
+
+	while (gc->prev_addr != gc->stop_addr) {
+		if (cnt == 0U) {
+			return 1;
+		}
+		cnt--;
+
+		gc->prev_addr = gc->addr;
+		rc = nvs_prev_ate(fs, &gc->addr, &gc_ate);
 		if (rc) {
 			return rc;
 		}
@@ -632,58 +707,57 @@ static int nvs_gc(struct nvs_fs *fs)
 			continue;
 		}
 
-#ifdef CONFIG_NVS_LOOKUP_CACHE
-		wlk_addr = fs->lookup_cache[nvs_lookup_cache_pos(gc_ate.id)];
+		rc = nvs_gc_ate_live(fs, gc->prev_addr, &gc_ate);
+		if (rc < 0) {
+			return rc;
+		}
+		if (!rc) {
+			continue;
+		}
+
+		size = nvs_al_size(fs, gc_ate.len) + ate_size;
 
-		if (wlk_addr == NVS_LOOKUP_CACHE_NO_ADDR) {
-			wlk_addr = fs->ate_wra;
+		if (!copy) {
+			gc->need += size;
+			gc->max = MAX(gc->max, nvs_al_size(fs, gc_ate.len));
+			continue;
 		}
-#else
-		wlk_addr = fs->ate_wra;
-#endif
-		do {
-			wlk_prev_addr = wlk_addr;
-			rc = nvs_prev_ate(fs, &wlk_addr, &wlk_ate);
-			if (rc) {
-				return rc;
-			}
-			/* if ate with same id is reached we might need to copy.
-			 * only consider valid wlk_ate's. Something wrong might
-			 * have been written that has the same ate but is
-			 * invalid, don't consider these as a match.
-			 */
-			if ((wlk_ate.id == gc_ate.id) &&
-			    (nvs_ate_valid(fs, &wlk_ate))) {
-				break;
-			}
-		} while (wlk_addr != fs->ate_wra);
 
-		/* if walk has reached the same address as gc_addr copy is
-		 * needed unless it is a deleted item.
-		 */
-		if ((wlk_prev_addr == gc_prev_addr) && gc_ate.len) {
-			/* copy needed */
-			LOG_DBG("Moving %d, len %d", gc_ate.id, gc_ate.len);
+		/* copy needed */
+		LOG_DBG("Moving %d, len %d", gc_ate.id, gc_ate.len);
 
-			data_addr = (gc_prev_addr & ADDR_SECT_MASK);
-			data_addr += gc_ate.offset;
+		data_addr = (gc->prev_addr & ADDR_SECT_MASK);
+		data_addr += gc_ate.offset;
 
-			gc_ate.offset = (uint16_t)(fs->data_wra & ADDR_OFFS_MASK);
-			nvs_ate_crc8_update(&gc_ate);
+		gc_ate.offset = (uint16_t)(fs->data_wra & ADDR_OFFS_MASK);
+		nvs_ate_crc8_update(&gc_ate);
 
-			rc = nvs_flash_block_move(fs, data_addr, gc_ate.len);
-			if (rc) {
-				return rc;
-			}
+		rc = nvs_flash_block_move(fs, data_addr, gc_ate.len);
+		if (rc) {
+			return rc;
+		}
 
-			rc = nvs_flash_ate_wrt(fs, &gc_ate);
-			if (rc) {
-				return rc;
-			}
+		rc = nvs_flash_ate_wrt(fs, &gc_ate);
+		if (rc) {
+			return rc;
 		}
-	} while (gc_prev_addr != stop_addr);
 
-gc_done:
+		gc->need -= MIN(gc->need, size);
+#ifdef CONFIG_NVS_GC_STATS
+		fs->gc_stats.moved += size;
+#endif
+	}
+
+	return 0;
+}
+
+/* finish the garbage collection: mark it done and erase the sector */
+static int nvs_gc_finish(struct nvs_fs *fs, struct nvs_gc_state *gc)
+{
+	int rc;
+	size_t ate_size;
+
+	ate_size = nvs_al_size(fs, sizeof(struct nvs_ate));
 
 	/* Make it possible to detect that gc has finished by writing a
 	 * gc done ate to the sector. In the field we might have nvs systems
@@ -699,18 +773,330 @@ gc_done:
 	}
 
 	/* Erase the gc'ed sector */
-	rc = nvs_flash_erase_sector(fs, sec_addr);
+	rc = nvs_flash_erase_sector(fs, gc->sec_addr);
 	if (rc) {
 		return rc;
 	}
+
+#ifdef CONFIG_NVS_GC_STATS
+	fs->gc_stats.count++;
+#endif
+	return 0;
+}
+
+#ifdef CONFIG_NVS_GC_STATS
+static void nvs_gc_stats_time(struct nvs_fs *fs, uint32_t start)
+{
+	uint32_t time_us;
+
+	time_us = k_cyc_to_us_ceil32(k_cycle_get_32() - start);
+
+	fs->gc_stats.time_us += time_us;
+	fs->gc_stats.max_time_us = MAX(fs->gc_stats.max_time_us, time_us);
+}
+#endif
+
+/* garbage collection: the address ate_wra has been updated to the new sector
+ * that has just been started. The data to gc is in the sector after this new
+ * sector.
+ */
+static int nvs_gc(struct nvs_fs *fs)
+{
+	int rc;
+	struct nvs_gc_state gc;
+	uint32_t sec_addr;
+#ifdef CONFIG_NVS_GC_STATS
+	uint32_t start = k_cycle_get_32();
+#endif
+
+	sec_addr = (fs->ate_wra & ADDR_SECT_MASK);
+	nvs_sector_advance(fs, &sec_addr);
+
+	rc = nvs_gc_start(fs, &gc, sec_addr);
+	if (rc < 0) {
+		return rc;
+	}
+
+	rc = nvs_gc_walk(fs, &gc, true, UINT32_MAX);
+	if (rc) {
+		return rc;
+	}
+
+	rc = nvs_gc_finish(fs, &gc);
+
+#ifdef CONFIG_NVS_GC_STATS
+	nvs_gc_stats_time(fs, start);
+#endif
+	return rc;
+}
+
+#ifdef CONFIG_NVS_BACKGROUND_GC
+static K_KERNEL_STACK_DEFINE(nvs_gc_stack, CONFIG_NVS_BACKGROUND_GC_STACK_SIZE);
+static struct k_work_q nvs_gc_workq;
+
+/* check if the write sector is running out of space and the next sector
+ * should be garbage collected in the background.
+ */
+static bool nvs_gc_bg_needed(struct nvs_fs *fs)
+{
+	uint32_t threshold;
+
+	/* with 2 sectors the sector to gc is the write sector itself */
+	if (fs->sector_count < 3) {
+		return false;
+	}
+
+	if ((fs->ate_wra >> ADDR_SECT_SHIFT) == fs->gc_skip_sector) {
+		return false;
+	}
+
+	threshold = fs->sector_size * CONFIG_NVS_BACKGROUND_GC_THRESHOLD / 100U;
+
+	return (fs->ate_wra - fs->data_wra) < threshold;
+}
+
+static void nvs_gc_bg_check(struct nvs_fs *fs)
+{
+	if ((fs->gc.phase == NVS_GC_IDLE) && nvs_gc_bg_needed(fs)) {
+		(void)k_work_submit_to_queue(&nvs_gc_workq, &fs->gc_work);
+	}
+}
+
+/* space that must stay free in the write sector while the next sector is
+ * garbage collected in the background. After a power loss nvs_startup()
+ * resumes the gc without erasing the write sector, as it can hold entries
+ * written in the meantime, so the entries still to copy must fit even after
+ * a write or a copy that was interrupted.
+ */
+static uint32_t nvs_gc_bg_reserve(struct nvs_fs *fs)
+{
+	return fs->gc.need + fs->gc.max;
+}
+
+/* finish the background gc at once, for a write that can not wait */
+static int nvs_gc_bg_finish(struct nvs_fs *fs)
+{
+	int rc;
+#ifdef CONFIG_NVS_GC_STATS
+	uint32_t start = k_cycle_get_32();
+#endif
+
+	rc = nvs_gc_walk(fs, &fs->gc, true, UINT32_MAX);
+	if (!rc) {
+		rc = nvs_gc_finish(fs, &fs->gc);
+	}
+
+	fs->gc.phase = NVS_GC_IDLE;
+
+#ifdef CONFIG_NVS_GC_STATS
+	nvs_gc_stats_time(fs, start);
+#endif
+	return rc;
+}
+
+/* background gc: measure the space needed by the sector after the next one,
+ * close the write sector early if this leaves enough free space, then copy
+ * the entries that are in use and erase the sector. Each run of the work
+ * does one step and resubmits itself, releasing the file system in between.
+ */
+static void nvs_gc_bg_work(struct k_work *work)
+{
+	struct nvs_fs *fs = CONTAINER_OF(work, struct nvs_fs, gc_work);
+	uint32_t sec_addr, need, max, threshold;
+	size_t ate_size;
+	int rc = 0;
+#ifdef CONFIG_NVS_GC_STATS
+	uint32_t start = k_cycle_get_32();
+#endif
+
+	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
+
+	ate_size = nvs_al_size(fs, sizeof(struct nvs_ate));
+	threshold = fs->sector_size * CONFIG_NVS_BACKGROUND_GC_THRESHOLD / 100U;
+
+	switch (fs->gc.phase) {
+	case NVS_GC_IDLE:
+		if (!fs->ready || !nvs_gc_bg_needed(fs)) {
+			goto end;
+		}
+
+		sec_addr = fs->ate_wra & ADDR_SECT_MASK;
+		nvs_sector_advance(fs, &sec_addr);
+		nvs_sector_advance(fs, &sec_addr);
+
+		rc = nvs_gc_start(fs, &fs->gc, sec_addr);
+		if (rc > 0) {
+			fs->gc.phase = NVS_GC_MEASURE;
+			rc = 0;
+		} else if (rc == 0) {
+			/* nothing to gc, the write sector can just be filled up */
+			fs->gc_skip_sector = fs->ate_wra >> ADDR_SECT_SHIFT;
+		}
+		break;
+	case NVS_GC_MEASURE:
+		rc = nvs_gc_walk(fs, &fs->gc, false, CONFIG_NVS_BACKGROUND_GC_STEP);
+		if (rc) {
+			break;
+		}
+
+		/* the gc'ed data must leave more space than the write sector
+		 * has left, otherwise leave it to nvs_write().
+		 */
+		if ((fs->gc.need + 2 * ate_size + threshold) > fs->sector_size) {
+			fs->gc_skip_sector = fs->ate_wra >> ADDR_SECT_SHIFT;
+			fs->gc.phase = NVS_GC_IDLE;
+			break;
+		}
+
+		need = fs->gc.need;
+		max = fs->gc.max;
+
+		rc = nvs_sector_close(fs);
+		if (rc) {
+			break;
+		}
+
+		rc = nvs_gc_start(fs, &fs->gc, fs->gc.sec_addr);
+		if (rc < 0) {
+			break;
+		}
+
+		/* entries can only have become unused since they were measured */
+		fs->gc.need = need;
+		fs->gc.max = max;
+		fs->gc.phase = NVS_GC_COPY;
+		rc = 0;
+		break;
+	case NVS_GC_COPY:
+		rc = nvs_gc_walk(fs, &fs->gc, true, CONFIG_NVS_BACKGROUND_GC_STEP);
+		if (rc) {
+			break;
+		}
+
+		rc = nvs_gc_finish(fs, &fs->gc);
+		fs->gc.phase = NVS_GC_IDLE;
+		break;
+	default:
+		break;
+	}
+
+	if (rc < 0) {
+		LOG_ERR("Background gc failed: %d", rc);
+		fs->gc.phase = NVS_GC_IDLE;
+	}
+
+#ifdef CONFIG_NVS_GC_STATS
+	nvs_gc_stats_time(fs, start);
+#endif
+
+	if (fs->gc.phase != NVS_GC_IDLE) {
+		(void)k_work_submit_to_queue(&nvs_gc_workq, &fs->gc_work);
+	}
+
+end:
+	k_mutex_unlock(&fs->nvs_lock);
+}
+
+static int nvs_gc_workq_init(void)
+{
+	k_work_queue_start(&nvs_gc_workq, nvs_gc_stack,
+			   K_KERNEL_STACK_SIZEOF(nvs_gc_stack),
+			   CONFIG_NVS_BACKGROUND_GC_THREAD_PRIO, NULL);
+	k_thread_name_set(&nvs_gc_workq.thread, "nvs_gc");
+
+	return 0;
+}
+
+SYS_INIT(nvs_gc_workq_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+#endif /* CONFIG_NVS_BACKGROUND_GC */
+
+/* possible data write after last ate write, update data_wra */
+static int nvs_recover_data_wra(struct nvs_fs *fs)
+{
+	int rc;
+	size_t empty_len;
+
+	while (fs->ate_wra > fs->data_wra) {
+		empty_len = fs->ate_wra - fs->data_wra;
+
+		rc = nvs_flash_cmp_const(fs, fs->data_wra,
+					 fs->flash_parameters->erase_value,
+					 empty_len);
+		if (rc < 0) {
+			return rc;
+		}
+		if (!rc) {
+			break;
+		}
+
+		fs->data_wra += fs->flash_parameters->write_block_size;
+	}
+
 	return 0;
 }
 
+#ifdef CONFIG_NVS_BACKGROUND_GC
+/* resume an interrupted gc without erasing the write sector, which can hold
+ * entries written while the gc was running in the background. The lookup
+ * cache is not built yet.
+ * return 0 when done, 1 if the entries still to copy might not fit in the
+ * write sector, errorcode on error.
+ */
+static int nvs_gc_resume(struct nvs_fs *fs)
+{
+	int rc;
+	struct nvs_gc_state gc;
+	uint32_t sec_addr;
+
+	rc = nvs_recover_data_wra(fs);
+	if (rc) {
+		return rc;
+	}
+
+#ifdef CONFIG_NVS_LOOKUP_CACHE
+	for (size_t i = 0; i < CONFIG_NVS_LOOKUP_CACHE_SIZE; i++) {
+		fs->lookup_cache[i] = fs->ate_wra;
+	}
+#endif
+
+	sec_addr = fs->ate_wra & ADDR_SECT_MASK;
+	nvs_sector_advance(fs, &sec_addr);
+
+	rc = nvs_gc_start(fs, &gc, sec_addr);
+	if (rc < 0) {
+		return rc;
+	}
+
+	rc = nvs_gc_walk(fs, &gc, false, UINT32_MAX);
+	if (rc) {
+		return rc;
+	}
+
+	if (fs->ate_wra < (fs->data_wra + gc.need)) {
+		return 1;
+	}
+
+	LOG_INF("Resuming gc, %" PRIu32 " bytes to move", gc.need);
+
+	rc = nvs_gc_start(fs, &gc, sec_addr);
+	if (rc < 0) {
+		return rc;
+	}
+
+	rc = nvs_gc_walk(fs, &gc, true, UINT32_MAX);
+	if (rc) {
+		return rc;
+	}
+
+	return nvs_gc_finish(fs, &gc);
+}
+#endif
+
 static int nvs_startup(struct nvs_fs *fs)
 {
 	int rc;
 	struct nvs_ate last_ate;
-	size_t ate_size, empty_len;
+	size_t ate_size;
 	/* Initialize addr to 0 for the case fs->sector_count == 0. This
 	 * should never happen as this is verified in nvs_mount() but both
 	 * Coverity and GCC believe the contrary.
@@ -819,7 +1205,8 @@ static int nvs_startup(struct nvs_fs *fs)
 	 * we might need to restart gc if it has not yet finished. Otherwise
 	 * just erase the sector.
 	 * When gc needs to be restarted, first erase the sector otherwise the
-	 * data might not fit into the sector.
+	 * data might not fit into the sector. A background gc is resumed
+	 * instead when the data fits, as the sector can hold new entries.
 	 */
 	addr = fs->ate_wra & ADDR_SECT_MASK;
 	nvs_sector_advance(fs, &addr);
@@ -858,6 +1245,12 @@ static int nvs_startup(struct nvs_fs *fs)
 			goto end;
 		}
 		LOG_INF("No GC Done marker found: restarting gc");
+#ifdef CONFIG_NVS_BACKGROUND_GC
+		rc = nvs_gc_resume(fs);
+		if (rc <= 0) {
+			goto end;
+		}
+#endif
 		rc = nvs_flash_erase_sector(fs, fs->ate_wra);
 		if (rc) {
 			goto end;
@@ -879,20 +1272,9 @@ static int nvs_startup(struct nvs_fs *fs)
 		goto end;
 	}
 
-	/* possible data write after last ate write, update data_wra */
-	while (fs->ate_wra > fs->data_wra) {
-		empty_len = fs->ate_wra - fs->data_wra;
-
-		rc = nvs_flash_cmp_const(fs, fs->data_wra, erase_value,
-				empty_len);
-		if (rc < 0) {
-			goto end;
-		}
-		if (!rc) {
-			break;
-		}
-
-		fs->data_wra += fs->flash_parameters->write_block_size;
+	rc = nvs_recover_data_wra(fs);
+	if (rc) {
+		goto end;
 	}
 
 	/* If the ate_wra is pointing to the first ate write location in a
@@ -931,12 +1313,22 @@ int nvs_clear(struct nvs_fs *fs)
 {
 	int rc;
 	uint32_t addr;
+#ifdef CONFIG_NVS_BACKGROUND_GC
+	struct k_work_sync sync;
+#endif
 
 	if (!fs->ready) {
 		LOG_ERR("NVS not initialized");
 		return -EACCES;
 	}
 
+#ifdef CONFIG_NVS_BACKGROUND_GC
+	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
+	fs->gc.phase = NVS_GC_IDLE;
+	k_mutex_unlock(&fs->nvs_lock);
+	(void)k_work_cancel_sync(&fs->gc_work, &sync);
+#endif
+
 	for (uint16_t i = 0; i < fs->sector_count; i++) {
 		addr = i << ADDR_SECT_SHIFT;
 		rc = nvs_flash_erase_sector(fs, addr);
@@ -957,6 +1349,25 @@ int nvs_mount(struct nvs_fs *fs)
 	int rc;
 	struct flash_pages_info info;
 	size_t write_block_size;
+#ifdef CONFIG_NVS_BACKGROUND_GC
+	struct k_work_sync sync;
+#endif
+
+#ifdef CONFIG_NVS_BACKGROUND_GC
+	/* the file system might be mounted again, with gc work still queued.
+	 * The work is initialized by a successful mount and only queued while
+	 * the file system is ready.
+	 */
+	if (fs->ready) {
+		(void)k_work_cancel_sync(&fs->gc_work, &sync);
+	}
+	k_work_init(&fs->gc_work, nvs_gc_bg_work);
+	fs->gc.phase = NVS_GC_IDLE;
+	fs->gc_skip_sector = UINT16_MAX;
+#endif
+#ifdef CONFIG_NVS_GC_STATS
+	memset(&fs->gc_stats, 0, sizeof(fs->gc_stats));
+#endif
 
 	k_mutex_init(&fs->nvs_lock);
 
@@ -1113,6 +1524,29 @@ no_cached_entry:
 			goto end;
 		}
 
+#ifdef CONFIG_NVS_BACKGROUND_GC
+		if (fs->gc.phase == NVS_GC_COPY) {
+			/* the next sector is being gc'ed into the write sector */
+			if (fs->ate_wra >= (fs->data_wra + required_space + ate_size +
+					    nvs_gc_bg_reserve(fs))) {
+				rc = nvs_flash_wrt_entry(fs, id, data, len);
+				if (rc) {
+					goto end;
+				}
+				break;
+			}
+
+			rc = nvs_gc_bg_finish(fs);
+			if (rc) {
+				goto end;
+			}
+#ifdef CONFIG_NVS_GC_STATS
+			fs->gc_stats.blocking_count++;
+#endif
+			continue;
+		}
+#endif
+
 		if (fs->ate_wra >= (fs->data_wra + required_space)) {
 
 			rc = nvs_flash_wrt_entry(fs, id, data, len);
@@ -1122,6 +1556,10 @@ no_cached_entry:
 			break;
 		}
 
+#ifdef CONFIG_NVS_BACKGROUND_GC
+		/* the sector measured in the background is gc'ed below */
+		fs->gc.phase = NVS_GC_IDLE;
+#endif
 
 		rc = nvs_sector_close(fs);
 		if (rc) {
@@ -1132,8 +1570,17 @@ no_cached_entry:
 		if (rc) {
 			goto end;
 		}
+#ifdef CONFIG_NVS_GC_STATS
+		fs->gc_stats.blocking_count++;
+#endif
 		gc_count++;
 	}
+#ifdef CONFIG_NVS_GC_STATS
+	fs->gc_stats.written += data_size + ate_size;
+#endif
+#ifdef CONFIG_NVS_BACKGROUND_GC
+	nvs_gc_bg_check(fs);
+#endif
 	rc = len;
 end:
 	k_mutex_unlock(&fs->nvs_lock);
@@ -1219,6 +1666,118 @@ ssize_t nvs_read(struct nvs_fs *fs, uint16_t id, void *data, size_t len)
 	return rc;
 }
 
+int nvs_walk(struct nvs_fs *fs, nvs_walk_cb_t cb, void *param)
+{
+	int rc;
+	uint32_t addr, ate_addr;
+	struct nvs_ate ate;
+
+	if (!fs->ready) {
+		LOG_ERR("NVS not initialized");
+		return -EACCES;
+	}
+
+	/* entries must not be moved by a background gc while they are walked */
+	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
+
+	addr = fs->ate_wra;
+
+	while (true) {
+		ate_addr = addr;
+		rc = nvs_prev_ate(fs, &addr, &ate);
+		if (rc) {
+			break;
+		}
+
+		/* skip sector close and gc done ate's */
+		if ((ate.id != 0xFFFF) && nvs_ate_valid(fs, &ate)) {
+			rc = cb(ate.id, ate_addr, ate.len, param);
+			if (rc) {
+				break;
+			}
+		}
+
+		if (addr == fs->ate_wra) {
+			break;
+		}
+	}
+
+	k_mutex_unlock(&fs->nvs_lock);
+
+	return rc;
+}
+
+ssize_t nvs_read_addr(struct nvs_fs *fs, uint16_t id, uint32_t addr, void *data, size_t len)
+{
+	int rc;
+	uint32_t rd_addr;
+	struct nvs_ate ate;
+	size_t ate_size;
+
+	if (!fs->ready) {
+		LOG_ERR("NVS not initialized");
+		return -EACCES;
+	}
+
+	ate_size = nvs_al_size(fs, sizeof(struct nvs_ate));
+
+	if (len > (fs->sector_size - 2 * ate_size)) {
+		return -EINVAL;
+	}
+
+	if ((addr >> ADDR_SECT_SHIFT) >= fs->sector_count) {
+		return -EINVAL;
+	}
+
+	/* the sector must not be erased by a background gc while it is read */
+	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
+
+	rc = nvs_flash_ate_rd(fs, addr, &ate);
+	if (rc) {
+		goto end;
+	}
+
+	/* the entry might have been moved or deleted since it was walked */
+	if ((ate.id != id) || !nvs_ate_valid(fs, &ate) || (ate.len == 0U)) {
+		rc = -ENOENT;
+		goto end;
+	}
+
+	rd_addr = addr & ADDR_SECT_MASK;
+	rd_addr += ate.offset;
+	rc = nvs_flash_rd(fs, rd_addr, data, MIN(len, ate.len));
+	if (rc) {
+		goto end;
+	}
+
+	rc = ate.len;
+end:
+	k_mutex_unlock(&fs->nvs_lock);
+
+	return rc;
+}
+
+int nvs_gc_stats_get(struct nvs_fs *fs, struct nvs_gc_stats *stats)
+{
+#ifdef CONFIG_NVS_GC_STATS
+	if (!fs->ready) {
+		LOG_ERR("NVS not initialized");
+		return -EACCES;
+	}
+
+	k_mutex_lock(&fs->nvs_lock, K_FOREVER);
+	*stats = fs->gc_stats;
+	k_mutex_unlock(&fs->nvs_lock);
+
+	return 0;
+#else
+	ARG_UNUSED(fs);
+	ARG_UNUSED(stats);
+
+	return -ENOTSUP;
+#endif
+}
+
 ssize_t nvs_calc_free_space(struct nvs_fs *fs)
 {
 
@@ -30,6 +30,18 @@ extern "C" {
 
 #define NVS_LOOKUP_CACHE_NO_ADDR 0xFFFFFFFF
 
+/*
+ * Garbage collection: no ate walked yet
+ */
+#define NVS_GC_NO_ADDR 0xFFFFFFFF
+
+/*
+ * Background garbage collection phases
+ */
+#define NVS_GC_IDLE 0
+#define NVS_GC_MEASURE 1 /* space needed by the next sector to gc is measured */
+#define NVS_GC_COPY 2 /* write sector is closed, the next sector is gc'ed */
+
 /* Allocation Table Entry */
 struct nvs_ate {
 	uint16_t id;	/* data id */
@@ -78,6 +78,14 @@ enum {
 	STATE_DOWNLOAD,
 };
 
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD)
+enum {
+	HASH_STATE_NONE = 0,
+	HASH_STATE_RUNNING,
+	HASH_STATE_DONE,
+};
+#endif
+
 static struct {
 	/** Whether an upload or download is currently in progress. */
 	uint8_t state;
@@ -106,6 +114,23 @@ static struct {
 
 	/** Delayed workqueue used to close the file after a period of inactivity. */
 	struct k_work_delayable file_close_work;
+
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD)
+	/**
+	 * Hash/checksum calculation on uploaded data, kept when the file is closed so that it
+	 * can carry on if the upload is resumed and be used once the upload has finished.
+	 */
+	struct {
+		/** Whether a calculation is in progress or finished. */
+		uint8_t state;
+
+		/** Amount of file data included in the calculation. */
+		size_t off;
+
+		/** Path of file the calculation is for. */
+		char path[CONFIG_MCUMGR_GRP_FS_PATH_LEN + 1];
+	} hash;
+#endif
 } fs_mgmt_ctxt;
 
 static const struct mgmt_handler fs_mgmt_handlers[];
@@ -198,6 +223,77 @@ static void fs_mgmt_upload_download_finish_check(void)
 	}
 }
 
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD)
+/**
+ * Prepares the hash/checksum calculation for data about to be uploaded to a file at an
+ * offset, returns whether the data is to be added to the calculation.
+ */
+static bool fs_mgmt_upload_hash_prepare(const char *path, size_t off)
+{
+	if (off == 0) {
+		/* New file contents */
+		strcpy(fs_mgmt_ctxt.hash.path, path);
+		fs_mgmt_ctxt.hash.off = 0;
+		fs_mgmt_ctxt.hash.state = (fs_mgmt_hash_checksum_upload_start() == 0 ?
+					   HASH_STATE_RUNNING : HASH_STATE_NONE);
+	} else if (strcmp(path, fs_mgmt_ctxt.hash.path) != 0) {
+		/* Another file, the calculation is not affected */
+		return false;
+	} else if (fs_mgmt_ctxt.hash.state != HASH_STATE_RUNNING ||
+		   fs_mgmt_ctxt.hash.off != off) {
+		/* Data the calculation has not seen is being added to the file */
+		fs_mgmt_ctxt.hash.state = HASH_STATE_NONE;
+	}
+
+	return fs_mgmt_ctxt.hash.state == HASH_STATE_RUNNING;
+}
+
+/**
+ * Adds data written to the file to the hash/checksum calculation.
+ */
+static void fs_mgmt_upload_hash_update(const uint8_t *data, size_t len, bool last)
+{
+	if (fs_mgmt_hash_checksum_upload_update(data, len) != 0 ||
+	    (last && fs_mgmt_hash_checksum_upload_finish() != 0)) {
+		fs_mgmt_ctxt.hash.state = HASH_STATE_NONE;
+		return;
+	}
+
+	fs_mgmt_ctxt.hash.off += len;
+
+	if (last) {
+		fs_mgmt_ctxt.hash.state = HASH_STATE_DONE;
+	}
+}
+
+/**
+ * Gets the output of a hash/checksum calculated while a file was uploaded, if there is one
+ * for the whole file.
+ */
+static bool fs_mgmt_upload_hash_get(const struct fs_mgmt_hash_checksum_group *group,
+				    const char *path, size_t file_len, uint8_t *output)
+{
+	bool found;
+
+	if (group->upload == NULL ||
+	    k_sem_take(&fs_mgmt_ctxt.lock_sem, FILE_SEMAPHORE_MAX_TAKE_TIME)) {
+		return false;
+	}
+
+	found = (fs_mgmt_ctxt.hash.state == HASH_STATE_DONE &&
+		 fs_mgmt_ctxt.hash.off == file_len &&
+		 strcmp(path, fs_mgmt_ctxt.hash.path) == 0);
+
+	if (found) {
+		memcpy(output, group->upload->output, group->output_size);
+	}
+
+	k_sem_give(&fs_mgmt_ctxt.lock_sem);
+
+	return found;
+}
+#endif
+
 /**
  * Command handler: fs file (read)
  */
@@ -360,6 +456,9 @@ static int fs_mgmt_file_upload(struct smp_streamer *ctxt)
 	struct zcbor_string file_data = { 0 };
 	size_t decoded = 0;
 	ssize_t existing_file_size = 0;
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD)
+	bool hash = false;
+#endif
 
 	struct zcbor_map_decode_key_val fs_upload_decode[] = {
 		ZCBOR_MAP_DECODE_KEY_DECODER("off", zcbor_uint64_decode, &off),
@@ -483,6 +582,11 @@ static int fs_mgmt_file_upload(struct smp_streamer *ctxt)
 	}
 
 	if (file_data.len > 0) {
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD)
+		/* Before the file is changed, a truncation failing still invalidates old results */
+		hash = fs_mgmt_upload_hash_prepare(file_name, off);
+#endif
+
 		/* Write the data chunk to the file. */
 		if (off == 0 && existing_file_size != 0) {
 			/* Offset is 0 and existing file exists with data, attempt to truncate
@@ -542,6 +646,12 @@ static int fs_mgmt_file_upload(struct smp_streamer *ctxt)
 		rc = fs_write(&fs_mgmt_ctxt.file, file_data.value, file_data.len);
 
 		if (rc < 0) {
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD)
+			if (hash) {
+				fs_mgmt_ctxt.hash.state = HASH_STATE_NONE;
+			}
+#endif
+
 			ok = smp_add_cmd_err(zse, MGMT_GROUP_ID_FS,
 					     FS_MGMT_ERR_FILE_WRITE_FAILED);
 			fs_mgmt_cleanup();
@@ -549,6 +659,14 @@ static int fs_mgmt_file_upload(struct smp_streamer *ctxt)
 		}
 
 		fs_mgmt_ctxt.off += file_data.len;
+
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD)
+		if (hash) {
+			fs_mgmt_upload_hash_update(file_data.value, file_data.len,
+						   (fs_mgmt_ctxt.len > 0 &&
+						    fs_mgmt_ctxt.off >= fs_mgmt_ctxt.len));
+		}
+#endif
 	}
 
 	/* Send the response. */
@@ -743,6 +861,14 @@ static int fs_mgmt_file_hash_checksum(struct smp_streamer *ctxt)
 		goto end;
 	}
 
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD)
+	if (off == 0 && len >= file_len &&
+	    fs_mgmt_upload_hash_get(group, path, file_len, (uint8_t *)output)) {
+		/* Whole file requested, calculated while it was uploaded */
+		goto encode;
+	}
+#endif
+
 	/* Open file for reading and pass to hash/checksum generation function */
 	fs_file_t_init(&file);
 	rc = fs_open(&file, path, FS_O_READ);
@@ -784,6 +910,9 @@ static int fs_mgmt_file_hash_checksum(struct smp_streamer *ctxt)
 		goto end;
 	}
 
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD)
+encode:
+#endif
 	ok &= zcbor_tstr_put_lit(zse, "type")	&&
 	      zcbor_tstr_put_term(zse, type_arr, sizeof(type_arr));
 
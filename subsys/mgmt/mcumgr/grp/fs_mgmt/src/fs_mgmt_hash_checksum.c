@@ -52,3 +52,68 @@ void fs_mgmt_hash_checksum_find_handlers(fs_mgmt_hash_checksum_list_cb cb, void
 		cb(group, user_data);
 	}
 }
+
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD)
+int fs_mgmt_hash_checksum_upload_start(void)
+{
+	sys_snode_t *snp, *sns;
+	int rc;
+
+	SYS_SLIST_FOR_EACH_NODE_SAFE(&fs_mgmt_hash_checksum_group_list, snp, sns) {
+		struct fs_mgmt_hash_checksum_group *group =
+			CONTAINER_OF(snp, struct fs_mgmt_hash_checksum_group, node);
+
+		if (group->upload != NULL) {
+			rc = group->upload->start();
+
+			if (rc != 0) {
+				return rc;
+			}
+		}
+	}
+
+	return 0;
+}
+
+int fs_mgmt_hash_checksum_upload_update(const uint8_t *data, size_t len)
+{
+	sys_snode_t *snp, *sns;
+	int rc;
+
+	SYS_SLIST_FOR_EACH_NODE_SAFE(&fs_mgmt_hash_checksum_group_list, snp, sns) {
+		struct fs_mgmt_hash_checksum_group *group =
+			CONTAINER_OF(snp, struct fs_mgmt_hash_checksum_group, node);
+
+		if (group->upload != NULL) {
+			rc = group->upload->update(data, len);
+
+			if (rc != 0) {
+				return rc;
+			}
+		}
+	}
+
+	return 0;
+}
+
+int fs_mgmt_hash_checksum_upload_finish(void)
+{
+	sys_snode_t *snp, *sns;
+	int rc;
+
+	SYS_SLIST_FOR_EACH_NODE_SAFE(&fs_mgmt_hash_checksum_group_list, snp, sns) {
+		struct fs_mgmt_hash_checksum_group *group =
+			CONTAINER_OF(snp, struct fs_mgmt_hash_checksum_group, node);
+
+		if (group->upload != NULL) {
+			rc = group->upload->finish(group->upload->output);
+
+			if (rc != 0) {
+				return rc;
+			}
+		}
+	}
+
+	return 0;
+}
+#endif
@@ -50,11 +50,47 @@ static int fs_mgmt_hash_checksum_crc32(struct fs_file_t *file, uint8_t *output,
 	return 0;
 }
 
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD)
+static uint32_t upload_crc32;
+static uint8_t upload_output[CRC32_SIZE];
+
+static int fs_mgmt_hash_checksum_crc32_upload_start(void)
+{
+	upload_crc32 = 0;
+
+	return 0;
+}
+
+static int fs_mgmt_hash_checksum_crc32_upload_update(const uint8_t *data, size_t len)
+{
+	upload_crc32 = crc32_ieee_update(upload_crc32, data, len);
+
+	return 0;
+}
+
+static int fs_mgmt_hash_checksum_crc32_upload_finish(uint8_t *output)
+{
+	memcpy(output, &upload_crc32, sizeof(upload_crc32));
+
+	return 0;
+}
+
+static const struct fs_mgmt_hash_checksum_upload_api crc32_upload = {
+	.start = fs_mgmt_hash_checksum_crc32_upload_start,
+	.update = fs_mgmt_hash_checksum_crc32_upload_update,
+	.finish = fs_mgmt_hash_checksum_crc32_upload_finish,
+	.output = upload_output,
+};
+#endif
+
 static struct fs_mgmt_hash_checksum_group crc32 = {
 	.group_name = "crc32",
 	.byte_string = false,
 	.output_size = CRC32_SIZE,
 	.function = fs_mgmt_hash_checksum_crc32,
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD)
+	.upload = &crc32_upload,
+#endif
 };
 
 void fs_mgmt_hash_checksum_register_crc32(void)
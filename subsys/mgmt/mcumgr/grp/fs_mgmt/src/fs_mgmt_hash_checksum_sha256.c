@@ -133,11 +133,96 @@ error:
 }
 #endif
 
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD)
+static uint8_t upload_output[SHA256_DIGEST_SIZE];
+
+#if defined(CONFIG_TINYCRYPT_SHA256)
+static struct tc_sha256_state_struct upload_sha;
+
+static int fs_mgmt_hash_checksum_sha256_upload_start(void)
+{
+	if (tc_sha256_init(&upload_sha) != TC_CRYPTO_SUCCESS) {
+		return MGMT_ERR_EUNKNOWN;
+	}
+
+	return 0;
+}
+
+static int fs_mgmt_hash_checksum_sha256_upload_update(const uint8_t *data, size_t len)
+{
+	if (tc_sha256_update(&upload_sha, data, len) != TC_CRYPTO_SUCCESS) {
+		return MGMT_ERR_EUNKNOWN;
+	}
+
+	return 0;
+}
+
+static int fs_mgmt_hash_checksum_sha256_upload_finish(uint8_t *output)
+{
+	if (tc_sha256_final(output, &upload_sha) != TC_CRYPTO_SUCCESS) {
+		return MGMT_ERR_EUNKNOWN;
+	}
+
+	return 0;
+}
+#else
+/* Released when finished or restarted, freeing a context that is not set up is harmless */
+static mbedtls_md_context_t upload_hash_ctx;
+
+static int fs_mgmt_hash_checksum_sha256_upload_start(void)
+{
+	mbedtls_md_free(&upload_hash_ctx);
+	mbedtls_md_init(&upload_hash_ctx);
+
+	if (mbedtls_md_setup(&upload_hash_ctx, mbedtls_md_info_from_type(MBEDTLS_MD_SHA256),
+			     0) != 0 ||
+	    mbedtls_md_starts(&upload_hash_ctx) != 0) {
+		mbedtls_md_free(&upload_hash_ctx);
+		return MGMT_ERR_EUNKNOWN;
+	}
+
+	return 0;
+}
+
+static int fs_mgmt_hash_checksum_sha256_upload_update(const uint8_t *data, size_t len)
+{
+	if (mbedtls_md_update(&upload_hash_ctx, data, len) != 0) {
+		return MGMT_ERR_EUNKNOWN;
+	}
+
+	return 0;
+}
+
+static int fs_mgmt_hash_checksum_sha256_upload_finish(uint8_t *output)
+{
+	int rc = 0;
+
+	if (mbedtls_md_finish(&upload_hash_ctx, output) != 0) {
+		rc = MGMT_ERR_EUNKNOWN;
+	}
+
+	mbedtls_md_free(&upload_hash_ctx);
+
+	return rc;
+}
+#endif
+
+static const struct fs_mgmt_hash_checksum_upload_api sha256_upload = {
+	.start = fs_mgmt_hash_checksum_sha256_upload_start,
+	.update = fs_mgmt_hash_checksum_sha256_upload_update,
+	.finish = fs_mgmt_hash_checksum_sha256_upload_finish,
+	.output = upload_output,
+};
+#endif
+
 static struct fs_mgmt_hash_checksum_group sha256 = {
 	.group_name = "sha256",
 	.byte_string = true,
 	.output_size = SHA256_DIGEST_SIZE,
 	.function = fs_mgmt_hash_checksum_sha256,
+#if defined(CONFIG_MCUMGR_GRP_FS_CHECKSUM_HASH_UPLOAD)
+	.upload = &sha256_upload,
+#endif
 };
 
 void fs_mgmt_hash_checksum_register_sha256(void)
@@ -29,6 +29,15 @@
 #include <zephyr/dfu/flash_img.h>
 #endif
 
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_HASH
+#if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_TC)
+#include <tinycrypt/constants.h>
+#include <tinycrypt/sha256.h>
+#else
+#include <mbedtls/md.h>
+#endif
+#endif
+
 #ifdef CONFIG_MCUMGR_MGMT_NOTIFICATION_HOOKS
 #include <zephyr/mgmt/mcumgr/mgmt/callbacks.h>
 #endif
@@ -81,6 +90,27 @@ struct img_mgmt_state g_img_mgmt_state;
 static K_MUTEX_DEFINE(img_mgmt_mutex);
 #endif
 
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW
+/* Upload chunk received ahead of the next expected offset, len is 0 when unused */
+struct img_mgmt_window_chunk {
+	size_t off;
+	size_t len;
+	uint8_t data[CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW_CHUNK_SIZE];
+};
+
+static struct img_mgmt_window_chunk img_mgmt_window[CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW_CHUNKS];
+#endif
+
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_HASH
+/* Hash of the image data written so far, only valid when img_mgmt_upload_hash_ok is set */
+#if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_TC)
+static struct tc_sha256_state_struct img_mgmt_upload_hash;
+#else
+static mbedtls_md_context_t img_mgmt_upload_hash;
+#endif
+static bool img_mgmt_upload_hash_ok;
+#endif
+
 #ifdef CONFIG_MCUMGR_GRP_IMG_VERBOSE_ERR
 const char *img_mgmt_err_str_app_reject = "app reject";
 const char *img_mgmt_err_str_hdr_malformed = "header malformed";
@@ -302,6 +332,157 @@ img_mgmt_find_by_hash(uint8_t *find, struct image_version *ver)
 	return -1;
 }
 
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_HASH
+static void img_mgmt_upload_hash_start(void)
+{
+#if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_TC)
+	img_mgmt_upload_hash_ok = (tc_sha256_init(&img_mgmt_upload_hash) == TC_CRYPTO_SUCCESS);
+#else
+	mbedtls_md_free(&img_mgmt_upload_hash);
+	mbedtls_md_init(&img_mgmt_upload_hash);
+
+	img_mgmt_upload_hash_ok =
+		(mbedtls_md_setup(&img_mgmt_upload_hash,
+				  mbedtls_md_info_from_type(MBEDTLS_MD_SHA256), 0) == 0 &&
+		 mbedtls_md_starts(&img_mgmt_upload_hash) == 0);
+#endif
+}
+
+static void img_mgmt_upload_hash_update(const uint8_t *data, size_t len)
+{
+	if (!img_mgmt_upload_hash_ok) {
+		return;
+	}
+
+#if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_TC)
+	img_mgmt_upload_hash_ok = (tc_sha256_update(&img_mgmt_upload_hash, data, len) ==
+				   TC_CRYPTO_SUCCESS);
+#else
+	img_mgmt_upload_hash_ok = (mbedtls_md_update(&img_mgmt_upload_hash, data, len) == 0);
+#endif
+}
+
+/*
+ * Finishes the hash of the uploaded image, returns true and sets match when it could be
+ * checked against the hash provided by the client, the image has to be read back otherwise.
+ */
+static bool img_mgmt_upload_hash_check(bool *match)
+{
+	uint8_t hash[IMG_MGMT_DATA_SHA_LEN];
+	bool ok = img_mgmt_upload_hash_ok;
+
+	img_mgmt_upload_hash_ok = false;
+
+#if defined(CONFIG_FLASH_AREA_CHECK_INTEGRITY_TC)
+	ok = ok && tc_sha256_final(hash, &img_mgmt_upload_hash) == TC_CRYPTO_SUCCESS;
+#else
+	ok = ok && mbedtls_md_finish(&img_mgmt_upload_hash, hash) == 0;
+	mbedtls_md_free(&img_mgmt_upload_hash);
+#endif
+
+	if (ok) {
+		*match = (g_img_mgmt_state.data_sha_len == IMG_MGMT_DATA_SHA_LEN &&
+			  memcmp(hash, g_img_mgmt_state.data_sha, IMG_MGMT_DATA_SHA_LEN) == 0);
+	}
+
+	return ok;
+}
+#endif
+
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW
+static void img_mgmt_window_clear(void)
+{
+	for (int i = 0; i < ARRAY_SIZE(img_mgmt_window); i++) {
+		img_mgmt_window[i].len = 0;
+	}
+}
+
+/*
+ * Holds the data of a request that is ahead of the next expected offset. The data is
+ * dropped if it is too large or all the chunks are in use; the client sends it again once
+ * the response offsets show that it is missing.
+ */
+static void img_mgmt_window_store(const struct img_mgmt_upload_req *req)
+{
+	struct img_mgmt_window_chunk *chunk = NULL;
+
+	if (req->img_data.len == 0 ||
+	    req->img_data.len > CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW_CHUNK_SIZE) {
+		return;
+	}
+
+	for (int i = 0; i < ARRAY_SIZE(img_mgmt_window); i++) {
+		if (img_mgmt_window[i].len == 0) {
+			if (chunk == NULL) {
+				chunk = &img_mgmt_window[i];
+			}
+		} else if (img_mgmt_window[i].off == req->off) {
+			/* Already held, this is a retransmission */
+			return;
+		}
+	}
+
+	if (chunk == NULL) {
+		LOG_DBG("No room for chunk at %zu", req->off);
+		return;
+	}
+
+	chunk->off = req->off;
+	chunk->len = req->img_data.len;
+	memcpy(chunk->data, req->img_data.value, req->img_data.len);
+}
+
+/*
+ * Writes the held chunks that continue the data written so far, sets last when they
+ * complete the image.
+ */
+static int img_mgmt_window_drain(bool *last)
+{
+	struct img_mgmt_window_chunk *chunk;
+	bool progress = true;
+	size_t skip;
+	size_t len;
+	int rc;
+
+	while (progress && !*last) {
+		progress = false;
+
+		for (int i = 0; i < ARRAY_SIZE(img_mgmt_window) && !*last; i++) {
+			chunk = &img_mgmt_window[i];
+
+			if (chunk->len == 0 || chunk->off > g_img_mgmt_state.off) {
+				continue;
+			}
+
+			/* A retransmission may have used different chunk boundaries */
+			skip = g_img_mgmt_state.off - chunk->off;
+
+			if (skip < chunk->len) {
+				len = chunk->len - skip;
+				*last = (g_img_mgmt_state.off + len == g_img_mgmt_state.size);
+
+				rc = img_mgmt_write_image_data(g_img_mgmt_state.off,
+							       &chunk->data[skip], len, *last);
+				if (rc != 0) {
+					return rc;
+				}
+
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_HASH
+				img_mgmt_upload_hash_update(&chunk->data[skip], len);
+#endif
+
+				g_img_mgmt_state.off += len;
+				progress = true;
+			}
+
+			chunk->len = 0;
+		}
+	}
+
+	return 0;
+}
+#endif
+
 /*
  * Resets upload status to defaults (no upload in progress)
  */
@@ -314,6 +495,12 @@ static void img_mgmt_reset_upload(void)
 	img_mgmt_take_lock();
 	memset(&g_img_mgmt_state, 0, sizeof(g_img_mgmt_state));
 	g_img_mgmt_state.area_id = -1;
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW
+	img_mgmt_window_clear();
+#endif
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_HASH
+	img_mgmt_upload_hash_ok = false;
+#endif
 	img_mgmt_release_lock();
 }
 
@@ -388,11 +575,25 @@ end:
 	return MGMT_ERR_EOK;
 }
 
+/*
+ * Responds to an upload request with the offset written so far, chunk_len is the length of
+ * the data of the request.
+ */
 static int
-img_mgmt_upload_good_rsp(struct smp_streamer *ctxt)
+img_mgmt_upload_good_rsp(struct smp_streamer *ctxt, size_t chunk_len)
 {
 	zcbor_state_t *zse = ctxt->writer->zs;
 	bool ok = true;
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW
+	uint32_t window = CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW_CHUNKS + 1;
+
+	/* Chunks that cannot be held out of order have to be sent one at a time */
+	if (chunk_len > CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW_CHUNK_SIZE) {
+		window = 1;
+	}
+#else
+	ARG_UNUSED(chunk_len);
+#endif
 
 	if (IS_ENABLED(CONFIG_MCUMGR_SMP_LEGACY_RC_BEHAVIOUR)) {
 		ok = zcbor_tstr_put_lit(zse, "rc")		&&
@@ -402,6 +603,12 @@ img_mgmt_upload_good_rsp(struct smp_streamer *ctxt)
 	ok = ok && zcbor_tstr_put_lit(zse, "off")		&&
 		   zcbor_size_put(zse, g_img_mgmt_state.off);
 
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW
+	/* Requests the client may have in flight: one in order and the ones that can be held */
+	ok = ok && zcbor_tstr_put_lit(zse, "win")		&&
+		   zcbor_uint32_put(zse, window);
+#endif
+
 	return ok ? MGMT_ERR_EOK : MGMT_ERR_EMSGSIZE;
 }
 
@@ -524,7 +731,7 @@ defined(CONFIG_MCUMGR_SMP_COMMAND_STATUS_HOOKS)
 		/* Request specifies incorrect offset.  Respond with a success code and
 		 * the correct offset.
 		 */
-		rc = img_mgmt_upload_good_rsp(ctxt);
+		rc = img_mgmt_upload_good_rsp(ctxt, req.img_data.len);
 		img_mgmt_release_lock();
 		return rc;
 	}
@@ -551,6 +758,16 @@ defined(CONFIG_MCUMGR_SMP_COMMAND_STATUS_HOOKS)
 	}
 #endif
 
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW
+	if (action.defer) {
+		/* Hold the data and respond with the offset that is still missing */
+		img_mgmt_window_store(&req);
+		rc = img_mgmt_upload_good_rsp(ctxt, req.img_data.len);
+		img_mgmt_release_lock();
+		return rc;
+	}
+#endif
+
 	/* Remember flash area ID and image size for subsequent upload requests. */
 	g_img_mgmt_state.area_id = action.area_id;
 	g_img_mgmt_state.size = action.size;
@@ -566,6 +783,10 @@ defined(CONFIG_MCUMGR_SMP_COMMAND_STATUS_HOOKS)
 
 		g_img_mgmt_state.off = 0;
 
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW
+		img_mgmt_window_clear();
+#endif
+
 #if defined(CONFIG_MCUMGR_GRP_IMG_STATUS_HOOKS)
 		(void)mgmt_callback_notify(MGMT_EVT_OP_IMG_MGMT_DFU_STARTED, NULL, 0, &err_rc,
 					   &err_group);
@@ -613,6 +834,10 @@ defined(CONFIG_MCUMGR_SMP_COMMAND_STATUS_HOOKS)
 		}
 #endif
 
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_HASH
+		img_mgmt_upload_hash_start();
+#endif
+
 #ifndef CONFIG_IMG_ERASE_PROGRESSIVELY
 		/* erase the entire req.size all at once */
 		if (action.erase) {
@@ -642,7 +867,20 @@ defined(CONFIG_MCUMGR_SMP_COMMAND_STATUS_HOOKS)
 						    last);
 		if (rc == 0) {
 			g_img_mgmt_state.off += action.write_bytes;
-		} else {
+
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_HASH
+			img_mgmt_upload_hash_update(req.img_data.value, action.write_bytes);
+#endif
+
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW
+			if (!last) {
+				/* Write the held data that now follows */
+				rc = img_mgmt_window_drain(&last);
+			}
+#endif
+		}
+
+		if (rc != 0) {
 			/* Write failed, currently not able to recover from this */
 #if defined(CONFIG_MCUMGR_SMP_COMMAND_STATUS_HOOKS)
 			cmd_status_arg.status = IMG_MGMT_ID_UPLOAD_STATUS_COMPLETE;
@@ -666,8 +904,18 @@ defined(CONFIG_MCUMGR_SMP_COMMAND_STATUS_HOOKS)
 
 #ifdef CONFIG_IMG_ENABLE_IMAGE_CHECK
 			static struct flash_img_context ctx;
+			bool checked = false;
 
-			if (flash_img_init_id(&ctx, g_img_mgmt_state.area_id) == 0) {
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_HASH
+			/* No need to read the image back when it was hashed as it was written */
+			checked = img_mgmt_upload_hash_check(&data_match);
+#endif
+
+			if (checked) {
+				if (!data_match) {
+					LOG_ERR("Uploaded image sha256 hash verification failed");
+				}
+			} else if (flash_img_init_id(&ctx, g_img_mgmt_state.area_id) == 0) {
 				struct flash_img_check fic = {
 					.match = g_img_mgmt_state.data_sha,
 					.clen = g_img_mgmt_state.size,
@@ -710,7 +958,7 @@ end:
 
 		img_mgmt_reset_upload();
 	} else {
-		rc = img_mgmt_upload_good_rsp(ctxt);
+		rc = img_mgmt_upload_good_rsp(ctxt, req.img_data.len);
 
 #ifdef CONFIG_IMG_ENABLE_IMAGE_CHECK
 		if (last && rc == MGMT_ERR_EOK) {
@@ -748,11 +748,19 @@ skip_size_check:
 		action->erase = (rc == 0);
 #endif
 	} else {
+		bool ahead = false;
+
 		/* Continuation of upload. */
 		action->area_id = g_img_mgmt_state.area_id;
 		action->size = g_img_mgmt_state.size;
 
-		if (req->off != g_img_mgmt_state.off) {
+#ifdef CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW
+		/* Data ahead of the expected offset is held until the data before it arrives */
+		ahead = (g_img_mgmt_state.area_id != -1 && req->off > g_img_mgmt_state.off);
+		action->defer = ahead;
+#endif
+
+		if (req->off != g_img_mgmt_state.off && !ahead) {
 			/*
 			 * Invalid offset. Drop the data, and respond with the offset we're
 			 * expecting data for.
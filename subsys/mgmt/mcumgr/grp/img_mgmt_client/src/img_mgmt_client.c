@@ -41,6 +41,17 @@ static struct mcumgr_image_upload *image_upload_buf;
 static K_SEM_DEFINE(mcumgr_img_client_grp_sem, 0, 1);
 static K_MUTEX_DEFINE(mcumgr_img_client_grp_mutex);
 
+/* Image upload requests in flight, updated by the responses */
+static struct {
+	struct k_spinlock lock;
+	/* Requests sent and not responded to yet */
+	int in_flight;
+	/* Highest offset reported by the server */
+	size_t offset;
+	/* Lowest offset reported by the server, below the start when it lost the upload */
+	size_t low_offset;
+} upload_window;
+
 static const char smp_images_str[] = "images";
 #define IMAGES_STR_LEN (sizeof(smp_images_str) - 1)
 
@@ -189,33 +200,50 @@ static int image_upload_res_fn(struct net_buf *nb, void *user_data)
 	zcbor_state_t zsd[CONFIG_MCUMGR_SMP_CBOR_MAX_DECODING_LEVELS + 2];
 	size_t decoded;
 	int rc;
+	int status;
 	int32_t res_rc = MGMT_ERR_EOK;
+	size_t offset = SIZE_MAX;
+	uint32_t window = 1;
+	k_spinlock_key_t key;
 
 	struct zcbor_map_decode_key_val upload_res_decode[] = {
-		ZCBOR_MAP_DECODE_KEY_DECODER("off", zcbor_size_decode,
-					     &image_upload_buf->image_upload_offset),
-		ZCBOR_MAP_DECODE_KEY_DECODER("rc", zcbor_int32_decode, &res_rc)};
+		ZCBOR_MAP_DECODE_KEY_DECODER("off", zcbor_size_decode, &offset),
+		ZCBOR_MAP_DECODE_KEY_DECODER("rc", zcbor_int32_decode, &res_rc),
+		ZCBOR_MAP_DECODE_KEY_DECODER("win", zcbor_uint32_decode, &window)};
 
 	if (!nb) {
-		image_upload_buf->status = MGMT_ERR_ETIMEOUT;
+		status = MGMT_ERR_ETIMEOUT;
 		goto end;
 	}
 
 	zcbor_new_decode_state(zsd, ARRAY_SIZE(zsd), nb->data, nb->len, 1, NULL, 0);
 
 	rc = zcbor_map_decode_bulk(zsd, upload_res_decode, ARRAY_SIZE(upload_res_decode), &decoded);
-	if (rc || image_upload_buf->image_upload_offset == SIZE_MAX) {
-		image_upload_buf->status = MGMT_ERR_EINVAL;
+	if (rc || offset == SIZE_MAX) {
+		status = MGMT_ERR_EINVAL;
 		goto end;
 	}
-	image_upload_buf->status = res_rc;
-
-	active_client->upload.offset = image_upload_buf->image_upload_offset;
+	status = res_rc;
 end:
-	/* Set status for Upload request handler */
-	rc = image_upload_buf->status;
+	key = k_spin_lock(&upload_window.lock);
+	upload_window.in_flight--;
+
+	if (status != MGMT_ERR_EOK) {
+		/* Keep the first error */
+		if (image_upload_buf->status == MGMT_ERR_EOK) {
+			image_upload_buf->status = status;
+		}
+	} else {
+		upload_window.offset = MAX(upload_window.offset, offset);
+		upload_window.low_offset = MIN(upload_window.low_offset, offset);
+		active_client->upload.window = CLAMP(window, 1,
+						     CONFIG_MCUMGR_GRP_IMG_CLIENT_UPLOAD_WINDOW);
+	}
+	k_spin_unlock(&upload_window.lock, key);
+
+	/* Wake up the Upload request handler */
 	k_sem_give(user_data);
-	return rc;
+	return status;
 }
 
 static int erase_res_fn(struct net_buf *nb, void *user_data)
@@ -310,6 +338,8 @@ int img_mgmt_client_upload_init(struct img_mgmt_client *client, size_t image_siz
 	client->upload.image_size = image_size;
 	client->upload.offset = 0;
 	client->upload.image_num = image_num;
+	/* Until the server tells otherwise, wait for each response before sending more */
+	client->upload.window = 1;
 	if (image_hash) {
 		memcpy(client->upload.sha256, image_hash, IMG_MGMT_DATA_SHA_LEN);
 		client->upload.hash_initialized = true;
@@ -328,23 +358,93 @@ int img_mgmt_client_upload_init(struct img_mgmt_client *client, size_t image_siz
 	return rc;
 }
 
-int img_mgmt_client_upload(struct img_mgmt_client *client, const uint8_t *data, size_t length,
-			   struct mcumgr_image_upload *res_buf)
+/* Sends an upload request for the image data at offset, data points to the data at base */
+static int image_upload_send(size_t offset, size_t base, const uint8_t *data, size_t length)
 {
 	struct net_buf *nb;
-	const uint8_t *write_ptr;
 	int rc;
 	uint32_t map_count;
 	bool ok;
-	size_t write_length, max_data_length, offset_before_send, request_length, wrote_length;
+	k_spinlock_key_t key;
 	zcbor_state_t zse[CONFIG_MCUMGR_SMP_CBOR_MAX_DECODING_LEVELS + 2];
 
+	nb = smp_client_buf_allocation(active_client->smp_client, MGMT_GROUP_ID_IMAGE,
+				       IMG_MGMT_ID_UPLOAD, MGMT_OP_WRITE, SMP_MCUMGR_VERSION_1);
+	if (!nb) {
+		return MGMT_ERR_ENOMEM;
+	}
+
+	zcbor_new_encode_state(zse, ARRAY_SIZE(zse), nb->data + nb->len, net_buf_tailroom(nb), 0);
+	if (offset) {
+		map_count = 6;
+	} else if (active_client->upload.hash_initialized) {
+		map_count = 12;
+	} else {
+		map_count = 10;
+	}
+
+	/* Init map start and write image info, data and offset */
+	ok = zcbor_map_start_encode(zse, map_count) && zcbor_tstr_put_lit(zse, "image") &&
+	     zcbor_uint32_put(zse, active_client->upload.image_num) &&
+	     zcbor_tstr_put_lit(zse, "data") &&
+	     zcbor_bstr_encode_ptr(zse, data + (offset - base), length) &&
+	     zcbor_tstr_put_lit(zse, "off") && zcbor_size_put(zse, offset);
+	/* Write Len and configured hash when offset is zero */
+	if (ok && !offset) {
+		ok = zcbor_tstr_put_lit(zse, "len") &&
+		     zcbor_size_put(zse, active_client->upload.image_size);
+		if (ok && active_client->upload.hash_initialized) {
+			ok = zcbor_tstr_put_lit(zse, "sha") &&
+			     zcbor_bstr_encode_ptr(zse, active_client->upload.sha256,
+						   IMG_MGMT_DATA_SHA_LEN);
+		}
+	}
+
+	if (ok) {
+		ok = zcbor_map_end_encode(zse, map_count);
+	}
+
+	if (!ok) {
+		LOG_ERR("Failed to encode Image Upload packet");
+		smp_packet_free(nb);
+		return MGMT_ERR_ENOMEM;
+	}
+
+	nb->len = zse->payload - nb->data;
+
+	/* The response may come before smp_client_send_cmd() returns */
+	key = k_spin_lock(&upload_window.lock);
+	upload_window.in_flight++;
+	k_spin_unlock(&upload_window.lock, key);
+
+	rc = smp_client_send_cmd(active_client->smp_client, nb, image_upload_res_fn,
+				 &mcumgr_img_client_grp_sem,
+				 CONFIG_MCUMGR_GRP_IMG_FLASH_OPERATION_TIMEOUT);
+	if (rc) {
+		LOG_ERR("Failed to send SMP Upload packet, err: %d", rc);
+		smp_packet_free(nb);
+
+		key = k_spin_lock(&upload_window.lock);
+		upload_window.in_flight--;
+		k_spin_unlock(&upload_window.lock, key);
+	}
+
+	return rc;
+}
+
+int img_mgmt_client_upload(struct img_mgmt_client *client, const uint8_t *data, size_t length,
+			   struct mcumgr_image_upload *res_buf)
+{
+	size_t max_data_length, base, end, next, resend, write_length;
+	bool send, done;
+	int in_flight;
+	int rc;
+	k_spinlock_key_t key;
+
 	k_mutex_lock(&mcumgr_img_client_grp_mutex, K_FOREVER);
 	active_client = client;
 	image_upload_buf = res_buf;
 
-	request_length = length;
-	wrote_length = 0;
 	/* Calculate max data length based on
 	 * net_buf size - (SMP header + CBOR message_len + 16-bit CRC + 16-bit length)
 	 */
@@ -356,91 +456,84 @@ int img_mgmt_client_upload(struct img_mgmt_client *client, const uint8_t *data,
 			(max_data_length % CONFIG_MCUMGR_GRP_IMG_UPLOAD_DATA_ALIGNMENT_SIZE);
 	}
 
-	while (request_length != wrote_length) {
-		write_ptr = data + wrote_length;
-		write_length = request_length - wrote_length;
-		if (write_length > max_data_length) {
-			write_length = max_data_length;
-		}
-
-		nb = smp_client_buf_allocation(active_client->smp_client, MGMT_GROUP_ID_IMAGE,
-					       IMG_MGMT_ID_UPLOAD, MGMT_OP_WRITE,
-					       SMP_MCUMGR_VERSION_1);
-		if (!nb) {
-			image_upload_buf->status = MGMT_ERR_ENOMEM;
-			goto end;
-		}
+	base = active_client->upload.offset;
+	end = base + length;
+	next = base;
+	resend = SIZE_MAX;
 
-		zcbor_new_encode_state(zse, ARRAY_SIZE(zse), nb->data + nb->len,
-				       net_buf_tailroom(nb), 0);
-		if (active_client->upload.offset) {
-			map_count = 6;
-		} else if (active_client->upload.hash_initialized) {
-			map_count = 12;
-		} else {
-			map_count = 10;
-		}
+	image_upload_buf->status = MGMT_ERR_EOK;
+	upload_window.in_flight = 0;
+	upload_window.offset = base;
+	upload_window.low_offset = base;
+	k_sem_reset(&mcumgr_img_client_grp_sem);
 
-		/* Init map start and write image info, data and offset */
-		ok = zcbor_map_start_encode(zse, map_count) && zcbor_tstr_put_lit(zse, "image") &&
-		     zcbor_uint32_put(zse, active_client->upload.image_num) &&
-		     zcbor_tstr_put_lit(zse, "data") &&
-		     zcbor_bstr_encode_ptr(zse, write_ptr, write_length) &&
-		     zcbor_tstr_put_lit(zse, "off") &&
-		     zcbor_size_put(zse, active_client->upload.offset);
-		/* Write Len and configured hash when offset is zero */
-		if (ok && !active_client->upload.offset) {
-			ok = zcbor_tstr_put_lit(zse, "len") &&
-			     zcbor_size_put(zse, active_client->upload.image_size);
-			if (ok && active_client->upload.hash_initialized) {
-				ok = zcbor_tstr_put_lit(zse, "sha") &&
-				     zcbor_bstr_encode_ptr(zse, active_client->upload.sha256,
-							   IMG_MGMT_DATA_SHA_LEN);
+	/*
+	 * Keep up to the number of requests the server allows in flight. Responses carry the
+	 * offset the server has written up to; once they are all in, the data after it is sent
+	 * again as the server may have dropped chunks it could not hold.
+	 */
+	for (;;) {
+		key = k_spin_lock(&upload_window.lock);
+		in_flight = upload_window.in_flight;
+
+		if (in_flight == 0 && next > upload_window.offset) {
+			if (upload_window.offset == resend) {
+				/* Sending the data from there again was not taken either */
+				image_upload_buf->status = MGMT_ERR_EBADSTATE;
 			}
+			resend = upload_window.offset;
+			next = upload_window.offset;
 		}
-
-		if (ok) {
-			ok = zcbor_map_end_encode(zse, map_count);
+		next = MAX(next, upload_window.offset);
+
+		/* Stop on errors, when the server has the data or when it lost the upload */
+		done = image_upload_buf->status != MGMT_ERR_EOK || upload_window.offset >= end ||
+		       upload_window.low_offset < base;
+		/* Do not get further ahead than the server can hold */
+		send = !done && next < end && in_flight < active_client->upload.window &&
+		       next < upload_window.offset + active_client->upload.window * max_data_length;
+		k_spin_unlock(&upload_window.lock, key);
+
+		if (done && in_flight == 0) {
+			break;
 		}
 
-		if (!ok) {
-			LOG_ERR("Failed to encode Image Upload packet");
-			smp_packet_free(nb);
-			image_upload_buf->status = MGMT_ERR_ENOMEM;
-			goto end;
-		}
-
-		offset_before_send = active_client->upload.offset;
-		nb->len = zse->payload - nb->data;
-		k_sem_reset(&mcumgr_img_client_grp_sem);
+		if (send) {
+			write_length = MIN(end - next, max_data_length);
 
-		image_upload_buf->status = MGMT_ERR_EINVAL;
-		image_upload_buf->image_upload_offset = SIZE_MAX;
+			rc = image_upload_send(next, base, data, write_length);
+			if (rc == MGMT_ERR_EOK) {
+				next += write_length;
+				continue;
+			}
 
-		rc = smp_client_send_cmd(active_client->smp_client, nb, image_upload_res_fn,
-					 &mcumgr_img_client_grp_sem,
-					 CONFIG_MCUMGR_GRP_IMG_FLASH_OPERATION_TIMEOUT);
-		if (rc) {
-			LOG_ERR("Failed to send SMP Upload init packet, err: %d", rc);
-			smp_packet_free(nb);
-			image_upload_buf->status = rc;
-			goto end;
+			if (rc != MGMT_ERR_ENOMEM || in_flight == 0) {
+				key = k_spin_lock(&upload_window.lock);
+				if (image_upload_buf->status == MGMT_ERR_EOK) {
+					image_upload_buf->status = rc;
+				}
+				k_spin_unlock(&upload_window.lock, key);
+				continue;
+			}
 
+			/* Out of buffers, the responses release the ones in use */
 		}
+
 		k_sem_take(&mcumgr_img_client_grp_sem, K_FOREVER);
-		if (image_upload_buf->status) {
-			LOG_ERR("Upload Fail: %d", image_upload_buf->status);
-			goto end;
-		}
+	}
 
-		if (offset_before_send + write_length < active_client->upload.offset) {
-			/* Offset further than expected which indicate upload session resume */
-			goto end;
-		}
+	if (image_upload_buf->status) {
+		LOG_ERR("Upload Fail: %d", image_upload_buf->status);
+	}
 
-		wrote_length += write_length;
+	if (upload_window.low_offset < base) {
+		/* The server needs the upload to go on from an earlier offset */
+		active_client->upload.offset = upload_window.low_offset;
+	} else {
+		active_client->upload.offset = upload_window.offset;
 	}
-end:
+	image_upload_buf->image_upload_offset = active_client->upload.offset;
+
 	rc = image_upload_buf->status;
 	active_client = NULL;
 	image_upload_buf = NULL;
@@ -36,6 +36,8 @@ struct smp_client_cmd_req {
 
 struct smp_client_data_base {
 	struct k_work_delayable work_delay;
+	/* Protects the lists, requests are sent and responded to from different threads */
+	struct k_spinlock lock;
 	sys_slist_t cmd_free_list;
 	sys_slist_t cmd_list;
 };
@@ -85,13 +87,14 @@ static void smp_client_transport_work_fn(struct k_work *work)
 	int64_t time_stamp_cmp;
 	int64_t time_stamp_ref;
 	int64_t time_stamp_delta;
+	sys_slist_t expired;
+	sys_snode_t *node;
+	k_spinlock_key_t key;
 
 	ARG_UNUSED(work);
 
-	if (sys_slist_is_empty(&smp_client_data.cmd_list)) {
-		/* No more packet for Transport */
-		return;
-	}
+	sys_slist_init(&expired);
+	key = k_spin_lock(&smp_client_data.lock);
 
 	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&smp_client_data.cmd_list, entry, tmp, node) {
 		time_stamp_ref = entry->timestamp;
@@ -116,6 +119,20 @@ static void smp_client_transport_work_fn(struct k_work *work)
 			continue;
 		}
 
+		/* Timed out, report it once the lock is released */
+		sys_slist_find_and_remove(&smp_client_data.cmd_list, &entry->node);
+		sys_slist_append(&expired, &entry->node);
+	}
+
+	if (!sys_slist_is_empty(&smp_client_data.cmd_list)) {
+		/* Re-schedule new timeout to next */
+		k_work_reschedule(&smp_client_data.work_delay, K_MSEC(backoff_ms));
+	}
+
+	k_spin_unlock(&smp_client_data.lock, key);
+
+	while ((node = sys_slist_get(&expired)) != NULL) {
+		entry = SYS_SLIST_CONTAINER(node, entry, node);
 		cb = entry->cb;
 		user_data = entry->user_data;
 		smp_client_cmd_req_free(entry);
@@ -123,11 +140,6 @@ static void smp_client_transport_work_fn(struct k_work *work)
 			cb(NULL, user_data);
 		}
 	}
-
-	if (!sys_slist_is_empty(&smp_client_data.cmd_list)) {
-		/* Re-schedule new timeout to next */
-		k_work_reschedule(&smp_client_data.work_delay, K_MSEC(backoff_ms));
-	}
 }
 
 static int smp_client_init(void)
@@ -145,8 +157,11 @@ static struct smp_client_cmd_req *smp_client_cmd_req_allocate(void)
 {
 	sys_snode_t *cmd_node;
 	struct smp_client_cmd_req *req;
+	k_spinlock_key_t key;
 
+	key = k_spin_lock(&smp_client_data.lock);
 	cmd_node = sys_slist_get(&smp_client_data.cmd_free_list);
+	k_spin_unlock(&smp_client_data.lock, key);
 	if (!cmd_node) {
 		return NULL;
 	}
@@ -158,16 +173,23 @@ static struct smp_client_cmd_req *smp_client_cmd_req_allocate(void)
 
 static void smp_cmd_add_to_list(struct smp_client_cmd_req *cmd_req)
 {
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&smp_client_data.lock);
 	if (sys_slist_is_empty(&smp_client_data.cmd_list)) {
 		/* Enable timer */
 		k_work_reschedule(&smp_client_data.work_delay, K_MSEC(CONFIG_SMP_CMD_RETRY_TIME));
 	}
 	sys_slist_append(&smp_client_data.cmd_list, &cmd_req->node);
+	k_spin_unlock(&smp_client_data.lock, key);
 }
 
 static void smp_client_cmd_req_free(struct smp_client_cmd_req *cmd_req)
 {
-	smp_client_buf_free(cmd_req->nb);
+	struct net_buf *nb = cmd_req->nb;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&smp_client_data.lock);
 	cmd_req->nb = NULL;
 	sys_slist_find_and_remove(&smp_client_data.cmd_list, &cmd_req->node);
 	/* Add to free list */
@@ -177,17 +199,20 @@ static void smp_client_cmd_req_free(struct smp_client_cmd_req *cmd_req)
 		/* cancel delay */
 		k_work_cancel_delayable(&smp_client_data.work_delay);
 	}
+	k_spin_unlock(&smp_client_data.lock, key);
+
+	smp_client_buf_free(nb);
 }
 
+/* Finds the request of a response and takes it off the list, so it only completes once */
 static struct smp_client_cmd_req *smp_client_response_discover(const struct smp_hdr *res_hdr)
 {
 	struct smp_hdr smp_header;
 	enum mcumgr_op_t response;
 	struct smp_client_cmd_req *cmd_req;
+	k_spinlock_key_t key;
 
-	if (sys_slist_is_empty(&smp_client_data.cmd_list)) {
-		return NULL;
-	}
+	key = k_spin_lock(&smp_client_data.lock);
 
 	SYS_SLIST_FOR_EACH_CONTAINER(&smp_client_data.cmd_list, cmd_req, node) {
 		smp_read_hdr(cmd_req->nb, &smp_header);
@@ -203,8 +228,12 @@ static struct smp_client_cmd_req *smp_client_response_discover(const struct smp_
 			continue;
 		}
 
+		sys_slist_find_and_remove(&smp_client_data.cmd_list, &cmd_req->node);
+		k_spin_unlock(&smp_client_data.lock, key);
 		return cmd_req;
 	}
+
+	k_spin_unlock(&smp_client_data.lock, key);
 	return NULL;
 }
 
@@ -1711,12 +1711,35 @@ static int get_context_recv_pktinfo(struct net_context *context,
 #endif
 }
 
+static int context_write_buf(struct net_pkt *pkt, const void *buf, size_t len,
+			     uint16_t *chksum, size_t offset)
+{
+	uint16_t part;
+	int ret;
+
+	if (chksum == NULL) {
+		return net_pkt_write(pkt, buf, len);
+	}
+
+	ret = net_pkt_write_chksum(pkt, buf, len, &part);
+	if (ret == 0) {
+		*chksum = net_chksum_add(*chksum, part, offset);
+	}
+
+	return ret;
+}
+
 /* If buf is not NULL, then use it. Otherwise read the data to be written
- * to net_pkt from msghdr.
+ * to net_pkt from msghdr. If calc_chksum is set, the payload checksum is
+ * calculated while copying the data and stored into the net_pkt.
  */
 static int context_write_data(struct net_pkt *pkt, const void *buf,
-			      int buf_len, const struct msghdr *msghdr)
+			      int buf_len, const struct msghdr *msghdr,
+			      bool calc_chksum)
 {
+	uint16_t chksum = 0U;
+	uint16_t *sum = calc_chksum ? &chksum : NULL;
+	size_t offset = 0U;
 	int ret = 0;
 
 	if (msghdr) {
@@ -1725,19 +1748,25 @@ static int context_write_data(struct net_pkt *pkt, const void *buf,
 		for (i = 0; i < msghdr->msg_iovlen; i++) {
 			int len = MIN(msghdr->msg_iov[i].iov_len, buf_len);
 
-			ret = net_pkt_write(pkt, msghdr->msg_iov[i].iov_base,
-					    len);
+			ret = context_write_buf(pkt, msghdr->msg_iov[i].iov_base,
+						len, sum, offset);
 			if (ret < 0) {
 				break;
 			}
 
+			offset += len;
 			buf_len -= len;
 			if (buf_len == 0) {
 				break;
 			}
 		}
 	} else {
-		ret = net_pkt_write(pkt, buf, buf_len);
+		ret = context_write_buf(pkt, buf, buf_len, sum, offset);
+		offset = buf_len;
+	}
+
+	if (calc_chksum && ret == 0) {
+		net_pkt_set_payload_chksum(pkt, chksum, offset);
 	}
 
 	return ret;
@@ -1788,7 +1817,9 @@ static int context_setup_udp_packet(struct net_context *context,
 		return ret;
 	}
 
-	ret = context_write_data(pkt, buf, len, msg);
+	ret = context_write_data(pkt, buf, len, msg,
+				 IS_ENABLED(CONFIG_NET_CHKSUM_COPY) &&
+				 net_if_need_calc_tx_checksum(net_pkt_iface(pkt)));
 	if (ret) {
 		return ret;
 	}
@@ -2110,6 +2141,14 @@ static int context_sendto(struct net_context *context,
 		return -ENETDOWN;
 	}
 
+	/* Back-pressure from the TX flow queues, the socket layer waits
+	 * and retries on -ENOBUFS.
+	 */
+	if (iface && !net_if_is_ip_offloaded(iface) &&
+	    net_tc_tx_flow_is_full(context, dst_addr)) {
+		return -ENOBUFS;
+	}
+
 	context->send_cb = cb;
 	context->user_data = user_data;
 
@@ -2161,7 +2200,7 @@ static int context_sendto(struct net_context *context,
 skip_alloc:
 	if (IS_ENABLED(CONFIG_NET_OFFLOAD) &&
 	    net_if_is_ip_offloaded(net_context_get_iface(context))) {
-		ret = context_write_data(pkt, buf, len, msghdr);
+		ret = context_write_data(pkt, buf, len, msghdr, false);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -2199,7 +2238,7 @@ skip_alloc:
 
 		ret = net_tcp_send_data(context, cb, user_data);
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_PACKET) && family == AF_PACKET) {
-		ret = context_write_data(pkt, buf, len, msghdr);
+		ret = context_write_data(pkt, buf, len, msghdr, false);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -2229,7 +2268,7 @@ skip_alloc:
 		}
 	} else if (IS_ENABLED(CONFIG_NET_SOCKETS_CAN) && family == AF_CAN &&
 		   net_context_get_proto(context) == CAN_RAW) {
-		ret = context_write_data(pkt, buf, len, msghdr);
+		ret = context_write_data(pkt, buf, len, msghdr, false);
 		if (ret < 0) {
 			goto fail;
 		}
@@ -1622,10 +1622,11 @@ static void pkt_cursor_update(struct net_pkt *pkt,
 /* Internal function that does all operation (skip/read/write/memset) */
 static int net_pkt_cursor_operate(struct net_pkt *pkt,
 				  void *data, size_t length,
-				  bool copy, bool write)
+				  bool copy, bool write, uint16_t *chksum)
 {
 	/* We use such variable to avoid lengthy lines */
 	struct net_pkt_cursor *c_op = &pkt->cursor;
+	size_t offset = 0;
 
 	while (c_op->buf && length) {
 		size_t d_len, len;
@@ -1653,7 +1654,13 @@ static int net_pkt_cursor_operate(struct net_pkt *pkt,
 			len = d_len;
 		}
 
-		if (copy && data) {
+		if (copy && data && write && chksum) {
+			*chksum = net_chksum_add(*chksum,
+						 calc_chksum_copy(0, c_op->pos,
+								  data, len),
+						 offset);
+			offset += len;
+		} else if (copy && data) {
 			memcpy(write ? c_op->pos : data,
 			       write ? data : c_op->pos,
 			       len);
@@ -1686,21 +1693,22 @@ int net_pkt_skip(struct net_pkt *pkt, size_t skip)
 {
 	NET_DBG("pkt %p skip %zu", pkt, skip);
 
-	return net_pkt_cursor_operate(pkt, NULL, skip, false, true);
+	return net_pkt_cursor_operate(pkt, NULL, skip, false, true, NULL);
 }
 
 int net_pkt_memset(struct net_pkt *pkt, int byte, size_t amount)
 {
 	NET_DBG("pkt %p byte %d amount %zu", pkt, byte, amount);
 
-	return net_pkt_cursor_operate(pkt, &byte, amount, false, true);
+	return net_pkt_cursor_operate(pkt, &byte, amount, false, true,
+				      NULL);
 }
 
 int net_pkt_read(struct net_pkt *pkt, void *data, size_t length)
 {
 	NET_DBG("pkt %p data %p length %zu", pkt, data, length);
 
-	return net_pkt_cursor_operate(pkt, data, length, true, false);
+	return net_pkt_cursor_operate(pkt, data, length, true, false, NULL);
 }
 
 int net_pkt_read_be16(struct net_pkt *pkt, uint16_t *data)
@@ -1747,15 +1755,33 @@ int net_pkt_write(struct net_pkt *pkt, const void *data, size_t length)
 		return net_pkt_skip(pkt, length);
 	}
 
-	return net_pkt_cursor_operate(pkt, (void *)data, length, true, true);
+	return net_pkt_cursor_operate(pkt, (void *)data, length, true, true,
+				      NULL);
 }
 
-int net_pkt_copy(struct net_pkt *pkt_dst,
-		 struct net_pkt *pkt_src,
-		 size_t length)
+int net_pkt_write_chksum(struct net_pkt *pkt, const void *data, size_t length,
+			 uint16_t *chksum)
+{
+	NET_DBG("pkt %p data %p length %zu", pkt, data, length);
+
+	*chksum = 0U;
+
+	if (data == pkt->cursor.pos && net_pkt_is_contiguous(pkt, length)) {
+		*chksum = calc_chksum(0U, data, length);
+
+		return net_pkt_skip(pkt, length);
+	}
+
+	return net_pkt_cursor_operate(pkt, (void *)data, length, true, true,
+				      chksum);
+}
+
+static int pkt_copy(struct net_pkt *pkt_dst, struct net_pkt *pkt_src,
+		    size_t length, uint16_t *chksum)
 {
 	struct net_pkt_cursor *c_dst = &pkt_dst->cursor;
 	struct net_pkt_cursor *c_src = &pkt_src->cursor;
+	size_t offset = 0;
 
 	while (c_dst->buf && c_src->buf && length) {
 		size_t s_len, d_len, len;
@@ -1783,7 +1809,15 @@ int net_pkt_copy(struct net_pkt *pkt_dst,
 			break;
 		}
 
-		memcpy(c_dst->pos, c_src->pos, len);
+		if (chksum != NULL) {
+			*chksum = net_chksum_add(*chksum,
+						 calc_chksum_copy(0, c_dst->pos,
+								  c_src->pos, len),
+						 offset);
+			offset += len;
+		} else {
+			memcpy(c_dst->pos, c_src->pos, len);
+		}
 
 		if (!net_pkt_is_being_overwritten(pkt_dst)) {
 			net_buf_add(c_dst->buf, len);
@@ -1803,6 +1837,22 @@ int net_pkt_copy(struct net_pkt *pkt_dst,
 	return 0;
 }
 
+int net_pkt_copy(struct net_pkt *pkt_dst,
+		 struct net_pkt *pkt_src,
+		 size_t length)
+{
+	return pkt_copy(pkt_dst, pkt_src, length, NULL);
+}
+
+int net_pkt_copy_chksum(struct net_pkt *pkt_dst,
+			struct net_pkt *pkt_src,
+			size_t length, uint16_t *chksum)
+{
+	*chksum = 0U;
+
+	return pkt_copy(pkt_dst, pkt_src, length, chksum);
+}
+
 static int32_t net_pkt_find_offset(struct net_pkt *pkt, uint8_t *ptr)
 {
 	struct net_buf *buf;
@@ -131,6 +131,19 @@ static inline enum net_verdict net_ipv6_input(struct net_pkt *pkt,
 }
 #endif
 extern bool net_tc_submit_to_tx_queue(uint8_t tc, struct net_pkt *pkt);
+#if defined(CONFIG_NET_TC_TX_FQ)
+extern bool net_tc_tx_flow_is_full(struct net_context *context,
+				   const struct sockaddr *dst);
+#else
+static inline bool net_tc_tx_flow_is_full(struct net_context *context,
+					  const struct sockaddr *dst)
+{
+	ARG_UNUSED(context);
+	ARG_UNUSED(dst);
+
+	return false;
+}
+#endif
 extern void net_tc_submit_to_rx_queue(uint8_t tc, struct net_pkt *pkt);
 extern enum net_verdict net_promisc_mode_input(struct net_pkt *pkt);
 
@@ -209,8 +222,38 @@ extern char *net_byte_to_hex(char *ptr, uint8_t byte, char base, bool pad);
 extern char *net_sprint_ll_addr_buf(const uint8_t *ll, uint8_t ll_len,
 				    char *buf, int buflen);
 extern uint16_t calc_chksum(uint16_t sum_in, const uint8_t *data, size_t len);
+extern uint16_t calc_chksum_copy(uint16_t sum_in, uint8_t *dst,
+				 const uint8_t *src, size_t len);
 extern uint16_t net_calc_chksum(struct net_pkt *pkt, uint8_t proto);
 
+/**
+ * @brief Add a partial checksum to a running checksum
+ *
+ * @param sum		Running checksum (as returned by calc_chksum())
+ * @param part		Checksum of a block of data, calculated as if the block
+ *			started at offset 0
+ * @param offset	Offset of the block within the checksummed data
+ *
+ * @return Combined checksum
+ */
+static inline uint16_t net_chksum_add(uint16_t sum, uint16_t part,
+				      size_t offset)
+{
+	/* A block at an odd offset sums its bytes in the other halves of the
+	 * 16-bit words, see RFC 1071 section 2 (B).
+	 */
+	if (offset % 2) {
+		part = BSWAP_16(part);
+	}
+
+	sum += part;
+	if (sum < part) {
+		sum++;
+	}
+
+	return sum;
+}
+
 /**
  * @brief Deliver the incoming packet through the recv_cb of the net_context
  *        to the upper layers
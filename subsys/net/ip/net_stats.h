@@ -411,6 +411,22 @@ static inline void net_stats_update_rx_time_detail(struct net_if *iface,
 #define net_stats_update_rx_time_detail(iface, detail_stat)
 #endif /* NET_PKT_RXTIME_STATS_DETAIL */
 
+#if defined(CONFIG_NET_STATISTICS_TX_FQ) && defined(CONFIG_NET_NATIVE)
+static inline void net_stats_update_tx_fq_queued(struct net_if *iface,
+						 int diff)
+{
+	UPDATE_STAT(iface, stats.tx_fq.queued += diff);
+}
+
+static inline void net_stats_update_tx_fq_drop(struct net_if *iface)
+{
+	UPDATE_STAT(iface, stats.tx_fq.drop++);
+}
+#else
+#define net_stats_update_tx_fq_queued(iface, diff)
+#define net_stats_update_tx_fq_drop(iface)
+#endif /* CONFIG_NET_STATISTICS_TX_FQ */
+
 #if (NET_TC_COUNT > 1) && defined(CONFIG_NET_STATISTICS) \
 	&& defined(CONFIG_NET_NATIVE)
 static inline void net_stats_update_tc_sent_pkt(struct net_if *iface, uint8_t tc)
@@ -40,19 +40,335 @@ static struct net_traffic_class tx_classes[NET_TC_TX_COUNT];
 static struct net_traffic_class rx_classes[NET_TC_RX_COUNT];
 #endif
 
-#if NET_TC_RX_COUNT > 0 || NET_TC_TX_COUNT > 0
+#if NET_TC_RX_COUNT > 0 || \
+	(NET_TC_TX_COUNT > 0 && !defined(CONFIG_NET_TC_TX_FQ))
 static void submit_to_queue(struct k_fifo *queue, struct net_pkt *pkt)
 {
 	k_fifo_put(queue, pkt);
 }
 #endif
 
+#if defined(CONFIG_NET_TC_TX_FQ)
+/* Flow queueing for the TX traffic classes. Every class has a fixed set of
+ * flow queues served with deficit round robin. Like in FQ-CoDel, a flow that
+ * becomes active is placed on the new flows list which is served before the
+ * old flows, so sparse (latency sensitive) flows do not wait behind bulk
+ * flows. A flow that used up its quantum moves to the end of the old flows.
+ */
+struct tc_fq_flow {
+	/* Queued packets, linked through the net_pkt fifo word */
+	sys_slist_t pkts;
+	/* Node in the new or old flows list */
+	sys_snode_t node;
+	/* Bytes the flow can still send in this round */
+	int32_t deficit;
+	/* Bytes currently queued */
+	uint32_t bytes;
+	/* Is the flow in one of the flow lists */
+	bool active;
+};
+
+struct tc_fq {
+	struct k_spinlock lock;
+	/* Number of queued packets, the TX thread waits on this */
+	struct k_sem pending;
+	sys_slist_t new_flows;
+	sys_slist_t old_flows;
+	struct tc_fq_flow flows[CONFIG_NET_TC_TX_FQ_FLOWS];
+};
+
+BUILD_ASSERT(sizeof(((struct net_pkt *)0)->fifo) == sizeof(sys_snode_t),
+	     "net_pkt fifo word cannot be used as a list node");
+
+static struct tc_fq tx_fq[NET_TC_TX_COUNT];
+
+/* Flows are told apart by protocol, destination address and ports. The
+ * source address is left out, a socket bound to an unspecified address only
+ * gets it when the packet is created. Both the queued packets and the
+ * sockets asking for room fill the same key, see tc_fq_flow_index().
+ */
+struct tc_fq_flow_key {
+	const uint8_t *dst;
+	size_t dst_len;
+	uint8_t proto;
+	/* Source and destination port, like in the transport header */
+	uint8_t ports[4];
+};
+
+static uint32_t tc_fq_hash(uint32_t hash, uint32_t word)
+{
+	return (hash ^ word) * 0x01000193U;
+}
+
+static uint32_t tc_fq_flow_index(const struct tc_fq_flow_key *key)
+{
+	uint32_t hash = tc_fq_hash(0x811c9dc5U, key->proto);
+
+	for (size_t i = 0; i < key->dst_len; i += sizeof(uint32_t)) {
+		hash = tc_fq_hash(hash, UNALIGNED_GET((uint32_t *)&key->dst[i]));
+	}
+
+	/* Only TCP and UDP have ports */
+	if (key->proto == IPPROTO_TCP || key->proto == IPPROTO_UDP) {
+		hash = tc_fq_hash(hash, UNALIGNED_GET((uint32_t *)key->ports));
+	}
+
+	/* Multiplicative (Fibonacci) hashing */
+	return ((hash * 2654435761U) >> 16) % CONFIG_NET_TC_TX_FQ_FLOWS;
+}
+
+/* Skips the IPv6 extension headers, leaving the cursor on the upper layer
+ * header. Returns false if that header is not in the packet.
+ */
+static bool tc_fq_ipv6_skip_ext(struct net_pkt *pkt, uint8_t *proto)
+{
+	uint8_t ext[4];
+
+	while (true) {
+		switch (*proto) {
+		case NET_IPV6_NEXTHDR_HBHO:
+		case NET_IPV6_NEXTHDR_DESTO:
+		case NET_IPV6_NEXTHDR_ROUTING:
+			/* Length in 8 octets units, not counting the first */
+			if (net_pkt_read(pkt, ext, 2) < 0 ||
+			    net_pkt_skip(pkt, ext[1] * 8U + 6U) < 0) {
+				return false;
+			}
+
+			break;
+		case NET_IPV6_NEXTHDR_FRAG:
+			if (net_pkt_read(pkt, ext, 4) < 0 ||
+			    net_pkt_skip(pkt, 4) < 0) {
+				return false;
+			}
+
+			*proto = ext[0];
+
+			/* Only the first fragment has the ports */
+			return (ext[2] == 0U) && ((ext[3] & 0xf8) == 0U);
+		default:
+			return true;
+		}
+
+		*proto = ext[0];
+	}
+}
+
+static uint32_t tc_fq_pkt_flow_index(struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_DEFINE(ip_access, struct net_ipv6_hdr);
+	struct tc_fq_flow_key key = { 0 };
+	bool overwrite = net_pkt_is_being_overwritten(pkt);
+	struct net_pkt_cursor backup;
+	bool has_ports = false;
+
+	net_pkt_cursor_backup(pkt, &backup);
+	net_pkt_set_overwrite(pkt, true);
+	net_pkt_cursor_init(pkt);
+
+	/* The IPv6 header is the larger one, the access serves both */
+	if (IS_ENABLED(CONFIG_NET_IPV4) && net_pkt_family(pkt) == AF_INET) {
+		struct net_ipv4_hdr *hdr;
+
+		ip_access.size = sizeof(struct net_ipv4_hdr);
+		hdr = net_pkt_get_data(pkt, &ip_access);
+
+		if (hdr != NULL) {
+			key.proto = hdr->proto;
+			key.dst = hdr->dst;
+			key.dst_len = sizeof(hdr->dst);
+
+			/* Only the first fragment has the ports */
+			has_ports = (hdr->offset[0] & 0x1f) == 0U &&
+				    hdr->offset[1] == 0U &&
+				    net_pkt_skip(pkt, (hdr->vhl & 0x0f) * 4U) == 0;
+		}
+	} else if (IS_ENABLED(CONFIG_NET_IPV6) &&
+		   net_pkt_family(pkt) == AF_INET6) {
+		struct net_ipv6_hdr *hdr = net_pkt_get_data(pkt, &ip_access);
+
+		if (hdr != NULL) {
+			key.proto = hdr->nexthdr;
+			key.dst = hdr->dst;
+			key.dst_len = sizeof(hdr->dst);
+
+			has_ports = net_pkt_skip(pkt, sizeof(*hdr)) == 0 &&
+				    tc_fq_ipv6_skip_ext(pkt, &key.proto);
+		}
+	}
+
+	if (has_ports && net_pkt_read(pkt, key.ports, sizeof(key.ports)) < 0) {
+		memset(key.ports, 0, sizeof(key.ports));
+	}
+
+	net_pkt_cursor_restore(pkt, &backup);
+	net_pkt_set_overwrite(pkt, overwrite);
+
+	return tc_fq_flow_index(&key);
+}
+
+static bool tc_fq_enqueue(struct tc_fq *fq, struct net_pkt *pkt)
+{
+	uint32_t len = net_pkt_get_len(pkt);
+	struct tc_fq_flow *flow;
+	k_spinlock_key_t key;
+
+	flow = &fq->flows[tc_fq_pkt_flow_index(pkt)];
+
+	key = k_spin_lock(&fq->lock);
+
+	/* Always accept one packet so that an oversized packet can pass */
+	if (flow->bytes > 0 &&
+	    flow->bytes + len > CONFIG_NET_TC_TX_FQ_FLOW_LIMIT) {
+		k_spin_unlock(&fq->lock, key);
+		return false;
+	}
+
+	sys_slist_append(&flow->pkts, (sys_snode_t *)&pkt->fifo);
+	flow->bytes += len;
+
+	if (!flow->active) {
+		flow->active = true;
+		flow->deficit = CONFIG_NET_TC_TX_FQ_QUANTUM;
+		sys_slist_append(&fq->new_flows, &flow->node);
+	}
+
+	k_spin_unlock(&fq->lock, key);
+
+	k_sem_give(&fq->pending);
+
+	return true;
+}
+
+static struct net_pkt *tc_fq_dequeue(struct tc_fq *fq)
+{
+	struct net_pkt *pkt = NULL;
+	struct tc_fq_flow *flow;
+	k_spinlock_key_t key;
+	sys_slist_t *list;
+	sys_snode_t *node;
+
+	key = k_spin_lock(&fq->lock);
+
+	while (true) {
+		list = sys_slist_is_empty(&fq->new_flows) ?
+			&fq->old_flows : &fq->new_flows;
+
+		node = sys_slist_peek_head(list);
+		if (node == NULL) {
+			break;
+		}
+
+		flow = CONTAINER_OF(node, struct tc_fq_flow, node);
+
+		if (flow->deficit <= 0) {
+			flow->deficit += CONFIG_NET_TC_TX_FQ_QUANTUM;
+			(void)sys_slist_get_not_empty(list);
+			sys_slist_append(&fq->old_flows, &flow->node);
+			continue;
+		}
+
+		node = sys_slist_get(&flow->pkts);
+		if (node == NULL) {
+			(void)sys_slist_get_not_empty(list);
+
+			/* An emptied new flow goes through the old flows once
+			 * so that it cannot regain priority by sending one
+			 * packet at a time.
+			 */
+			if (list == &fq->new_flows) {
+				sys_slist_append(&fq->old_flows, &flow->node);
+			} else {
+				flow->active = false;
+			}
+
+			continue;
+		}
+
+		pkt = CONTAINER_OF((intptr_t *)node, struct net_pkt, fifo);
+		flow->bytes -= net_pkt_get_len(pkt);
+		flow->deficit -= net_pkt_get_len(pkt);
+		break;
+	}
+
+	k_spin_unlock(&fq->lock, key);
+
+	return pkt;
+}
+
+static void tc_fq_init(struct tc_fq *fq)
+{
+	k_sem_init(&fq->pending, 0, K_SEM_MAX_LIMIT);
+}
+
+bool net_tc_tx_flow_is_full(struct net_context *context,
+			    const struct sockaddr *dst)
+{
+	struct tc_fq_flow_key key = {
+		.proto = net_context_get_proto(context),
+	};
+	bool full = false;
+	uint32_t idx;
+
+	if (dst == NULL) {
+		return false;
+	}
+
+	UNALIGNED_PUT(net_sin_ptr(&context->local)->sin_port,
+		      (uint16_t *)&key.ports[0]);
+
+	if (IS_ENABLED(CONFIG_NET_IPV6) && dst->sa_family == AF_INET6) {
+		key.dst = net_sin6(dst)->sin6_addr.s6_addr;
+		key.dst_len = sizeof(struct in6_addr);
+
+		/* Sent as IPv4 */
+		if (IS_ENABLED(CONFIG_NET_IPV4_MAPPING_TO_IPV6) &&
+		    net_ipv6_addr_is_v4_mapped(&net_sin6(dst)->sin6_addr)) {
+			key.dst = &key.dst[12];
+			key.dst_len = sizeof(struct in_addr);
+		}
+
+		UNALIGNED_PUT(net_sin6(dst)->sin6_port, (uint16_t *)&key.ports[2]);
+	} else if (IS_ENABLED(CONFIG_NET_IPV4) && dst->sa_family == AF_INET) {
+		key.dst = net_sin(dst)->sin_addr.s4_addr;
+		key.dst_len = sizeof(struct in_addr);
+		UNALIGNED_PUT(net_sin(dst)->sin_port, (uint16_t *)&key.ports[2]);
+	} else {
+		return false;
+	}
+
+	idx = tc_fq_flow_index(&key);
+
+	for (int i = 0; i < NET_TC_TX_COUNT && !full; i++) {
+		k_spinlock_key_t key = k_spin_lock(&tx_fq[i].lock);
+
+		full = tx_fq[i].flows[idx].bytes >=
+		       CONFIG_NET_TC_TX_FQ_FLOW_LIMIT;
+
+		k_spin_unlock(&tx_fq[i].lock, key);
+	}
+
+	return full;
+}
+#endif /* CONFIG_NET_TC_TX_FQ */
+
 bool net_tc_submit_to_tx_queue(uint8_t tc, struct net_pkt *pkt)
 {
 #if NET_TC_TX_COUNT > 0
 	net_pkt_set_tx_stats_tick(pkt, k_cycle_get_32());
 
+#if defined(CONFIG_NET_TC_TX_FQ)
+	if (!tc_fq_enqueue(&tx_fq[tc], pkt)) {
+		NET_DBG("TC %d flow full, dropping pkt %p", tc, pkt);
+		net_stats_update_tx_fq_drop(net_pkt_iface(pkt));
+		net_pkt_unref(pkt);
+		return false;
+	}
+
+	net_stats_update_tx_fq_queued(net_pkt_iface(pkt), 1);
+#else
 	submit_to_queue(&tx_classes[tc].fifo, pkt);
+#endif
 #else
 	ARG_UNUSED(tc);
 	ARG_UNUSED(pkt);
@@ -260,6 +576,29 @@ static void tc_rx_handler(void *p1, void *p2, void *p3)
 #endif
 
 #if NET_TC_TX_COUNT > 0
+#if defined(CONFIG_NET_TC_TX_FQ)
+static void tc_tx_handler(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	struct tc_fq *fq = p1;
+	struct net_pkt *pkt;
+
+	while (1) {
+		(void)k_sem_take(&fq->pending, K_FOREVER);
+
+		pkt = tc_fq_dequeue(fq);
+		if (pkt == NULL) {
+			continue;
+		}
+
+		net_stats_update_tx_fq_queued(net_pkt_iface(pkt), -1);
+
+		net_process_tx_packet(pkt);
+	}
+}
+#else
 static void tc_tx_handler(void *p1, void *p2, void *p3)
 {
 	ARG_UNUSED(p2);
@@ -277,6 +616,7 @@ static void tc_tx_handler(void *p1, void *p2, void *p3)
 		net_process_tx_packet(pkt);
 	}
 }
+#endif /* CONFIG_NET_TC_TX_FQ */
 #endif
 
 /* Create a fifo for each traffic class we are using. All the network
@@ -298,6 +638,7 @@ void net_tc_tx_init(void)
 
 	for (i = 0; i < NET_TC_TX_COUNT; i++) {
 		uint8_t thread_priority;
+		void *queue;
 		int priority;
 		k_tid_t tid;
 
@@ -316,12 +657,18 @@ void net_tc_tx_init(void)
 							"coop" : "preempt",
 			priority);
 
+#if defined(CONFIG_NET_TC_TX_FQ)
+		tc_fq_init(&tx_fq[i]);
+		queue = &tx_fq[i];
+#else
 		k_fifo_init(&tx_classes[i].fifo);
+		queue = &tx_classes[i].fifo;
+#endif
 
 		tid = k_thread_create(&tx_classes[i].handler, tx_stack[i],
 				      K_KERNEL_STACK_SIZEOF(tx_stack[i]),
 				      tc_tx_handler,
-				      &tx_classes[i].fifo, NULL, NULL,
+				      queue, NULL, NULL,
 				      priority, 0, K_FOREVER);
 		if (!tid) {
 			NET_ERR("Cannot create TC handler thread %d", i);
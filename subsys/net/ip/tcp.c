@@ -1492,6 +1492,8 @@ static int tcp_out_ext(struct tcp *conn, uint8_t flags, struct net_pkt *data,
 	if (data) {
 		/* Append the data buffer to the pkt */
 		net_pkt_append_buffer(pkt, data->buffer);
+		net_pkt_set_payload_chksum(pkt, net_pkt_payload_chksum(data),
+					   net_pkt_payload_chksum_len(data));
 		data->buffer = NULL;
 	}
 
@@ -1576,6 +1578,19 @@ static int tcp_pkt_peek(struct net_pkt *to, struct net_pkt *from, size_t pos,
 		net_pkt_skip(from, pos);
 	}
 
+	if (IS_ENABLED(CONFIG_NET_CHKSUM_COPY) &&
+	    net_if_need_calc_tx_checksum(net_pkt_iface(to))) {
+		uint16_t chksum;
+		int ret;
+
+		ret = net_pkt_copy_chksum(to, from, len, &chksum);
+		if (ret == 0) {
+			net_pkt_set_payload_chksum(to, chksum, len);
+		}
+
+		return ret;
+	}
+
 	return net_pkt_copy(to, from, len);
 }
 
@@ -1747,6 +1762,13 @@ static int tcp_send_queued_data(struct tcp *conn)
 			}
 		}
 
+		/* Do not overfill the TX flow queue of the connection, the
+		 * rest is sent when the queued segments get acknowledged.
+		 */
+		if (net_tc_tx_flow_is_full(conn->context, &conn->dst.sa)) {
+			break;
+		}
+
 		ret = tcp_send_data(conn);
 		if (ret < 0) {
 			break;
@@ -539,11 +539,16 @@ static uint16_t offset_based_swap8(const uint8_t *data)
  * it is possible to do parallel addition using larger word sizes such as 32-bit or 64-bit words.
  * In those cases the variable that stores the accumulative sum has to be bigger too.
  * Once the sum is computed a final step folds the sum to a 16-bit word (adding carry if any).
+ *
+ * If dst is set, the data is also copied there while it is being summed, so that the payload
+ * needs to be read only once. The word loops work on naturally aligned source words, the
+ * destination can have any alignment.
  */
-uint16_t calc_chksum(uint16_t sum_in, const uint8_t *data, size_t len)
+static ALWAYS_INLINE uint16_t chksum_core(uint16_t sum_in, const uint8_t *data,
+					  uint8_t *dst, size_t len)
 {
 	uint64_t sum;
-	uint32_t *p;
+	const uint32_t *p;
 	size_t i = 0;
 	size_t pending = len;
 	int odd_start = ((uintptr_t)data & 0x01);
@@ -557,24 +562,89 @@ uint16_t calc_chksum(uint16_t sum_in, const uint8_t *data, size_t len)
 		sum = sum_in;
 	}
 
-	/* Process up to 3 data elements up front, so the data is aligned further down the line */
+	/* Process up to 7 data elements up front, so the data is aligned further down the line */
 	if ((((uintptr_t)data & 0x01) != 0) && (pending >= 1)) {
+		if (dst != NULL) {
+			*dst++ = *data;
+		}
+
 		sum += offset_based_swap8(data);
 		data++;
 		pending--;
 	}
 	if ((((uintptr_t)data & 0x02) != 0) && (pending >= sizeof(uint16_t))) {
+		uint16_t word = *((const uint16_t *)data);
+
+		if (dst != NULL) {
+			UNALIGNED_PUT(word, (uint16_t *)dst);
+			dst += sizeof(uint16_t);
+		}
+
 		pending -= sizeof(uint16_t);
-		sum = sum + *((uint16_t *)data);
+		sum = sum + word;
 		data += sizeof(uint16_t);
 	}
-	p = (uint32_t *)data;
+
+	if (IS_ENABLED(CONFIG_64BIT)) {
+		const uint64_t *p64;
+
+		if ((((uintptr_t)data & 0x04) != 0) && (pending >= sizeof(uint32_t))) {
+			uint32_t word = *((const uint32_t *)data);
+
+			if (dst != NULL) {
+				UNALIGNED_PUT(word, (uint32_t *)dst);
+				dst += sizeof(uint32_t);
+			}
+
+			pending -= sizeof(uint32_t);
+			sum = sum + word;
+			data += sizeof(uint32_t);
+		}
+
+		/* Full 64-bit words with end-around carry, so each load covers
+		 * four 16-bit words of the packet.
+		 */
+		p64 = (const uint64_t *)data;
+		while (pending >= sizeof(uint64_t) * 2) {
+			uint64_t word_a = p64[0];
+			uint64_t word_b = p64[1];
+
+			if (dst != NULL) {
+				UNALIGNED_PUT(word_a, (uint64_t *)dst);
+				UNALIGNED_PUT(word_b, (uint64_t *)(dst + sizeof(uint64_t)));
+				dst += sizeof(uint64_t) * 2;
+			}
+
+			pending -= sizeof(uint64_t) * 2;
+			p64 += 2;
+			sum += word_a;
+			sum += (sum < word_a);
+			sum += word_b;
+			sum += (sum < word_b);
+		}
+
+		data = (const uint8_t *)p64;
+
+		/* Fold to 32 bits so the remaining 32-bit words cannot overflow */
+		sum = (sum & 0xffffffff) + (sum >> 32);
+		sum = (sum & 0xffffffff) + (sum >> 32);
+	}
+
+	p = (const uint32_t *)data;
 
 	/* Do loop unrolling for the very large data sets */
 	while (pending >= sizeof(uint32_t) * 4) {
 		uint64_t sum_a = p[i];
 		uint64_t sum_b = p[i + 1];
 
+		if (dst != NULL) {
+			UNALIGNED_PUT(p[i], (uint32_t *)dst);
+			UNALIGNED_PUT(p[i + 1], (uint32_t *)(dst + sizeof(uint32_t)));
+			UNALIGNED_PUT(p[i + 2], (uint32_t *)(dst + sizeof(uint32_t) * 2));
+			UNALIGNED_PUT(p[i + 3], (uint32_t *)(dst + sizeof(uint32_t) * 3));
+			dst += sizeof(uint32_t) * 4;
+		}
+
 		pending -= sizeof(uint32_t) * 4;
 		sum_a += p[i + 2];
 		sum_b += p[i + 3];
@@ -582,16 +652,32 @@ uint16_t calc_chksum(uint16_t sum_in, const uint8_t *data, size_t len)
 		sum += sum_a + sum_b;
 	}
 	while (pending >= sizeof(uint32_t)) {
+		if (dst != NULL) {
+			UNALIGNED_PUT(p[i], (uint32_t *)dst);
+			dst += sizeof(uint32_t);
+		}
+
 		pending -= sizeof(uint32_t);
 		sum = sum + p[i++];
 	}
-	data = (uint8_t *)(p + i);
+	data = (const uint8_t *)(p + i);
 	if (pending >= 2) {
+		uint16_t word = *((const uint16_t *)data);
+
+		if (dst != NULL) {
+			UNALIGNED_PUT(word, (uint16_t *)dst);
+			dst += sizeof(uint16_t);
+		}
+
 		pending -= sizeof(uint16_t);
-		sum = sum + *((uint16_t *)data);
+		sum = sum + word;
 		data += sizeof(uint16_t);
 	}
 	if (pending == 1) {
+		if (dst != NULL) {
+			*dst = *data;
+		}
+
 		sum += offset_based_swap8(data);
 	}
 
@@ -610,38 +696,49 @@ uint16_t calc_chksum(uint16_t sum_in, const uint8_t *data, size_t len)
 	}
 }
 
-static inline uint16_t pkt_calc_chksum(struct net_pkt *pkt, uint16_t sum)
+uint16_t calc_chksum(uint16_t sum_in, const uint8_t *data, size_t len)
+{
+	return chksum_core(sum_in, data, NULL, len);
+}
+
+uint16_t calc_chksum_copy(uint16_t sum_in, uint8_t *dst, const uint8_t *src, size_t len)
+{
+	return chksum_core(sum_in, src, dst, len);
+}
+
+static inline uint16_t pkt_calc_chksum(struct net_pkt *pkt, uint16_t sum,
+				       size_t length)
 {
 	struct net_pkt_cursor *cur = &pkt->cursor;
+	size_t offset = 0;
 	size_t len;
 
 	if (!cur->buf || !cur->pos) {
 		return sum;
 	}
 
-	len = cur->buf->len - (cur->pos - cur->buf->data);
+	while (cur->buf && length > 0) {
+		len = MIN(length, cur->buf->len - (cur->pos - cur->buf->data));
+
+		/* A fragment starting at an odd offset of the summed data has
+		 * its 16-bit words shifted by one byte, which is the same as
+		 * summing them byte swapped.
+		 */
+		if (offset % 2) {
+			sum = BSWAP_16(calc_chksum(BSWAP_16(sum), cur->pos, len));
+		} else {
+			sum = calc_chksum(sum, cur->pos, len);
+		}
 
-	while (cur->buf) {
-		sum = calc_chksum(sum, cur->pos, len);
+		offset += len;
+		length -= len;
 
 		cur->buf = cur->buf->frags;
-		if (!cur->buf || !cur->buf->len) {
+		if (!cur->buf) {
 			break;
 		}
 
 		cur->pos = cur->buf->data;
-
-		if (len % 2) {
-			sum += *cur->pos;
-			if (sum < *cur->pos) {
-				sum++;
-			}
-
-			cur->pos++;
-			len = cur->buf->len - 1;
-		} else {
-			len = cur->buf->len;
-		}
 	}
 
 	return sum;
@@ -651,6 +748,8 @@ static inline uint16_t pkt_calc_chksum(struct net_pkt *pkt, uint16_t sum)
 uint16_t net_calc_chksum(struct net_pkt *pkt, uint8_t proto)
 {
 	size_t len = 0U;
+	size_t l4_len;
+	size_t payload_len;
 	uint16_t sum = 0U;
 	struct net_pkt_cursor backup;
 	bool ow;
@@ -685,7 +784,22 @@ uint16_t net_calc_chksum(struct net_pkt *pkt, uint8_t proto)
 	sum = calc_chksum(sum, pkt->cursor.pos, len);
 	net_pkt_skip(pkt, len + net_pkt_ip_opts_len(pkt));
 
-	sum = pkt_calc_chksum(pkt, sum);
+	/* If the payload was summed while it was copied into the packet,
+	 * only the transport header needs to be read here.
+	 */
+	l4_len = net_pkt_get_len(pkt) - net_pkt_ip_hdr_len(pkt) -
+		 net_pkt_ip_opts_len(pkt);
+	payload_len = net_pkt_payload_chksum_len(pkt);
+	if (payload_len > l4_len) {
+		payload_len = 0U;
+	}
+
+	sum = pkt_calc_chksum(pkt, sum, l4_len - payload_len);
+
+	if (payload_len > 0U) {
+		sum = net_chksum_add(sum, net_pkt_payload_chksum(pkt),
+				     l4_len - payload_len);
+	}
 
 	sum = (sum == 0U) ? 0xffff : htons(sum);
 
@@ -121,55 +121,223 @@ static int coap_service_remove_observer(const struct coap_service *service,
 	return 0;
 }
 
-static int coap_server_process(int sock_fd)
+#if CONFIG_COAP_SERVER_DISPATCH_TABLE_SIZE > 0
+/*
+ * Request dispatch table. Each service owns a slice of the table: resources with an exact
+ * path sorted by the hash of their path segments, followed by the wildcard resources in
+ * resource order. The table is built once as resources are placed in linker sections.
+ */
+struct coap_dispatch_entry {
+	uint32_t hash;
+	uint16_t index;
+};
+
+static struct coap_dispatch_entry dispatch_table[CONFIG_COAP_SERVER_DISPATCH_TABLE_SIZE];
+
+#define DISPATCH_HASH_INIT  2166136261U
+#define DISPATCH_HASH_PRIME 16777619U
+
+static uint32_t coap_dispatch_hash(uint32_t hash, const uint8_t *segment, size_t len)
 {
-	static uint8_t buf[CONFIG_COAP_SERVER_MESSAGE_SIZE];
+	/* Hash the separator too, so that "ab/c" and "a/bc" differ */
+	hash = (hash ^ '/') * DISPATCH_HASH_PRIME;
 
-	struct sockaddr client_addr;
-	socklen_t client_addr_len = sizeof(client_addr);
-	struct coap_service *service = NULL;
-	struct coap_packet request;
-	struct coap_pending *pending;
-	struct coap_option options[MAX_OPTIONS] = { 0 };
-	uint8_t opt_num = MAX_OPTIONS;
-	uint8_t type;
-	ssize_t received;
-	int ret;
+	for (size_t i = 0; i < len; i++) {
+		hash = (hash ^ segment[i]) * DISPATCH_HASH_PRIME;
+	}
 
-	received = zsock_recvfrom(sock_fd, buf, sizeof(buf), ZSOCK_MSG_DONTWAIT, &client_addr,
-				  &client_addr_len);
-	__ASSERT_NO_MSG(received <= sizeof(buf));
+	return hash;
+}
 
-	if (received < 0) {
-		if (errno == EWOULDBLOCK) {
-			return 0;
+static bool coap_dispatch_is_wildcard(const char * const *path)
+{
+	if (!IS_ENABLED(CONFIG_COAP_URI_WILDCARD)) {
+		return false;
+	}
+
+	for (; *path != NULL; path++) {
+		if (strcmp(*path, "+") == 0 || strcmp(*path, "#") == 0) {
+			return true;
 		}
+	}
 
-		LOG_ERR("Failed to process client request (%d)", -errno);
-		return -errno;
+	return false;
+}
+
+static void coap_server_dispatch_init(void)
+{
+	size_t used = 0;
+
+	COAP_SERVICE_FOREACH(svc) {
+		struct coap_service_data *data = svc->data;
+		size_t count = COAP_SERVICE_RESOURCE_COUNT(svc);
+		struct coap_dispatch_entry *table = &dispatch_table[used];
+		uint16_t exact = 0U;
+		uint16_t wildcard = 0U;
+
+		data->dispatch_indexed = false;
+
+		if (count > ARRAY_SIZE(dispatch_table) - used || count > UINT16_MAX) {
+			LOG_WRN("Dispatch table full, resources of %s are matched linearly",
+				svc->name);
+			continue;
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			const char * const *path = svc->res_begin[i].path;
+			uint32_t hash = DISPATCH_HASH_INIT;
+			uint16_t pos;
+
+			if (coap_dispatch_is_wildcard(path)) {
+				continue;
+			}
+
+			for (; *path != NULL; path++) {
+				hash = coap_dispatch_hash(hash, (const uint8_t *)*path, strlen(*path));
+			}
+
+			/* Insertion sort, equal hashes stay in resource order */
+			for (pos = exact; pos > 0 && table[pos - 1].hash > hash; pos--) {
+				table[pos] = table[pos - 1];
+			}
+
+			table[pos].hash = hash;
+			table[pos].index = i;
+			exact++;
+		}
+
+		for (size_t i = 0; i < count; i++) {
+			if (coap_dispatch_is_wildcard(svc->res_begin[i].path)) {
+				table[exact + wildcard].hash = 0U;
+				table[exact + wildcard].index = i;
+				wildcard++;
+			}
+		}
+
+		data->dispatch_start = used;
+		data->dispatch_exact = exact;
+		data->dispatch_wildcard = wildcard;
+		data->dispatch_indexed = true;
+		used += count;
 	}
+}
 
-	ret = coap_packet_parse(&request, buf, received, options, opt_num);
-	if (ret < 0) {
-		LOG_ERR("Failed To parse coap message (%d)", ret);
-		return ret;
+/* Returns the index of the first resource of the service matching the request path */
+static int coap_server_dispatch_find(const struct coap_service *service,
+				     struct coap_option *options, uint8_t opt_num)
+{
+	const struct coap_service_data *data = service->data;
+	const struct coap_dispatch_entry *table = &dispatch_table[data->dispatch_start];
+	uint32_t hash = DISPATCH_HASH_INIT;
+	uint16_t lo = 0U;
+	uint16_t hi = data->dispatch_exact;
+	int found = -ENOENT;
+
+	for (uint8_t i = 0U; i < opt_num; i++) {
+		if (options[i].delta == COAP_OPTION_URI_PATH) {
+			hash = coap_dispatch_hash(hash, options[i].value, options[i].len);
+		}
 	}
 
-	(void)k_mutex_lock(&lock, K_FOREVER);
-	/* Find the active service */
-	COAP_SERVICE_FOREACH(svc) {
-		if (svc->data->sock_fd == sock_fd) {
-			service = svc;
+	while (lo < hi) {
+		uint16_t mid = lo + (hi - lo) / 2U;
+
+		if (table[mid].hash < hash) {
+			lo = mid + 1U;
+		} else {
+			hi = mid;
+		}
+	}
+
+	for (; lo < data->dispatch_exact && table[lo].hash == hash; lo++) {
+		if (coap_uri_path_match(service->res_begin[table[lo].index].path, options,
+					opt_num)) {
+			found = table[lo].index;
 			break;
 		}
 	}
-	if (service == NULL) {
-		ret = -ENOENT;
-		goto unlock;
+
+	/* Wildcard resources placed before the exact match take precedence */
+	for (uint16_t i = data->dispatch_exact;
+	     i < data->dispatch_exact + data->dispatch_wildcard; i++) {
+		if (found >= 0 && table[i].index > found) {
+			break;
+		}
+
+		if (coap_uri_path_match(service->res_begin[table[i].index].path, options,
+					opt_num)) {
+			return table[i].index;
+		}
+	}
+
+	return found;
+}
+#endif /* CONFIG_COAP_SERVER_DISPATCH_TABLE_SIZE > 0 */
+
+static int coap_server_handle_request(const struct coap_service *service,
+				      struct coap_packet *request,
+				      struct coap_option *options, uint8_t opt_num,
+				      struct sockaddr *client_addr, socklen_t client_addr_len)
+{
+	struct coap_resource *resources = service->res_begin;
+	size_t resources_len = COAP_SERVICE_RESOURCE_COUNT(service);
+
+#if CONFIG_COAP_SERVER_DISPATCH_TABLE_SIZE > 0
+	if (service->data->dispatch_indexed) {
+		int index = coap_server_dispatch_find(service, options, opt_num);
+
+		if (index < 0) {
+			return index;
+		}
+
+		resources = &resources[index];
+		resources_len = 1;
+	}
+#endif
+
+	return coap_handle_request_len(request, resources, resources_len, options, opt_num,
+				       client_addr, client_addr_len);
+}
+
+/* Reject a confirmable message with an empty reset, as done for a CoAP ping */
+static int coap_server_send_reset(const struct coap_service *service,
+				  const struct coap_packet *request,
+				  struct sockaddr *client_addr, socklen_t client_addr_len)
+{
+	uint8_t rst_buf[COAP_TOKEN_MAX_LEN + 4U];
+	struct coap_packet rst;
+	int ret;
+
+	ret = coap_packet_init(&rst, rst_buf, sizeof(rst_buf), COAP_VERSION_1, COAP_TYPE_RESET,
+			       0, NULL, COAP_CODE_EMPTY, coap_header_get_id(request));
+	if (ret < 0) {
+		LOG_ERR("Failed to init RST (%d)", ret);
+		return ret;
+	}
+
+	return coap_service_send(service, &rst, client_addr, client_addr_len, NULL);
+}
+
+static int coap_server_handle(const struct coap_service *service, uint8_t *buf, size_t len,
+			      struct sockaddr *client_addr, socklen_t client_addr_len)
+{
+	struct coap_packet request;
+	struct coap_pending *pending;
+	struct coap_option options[MAX_OPTIONS] = { 0 };
+	uint8_t opt_num = MAX_OPTIONS;
+	uint8_t type;
+	int ret;
+
+	ret = coap_packet_parse(&request, buf, len, options, opt_num);
+	if (ret < 0) {
+		LOG_ERR("Failed To parse coap message (%d)", ret);
+		return ret;
 	}
 
 	type = coap_header_get_type(&request);
 
+	(void)k_mutex_lock(&lock, K_FOREVER);
+
 	pending = coap_pending_received(&request, service->data->pending, MAX_PENDINGS);
 	if (pending) {
 		uint8_t token[COAP_TOKEN_MAX_LEN];
@@ -178,7 +346,7 @@ static int coap_server_process(int sock_fd)
 		switch (type) {
 		case COAP_TYPE_RESET:
 			tkl = coap_header_get_token(&request, token);
-			coap_service_remove_observer(service, NULL, &client_addr, token, tkl);
+			coap_service_remove_observer(service, NULL, client_addr, token, tkl);
 			__fallthrough;
 		case COAP_TYPE_ACK:
 			coap_server_free(pending->data);
@@ -187,16 +355,36 @@ static int coap_server_process(int sock_fd)
 		default:
 			LOG_WRN("Unexpected pending type %d", type);
 			ret = -EINVAL;
-			goto unlock;
+			break;
 		}
 
-		goto unlock;
-	} else if (type == COAP_TYPE_ACK || type == COAP_TYPE_RESET) {
+		(void)k_mutex_unlock(&lock);
+
+		return ret;
+	}
+
+	(void)k_mutex_unlock(&lock);
+
+	if (type == COAP_TYPE_ACK || type == COAP_TYPE_RESET) {
 		LOG_WRN("Unexpected type %d without pending packet", type);
-		ret = -EINVAL;
-		goto unlock;
+		return -EINVAL;
+	}
+
+	/* Pings (empty messages) and stray responses are not dispatched to resources */
+	if (coap_header_get_code(&request) == COAP_CODE_EMPTY ||
+	    !coap_packet_is_request(&request)) {
+		if (type == COAP_TYPE_CON) {
+			return coap_server_send_reset(service, &request, client_addr,
+						      client_addr_len);
+		}
+
+		return 0;
 	}
 
+	/*
+	 * With worker threads, resource handlers run without the server lock held, so that
+	 * other services and workers are not blocked by a slow handler.
+	 */
 	if (IS_ENABLED(CONFIG_COAP_SERVER_WELL_KNOWN_CORE) &&
 	    coap_header_get_code(&request) == COAP_METHOD_GET &&
 	    coap_uri_path_match(COAP_WELL_KNOWN_CORE_PATH, options, opt_num)) {
@@ -209,14 +397,13 @@ static int coap_server_process(int sock_fd)
 						   well_known_buf, sizeof(well_known_buf));
 		if (ret < 0) {
 			LOG_ERR("Failed to build well known core for %s (%d)", service->name, ret);
-			goto unlock;
+			return ret;
 		}
 
-		ret = coap_service_send(service, &response, &client_addr, client_addr_len, NULL);
+		ret = coap_service_send(service, &response, client_addr, client_addr_len, NULL);
 	} else {
-		ret = coap_handle_request_len(&request, service->res_begin,
-					      COAP_SERVICE_RESOURCE_COUNT(service),
-					      options, opt_num, &client_addr, client_addr_len);
+		ret = coap_server_handle_request(service, &request, options, opt_num,
+						 client_addr, client_addr_len);
 
 		/* Translate errors to response codes */
 		switch (ret) {
@@ -240,18 +427,153 @@ static int coap_server_process(int sock_fd)
 			ret = coap_ack_init(&ack, &request, ack_buf, sizeof(ack_buf), (uint8_t)ret);
 			if (ret < 0) {
 				LOG_ERR("Failed to init ACK (%d)", ret);
-				goto unlock;
+				return ret;
 			}
 
-			ret = coap_service_send(service, &ack, &client_addr, client_addr_len, NULL);
+			ret = coap_service_send(service, &ack, client_addr, client_addr_len, NULL);
 		}
 	}
 
-unlock:
+	return ret;
+}
+
+static ssize_t coap_server_recv(int sock_fd, uint8_t *buf, size_t len,
+				struct sockaddr *client_addr, socklen_t *client_addr_len,
+				const struct coap_service **service)
+{
+	ssize_t received;
+
+	received = zsock_recvfrom(sock_fd, buf, len, ZSOCK_MSG_DONTWAIT, client_addr,
+				  client_addr_len);
+	__ASSERT_NO_MSG(received <= (ssize_t)len);
+
+	if (received < 0) {
+		if (errno == EWOULDBLOCK) {
+			return 0;
+		}
+
+		LOG_ERR("Failed to process client request (%d)", -errno);
+		return -errno;
+	}
+
+	*service = NULL;
+
+	(void)k_mutex_lock(&lock, K_FOREVER);
+	/* Find the active service */
+	COAP_SERVICE_FOREACH(svc) {
+		if (svc->data->sock_fd == sock_fd) {
+			*service = svc;
+			break;
+		}
+	}
+	(void)k_mutex_unlock(&lock);
+
+	if (*service == NULL) {
+		return -ENOENT;
+	}
+
+	return received;
+}
+
+#if CONFIG_COAP_SERVER_WORKERS > 0
+struct coap_server_request {
+	void *fifo_reserved;
+	const struct coap_service *service;
+	struct sockaddr addr;
+	socklen_t addr_len;
+	size_t len;
+	uint8_t buf[CONFIG_COAP_SERVER_MESSAGE_SIZE];
+};
+
+K_MEM_SLAB_DEFINE_STATIC(request_slab, sizeof(struct coap_server_request),
+			 CONFIG_COAP_SERVER_WORKER_QUEUE_SIZE, 4);
+static K_FIFO_DEFINE(request_fifo);
+
+static K_THREAD_STACK_ARRAY_DEFINE(worker_stacks, CONFIG_COAP_SERVER_WORKERS,
+				   CONFIG_COAP_SERVER_WORKER_STACK_SIZE);
+static struct k_thread worker_threads[CONFIG_COAP_SERVER_WORKERS];
+
+static int coap_server_process(int sock_fd)
+{
+	struct coap_server_request *req;
+	ssize_t received;
+
+	if (k_mem_slab_alloc(&request_slab, (void **)&req, K_NO_WAIT) < 0) {
+		uint8_t discard;
+
+		/* Drop the datagram, confirmable requests are retransmitted by the client */
+		(void)zsock_recv(sock_fd, &discard, sizeof(discard), ZSOCK_MSG_DONTWAIT);
+		LOG_WRN("Request queue full, dropping request");
+
+		return -ENOMEM;
+	}
+
+	req->addr_len = sizeof(req->addr);
+	received = coap_server_recv(sock_fd, req->buf, sizeof(req->buf), &req->addr,
+				    &req->addr_len, &req->service);
+	if (received <= 0) {
+		k_mem_slab_free(&request_slab, req);
+		return received;
+	}
+
+	req->len = received;
+	k_fifo_put(&request_fifo, req);
+
+	return 0;
+}
+
+static void coap_server_worker(void *p1, void *p2, void *p3)
+{
+	struct coap_server_request *req;
+
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		req = k_fifo_get(&request_fifo, K_FOREVER);
+
+		(void)coap_server_handle(req->service, req->buf, req->len, &req->addr,
+					 req->addr_len);
+
+		k_mem_slab_free(&request_slab, req);
+	}
+}
+
+static void coap_server_workers_start(void)
+{
+	for (int i = 0; i < CONFIG_COAP_SERVER_WORKERS; i++) {
+		k_thread_create(&worker_threads[i], worker_stacks[i],
+				K_THREAD_STACK_SIZEOF(worker_stacks[i]), coap_server_worker,
+				NULL, NULL, NULL, THREAD_PRIORITY, 0, K_NO_WAIT);
+		k_thread_name_set(&worker_threads[i], "coap_server_worker");
+	}
+}
+#else
+static int coap_server_process(int sock_fd)
+{
+	static uint8_t buf[CONFIG_COAP_SERVER_MESSAGE_SIZE];
+
+	struct sockaddr client_addr;
+	socklen_t client_addr_len = sizeof(client_addr);
+	const struct coap_service *service;
+	ssize_t received;
+	int ret;
+
+	received = coap_server_recv(sock_fd, buf, sizeof(buf), &client_addr, &client_addr_len,
+				    &service);
+	if (received <= 0) {
+		return received;
+	}
+
+	/* Without workers, resource handlers run under the server lock */
+	(void)k_mutex_lock(&lock, K_FOREVER);
+	ret = coap_server_handle(service, buf, received, &client_addr, client_addr_len);
 	(void)k_mutex_unlock(&lock);
 
 	return ret;
 }
+#endif /* CONFIG_COAP_SERVER_WORKERS > 0 */
 
 static void coap_server_retransmit(void)
 {
@@ -743,6 +1065,13 @@ static void coap_server_thread(void *p1, void *p2, void *p3)
 		}
 	}
 
+#if CONFIG_COAP_SERVER_DISPATCH_TABLE_SIZE > 0
+	coap_server_dispatch_init();
+#endif
+#if CONFIG_COAP_SERVER_WORKERS > 0
+	coap_server_workers_start();
+#endif
+
 	COAP_SERVICE_FOREACH(svc) {
 		if (svc->flags & COAP_SERVICE_AUTOSTART) {
 			ret = coap_service_start(svc);
@@ -9,14 +9,183 @@
 
 LOG_MODULE_REGISTER(net_dns_cache, CONFIG_DNS_RESOLVER_LOG_LEVEL);
 
-static void dns_cache_clean(struct dns_cache const *cache);
+/* Refresh entries once this share (in per mille) of their TTL has elapsed */
+#define DNS_CACHE_PREFETCH_PERMILLE 900
+
+static void dns_cache_clean(struct dns_cache *cache);
+
+/* FNV-1a, cheap and good enough to spread host names over the buckets */
+static uint32_t dns_cache_hash(const char *query)
+{
+	uint32_t hash = 2166136261U;
+
+	while (*query != '\0') {
+		hash ^= (uint8_t)*query++;
+		hash *= 16777619U;
+	}
+
+	return hash;
+}
+
+static inline uint16_t *dns_cache_bucket(struct dns_cache *cache, uint32_t hash)
+{
+	return &cache->buckets[hash % cache->size];
+}
+
+static inline struct dns_cache_entry *dns_cache_entry(struct dns_cache *cache, uint16_t link)
+{
+	return link == 0 ? NULL : &cache->entries[link - 1];
+}
+
+static inline bool dns_cache_match(struct dns_cache_entry const *entry, uint32_t hash,
+				   char const *query)
+{
+	return entry->hash == hash && strcmp(entry->query, query) == 0;
+}
+
+static inline bool dns_cache_family_match(struct dns_cache_entry const *entry,
+					  sa_family_t family)
+{
+	return family == AF_UNSPEC || entry->data.ai_family == AF_UNSPEC ||
+	       entry->data.ai_family == family;
+}
+
+/* Needs to be called when lock is already acquired */
+static void dns_cache_unlink(struct dns_cache *cache, size_t index)
+{
+	struct dns_cache_entry *entry = &cache->entries[index];
+	uint16_t *link = dns_cache_bucket(cache, entry->hash);
+
+	while (*link != 0) {
+		if (*link == index + 1) {
+			*link = entry->next;
+			break;
+		}
+		link = &dns_cache_entry(cache, *link)->next;
+	}
+
+	entry->next = 0;
+	entry->in_use = false;
+}
+
+/* Needs to be called when lock is already acquired */
+static void dns_cache_link(struct dns_cache *cache, size_t index)
+{
+	struct dns_cache_entry *entry = &cache->entries[index];
+	uint16_t *link = dns_cache_bucket(cache, entry->hash);
+
+	/* Append, so that lookups return addresses in the order they were added */
+	while (*link != 0) {
+		link = &dns_cache_entry(cache, *link)->next;
+	}
+
+	*link = index + 1;
+	entry->next = 0;
+	entry->in_use = true;
+
+	if (sys_timepoint_cmp(entry->expiry, cache->next_expiry) < 0) {
+		cache->next_expiry = entry->expiry;
+	}
+}
+
+/* Needs to be called when lock is already acquired */
+static void dns_cache_set_ttl(struct dns_cache_entry *entry, uint32_t ttl)
+{
+	entry->expiry = sys_timepoint_calc(K_SECONDS(ttl));
+	entry->prefetch = sys_timepoint_calc(
+		K_MSEC((uint64_t)ttl * DNS_CACHE_PREFETCH_PERMILLE));
+	entry->prefetching = false;
+}
+
+/* Needs to be called when lock is already acquired */
+static size_t dns_cache_slot(struct dns_cache *cache)
+{
+	k_timepoint_t closest_to_expiry = sys_timepoint_calc(K_FOREVER);
+	size_t index_to_replace = 0;
+
+	dns_cache_clean(cache);
+
+	for (size_t i = 0; i < cache->size; i++) {
+		if (!cache->entries[i].in_use) {
+			return i;
+		} else if (sys_timepoint_cmp(closest_to_expiry, cache->entries[i].expiry) > 0) {
+			index_to_replace = i;
+			closest_to_expiry = cache->entries[i].expiry;
+		}
+	}
+
+	NET_DBG("Overwrite \"%s\"", cache->entries[index_to_replace].query);
+	dns_cache_unlink(cache, index_to_replace);
+
+	return index_to_replace;
+}
+
+/* Needs to be called when lock is already acquired */
+static void dns_cache_remove_negative(struct dns_cache *cache, uint32_t hash, char const *query,
+				      sa_family_t family)
+{
+	uint16_t link = *dns_cache_bucket(cache, hash);
+
+	while (link != 0) {
+		struct dns_cache_entry *entry = dns_cache_entry(cache, link);
+		uint16_t next = entry->next;
+
+		if (entry->negative && dns_cache_match(entry, hash, query) &&
+		    dns_cache_family_match(entry, family)) {
+			dns_cache_unlink(cache, link - 1);
+		}
+
+		link = next;
+	}
+}
+
+/* Needs to be called when lock is already acquired */
+static bool dns_cache_renew(struct dns_cache *cache, uint32_t hash, char const *query,
+			    struct dns_addrinfo const *addrinfo, uint32_t ttl)
+{
+	uint16_t link = *dns_cache_bucket(cache, hash);
+
+	for (; link != 0; link = dns_cache_entry(cache, link)->next) {
+		struct dns_cache_entry *entry = dns_cache_entry(cache, link);
+
+		if (!entry->prefetching || entry->negative || !dns_cache_match(entry, hash, query) ||
+		    memcmp(&entry->data, addrinfo, sizeof(*addrinfo)) != 0) {
+			continue;
+		}
+
+		NET_DBG("Renew \"%s\" with TTL %" PRIu32, query, ttl);
+		dns_cache_set_ttl(entry, ttl);
+		if (sys_timepoint_cmp(entry->expiry, cache->next_expiry) < 0) {
+			cache->next_expiry = entry->expiry;
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
+static int dns_cache_check_query(char const *query)
+{
+	if (strlen(query) >= CONFIG_DNS_RESOLVER_MAX_QUERY_LEN) {
+		NET_WARN("Query string to big to be processed %u >= "
+			 "CONFIG_DNS_RESOLVER_MAX_QUERY_LEN",
+			 strlen(query));
+		return -EINVAL;
+	}
+
+	return 0;
+}
 
 int dns_cache_flush(struct dns_cache *cache)
 {
 	k_mutex_lock(cache->lock, K_FOREVER);
 	for (size_t i = 0; i < cache->size; i++) {
 		cache->entries[i].in_use = false;
+		cache->entries[i].next = 0;
+		cache->buckets[i] = 0;
 	}
+	cache->next_expiry = sys_timepoint_calc(K_FOREVER);
 	k_mutex_unlock(cache->lock);
 
 	return 0;
@@ -25,47 +194,79 @@ int dns_cache_flush(struct dns_cache *cache)
 int dns_cache_add(struct dns_cache *cache, char const *query, struct dns_addrinfo const *addrinfo,
 		  uint32_t ttl)
 {
-	k_timepoint_t closest_to_expiry = sys_timepoint_calc(K_FOREVER);
-	size_t index_to_replace = 0;
-	bool found_empty = false;
+	struct dns_cache_entry *entry;
+	uint32_t hash;
+	size_t index;
 
 	if (cache == NULL || query == NULL || addrinfo == NULL || ttl == 0) {
 		return -EINVAL;
 	}
 
-	if (strlen(query) >= CONFIG_DNS_RESOLVER_MAX_QUERY_LEN) {
-		NET_WARN("Query string to big to be processed %u >= "
-			 "CONFIG_DNS_RESOLVER_MAX_QUERY_LEN",
-			 strlen(query));
+	if (dns_cache_check_query(query) < 0) {
 		return -EINVAL;
 	}
 
+	hash = dns_cache_hash(query);
+
 	k_mutex_lock(cache->lock, K_FOREVER);
 
 	NET_DBG("Add \"%s\" with TTL %" PRIu32, query, ttl);
 
-	dns_cache_clean(cache);
+	dns_cache_remove_negative(cache, hash, query, addrinfo->ai_family);
 
-	for (size_t i = 0; i < cache->size; i++) {
-		if (!cache->entries[i].in_use) {
-			index_to_replace = i;
-			found_empty = true;
-			break;
-		} else if (sys_timepoint_cmp(closest_to_expiry, cache->entries[i].expiry) > 0) {
-			index_to_replace = i;
-			closest_to_expiry = cache->entries[i].expiry;
-		}
+	if (dns_cache_renew(cache, hash, query, addrinfo, ttl)) {
+		goto out;
 	}
 
-	if (!found_empty) {
-		NET_DBG("Overwrite \"%s\"", cache->entries[index_to_replace].query);
+	index = dns_cache_slot(cache);
+	entry = &cache->entries[index];
+
+	strncpy(entry->query, query, CONFIG_DNS_RESOLVER_MAX_QUERY_LEN - 1);
+	entry->data = *addrinfo;
+	entry->hash = hash;
+	entry->negative = false;
+	dns_cache_set_ttl(entry, ttl);
+	dns_cache_link(cache, index);
+
+out:
+	k_mutex_unlock(cache->lock);
+
+	return 0;
+}
+
+int dns_cache_add_negative(struct dns_cache *cache, char const *query, sa_family_t family,
+			   uint32_t ttl)
+{
+	struct dns_cache_entry *entry;
+	uint32_t hash;
+	size_t index;
+
+	if (cache == NULL || query == NULL || ttl == 0) {
+		return -EINVAL;
 	}
 
-	strncpy(cache->entries[index_to_replace].query, query,
-		CONFIG_DNS_RESOLVER_MAX_QUERY_LEN - 1);
-	cache->entries[index_to_replace].data = *addrinfo;
-	cache->entries[index_to_replace].expiry = sys_timepoint_calc(K_SECONDS(ttl));
-	cache->entries[index_to_replace].in_use = true;
+	if (dns_cache_check_query(query) < 0) {
+		return -EINVAL;
+	}
+
+	hash = dns_cache_hash(query);
+
+	k_mutex_lock(cache->lock, K_FOREVER);
+
+	NET_DBG("Add negative \"%s\" family %d with TTL %" PRIu32, query, family, ttl);
+
+	dns_cache_remove_negative(cache, hash, query, family);
+
+	index = dns_cache_slot(cache);
+	entry = &cache->entries[index];
+
+	strncpy(entry->query, query, CONFIG_DNS_RESOLVER_MAX_QUERY_LEN - 1);
+	memset(&entry->data, 0, sizeof(entry->data));
+	entry->data.ai_family = family;
+	entry->hash = hash;
+	entry->negative = true;
+	dns_cache_set_ttl(entry, ttl);
+	dns_cache_link(cache, index);
 
 	k_mutex_unlock(cache->lock);
 
@@ -74,22 +275,30 @@ int dns_cache_add(struct dns_cache *cache, char const *query, struct dns_addrinf
 
 int dns_cache_remove(struct dns_cache *cache, char const *query)
 {
+	uint32_t hash;
+	uint16_t link;
+
 	NET_DBG("Remove all entries with query \"%s\"", query);
-	if (strlen(query) >= CONFIG_DNS_RESOLVER_MAX_QUERY_LEN) {
-		NET_WARN("Query string to big to be processed %u >= "
-			 "CONFIG_DNS_RESOLVER_MAX_QUERY_LEN",
-			 strlen(query));
+	if (dns_cache_check_query(query) < 0) {
 		return -EINVAL;
 	}
 
+	hash = dns_cache_hash(query);
+
 	k_mutex_lock(cache->lock, K_FOREVER);
 
 	dns_cache_clean(cache);
 
-	for (size_t i = 0; i < cache->size; i++) {
-		if (cache->entries[i].in_use && strcmp(cache->entries[i].query, query) == 0) {
-			cache->entries[i].in_use = false;
+	link = *dns_cache_bucket(cache, hash);
+	while (link != 0) {
+		struct dns_cache_entry *entry = dns_cache_entry(cache, link);
+		uint16_t next = entry->next;
+
+		if (dns_cache_match(entry, hash, query)) {
+			dns_cache_unlink(cache, link - 1);
 		}
+
+		link = next;
 	}
 
 	k_mutex_unlock(cache->lock);
@@ -97,38 +306,42 @@ int dns_cache_remove(struct dns_cache *cache, char const *query)
 	return 0;
 }
 
-int dns_cache_find(struct dns_cache const *cache, const char *query, struct dns_addrinfo *addrinfo,
-		   size_t addrinfo_array_len)
+int dns_cache_find_family(struct dns_cache *cache, const char *query, sa_family_t family,
+			  struct dns_addrinfo *addrinfo, size_t addrinfo_array_len)
 {
 	size_t found = 0;
+	uint32_t hash;
+	uint16_t link;
 
 	NET_DBG("Find \"%s\"", query);
 	if (cache == NULL || query == NULL || addrinfo == NULL || addrinfo_array_len <= 0) {
 		return -EINVAL;
 	}
-	if (strlen(query) >= CONFIG_DNS_RESOLVER_MAX_QUERY_LEN) {
-		NET_WARN("Query string to big to be processed %u >= "
-			 "CONFIG_DNS_RESOLVER_MAX_QUERY_LEN",
-			 strlen(query));
+	if (dns_cache_check_query(query) < 0) {
 		return -EINVAL;
 	}
 
+	hash = dns_cache_hash(query);
+
 	k_mutex_lock(cache->lock, K_FOREVER);
 
 	dns_cache_clean(cache);
 
-	for (size_t i = 0; i < cache->size; i++) {
-		if (!cache->entries[i].in_use) {
+	for (link = *dns_cache_bucket(cache, hash); link != 0;
+	     link = dns_cache_entry(cache, link)->next) {
+		struct dns_cache_entry *entry = dns_cache_entry(cache, link);
+
+		if (entry->negative || !dns_cache_match(entry, hash, query)) {
 			continue;
 		}
-		if (strcmp(cache->entries[i].query, query) != 0) {
+		if (family != AF_UNSPEC && entry->data.ai_family != family) {
 			continue;
 		}
 		if (found >= addrinfo_array_len) {
 			NET_WARN("Found \"%s\" but not enough space in provided buffer.", query);
 			found++;
 		} else {
-			addrinfo[found] = cache->entries[i].data;
+			addrinfo[found] = entry->data;
 			found++;
 			NET_DBG("Found \"%s\"", query);
 		}
@@ -146,9 +359,88 @@ int dns_cache_find(struct dns_cache const *cache, const char *query, struct dns_
 	return found;
 }
 
+int dns_cache_find(struct dns_cache *cache, const char *query, struct dns_addrinfo *addrinfo,
+		   size_t addrinfo_array_len)
+{
+	return dns_cache_find_family(cache, query, AF_UNSPEC, addrinfo, addrinfo_array_len);
+}
+
+bool dns_cache_find_negative(struct dns_cache *cache, const char *query, sa_family_t family)
+{
+	bool found = false;
+	uint32_t hash;
+	uint16_t link;
+
+	if (cache == NULL || query == NULL || dns_cache_check_query(query) < 0) {
+		return false;
+	}
+
+	hash = dns_cache_hash(query);
+
+	k_mutex_lock(cache->lock, K_FOREVER);
+
+	dns_cache_clean(cache);
+
+	for (link = *dns_cache_bucket(cache, hash); link != 0;
+	     link = dns_cache_entry(cache, link)->next) {
+		struct dns_cache_entry *entry = dns_cache_entry(cache, link);
+
+		if (entry->negative && dns_cache_match(entry, hash, query) &&
+		    dns_cache_family_match(entry, family)) {
+			found = true;
+			break;
+		}
+	}
+
+	k_mutex_unlock(cache->lock);
+
+	return found;
+}
+
+bool dns_cache_prefetch_due(struct dns_cache *cache, const char *query, sa_family_t family)
+{
+	bool due = false;
+	uint32_t hash;
+	uint16_t link;
+
+	if (cache == NULL || query == NULL || dns_cache_check_query(query) < 0) {
+		return false;
+	}
+
+	hash = dns_cache_hash(query);
+
+	k_mutex_lock(cache->lock, K_FOREVER);
+
+	for (link = *dns_cache_bucket(cache, hash); link != 0;
+	     link = dns_cache_entry(cache, link)->next) {
+		struct dns_cache_entry *entry = dns_cache_entry(cache, link);
+
+		if (entry->negative || entry->prefetching ||
+		    !dns_cache_match(entry, hash, query) ||
+		    !dns_cache_family_match(entry, family) ||
+		    !sys_timepoint_expired(entry->prefetch)) {
+			continue;
+		}
+
+		entry->prefetching = true;
+		due = true;
+	}
+
+	k_mutex_unlock(cache->lock);
+
+	return due;
+}
+
 /* Needs to be called when lock is already acquired */
-static void dns_cache_clean(struct dns_cache const *cache)
+static void dns_cache_clean(struct dns_cache *cache)
 {
+	k_timepoint_t next_expiry = sys_timepoint_calc(K_FOREVER);
+
+	/* Nothing can have expired before the earliest expiry */
+	if (!sys_timepoint_expired(cache->next_expiry)) {
+		return;
+	}
+
 	for (size_t i = 0; i < cache->size; i++) {
 		if (!cache->entries[i].in_use) {
 			continue;
@@ -156,7 +448,11 @@ static void dns_cache_clean(struct dns_cache const *cache)
 
 		if (sys_timepoint_expired(cache->entries[i].expiry)) {
 			NET_DBG("Remove \"%s\"", cache->entries[i].query);
-			cache->entries[i].in_use = false;
+			dns_cache_unlink(cache, i);
+		} else if (sys_timepoint_cmp(cache->entries[i].expiry, next_expiry) < 0) {
+			next_expiry = cache->entries[i].expiry;
 		}
 	}
+
+	cache->next_expiry = next_expiry;
 }
@@ -22,12 +22,26 @@ struct dns_cache_entry {
 	char query[CONFIG_DNS_RESOLVER_MAX_QUERY_LEN];
 	struct dns_addrinfo data;
 	k_timepoint_t expiry;
+	/** Time after which the entry should be refreshed ahead of expiry */
+	k_timepoint_t prefetch;
+	/** Hash of @a query, used to pick the bucket */
+	uint32_t hash;
+	/** Next entry in the same bucket, as index + 1 (0 ends the chain) */
+	uint16_t next;
+	/** The name (or name and family) is known not to resolve */
+	bool negative;
+	/** A refresh of this entry has been requested */
+	bool prefetching;
 	bool in_use;
 };
 
 struct dns_cache {
 	size_t size;
 	struct dns_cache_entry *entries;
+	/** Bucket heads, as entry index + 1 (0 is an empty bucket) */
+	uint16_t *buckets;
+	/** Earliest expiry of all entries, nothing to purge before that */
+	k_timepoint_t next_expiry;
 	struct k_mutex *lock;
 };
 
@@ -41,10 +55,13 @@ struct dns_cache {
  * @param name Name of the cache.
  */
 #define DNS_CACHE_DEFINE(name, cache_size)                                                         \
+	BUILD_ASSERT((cache_size) < UINT16_MAX, "DNS cache too large");                            \
 	static K_MUTEX_DEFINE(name##_mutex);                                                       \
 	static struct dns_cache_entry name##_entries[cache_size];                                  \
+	static uint16_t name##_buckets[cache_size];                                                \
 	static struct dns_cache name = {                                                           \
-		.entries = name##_entries, .size = cache_size, .lock = &name##_mutex};
+		.entries = name##_entries, .buckets = name##_buckets, .size = cache_size,          \
+		.lock = &name##_mutex};
 
 /**
  * @brief Flushes the dns cache removing all its entries.
@@ -94,7 +111,63 @@ int dns_cache_remove(struct dns_cache *cache, char const *query);
  * -ENOSR means there was not enough space in the addrinfo array to accommodate all cache hits the
  * array will however be filled with valid data.
  */
-int dns_cache_find(struct dns_cache const *cache, const char *query, struct dns_addrinfo *addrinfo,
+int dns_cache_find(struct dns_cache *cache, const char *query, struct dns_addrinfo *addrinfo,
 		   size_t addrinfo_array_len);
 
+/**
+ * @brief Tries to find the specified query entry of one address family within the cache.
+ *
+ * Same as dns_cache_find() but only returns addresses of the given family.
+ *
+ * @param cache Cache where the entry should be searched.
+ * @param query Query which should be searched for.
+ * @param family Address family to look for, or AF_UNSPEC for any.
+ * @param addrinfo dns_addrinfo array which will be written if the query was found.
+ * @param addrinfo_array_len Array size of the dns_addrinfo array
+ * @retval Same as for dns_cache_find().
+ */
+int dns_cache_find_family(struct dns_cache *cache, const char *query, sa_family_t family,
+			  struct dns_addrinfo *addrinfo, size_t addrinfo_array_len);
+
+/**
+ * @brief Adds a negative entry, recording that a query has no answer.
+ *
+ * Adding a regular entry for the same query and family drops the negative one.
+ *
+ * @param cache Cache where the entry should be added.
+ * @param query Query which did not resolve.
+ * @param family AF_UNSPEC if the name does not exist at all (NXDOMAIN), or the
+ * address family for which the name has no records (NODATA).
+ * @param ttl Time to live for the entry in seconds.
+ * @retval 0 on success
+ * @retval On error, a negative value is returned.
+ */
+int dns_cache_add_negative(struct dns_cache *cache, char const *query, sa_family_t family,
+			   uint32_t ttl);
+
+/**
+ * @brief Checks whether the cache holds a negative answer for a query.
+ *
+ * @param cache Cache where the entry should be searched.
+ * @param query Query which should be searched for.
+ * @param family Address family of the query.
+ * @retval true if the query is known not to resolve for @p family.
+ */
+bool dns_cache_find_negative(struct dns_cache *cache, const char *query, sa_family_t family);
+
+/**
+ * @brief Checks whether cached addresses of a query should be refreshed.
+ *
+ * Returns true once the entries of the query are close to expiry, and marks
+ * them so that subsequent calls return false until a fresh answer is added.
+ * An address added again while its entry is being refreshed only renews the
+ * existing entry instead of creating a duplicate.
+ *
+ * @param cache Cache where the entry should be searched.
+ * @param query Query which should be searched for.
+ * @param family Address family of the query.
+ * @retval true if the caller should issue a query to refresh the entries.
+ */
+bool dns_cache_prefetch_due(struct dns_cache *cache, const char *query, sa_family_t family);
+
 #endif /* ZEPHYR_INCLUDE_NET_DNS_CACHE_H_ */
@@ -223,10 +223,17 @@ int dns_unpack_response_header(struct dns_msg_t *msg, int src_id)
 	/* For mDNS (when src_id == 0) the query count is 0 so accept
 	 * the packet in that case.
 	 */
-	if ((qdcount < 1 && src_id > 0) || ancount < 1) {
+	if (qdcount < 1 && src_id > 0) {
 		return -EINVAL;
 	}
 
+	/* A successful reply without answers, i.e. the name exists but has
+	 * no records of the queried type.
+	 */
+	if (ancount < 1) {
+		return -ENODATA;
+	}
+
 	return 0;
 }
 
@@ -72,6 +72,17 @@ NET_BUF_POOL_DEFINE(dns_qname_pool, DNS_RESOLVER_BUF_CTR, CONFIG_DNS_RESOLVER_MA
 DNS_CACHE_DEFINE(dns_cache, CONFIG_DNS_RESOLVER_CACHE_MAX_ENTRIES);
 #endif /* CONFIG_DNS_RESOLVER_CACHE */
 
+#ifdef CONFIG_DNS_RESOLVER_CACHE_PREFETCH
+/* Refreshes run in the background, so they need their own copy of the name */
+static char dns_prefetch_query[CONFIG_DNS_RESOLVER_MAX_QUERY_LEN];
+static atomic_t dns_prefetch_busy;
+
+/* Used when the caller asked to wait forever, which a refresh should not */
+#define DNS_PREFETCH_TIMEOUT_MS (2 * MSEC_PER_SEC)
+#endif /* CONFIG_DNS_RESOLVER_CACHE_PREFETCH */
+
+static struct dns_resolve_stats dns_stats;
+
 static struct dns_resolve_context dns_default_ctx;
 
 /* Must be invoked with context lock held */
@@ -414,7 +425,104 @@ static inline void invoke_query_callback(int status,
 	if (pending_query->query != NULL && pending_query->cb != NULL)  {
 		pending_query->cb(status, info, pending_query->user_data);
 	}
+
+#if defined(CONFIG_DNS_RESOLVER_COALESCE_QUERIES)
+	/* Share the result with the queries waiting on this one */
+	for (int i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		struct dns_pending_query *follower =
+			&pending_query->ctx->queries[i];
+
+		if (follower->leader == pending_query &&
+		    follower->query != NULL && follower->cb != NULL) {
+			follower->cb(status, info, follower->user_data);
+		}
+	}
+#endif
+}
+
+#if defined(CONFIG_DNS_RESOLVER_COALESCE_QUERIES)
+static void release_query(struct dns_pending_query *pending_query);
+
+/* Callback of a query whose caller is done while other queries still wait
+ * for its answer.
+ */
+static void dns_detached_cb(enum dns_resolve_status status,
+			    struct dns_addrinfo *info,
+			    void *user_data)
+{
+	ARG_UNUSED(status);
+	ARG_UNUSED(info);
+	ARG_UNUSED(user_data);
+}
+
+/* Must be invoked with context lock held */
+static struct dns_pending_query *get_follower(struct dns_pending_query *leader)
+{
+	for (int i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		if (leader->ctx->queries[i].leader == leader) {
+			return &leader->ctx->queries[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Stop a query from waiting on its leader. A detached leader lives only as
+ * long as there are queries waiting on it.
+ *
+ * Must be invoked with context lock held.
+ */
+static void release_follower(struct dns_pending_query *follower)
+{
+	struct dns_pending_query *leader = follower->leader;
+
+	follower->leader = NULL;
+
+	if (leader->cb != dns_detached_cb) {
+		return;
+	}
+
+	follower = get_follower(leader);
+	if (follower == NULL) {
+		release_query(leader);
+		return;
+	}
+
+	/* The query name belongs to the caller, so it has to come from a
+	 * caller that is still waiting.
+	 */
+	leader->query = follower->query;
+}
+
+/* End the caller of a query while keeping its request for the queries that
+ * wait on it, each of which has a timeout of its own. Returns true if the
+ * request was kept.
+ *
+ * Must be invoked with context lock held.
+ */
+static bool detach_leader(struct dns_pending_query *pending_query)
+{
+	struct dns_pending_query *follower;
+
+	if (pending_query->cb == dns_detached_cb) {
+		return true;
+	}
+
+	follower = get_follower(pending_query);
+	if (follower == NULL) {
+		return false;
+	}
+
+	(void)k_work_cancel_delayable(&pending_query->timer);
+
+	pending_query->cb(DNS_EAI_CANCELED, NULL, pending_query->user_data);
+	pending_query->cb = dns_detached_cb;
+	pending_query->user_data = NULL;
+	pending_query->query = follower->query;
+
+	return true;
 }
+#endif /* CONFIG_DNS_RESOLVER_COALESCE_QUERIES */
 
 /* Release a query slot reserved by get_cb_slot().
  *
@@ -426,6 +534,23 @@ static void release_query(struct dns_pending_query *pending_query)
 {
 	int busy = k_work_cancel_delayable(&pending_query->timer);
 
+#if defined(CONFIG_DNS_RESOLVER_COALESCE_QUERIES)
+	if (pending_query->leader != NULL) {
+		release_follower(pending_query);
+	}
+
+	/* Queries waiting on this one are done as well */
+	for (int i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		struct dns_pending_query *follower =
+			&pending_query->ctx->queries[i];
+
+		if (follower->leader == pending_query) {
+			follower->leader = NULL;
+			release_query(follower);
+		}
+	}
+#endif
+
 	/* If the work item is no longer pending we're done. */
 	if (busy == 0) {
 		/* All done. */
@@ -458,6 +583,49 @@ static inline int get_slot_by_id(struct dns_resolve_context *ctx,
 	return -ENOENT;
 }
 
+#if defined(CONFIG_DNS_RESOLVER_COALESCE_QUERIES)
+/* Find a pending query that sent its own request for the same name and type.
+ *
+ * Must be invoked with context lock held.
+ */
+static int get_slot_by_name(struct dns_resolve_context *ctx, int skip,
+			    const char *query, enum dns_query_type type)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		struct dns_pending_query *pending_query = &ctx->queries[i];
+
+		if (i == skip || pending_query->cb == NULL ||
+		    pending_query->query == NULL ||
+		    pending_query->leader != NULL) {
+			continue;
+		}
+
+		if (pending_query->query_type == type &&
+		    strcmp(pending_query->query, query) == 0) {
+			return i;
+		}
+	}
+
+	return -ENOENT;
+}
+#endif /* CONFIG_DNS_RESOLVER_COALESCE_QUERIES */
+
+#ifdef CONFIG_DNS_RESOLVER_CACHE
+static inline sa_family_t dns_query_family(enum dns_query_type type)
+{
+	switch (type) {
+	case DNS_QUERY_TYPE_A:
+		return AF_INET;
+	case DNS_QUERY_TYPE_AAAA:
+		return AF_INET6;
+	default:
+		return AF_UNSPEC;
+	}
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
 /* Unit test needs to be able to call this function */
 #if !defined(CONFIG_NET_TEST)
 static
@@ -479,6 +647,9 @@ int dns_validate_msg(struct dns_resolve_context *ctx,
 	int items;
 	int server_idx;
 	int ret = 0;
+	/* the name does not exist, or has no records of the queried type */
+	bool nxdomain = false;
+	bool nodata = false;
 
 	/* Make sure that we can read DNS id, flags and rcode */
 	if (dns_msg->msg_size < (sizeof(*dns_id) + sizeof(uint16_t))) {
@@ -509,8 +680,14 @@ int dns_validate_msg(struct dns_resolve_context *ctx,
 
 	ret = dns_unpack_response_header(dns_msg, *dns_id);
 	if (ret < 0) {
-		ret = DNS_EAI_FAIL;
-		goto quit;
+		if (ret != -ENODATA || *dns_id == 0) {
+			ret = DNS_EAI_FAIL;
+			goto quit;
+		}
+
+		nodata = true;
+	} else if (ret == DNS_HEADER_NAMEERROR) {
+		nxdomain = true;
 	}
 
 	if (dns_header_qdcount(dns_msg->msg) != 1) {
@@ -678,7 +855,7 @@ query_known:
 	/* No IP addresses were found, so we take the last CNAME to generate
 	 * another query. Number of additional queries is controlled via Kconfig
 	 */
-	if (items == 0) {
+	if (items == 0 && !nxdomain && !nodata) {
 		if (dns_msg->response_type == DNS_RESPONSE_CNAME_NO_IP) {
 			uint16_t pos = dns_msg->response_position;
 
@@ -703,6 +880,17 @@ query_known:
 	}
 
 	if (items == 0) {
+#ifdef CONFIG_DNS_RESOLVER_CACHE
+		if ((nxdomain || nodata) &&
+		    CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL > 0 &&
+		    ctx->queries[*query_idx].query != NULL) {
+			dns_cache_add_negative(&dns_cache,
+				ctx->queries[*query_idx].query,
+				nxdomain ? AF_UNSPEC :
+				dns_query_family(ctx->queries[*query_idx].query_type),
+				CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL);
+		}
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
 		ret = DNS_EAI_NODATA;
 	} else {
 		ret = DNS_EAI_ALLDONE;
@@ -1000,6 +1188,12 @@ static int dns_resolve_cancel_with_hash(struct dns_resolve_context *ctx,
 		query_name, ctx->queries[i].query_type,
 		query_hash);
 
+#if defined(CONFIG_DNS_RESOLVER_COALESCE_QUERIES)
+	if (detach_leader(&ctx->queries[i])) {
+		goto unlock;
+	}
+#endif
+
 	dns_resolve_cancel_slot(ctx, i);
 
 unlock:
@@ -1109,6 +1303,114 @@ static void query_timeout(struct k_work *work)
 	k_mutex_unlock(&pending_query->ctx->lock);
 }
 
+static int dns_resolve_name_internal(struct dns_resolve_context *ctx,
+				     const char *query,
+				     enum dns_query_type type,
+				     uint16_t *dns_id,
+				     dns_resolve_cb_t cb,
+				     void *user_data,
+				     int32_t timeout,
+				     bool use_cache);
+
+#ifdef CONFIG_DNS_RESOLVER_CACHE_PREFETCH
+static void dns_prefetch_cb(enum dns_resolve_status status,
+			    struct dns_addrinfo *info,
+			    void *user_data)
+{
+	ARG_UNUSED(info);
+	ARG_UNUSED(user_data);
+
+	/* The answers are stored in the cache by dns_validate_msg(), so
+	 * there is nothing to do here until the query is finished.
+	 */
+	if (status != DNS_EAI_INPROGRESS) {
+		atomic_clear(&dns_prefetch_busy);
+	}
+}
+
+static void dns_prefetch(struct dns_resolve_context *ctx, const char *query,
+			 enum dns_query_type type, int32_t timeout)
+{
+	/* Only one refresh is run at a time so that a burst of cache hits
+	 * cannot use up all the query slots.
+	 */
+	if (!atomic_cas(&dns_prefetch_busy, 0, 1)) {
+		return;
+	}
+
+	strncpy(dns_prefetch_query, query, sizeof(dns_prefetch_query) - 1);
+
+	if (timeout == SYS_FOREVER_MS) {
+		timeout = DNS_PREFETCH_TIMEOUT_MS;
+	}
+
+	if (dns_resolve_name_internal(ctx, dns_prefetch_query, type, NULL,
+				      dns_prefetch_cb, NULL, timeout,
+				      false) < 0) {
+		atomic_clear(&dns_prefetch_busy);
+		return;
+	}
+
+	NET_DBG("Refreshing %s", query);
+
+	dns_stats.cache_prefetch++;
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE_PREFETCH */
+
+#ifdef CONFIG_DNS_RESOLVER_CACHE
+/* Returns true if the query was answered from the cache */
+static bool dns_resolve_from_cache(struct dns_resolve_context *ctx,
+				   const char *query,
+				   enum dns_query_type type,
+				   dns_resolve_cb_t cb,
+				   void *user_data,
+				   int32_t timeout)
+{
+	struct dns_addrinfo cached_info[CONFIG_DNS_RESOLVER_AI_MAX_ENTRIES] = {0};
+	sa_family_t family = dns_query_family(type);
+	int ret;
+
+	ret = dns_cache_find_family(&dns_cache, query, family, cached_info,
+				    ARRAY_SIZE(cached_info));
+	if (ret == -ENOSR) {
+		/* More entries cached than we can return, use what fits */
+		ret = ARRAY_SIZE(cached_info);
+	}
+
+	if (ret > 0) {
+		dns_stats.cache_hit++;
+
+		for (size_t cache_index = 0; cache_index < ret; cache_index++) {
+			cb(DNS_EAI_INPROGRESS, &cached_info[cache_index], user_data);
+		}
+		cb(DNS_EAI_ALLDONE, NULL, user_data);
+
+#ifdef CONFIG_DNS_RESOLVER_CACHE_PREFETCH
+		if (dns_cache_prefetch_due(&dns_cache, query, family)) {
+			dns_prefetch(ctx, query, type, timeout);
+		}
+#else
+		ARG_UNUSED(ctx);
+		ARG_UNUSED(timeout);
+#endif
+		return true;
+	}
+
+	if (CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL > 0 &&
+	    dns_cache_find_negative(&dns_cache, query, family)) {
+		dns_stats.cache_negative_hit++;
+
+		cb(DNS_EAI_NODATA, NULL, user_data);
+
+		return true;
+	}
+
+	dns_stats.cache_miss++;
+
+	return false;
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
 int dns_resolve_name(struct dns_resolve_context *ctx,
 		     const char *query,
 		     enum dns_query_type type,
@@ -1116,6 +1418,19 @@ int dns_resolve_name(struct dns_resolve_context *ctx,
 		     dns_resolve_cb_t cb,
 		     void *user_data,
 		     int32_t timeout)
+{
+	return dns_resolve_name_internal(ctx, query, type, dns_id, cb,
+					 user_data, timeout, true);
+}
+
+static int dns_resolve_name_internal(struct dns_resolve_context *ctx,
+				     const char *query,
+				     enum dns_query_type type,
+				     uint16_t *dns_id,
+				     dns_resolve_cb_t cb,
+				     void *user_data,
+				     int32_t timeout,
+				     bool use_cache)
 {
 	k_timeout_t tout;
 	struct net_buf *dns_data = NULL;
@@ -1125,9 +1440,9 @@ int dns_resolve_name(struct dns_resolve_context *ctx,
 	int failure = 0;
 	bool mdns_query = false;
 	uint8_t hop_limit;
-#ifdef CONFIG_DNS_RESOLVER_CACHE
-	struct dns_addrinfo cached_info[CONFIG_DNS_RESOLVER_AI_MAX_ENTRIES] = {0};
-#endif /* CONFIG_DNS_RESOLVER_CACHE */
+#if defined(CONFIG_DNS_RESOLVER_COALESCE_QUERIES)
+	int leader;
+#endif
 
 	if (!ctx || !query || !cb) {
 		return -EINVAL;
@@ -1190,18 +1505,15 @@ int dns_resolve_name(struct dns_resolve_context *ctx,
 
 try_resolve:
 #ifdef CONFIG_DNS_RESOLVER_CACHE
-	ret = dns_cache_find(&dns_cache, query, cached_info, sizeof(cached_info));
-	if (ret > 0) {
+	if (use_cache &&
+	    dns_resolve_from_cache(ctx, query, type, cb, user_data, timeout)) {
 		/* The query was cached, no
 		 * need to continue further.
 		 */
-		for (size_t cache_index = 0; cache_index < ret; cache_index++) {
-			cb(DNS_EAI_INPROGRESS, &cached_info[cache_index], user_data);
-		}
-		cb(DNS_EAI_ALLDONE, NULL, user_data);
-
 		return 0;
 	}
+#else
+	ARG_UNUSED(use_cache);
 #endif /* CONFIG_DNS_RESOLVER_CACHE */
 
 	k_mutex_lock(&ctx->lock, K_FOREVER);
@@ -1227,6 +1539,41 @@ try_resolve:
 
 	k_work_init_delayable(&ctx->queries[i].timer, query_timeout);
 
+#if defined(CONFIG_DNS_RESOLVER_COALESCE_QUERIES)
+	ctx->queries[i].leader = NULL;
+
+	/* If the same name is already being resolved, wait for that answer
+	 * instead of sending another request. The query gets an id and a
+	 * timeout of its own so that it can still end separately.
+	 */
+	leader = get_slot_by_name(ctx, i, query, type);
+	if (leader >= 0) {
+		ctx->queries[i].leader = &ctx->queries[leader];
+		ctx->queries[i].query_hash = ctx->queries[leader].query_hash;
+
+		do {
+			ctx->queries[i].id = sys_rand16_get();
+		} while (ctx->queries[i].id == ctx->queries[leader].id);
+
+		if (dns_id) {
+			*dns_id = ctx->queries[i].id;
+		}
+
+		/* Wait no longer than this caller asked for */
+		ret = k_work_reschedule(&ctx->queries[i].timer, tout);
+		if (ret < 0) {
+			goto quit;
+		}
+
+		NET_DBG("Query %s joins pending query id %u", query,
+			ctx->queries[leader].id);
+
+		dns_stats.coalesced++;
+		ret = 0;
+		goto quit;
+	}
+#endif /* CONFIG_DNS_RESOLVER_COALESCE_QUERIES */
+
 	dns_data = net_buf_alloc(&dns_msg_pool, ctx->buf_timeout);
 	if (!dns_data) {
 		ret = -ENOMEM;
@@ -1501,6 +1848,11 @@ unlock:
 	return err;
 }
 
+void dns_resolve_get_stats(struct dns_resolve_stats *stats)
+{
+	*stats = dns_stats;
+}
+
 struct dns_resolve_context *dns_resolve_get_default(void)
 {
 	return &dns_default_ctx;
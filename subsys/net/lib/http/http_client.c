@@ -295,13 +295,18 @@ static int on_headers_complete(struct http_parser *parser)
 		req->internal.response.http_cb->on_headers_complete(parser);
 	}
 
-	if (parser->status_code >= 500 && parser->status_code < 600) {
+	/* On a persistent connection the body must be consumed, the next
+	 * response follows it.
+	 */
+	if (!req->internal.persistent &&
+	    parser->status_code >= 500 && parser->status_code < 600) {
 		NET_DBG("Status %d, skipping body", parser->status_code);
 		return 1;
 	}
 
 	if ((req->method == HTTP_HEAD || req->method == HTTP_OPTIONS) &&
-	    req->internal.response.content_length > 0) {
+	    (req->internal.response.content_length > 0 ||
+	     (req->internal.persistent && req->method == HTTP_HEAD))) {
 		NET_DBG("No body expected");
 		return 1;
 	}
@@ -344,6 +349,13 @@ static int on_message_complete(struct http_parser *parser)
 
 	req->internal.response.message_complete = 1;
 
+	/* Stop at the end of the response, data after it belongs to the
+	 * response of the next pipelined request.
+	 */
+	if (req->internal.persistent) {
+		http_parser_pause(parser, 1);
+	}
+
 	return 0;
 }
 
@@ -439,11 +451,52 @@ static void http_report_progress(struct http_request *req)
 	}
 }
 
-static int http_wait_data(int sock, struct http_request *req, int32_t timeout)
+/* Account for the part of the received data which follows the end of the
+ * response, it is kept in the connection for the next response.
+ */
+static void http_carry_data(struct http_client_conn *conn,
+			    struct http_request *req, uint8_t *data,
+			    size_t len, size_t parsed, bool carried)
+{
+	size_t extra = len - parsed;
+
+	http_parser_pause(&req->internal.parser, 0);
+
+	if (extra == 0) {
+		return;
+	}
+
+	req->internal.response.data_len -= extra;
+
+	if (req->internal.response.body_frag_start) {
+		req->internal.response.body_frag_len =
+			req->internal.response.data_len -
+			(req->internal.response.body_frag_start -
+			 req->internal.response.recv_buf);
+	}
+
+	if (carried && conn->carry_len > 0) {
+		/* Still reading the carried data, which was copied from
+		 * another buffer and is thus intact.
+		 */
+		conn->carry -= extra;
+		conn->carry_len += extra;
+	} else {
+		conn->carry = data + parsed;
+		conn->carry_len = extra;
+	}
+
+	NET_DBG("%zd bytes of the next response received", conn->carry_len);
+}
+
+static int http_wait_data(int sock, struct http_request *req,
+			  struct http_client_conn *conn, int32_t timeout)
 {
 	int total_received = 0;
 	size_t offset = 0;
+	size_t parsed;
 	int received, ret;
+	bool carried;
 	struct zsock_pollfd fds[1];
 	int nfds = 1;
 	int32_t remaining_time = timeout;
@@ -453,6 +506,22 @@ static int http_wait_data(int sock, struct http_request *req, int32_t timeout)
 	fds[0].events = ZSOCK_POLLIN;
 
 	do {
+		carried = (conn != NULL && conn->carry_len > 0);
+
+		if (carried) {
+			/* The start of this response was received along with
+			 * the previous one.
+			 */
+			received = MIN(conn->carry_len,
+				       req->internal.response.recv_buf_len - offset);
+			memmove(req->internal.response.recv_buf + offset,
+				conn->carry, received);
+			conn->carry += received;
+			conn->carry_len -= received;
+
+			goto process;
+		}
+
 		if (timeout > 0) {
 			remaining_time -= (int32_t)k_uptime_delta(&timestamp);
 			if (remaining_time < 0) {
@@ -485,34 +554,49 @@ static int http_wait_data(int sock, struct http_request *req, int32_t timeout)
 			} else if (received < 0) {
 				ret = -errno;
 				goto error;
-			} else {
-				req->internal.response.data_len += received;
-
-				(void)http_parser_execute(
-					&req->internal.parser, &req->internal.parser_settings,
-					req->internal.response.recv_buf + offset, received);
 			}
+		} else {
+			continue;
+		}
 
-			total_received += received;
-			offset += received;
+process:
+		req->internal.response.data_len += received;
 
-			if (offset >= req->internal.response.recv_buf_len) {
-				offset = 0;
-			}
+		parsed = http_parser_execute(
+			&req->internal.parser, &req->internal.parser_settings,
+			req->internal.response.recv_buf + offset, received);
 
-			if (req->internal.response.message_complete) {
-				http_report_complete(req);
-				break;
-			} else if (offset == 0) {
-				http_report_progress(req);
+		if (conn != NULL &&
+		    HTTP_PARSER_ERRNO(&req->internal.parser) == HPE_PAUSED) {
+			http_carry_data(conn, req,
+					req->internal.response.recv_buf + offset,
+					received, parsed, carried);
+			received = parsed;
+		}
 
-				/* Re-use the result buffer and start to fill it again */
-				req->internal.response.data_len = 0;
-				req->internal.response.body_frag_start = NULL;
-				req->internal.response.body_frag_len = 0;
-			}
+		total_received += received;
+		offset += received;
+
+		if (offset >= req->internal.response.recv_buf_len) {
+			offset = 0;
 		}
 
+		if (req->internal.response.message_complete) {
+			if (conn != NULL) {
+				conn->keep_alive =
+					http_should_keep_alive(&req->internal.parser);
+			}
+
+			http_report_complete(req);
+			break;
+		} else if (offset == 0) {
+			http_report_progress(req);
+
+			/* Re-use the result buffer and start to fill it again */
+			req->internal.response.data_len = 0;
+			req->internal.response.body_frag_start = NULL;
+			req->internal.response.body_frag_len = 0;
+		}
 	} while (true);
 
 	return total_received;
@@ -520,6 +604,10 @@ static int http_wait_data(int sock, struct http_request *req, int32_t timeout)
 closed:
 	LOG_DBG("Connection closed");
 
+	if (conn != NULL) {
+		conn->keep_alive = false;
+	}
+
 	/* If connection was closed with no data sent, this is a NULL response, and is a special
 	 * case valid response.
 	 */
@@ -538,22 +626,23 @@ error:
 	return ret;
 }
 
-int http_client_req(int sock, struct http_request *req,
-		    int32_t timeout, void *user_data)
+static bool http_request_is_valid(int sock, const struct http_request *req)
+{
+	return !(sock < 0 || req == NULL || req->response == NULL ||
+		 req->recv_buf == NULL || req->recv_buf_len == 0);
+}
+
+static int http_send_request(int sock, struct http_request *req,
+			     bool persistent, void *user_data)
 {
 	/* Utilize the network usage by sending data in bigger blocks */
 	char send_buf[MAX_SEND_BUF_LEN];
 	const size_t send_buf_max_len = sizeof(send_buf);
 	size_t send_buf_pos = 0;
 	int total_sent = 0;
-	int ret, total_recv, i;
+	int ret, i;
 	const char *method;
 
-	if (sock < 0 || req == NULL || req->response == NULL ||
-	    req->recv_buf == NULL || req->recv_buf_len == 0) {
-		return -EINVAL;
-	}
-
 	memset(&req->internal.response, 0, sizeof(req->internal.response));
 
 	req->internal.response.http_cb = req->http_cb;
@@ -562,6 +651,7 @@ int http_client_req(int sock, struct http_request *req,
 	req->internal.response.recv_buf_len = req->recv_buf_len;
 	req->internal.user_data = user_data;
 	req->internal.sock = sock;
+	req->internal.persistent = persistent;
 
 	method = http_method_str(req->method);
 
@@ -728,18 +818,128 @@ int http_client_req(int sock, struct http_request *req,
 	http_client_init_parser(&req->internal.parser,
 				&req->internal.parser_settings);
 
+	return total_sent;
+
+out:
+	return ret;
+}
+
+int http_client_req(int sock, struct http_request *req,
+		    int32_t timeout, void *user_data)
+{
+	int total_sent, total_recv;
+
+	if (!http_request_is_valid(sock, req)) {
+		return -EINVAL;
+	}
+
+	total_sent = http_send_request(sock, req, false, user_data);
+	if (total_sent < 0) {
+		return total_sent;
+	}
+
 	/* Request is sent, now wait data to be received */
-	total_recv = http_wait_data(sock, req, timeout);
+	total_recv = http_wait_data(sock, req, NULL, timeout);
 	if (total_recv < 0) {
 		NET_DBG("Wait data failure (%d)", total_recv);
-		ret = total_recv;
-		goto out;
+		return total_recv;
 	}
 
 	NET_DBG("Received %d bytes", total_recv);
 
 	return total_sent;
+}
+
+void http_client_conn_init(struct http_client_conn *conn, int sock)
+{
+	memset(conn, 0, sizeof(*conn));
+
+	conn->sock = sock;
+	conn->keep_alive = true;
+}
+
+int http_client_conn_send(struct http_client_conn *conn,
+			  struct http_request *req, void *user_data)
+{
+	int ret;
+
+	if (conn == NULL || !http_request_is_valid(conn->sock, req)) {
+		return -EINVAL;
+	}
+
+	if (!conn->keep_alive) {
+		return -ENOTCONN;
+	}
+
+	if (conn->pending_count == ARRAY_SIZE(conn->pending)) {
+		return -EBUSY;
+	}
+
+	ret = http_send_request(conn->sock, req, true, user_data);
+	if (ret < 0) {
+		/* A partially sent request leaves the connection unusable */
+		conn->keep_alive = false;
+		return ret;
+	}
+
+	conn->pending[(conn->pending_head + conn->pending_count) %
+		      ARRAY_SIZE(conn->pending)] = req;
+	conn->pending_count++;
 
-out:
 	return ret;
 }
+
+int http_client_conn_recv(struct http_client_conn *conn, int32_t timeout)
+{
+	struct http_request *req;
+	int ret;
+
+	if (conn == NULL) {
+		return -EINVAL;
+	}
+
+	if (conn->pending_count == 0) {
+		return -ENOENT;
+	}
+
+	req = conn->pending[conn->pending_head];
+
+	conn->pending_head = (conn->pending_head + 1) % ARRAY_SIZE(conn->pending);
+	conn->pending_count--;
+
+	ret = http_wait_data(conn->sock, req, conn, timeout);
+	if (ret < 0) {
+		NET_DBG("Wait data failure (%d)", ret);
+
+		/* Whatever is left of the response would be taken for the
+		 * next one.
+		 */
+		conn->keep_alive = false;
+		conn->carry_len = 0;
+	}
+
+	return ret;
+}
+
+int http_client_conn_req(struct http_client_conn *conn,
+			 struct http_request *req, int32_t timeout,
+			 void *user_data)
+{
+	int total_sent;
+	int ret;
+
+	total_sent = http_client_conn_send(conn, req, user_data);
+	if (total_sent < 0) {
+		return total_sent;
+	}
+
+	/* Responses arrive in order, so complete the requests sent before */
+	while (conn->pending_count > 0) {
+		ret = http_client_conn_recv(conn, timeout);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+
+	return total_sent;
+}
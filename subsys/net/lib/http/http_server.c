@@ -0,0 +1,865 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(net_http_server, CONFIG_NET_HTTP_LOG_LEVEL);
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/net/http/server.h>
+#include <zephyr/net/http/service.h>
+#include <zephyr/net/http/status.h>
+#include <zephyr/net/net_ip.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/net/socket_service.h>
+#include <zephyr/sys/util.h>
+
+#define SERVER_FDS (CONFIG_HTTP_SERVER_MAX_SERVICES + CONFIG_HTTP_SERVER_MAX_CLIENTS)
+
+/* Room for the size line before a chunk and the CRLF after it. The buffer
+ * size is at most 0xffff, so the size fits in four hex digits.
+ */
+#define CHUNK_HEADER_LEN  (sizeof("ffff\r\n") - 1)
+#define CHUNK_TRAILER_LEN (sizeof("\r\n") - 1)
+#define CHUNK_LAST	  "0\r\n\r\n"
+
+BUILD_ASSERT(CONFIG_HTTP_SERVER_CLIENT_BUFFER_SIZE <= 0xffff);
+
+static void http_server_svc_handler(struct k_work *work);
+static void http_server_inactivity_handler(struct k_work *work);
+
+NET_SOCKET_SERVICE_SYNC_DEFINE_STATIC(http_server_svc, NULL, http_server_svc_handler, SERVER_FDS);
+
+static K_MUTEX_DEFINE(server_lock);
+static K_WORK_DELAYABLE_DEFINE(inactivity_work, http_server_inactivity_handler);
+
+/* The first CONFIG_HTTP_SERVER_MAX_SERVICES poll entries are the listening
+ * sockets, the others belong to the connection pool entry of same index.
+ */
+static struct {
+	struct zsock_pollfd fds[SERVER_FDS];
+	const struct http_service_desc *services[CONFIG_HTTP_SERVER_MAX_SERVICES];
+	struct http_client_ctx clients[CONFIG_HTTP_SERVER_MAX_CLIENTS];
+	bool fds_changed;
+	bool running;
+} server;
+
+static const char *http_status_str(uint16_t status)
+{
+	switch (status) {
+	case HTTP_200_OK:
+		return "OK";
+	case HTTP_400_BAD_REQUEST:
+		return "Bad Request";
+	case HTTP_404_NOT_FOUND:
+		return "Not Found";
+	case HTTP_405_METHOD_NOT_ALLOWED:
+		return "Method Not Allowed";
+	case HTTP_414_URI_TOO_LONG:
+		return "URI Too Long";
+	default:
+		return "Internal Server Error";
+	}
+}
+
+static const struct http_resource_detail *
+http_resource_find(const struct http_service_desc *service, const char *path)
+{
+	HTTP_SERVICE_FOREACH_RESOURCE(service, res) {
+		if (strcmp(res->resource, path) == 0) {
+			return res->detail;
+		}
+	}
+
+	return NULL;
+}
+
+static void client_reset_request(struct http_client_ctx *client)
+{
+	http_parser_init(&client->parser, HTTP_REQUEST);
+	client->parser.data = client;
+
+	client->resource = NULL;
+	client->url_len = 0;
+	client->status = 0;
+	client->tx_iovcnt = 0;
+	client->message_complete = false;
+	client->response_complete = false;
+}
+
+static void client_close(struct http_client_ctx *client)
+{
+	const struct http_resource_detail_dynamic *dynamic;
+
+	NET_DBG("[%p] Closing connection %d", client, client->fd);
+
+	if (client->status == HTTP_200_OK && client->resource != NULL &&
+	    client->resource->type == HTTP_RESOURCE_TYPE_DYNAMIC && !client->message_complete) {
+		dynamic = (const struct http_resource_detail_dynamic *)client->resource;
+
+		if (dynamic->request_cb != NULL) {
+			(void)dynamic->request_cb(client, HTTP_SERVER_DATA_ABORTED, NULL, 0,
+						  dynamic->user_data);
+		}
+	}
+
+#if defined(CONFIG_FILE_SYSTEM)
+	if (client->file.mp != NULL) {
+		(void)fs_close(&client->file);
+	}
+#endif
+
+	zsock_close(client->fd);
+	client->fd = -1;
+	server.fds_changed = true;
+}
+
+static int on_url(struct http_parser *parser, const char *at, size_t length)
+{
+	struct http_client_ctx *client = parser->data;
+
+	if (client->url_len + length >= sizeof(client->url_buffer)) {
+		client->status = HTTP_414_URI_TOO_LONG;
+		return -1;
+	}
+
+	memcpy(&client->url_buffer[client->url_len], at, length);
+	client->url_len += length;
+
+	return 0;
+}
+
+static int on_headers_complete(struct http_parser *parser)
+{
+	struct http_client_ctx *client = parser->data;
+	uint32_t methods;
+	char *query;
+
+	client->url_buffer[client->url_len] = '\0';
+
+	query = strchr(client->url_buffer, '?');
+	if (query != NULL) {
+		*query = '\0';
+	}
+
+	client->resource = http_resource_find(client->service, client->url_buffer);
+	if (client->resource == NULL) {
+		client->status = HTTP_404_NOT_FOUND;
+		return 0;
+	}
+
+	methods = client->resource->bitmask_of_supported_http_methods;
+
+	/* HEAD is implied by GET, the body is just left out */
+	if ((parser->method >= 32 || (methods & BIT(parser->method)) == 0) &&
+	    !(parser->method == HTTP_HEAD && (methods & BIT(HTTP_GET)) != 0)) {
+		client->status = HTTP_405_METHOD_NOT_ALLOWED;
+		return 0;
+	}
+
+	client->status = HTTP_200_OK;
+
+	return 0;
+}
+
+static int dynamic_request(struct http_client_ctx *client, enum http_data_status status,
+			   const uint8_t *data, size_t len)
+{
+	const struct http_resource_detail_dynamic *dynamic =
+		(const struct http_resource_detail_dynamic *)client->resource;
+
+	if (client->status != HTTP_200_OK ||
+	    client->resource->type != HTTP_RESOURCE_TYPE_DYNAMIC ||
+	    dynamic->request_cb == NULL) {
+		return 0;
+	}
+
+	if (dynamic->request_cb(client, status, data, len, dynamic->user_data) < 0) {
+		client->status = HTTP_500_INTERNAL_SERVER_ERROR;
+	}
+
+	return 0;
+}
+
+static int on_body(struct http_parser *parser, const char *at, size_t length)
+{
+	return dynamic_request(parser->data, HTTP_SERVER_DATA_MORE, (const uint8_t *)at, length);
+}
+
+static int on_message_complete(struct http_parser *parser)
+{
+	struct http_client_ctx *client = parser->data;
+
+	(void)dynamic_request(client, HTTP_SERVER_DATA_FINAL, NULL, 0);
+
+	client->message_complete = true;
+	client->keep_alive = http_should_keep_alive(parser);
+
+	/* Stop at the end of the request, a pipelined one is parsed after
+	 * the response is sent.
+	 */
+	http_parser_pause(parser, 1);
+
+	return 0;
+}
+
+static const struct http_parser_settings parser_settings = {
+	.on_url = on_url,
+	.on_headers_complete = on_headers_complete,
+	.on_body = on_body,
+	.on_message_complete = on_message_complete,
+};
+
+static void client_parse(struct http_client_ctx *client)
+{
+	enum http_errno err;
+	size_t parsed;
+
+	parsed = http_parser_execute(&client->parser, &parser_settings,
+				     (const char *)client->buffer, client->data_len);
+
+	err = HTTP_PARSER_ERRNO(&client->parser);
+	if (err != HPE_OK && err != HPE_PAUSED) {
+		NET_DBG("[%p] Invalid request (%s)", client, http_errno_name(err));
+
+		if (client->status != HTTP_414_URI_TOO_LONG) {
+			client->status = HTTP_400_BAD_REQUEST;
+		}
+
+		/* The parser cannot go on, answer and close */
+		client->resource = NULL;
+		client->message_complete = true;
+		client->keep_alive = false;
+		parsed = client->data_len;
+	}
+
+	client->data_len -= parsed;
+	memmove(client->buffer, &client->buffer[parsed], client->data_len);
+}
+
+static void client_queue(struct http_client_ctx *client, const void *data, size_t len)
+{
+	__ASSERT_NO_MSG(client->tx_iovcnt < ARRAY_SIZE(client->tx_iov));
+
+	client->tx_iov[client->tx_iovcnt].iov_base = (void *)data;
+	client->tx_iov[client->tx_iovcnt].iov_len = len;
+	client->tx_iovcnt++;
+}
+
+/* Queue the response header, a negative content length means chunked */
+static int response_header(struct http_client_ctx *client, ssize_t content_len)
+{
+	const struct http_resource_detail *res =
+		client->status == HTTP_200_OK ? client->resource : NULL;
+	char *buf = (char *)client->tx_buffer;
+	size_t size = sizeof(client->tx_buffer);
+	size_t len;
+
+	len = snprintk(buf, size, "HTTP/1.1 %u %s\r\n", client->status,
+		       http_status_str(client->status));
+
+	if (res != NULL && res->content_type != NULL && len < size) {
+		len += snprintk(&buf[len], size - len, "Content-Type: %s\r\n", res->content_type);
+	}
+
+	if (res != NULL && res->content_encoding != NULL && len < size) {
+		len += snprintk(&buf[len], size - len, "Content-Encoding: %s\r\n",
+				res->content_encoding);
+	}
+
+	if (content_len < 0 && len < size) {
+		len += snprintk(&buf[len], size - len, "Transfer-Encoding: chunked\r\n");
+	} else if (len < size) {
+		len += snprintk(&buf[len], size - len, "Content-Length: %zd\r\n", content_len);
+	}
+
+	if (!client->keep_alive && len < size) {
+		len += snprintk(&buf[len], size - len, "Connection: close\r\n");
+	}
+
+	if (len < size) {
+		len += snprintk(&buf[len], size - len, "\r\n");
+	}
+
+	if (len >= size) {
+		NET_ERR("[%p] Response header does not fit in %zu bytes", client, size);
+		return -ENOBUFS;
+	}
+
+	client_queue(client, buf, len);
+
+	return 0;
+}
+
+#if defined(CONFIG_FILE_SYSTEM)
+static int response_start_fs(struct http_client_ctx *client, bool head)
+{
+	const struct http_resource_detail_static_fs *res =
+		(const struct http_resource_detail_static_fs *)client->resource;
+	struct fs_dirent entry;
+	int ret;
+
+	fs_file_t_init(&client->file);
+
+	ret = fs_stat(res->fs_path, &entry);
+	if (ret == 0 && !head) {
+		ret = fs_open(&client->file, res->fs_path, FS_O_READ);
+	}
+
+	if (ret < 0) {
+		NET_DBG("[%p] Cannot open %s (%d)", client, res->fs_path, ret);
+		client->status = HTTP_404_NOT_FOUND;
+		client->response_complete = true;
+		return response_header(client, 0);
+	}
+
+	client->response_complete = head;
+
+	return response_header(client, entry.size);
+}
+#endif /* CONFIG_FILE_SYSTEM */
+
+static int response_start(struct http_client_ctx *client)
+{
+	const struct http_resource_detail_static *res_static;
+	bool head = client->parser.method == HTTP_HEAD;
+	int ret;
+
+	if (client->status != HTTP_200_OK) {
+		client->response_complete = true;
+		return response_header(client, 0);
+	}
+
+	switch (client->resource->type) {
+	case HTTP_RESOURCE_TYPE_STATIC:
+		res_static = (const struct http_resource_detail_static *)client->resource;
+
+		ret = response_header(client, res_static->static_data_len);
+		if (ret == 0 && !head) {
+			/* Sent along with the header, straight from where it is */
+			client_queue(client, res_static->static_data, res_static->static_data_len);
+		}
+
+		client->response_complete = true;
+		return ret;
+
+	case HTTP_RESOURCE_TYPE_STATIC_FS:
+#if defined(CONFIG_FILE_SYSTEM)
+		return response_start_fs(client, head);
+#else
+		client->status = HTTP_404_NOT_FOUND;
+		client->response_complete = true;
+		return response_header(client, 0);
+#endif
+
+	case HTTP_RESOURCE_TYPE_DYNAMIC:
+		client->response_complete = head;
+		return response_header(client, -1);
+	}
+
+	return -EINVAL;
+}
+
+/* Queue the next part of a streamed response once the previous one is sent */
+static int response_next(struct http_client_ctx *client)
+{
+	const struct http_resource_detail_dynamic *dynamic;
+	char size_line[CHUNK_HEADER_LEN + 1];
+	uint8_t *chunk;
+	ssize_t len;
+	int line_len;
+
+	switch (client->resource->type) {
+#if defined(CONFIG_FILE_SYSTEM)
+	case HTTP_RESOURCE_TYPE_STATIC_FS:
+		len = fs_read(&client->file, client->tx_buffer, sizeof(client->tx_buffer));
+		if (len < 0) {
+			return len;
+		}
+
+		if (len == 0) {
+			(void)fs_close(&client->file);
+			client->response_complete = true;
+			return 0;
+		}
+
+		client_queue(client, client->tx_buffer, len);
+		return 0;
+#endif
+
+	case HTTP_RESOURCE_TYPE_DYNAMIC:
+		dynamic = (const struct http_resource_detail_dynamic *)client->resource;
+		chunk = &client->tx_buffer[CHUNK_HEADER_LEN];
+
+		len = dynamic->response_cb(client, chunk,
+					   sizeof(client->tx_buffer) - CHUNK_HEADER_LEN -
+						   CHUNK_TRAILER_LEN,
+					   dynamic->user_data);
+		if (len < 0) {
+			return len;
+		}
+
+		if (len == 0) {
+			client->response_complete = true;
+			client_queue(client, CHUNK_LAST, sizeof(CHUNK_LAST) - 1);
+			return 0;
+		}
+
+		/* Put the size line right in front of the chunk data */
+		line_len = snprintk(size_line, sizeof(size_line), "%zx\r\n", (size_t)len);
+		memcpy(chunk - line_len, size_line, line_len);
+		memcpy(&chunk[len], "\r\n", CHUNK_TRAILER_LEN);
+
+		client_queue(client, chunk - line_len, line_len + len + CHUNK_TRAILER_LEN);
+		return 0;
+
+	default:
+		return -EINVAL;
+	}
+}
+
+static void client_tx_advance(struct http_client_ctx *client, size_t sent)
+{
+	while (sent > 0 && client->tx_iovcnt > 0) {
+		struct iovec *iov = &client->tx_iov[0];
+
+		if (sent < iov->iov_len) {
+			iov->iov_base = (uint8_t *)iov->iov_base + sent;
+			iov->iov_len -= sent;
+			return;
+		}
+
+		sent -= iov->iov_len;
+		client->tx_iovcnt--;
+		memmove(client->tx_iov, &client->tx_iov[1],
+			client->tx_iovcnt * sizeof(client->tx_iov[0]));
+	}
+}
+
+/* Send as much of the response as the socket takes without blocking */
+static int client_send(struct http_client_ctx *client)
+{
+	struct msghdr msg = {0};
+	ssize_t sent;
+	int ret;
+
+	while (true) {
+		while (client->tx_iovcnt > 0) {
+			msg.msg_iov = client->tx_iov;
+			msg.msg_iovlen = client->tx_iovcnt;
+
+			sent = zsock_sendmsg(client->fd, &msg, ZSOCK_MSG_DONTWAIT);
+			if (sent < 0) {
+				return -errno;
+			}
+
+			client_tx_advance(client, sent);
+		}
+
+		if (client->response_complete) {
+			return 0;
+		}
+
+		ret = response_next(client);
+		if (ret < 0) {
+			return ret;
+		}
+	}
+}
+
+/* Handle the buffered requests, returns a negative value when the
+ * connection is to be closed.
+ */
+static int client_process(struct http_client_ctx *client)
+{
+	int ret;
+
+	while (true) {
+		if (!client->message_complete) {
+			if (client->data_len == 0) {
+				return 0;
+			}
+
+			client_parse(client);
+			if (!client->message_complete) {
+				return 0;
+			}
+
+			ret = response_start(client);
+			if (ret < 0) {
+				return ret;
+			}
+		}
+
+		ret = client_send(client);
+		if (ret == -EAGAIN) {
+			/* Wait for the socket to be writable, pipelined
+			 * requests stay in the buffer meanwhile.
+			 */
+			client->tx_blocked = true;
+			return 0;
+		}
+
+		if (ret < 0) {
+			return ret;
+		}
+
+		client->tx_blocked = false;
+
+		if (!client->keep_alive) {
+			return -ENOTCONN;
+		}
+
+		client_reset_request(client);
+	}
+}
+
+static void client_event(struct http_client_ctx *client, short revents)
+{
+	bool tx_blocked = client->tx_blocked;
+	ssize_t len;
+	int ret;
+
+	client->last_activity = k_uptime_get();
+
+	if (revents & (ZSOCK_POLLERR | ZSOCK_POLLNVAL)) {
+		client_close(client);
+		return;
+	}
+
+	if (client->tx_blocked) {
+		if (!(revents & ZSOCK_POLLOUT)) {
+			if (revents & ZSOCK_POLLHUP) {
+				client_close(client);
+			}
+
+			return;
+		}
+	} else {
+		len = zsock_recv(client->fd, &client->buffer[client->data_len],
+				 sizeof(client->buffer) - client->data_len, ZSOCK_MSG_DONTWAIT);
+		if (len == 0 || (len < 0 && errno != EAGAIN)) {
+			client_close(client);
+			return;
+		}
+
+		if (len < 0) {
+			return;
+		}
+
+		client->data_len += len;
+	}
+
+	ret = client_process(client);
+	if (ret < 0) {
+		client_close(client);
+		return;
+	}
+
+	if (client->tx_blocked != tx_blocked) {
+		server.fds_changed = true;
+	}
+}
+
+static void server_accept(int index)
+{
+	const struct http_service_desc *service = server.services[index];
+	struct http_client_ctx *client = NULL;
+	size_t count = 0;
+	int sock;
+
+	sock = zsock_accept(server.fds[index].fd, NULL, NULL);
+	if (sock < 0) {
+		NET_ERR("Cannot accept connection (%d)", -errno);
+		return;
+	}
+
+	ARRAY_FOR_EACH_PTR(server.clients, it) {
+		if (it->fd < 0) {
+			client = client != NULL ? client : it;
+		} else if (it->service == service) {
+			count++;
+		}
+	}
+
+	if (client == NULL || (service->concurrent > 0 && count >= service->concurrent)) {
+		NET_DBG("Connection pool full, dropping connection");
+		zsock_close(sock);
+		return;
+	}
+
+	client->fd = sock;
+	client->service = service;
+	client->data_len = 0;
+	client->tx_blocked = false;
+	client->last_activity = k_uptime_get();
+#if defined(CONFIG_FILE_SYSTEM)
+	fs_file_t_init(&client->file);
+#endif
+	client_reset_request(client);
+
+	NET_DBG("[%p] Accepted connection %d", client, sock);
+
+	server.fds_changed = true;
+}
+
+static void server_update_fds(void)
+{
+	int ret;
+
+	for (int i = 0; i < CONFIG_HTTP_SERVER_MAX_CLIENTS; i++) {
+		struct zsock_pollfd *pollfd = &server.fds[CONFIG_HTTP_SERVER_MAX_SERVICES + i];
+		struct http_client_ctx *client = &server.clients[i];
+
+		pollfd->fd = client->fd;
+		pollfd->events = client->tx_blocked ? ZSOCK_POLLOUT : ZSOCK_POLLIN;
+	}
+
+	server.fds_changed = false;
+
+	ret = net_socket_service_register(&http_server_svc, server.fds, ARRAY_SIZE(server.fds),
+					  NULL);
+	if (ret < 0) {
+		NET_ERR("Cannot register socket service (%d)", ret);
+	}
+}
+
+static void http_server_svc_handler(struct k_work *work)
+{
+	struct net_socket_service_event *pev =
+		CONTAINER_OF(work, struct net_socket_service_event, work);
+	int fd = pev->event.fd;
+
+	k_mutex_lock(&server_lock, K_FOREVER);
+
+	if (!server.running) {
+		goto out;
+	}
+
+	for (int i = 0; i < CONFIG_HTTP_SERVER_MAX_SERVICES; i++) {
+		if (server.fds[i].fd == fd) {
+			if (pev->event.revents & ZSOCK_POLLIN) {
+				server_accept(i);
+			} else {
+				NET_ERR("Listening socket error (0x%x)", pev->event.revents);
+			}
+
+			goto out;
+		}
+	}
+
+	ARRAY_FOR_EACH_PTR(server.clients, client) {
+		if (client->fd == fd) {
+			client_event(client, pev->event.revents);
+			break;
+		}
+	}
+
+out:
+	if (server.running && server.fds_changed) {
+		server_update_fds();
+	}
+
+	k_mutex_unlock(&server_lock);
+}
+
+static void http_server_inactivity_handler(struct k_work *work)
+{
+	int64_t timeout = CONFIG_HTTP_SERVER_CLIENT_INACTIVITY_TIMEOUT * MSEC_PER_SEC;
+	int64_t now = k_uptime_get();
+
+	ARG_UNUSED(work);
+
+	k_mutex_lock(&server_lock, K_FOREVER);
+
+	if (!server.running) {
+		goto out;
+	}
+
+	ARRAY_FOR_EACH_PTR(server.clients, client) {
+		if (client->fd >= 0 && now - client->last_activity >= timeout) {
+			NET_DBG("[%p] Inactivity timeout", client);
+			client_close(client);
+		}
+	}
+
+	if (server.fds_changed) {
+		server_update_fds();
+	}
+
+	k_work_reschedule(&inactivity_work, K_MSEC(timeout));
+
+out:
+	k_mutex_unlock(&server_lock);
+}
+
+static int service_listen(const struct http_service_desc *service)
+{
+	struct sockaddr addr = {0};
+	socklen_t addr_len = sizeof(addr);
+	int backlog = MAX(service->backlog, 1);
+	int opt = 1;
+	int sock;
+	int ret;
+
+	if (service->host != NULL &&
+	    zsock_inet_pton(AF_INET6, service->host, &net_sin6(&addr)->sin6_addr) == 1) {
+		addr.sa_family = AF_INET6;
+	} else if (service->host != NULL &&
+		   zsock_inet_pton(AF_INET, service->host, &net_sin(&addr)->sin_addr) == 1) {
+		addr.sa_family = AF_INET;
+	} else {
+		/* A host name, accept any address */
+		addr.sa_family = IS_ENABLED(CONFIG_NET_IPV6) ? AF_INET6 : AF_INET;
+	}
+
+	if (addr.sa_family == AF_INET6) {
+		net_sin6(&addr)->sin6_port = htons(*service->port);
+	} else {
+		net_sin(&addr)->sin_port = htons(*service->port);
+	}
+
+	sock = zsock_socket(addr.sa_family, SOCK_STREAM, IPPROTO_TCP);
+	if (sock < 0) {
+		ret = -errno;
+		NET_ERR("Cannot create socket (%d)", ret);
+		return ret;
+	}
+
+	(void)zsock_setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+	if (zsock_bind(sock, &addr, addr.sa_family == AF_INET6 ? sizeof(struct sockaddr_in6)
+							       : sizeof(struct sockaddr_in)) < 0) {
+		ret = -errno;
+		NET_ERR("Cannot bind to port %u (%d)", *service->port, ret);
+		goto error;
+	}
+
+	if (zsock_listen(sock, backlog) < 0) {
+		ret = -errno;
+		NET_ERR("Cannot listen (%d)", ret);
+		goto error;
+	}
+
+	if (*service->port == 0) {
+		/* Ephemeral port, tell the application which one it got */
+		if (zsock_getsockname(sock, &addr, &addr_len) < 0) {
+			ret = -errno;
+			goto error;
+		}
+
+		*service->port = ntohs(addr.sa_family == AF_INET6 ? net_sin6(&addr)->sin6_port
+								  : net_sin(&addr)->sin_port);
+	}
+
+	NET_DBG("Listening on port %u", *service->port);
+
+	return sock;
+
+error:
+	zsock_close(sock);
+	return ret;
+}
+
+static void server_close_all(void)
+{
+	ARRAY_FOR_EACH_PTR(server.clients, client) {
+		if (client->fd >= 0) {
+			client_close(client);
+		}
+	}
+
+	for (int i = 0; i < CONFIG_HTTP_SERVER_MAX_SERVICES; i++) {
+		if (server.fds[i].fd >= 0) {
+			zsock_close(server.fds[i].fd);
+			server.fds[i].fd = -1;
+		}
+	}
+}
+
+int http_server_start(void)
+{
+	int count = 0;
+	int ret = 0;
+
+	k_mutex_lock(&server_lock, K_FOREVER);
+
+	if (server.running) {
+		ret = -EALREADY;
+		goto out;
+	}
+
+	ARRAY_FOR_EACH_PTR(server.fds, pollfd) {
+		pollfd->fd = -1;
+	}
+
+	ARRAY_FOR_EACH_PTR(server.clients, client) {
+		client->fd = -1;
+	}
+
+	HTTP_SERVICE_FOREACH(service) {
+		if (count >= CONFIG_HTTP_SERVER_MAX_SERVICES) {
+			NET_ERR("Too many services, increase %s", "CONFIG_HTTP_SERVER_MAX_SERVICES");
+			ret = -ENOMEM;
+			goto error;
+		}
+
+		ret = service_listen(service);
+		if (ret < 0) {
+			goto error;
+		}
+
+		server.services[count] = service;
+		server.fds[count].fd = ret;
+		server.fds[count].events = ZSOCK_POLLIN;
+		count++;
+	}
+
+	server.running = true;
+	server_update_fds();
+
+	if (CONFIG_HTTP_SERVER_CLIENT_INACTIVITY_TIMEOUT > 0) {
+		k_work_reschedule(&inactivity_work,
+				  K_SECONDS(CONFIG_HTTP_SERVER_CLIENT_INACTIVITY_TIMEOUT));
+	}
+
+	ret = 0;
+	goto out;
+
+error:
+	server_close_all();
+
+out:
+	k_mutex_unlock(&server_lock);
+
+	return ret;
+}
+
+int http_server_stop(void)
+{
+	int ret = 0;
+
+	k_mutex_lock(&server_lock, K_FOREVER);
+
+	if (!server.running) {
+		ret = -EALREADY;
+		goto out;
+	}
+
+	server.running = false;
+
+	(void)net_socket_service_unregister(&http_server_svc);
+	(void)k_work_cancel_delayable(&inactivity_work);
+
+	server_close_all();
+
+out:
+	k_mutex_unlock(&server_lock);
+
+	return ret;
+}
@@ -449,6 +449,8 @@ void lwm2m_engine_context_close(struct lwm2m_ctx *client_ctx)
 
 
 	client_ctx->connection_suspended = false;
+	client_ctx->notify_sent = 0;
+	client_ctx->notify_merged = 0;
 #if defined(CONFIG_LWM2M_QUEUE_MODE_ENABLED)
 	client_ctx->buffer_client_messages = true;
 #endif
@@ -458,7 +460,10 @@ void lwm2m_engine_context_init(struct lwm2m_ctx *client_ctx)
 {
 	sys_slist_init(&client_ctx->pending_sends);
 	sys_slist_init(&client_ctx->observer);
+	engine_observe_index_invalidate();
 	client_ctx->connection_suspended = false;
+	client_ctx->notify_sent = 0;
+	client_ctx->notify_merged = 0;
 #if defined(CONFIG_LWM2M_QUEUE_MODE_ENABLED)
 	client_ctx->buffer_client_messages = true;
 	sys_slist_init(&client_ctx->queued_messages);
@@ -3101,6 +3106,7 @@ msg_init:
 
 	obs->active_notify = msg;
 	obs->resource_update = false;
+	ctx->notify_sent++;
 	lwm2m_information_interface_send(msg);
 #if defined(CONFIG_LWM2M_RESOURCE_DATA_CACHE_SUPPORT)
 	msg->cache_info = NULL;
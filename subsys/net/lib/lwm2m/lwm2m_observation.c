@@ -334,11 +334,287 @@ int engine_observe_attribute_list_get(sys_slist_t *path_list, struct notificatio
 	return 0;
 }
 
-int lwm2m_notify_observer_path(const struct lwm2m_obj_path *path)
+static int engine_observe_notify_event(struct lwm2m_ctx *ctx, struct observe_node *obs,
+				       const struct lwm2m_obj_path *path)
 {
-	struct observe_node *obs;
 	struct notification_attrs nattrs = {0};
 	int64_t timestamp;
+	int ret;
+
+	/* update the event time for this observer */
+	ret = engine_observe_attribute_list_get(&obs->path_list, &nattrs, ctx->srv_obj_inst);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (obs->resource_update) {
+		/* A notification is already scheduled and will carry this change */
+		ctx->notify_merged++;
+	}
+
+	if (nattrs.pmin) {
+		timestamp = obs->last_timestamp + MSEC_PER_SEC * nattrs.pmin;
+	} else {
+		/* Trig immediately */
+		timestamp = k_uptime_get();
+	}
+
+#if CONFIG_LWM2M_ENGINE_NOTIFY_COALESCE_WINDOW > 0
+	/* Wait for further changes, but no longer than pmax allows */
+	int64_t deadline = k_uptime_get() + CONFIG_LWM2M_ENGINE_NOTIFY_COALESCE_WINDOW;
+
+	if (nattrs.pmax) {
+		deadline = MIN(deadline, obs->last_timestamp + MSEC_PER_SEC * nattrs.pmax);
+	}
+
+	timestamp = MAX(timestamp, deadline);
+#endif
+
+	if (!obs->event_timestamp || obs->event_timestamp > timestamp) {
+		obs->resource_update = true;
+		obs->event_timestamp = timestamp;
+	}
+
+	LOG_DBG("NOTIFY EVENT %u/%u/%u", path->obj_id, path->obj_inst_id, path->res_id);
+	lwm2m_engine_wake_up();
+
+	return 0;
+}
+
+#if defined(CONFIG_LWM2M_ENGINE_OBSERVER_INDEX)
+/*
+ * Prefix tree over the observed paths of all contexts. Depth n of the tree
+ * holds the n-th path component (object, object instance, resource and
+ * resource instance ID) and every observed path is attached to the node of
+ * its last component. Children are looked up through a hash on
+ * (parent, ID), since a single object may have hundreds of observed
+ * instances. Node 0 is the root.
+ */
+#define OBS_INDEX_NONE	  UINT16_MAX
+#define OBS_INDEX_NODES	  (LWM2M_ENGINE_MAX_OBSERVER_PATH * 4 + 1)
+#define OBS_INDEX_BUCKETS LWM2M_ENGINE_MAX_OBSERVER_PATH
+
+struct observe_index_node {
+	uint16_t parent;
+	uint16_t id;
+	uint16_t child;	    /* First child */
+	uint16_t sibling;   /* Next child of the same parent */
+	uint16_t hash_next; /* Next node in the same hash bucket */
+	uint16_t paths;	    /* First observed path ending at this node */
+};
+
+struct observe_index_path {
+	struct observe_node *obs;
+	struct lwm2m_ctx *ctx;
+	uint16_t next;
+};
+
+static struct observe_index_node obs_index_nodes[OBS_INDEX_NODES];
+static struct observe_index_path obs_index_paths[LWM2M_ENGINE_MAX_OBSERVER_PATH];
+static uint16_t obs_index_buckets[OBS_INDEX_BUCKETS];
+static uint16_t obs_index_node_count;
+static uint16_t obs_index_path_count;
+static bool obs_index_stale = true;
+static bool obs_index_overflow;
+
+static inline uint16_t *obs_index_bucket(uint16_t parent, uint16_t id)
+{
+	return &obs_index_buckets[((uint32_t)parent * 31U + id) % OBS_INDEX_BUCKETS];
+}
+
+static uint16_t obs_index_path_id(const struct lwm2m_obj_path *path, uint8_t depth)
+{
+	switch (depth) {
+	case LWM2M_PATH_LEVEL_OBJECT:
+		return path->obj_id;
+	case LWM2M_PATH_LEVEL_OBJECT_INST:
+		return path->obj_inst_id;
+	case LWM2M_PATH_LEVEL_RESOURCE:
+		return path->res_id;
+	default:
+		return path->res_inst_id;
+	}
+}
+
+/* Tree depth of an observed path, following lwm2m_observer_path_compare() */
+static uint8_t obs_index_depth(const struct lwm2m_obj_path *o_p)
+{
+	uint8_t depth = MAX(o_p->level, LWM2M_PATH_LEVEL_OBJECT);
+
+	if (!IS_ENABLED(CONFIG_LWM2M_VERSION_1_1)) {
+		depth = MIN(depth, LWM2M_PATH_LEVEL_RESOURCE);
+	}
+
+	return depth;
+}
+
+static uint16_t obs_index_find(uint16_t parent, uint16_t id)
+{
+	uint16_t n = *obs_index_bucket(parent, id);
+
+	while (n != OBS_INDEX_NONE &&
+	       (obs_index_nodes[n].parent != parent || obs_index_nodes[n].id != id)) {
+		n = obs_index_nodes[n].hash_next;
+	}
+
+	return n;
+}
+
+static uint16_t obs_index_find_or_add(uint16_t parent, uint16_t id)
+{
+	struct observe_index_node *node;
+	uint16_t *bucket;
+	uint16_t n;
+
+	n = obs_index_find(parent, id);
+	if (n != OBS_INDEX_NONE || obs_index_node_count >= OBS_INDEX_NODES) {
+		return n;
+	}
+
+	n = obs_index_node_count++;
+	bucket = obs_index_bucket(parent, id);
+	node = &obs_index_nodes[n];
+	node->parent = parent;
+	node->id = id;
+	node->child = OBS_INDEX_NONE;
+	node->paths = OBS_INDEX_NONE;
+	node->sibling = obs_index_nodes[parent].child;
+	obs_index_nodes[parent].child = n;
+	node->hash_next = *bucket;
+	*bucket = n;
+
+	return n;
+}
+
+static int obs_index_add(struct lwm2m_ctx *ctx, struct observe_node *obs,
+			 const struct lwm2m_obj_path *o_p)
+{
+	struct observe_index_path *entry;
+	uint8_t depth = obs_index_depth(o_p);
+	uint16_t n = 0;
+
+	if (obs_index_path_count >= ARRAY_SIZE(obs_index_paths)) {
+		return -ENOMEM;
+	}
+
+	for (uint8_t d = LWM2M_PATH_LEVEL_OBJECT; d <= depth; d++) {
+		n = obs_index_find_or_add(n, obs_index_path_id(o_p, d));
+		if (n == OBS_INDEX_NONE) {
+			return -ENOMEM;
+		}
+	}
+
+	entry = &obs_index_paths[obs_index_path_count];
+	entry->obs = obs;
+	entry->ctx = ctx;
+	entry->next = obs_index_nodes[n].paths;
+	obs_index_nodes[n].paths = obs_index_path_count++;
+
+	return 0;
+}
+
+static void obs_index_rebuild(void)
+{
+	struct lwm2m_ctx **sock_ctx = lwm2m_sock_ctx();
+	struct lwm2m_obj_path_list *o_p;
+	struct observe_node *obs;
+
+	(void)memset(obs_index_buckets, 0xff, sizeof(obs_index_buckets));
+	obs_index_nodes[0].child = OBS_INDEX_NONE;
+	obs_index_nodes[0].paths = OBS_INDEX_NONE;
+	obs_index_node_count = 1;
+	obs_index_path_count = 0;
+	obs_index_overflow = false;
+	obs_index_stale = false;
+
+	for (int i = 0; i < lwm2m_sock_nfds(); ++i) {
+		SYS_SLIST_FOR_EACH_CONTAINER(&sock_ctx[i]->observer, obs, node) {
+			SYS_SLIST_FOR_EACH_CONTAINER(&obs->path_list, o_p, node) {
+				if (obs_index_add(sock_ctx[i], obs, &o_p->path) < 0) {
+					LOG_WRN("Observer index full, using linear lookup");
+					obs_index_overflow = true;
+					return;
+				}
+			}
+		}
+	}
+}
+
+static void obs_index_mark(uint16_t n, bool subtree, uint32_t *matched)
+{
+	uint16_t i;
+
+	for (i = obs_index_nodes[n].paths; i != OBS_INDEX_NONE; i = obs_index_paths[i].next) {
+		matched[i / 32U] |= BIT(i % 32U);
+	}
+
+	if (!subtree) {
+		return;
+	}
+
+	/* Bounded by the path depth, at most three levels of recursion */
+	for (i = obs_index_nodes[n].child; i != OBS_INDEX_NONE; i = obs_index_nodes[i].sibling) {
+		obs_index_mark(i, true, matched);
+	}
+}
+
+static int obs_index_notify(const struct lwm2m_obj_path *path)
+{
+	uint32_t matched[DIV_ROUND_UP(LWM2M_ENGINE_MAX_OBSERVER_PATH, 32)] = {0};
+	struct observe_index_path *entry;
+	uint16_t n = 0;
+	uint16_t i, j;
+	int ret = 0;
+
+	/*
+	 * Observed paths which are a prefix of the changed path sit on the way
+	 * down, paths below the changed path in the subtree of its last node.
+	 */
+	for (uint8_t d = LWM2M_PATH_LEVEL_OBJECT; d <= path->level; d++) {
+		n = obs_index_find(n, obs_index_path_id(path, d));
+		if (n == OBS_INDEX_NONE) {
+			break;
+		}
+
+		obs_index_mark(n, d == path->level, matched);
+	}
+
+	/* Path entries were added in context and observer list order */
+	for (i = 0; i < obs_index_path_count; i++) {
+		if (!(matched[i / 32U] & BIT(i % 32U))) {
+			continue;
+		}
+
+		entry = &obs_index_paths[i];
+
+		/* Composite observers may match on more than one path */
+		for (j = i + 1; j < obs_index_path_count; j++) {
+			if (obs_index_paths[j].obs == entry->obs) {
+				matched[j / 32U] &= ~BIT(j % 32U);
+			}
+		}
+
+		ret = engine_observe_notify_event(entry->ctx, entry->obs, path);
+		if (ret < 0) {
+			return ret;
+		}
+		ret++;
+	}
+
+	return ret;
+}
+#endif /* CONFIG_LWM2M_ENGINE_OBSERVER_INDEX */
+
+void engine_observe_index_invalidate(void)
+{
+#if defined(CONFIG_LWM2M_ENGINE_OBSERVER_INDEX)
+	obs_index_stale = true;
+#endif
+}
+
+int lwm2m_notify_observer_path(const struct lwm2m_obj_path *path)
+{
+	struct observe_node *obs;
 	int ret = 0;
 	int i;
 	struct lwm2m_ctx **sock_ctx = lwm2m_sock_ctx();
@@ -347,34 +623,29 @@ int lwm2m_notify_observer_path(const struct lwm2m_obj_path *path)
 		return 0;
 	}
 
+#if defined(CONFIG_LWM2M_ENGINE_OBSERVER_INDEX)
+	lwm2m_registry_lock();
+	if (obs_index_stale) {
+		obs_index_rebuild();
+	}
+
+	if (!obs_index_overflow) {
+		ret = obs_index_notify(path);
+		lwm2m_registry_unlock();
+		return ret;
+	}
+	lwm2m_registry_unlock();
+#endif
+
 	/* look for observers which match our resource */
 	for (i = 0; i < lwm2m_sock_nfds(); ++i) {
 		SYS_SLIST_FOR_EACH_CONTAINER(&sock_ctx[i]->observer, obs, node) {
 			if (lwm2m_notify_observer_list(&obs->path_list, path)) {
-				/* update the event time for this observer */
-				ret = engine_observe_attribute_list_get(&obs->path_list, &nattrs,
-									sock_ctx[i]->srv_obj_inst);
+				ret = engine_observe_notify_event(sock_ctx[i], obs, path);
 				if (ret < 0) {
 					return ret;
 				}
-
-				if (nattrs.pmin) {
-					timestamp =
-						obs->last_timestamp + MSEC_PER_SEC * nattrs.pmin;
-				} else {
-					/* Trig immediately */
-					timestamp = k_uptime_get();
-				}
-
-				if (!obs->event_timestamp || obs->event_timestamp > timestamp) {
-					obs->resource_update = true;
-					obs->event_timestamp = timestamp;
-				}
-
-				LOG_DBG("NOTIFY EVENT %u/%u/%u", path->obj_id, path->obj_inst_id,
-					path->res_id);
 				ret++;
-				lwm2m_engine_wake_up();
 			}
 		}
 	}
@@ -443,6 +714,7 @@ static void engine_observe_node_init(struct observe_node *obs, const uint8_t *to
 	obs->format = format;
 	obs->counter = OBSERVE_COUNTER_START;
 	sys_slist_append(&ctx->observer, &obs->node);
+	engine_observe_index_invalidate();
 
 	SYS_SLIST_FOR_EACH_CONTAINER(&obs->path_list, tmp, node) {
 		LOG_DBG("OBSERVER ADDED %u/%u/%u/%u(%u)", tmp->path.obj_id, tmp->path.obj_inst_id,
@@ -469,6 +741,7 @@ static void remove_observer_path_from_list(struct lwm2m_ctx *ctx, struct observe
 	/* Remove from the list and add to free list */
 	sys_slist_remove(&obs->path_list, prev_node, &o_p->node);
 	sys_slist_append(&obs_obj_path_list, &o_p->node);
+	engine_observe_index_invalidate();
 }
 
 static void engine_observe_single_path_id_remove(struct lwm2m_ctx *ctx, struct observe_node *obs,
@@ -721,6 +994,7 @@ void remove_observer_from_list(struct lwm2m_ctx *ctx, sys_snode_t *prev_node,
 	}
 	sys_slist_remove(&ctx->observer, prev_node, &obs->node);
 	(void)memset(obs, 0, sizeof(*obs));
+	engine_observe_index_invalidate();
 }
 
 int engine_remove_observer_by_token(struct lwm2m_ctx *ctx, const uint8_t *token, uint8_t tkl)
@@ -1472,6 +1746,41 @@ int64_t engine_observe_shedule_next_event(struct observe_node *obs, uint16_t srv
 	return t_s;
 }
 
+int engine_observe_coalesce(struct lwm2m_ctx *ctx, const int64_t timestamp)
+{
+	int count = 0;
+#if CONFIG_LWM2M_ENGINE_NOTIFY_COALESCE_WINDOW > 0
+	struct notification_attrs nattrs;
+	struct observe_node *obs;
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&ctx->observer, obs, node) {
+		if (!obs->event_timestamp || obs->event_timestamp <= timestamp ||
+		    obs->event_timestamp > timestamp + CONFIG_LWM2M_ENGINE_NOTIFY_COALESCE_WINDOW ||
+		    obs->active_notify != NULL) {
+			continue;
+		}
+
+		if (engine_observe_attribute_list_get(&obs->path_list, &nattrs,
+						      ctx->srv_obj_inst) < 0) {
+			continue;
+		}
+
+		/* Sending early is fine as long as pmin has elapsed */
+		if (obs->last_timestamp + MSEC_PER_SEC * nattrs.pmin > timestamp) {
+			continue;
+		}
+
+		obs->event_timestamp = timestamp;
+		count++;
+	}
+#else
+	ARG_UNUSED(ctx);
+	ARG_UNUSED(timestamp);
+#endif
+
+	return count;
+}
+
 struct lwm2m_obj_path_list *lwm2m_engine_get_from_list(sys_slist_t *path_list)
 {
 	sys_snode_t *path_node = sys_slist_get(path_list);
@@ -12,6 +12,12 @@ int lwm2m_notify_observer_path(const struct lwm2m_obj_path *path);
 
 #define MAX_TOKEN_LEN 8
 
+#ifdef CONFIG_LWM2M_VERSION_1_1
+#define LWM2M_ENGINE_MAX_OBSERVER_PATH CONFIG_LWM2M_ENGINE_MAX_OBSERVER * 3
+#else
+#define LWM2M_ENGINE_MAX_OBSERVER_PATH CONFIG_LWM2M_ENGINE_MAX_OBSERVER
+#endif
+
 struct observe_node {
 	sys_snode_t node;
 	sys_slist_t path_list;               /* List of Observation path */
@@ -35,6 +41,20 @@ void clear_attrs(void *ref);
 int64_t engine_observe_shedule_next_event(struct observe_node *obs, uint16_t srv_obj_inst,
 					  const int64_t timestamp);
 
+/**
+ * Bring forward the notifications due within the coalescing window
+ *
+ * Called after a notification is generated for @p ctx, so that the
+ * notifications of its other observations which are due within
+ * @kconfig{CONFIG_LWM2M_ENGINE_NOTIFY_COALESCE_WINDOW} and whose pmin
+ * has elapsed are sent right after it.
+ *
+ * @param ctx LwM2M context the notification was generated for
+ * @param timestamp Current uptime in milliseconds
+ * @return Number of notifications brought forward
+ */
+int engine_observe_coalesce(struct lwm2m_ctx *ctx, const int64_t timestamp);
+
 void remove_observer_from_list(struct lwm2m_ctx *ctx, sys_snode_t *prev_node,
 			       struct observe_node *obs);
 
@@ -52,6 +72,15 @@ int lwm2m_engine_observation_handler(struct lwm2m_message *msg, int observe, uin
 
 void engine_remove_observer_by_id(uint16_t obj_id, int32_t obj_inst_id);
 
+/**
+ * Mark the observed path index stale
+ *
+ * Must be called whenever an observer list of a context, or the set of
+ * contexts returned by lwm2m_sock_ctx(), changes outside of the
+ * observation module.
+ */
+void engine_observe_index_invalidate(void);
+
 /* path object list */
 struct lwm2m_obj_path_list {
 	sys_snode_t node;
@@ -146,31 +146,13 @@ static int client_write(struct mqtt_client *client, const uint8_t *data,
 	return 0;
 }
 
-static int client_write_msg(struct mqtt_client *client,
-			    const struct msghdr *message)
-{
-	int err_code;
-
-	NET_DBG("[%p]: Transport writing message.", client);
-
-	err_code = mqtt_transport_write_msg(client, message);
-	if (err_code < 0) {
-		NET_ERR("Transport write failed, err_code = %d, "
-			 "closing connection", err_code);
-		client_disconnect(client, err_code, true);
-		return err_code;
-	}
-
-	NET_DBG("[%p]: Transport write complete.", client);
-	client->internal.last_activity = mqtt_sys_tick_in_ms_get();
-
-	return 0;
-}
-
 void mqtt_client_init(struct mqtt_client *client)
 {
 	NULL_PARAM_CHECK_VOID(client);
 
+	/* This also empties the in-flight window, messages not acknowledged
+	 * yet are forgotten.
+	 */
 	memset(client, 0, sizeof(*client));
 
 	MQTT_STATE_INIT(client);
@@ -236,47 +218,345 @@ static int verify_tx_state(const struct mqtt_client *client)
 	return 0;
 }
 
-int mqtt_publish(struct mqtt_client *client,
-		 const struct mqtt_publish_param *param)
+/** @brief Publish messages encoded back to back for a single transport write. */
+struct publish_batch {
+	struct buf_ctx packet;
+	struct iovec iov[2 * CONFIG_MQTT_PUBLISH_BATCH_SIZE];
+	size_t iovcnt;
+};
+
+static void publish_batch_init(struct mqtt_client *client,
+			       struct publish_batch *batch)
 {
+	tx_buf_init(client, &batch->packet);
+	batch->iovcnt = 0;
+}
+
+static int publish_batch_add(struct publish_batch *batch,
+			     const struct mqtt_publish_param *param)
+{
+	struct buf_ctx packet = batch->packet;
 	int err_code;
-	struct buf_ctx packet;
-	struct iovec io_vector[2];
+
+	if (batch->iovcnt > ARRAY_SIZE(batch->iov) - 2) {
+		return -ENOMEM;
+	}
+
+	err_code = publish_encode(param, &packet);
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	batch->iov[batch->iovcnt].iov_base = packet.cur;
+	batch->iov[batch->iovcnt].iov_len = packet.end - packet.cur;
+	batch->iovcnt++;
+
+	if (param->message.payload.len > 0) {
+		batch->iov[batch->iovcnt].iov_base = param->message.payload.data;
+		batch->iov[batch->iovcnt].iov_len = param->message.payload.len;
+		batch->iovcnt++;
+	}
+
+	/* Next packet is encoded right after this one's header. */
+	batch->packet.cur = packet.end;
+
+	return 0;
+}
+
+static int publish_batch_flush(struct mqtt_client *client,
+			       struct publish_batch *batch)
+{
 	struct msghdr msg;
+	int err_code;
+
+	if (batch->iovcnt == 0) {
+		return 0;
+	}
+
+	memset(&msg, 0, sizeof(msg));
+
+	msg.msg_iov = batch->iov;
+	msg.msg_iovlen = batch->iovcnt;
+
+	NET_DBG("[%p]: Transport writing %zu publish vectors.", client,
+		batch->iovcnt);
+
+	err_code = mqtt_transport_write_msg(client, &msg);
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	client->internal.last_activity = mqtt_sys_tick_in_ms_get();
+
+	publish_batch_init(client, batch);
+
+	return 0;
+}
+
+#if CONFIG_MQTT_INFLIGHT_WINDOW > 0
+static struct mqtt_inflight *inflight_find(struct mqtt_client *client,
+					   uint16_t message_id)
+{
+	for (int i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		if (client->internal.inflight[i].param.message_id == message_id) {
+			return &client->internal.inflight[i];
+		}
+	}
+
+	return NULL;
+}
+
+static uint16_t inflight_next_id(struct mqtt_client *client)
+{
+	uint16_t message_id = client->internal.last_message_id;
+
+	do {
+		message_id++;
+	} while ((message_id == 0U) || (inflight_find(client, message_id) != NULL));
+
+	client->internal.last_message_id = message_id;
+
+	return message_id;
+}
+
+/* Track a QoS 1/2 message, @p encode is set to the parameters to send. */
+static int inflight_add(struct mqtt_client *client,
+			const struct mqtt_publish_param *param,
+			const struct mqtt_publish_param **encode)
+{
+	struct mqtt_inflight *entry = NULL;
+
+	*encode = param;
+
+	if (param->message.topic.qos == MQTT_QOS_0_AT_MOST_ONCE) {
+		return 0;
+	}
+
+	/* An application retransmission reuses the entry of the message. */
+	if (param->message_id != 0U) {
+		entry = inflight_find(client, param->message_id);
+	}
+
+	if (entry == NULL) {
+		entry = inflight_find(client, 0U);
+		if (entry == NULL) {
+			return -EBUSY;
+		}
+	}
+
+	entry->param = *param;
+	entry->released = false;
+
+	if (entry->param.message_id == 0U) {
+		entry->param.message_id = inflight_next_id(client);
+	}
+
+	*encode = &entry->param;
+
+	return 0;
+}
+
+static void inflight_drop(struct mqtt_client *client,
+			  const struct mqtt_publish_param *param)
+{
+	struct mqtt_inflight *entry;
+
+	if ((param->message.topic.qos == MQTT_QOS_0_AT_MOST_ONCE) ||
+	    (param->message_id == 0U)) {
+		return;
+	}
+
+	entry = inflight_find(client, param->message_id);
+	if (entry != NULL) {
+		memset(entry, 0, sizeof(*entry));
+	}
+}
+
+void mqtt_inflight_ack(struct mqtt_client *client, uint8_t type,
+		       uint16_t message_id)
+{
+	struct mqtt_inflight *entry;
+
+	if (message_id == 0U) {
+		return;
+	}
+
+	entry = inflight_find(client, message_id);
+	if (entry == NULL) {
+		return;
+	}
+
+	if (type == MQTT_PKT_TYPE_PUBREC) {
+		entry->released = true;
+	} else {
+		memset(entry, 0, sizeof(*entry));
+	}
+}
+
+static int inflight_batch_add(struct publish_batch *batch,
+			      struct mqtt_inflight *entry)
+{
+	struct mqtt_pubrel_param pubrel;
+	struct buf_ctx packet = batch->packet;
+	int err_code;
+
+	if (!entry->released) {
+		return publish_batch_add(batch, &entry->param);
+	}
+
+	if (batch->iovcnt == ARRAY_SIZE(batch->iov)) {
+		return -ENOMEM;
+	}
+
+	pubrel.message_id = entry->param.message_id;
+
+	err_code = publish_release_encode(&pubrel, &packet);
+	if (err_code < 0) {
+		return err_code;
+	}
+
+	batch->iov[batch->iovcnt].iov_base = packet.cur;
+	batch->iov[batch->iovcnt].iov_len = packet.end - packet.cur;
+	batch->iovcnt++;
+	batch->packet.cur = packet.end;
+
+	return 0;
+}
+
+int mqtt_inflight_resend(struct mqtt_client *client, bool session_present)
+{
+	struct publish_batch batch;
+	struct mqtt_inflight *entry;
+	int err_code;
+
+	publish_batch_init(client, &batch);
+
+	for (int i = 0; i < ARRAY_SIZE(client->internal.inflight); i++) {
+		entry = &client->internal.inflight[i];
+
+		if (entry->param.message_id == 0U) {
+			continue;
+		}
+
+		if (!session_present) {
+			/* The broker took ownership of a released message,
+			 * without a session there is nothing left to complete.
+			 */
+			if (entry->released) {
+				NET_WARN("[CID %p]: Session lost, dropping message id 0x%04x",
+					 client, entry->param.message_id);
+				memset(entry, 0, sizeof(*entry));
+				continue;
+			}
+
+			/* Published anew in the new session. */
+			entry->param.dup_flag = 0U;
+		} else {
+			entry->param.dup_flag = 1U;
+		}
+
+		NET_DBG("[CID %p]: Resending message id 0x%04x", client,
+			entry->param.message_id);
+
+		err_code = inflight_batch_add(&batch, entry);
+		if ((err_code == -ENOMEM) && (batch.iovcnt > 0)) {
+			err_code = publish_batch_flush(client, &batch);
+			if (err_code == 0) {
+				err_code = inflight_batch_add(&batch, entry);
+			}
+		}
+
+		if (err_code < 0) {
+			return err_code;
+		}
+	}
+
+	return publish_batch_flush(client, &batch);
+}
+#else
+static int inflight_add(struct mqtt_client *client,
+			const struct mqtt_publish_param *param,
+			const struct mqtt_publish_param **encode)
+{
+	ARG_UNUSED(client);
+
+	*encode = param;
+
+	return 0;
+}
+
+static void inflight_drop(struct mqtt_client *client,
+			  const struct mqtt_publish_param *param)
+{
+	ARG_UNUSED(client);
+	ARG_UNUSED(param);
+}
+#endif /* CONFIG_MQTT_INFLIGHT_WINDOW > 0 */
+
+int mqtt_publish_batch(struct mqtt_client *client,
+		       struct mqtt_publish_param *param, size_t count)
+{
+	int err_code;
+	int encode_err = 0;
+	size_t published = 0;
+	struct publish_batch batch;
+	const struct mqtt_publish_param *encode;
 
 	NULL_PARAM_CHECK(client);
 	NULL_PARAM_CHECK(param);
 
-	NET_DBG("[CID %p]:[State 0x%02x]: >> Topic size 0x%08x, "
-		 "Data size 0x%08x", client, client->internal.state,
-		 param->message.topic.topic.size,
-		 param->message.payload.len);
+	NET_DBG("[CID %p]:[State 0x%02x]: >> Message count %zu",
+		 client, client->internal.state, count);
 
 	mqtt_mutex_lock(client);
 
-	tx_buf_init(client, &packet);
-
 	err_code = verify_tx_state(client);
 	if (err_code < 0) {
 		goto error;
 	}
 
-	err_code = publish_encode(param, &packet);
-	if (err_code < 0) {
-		goto error;
-	}
+	publish_batch_init(client, &batch);
 
-	io_vector[0].iov_base = packet.cur;
-	io_vector[0].iov_len = packet.end - packet.cur;
-	io_vector[1].iov_base = param->message.payload.data;
-	io_vector[1].iov_len = param->message.payload.len;
+	for (; published < count; published++) {
+		encode_err = inflight_add(client, &param[published], &encode);
+		if (encode_err < 0) {
+			break;
+		}
 
-	memset(&msg, 0, sizeof(msg));
+		encode_err = publish_batch_add(&batch, encode);
+		if ((encode_err == -ENOMEM) && (batch.iovcnt > 0)) {
+			/* Transmit buffer or vectors exhausted, send what is
+			 * encoded so far and start over.
+			 */
+			err_code = publish_batch_flush(client, &batch);
+			if (err_code < 0) {
+				goto write_error;
+			}
+
+			encode_err = publish_batch_add(&batch, encode);
+		}
+
+		if (encode_err < 0) {
+			inflight_drop(client, encode);
+			break;
+		}
+
+		/* Let the application match the acknowledgment to the message */
+		param[published].message_id = encode->message_id;
+	}
+
+	err_code = publish_batch_flush(client, &batch);
 
-	msg.msg_iov = io_vector;
-	msg.msg_iovlen = ARRAY_SIZE(io_vector);
+write_error:
+	if (err_code < 0) {
+		/* Tracked QoS 1/2 messages are sent again on reconnection. */
+		NET_ERR("Transport write failed, err_code = %d, "
+			 "closing connection", err_code);
+		client_disconnect(client, err_code, true);
+		goto error;
+	}
 
-	err_code = client_write_msg(client, &msg);
+	err_code = (published > 0) ? published : encode_err;
 
 error:
 	NET_DBG("[CID %p]:[State 0x%02x]: << result 0x%08x",
@@ -287,6 +567,20 @@ error:
 	return err_code;
 }
 
+int mqtt_publish(struct mqtt_client *client,
+		 const struct mqtt_publish_param *param)
+{
+	struct mqtt_publish_param copy;
+	int err_code;
+
+	NULL_PARAM_CHECK(param);
+
+	copy = *param;
+	err_code = mqtt_publish_batch(client, &copy, 1);
+
+	return (err_code < 0) ? err_code : 0;
+}
+
 int mqtt_publish_qos1_ack(struct mqtt_client *client,
 			  const struct mqtt_puback_param *param)
 {
@@ -162,6 +162,43 @@ void event_notify(struct mqtt_client *client, const struct mqtt_evt *evt);
  */
 int mqtt_handle_rx(struct mqtt_client *client);
 
+#if CONFIG_MQTT_INFLIGHT_WINDOW > 0
+/**@brief Updates the in-flight window on a PUBACK, PUBREC or PUBCOMP.
+ *
+ * @param[in] client Identifies the client for which the ack was received.
+ * @param[in] type Packet type of the acknowledgment.
+ * @param[in] message_id Message id of the acknowledgment.
+ */
+void mqtt_inflight_ack(struct mqtt_client *client, uint8_t type,
+		       uint16_t message_id);
+
+/**@brief Retransmits the in-flight window after a connection was accepted.
+ *
+ * @param[in] client Identifies the client which was connected.
+ * @param[in] session_present Broker resumed the previous session.
+ *
+ * @return 0 if the procedure is successful, an error code otherwise.
+ */
+int mqtt_inflight_resend(struct mqtt_client *client, bool session_present);
+#else
+static inline void mqtt_inflight_ack(struct mqtt_client *client, uint8_t type,
+				     uint16_t message_id)
+{
+	ARG_UNUSED(client);
+	ARG_UNUSED(type);
+	ARG_UNUSED(message_id);
+}
+
+static inline int mqtt_inflight_resend(struct mqtt_client *client,
+				       bool session_present)
+{
+	ARG_UNUSED(client);
+	ARG_UNUSED(session_present);
+
+	return 0;
+}
+#endif /* CONFIG_MQTT_INFLIGHT_WINDOW > 0 */
+
 /**@brief Constructs/encodes Connect packet.
  *
  * @param[in] client Identifies the client for which the procedure is requested.
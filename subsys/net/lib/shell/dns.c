@@ -200,6 +200,31 @@ static int cmd_net_dns_query(const struct shell *sh, size_t argc, char *argv[])
 	return 0;
 }
 
+static int cmd_net_dns_stats(const struct shell *sh, size_t argc, char *argv[])
+{
+#if defined(CONFIG_DNS_RESOLVER)
+	struct dns_resolve_stats stats;
+#endif
+
+	ARG_UNUSED(argc);
+	ARG_UNUSED(argv);
+
+#if defined(CONFIG_DNS_RESOLVER)
+	dns_resolve_get_stats(&stats);
+
+	PR("Cache hits          : %u\n", stats.cache_hit);
+	PR("Cache misses        : %u\n", stats.cache_miss);
+	PR("Negative cache hits : %u\n", stats.cache_negative_hit);
+	PR("Cache refreshes     : %u\n", stats.cache_prefetch);
+	PR("Coalesced queries   : %u\n", stats.coalesced);
+#else
+	PR_INFO("Set %s to enable %s support.\n", "CONFIG_DNS_RESOLVER",
+		"DNS resolver");
+#endif
+
+	return 0;
+}
+
 static int cmd_net_dns(const struct shell *sh, size_t argc, char *argv[])
 {
 #if defined(CONFIG_DNS_RESOLVER)
@@ -236,6 +261,8 @@ SHELL_STATIC_SUBCMD_SET_CREATE(net_cmd_dns,
 		  "'net dns <hostname> [A or AAAA]' queries IPv4 address "
 		  "(default) or IPv6 address for a host name.",
 		  cmd_net_dns_query),
+	SHELL_CMD(stats, NULL, "Show DNS cache and query statistics.",
+		  cmd_net_dns_stats),
 	SHELL_SUBCMD_SET_END
 );
 
@@ -507,6 +507,12 @@ static void net_shell_print_statistics(struct net_if *iface, void *user_data)
 	   GET_STAT(iface, ipv4_igmp.sent),
 	   GET_STAT(iface, ipv4_igmp.drop));
 #endif /* CONFIG_NET_STATISTICS_IGMP */
+#if defined(CONFIG_NET_STATISTICS_TX_FQ)
+	PR("TX flow queue  %d\tdrop\t%d\n",
+	   GET_STAT(iface, tx_fq.queued),
+	   GET_STAT(iface, tx_fq.drop));
+#endif /* CONFIG_NET_STATISTICS_TX_FQ */
+
 #if defined(CONFIG_NET_STATISTICS_UDP) && defined(CONFIG_NET_NATIVE_UDP)
 	PR("UDP recv       %d\tsent\t%d\tdrop\t%d\n",
 	   GET_STAT(iface, udp.recv),
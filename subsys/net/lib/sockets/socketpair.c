@@ -22,6 +22,32 @@ enum {
 	SPAIR_FLAG_NONBLOCK = (1 << 0), /**< socket is non-blocking */
 };
 
+#ifdef CONFIG_NET_SOCKETPAIR_SPSC
+enum {
+	SPAIR_RX_IDLE,    /**< no reader is blocked on @ref spair.recv_q */
+	SPAIR_RX_CLAIMED, /**< a reader is publishing its buffer */
+	SPAIR_RX_WAITING, /**< a reader published its buffer and is blocked */
+	SPAIR_RX_BUSY,    /**< a writer is copying into the reader's buffer */
+	SPAIR_RX_DONE,    /**< the reader's buffer has been filled */
+};
+
+#define SPAIR_RING_SIZE CONFIG_NET_SOCKETPAIR_BUFFER_SIZE
+/* Indices run over twice the ring size so a full ring differs from an empty one */
+#define SPAIR_RING_WRAP (2 * SPAIR_RING_SIZE)
+
+/**
+ * Single-producer, single-consumer receive queue
+ *
+ * @a head is only advanced by the writer of the remote endpoint and @a tail
+ * only by the reader of the local endpoint, so neither side needs a lock
+ * to move data through the queue.
+ */
+struct spair_ring {
+	atomic_t head; /**< next index to write */
+	atomic_t tail; /**< next index to read */
+};
+#endif /* CONFIG_NET_SOCKETPAIR_SPSC */
+
 #define SPAIR_FLAGS_DEFAULT 0
 
 /**
@@ -42,12 +68,32 @@ enum {
  * - read operations may block if the local @a recv_q is empty
  * - write operations may block if the remote @a recv_q is full
  * - each endpoint may be blocking or non-blocking
+ *
+ * With @kconfig{CONFIG_NET_SOCKETPAIR_SPSC}, @a recv_q is a lock-free ring:
+ * - a writer only holds its local @a sem; the remote @a sem is not taken
+ * - @a readable and @a writeable are only raised when @a recv_q goes from
+ *   empty to non-empty and from full to non-full, respectively
+ * - a reader blocked on an empty @a recv_q publishes its buffer, and the
+ *   next write copies directly into it, bypassing @a recv_q entirely. Only
+ *   one reader at a time can publish its buffer, further readers wait for
+ *   @a recv_q. The writer gives @a rx_sem once the buffer is filled, as
+ *   @a readable may be reset by other readers or poll() meanwhile.
  */
 __net_socket struct spair {
 	int remote; /**< the remote endpoint file descriptor */
 	uint32_t flags; /**< status and option bits */
 	struct k_sem sem; /**< semaphore for exclusive structure access */
+#ifdef CONFIG_NET_SOCKETPAIR_SPSC
+	struct spair_ring recv_q; /**< receive queue of local endpoint */
+	atomic_t closing; /**< set once the local endpoint is being closed */
+	atomic_t rx_state; /**< state of the direct reader handoff */
+	void *rx_buf; /**< buffer of the blocked reader */
+	size_t rx_len; /**< size of @a rx_buf */
+	size_t rx_done; /**< bytes copied into @a rx_buf by the writer */
+	struct k_sem rx_sem; /**< given when @a rx_buf has been filled */
+#else
 	struct k_pipe recv_q; /**< receive queue of local endpoint */
+#endif
 	/** indicates local @a recv_q isn't empty */
 	struct k_poll_signal readable;
 	/** indicates local @a recv_q isn't full */
@@ -91,6 +137,80 @@ static inline bool sock_is_eof(const struct spair *spair)
 	return !sock_is_connected(spair);
 }
 
+#ifdef CONFIG_NET_SOCKETPAIR_SPSC
+static inline size_t spair_ring_advance(size_t idx, size_t n)
+{
+	idx += n;
+
+	return (idx >= SPAIR_RING_WRAP) ? idx - SPAIR_RING_WRAP : idx;
+}
+
+static inline size_t spair_ring_offset(size_t idx)
+{
+	return (idx >= SPAIR_RING_SIZE) ? idx - SPAIR_RING_SIZE : idx;
+}
+
+/** Number of bytes queued in the @ref spair.recv_q of @p spair */
+static inline size_t spair_ring_used(struct spair *spair)
+{
+	size_t head = (size_t)atomic_get(&spair->recv_q.head);
+	size_t tail = (size_t)atomic_get(&spair->recv_q.tail);
+
+	return (head >= tail) ? head - tail : head + SPAIR_RING_WRAP - tail;
+}
+
+/**
+ * Append up to @p count bytes to the @ref spair.recv_q of @p spair
+ *
+ * Must only be called by the (single) writer of the remote endpoint.
+ *
+ * @return the number of bytes queued
+ */
+static size_t spair_ring_put(struct spair *spair, const uint8_t *data,
+			     size_t count)
+{
+	size_t head = (size_t)atomic_get(&spair->recv_q.head);
+	size_t off = spair_ring_offset(head);
+	size_t chunk;
+
+	count = MIN(count, SPAIR_RING_SIZE - spair_ring_used(spair));
+	chunk = MIN(count, SPAIR_RING_SIZE - off);
+
+	memcpy(&spair->buf[off], data, chunk);
+	memcpy(spair->buf, data + chunk, count - chunk);
+
+	/* publish the data to the reader */
+	atomic_set(&spair->recv_q.head, spair_ring_advance(head, count));
+
+	return count;
+}
+
+/**
+ * Remove up to @p count bytes from the @ref spair.recv_q of @p spair
+ *
+ * Must only be called by the (single) reader of the local endpoint.
+ *
+ * @return the number of bytes dequeued
+ */
+static size_t spair_ring_get(struct spair *spair, uint8_t *data, size_t count)
+{
+	size_t tail = (size_t)atomic_get(&spair->recv_q.tail);
+	size_t off = spair_ring_offset(tail);
+	size_t chunk;
+
+	count = MIN(count, spair_ring_used(spair));
+	chunk = MIN(count, SPAIR_RING_SIZE - off);
+
+	memcpy(data, &spair->buf[off], chunk);
+	memcpy(data + chunk, spair->buf, count - chunk);
+
+	/* hand the space back to the writer */
+	atomic_set(&spair->recv_q.tail, spair_ring_advance(tail, count));
+
+	return count;
+}
+#endif /* CONFIG_NET_SOCKETPAIR_SPSC */
+
 /**
  * Determine bytes available to write
  *
@@ -106,7 +226,11 @@ static inline size_t spair_write_avail(struct spair *spair)
 		return 0;
 	}
 
+#ifdef CONFIG_NET_SOCKETPAIR_SPSC
+	return SPAIR_RING_SIZE - spair_ring_used(remote);
+#else
 	return k_pipe_write_avail(&remote->recv_q);
+#endif
 }
 
 /**
@@ -117,7 +241,11 @@ static inline size_t spair_write_avail(struct spair *spair)
  */
 static inline size_t spair_read_avail(struct spair *spair)
 {
+#ifdef CONFIG_NET_SOCKETPAIR_SPSC
+	return spair_ring_used(spair);
+#else
 	return k_pipe_read_avail(&spair->recv_q);
+#endif
 }
 
 /** Swap two 32-bit integers */
@@ -168,6 +296,15 @@ static void spair_delete(struct spair *spair)
 		return;
 	}
 
+#ifdef CONFIG_NET_SOCKETPAIR_SPSC
+	/* Writers of the remote endpoint block on our writeable signal while
+	 * holding the remote sem, so cancel them before taking that sem.
+	 */
+	atomic_set(&spair->closing, true);
+	res = k_poll_signal_raise(&spair->writeable, SPAIR_SIG_CANCEL);
+	__ASSERT(res == 0, "k_poll_signal_raise() failed: %d", res);
+#endif
+
 	if (spair->remote != -1) {
 		remote = z_get_fd_obj(spair->remote,
 			(const struct fd_op_vtable *)&spair_fd_op_vtable, 0);
@@ -250,7 +387,11 @@ static struct spair *spair_new(void)
 	spair->flags = SPAIR_FLAGS_DEFAULT;
 
 	k_sem_init(&spair->sem, 1, 1);
+#ifdef CONFIG_NET_SOCKETPAIR_SPSC
+	k_sem_init(&spair->rx_sem, 0, 1);
+#else
 	k_pipe_init(&spair->recv_q, spair->buf, sizeof(spair->buf));
+#endif
 	k_poll_signal_init(&spair->readable);
 	k_poll_signal_init(&spair->writeable);
 
@@ -393,6 +534,131 @@ out:
  * @return on success, a number > 0 representing the number of bytes written
  * @return -1 on error, with @ref errno set appropriately.
  */
+#ifdef CONFIG_NET_SOCKETPAIR_SPSC
+static ssize_t spair_write(void *obj, const void *buffer, size_t count)
+{
+	int res;
+	bool is_nonblock;
+	size_t bytes_written;
+	bool have_local_sem = false;
+	struct spair *const spair = (struct spair *)obj;
+	struct spair *remote = NULL;
+
+	if (obj == NULL || buffer == NULL || count == 0) {
+		errno = EINVAL;
+		res = -1;
+		goto out;
+	}
+
+	res = k_sem_take(&spair->sem, K_NO_WAIT);
+	is_nonblock = sock_is_nonblock(spair);
+	if (res < 0) {
+		if (is_nonblock) {
+			errno = EAGAIN;
+			res = -1;
+			goto out;
+		}
+
+		res = k_sem_take(&spair->sem, K_FOREVER);
+		if (res < 0) {
+			errno = -res;
+			res = -1;
+			goto out;
+		}
+		is_nonblock = sock_is_nonblock(spair);
+	}
+
+	have_local_sem = true;
+
+	/* The local sem keeps the remote endpoint alive, as spair_delete()
+	 * takes it before freeing the remote, and it serializes every producer
+	 * of the remote recv_q. The remote sem is therefore never needed here.
+	 */
+	remote = z_get_fd_obj(spair->remote,
+		(const struct fd_op_vtable *)&spair_fd_op_vtable, 0);
+
+	if (remote == NULL) {
+		errno = EPIPE;
+		res = -1;
+		goto out;
+	}
+
+	/* A blocked reader can only be waiting on an empty recv_q, so copying
+	 * straight into its buffer preserves ordering.
+	 */
+	if (spair_ring_used(remote) == 0 &&
+	    atomic_cas(&remote->rx_state, SPAIR_RX_WAITING, SPAIR_RX_BUSY)) {
+		bytes_written = MIN(count, remote->rx_len);
+		memcpy(remote->rx_buf, buffer, bytes_written);
+		remote->rx_done = bytes_written;
+		atomic_set(&remote->rx_state, SPAIR_RX_DONE);
+		k_sem_give(&remote->rx_sem);
+
+		res = k_poll_signal_raise(&remote->readable, SPAIR_SIG_DATA);
+		__ASSERT(res == 0, "k_poll_signal_raise() failed: %d", res);
+
+		res = bytes_written;
+		goto out;
+	}
+
+	while (spair_ring_used(remote) == SPAIR_RING_SIZE) {
+		struct k_poll_event events[] = {
+			K_POLL_EVENT_INITIALIZER(
+				K_POLL_TYPE_SIGNAL,
+				K_POLL_MODE_NOTIFY_ONLY,
+				&remote->writeable),
+		};
+
+		if (is_nonblock || k_is_in_isr()) {
+			errno = EAGAIN;
+			res = -1;
+			goto out;
+		}
+
+		/* The reader only signals on a full -> non-full transition, so
+		 * look again after clearing the signal to not miss that edge.
+		 */
+		k_poll_signal_reset(&remote->writeable);
+
+		if (atomic_get(&remote->closing)) {
+			errno = EPIPE;
+			res = -1;
+			goto out;
+		}
+
+		if (spair_ring_used(remote) < SPAIR_RING_SIZE) {
+			break;
+		}
+
+		res = k_poll(events, ARRAY_SIZE(events), K_FOREVER);
+		if (res < 0) {
+			errno = -res;
+			res = -1;
+			goto out;
+		}
+	}
+
+	bytes_written = spair_ring_put(remote, buffer, count);
+
+	/* Only wake the reader if it had drained everything before this write;
+	 * otherwise it has not gone to sleep yet and will find the data itself.
+	 */
+	if (spair_ring_used(remote) <= bytes_written) {
+		res = k_poll_signal_raise(&remote->readable, SPAIR_SIG_DATA);
+		__ASSERT(res == 0, "k_poll_signal_raise() failed: %d", res);
+	}
+
+	res = bytes_written;
+
+out:
+
+	if (spair != NULL && have_local_sem) {
+		k_sem_give(&spair->sem);
+	}
+
+	return res;
+}
+#else
 static ssize_t spair_write(void *obj, const void *buffer, size_t count)
 {
 	int res;
@@ -568,6 +834,7 @@ out:
 
 	return res;
 }
+#endif /* CONFIG_NET_SOCKETPAIR_SPSC */
 
 /**
  * Read data from one end of a @ref spair
@@ -603,6 +870,141 @@ out:
  * @return on success, a number > 0 representing the number of bytes written
  * @return -1 on error, with @ref errno set appropriately.
  */
+#ifdef CONFIG_NET_SOCKETPAIR_SPSC
+static ssize_t spair_read(void *obj, void *buffer, size_t count)
+{
+	int res;
+	bool is_nonblock;
+	size_t bytes_read;
+	bool have_local_sem = false;
+	struct spair *const spair = (struct spair *)obj;
+
+	if (obj == NULL || buffer == NULL || count == 0) {
+		errno = EINVAL;
+		res = -1;
+		goto out;
+	}
+
+	res = k_sem_take(&spair->sem, K_NO_WAIT);
+	is_nonblock = sock_is_nonblock(spair);
+	if (res < 0) {
+		if (is_nonblock) {
+			errno = EAGAIN;
+			res = -1;
+			goto out;
+		}
+
+		res = k_sem_take(&spair->sem, K_FOREVER);
+		if (res < 0) {
+			errno = -res;
+			res = -1;
+			goto out;
+		}
+		is_nonblock = sock_is_nonblock(spair);
+	}
+
+	have_local_sem = true;
+
+	while (spair_ring_used(spair) == 0) {
+		int signaled = false;
+		int result = -1;
+		bool published;
+		struct k_poll_event events[] = {
+			K_POLL_EVENT_INITIALIZER(
+				K_POLL_TYPE_SIGNAL,
+				K_POLL_MODE_NOTIFY_ONLY,
+				&spair->readable),
+			K_POLL_EVENT_INITIALIZER(
+				K_POLL_TYPE_SEM_AVAILABLE,
+				K_POLL_MODE_NOTIFY_ONLY,
+				&spair->rx_sem),
+		};
+
+		if (!sock_is_connected(spair)) {
+			/* signal EOF */
+			res = 0;
+			goto out;
+		}
+
+		if (is_nonblock || k_is_in_isr()) {
+			errno = EAGAIN;
+			res = -1;
+			goto out;
+		}
+
+		/* The writer only signals on an empty -> non-empty transition,
+		 * so drop any stale signal and look again before sleeping. A
+		 * cancellation cannot be lost here, since it is raised with the
+		 * local sem held and the endpoint is still connected.
+		 */
+		k_poll_signal_reset(&spair->readable);
+		if (spair_ring_used(spair) > 0) {
+			break;
+		}
+
+		/* Let the next write copy directly into our buffer, unless
+		 * another reader has already published its own.
+		 */
+		published = atomic_cas(&spair->rx_state, SPAIR_RX_IDLE,
+				       SPAIR_RX_CLAIMED);
+		if (published) {
+			spair->rx_buf = buffer;
+			spair->rx_len = count;
+			atomic_set(&spair->rx_state, SPAIR_RX_WAITING);
+		}
+
+		k_sem_give(&spair->sem);
+		have_local_sem = false;
+
+		res = k_poll(events, published ? ARRAY_SIZE(events) : 1,
+			     K_FOREVER);
+		__ASSERT(res == 0, "k_poll() failed: %d", res);
+
+		res = k_sem_take(&spair->sem, K_FOREVER);
+		__ASSERT(res == 0, "failed to take local sem: %d", res);
+
+		have_local_sem = true;
+
+		if (published &&
+		    !atomic_cas(&spair->rx_state, SPAIR_RX_WAITING,
+				SPAIR_RX_IDLE)) {
+			/* a writer claimed our buffer, wait for the copy */
+			res = k_sem_take(&spair->rx_sem, K_FOREVER);
+			__ASSERT(res == 0, "failed to take rx sem: %d", res);
+
+			res = spair->rx_done;
+			atomic_set(&spair->rx_state, SPAIR_RX_IDLE);
+			goto out;
+		}
+
+		k_poll_signal_check(&spair->readable, &signaled, &result);
+		if (signaled && result == SPAIR_SIG_CANCEL) {
+			errno = EPIPE;
+			res = -1;
+			goto out;
+		}
+	}
+
+	bytes_read = spair_ring_get(spair, buffer, count);
+
+	/* Only wake the writer if recv_q was full before this read */
+	if (sock_is_connected(spair) &&
+	    spair_ring_used(spair) + bytes_read >= SPAIR_RING_SIZE) {
+		res = k_poll_signal_raise(&spair->writeable, SPAIR_SIG_DATA);
+		__ASSERT(res == 0, "k_poll_signal_raise() failed: %d", res);
+	}
+
+	res = bytes_read;
+
+out:
+
+	if (spair != NULL && have_local_sem) {
+		k_sem_give(&spair->sem);
+	}
+
+	return res;
+}
+#else
 static ssize_t spair_read(void *obj, void *buffer, size_t count)
 {
 	int res;
@@ -741,6 +1143,7 @@ out:
 
 	return res;
 }
+#endif /* CONFIG_NET_SOCKETPAIR_SPSC */
 
 static int zsock_poll_prepare_ctx(struct spair *const spair,
 				  struct zsock_pollfd *const pfd,
@@ -788,12 +1191,14 @@ static int zsock_poll_prepare_ctx(struct spair *const spair,
 
 		__ASSERT(remote != NULL, "remote is NULL");
 
-		res = k_sem_take(&remote->sem, K_FOREVER);
-		if (res < 0) {
-			goto out;
-		}
+		if (!IS_ENABLED(CONFIG_NET_SOCKETPAIR_SPSC)) {
+			res = k_sem_take(&remote->sem, K_FOREVER);
+			if (res < 0) {
+				goto out;
+			}
 
-		have_remote_sem = true;
+			have_remote_sem = true;
+		}
 
 		/* Wait until the recv queue on the remote end is no longer full */
 		(*pev)->obj = &remote->writeable;
@@ -837,13 +1242,15 @@ static int zsock_poll_update_ctx(struct spair *const spair,
 
 		__ASSERT(remote != NULL, "remote is NULL");
 
-		res = k_sem_take(&remote->sem, K_FOREVER);
-		if (res < 0) {
-			/* if other end is deleted, this might occur */
-			goto pollout_done;
-		}
+		if (!IS_ENABLED(CONFIG_NET_SOCKETPAIR_SPSC)) {
+			res = k_sem_take(&remote->sem, K_FOREVER);
+			if (res < 0) {
+				/* if other end is deleted, this might occur */
+				goto pollout_done;
+			}
 
-		have_remote_sem = true;
+			have_remote_sem = true;
+		}
 
 		if (spair_write_avail(spair) > 0) {
 			pfd->revents |= ZSOCK_POLLOUT;
@@ -853,6 +1260,18 @@ static int zsock_poll_update_ctx(struct spair *const spair,
 		/* check to see if op was canceled */
 		signaled = false;
 		k_poll_signal_check(&remote->writeable, &signaled, &result);
+#ifdef CONFIG_NET_SOCKETPAIR_SPSC
+		if (signaled && result == SPAIR_SIG_DATA) {
+			/* stale edge-triggered signal, see spair_write() */
+			k_poll_signal_reset(&remote->writeable);
+			if (atomic_get(&remote->closing)) {
+				pfd->revents |= ZSOCK_POLLHUP;
+			} else if (spair_write_avail(spair) > 0) {
+				pfd->revents |= ZSOCK_POLLOUT;
+			}
+			goto pollout_done;
+		}
+#endif
 		if (signaled) {
 			/* Cannot be SPAIR_SIG_DATA, because
 			 * spair_write_avail() would have
@@ -880,6 +1299,16 @@ pollout_done:
 		/* check to see if op was canceled */
 		signaled = false;
 		k_poll_signal_check(&spair->readable, &signaled, &result);
+#ifdef CONFIG_NET_SOCKETPAIR_SPSC
+		if (signaled && result == SPAIR_SIG_DATA) {
+			/* stale edge-triggered signal, see spair_read() */
+			k_poll_signal_reset(&spair->readable);
+			if (spair_read_avail(spair) > 0) {
+				pfd->revents |= ZSOCK_POLLIN;
+			}
+			goto pollin_done;
+		}
+#endif
 		if (signaled) {
 			/* Cannot be SPAIR_SIG_DATA, because
 			 * spair_read_avail() would have
@@ -0,0 +1,430 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(net_sock_rtio, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/net/socket_rtio.h>
+#include <zephyr/posix/fcntl.h>
+#include <zephyr/rtio/rtio.h>
+#include <zephyr/sys/fdtable.h>
+
+/*
+ * Operations are tried without blocking from a work queue. When one would
+ * block, the socket's poll events are armed with a triggered work item, so
+ * the work runs again once the network stack signals the socket from its
+ * receive or transmit callbacks. No thread waits in poll() for the sockets.
+ */
+
+static K_KERNEL_STACK_DEFINE(sock_rtio_stack, CONFIG_NET_SOCKETS_RTIO_STACK_SIZE);
+static struct k_work_q sock_rtio_workq;
+
+static bool sock_rtio_is_rx(const struct rtio_sqe *sqe)
+{
+	return sqe->op == RTIO_OP_RX || sqe->op == RTIO_OP_SOCK_ACCEPT;
+}
+
+static int sock_rtio_recv(struct zsock_rtio_iodev_data *data,
+			  struct rtio_iodev_sqe *iodev_sqe)
+{
+	const struct rtio_sqe *sqe = &iodev_sqe->sqe;
+	uint32_t max_len = CONFIG_NET_SOCKETS_RTIO_MEMPOOL_READ_SIZE;
+	uint32_t buf_len;
+	uint8_t *buf;
+	uint8_t peek;
+	ssize_t ret;
+
+	if (sqe->flags & RTIO_SQE_MEMPOOL_BUFFER && sqe->buf == NULL) {
+		/* Don't hold mempool blocks while waiting for data */
+		ret = zsock_recv(data->sock, &peek, sizeof(peek),
+				 ZSOCK_MSG_PEEK | ZSOCK_MSG_DONTWAIT);
+		if (ret < 0) {
+			return -errno;
+		}
+
+		max_len = ROUND_UP(max_len, rtio_mempool_block_size(iodev_sqe->r));
+	}
+
+	ret = rtio_sqe_rx_buf(iodev_sqe, 1, max_len, &buf, &buf_len);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = zsock_recv(data->sock, buf, buf_len, ZSOCK_MSG_DONTWAIT);
+
+	return ret < 0 ? -errno : ret;
+}
+
+static int sock_rtio_accept(struct zsock_rtio_iodev_data *data,
+			    struct rtio_iodev_sqe *iodev_sqe)
+{
+	const struct rtio_sqe *sqe = &iodev_sqe->sqe;
+	socklen_t addrlen = sqe->addr_len;
+	int ret;
+
+	ret = zsock_accept(data->sock, sqe->addr, sqe->addr != NULL ? &addrlen : NULL);
+
+	return ret < 0 ? -errno : ret;
+}
+
+static int sock_rtio_send(struct zsock_rtio_iodev_data *data,
+			  struct rtio_iodev_sqe *iodev_sqe)
+{
+	const struct rtio_sqe *sqe = &iodev_sqe->sqe;
+	const uint8_t *buf = sqe->op == RTIO_OP_TINY_TX ? sqe->tiny_buf : sqe->buf;
+	uint32_t len = sqe->op == RTIO_OP_TINY_TX ? sqe->tiny_buf_len : sqe->buf_len;
+	ssize_t ret;
+
+	while (data->tx_offset < len) {
+		ret = zsock_send(data->sock, buf + data->tx_offset, len - data->tx_offset,
+				 ZSOCK_MSG_DONTWAIT);
+		if (ret < 0) {
+			return -errno;
+		}
+
+		data->tx_offset += ret;
+	}
+
+	return len;
+}
+
+static int sock_rtio_connect(struct zsock_rtio_iodev_data *data,
+			     struct rtio_iodev_sqe *iodev_sqe)
+{
+	const struct rtio_sqe *sqe = &iodev_sqe->sqe;
+
+	/* Called again while connecting, to learn how it went */
+	if (zsock_connect(data->sock, sqe->addr, sqe->addr_len) < 0) {
+		return (errno == EINPROGRESS || errno == EALREADY) ? -EAGAIN : -errno;
+	}
+
+	return 0;
+}
+
+static int sock_rtio_op(struct zsock_rtio_iodev_data *data,
+			struct rtio_iodev_sqe *iodev_sqe)
+{
+	switch (iodev_sqe->sqe.op) {
+	case RTIO_OP_RX:
+		return sock_rtio_recv(data, iodev_sqe);
+	case RTIO_OP_SOCK_ACCEPT:
+		return sock_rtio_accept(data, iodev_sqe);
+	case RTIO_OP_TX:
+	case RTIO_OP_TINY_TX:
+		return sock_rtio_send(data, iodev_sqe);
+	case RTIO_OP_SOCK_CONNECT:
+		return sock_rtio_connect(data, iodev_sqe);
+	default:
+		return -ENOTSUP;
+	}
+}
+
+/* Run the operations of one direction until one would block. Returns the
+ * operation waiting for the socket, or NULL.
+ */
+static struct rtio_iodev_sqe *sock_rtio_run(struct zsock_rtio_iodev_data *data,
+					    struct rtio_iodev_sqe *curr, struct rtio_mpsc *q)
+{
+	struct rtio_mpsc_node *node;
+	bool multishot;
+	int ret;
+
+	while (true) {
+		if (curr == NULL) {
+			node = rtio_mpsc_pop(q);
+			if (node == NULL) {
+				return NULL;
+			}
+
+			curr = CONTAINER_OF(node, struct rtio_iodev_sqe, q);
+		}
+
+		multishot = curr->sqe.flags & RTIO_SQE_MULTISHOT;
+
+		if (curr->sqe.flags & RTIO_SQE_CANCELED) {
+			ret = -ECANCELED;
+		} else if (multishot && data->rx_closed) {
+			/* Already reported, stop it without another completion */
+			curr->sqe.flags |= RTIO_SQE_CANCELED;
+			ret = -ECANCELED;
+		} else {
+			ret = sock_rtio_op(data, curr);
+			if (ret == -EAGAIN || ret == -EWOULDBLOCK) {
+				return curr;
+			}
+
+			if (multishot && ret <= 0) {
+				data->rx_closed = true;
+			}
+		}
+
+		if (!sock_rtio_is_rx(&curr->sqe)) {
+			data->tx_offset = 0;
+		}
+
+		/* A multishot read is submitted again from here, and only
+		 * queued since the work is running.
+		 */
+		if (ret < 0) {
+			rtio_iodev_sqe_err(curr, ret);
+		} else {
+			rtio_iodev_sqe_ok(curr, ret);
+		}
+
+		curr = NULL;
+	}
+}
+
+static void sock_rtio_err(struct rtio_iodev_sqe *iodev_sqe, int err)
+{
+	/* A multishot read would be submitted again right away */
+	if (iodev_sqe->sqe.flags & RTIO_SQE_MULTISHOT) {
+		iodev_sqe->sqe.flags |= RTIO_SQE_CANCELED;
+	}
+
+	rtio_iodev_sqe_err(iodev_sqe, err);
+}
+
+static void sock_rtio_fail(struct rtio_iodev_sqe *curr, struct rtio_mpsc *q, int err)
+{
+	struct rtio_mpsc_node *node;
+
+	if (curr != NULL) {
+		sock_rtio_err(curr, err);
+	}
+
+	while ((node = rtio_mpsc_pop(q)) != NULL) {
+		sock_rtio_err(CONTAINER_OF(node, struct rtio_iodev_sqe, q), err);
+	}
+}
+
+/* Wait for the socket to be ready for the operations which would block */
+static void sock_rtio_arm(struct zsock_rtio_iodev_data *data)
+{
+	struct zsock_pollfd pfd = {
+		.fd = data->sock,
+	};
+	struct k_poll_event *pev = data->events;
+	const struct fd_op_vtable *vtable;
+	struct k_mutex *lock;
+	void *obj;
+	int ret;
+
+	if (data->rx != NULL) {
+		pfd.events |= ZSOCK_POLLIN;
+	}
+
+	/* Only stream sockets can wait to be writable, datagram sends
+	 * blocked on network buffers are retried a bit later.
+	 */
+	if (data->tx != NULL) {
+		if (data->stream) {
+			pfd.events |= ZSOCK_POLLOUT;
+		} else {
+			k_work_schedule_for_queue(&sock_rtio_workq, &data->work, K_TICKS(1));
+		}
+	}
+
+	if (pfd.events == 0) {
+		return;
+	}
+
+	obj = z_get_fd_obj_and_vtable(data->sock, &vtable, &lock);
+	if (obj == NULL) {
+		ret = -EBADF;
+		goto fail;
+	}
+
+	(void)k_mutex_lock(lock, K_FOREVER);
+	ret = z_fdtable_call_ioctl(vtable, obj, ZFD_IOCTL_POLL_PREPARE, &pfd, &pev,
+				   data->events + ARRAY_SIZE(data->events));
+	k_mutex_unlock(lock);
+
+	if (ret == -EALREADY) {
+		/* Ready already, e.g. end of stream or a socket error */
+		k_work_reschedule_for_queue(&sock_rtio_workq, &data->work, K_NO_WAIT);
+		return;
+	}
+
+	if (ret < 0) {
+		goto fail;
+	}
+
+	ret = k_work_poll_submit_to_queue(&sock_rtio_workq, &data->poll_work, data->events,
+					  pev - data->events, K_FOREVER);
+	if (ret == 0) {
+		return;
+	}
+
+fail:
+	LOG_ERR("Cannot wait for socket %d (%d)", data->sock, ret);
+
+	if (pfd.events & ZSOCK_POLLIN) {
+		sock_rtio_fail(data->rx, &data->rx_q, ret);
+		data->rx = NULL;
+	}
+
+	if (pfd.events & ZSOCK_POLLOUT) {
+		sock_rtio_fail(data->tx, &data->tx_q, ret);
+		data->tx = NULL;
+	}
+}
+
+static void sock_rtio_process(struct zsock_rtio_iodev_data *data)
+{
+	(void)k_mutex_lock(&data->lock, K_FOREVER);
+
+	if (data->sock < 0) {
+		k_mutex_unlock(&data->lock);
+		return;
+	}
+
+	/* The poll events are reused below */
+	(void)k_work_poll_cancel(&data->poll_work);
+
+	data->rx = sock_rtio_run(data, data->rx, &data->rx_q);
+	data->tx = sock_rtio_run(data, data->tx, &data->tx_q);
+
+	sock_rtio_arm(data);
+
+	k_mutex_unlock(&data->lock);
+}
+
+static void sock_rtio_work_handler(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+
+	sock_rtio_process(CONTAINER_OF(dwork, struct zsock_rtio_iodev_data, work));
+}
+
+static void sock_rtio_poll_handler(struct k_work *work)
+{
+	struct k_work_poll *pwork = CONTAINER_OF(work, struct k_work_poll, work);
+
+	sock_rtio_process(CONTAINER_OF(pwork, struct zsock_rtio_iodev_data, poll_work));
+}
+
+static void sock_rtio_submit(struct rtio_iodev_sqe *iodev_sqe)
+{
+	struct zsock_rtio_iodev_data *data = iodev_sqe->sqe.iodev->data;
+
+	if (data->sock < 0) {
+		sock_rtio_err(iodev_sqe, -EBADF);
+		return;
+	}
+
+	if (sock_rtio_is_rx(&iodev_sqe->sqe)) {
+		rtio_mpsc_push(&data->rx_q, &iodev_sqe->q);
+	} else {
+		rtio_mpsc_push(&data->tx_q, &iodev_sqe->q);
+	}
+
+	k_work_reschedule_for_queue(&sock_rtio_workq, &data->work, K_NO_WAIT);
+}
+
+const struct rtio_iodev_api zsock_rtio_iodev_api = {
+	.submit = sock_rtio_submit,
+};
+
+int zsock_rtio_iodev_attach(const struct rtio_iodev *iodev, int sock)
+{
+	struct zsock_rtio_iodev_data *data = iodev->data;
+	const struct fd_op_vtable *vtable;
+	struct zsock_pollfd pfd = {
+		.fd = sock,
+		.events = ZSOCK_POLLIN,
+	};
+	struct k_poll_event event;
+	struct k_poll_event *pev = &event;
+	struct k_mutex *lock;
+	socklen_t optlen;
+	void *obj;
+	int type;
+	int ret;
+
+	if (data->sock >= 0) {
+		return -EBUSY;
+	}
+
+	optlen = sizeof(type);
+	if (zsock_getsockopt(sock, SOL_SOCKET, SO_TYPE, &type, &optlen) < 0) {
+		return -errno;
+	}
+
+	/* Offloaded sockets have no poll events to wait on */
+	obj = z_get_fd_obj_and_vtable(sock, &vtable, &lock);
+	if (obj == NULL) {
+		return -EBADF;
+	}
+
+	(void)k_mutex_lock(lock, K_FOREVER);
+	ret = z_fdtable_call_ioctl(vtable, obj, ZFD_IOCTL_POLL_PREPARE, &pfd, &pev, pev + 1);
+	k_mutex_unlock(lock);
+
+	if (ret == -EXDEV) {
+		return -ENOTSUP;
+	}
+
+	ret = zsock_fcntl(sock, F_GETFL, 0);
+	if (ret < 0 || zsock_fcntl(sock, F_SETFL, ret | O_NONBLOCK) < 0) {
+		return -errno;
+	}
+
+	k_work_init_delayable(&data->work, sock_rtio_work_handler);
+	k_work_poll_init(&data->poll_work, sock_rtio_poll_handler);
+	k_mutex_init(&data->lock);
+	rtio_mpsc_init(&data->rx_q);
+	rtio_mpsc_init(&data->tx_q);
+	data->rx = NULL;
+	data->tx = NULL;
+	data->tx_offset = 0;
+	data->stream = (type == SOCK_STREAM);
+	data->rx_closed = false;
+	data->sock = sock;
+
+	return 0;
+}
+
+void zsock_rtio_iodev_detach(const struct rtio_iodev *iodev)
+{
+	struct zsock_rtio_iodev_data *data = iodev->data;
+	struct k_work_sync sync;
+
+	if (data->sock < 0) {
+		return;
+	}
+
+	(void)k_mutex_lock(&data->lock, K_FOREVER);
+
+	data->sock = -1;
+	(void)k_work_poll_cancel(&data->poll_work);
+
+	sock_rtio_fail(data->rx, &data->rx_q, -ECANCELED);
+	sock_rtio_fail(data->tx, &data->tx_q, -ECANCELED);
+	data->rx = NULL;
+	data->tx = NULL;
+
+	k_mutex_unlock(&data->lock);
+
+	/* Wait for handlers already running, they see the socket is gone */
+	(void)k_work_cancel_delayable_sync(&data->work, &sync);
+	(void)k_work_cancel_sync(&data->poll_work.work, &sync);
+}
+
+static int sock_rtio_init(void)
+{
+	k_work_queue_start(&sock_rtio_workq, sock_rtio_stack,
+			   K_KERNEL_STACK_SIZEOF(sock_rtio_stack),
+			   CONFIG_NET_SOCKETS_RTIO_THREAD_PRIO, NULL);
+	k_thread_name_set(&sock_rtio_workq.thread, "sock_rtio");
+
+	return 0;
+}
+
+SYS_INIT(sock_rtio_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
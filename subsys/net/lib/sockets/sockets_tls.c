@@ -68,6 +68,12 @@ LOG_MODULE_REGISTER(net_sock_tls, CONFIG_NET_SOCKETS_LOG_LEVEL);
 #define DTLS_SENDMSG_BUF_SIZE 0
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
+#if defined(CONFIG_NET_SOCKETS_TLS_WRITE_BUFFER_SIZE)
+#define TLS_WRITE_BUF_SIZE (CONFIG_NET_SOCKETS_TLS_WRITE_BUFFER_SIZE)
+#else
+#define TLS_WRITE_BUF_SIZE 0
+#endif /* CONFIG_NET_SOCKETS_TLS_WRITE_BUFFER_SIZE */
+
 static const struct socket_op_vtable tls_sock_fd_op_vtable;
 
 #ifndef MBEDTLS_ERR_SSL_PEER_VERIFY_FAILED
@@ -123,6 +129,25 @@ struct tls_dtls_cid {
 };
 #endif
 
+#if TLS_WRITE_BUF_SIZE > 0
+/** Plaintext data waiting to be sent in a single TLS record. */
+struct tls_write_buffer {
+	/** Work item sending out data that was held for too long. */
+	struct k_work_delayable flush_work;
+
+	/** Amount of data in the buffer. */
+	size_t len;
+
+	/** Length of the write interrupted by mbedTLS, which has to be
+	 *  repeated with the same length.
+	 */
+	size_t pending;
+
+	/** Buffered data. */
+	uint8_t data[TLS_WRITE_BUF_SIZE];
+};
+#endif /* TLS_WRITE_BUF_SIZE > 0 */
+
 /** TLS context information. */
 __net_socket struct tls_context {
 	/** Underlying TCP/UDP socket. */
@@ -198,6 +223,16 @@ __net_socket struct tls_context {
 		/** Socket RX timeout */
 		k_timeout_t timeout_rx;
 
+#if TLS_WRITE_BUF_SIZE > 0
+		/** Hold all writes in the write buffer, not only ZSOCK_MSG_MORE
+		 *  ones.
+		 */
+		bool write_buffer;
+
+		/** TCP_NODELAY set on the socket. */
+		bool nodelay;
+#endif /* TLS_WRITE_BUF_SIZE > 0 */
+
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
 		/* DTLS handshake timeout */
 		uint32_t dtls_handshake_timeout_min;
@@ -223,6 +258,11 @@ __net_socket struct tls_context {
 	socklen_t dtls_peer_addrlen;
 #endif /* CONFIG_NET_SOCKETS_ENABLE_DTLS */
 
+#if TLS_WRITE_BUF_SIZE > 0
+	/** Write buffer for TLS stream sockets. */
+	struct tls_write_buffer wbuf;
+#endif /* TLS_WRITE_BUF_SIZE > 0 */
+
 #if defined(CONFIG_MBEDTLS)
 	/** mbedTLS context. */
 	mbedtls_ssl_context ssl;
@@ -248,6 +288,11 @@ __net_socket struct tls_context {
 /* A global pool of TLS contexts. */
 static struct tls_context tls_contexts[CONFIG_NET_SOCKETS_TLS_MAX_CONTEXTS];
 
+#if TLS_WRITE_BUF_SIZE > 0
+static int tls_write_flush(struct tls_context *ctx, int flags);
+static void tls_write_flush_work(struct k_work *work);
+#endif
+
 static struct tls_session_cache client_cache[CONFIG_NET_SOCKETS_TLS_MAX_CLIENT_SESSION_COUNT];
 
 #if defined(MBEDTLS_SSL_CACHE_C)
@@ -464,6 +509,10 @@ static struct tls_context *tls_alloc(void)
 	if (tls) {
 		k_sem_init(&tls->tls_established, 0, 1);
 
+#if TLS_WRITE_BUF_SIZE > 0
+		k_work_init_delayable(&tls->wbuf.flush_work, tls_write_flush_work);
+#endif
+
 		mbedtls_ssl_init(&tls->ssl);
 		mbedtls_ssl_config_init(&tls->config);
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
@@ -521,6 +570,10 @@ static struct tls_context *tls_clone(struct tls_context *source_tls)
 /* Release TLS context. */
 static int tls_release(struct tls_context *tls)
 {
+#if TLS_WRITE_BUF_SIZE > 0
+	struct k_work_sync sync;
+#endif
+
 	if (!PART_OF_ARRAY(tls_contexts, tls)) {
 		NET_ERR("Invalid TLS context");
 		return -EBADF;
@@ -531,6 +584,10 @@ static int tls_release(struct tls_context *tls)
 		return -EBADF;
 	}
 
+#if TLS_WRITE_BUF_SIZE > 0
+	(void)k_work_cancel_delayable_sync(&tls->wbuf.flush_work, &sync);
+#endif
+
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
 	mbedtls_ssl_cookie_free(&tls->cookie);
 #endif
@@ -2004,6 +2061,52 @@ static int tls_opt_cert_nocopy_set(struct tls_context *context,
 	return 0;
 }
 
+static int tls_opt_write_buffer_set(struct tls_context *context,
+				    const void *optval, socklen_t optlen)
+{
+#if TLS_WRITE_BUF_SIZE > 0
+	int *val = (int *)optval;
+
+	if (!optval) {
+		return -EINVAL;
+	}
+
+	if (sizeof(int) != optlen) {
+		return -EINVAL;
+	}
+
+	if (context->type != SOCK_STREAM) {
+		return -ENOPROTOOPT;
+	}
+
+	context->options.write_buffer = (bool)*val;
+
+	if (!context->options.write_buffer && context->wbuf.len > 0) {
+		(void)tls_write_flush(context, ZSOCK_MSG_DONTWAIT);
+	}
+
+	return 0;
+#else
+	return -ENOPROTOOPT;
+#endif /* TLS_WRITE_BUF_SIZE > 0 */
+}
+
+static int tls_opt_write_buffer_get(struct tls_context *context,
+				    void *optval, socklen_t *optlen)
+{
+#if TLS_WRITE_BUF_SIZE > 0
+	if (*optlen != sizeof(int)) {
+		return -EINVAL;
+	}
+
+	*(int *)optval = context->options.write_buffer;
+
+	return 0;
+#else
+	return -ENOPROTOOPT;
+#endif /* TLS_WRITE_BUF_SIZE > 0 */
+}
+
 static int tls_opt_dtls_role_set(struct tls_context *context,
 				 const void *optval, socklen_t optlen)
 {
@@ -2111,6 +2214,13 @@ int ztls_close_ctx(struct tls_context *ctx)
 	/* Try to send close notification. */
 	ctx->flags = 0;
 
+#if TLS_WRITE_BUF_SIZE > 0
+	/* Send out held data first, otherwise it would be lost. */
+	if (ctx->wbuf.len > 0) {
+		(void)tls_write_flush(ctx, 0);
+	}
+#endif
+
 	(void)mbedtls_ssl_close_notify(&ctx->ssl);
 
 	err = tls_release(ctx);
@@ -2337,6 +2447,163 @@ static ssize_t send_tls(struct tls_context *ctx, const void *buf,
 	return -1;
 }
 
+#if TLS_WRITE_BUF_SIZE > 0
+/* Send out the data held in the write buffer, returns 0 once it is empty. */
+static int tls_write_flush(struct tls_context *ctx, int flags)
+{
+	struct tls_write_buffer *wbuf = &ctx->wbuf;
+	ssize_t ret;
+
+	while (wbuf->len > 0) {
+		/* A write interrupted by mbedTLS has to be repeated with the
+		 * same length, so data added in the meantime has to wait.
+		 */
+		size_t len = wbuf->pending > 0 ? wbuf->pending : wbuf->len;
+
+		ret = send_tls(ctx, wbuf->data, len, flags);
+		if (ret < 0) {
+			if (ctx->error != 0) {
+				/* Session is gone, and so is the data. */
+				wbuf->len = 0;
+				wbuf->pending = 0;
+			} else {
+				wbuf->pending = len;
+			}
+
+			return -errno;
+		}
+
+		wbuf->pending = 0;
+		wbuf->len -= ret;
+		memmove(wbuf->data, wbuf->data + ret, wbuf->len);
+	}
+
+	return 0;
+}
+
+static void tls_write_flush_work(struct k_work *work)
+{
+	struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+	struct tls_context *ctx =
+		CONTAINER_OF(dwork, struct tls_context, wbuf.flush_work);
+
+	/* Don't wait for the socket lock, its owner may be closing the socket
+	 * and waiting for this work item to finish.
+	 */
+	if (ctx->lock != NULL && k_mutex_lock(ctx->lock, K_NO_WAIT) != 0) {
+		(void)k_work_reschedule(dwork, K_MSEC(1));
+		return;
+	}
+
+	if (tls_write_flush(ctx, ZSOCK_MSG_DONTWAIT) == -EAGAIN) {
+		(void)k_work_reschedule(
+			dwork, K_MSEC(CONFIG_NET_SOCKETS_TLS_WRITE_BUFFER_DELAY));
+	}
+
+	if (ctx->lock != NULL) {
+		k_mutex_unlock(ctx->lock);
+	}
+}
+
+/* Returns true if the data could not be sent right away and the flush work
+ * has to retry.
+ */
+static bool tls_write_flush_or_defer(struct tls_context *ctx, int flags,
+				     int *err)
+{
+	*err = tls_write_flush(ctx, flags);
+	if (*err == -EAGAIN) {
+		(void)k_work_schedule(&ctx->wbuf.flush_work,
+			K_MSEC(CONFIG_NET_SOCKETS_TLS_WRITE_BUFFER_DELAY));
+		*err = 0;
+		return true;
+	}
+
+	return false;
+}
+
+static ssize_t send_tls_buffered(struct tls_context *ctx, const void *buf,
+				 size_t len, int flags)
+{
+	struct tls_write_buffer *wbuf = &ctx->wbuf;
+	const bool hold = (flags & ZSOCK_MSG_MORE) ||
+			  (ctx->options.write_buffer && !ctx->options.nodelay);
+	size_t copied = 0;
+	ssize_t ret;
+	int err;
+
+	if (wbuf->len == 0 && (!hold || len >= sizeof(wbuf->data))) {
+		/* Nothing to combine the data with. */
+		return send_tls(ctx, buf, len, flags);
+	}
+
+	if (ctx->error != 0) {
+		errno = ctx->error;
+		return -1;
+	}
+
+	if (ctx->session_closed) {
+		errno = ECONNABORTED;
+		return -1;
+	}
+
+	while (copied < len) {
+		size_t chunk;
+
+		if (wbuf->len == 0 && len - copied >= sizeof(wbuf->data)) {
+			/* At least one full record left, no need to copy. */
+			ret = send_tls(ctx, (const uint8_t *)buf + copied,
+				       len - copied, flags);
+			if (ret < 0) {
+				return copied > 0 ? (ssize_t)copied : -1;
+			}
+
+			copied += ret;
+			continue;
+		}
+
+		chunk = MIN(len - copied, sizeof(wbuf->data) - wbuf->len);
+		memcpy(wbuf->data + wbuf->len, (const uint8_t *)buf + copied,
+		       chunk);
+		wbuf->len += chunk;
+		copied += chunk;
+
+		if (wbuf->len < sizeof(wbuf->data)) {
+			break;
+		}
+
+		/* Buffer is full, a full sized record can be sent. */
+		if (tls_write_flush_or_defer(ctx, flags, &err)) {
+			return copied;
+		}
+
+		if (err < 0) {
+			errno = -err;
+			return -1;
+		}
+	}
+
+	if (wbuf->len == 0) {
+		return copied;
+	}
+
+	if (hold) {
+		/* The delay counts from the first write held. */
+		(void)k_work_schedule(&wbuf->flush_work,
+			K_MSEC(CONFIG_NET_SOCKETS_TLS_WRITE_BUFFER_DELAY));
+		return copied;
+	}
+
+	(void)tls_write_flush_or_defer(ctx, flags, &err);
+	if (err < 0) {
+		errno = -err;
+		return -1;
+	}
+
+	return copied;
+}
+#endif /* TLS_WRITE_BUF_SIZE > 0 */
+
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
 static ssize_t sendto_dtls_client(struct tls_context *ctx, const void *buf,
 				  size_t len, int flags,
@@ -2427,7 +2694,11 @@ ssize_t ztls_sendto_ctx(struct tls_context *ctx, const void *buf, size_t len,
 
 	/* TLS */
 	if (ctx->type == SOCK_STREAM) {
+#if TLS_WRITE_BUF_SIZE > 0
+		return send_tls_buffered(ctx, buf, len, flags);
+#else
 		return send_tls(ctx, buf, len, flags);
+#endif
 	}
 
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
@@ -2485,20 +2756,32 @@ static ssize_t tls_sendmsg_loop_and_send(struct tls_context *ctx,
 {
 	ssize_t len = 0;
 	ssize_t ret;
+	int last = msg->msg_iovlen - 1;
+
+	/* Let the write buffer combine all vectors into one record. */
+	while (last > 0 && msg->msg_iov[last].iov_len == 0) {
+		last--;
+	}
 
 	for (int i = 0; i < msg->msg_iovlen; i++) {
 		struct iovec *vec = msg->msg_iov + i;
+		int vec_flags = flags;
 		size_t sent = 0;
 
 		if (vec->iov_len == 0) {
 			continue;
 		}
 
+		if (TLS_WRITE_BUF_SIZE > 0 && ctx->type == SOCK_STREAM &&
+		    i < last) {
+			vec_flags |= ZSOCK_MSG_MORE;
+		}
+
 		while (sent < vec->iov_len) {
 			uint8_t *ptr = (uint8_t *)vec->iov_base + sent;
 
 			ret = ztls_sendto_ctx(ctx, ptr, vec->iov_len - sent,
-					      flags, msg->msg_name,
+					      vec_flags, msg->msg_name,
 					      msg->msg_namelen);
 			if (ret < 0) {
 				return ret;
@@ -2566,6 +2849,13 @@ static ssize_t recv_tls(struct tls_context *ctx, void *buf,
 		return 0;
 	}
 
+#if TLS_WRITE_BUF_SIZE > 0
+	/* The peer may be waiting for the held data before it responds. */
+	if (ctx->wbuf.len > 0) {
+		(void)tls_write_flush(ctx, ZSOCK_MSG_DONTWAIT);
+	}
+#endif
+
 	if (!is_block) {
 		timeout = K_NO_WAIT;
 	} else {
@@ -3471,6 +3761,10 @@ int ztls_getsockopt_ctx(struct tls_context *ctx, int level, int optname,
 		err = tls_opt_session_cache_get(ctx, optval, optlen);
 		break;
 
+	case TLS_WRITE_BUFFER:
+		err = tls_opt_write_buffer_get(ctx, optval, optlen);
+		break;
+
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
 	case TLS_DTLS_HANDSHAKE_TIMEOUT_MIN:
 		err = tls_opt_dtls_handshake_timeout_get(ctx, optval,
@@ -3551,6 +3845,25 @@ int ztls_setsockopt_ctx(struct tls_context *ctx, int level, int optname,
 		goto out;
 	}
 
+#if TLS_WRITE_BUF_SIZE > 0
+	/* Don't hold back data on a socket asking for low latency. */
+	if ((level == IPPROTO_TCP) && (optname == TCP_NODELAY) &&
+	    (ctx->type == SOCK_STREAM)) {
+		err = zsock_setsockopt(ctx->sock, level, optname,
+				       optval, optlen);
+		if (err < 0) {
+			return err;
+		}
+
+		ctx->options.nodelay = *(const int *)optval != 0;
+		if (ctx->options.nodelay && ctx->wbuf.len > 0) {
+			(void)tls_write_flush(ctx, ZSOCK_MSG_DONTWAIT);
+		}
+
+		return 0;
+	}
+#endif /* TLS_WRITE_BUF_SIZE > 0 */
+
 	if (level != SOL_TLS) {
 		return zsock_setsockopt(ctx->sock, level, optname,
 					optval, optlen);
@@ -3593,6 +3906,10 @@ int ztls_setsockopt_ctx(struct tls_context *ctx, int level, int optname,
 		err = tls_opt_session_cache_purge_set(ctx, optval, optlen);
 		break;
 
+	case TLS_WRITE_BUFFER:
+		err = tls_opt_write_buffer_set(ctx, optval, optlen);
+		break;
+
 #if defined(CONFIG_NET_SOCKETS_ENABLE_DTLS)
 	case TLS_DTLS_HANDSHAKE_TIMEOUT_MIN:
 		err = tls_opt_dtls_handshake_timeout_set(ctx, optval,
@@ -574,6 +574,53 @@ static int sendmsg_all(int sock, const struct msghdr *message, int flags)
 }
 #endif /* !defined(CONFIG_NET_TEST) */
 
+void websocket_mask_payload(uint8_t *dst, const uint8_t *src, size_t len,
+			    uint32_t masking_value, size_t offset)
+{
+	uint8_t mask[sizeof(unsigned long)];
+	unsigned long mask_word;
+	size_t i;
+
+	for (i = 0; i < sizeof(mask); i++) {
+		mask[i] = masking_value >> (8 * (3 - (i % 4)));
+	}
+
+	/* Byte at a time until the destination is word aligned */
+	while (len > 0 && !IS_ALIGNED(dst, sizeof(unsigned long))) {
+		*dst++ = *src++ ^ mask[offset++ % 4];
+		len--;
+	}
+
+	if (len >= sizeof(unsigned long)) {
+		/* The word size is a multiple of the mask length, so the key
+		 * rotated to the current position fits every word.
+		 */
+		for (i = 0; i < sizeof(mask_word); i++) {
+			((uint8_t *)&mask_word)[i] = mask[(offset + i) % 4];
+		}
+
+		if (IS_ALIGNED(src, sizeof(unsigned long))) {
+			for (; len >= sizeof(unsigned long); len -= sizeof(unsigned long)) {
+				*(unsigned long *)dst = *(const unsigned long *)src ^ mask_word;
+				dst += sizeof(unsigned long);
+				src += sizeof(unsigned long);
+			}
+		} else {
+			for (; len >= sizeof(unsigned long); len -= sizeof(unsigned long)) {
+				*(unsigned long *)dst =
+					UNALIGNED_GET((const unsigned long *)src) ^ mask_word;
+				dst += sizeof(unsigned long);
+				src += sizeof(unsigned long);
+			}
+		}
+	}
+
+	while (len > 0) {
+		*dst++ = *src++ ^ mask[offset++ % 4];
+		len--;
+	}
+}
+
 static int websocket_prepare_and_send(struct websocket_context *ctx,
 				      uint8_t *header, size_t header_len,
 				      uint8_t *payload, size_t payload_len,
@@ -618,13 +665,47 @@ static int websocket_prepare_and_send(struct websocket_context *ctx,
 #endif /* CONFIG_NET_TEST */
 }
 
+/* Mask the payload into the context transmit buffer one chunk at a time
+ * and send each chunk as soon as it is masked, the header goes out with the
+ * first one. This bounds the memory needed for masking to the chunk size
+ * whatever the frame length.
+ */
+static int websocket_send_masked(struct websocket_context *ctx,
+				 uint8_t *header, size_t header_len,
+				 const uint8_t *payload, size_t payload_len,
+				 int32_t timeout)
+{
+	size_t offset = 0;
+	size_t chunk_len;
+	int sent = 0;
+	int ret;
+
+	while (offset < payload_len) {
+		chunk_len = MIN(payload_len - offset, sizeof(ctx->tx_buf));
+
+		websocket_mask_payload(ctx->tx_buf, payload + offset, chunk_len,
+				       ctx->masking_value, offset);
+
+		ret = websocket_prepare_and_send(ctx, header, header_len,
+						 ctx->tx_buf, chunk_len, timeout);
+		if (ret < 0) {
+			return ret;
+		}
+
+		sent += ret;
+		offset += chunk_len;
+		header_len = 0;
+	}
+
+	return sent;
+}
+
 int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 		       enum websocket_opcode opcode, bool mask, bool final,
 		       int32_t timeout)
 {
 	struct websocket_context *ctx;
 	uint8_t header[MAX_HEADER_LEN], hdr_len = 2;
-	uint8_t *data_to_send = (uint8_t *)payload;
 	int ret;
 
 	if (opcode != WEBSOCKET_OPCODE_DATA_TEXT &&
@@ -687,39 +768,25 @@ int websocket_send_msg(int ws_sock, const uint8_t *payload, size_t payload_len,
 
 	/* Add masking value if needed */
 	if (mask) {
-		int i;
-
 		ctx->masking_value = sys_rand32_get();
 
 		header[hdr_len++] |= ctx->masking_value >> 24;
 		header[hdr_len++] |= ctx->masking_value >> 16;
 		header[hdr_len++] |= ctx->masking_value >> 8;
 		header[hdr_len++] |= ctx->masking_value;
-
-		if ((payload != NULL) && (payload_len > 0)) {
-			data_to_send = k_malloc(payload_len);
-			if (!data_to_send) {
-				return -ENOMEM;
-			}
-
-			memcpy(data_to_send, payload, payload_len);
-
-			for (i = 0; i < payload_len; i++) {
-				data_to_send[i] ^= ctx->masking_value >> (8 * (3 - i % 4));
-			}
-		}
 	}
 
-	ret = websocket_prepare_and_send(ctx, header, hdr_len,
-					 data_to_send, payload_len, timeout);
-	if (ret < 0) {
-		NET_DBG("Cannot send ws msg (%d)", -errno);
-		goto quit;
+	if (mask && (payload != NULL) && (payload_len > 0)) {
+		ret = websocket_send_masked(ctx, header, hdr_len, payload,
+					    payload_len, timeout);
+	} else {
+		ret = websocket_prepare_and_send(ctx, header, hdr_len,
+						 (uint8_t *)payload, payload_len,
+						 timeout);
 	}
 
-quit:
-	if (data_to_send != payload) {
-		k_free(data_to_send);
+	if (ret < 0) {
+		NET_DBG("Cannot send ws msg (%d)", ret);
 	}
 
 	/* Do no math with 0 and error codes */
@@ -1019,15 +1086,10 @@ int websocket_recv_msg(int ws_sock, uint8_t *buf, size_t buf_len,
 
 	/* Unmask the data */
 	if (ctx->masked) {
-		uint8_t *mask_as_bytes = (uint8_t *)&ctx->masking_value;
 		size_t data_buf_offset = ctx->message_len - ctx->parser_remaining - payload.count;
 
-		for (size_t i = 0; i < payload.count; i++) {
-			size_t m = data_buf_offset % 4;
-
-			payload.buf[i] ^= mask_as_bytes[3 - m];
-			data_buf_offset++;
-		}
+		websocket_mask_payload(payload.buf, payload.buf, payload.count,
+				       ctx->masking_value, data_buf_offset);
 	}
 
 	return payload.count;
@@ -96,6 +96,9 @@ __net_socket struct websocket_context {
 	/** Websocket connection masking value */
 	uint32_t masking_value;
 
+	/** Buffer where outgoing payload is masked before sending */
+	uint8_t tx_buf[CONFIG_WEBSOCKET_TX_CHUNK_SIZE];
+
 	/** Message length */
 	uint64_t message_len;
 
@@ -141,6 +144,24 @@ struct test_data {
 };
 #endif /* CONFIG_NET_TEST */
 
+/**
+ * @brief Apply a Websocket masking key to a payload.
+ *
+ * The payload is processed a word at a time, unaligned bytes at the start
+ * and at the end are handled separately. As masking is an XOR, the same
+ * call both masks and unmasks the data.
+ *
+ * @param dst Destination buffer, can be the same as @p src.
+ * @param src Source buffer.
+ * @param len Number of bytes to process.
+ * @param masking_value Masking key, the first key byte in the most
+ *        significant bits.
+ * @param offset Position of @p src in the frame payload, selects the key
+ *        byte applied to the first byte.
+ */
+void websocket_mask_payload(uint8_t *dst, const uint8_t *src, size_t len,
+			    uint32_t masking_value, size_t offset);
+
 /**
  * @brief Disconnect the Websocket.
  *
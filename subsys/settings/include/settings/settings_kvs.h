@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef __SETTINGS_KVS_H_
+#define __SETTINGS_KVS_H_
+
+#include <zephyr/fs/kvs.h>
+#include <zephyr/settings/settings.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* In the KVS backend, each setting is stored in a single KVS entry, whose
+ * key is the setting's name, without a trailing \0, and whose data is the
+ * setting's value. A setting is deleted by deleting its entry.
+ */
+struct settings_kvs {
+	struct settings_store cf_store;
+	struct kvs_fs cf_kvs;
+	const struct device *flash_dev;
+};
+
+/* register kvs to be a source of settings */
+int settings_kvs_src(struct settings_kvs *cf);
+
+/* register kvs to be the destination of settings */
+int settings_kvs_dst(struct settings_kvs *cf);
+
+/* Initialize a kvs backend. */
+int settings_kvs_backend_init(struct settings_kvs *cf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* __SETTINGS_KVS_H_ */
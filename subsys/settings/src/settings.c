@@ -27,11 +27,134 @@ K_MUTEX_DEFINE(settings_lock);
 
 void settings_store_init(void);
 
+#if defined(CONFIG_SETTINGS_HANDLER_TRIE)
+/* Prefix trie of the static handler names, one node per name component.
+ * Node 0 is the root, 0 also marks the end of the child and sibling lists.
+ */
+struct settings_trie_node {
+	const char *name;	/* Name component, not terminated */
+	uint16_t len;
+	uint16_t child;		/* First child */
+	uint16_t sibling;	/* Next sibling */
+	uint16_t handler;	/* Static handler index + 1, 0 if none */
+};
+
+static struct settings_trie_node settings_trie[CONFIG_SETTINGS_HANDLER_TRIE_SIZE + 1];
+static uint16_t settings_trie_used;
+static bool settings_trie_ready;
+
+static uint16_t settings_trie_child(uint16_t node, const char *name, size_t len)
+{
+	uint16_t child;
+
+	for (child = settings_trie[node].child; child != 0;
+	     child = settings_trie[child].sibling) {
+		if ((settings_trie[child].len == len) &&
+		    (strncmp(settings_trie[child].name, name, len) == 0)) {
+			break;
+		}
+	}
+
+	return child;
+}
+
+static int settings_trie_insert(const char *name, uint16_t handler)
+{
+	uint16_t node = 0;
+	uint16_t child;
+	const char *next;
+	size_t len;
+
+	do {
+		len = settings_name_next(name, &next);
+
+		child = settings_trie_child(node, name, len);
+		if (child == 0) {
+			if (settings_trie_used == CONFIG_SETTINGS_HANDLER_TRIE_SIZE) {
+				return -ENOMEM;
+			}
+
+			child = ++settings_trie_used;
+			settings_trie[child] = (struct settings_trie_node) {
+				.name = name,
+				.len = len,
+				.sibling = settings_trie[node].child,
+			};
+			settings_trie[node].child = child;
+		}
+
+		node = child;
+		name = next;
+	} while (name);
+
+	settings_trie[node].handler = handler + 1;
+
+	return 0;
+}
+
+static void settings_trie_build(void)
+{
+	struct settings_handler_static *ch;
+	int count;
+
+	settings_trie_ready = false;
+	settings_trie_used = 0;
+	settings_trie[0].child = 0;
+
+	STRUCT_SECTION_COUNT(settings_handler_static, &count);
+
+	for (int i = 0; i < count; i++) {
+		STRUCT_SECTION_GET(settings_handler_static, i, &ch);
+
+		if (settings_trie_insert(ch->name, i) != 0) {
+			LOG_WRN("Handler trie too small, looking handlers up by name");
+			return;
+		}
+	}
+
+	settings_trie_ready = true;
+}
+
+/* Find the static handler with the longest name matching name */
+static struct settings_handler_static *settings_trie_lookup(const char *name,
+							    const char **next)
+{
+	struct settings_handler_static *bestmatch = NULL;
+	uint16_t node = 0;
+	const char *tmpnext;
+	size_t len;
+
+	while (name) {
+		len = settings_name_next(name, &tmpnext);
+
+		node = settings_trie_child(node, name, len);
+		if (node == 0) {
+			break;
+		}
+
+		if (settings_trie[node].handler != 0) {
+			STRUCT_SECTION_GET(settings_handler_static,
+					   settings_trie[node].handler - 1, &bestmatch);
+			if (next) {
+				*next = tmpnext;
+			}
+		}
+
+		name = tmpnext;
+	}
+
+	return bestmatch;
+}
+#endif /* CONFIG_SETTINGS_HANDLER_TRIE */
+
 void settings_init(void)
 {
 #if defined(CONFIG_SETTINGS_DYNAMIC_HANDLERS)
 	sys_slist_init(&settings_handlers);
 #endif /* CONFIG_SETTINGS_DYNAMIC_HANDLERS */
+#if defined(CONFIG_SETTINGS_HANDLER_TRIE)
+	settings_trie_build();
+#endif /* CONFIG_SETTINGS_HANDLER_TRIE */
 	settings_store_init();
 }
 
@@ -134,17 +257,13 @@ int settings_name_next(const char *name, const char **next)
 	return rc;
 }
 
-struct settings_handler_static *settings_parse_and_lookup(const char *name,
-							const char **next)
+/* Find the static handler with the longest name matching name */
+static struct settings_handler_static *settings_static_lookup(const char *name,
+							      const char **next)
 {
-	struct settings_handler_static *bestmatch;
+	struct settings_handler_static *bestmatch = NULL;
 	const char *tmpnext;
 
-	bestmatch = NULL;
-	if (next) {
-		*next = NULL;
-	}
-
 	STRUCT_SECTION_FOREACH(settings_handler_static, ch) {
 		if (!settings_name_steq(name, ch->name, &tmpnext)) {
 			continue;
@@ -164,8 +283,31 @@ struct settings_handler_static *settings_parse_and_lookup(const char *name,
 		}
 	}
 
+	return bestmatch;
+}
+
+struct settings_handler_static *settings_parse_and_lookup(const char *name,
+							const char **next)
+{
+	struct settings_handler_static *bestmatch;
+
+	if (next) {
+		*next = NULL;
+	}
+
+#if defined(CONFIG_SETTINGS_HANDLER_TRIE)
+	if (settings_trie_ready) {
+		bestmatch = settings_trie_lookup(name, next);
+	} else {
+		bestmatch = settings_static_lookup(name, next);
+	}
+#else
+	bestmatch = settings_static_lookup(name, next);
+#endif /* CONFIG_SETTINGS_HANDLER_TRIE */
+
 #if defined(CONFIG_SETTINGS_DYNAMIC_HANDLERS)
 	struct settings_handler *ch;
+	const char *tmpnext;
 
 	SYS_SLIST_FOR_EACH_CONTAINER(&settings_handlers, ch, node) {
 		if (!settings_name_steq(name, ch->name, &tmpnext)) {
@@ -189,6 +331,12 @@ struct settings_handler_static *settings_parse_and_lookup(const char *name,
 	return bestmatch;
 }
 
+bool settings_load_skip(const char *name, const struct settings_load_arg *load_arg)
+{
+	return load_arg && load_arg->subtree &&
+	       !settings_name_steq(name, load_arg->subtree, NULL);
+}
+
 int settings_call_set_handler(const char *name,
 			      size_t len,
 			      settings_read_cb read_cb,
@@ -146,6 +146,7 @@ static int read_entry_len(const struct fcb_entry_ctx *entry_ctx, off_t off)
 static int settings_fcb_load_priv(struct settings_store *cs,
 				  line_load_cb cb,
 				  void *cb_arg,
+				  const struct settings_load_arg *load_arg,
 				  bool filter_duplicates)
 {
 	struct settings_fcb *cf = CONTAINER_OF(cs, struct settings_fcb, cf_store);
@@ -169,9 +170,14 @@ static int settings_fcb_load_priv(struct settings_store *cs,
 		}
 		name[name_len] = '\0';
 
-		if (filter_duplicates &&
-		    (!read_entry_len(&entry_ctx, name_len+1) ||
-		     settings_fcb_check_duplicate(cf, &entry_ctx, name))) {
+		/* Skip settings outside of the loaded subtree before looking
+		 * for their duplicates.
+		 */
+		if (settings_load_skip(name, load_arg)) {
+			pass_entry = false;
+		} else if (filter_duplicates &&
+			   (!read_entry_len(&entry_ctx, name_len+1) ||
+			    settings_fcb_check_duplicate(cf, &entry_ctx, name))) {
 			pass_entry = false;
 		}
 		/*name, val-read_cb-ctx, val-off*/
@@ -193,6 +199,7 @@ static int settings_fcb_load(struct settings_store *cs,
 		cs,
 		settings_line_load_cb,
 		(void *)arg,
+		arg,
 		true);
 }
 
@@ -380,7 +387,7 @@ static int settings_fcb_save(struct settings_store *cs, const char *name,
 	cdca.val = (char *)value;
 	cdca.is_dup = 0;
 	cdca.val_len = val_len;
-	settings_fcb_load_priv(cs, settings_line_dup_check_cb, &cdca, false);
+	settings_fcb_load_priv(cs, settings_line_dup_check_cb, &cdca, NULL, false);
 	if (cdca.is_dup == 1) {
 		return 0;
 	}
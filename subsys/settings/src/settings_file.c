@@ -117,7 +117,8 @@ static int read_entry_len(const struct line_entry_ctx *entry_ctx, off_t off)
 }
 
 static int settings_file_load_priv(struct settings_store *cs, line_load_cb cb,
-				   void *cb_arg, bool filter_duplicates)
+				   void *cb_arg, const struct settings_load_arg *load_arg,
+				   bool filter_duplicates)
 {
 	struct settings_file *cf = CONTAINER_OF(cs, struct settings_file, cf_store);
 	struct fs_file_t file;
@@ -161,9 +162,14 @@ static int settings_file_load_priv(struct settings_store *cs, line_load_cb cb,
 		}
 		name[name_len] = '\0';
 
-		if (filter_duplicates &&
-		    (!read_entry_len(&entry_ctx, name_len+1) ||
-		     settings_file_check_duplicate(&entry_ctx, name))) {
+		/* Skip settings outside of the loaded subtree before looking
+		 * for their duplicates.
+		 */
+		if (settings_load_skip(name, load_arg)) {
+			pass_entry = false;
+		} else if (filter_duplicates &&
+			   (!read_entry_len(&entry_ctx, name_len+1) ||
+			    settings_file_check_duplicate(&entry_ctx, name))) {
 			pass_entry = false;
 		}
 		/*name, val-read_cb-ctx, val-off*/
@@ -189,6 +195,7 @@ static int settings_file_load(struct settings_store *cs,
 	return settings_file_load_priv(cs,
 				       settings_line_load_cb,
 				       (void *)arg,
+				       arg,
 				       true);
 }
 
@@ -441,7 +448,7 @@ static int settings_file_save(struct settings_store *cs, const char *name,
 	cdca.val = (char *)value;
 	cdca.is_dup = 0;
 	cdca.val_len = val_len;
-	settings_file_load_priv(cs, settings_line_dup_check_cb, &cdca, false);
+	settings_file_load_priv(cs, settings_line_dup_check_cb, &cdca, NULL, false);
 	if (cdca.is_dup == 1) {
 		return 0;
 	}
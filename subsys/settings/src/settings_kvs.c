@@ -0,0 +1,221 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/settings/settings.h>
+#include "settings/settings_kvs.h"
+#include "settings_priv.h"
+#include <zephyr/storage/flash_map.h>
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_DECLARE(settings, CONFIG_SETTINGS_LOG_LEVEL);
+
+#if DT_HAS_CHOSEN(zephyr_settings_partition)
+#define SETTINGS_PARTITION DT_FIXED_PARTITION_ID(DT_CHOSEN(zephyr_settings_partition))
+#else
+#define SETTINGS_PARTITION FIXED_PARTITION_ID(storage_partition)
+#endif
+
+struct settings_kvs_read_fn_arg {
+	struct settings_kvs *cf;
+	const char *name;
+	size_t name_len;
+	uint32_t addr;
+};
+
+struct settings_kvs_load_arg {
+	struct settings_kvs *cf;
+	const struct settings_load_arg *arg;
+};
+
+static int settings_kvs_load(struct settings_store *cs,
+			     const struct settings_load_arg *arg);
+static int settings_kvs_save(struct settings_store *cs, const char *name,
+			     const char *value, size_t val_len);
+static void *settings_kvs_storage_get(struct settings_store *cs);
+
+static struct settings_store_itf settings_kvs_itf = {
+	.csi_load = settings_kvs_load,
+	.csi_save = settings_kvs_save,
+	.csi_storage_get = settings_kvs_storage_get
+};
+
+static ssize_t settings_kvs_read_fn(void *back_end, void *data, size_t len)
+{
+	struct settings_kvs_read_fn_arg *rd_fn_arg;
+	ssize_t rc;
+
+	rd_fn_arg = (struct settings_kvs_read_fn_arg *)back_end;
+
+	rc = kvs_read_addr(&rd_fn_arg->cf->cf_kvs, rd_fn_arg->name, rd_fn_arg->name_len,
+			   rd_fn_arg->addr, data, len);
+	if (rc > (ssize_t)len) {
+		/* kvs_read_addr signals that not all bytes were read
+		 * align read len to what was requested
+		 */
+		rc = len;
+	}
+	return rc;
+}
+
+int settings_kvs_src(struct settings_kvs *cf)
+{
+	cf->cf_store.cs_itf = &settings_kvs_itf;
+	settings_src_register(&cf->cf_store);
+
+	return 0;
+}
+
+int settings_kvs_dst(struct settings_kvs *cf)
+{
+	cf->cf_store.cs_itf = &settings_kvs_itf;
+	settings_dst_register(&cf->cf_store);
+
+	return 0;
+}
+
+static int settings_kvs_load_entry(const void *key, size_t key_len, uint32_t addr, size_t len,
+				   void *param)
+{
+	struct settings_kvs_load_arg *load_arg = (struct settings_kvs_load_arg *)param;
+	struct settings_kvs_read_fn_arg read_fn_arg;
+	const char *name = (const char *)key;
+
+	/* kvs_walk() terminates the keys, they can be used as names */
+	if ((key_len != strlen(name)) || settings_load_skip(name, load_arg->arg)) {
+		return 0;
+	}
+
+	/* The entry can move before it is read, the name is kept to look it
+	 * up again then.
+	 */
+	read_fn_arg.cf = load_arg->cf;
+	read_fn_arg.name = name;
+	read_fn_arg.name_len = key_len;
+	read_fn_arg.addr = addr;
+
+	return settings_call_set_handler(name, len, settings_kvs_read_fn, &read_fn_arg,
+					 (void *)load_arg->arg);
+}
+
+static int settings_kvs_load(struct settings_store *cs,
+			     const struct settings_load_arg *arg)
+{
+	struct settings_kvs *cf = CONTAINER_OF(cs, struct settings_kvs, cf_store);
+	struct settings_kvs_load_arg load_arg = {
+		.cf = cf,
+		.arg = arg,
+	};
+
+	/* The values are only read by the handlers of the settings loaded,
+	 * the walk itself only reads the names.
+	 */
+	return kvs_walk(&cf->cf_kvs, settings_kvs_load_entry, &load_arg);
+}
+
+static int settings_kvs_save(struct settings_store *cs, const char *name,
+			     const char *value, size_t val_len)
+{
+	struct settings_kvs *cf = CONTAINER_OF(cs, struct settings_kvs, cf_store);
+	ssize_t rc;
+
+	if (!name) {
+		return -EINVAL;
+	}
+
+	if (!value || !val_len) {
+		return kvs_delete(&cf->cf_kvs, name, strlen(name));
+	}
+
+	rc = kvs_write(&cf->cf_kvs, name, strlen(name), value, val_len);
+	if (rc < 0) {
+		return rc;
+	}
+
+	return 0;
+}
+
+/* Initialize the kvs backend. */
+int settings_kvs_backend_init(struct settings_kvs *cf)
+{
+	int rc;
+
+	cf->cf_kvs.flash_device = cf->flash_dev;
+	if (cf->cf_kvs.flash_device == NULL) {
+		return -ENODEV;
+	}
+
+	rc = kvs_mount(&cf->cf_kvs);
+	if (rc) {
+		return rc;
+	}
+
+	LOG_DBG("Initialized");
+	return 0;
+}
+
+int settings_backend_init(void)
+{
+	static struct settings_kvs default_settings_kvs;
+	int rc;
+	uint16_t cnt = 0;
+	size_t kvs_sector_size, kvs_size = 0;
+	const struct flash_area *fa;
+	struct flash_sector hw_flash_sector;
+	uint32_t sector_cnt = 1;
+
+	rc = flash_area_open(SETTINGS_PARTITION, &fa);
+	if (rc) {
+		return rc;
+	}
+
+	rc = flash_area_get_sectors(SETTINGS_PARTITION, &sector_cnt,
+				    &hw_flash_sector);
+	if (rc != 0 && rc != -ENOMEM) {
+		return rc;
+	}
+
+	kvs_sector_size = CONFIG_SETTINGS_KVS_SECTOR_SIZE_MULT *
+			  hw_flash_sector.fs_size;
+
+	while (cnt < CONFIG_SETTINGS_KVS_SECTOR_COUNT) {
+		kvs_size += kvs_sector_size;
+		if (kvs_size > fa->fa_size) {
+			break;
+		}
+		cnt++;
+	}
+
+	/* define the kvs file system using the page_info */
+	default_settings_kvs.cf_kvs.sector_size = kvs_sector_size;
+	default_settings_kvs.cf_kvs.sector_count = cnt;
+	default_settings_kvs.cf_kvs.offset = fa->fa_off;
+	default_settings_kvs.flash_dev = fa->fa_dev;
+
+	rc = settings_kvs_backend_init(&default_settings_kvs);
+	if (rc) {
+		return rc;
+	}
+
+	rc = settings_kvs_src(&default_settings_kvs);
+
+	if (rc) {
+		return rc;
+	}
+
+	rc = settings_kvs_dst(&default_settings_kvs);
+
+	return rc;
+}
+
+static void *settings_kvs_storage_get(struct settings_store *cs)
+{
+	struct settings_kvs *cf = CONTAINER_OF(cs, struct settings_kvs, cf_store);
+
+	return &cf->cf_kvs;
+}
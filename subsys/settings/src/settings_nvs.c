@@ -24,7 +24,7 @@ LOG_MODULE_DECLARE(settings, CONFIG_SETTINGS_LOG_LEVEL);
 #endif
 
 struct settings_nvs_read_fn_arg {
-	struct nvs_fs *fs;
+	struct settings_nvs *cf;
 	uint16_t id;
 };
 
@@ -40,6 +40,115 @@ static struct settings_store_itf settings_nvs_itf = {
 	.csi_storage_get = settings_nvs_storage_get
 };
 
+#if CONFIG_SETTINGS_NVS_LOAD_INDEX_SIZE
+#define SETTINGS_NVS_INDEX_NONE 0xFFFFFFFF
+#define SETTINGS_NVS_INDEX_DELETED 0xFFFFFFFE
+
+/* NVS addresses of the name and value entries of a range of name IDs, found
+ * by a single walk of the NVS allocation table. Only used while loading,
+ * under the settings lock. Saving a setting invalidates the index, entries
+ * moved by the NVS garbage collection are looked up again when read.
+ */
+static struct {
+	struct settings_nvs *cf;
+	uint16_t first_id;
+	uint16_t count;
+	uint32_t name[CONFIG_SETTINGS_NVS_LOAD_INDEX_SIZE];
+	uint32_t value[CONFIG_SETTINGS_NVS_LOAD_INDEX_SIZE];
+} settings_nvs_index;
+
+static bool settings_nvs_index_covers(struct settings_nvs *cf, uint16_t name_id)
+{
+	return (settings_nvs_index.cf == cf) &&
+	       (name_id >= settings_nvs_index.first_id) &&
+	       (name_id < settings_nvs_index.first_id + settings_nvs_index.count);
+}
+
+static int settings_nvs_index_add(uint16_t id, uint32_t addr, size_t len, void *param)
+{
+	uint32_t *entry;
+
+	ARG_UNUSED(param);
+
+	if (id > NVS_NAMECNT_ID + NVS_NAME_ID_OFFSET) {
+		id -= NVS_NAME_ID_OFFSET;
+		entry = settings_nvs_index.value;
+	} else {
+		entry = settings_nvs_index.name;
+	}
+
+	if ((id < settings_nvs_index.first_id) ||
+	    (id >= settings_nvs_index.first_id + settings_nvs_index.count)) {
+		return 0;
+	}
+
+	/* Entries are walked from the newest, older ones are superseded */
+	entry = &entry[id - settings_nvs_index.first_id];
+	if (*entry == SETTINGS_NVS_INDEX_NONE) {
+		*entry = (len > 0) ? addr : SETTINGS_NVS_INDEX_DELETED;
+	}
+
+	return 0;
+}
+
+/* Index the name IDs up to last_id, down to as many as fit in the index. */
+static int settings_nvs_index_build(struct settings_nvs *cf, uint16_t last_id)
+{
+	int rc;
+
+	settings_nvs_index.count = MIN(last_id - NVS_NAMECNT_ID,
+				       CONFIG_SETTINGS_NVS_LOAD_INDEX_SIZE);
+	settings_nvs_index.first_id = last_id + 1 - settings_nvs_index.count;
+	memset(settings_nvs_index.name, 0xff, sizeof(settings_nvs_index.name));
+	memset(settings_nvs_index.value, 0xff, sizeof(settings_nvs_index.value));
+
+	rc = nvs_walk(&cf->cf_nvs, settings_nvs_index_add, NULL);
+	if (rc) {
+		settings_nvs_index.cf = NULL;
+		return rc;
+	}
+
+	settings_nvs_index.cf = cf;
+
+	return 0;
+}
+#endif /* CONFIG_SETTINGS_NVS_LOAD_INDEX_SIZE */
+
+/* Read a name or value entry, from its indexed address if there is one */
+static ssize_t settings_nvs_read(struct settings_nvs *cf, uint16_t id, void *data, size_t len)
+{
+#if CONFIG_SETTINGS_NVS_LOAD_INDEX_SIZE
+	uint16_t name_id = id;
+	uint32_t addr;
+	ssize_t rc;
+
+	if (id > NVS_NAMECNT_ID + NVS_NAME_ID_OFFSET) {
+		name_id -= NVS_NAME_ID_OFFSET;
+	}
+
+	if (settings_nvs_index_covers(cf, name_id)) {
+		if (name_id == id) {
+			addr = settings_nvs_index.name[name_id - settings_nvs_index.first_id];
+		} else {
+			addr = settings_nvs_index.value[name_id - settings_nvs_index.first_id];
+		}
+
+		if ((addr == SETTINGS_NVS_INDEX_NONE) || (addr == SETTINGS_NVS_INDEX_DELETED)) {
+			return -ENOENT;
+		}
+
+		rc = nvs_read_addr(&cf->cf_nvs, id, addr, data, len);
+		if (rc != -ENOENT) {
+			return rc;
+		}
+
+		/* The entry was moved by the garbage collection, look it up */
+	}
+#endif
+
+	return nvs_read(&cf->cf_nvs, id, data, len);
+}
+
 static ssize_t settings_nvs_read_fn(void *back_end, void *data, size_t len)
 {
 	struct settings_nvs_read_fn_arg *rd_fn_arg;
@@ -47,7 +156,7 @@ static ssize_t settings_nvs_read_fn(void *back_end, void *data, size_t len)
 
 	rd_fn_arg = (struct settings_nvs_read_fn_arg *)back_end;
 
-	rc = nvs_read(rd_fn_arg->fs, rd_fn_arg->id, data, len);
+	rc = settings_nvs_read(rd_fn_arg->cf, rd_fn_arg->id, data, len);
 	if (rc > (ssize_t)len) {
 		/* nvs_read signals that not all bytes were read
 		 * align read len to what was requested
@@ -150,13 +259,39 @@ static int settings_nvs_load(struct settings_store *cs,
 			break;
 		}
 
+#if CONFIG_SETTINGS_NVS_LOAD_INDEX_SIZE
+		/* Locate the entries of the next name IDs in a single walk,
+		 * rather than walking NVS for each of them. The index is
+		 * rebuilt if a setting was saved meanwhile.
+		 */
+		if (!settings_nvs_index_covers(cf, name_id)) {
+			(void)settings_nvs_index_build(cf, name_id);
+		}
+#endif
+
 		/* In the NVS backend, each setting item is stored in two NVS
 		 * entries one for the setting's name and one with the
 		 * setting's value.
 		 */
-		rc1 = nvs_read(&cf->cf_nvs, name_id, &name, sizeof(name));
-		rc2 = nvs_read(&cf->cf_nvs, name_id + NVS_NAME_ID_OFFSET,
-			       &buf, sizeof(buf));
+		rc1 = settings_nvs_read(cf, name_id, &name, sizeof(name));
+		if (rc1 > 0) {
+			/* Found a name, this might not include a trailing \0 */
+			name[rc1] = '\0';
+
+			/* Don't read the value of settings outside of the
+			 * loaded subtree.
+			 */
+			if (settings_load_skip(name, arg)) {
+#if CONFIG_SETTINGS_NVS_NAME_CACHE
+				settings_nvs_cache_add(cf, name, name_id);
+				cached++;
+#endif
+				continue;
+			}
+		}
+
+		rc2 = settings_nvs_read(cf, name_id + NVS_NAME_ID_OFFSET,
+					&buf, sizeof(buf));
 
 		if ((rc1 <= 0) && (rc2 <= 0)) {
 			/* Settings largest ID in use is invalid due to
@@ -191,9 +326,7 @@ static int settings_nvs_load(struct settings_store *cs,
 			continue;
 		}
 
-		/* Found a name, this might not include a trailing \0 */
-		name[rc1] = '\0';
-		read_fn_arg.fs = &cf->cf_nvs;
+		read_fn_arg.cf = cf;
 		read_fn_arg.id = name_id + NVS_NAME_ID_OFFSET;
 
 #if CONFIG_SETTINGS_NVS_NAME_CACHE
@@ -225,6 +358,11 @@ static int settings_nvs_save(struct settings_store *cs, const char *name,
 		return -EINVAL;
 	}
 
+#if CONFIG_SETTINGS_NVS_LOAD_INDEX_SIZE
+	/* The index no longer holds the latest entries of the name IDs */
+	settings_nvs_index.cf = NULL;
+#endif
+
 	/* Find out if we are doing a delete */
 	delete = ((value == NULL) || (val_len == 0));
 
@@ -107,6 +107,19 @@ void settings_line_io_init(int (*read_cb)(void *ctx, off_t off, char *buf,
 			  uint8_t io_rwbs);
 
 
+/**
+ * Check whether loading skips a setting.
+ *
+ * Lets backends skip the settings outside of the subtree being loaded before
+ * reading their value or looking for their duplicates.
+ *
+ * @param name name of the setting
+ * @param load_arg arguments of the load, can be NULL
+ *
+ * @retval true if the setting is outside of the loaded subtree
+ */
+bool settings_load_skip(const char *name, const struct settings_load_arg *load_arg);
+
 extern sys_slist_t settings_load_srcs;
 extern sys_slist_t settings_handlers;
 extern struct settings_store *settings_save_dst;
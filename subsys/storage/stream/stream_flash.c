@@ -13,6 +13,8 @@ LOG_MODULE_REGISTER(LOG_MODULE_NAME, CONFIG_STREAM_FLASH_LOG_LEVEL);
 #include <zephyr/types.h>
 #include <string.h>
 #include <zephyr/drivers/flash.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
 
 #include <zephyr/storage/stream_flash.h>
 
@@ -104,23 +106,19 @@ int stream_flash_erase_page(struct stream_flash_ctx *ctx, off_t off)
 
 #endif /* CONFIG_STREAM_FLASH_ERASE */
 
-static int flash_sync(struct stream_flash_ctx *ctx)
+/* Erases, writes and verifies @p len bytes of @p buf at @p write_addr */
+static int flash_program(struct stream_flash_ctx *ctx, uint8_t *buf, size_t len,
+			 size_t write_addr)
 {
 	int rc = 0;
-	size_t write_addr = ctx->offset + ctx->bytes_written;
 	size_t buf_bytes_aligned;
 	size_t fill_length;
 	uint8_t filler;
 
-
-	if (ctx->buf_bytes == 0) {
-		return 0;
-	}
-
 	if (IS_ENABLED(CONFIG_STREAM_FLASH_ERASE)) {
 
 		rc = stream_flash_erase_page(ctx,
-					     write_addr + ctx->buf_bytes - 1);
+					     write_addr + len - 1);
 		if (rc < 0) {
 			LOG_ERR("stream_flash_erase_page err %d offset=0x%08zx",
 				rc, write_addr);
@@ -129,17 +127,17 @@ static int flash_sync(struct stream_flash_ctx *ctx)
 	}
 
 	fill_length = flash_get_write_block_size(ctx->fdev);
-	if (ctx->buf_bytes % fill_length) {
-		fill_length -= ctx->buf_bytes % fill_length;
+	if (len % fill_length) {
+		fill_length -= len % fill_length;
 		filler = flash_get_parameters(ctx->fdev)->erase_value;
 
-		memset(ctx->buf + ctx->buf_bytes, filler, fill_length);
+		memset(buf + len, filler, fill_length);
 	} else {
 		fill_length = 0;
 	}
 
-	buf_bytes_aligned = ctx->buf_bytes + fill_length;
-	rc = flash_write(ctx->fdev, write_addr, ctx->buf, buf_bytes_aligned);
+	buf_bytes_aligned = len + fill_length;
+	rc = flash_write(ctx->fdev, write_addr, buf, buf_bytes_aligned);
 
 	if (rc != 0) {
 		LOG_ERR("flash_write error %d offset=0x%08zx", rc,
@@ -151,30 +149,264 @@ static int flash_sync(struct stream_flash_ctx *ctx)
 		/* Invert to ensure that caller is able to discover a faulty
 		 * flash_read() even if no error code is returned.
 		 */
-		for (int i = 0; i < ctx->buf_bytes; i++) {
-			ctx->buf[i] = ~ctx->buf[i];
+		for (int i = 0; i < len; i++) {
+			buf[i] = ~buf[i];
 		}
 
-		rc = flash_read(ctx->fdev, write_addr, ctx->buf,
-				ctx->buf_bytes);
+		rc = flash_read(ctx->fdev, write_addr, buf, len);
 		if (rc != 0) {
 			LOG_ERR("flash read failed: %d", rc);
 			return rc;
 		}
 
-		rc = ctx->callback(ctx->buf, ctx->buf_bytes, write_addr);
+		rc = ctx->callback(buf, len, write_addr);
 		if (rc != 0) {
 			LOG_ERR("callback failed: %d", rc);
 			return rc;
 		}
 	}
 
+	return rc;
+}
+
+static int flash_sync(struct stream_flash_ctx *ctx)
+{
+	int rc;
+
+	if (ctx->buf_bytes == 0) {
+		return 0;
+	}
+
+	rc = flash_program(ctx, ctx->buf, ctx->buf_bytes,
+			   ctx->offset + ctx->bytes_written);
+	if (rc != 0) {
+		return rc;
+	}
+
 	ctx->bytes_written += ctx->buf_bytes;
 	ctx->buf_bytes = 0U;
 
 	return rc;
 }
 
+#ifdef CONFIG_STREAM_FLASH_ASYNC
+
+static K_THREAD_STACK_DEFINE(stream_flash_workq_stack, CONFIG_STREAM_FLASH_ASYNC_STACK_SIZE);
+static struct k_work_q stream_flash_workq;
+
+static void async_work_handler(struct k_work *work)
+{
+	struct stream_flash_ctx *ctx = CONTAINER_OF(work, struct stream_flash_ctx, async.work);
+	k_spinlock_key_t key;
+	size_t write_addr;
+	uint8_t *buf;
+	size_t len;
+	bool more;
+	int rc;
+
+	for (;;) {
+		key = k_spin_lock(&ctx->async.lock);
+		if (ctx->async.queued == 0 || ctx->async.error != 0) {
+			k_spin_unlock(&ctx->async.lock, key);
+			return;
+		}
+
+		/* Only the last queued buffer may be partially filled */
+		buf = ctx->async.bufs + ctx->async.next * ctx->buf_len;
+		len = MIN(ctx->async.queued, ctx->buf_len);
+		write_addr = ctx->offset + ctx->bytes_written;
+		k_spin_unlock(&ctx->async.lock, key);
+
+		rc = flash_program(ctx, buf, len, write_addr);
+
+		key = k_spin_lock(&ctx->async.lock);
+		if (rc == 0) {
+			ctx->bytes_written += len;
+			ctx->async.queued -= len;
+			ctx->async.next = (ctx->async.next + 1) % ctx->async.count;
+		} else {
+			ctx->async.error = rc;
+		}
+		more = rc == 0 && !(ctx->async.flushing && ctx->async.queued == 0);
+		k_spin_unlock(&ctx->async.lock, key);
+
+#ifdef CONFIG_STREAM_FLASH_ERASE
+		/* Erase the next page while the next buffer is being filled. A
+		 * failure is reported when the buffer is written.
+		 */
+		if (more && write_addr + len < ctx->offset + ctx->available) {
+			(void)stream_flash_erase_page(ctx, write_addr + len);
+		}
+#else
+		ARG_UNUSED(more);
+#endif
+
+		if (ctx->async.callback) {
+			ctx->async.callback(ctx, write_addr, len, rc);
+		}
+
+		k_sem_give(&ctx->async.done);
+	}
+}
+
+/* Queues the buffer being filled and moves to the next buffer */
+static void async_queue(struct stream_flash_ctx *ctx)
+{
+	k_spinlock_key_t key = k_spin_lock(&ctx->async.lock);
+
+	ctx->async.queued += ctx->buf_bytes;
+	k_spin_unlock(&ctx->async.lock, key);
+
+	k_work_submit_to_queue(&stream_flash_workq, &ctx->async.work);
+
+	ctx->async.fill = (ctx->async.fill + 1) % ctx->async.count;
+	ctx->buf = ctx->async.bufs + ctx->async.fill * ctx->buf_len;
+	ctx->buf_bytes = 0U;
+}
+
+/* Waits until at most @p max_queued buffers are queued */
+static int async_wait_queued(struct stream_flash_ctx *ctx, size_t max_queued)
+{
+	k_spinlock_key_t key;
+	size_t queued;
+	int rc;
+
+	for (;;) {
+		key = k_spin_lock(&ctx->async.lock);
+		queued = DIV_ROUND_UP(ctx->async.queued, ctx->buf_len);
+		rc = ctx->async.error;
+		k_spin_unlock(&ctx->async.lock, key);
+
+		if (rc != 0 || queued <= max_queued) {
+			break;
+		}
+
+		k_sem_take(&ctx->async.done, K_FOREVER);
+	}
+
+	return rc;
+}
+
+static int async_buffered_write(struct stream_flash_ctx *ctx, const uint8_t *data,
+				size_t len, bool flush)
+{
+	size_t processed = 0;
+	size_t buf_empty_bytes;
+	k_spinlock_key_t key;
+	int rc;
+
+	key = k_spin_lock(&ctx->async.lock);
+	rc = ctx->async.error;
+	if (rc == 0 && ctx->bytes_written + ctx->async.queued + ctx->buf_bytes + len >
+		       ctx->available) {
+		rc = -ENOMEM;
+	}
+	ctx->async.flushing = flush;
+	k_spin_unlock(&ctx->async.lock, key);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+	while ((len - processed) >=
+	       (buf_empty_bytes = ctx->buf_len - ctx->buf_bytes)) {
+		memcpy(ctx->buf + ctx->buf_bytes, data + processed,
+		       buf_empty_bytes);
+
+		ctx->buf_bytes = ctx->buf_len;
+		async_queue(ctx);
+		processed += buf_empty_bytes;
+
+		/* The buffer to fill next must have been written */
+		rc = async_wait_queued(ctx, ctx->async.count - 1);
+		if (rc != 0) {
+			return rc;
+		}
+	}
+
+	/* place rest of the data into ctx->buf */
+	if (processed < len) {
+		memcpy(ctx->buf + ctx->buf_bytes,
+		       data + processed, len - processed);
+		ctx->buf_bytes += len - processed;
+	}
+
+	if (flush) {
+		if (ctx->buf_bytes > 0) {
+			async_queue(ctx);
+		}
+
+		rc = stream_flash_async_wait(ctx);
+	}
+
+	return rc;
+}
+
+int stream_flash_async_enable(struct stream_flash_ctx *ctx, uint8_t *bufs, size_t count,
+			      stream_flash_async_callback_t cb)
+{
+	if (!ctx || !bufs) {
+		return -EFAULT;
+	}
+
+	if (count < 2) {
+		return -EINVAL;
+	}
+
+	if (ctx->buf_bytes != 0) {
+		return -EBUSY;
+	}
+
+	memset(&ctx->async, 0, sizeof(ctx->async));
+	ctx->async.bufs = bufs;
+	ctx->async.count = count;
+	ctx->async.callback = cb;
+	k_work_init(&ctx->async.work, async_work_handler);
+	k_sem_init(&ctx->async.done, 0, 1);
+
+	ctx->buf = bufs;
+
+	return 0;
+}
+
+int stream_flash_async_wait(struct stream_flash_ctx *ctx)
+{
+	struct k_work_sync sync;
+	int rc;
+
+	if (!ctx) {
+		return -EFAULT;
+	}
+
+	if (!ctx->async.bufs) {
+		return 0;
+	}
+
+	rc = async_wait_queued(ctx, 0);
+
+	/* Let the work item return, so that the context may be reused */
+	k_work_flush(&ctx->async.work, &sync);
+
+	return rc;
+}
+
+static int stream_flash_workq_init(void)
+{
+	const struct k_work_queue_config cfg = {
+		.name = "stream_flash",
+	};
+
+	k_work_queue_start(&stream_flash_workq, stream_flash_workq_stack,
+			   K_THREAD_STACK_SIZEOF(stream_flash_workq_stack),
+			   CONFIG_STREAM_FLASH_ASYNC_PRIORITY, &cfg);
+
+	return 0;
+}
+
+SYS_INIT(stream_flash_workq_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
+
+#endif /* CONFIG_STREAM_FLASH_ASYNC */
+
 int stream_flash_buffered_write(struct stream_flash_ctx *ctx, const uint8_t *data,
 				size_t len, bool flush)
 {
@@ -186,6 +418,12 @@ int stream_flash_buffered_write(struct stream_flash_ctx *ctx, const uint8_t *dat
 		return -EFAULT;
 	}
 
+#ifdef CONFIG_STREAM_FLASH_ASYNC
+	if (ctx->async.bufs) {
+		return async_buffered_write(ctx, data, len, flush);
+	}
+#endif
+
 	if (ctx->bytes_written + ctx->buf_bytes + len > ctx->available) {
 		return -ENOMEM;
 	}
@@ -299,6 +537,9 @@ int stream_flash_init(struct stream_flash_ctx *ctx, const struct device *fdev,
 #ifdef CONFIG_STREAM_FLASH_ERASE
 	ctx->last_erased_page_start_offset = -1;
 #endif
+#ifdef CONFIG_STREAM_FLASH_ASYNC
+	ctx->async.bufs = NULL;
+#endif
 
 	return 0;
 }
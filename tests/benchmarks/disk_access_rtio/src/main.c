@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Reads and writes a RAM disk one sector per submission through the RTIO disk
+ * I/O device, keeping one or several submissions in flight. The RAM disk
+ * completes each request from its submit operation, before the next one is
+ * started, so a deeper queue never has several requests in progress: the
+ * QD1 and QD8 runs only compare how many submissions get merged, not the
+ * overlap of requests a disk like NVMe would get. The number of disk requests
+ * the submissions were merged into is the figure to compare.
+ */
+
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <zephyr/rtio/rtio.h>
+#include <zephyr/storage/disk_access.h>
+#include <zephyr/storage/disk_access_rtio.h>
+
+#define DISK_NAME    "RAM"
+#define SECTOR_SIZE  DT_PROP(DT_NODELABEL(ramdisk0), sector_size)
+#define SECTOR_COUNT DT_PROP(DT_NODELABEL(ramdisk0), sector_count)
+
+RTIO_DEFINE(bench_rtio, 16, 16);
+DISK_ACCESS_RTIO_IODEV_DEFINE(disk_qd1, DISK_NAME, 1);
+DISK_ACCESS_RTIO_IODEV_DEFINE(disk_qd8, DISK_NAME, 8);
+
+static uint8_t wbuf[SECTOR_COUNT * SECTOR_SIZE] __aligned(4);
+static uint8_t rbuf[SECTOR_COUNT * SECTOR_SIZE] __aligned(4);
+
+static void *setup(void)
+{
+	int rc;
+
+	rc = disk_access_init(DISK_NAME);
+	zassert_ok(rc, "disk_access_init fail: %d", rc);
+
+	for (size_t i = 0; i < sizeof(wbuf); i++) {
+		wbuf[i] = (uint8_t)(i + i / SECTOR_SIZE);
+	}
+
+	return NULL;
+}
+
+/* Transfers the whole disk one sector per submission, @p depth at a time */
+static void transfer(const struct rtio_iodev *iodev, bool write, uint32_t depth)
+{
+	struct disk_access_rtio_data *data = iodev->data;
+	uint32_t submissions = data->submissions;
+	uint32_t requests = data->requests;
+	uint32_t submitted = 0;
+	uint32_t completed = 0;
+	struct rtio_sqe *sqe;
+	struct rtio_cqe *cqe;
+	uint64_t cycles;
+
+	cycles = k_cycle_get_64();
+
+	while (completed < SECTOR_COUNT) {
+		while ((submitted < SECTOR_COUNT) && (submitted - completed < depth)) {
+			sqe = rtio_sqe_acquire(&bench_rtio);
+			zassert_not_null(sqe, "no free submission");
+
+			if (write) {
+				disk_access_rtio_sqe_prep_write(sqe, iodev,
+								&wbuf[submitted * SECTOR_SIZE],
+								submitted, 1, NULL);
+			} else {
+				disk_access_rtio_sqe_prep_read(sqe, iodev,
+							       &rbuf[submitted * SECTOR_SIZE],
+							       submitted, 1, NULL);
+			}
+			submitted++;
+		}
+
+		rtio_submit(&bench_rtio, 0);
+
+		cqe = rtio_cqe_consume_block(&bench_rtio);
+		do {
+			zassert_ok(cqe->result, "disk submission fail: %d", cqe->result);
+			rtio_cqe_release(&bench_rtio, cqe);
+			completed++;
+		} while ((cqe = rtio_cqe_consume(&bench_rtio)) != NULL);
+	}
+
+	cycles = k_cycle_get_64() - cycles;
+	submissions = data->submissions - submissions;
+	requests = data->requests - requests;
+
+	zassert_equal(submissions, SECTOR_COUNT, "%u submissions, expected %u", submissions,
+		      SECTOR_COUNT);
+
+	TC_PRINT("%-5s depth %u: %8u us, %4u submissions in %4u disk requests\n",
+		 write ? "write" : "read", depth, (uint32_t)k_cyc_to_us_floor64(cycles),
+		 submissions, requests);
+}
+
+ZTEST(disk_access_rtio_bench, test_write_read)
+{
+	transfer(&disk_qd8, true, 8);
+
+	memset(rbuf, 0, sizeof(rbuf));
+	transfer(&disk_qd1, false, 1);
+	zassert_mem_equal(rbuf, wbuf, sizeof(wbuf), "data read at depth 1 differs");
+
+	memset(rbuf, 0, sizeof(rbuf));
+	transfer(&disk_qd8, false, 8);
+	zassert_mem_equal(rbuf, wbuf, sizeof(wbuf), "data read at depth 8 differs");
+}
+
+ZTEST(disk_access_rtio_bench, test_depth)
+{
+	TC_PRINT("Merge up to %d submissions\n", CONFIG_DISK_ACCESS_RTIO_MERGE_MAX);
+
+	transfer(&disk_qd1, true, 1);
+	transfer(&disk_qd8, true, 8);
+	transfer(&disk_qd1, false, 1);
+	transfer(&disk_qd8, false, 8);
+}
+
+ZTEST_SUITE(disk_access_rtio_bench, NULL, setup, NULL, NULL, NULL);
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Reopens, stats and reads the ends of files under a deep directory of an
+ * ext2 file system on a RAM disk, like a logger appending to several files
+ * does. On native_sim the RAM disk takes no time, so the number of sectors
+ * the file system read is the figure to compare with and without the ext2
+ * caches.
+ */
+
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/storage/disk_access.h>
+
+#define DISK_NAME  "RAM"
+#define MNT        "/ext"
+#define DIR        MNT "/var/log/app/device/session"
+#define FILES      4
+#define FILE_SIZE  (64 * 1024)
+#define READ_SIZE  64
+#define ITERATIONS 100
+
+static struct fs_mount_t mnt = {
+	.type = FS_EXT2,
+	.mnt_point = MNT,
+	.storage_dev = DISK_NAME,
+};
+
+static uint8_t buf[4096];
+
+static void file_path(char *path, size_t size, int i)
+{
+	snprintf(path, size, DIR "/log%d.txt", i);
+}
+
+static uint32_t sectors_read(void)
+{
+	struct disk_cache_stats stats;
+
+	zassert_ok(disk_access_cache_stats_get(DISK_NAME, &stats));
+	return stats.hits + stats.misses;
+}
+
+static void *setup(void)
+{
+	static const char *const dirs[] = {
+		MNT "/var", MNT "/var/log", MNT "/var/log/app", MNT "/var/log/app/device", DIR,
+	};
+	struct fs_statvfs stat;
+	struct fs_file_t file;
+	char path[64];
+	int rc;
+
+	/* The RAM disk starts blank */
+	rc = fs_mkfs(FS_EXT2, (uintptr_t)mnt.storage_dev, NULL, 0);
+	zassert_ok(rc, "mkfs fail: %d", rc);
+
+	mnt.flags = FS_MOUNT_FLAG_NO_FORMAT;
+	rc = fs_mount(&mnt);
+	zassert_ok(rc, "mount fail: %d", rc);
+
+	for (int i = 0; i < ARRAY_SIZE(dirs); i++) {
+		rc = fs_mkdir(dirs[i]);
+		zassert_ok(rc, "mkdir %s fail: %d", dirs[i], rc);
+	}
+
+	/* Write one file system block at a time */
+	rc = fs_statvfs(MNT, &stat);
+	zassert_ok(rc, "statvfs fail: %d", rc);
+	zassert_true(stat.f_bsize <= sizeof(buf), "block size %lu", stat.f_bsize);
+
+	for (int i = 0; i < FILES; i++) {
+		file_path(path, sizeof(path), i);
+		fs_file_t_init(&file);
+
+		rc = fs_open(&file, path, FS_O_CREATE | FS_O_WRITE);
+		zassert_ok(rc, "open %s fail: %d", path, rc);
+
+		for (size_t off = 0; off < FILE_SIZE; off += stat.f_bsize) {
+			memset(buf, 'a' + i, stat.f_bsize);
+			zassert_equal(fs_write(&file, buf, stat.f_bsize), stat.f_bsize, "write fail");
+		}
+
+		zassert_ok(fs_close(&file));
+	}
+
+	/* Start with nothing cached */
+	zassert_ok(fs_unmount(&mnt));
+	zassert_ok(fs_mount(&mnt));
+
+	return NULL;
+}
+
+static void teardown(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	fs_unmount(&mnt);
+}
+
+/* Runs @p op on all the files @p ITERATIONS times */
+static void measure(const char *name, void (*op)(const char *path, int i))
+{
+	uint32_t sectors = sectors_read();
+	uint64_t cycles;
+	char path[64];
+
+	cycles = k_cycle_get_64();
+
+	for (int n = 0; n < ITERATIONS; n++) {
+		for (int i = 0; i < FILES; i++) {
+			file_path(path, sizeof(path), i);
+			op(path, i);
+		}
+	}
+
+	cycles = k_cycle_get_64() - cycles;
+	sectors = sectors_read() - sectors;
+
+	TC_PRINT("%-9s %8u us, %6u sectors read, %3u.%02u sectors per operation\n", name,
+		 (uint32_t)k_cyc_to_us_floor64(cycles), sectors,
+		 sectors / (ITERATIONS * FILES), sectors * 100 / (ITERATIONS * FILES) % 100);
+}
+
+static void op_stat(const char *path, int i)
+{
+	struct fs_dirent entry;
+
+	zassert_ok(fs_stat(path, &entry), "stat %s fail", path);
+	zassert_equal(entry.size, FILE_SIZE);
+}
+
+static void op_open(const char *path, int i)
+{
+	struct fs_file_t file;
+
+	fs_file_t_init(&file);
+	zassert_ok(fs_open(&file, path, FS_O_READ), "open %s fail", path);
+	zassert_ok(fs_close(&file));
+}
+
+static void op_read(const char *path, int i)
+{
+	struct fs_file_t file;
+
+	fs_file_t_init(&file);
+	zassert_ok(fs_open(&file, path, FS_O_READ), "open %s fail", path);
+	zassert_ok(fs_seek(&file, FILE_SIZE - READ_SIZE, FS_SEEK_SET));
+	zassert_equal(fs_read(&file, buf, READ_SIZE), READ_SIZE, "read %s fail", path);
+	zassert_equal(buf[0], 'a' + i);
+	zassert_ok(fs_close(&file));
+}
+
+static void op_missing(const char *path, int i)
+{
+	struct fs_dirent entry;
+	char missing[64];
+
+	snprintf(missing, sizeof(missing), "%s.old", path);
+	zassert_equal(fs_stat(missing, &entry), -ENOENT, "stat %s", missing);
+}
+
+ZTEST(ext2_lookup_bench, test_lookup)
+{
+	TC_PRINT("Inode cache %s, directory entry cache %s, extent cache %s\n",
+		 IS_ENABLED(CONFIG_EXT2_INODE_CACHE) ? "on" : "off",
+		 IS_ENABLED(CONFIG_EXT2_DENTRY_CACHE) ? "on" : "off",
+		 IS_ENABLED(CONFIG_EXT2_EXTENT_CACHE) ? "on" : "off");
+
+	measure("stat", op_stat);
+	measure("open", op_open);
+	measure("read end", op_read);
+	measure("missing", op_missing);
+}
+
+ZTEST_SUITE(ext2_lookup_bench, NULL, setup, NULL, NULL, teardown);
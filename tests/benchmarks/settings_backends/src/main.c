@@ -0,0 +1,206 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Compares the settings backends storing to flash: the time taken to save,
+ * overwrite and load settings, and to mount the storage. The flash simulator
+ * simulates the time flash operations take, the number of flash operations
+ * is reported as well.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <zephyr/ztest.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/stats/stats.h>
+#include <zephyr/storage/flash_map.h>
+
+#if defined(CONFIG_SETTINGS_NVS)
+#include <zephyr/fs/nvs.h>
+#define BENCH_BACKEND "NVS"
+#elif defined(CONFIG_SETTINGS_FCB)
+#include <zephyr/fs/fcb.h>
+#define BENCH_BACKEND "FCB"
+#elif defined(CONFIG_SETTINGS_KVS)
+#include <zephyr/fs/kvs.h>
+#define BENCH_BACKEND "KVS"
+#else
+#error "Settings backend not selected"
+#endif
+
+#define BENCH_PARTITION storage_partition
+#define BENCH_SETTINGS 200
+#define BENCH_OVERWRITES 5
+
+static uint32_t *flash_read_calls;
+static uint32_t *flash_write_calls;
+static uint32_t *flash_erase_calls;
+
+static int loaded;
+static int bad_values;
+static uint32_t bench_round;
+
+static int bench_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+	uint32_t value;
+	int rc;
+
+	ARG_UNUSED(len);
+
+	rc = read_cb(cb_arg, &value, sizeof(value));
+	if ((rc != sizeof(value)) || (value != strtoul(name, NULL, 10) + bench_round)) {
+		bad_values++;
+	}
+
+	loaded++;
+
+	return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(bench, "bench", NULL, bench_set, NULL, NULL);
+
+static int flash_calls_find(struct stats_hdr *hdr, void *arg, const char *name, uint16_t off)
+{
+	ARG_UNUSED(arg);
+
+	if (!strcmp(name, "flash_read_calls")) {
+		flash_read_calls = (uint32_t *)((uint8_t *)hdr + off);
+	} else if (!strcmp(name, "flash_write_calls")) {
+		flash_write_calls = (uint32_t *)((uint8_t *)hdr + off);
+	} else if (!strcmp(name, "flash_erase_calls")) {
+		flash_erase_calls = (uint32_t *)((uint8_t *)hdr + off);
+	}
+
+	return 0;
+}
+
+struct measure {
+	uint64_t cycles;
+	uint32_t reads;
+	uint32_t writes;
+	uint32_t erases;
+};
+
+static void measure_start(struct measure *m)
+{
+	m->reads = *flash_read_calls;
+	m->writes = *flash_write_calls;
+	m->erases = *flash_erase_calls;
+	m->cycles = k_cycle_get_64();
+}
+
+static void measure_end(struct measure *m, const char *what)
+{
+	m->cycles = k_cycle_get_64() - m->cycles;
+
+	TC_PRINT("%s %-24s %9u us, %6u reads, %6u writes, %4u erases\n", BENCH_BACKEND, what,
+		 (uint32_t)k_cyc_to_us_floor64(m->cycles), *flash_read_calls - m->reads,
+		 *flash_write_calls - m->writes, *flash_erase_calls - m->erases);
+}
+
+static void *setup(void)
+{
+	const struct flash_area *fa;
+	struct stats_hdr *sim_stats;
+	int rc;
+
+	/* Start from an empty storage, the flash simulator may keep its content */
+	rc = flash_area_open(FIXED_PARTITION_ID(BENCH_PARTITION), &fa);
+	zassert_ok(rc, "flash_area_open() fail: %d", rc);
+	rc = flash_area_erase(fa, 0, fa->fa_size);
+	zassert_ok(rc, "flash_area_erase() fail: %d", rc);
+	flash_area_close(fa);
+
+	rc = settings_subsys_init();
+	zassert_ok(rc, "settings_subsys_init fail: %d", rc);
+
+	sim_stats = stats_group_find("flash_sim_stats");
+	zassert_not_null(sim_stats, "flash simulator statistics not found");
+	stats_walk(sim_stats, flash_calls_find, NULL);
+	zassert_not_null(flash_read_calls, "flash read statistic not found");
+	zassert_not_null(flash_write_calls, "flash write statistic not found");
+	zassert_not_null(flash_erase_calls, "flash erase statistic not found");
+
+	return NULL;
+}
+
+static void save_settings(uint32_t value_offset)
+{
+	char name[SETTINGS_MAX_NAME_LEN];
+	uint32_t value;
+	int rc;
+
+	for (int i = 0; i < BENCH_SETTINGS; i++) {
+		snprintf(name, sizeof(name), "bench/%u", i);
+		value = i + value_offset;
+
+		rc = settings_save_one(name, &value, sizeof(value));
+		zassert_ok(rc, "settings_save_one fail: %d", rc);
+	}
+}
+
+/* Mounts the storage of the backend again, as done at boot */
+static int storage_mount(void)
+{
+	void *storage;
+	int rc;
+
+	rc = settings_storage_get(&storage);
+	if (rc) {
+		return rc;
+	}
+
+#if defined(CONFIG_SETTINGS_NVS)
+	return nvs_mount((struct nvs_fs *)storage);
+#elif defined(CONFIG_SETTINGS_FCB)
+	return fcb_init(FIXED_PARTITION_ID(BENCH_PARTITION), (struct fcb *)storage);
+#elif defined(CONFIG_SETTINGS_KVS)
+	return kvs_mount((struct kvs_fs *)storage);
+#endif
+}
+
+ZTEST(settings_backends_bench, test_backend)
+{
+	char name[SETTINGS_MAX_NAME_LEN];
+	struct measure m;
+	int rc;
+
+	measure_start(&m);
+	save_settings(0);
+	measure_end(&m, "save " STRINGIFY(BENCH_SETTINGS));
+
+	measure_start(&m);
+	for (bench_round = 1; bench_round <= BENCH_OVERWRITES; bench_round++) {
+		save_settings(bench_round);
+	}
+	bench_round = BENCH_OVERWRITES;
+	measure_end(&m, "overwrite " STRINGIFY(BENCH_OVERWRITES) " times");
+
+	measure_start(&m);
+	rc = storage_mount();
+	measure_end(&m, "mount");
+	zassert_ok(rc, "mount fail: %d", rc);
+
+	loaded = 0;
+	bad_values = 0;
+	measure_start(&m);
+	rc = settings_load();
+	measure_end(&m, "load all");
+	zassert_ok(rc, "settings_load fail: %d", rc);
+	zassert_equal(loaded, BENCH_SETTINGS, "%d settings loaded", loaded);
+	zassert_equal(bad_values, 0, "%d settings loaded with a wrong value", bad_values);
+
+	snprintf(name, sizeof(name), "bench/%u", BENCH_SETTINGS / 2);
+	loaded = 0;
+	measure_start(&m);
+	rc = settings_load_subtree(name);
+	measure_end(&m, "load one");
+	zassert_ok(rc, "settings_load_subtree fail: %d", rc);
+	zassert_equal(loaded, 1, "%d settings loaded", loaded);
+	zassert_equal(bad_values, 0, "setting loaded with a wrong value");
+}
+
+ZTEST_SUITE(settings_backends_bench, NULL, setup, NULL, NULL, NULL);
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Measures how long settings_load() takes with the NVS backend as the number
+ * of stored settings grows. On native_sim the flash simulator takes no time,
+ * so the number of flash reads is the figure to compare.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <zephyr/ztest.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/stats/stats.h>
+#include <zephyr/storage/flash_map.h>
+
+#include "settings/settings_nvs.h"
+
+#define BENCH_PARTITION storage_partition
+
+void settings_init(void);
+
+static struct settings_nvs bench_nvs;
+static uint32_t *flash_read_calls;
+
+static int loaded;
+static int bad_values;
+
+static int bench_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+	uint32_t value;
+	int rc;
+
+	ARG_UNUSED(len);
+
+	rc = read_cb(cb_arg, &value, sizeof(value));
+	if ((rc != sizeof(value)) || (value != strtoul(name, NULL, 10))) {
+		bad_values++;
+	}
+
+	loaded++;
+
+	return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(bench, "bench", NULL, bench_set, NULL, NULL);
+
+static int flash_read_calls_find(struct stats_hdr *hdr, void *arg, const char *name,
+				 uint16_t off)
+{
+	if (!strcmp(name, "flash_read_calls")) {
+		*(uint32_t **)arg = (uint32_t *)((uint8_t *)hdr + off);
+	}
+
+	return 0;
+}
+
+static void *setup(void)
+{
+	const struct flash_area *fa;
+	struct flash_pages_info info;
+	struct stats_hdr *sim_stats;
+	int rc;
+
+	rc = flash_area_open(FIXED_PARTITION_ID(BENCH_PARTITION), &fa);
+	zassert_ok(rc, "flash_area_open() fail: %d", rc);
+
+	rc = flash_get_page_info_by_offs(flash_area_get_device(fa), fa->fa_off, &info);
+	zassert_ok(rc, "Unable to get page info: %d", rc);
+
+	bench_nvs.cf_nvs.offset = fa->fa_off;
+	bench_nvs.cf_nvs.sector_size = info.size;
+	bench_nvs.cf_nvs.sector_count = fa->fa_size / info.size;
+	bench_nvs.flash_dev = flash_area_get_device(fa);
+
+	/* Start from an empty storage, the flash simulator may keep its content */
+	rc = settings_nvs_backend_init(&bench_nvs);
+	zassert_ok(rc, "settings_nvs_backend_init fail: %d", rc);
+	rc = nvs_clear(&bench_nvs.cf_nvs);
+	zassert_ok(rc, "nvs_clear fail: %d", rc);
+	rc = settings_nvs_backend_init(&bench_nvs);
+	zassert_ok(rc, "settings_nvs_backend_init fail: %d", rc);
+
+	settings_init();
+	settings_nvs_src(&bench_nvs);
+	settings_nvs_dst(&bench_nvs);
+
+	sim_stats = stats_group_find("flash_sim_stats");
+	zassert_not_null(sim_stats, "flash simulator statistics not found");
+	stats_walk(sim_stats, flash_read_calls_find, &flash_read_calls);
+	zassert_not_null(flash_read_calls, "flash read statistic not found");
+
+	/* Fills the name cache so that saving doesn't look names up */
+	rc = settings_load();
+	zassert_ok(rc, "settings_load fail: %d", rc);
+
+	return NULL;
+}
+
+static void store_settings(int first, int count)
+{
+	char name[SETTINGS_MAX_NAME_LEN];
+	uint32_t value;
+	int rc;
+
+	for (int i = first; i < first + count; i++) {
+		snprintf(name, sizeof(name), "bench/%u", i);
+		value = i;
+
+		rc = settings_save_one(name, &value, sizeof(value));
+		zassert_ok(rc, "settings_save_one fail: %d", rc);
+	}
+}
+
+static void load_settings(int count)
+{
+	uint32_t reads;
+	uint64_t cycles;
+	int rc;
+
+	loaded = 0;
+	bad_values = 0;
+	reads = *flash_read_calls;
+	cycles = k_cycle_get_64();
+
+	rc = settings_load();
+
+	cycles = k_cycle_get_64() - cycles;
+	reads = *flash_read_calls - reads;
+
+	zassert_ok(rc, "settings_load fail: %d", rc);
+	zassert_equal(loaded, count, "%d settings loaded, expected %d", loaded, count);
+	zassert_equal(bad_values, 0, "%d settings loaded with a wrong value", bad_values);
+
+	TC_PRINT("%4d settings: load %8u us, %8u flash reads\n", count,
+		 (uint32_t)k_cyc_to_us_floor64(cycles), reads);
+}
+
+ZTEST(settings_load_bench, test_load)
+{
+	static const int counts[] = {100, 500, 1000};
+	int stored = 0;
+
+	TC_PRINT("NVS load index size %d\n", CONFIG_SETTINGS_NVS_LOAD_INDEX_SIZE);
+
+	for (int i = 0; i < ARRAY_SIZE(counts); i++) {
+		store_settings(stored, counts[i] - stored);
+		stored = counts[i];
+
+		load_settings(stored);
+	}
+}
+
+ZTEST_SUITE(settings_load_bench, NULL, setup, NULL, NULL, NULL);
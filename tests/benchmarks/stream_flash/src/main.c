@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * Streams an image to the second image slot of the simulated flash as an
+ * upload does: each chunk is written once the transport received it, which
+ * takes CHUNK_TIME_US. The flash simulator busy-waits for the program and
+ * erase times, so with a single buffer the transport waits for the flash,
+ * while with several buffers the flash is written as the next chunks arrive.
+ */
+
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/storage/stream_flash.h>
+
+#define SLOT_OFFSET   FIXED_PARTITION_OFFSET(slot1_partition)
+#define IMAGE_SIZE    (64 * 1024)
+#define CHUNK_SIZE    256
+#define CHUNK_TIME_US 500
+#define BUF_LEN       512
+#define MAX_BUF_COUNT 4
+
+static const struct device *const fdev = FIXED_PARTITION_DEVICE(slot1_partition);
+static struct stream_flash_ctx ctx;
+static uint8_t bufs[MAX_BUF_COUNT * BUF_LEN];
+static uint8_t image[IMAGE_SIZE];
+static uint8_t read_buf[BUF_LEN];
+
+static void *setup(void)
+{
+	zassert_true(device_is_ready(fdev), "flash device not ready");
+
+	for (size_t i = 0; i < sizeof(image); i++) {
+		image[i] = (uint8_t)(i * 7 + i / 256);
+	}
+
+	return NULL;
+}
+
+static void upload(size_t buf_count)
+{
+	uint32_t max_write_us = 0;
+	uint64_t start;
+	uint64_t cycles;
+	uint32_t us;
+	int rc;
+
+	/* Start from a programmed slot, so that all the pages are erased */
+	rc = flash_erase(fdev, SLOT_OFFSET, IMAGE_SIZE);
+	zassert_ok(rc, "erase fail: %d", rc);
+	rc = flash_write(fdev, SLOT_OFFSET, image, IMAGE_SIZE);
+	zassert_ok(rc, "write fail: %d", rc);
+
+	rc = stream_flash_init(&ctx, fdev, bufs, BUF_LEN, SLOT_OFFSET, IMAGE_SIZE, NULL);
+	zassert_ok(rc, "init fail: %d", rc);
+
+	if (buf_count > 1) {
+		rc = stream_flash_async_enable(&ctx, bufs, buf_count, NULL);
+		zassert_ok(rc, "async enable fail: %d", rc);
+	}
+
+	start = k_cycle_get_64();
+
+	for (size_t off = 0; off < IMAGE_SIZE; off += CHUNK_SIZE) {
+		k_usleep(CHUNK_TIME_US);
+
+		cycles = k_cycle_get_64();
+		rc = stream_flash_buffered_write(&ctx, &image[off], CHUNK_SIZE,
+						 off + CHUNK_SIZE == IMAGE_SIZE);
+		zassert_ok(rc, "write fail at %zu: %d", off, rc);
+		max_write_us = MAX(max_write_us,
+				   (uint32_t)k_cyc_to_us_floor64(k_cycle_get_64() - cycles));
+	}
+
+	us = (uint32_t)k_cyc_to_us_floor64(k_cycle_get_64() - start);
+
+	zassert_equal(stream_flash_bytes_written(&ctx), IMAGE_SIZE, "image not written");
+
+	for (size_t off = 0; off < IMAGE_SIZE; off += BUF_LEN) {
+		rc = flash_read(fdev, SLOT_OFFSET + off, read_buf, BUF_LEN);
+		zassert_ok(rc, "read fail: %d", rc);
+		zassert_mem_equal(read_buf, &image[off], BUF_LEN, "data differs at %zu", off);
+	}
+
+	TC_PRINT("%zu buffer(s): %8u us, %4u KiB/s, longest write %6u us\n", buf_count, us,
+		 (uint32_t)((uint64_t)IMAGE_SIZE * 1000000 / 1024 / us), max_write_us);
+}
+
+ZTEST(stream_flash_bench, test_upload)
+{
+	TC_PRINT("%u KiB in %u byte chunks received in %u us each\n", IMAGE_SIZE / 1024,
+		 CHUNK_SIZE, CHUNK_TIME_US);
+
+	upload(1);
+	upload(2);
+	upload(MAX_BUF_COUNT);
+}
+
+ZTEST_SUITE(stream_flash_bench, NULL, setup, NULL, NULL, NULL);
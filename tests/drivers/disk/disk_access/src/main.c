@@ -272,6 +272,97 @@ ZTEST(disk_driver, test_write)
 	}
 }
 
+#ifdef CONFIG_DISK_CACHE
+/* Sequential reads are served by the read ahead, writes stay cached until synced */
+ZTEST(disk_driver, test_cache)
+{
+	struct disk_cache_stats before, after;
+	uint32_t sector = disk_sector_count / 4;
+	int rc, i;
+
+	rc = disk_access_cache_stats_get(disk_pdrv, &before);
+	zassert_equal(rc, 0, "Failed to get cache statistics");
+
+	for (i = 0; i < SECTOR_COUNT3; i++) {
+		rc = read_sector(scratch_buf[0], sector + i, 1);
+		zassert_equal(rc, 0, "Failed to read sector %u", sector + i);
+	}
+
+	rc = disk_access_cache_stats_get(disk_pdrv, &after);
+	zassert_equal(rc, 0, "Failed to get cache statistics");
+	TC_PRINT("%u hits, %u misses, %u sectors read ahead\n", after.hits - before.hits,
+		 after.misses - before.misses, after.read_ahead - before.read_ahead);
+	zassert_equal((after.hits - before.hits) + (after.misses - before.misses), SECTOR_COUNT3,
+		      "Reads not accounted");
+	if (CONFIG_DISK_CACHE_READ_AHEAD > 0) {
+		zassert_true(after.read_ahead > before.read_ahead, "No sector read ahead");
+		zassert_true(after.hits - before.hits >= SECTOR_COUNT3 / 2,
+			     "Sequential reads missed the cache");
+	}
+
+	/* Reading a cached sector again is a hit */
+	rc = read_sector(scratch_buf[1], sector + SECTOR_COUNT3 - 1, 1);
+	zassert_equal(rc, 0, "Failed to read cached sector");
+	zassert_mem_equal(scratch_buf[0], scratch_buf[1], disk_sector_size,
+			  "Cached sector mismatch");
+	before = after;
+	rc = disk_access_cache_stats_get(disk_pdrv, &after);
+	zassert_equal(rc, 0, "Failed to get cache statistics");
+	zassert_equal(after.hits, before.hits + 1, "Cached sector not hit");
+
+	/* Written sectors are only written to the disk on sync */
+	rc = write_sector_checked(scratch_buf[0], scratch_buf[1], sector, SECTOR_COUNT2);
+	zassert_equal(rc, 0, "Failed to write sector %u", sector);
+
+	before = after;
+	rc = disk_access_cache_stats_get(disk_pdrv, &after);
+	zassert_equal(rc, 0, "Failed to get cache statistics");
+	zassert_true(after.dirty > 0, "Written sector not cached");
+	zassert_equal(after.write_backs, before.write_backs, "Sector written before sync");
+
+	rc = disk_access_ioctl(disk_pdrv, DISK_IOCTL_CTRL_SYNC, NULL);
+	zassert_equal(rc, 0, "Failed to sync disk");
+
+	before = after;
+	rc = disk_access_cache_stats_get(disk_pdrv, &after);
+	zassert_equal(rc, 0, "Failed to get cache statistics");
+	zassert_equal(after.dirty, 0, "Dirty sectors left after sync");
+	zassert_equal(after.write_backs, before.write_backs + before.dirty,
+		      "Dirty sectors not written on sync");
+}
+
+/* Initializing the disk again writes the dirty sectors and empties the cache */
+ZTEST(disk_driver, test_cache_reinit)
+{
+	struct disk_cache_stats before, after;
+	uint32_t sector = disk_sector_count / 2;
+	int rc;
+
+	rc = write_sector_checked(scratch_buf[0], scratch_buf[1], sector, SECTOR_COUNT2);
+	zassert_equal(rc, 0, "Failed to write sector %u", sector);
+
+	rc = disk_access_cache_stats_get(disk_pdrv, &before);
+	zassert_equal(rc, 0, "Failed to get cache statistics");
+	zassert_true(before.dirty > 0, "Written sector not cached");
+
+	rc = disk_access_init(disk_pdrv);
+	zassert_equal(rc, 0, "Failed to initialize disk");
+
+	rc = disk_access_cache_stats_get(disk_pdrv, &after);
+	zassert_equal(rc, 0, "Failed to get cache statistics");
+	zassert_equal(after.cached, 0, "Sectors left in the cache after init");
+	zassert_equal(after.write_backs, before.write_backs + before.dirty,
+		      "Dirty sectors not written on init");
+
+	/* The disk is probed again and still holds the written data */
+	memset(scratch_buf[1], 0, SECTOR_COUNT2 * disk_sector_size);
+	rc = read_sector(scratch_buf[1], sector, SECTOR_COUNT2);
+	zassert_equal(rc, 0, "Failed to read sector %u", sector);
+	zassert_mem_equal(scratch_buf[0], scratch_buf[1], SECTOR_COUNT2 * disk_sector_size,
+			  "Written sector lost on init");
+}
+#endif
+
 static void *disk_driver_setup(void)
 {
 #ifdef CONFIG_DISK_DRIVER_LOOPBACK
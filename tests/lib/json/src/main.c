@@ -3,6 +3,8 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <float.h>
+#include <math.h>
 #include <string.h>
 #include <zephyr/types.h>
 #include <stdbool.h>
@@ -209,36 +211,40 @@ ZTEST(lib_json_test, test_json_encoding)
 	zassert_equal(ret, 0, "Encoded contents not consistent");
 }
 
+static const char test_json[] = "{\"some_string\":\"zephyr 123\\uABCD456\","
+	"\"some_int\":\t42\n,"
+	"\"some_bool\":true    \t  "
+	"\n"
+	"\r   ,"
+	"\"some_nested_struct\":{    "
+	"\"nested_int\":-1234,\n\n"
+	"\"nested_bool\":false,\t"
+	"\"nested_string\":\"this should be escaped: \\t\","
+	"\"extra_nested_array\":[0,-1]},"
+	"\"extra_struct\":{\"nested_bool\":false},"
+	"\"extra_bool\":true,"
+	"\"some_array\":[11,22, 33,\t45,\n299],"
+	"\"another_b!@l\":true,"
+	"\"if\":false,"
+	"\"another-array\":[2,3,5,7],"
+	"\"4nother_ne$+\":{\"nested_int\":1234,"
+	"\"nested_bool\":true,"
+	"\"nested_string\":\"no escape necessary\"},"
+	"\"nested_obj_array\":["
+	"{\"nested_int\":1,\"nested_bool\":true,\"nested_string\":\"true\"},"
+	"{\"nested_int\":0,\"nested_bool\":false,\"nested_string\":\"false\"}]"
+	"}\n";
+
 ZTEST(lib_json_test, test_json_decoding)
 {
 	struct test_struct ts;
-	char encoded[] = "{\"some_string\":\"zephyr 123\\uABCD456\","
-		"\"some_int\":\t42\n,"
-		"\"some_bool\":true    \t  "
-		"\n"
-		"\r   ,"
-		"\"some_nested_struct\":{    "
-		"\"nested_int\":-1234,\n\n"
-		"\"nested_bool\":false,\t"
-		"\"nested_string\":\"this should be escaped: \\t\","
-		"\"extra_nested_array\":[0,-1]},"
-		"\"extra_struct\":{\"nested_bool\":false},"
-		"\"extra_bool\":true,"
-		"\"some_array\":[11,22, 33,\t45,\n299],"
-		"\"another_b!@l\":true,"
-		"\"if\":false,"
-		"\"another-array\":[2,3,5,7],"
-		"\"4nother_ne$+\":{\"nested_int\":1234,"
-		"\"nested_bool\":true,"
-		"\"nested_string\":\"no escape necessary\"},"
-		"\"nested_obj_array\":["
-		"{\"nested_int\":1,\"nested_bool\":true,\"nested_string\":\"true\"},"
-		"{\"nested_int\":0,\"nested_bool\":false,\"nested_string\":\"false\"}]"
-		"}\n";
+	char encoded[sizeof(test_json)];
 	const int expected_array[] = { 11, 22, 33, 45, 299 };
 	const int expected_other_array[] = { 2, 3, 5, 7 };
 	int ret;
 
+	memcpy(encoded, test_json, sizeof(encoded));
+
 	ret = json_obj_parse(encoded, sizeof(encoded) - 1, test_descr,
 			     ARRAY_SIZE(test_descr), &ts);
 
@@ -1209,4 +1215,457 @@ ZTEST(lib_json_test, test_large_descriptor)
 	zassert_true(ret & ((int64_t)1 << 39), "Field int39 not decoded");
 }
 
+/* Feed the object to a streaming parser in pieces of chunk_size bytes */
+static int64_t stream_parse(const char *json, size_t len, size_t chunk_size,
+			    const struct json_obj_descr *descr, size_t descr_len,
+			    void *val, char *buf, size_t buf_size)
+{
+	static struct json_obj_stream stream;
+	int64_t ret = -EAGAIN;
+	size_t off;
+
+	json_obj_stream_parse_init(&stream, descr, descr_len, val, buf, buf_size);
+
+	for (off = 0; off < len; off += chunk_size) {
+		ret = json_obj_stream_parse(&stream, &json[off], MIN(chunk_size, len - off));
+	}
+
+	return ret;
+}
+
+static void assert_nested_equal(const struct test_nested *a, const struct test_nested *b)
+{
+	zassert_equal(a->nested_int, b->nested_int, "Nested integer differs");
+	zassert_equal(a->nested_bool, b->nested_bool, "Nested boolean differs");
+	zassert_true(!strcmp(a->nested_string, b->nested_string), "Nested string differs");
+}
+
+ZTEST(lib_json_test, test_json_stream_decoding)
+{
+	static char encoded[sizeof(test_json)];
+	static char strings[128];
+	struct test_struct expected;
+	struct test_struct ts;
+	int64_t ret;
+
+	memcpy(encoded, test_json, sizeof(encoded));
+	ret = json_obj_parse(encoded, sizeof(encoded) - 1, test_descr,
+			     ARRAY_SIZE(test_descr), &expected);
+	zassert_equal(ret, (1 << ARRAY_SIZE(test_descr)) - 1, "Reference parse failed");
+
+	for (size_t chunk_size = 1; chunk_size < sizeof(test_json); chunk_size++) {
+		memset(&ts, 0, sizeof(ts));
+
+		ret = stream_parse(test_json, sizeof(test_json) - 1, chunk_size, test_descr,
+				   ARRAY_SIZE(test_descr), &ts, strings, sizeof(strings));
+		zassert_equal(ret, (1 << ARRAY_SIZE(test_descr)) - 1,
+			      "Not all fields decoded with %zu byte chunks", chunk_size);
+
+		zassert_true(!strcmp(ts.some_string, expected.some_string),
+			     "String not decoded correctly");
+		zassert_equal(ts.some_int, expected.some_int, "Integer not decoded correctly");
+		zassert_equal(ts.some_bool, expected.some_bool, "Boolean not decoded correctly");
+		assert_nested_equal(&ts.some_nested_struct, &expected.some_nested_struct);
+		zassert_equal(ts.some_array_len, expected.some_array_len,
+			      "Array doesn't have correct number of items");
+		zassert_true(!memcmp(ts.some_array, expected.some_array,
+				     ts.some_array_len * sizeof(ts.some_array[0])),
+			     "Array not decoded with expected values");
+		zassert_equal(ts.another_bxxl, expected.another_bxxl,
+			      "Named boolean not decoded correctly");
+		zassert_equal(ts.if_, expected.if_, "Named boolean not decoded correctly");
+		zassert_equal(ts.another_array_len, expected.another_array_len,
+			      "Named array does not have correct number of items");
+		zassert_true(!memcmp(ts.another_array, expected.another_array,
+				     ts.another_array_len * sizeof(ts.another_array[0])),
+			     "Named array not decoded with expected values");
+		assert_nested_equal(&ts.xnother_nexx, &expected.xnother_nexx);
+		zassert_equal(ts.obj_array_len, expected.obj_array_len,
+			      "Array of objects does not have correct number of items");
+		assert_nested_equal(&ts.nested_obj_array[0], &expected.nested_obj_array[0]);
+		assert_nested_equal(&ts.nested_obj_array[1], &expected.nested_obj_array[1]);
+	}
+}
+
+ZTEST(lib_json_test, test_json_stream_2dim_arr_obj)
+{
+	static const char encoded[] = "{\"objects_array_array\":["
+		"[{\"name\":\"Sim\303\263n Bol\303\255var\",\"height\":168},"
+		 "{\"name\":\"Pel\303\251\",\"height\":173}],"
+		"[],"
+		"[{\"name\":\"Hazel Findlay\",\"height\":157}]"
+		"]}";
+	static struct obj_array_2dim oaa;
+	char strings[64];
+	int64_t ret;
+
+	ret = stream_parse(encoded, sizeof(encoded) - 1, 5, array_2dim_descr,
+			   ARRAY_SIZE(array_2dim_descr), &oaa, strings, sizeof(strings));
+
+	zassert_equal(ret, 1, "Array of arrays fields not decoded correctly");
+	zassert_equal(oaa.objects_array_array_len, 3, "Number of subarrays not decoded correctly");
+	zassert_equal(oaa.objects_array_array[0].num_elements, 2,
+		      "Number of object fields not decoded correctly");
+	zassert_equal(oaa.objects_array_array[1].num_elements, 0,
+		      "Number of object fields not decoded correctly");
+	zassert_equal(oaa.objects_array_array[2].num_elements, 1,
+		      "Number of object fields not decoded correctly");
+	zassert_true(!strcmp(oaa.objects_array_array[0].elements[1].name, "Pel\303\251"),
+		     "Name not decoded correctly");
+	zassert_equal(oaa.objects_array_array[2].elements[0].height, 157,
+		      "Height not decoded correctly");
+}
+
+struct raw_values {
+	struct json_obj_token num;
+	struct json_obj_token str;
+	struct json_obj_token arr;
+};
+
+static const struct json_obj_descr raw_values_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct raw_values, num, JSON_TOK_FLOAT),
+	JSON_OBJ_DESCR_PRIM(struct raw_values, str, JSON_TOK_OPAQUE),
+	JSON_OBJ_DESCR_PRIM(struct raw_values, arr, JSON_TOK_OBJ_ARRAY),
+};
+
+ZTEST(lib_json_test, test_json_stream_raw_values)
+{
+	static const char encoded[] = "{\"num\":-12.75,\"skip\":[\"]\",{}],"
+				      "\"arr\":[{\"a\":\"[\"},[1,2]],\"str\":\"x\\\"y\"}";
+	struct raw_values rv;
+	char strings[40];
+	int64_t ret;
+
+	for (size_t chunk_size = 1; chunk_size < sizeof(encoded); chunk_size++) {
+		ret = stream_parse(encoded, sizeof(encoded) - 1, chunk_size, raw_values_descr,
+				   ARRAY_SIZE(raw_values_descr), &rv, strings, sizeof(strings));
+		zassert_equal(ret, 0x7, "Raw values not decoded");
+
+		zassert_equal(rv.num.length, 6, "Float length not correct");
+		zassert_mem_equal(rv.num.start, "-12.75", 6, "Float not decoded correctly");
+		zassert_equal(rv.str.length, 4, "Opaque length not correct");
+		zassert_mem_equal(rv.str.start, "x\\\"y", 4, "Opaque not decoded correctly");
+		zassert_equal(rv.arr.length, 17, "Array length not correct");
+		zassert_mem_equal(rv.arr.start, "[{\"a\":\"[\"},[1,2]]", 17,
+				  "Array not copied correctly");
+	}
+}
+
+ZTEST(lib_json_test, test_json_stream_errors)
+{
+	static struct json_obj_stream stream;
+	struct test_struct ts;
+	char strings[16];
+	const char *truncated = "{\"some_int\":42,\"some_bool\":tr";
+	struct encoding_test encoded[] = {
+		{ "{\"some_bool\":truffle }", -EINVAL },
+		{ "{\"some_string\":null }", -EINVAL },
+		{ "{\"some_string\":false}", -EINVAL },
+		{ "{\"some_string\":\"\\X\"}", -EINVAL },
+		{ "{\"some_int\":42,}", -EINVAL },
+		{ "{\"some_array\":[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17]}", -ENOSPC },
+		{ "{\"some_string\":\"0123456789abcdef\"}", -ENOMEM },
+		{ "{\"unknown\":\"0123456789abcdef\"}", 0 },
+	};
+	int64_t ret;
+
+	/* Incomplete objects are waiting for more data */
+	json_obj_stream_parse_init(&stream, test_descr, ARRAY_SIZE(test_descr), &ts,
+				   strings, sizeof(strings));
+	ret = json_obj_stream_parse(&stream, truncated, strlen(truncated));
+	zassert_equal(ret, -EAGAIN, "Truncated object returned %d", (int)ret);
+	ret = json_obj_stream_parse(&stream, "ue} trailing", strlen("ue} trailing"));
+	zassert_equal(ret, 0x6, "Resumed object not decoded");
+	zassert_equal(ts.some_int, 42, "Integer not decoded correctly");
+	zassert_true(ts.some_bool, "Boolean not decoded correctly");
+
+	/* The result sticks once the object is complete */
+	ret = json_obj_stream_parse(&stream, "{", 1);
+	zassert_equal(ret, 0x6, "Data after the object not ignored");
+
+	/* Errors are found as with the whole object. Strings must fit in the
+	 * buffer, unless their field is skipped.
+	 */
+	for (int i = 0; i < ARRAY_SIZE(encoded); i++) {
+		ret = stream_parse(encoded[i].str, strlen(encoded[i].str), 3, test_descr,
+				   ARRAY_SIZE(test_descr), &ts, strings, sizeof(strings));
+		zassert_equal(ret, encoded[i].result, "Decoding '%s' result %d, expected %d",
+			      encoded[i].str, (int)ret, encoded[i].result);
+	}
+}
+
+ZTEST(lib_json_test, test_json_stream_benchmark)
+{
+	static char encoded[sizeof(test_json)];
+	static char strings[128];
+	const size_t chunk_size = 64;
+	const int iterations = 200;
+	struct test_struct ts;
+	uint32_t start;
+	uint64_t whole_ns, stream_ns;
+	int64_t ret;
+
+	/* The whole object is copied each time, as it would be received */
+	start = k_cycle_get_32();
+
+	for (int i = 0; i < iterations; i++) {
+		memcpy(encoded, test_json, sizeof(encoded));
+		ret = json_obj_parse(encoded, sizeof(encoded) - 1, test_descr,
+				     ARRAY_SIZE(test_descr), &ts);
+		zassert_true(ret > 0, "Parsing failed");
+	}
+
+	whole_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	start = k_cycle_get_32();
+
+	for (int i = 0; i < iterations; i++) {
+		ret = stream_parse(test_json, sizeof(test_json) - 1, chunk_size, test_descr,
+				   ARRAY_SIZE(test_descr), &ts, strings, sizeof(strings));
+		zassert_true(ret > 0, "Streaming parse failed");
+	}
+
+	stream_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	TC_PRINT("%zu byte object: %u ns buffered, %u ns streamed in %zu byte chunks\n",
+		 sizeof(test_json) - 1, (uint32_t)(whole_ns / iterations),
+		 (uint32_t)(stream_ns / iterations), chunk_size);
+}
+
+struct fp_values {
+	float f;
+	double d;
+	double arr[8];
+	size_t arr_len;
+};
+
+static const struct json_obj_descr fp_values_descr[] = {
+	JSON_OBJ_DESCR_PRIM(struct fp_values, f, JSON_TOK_FLOAT_FP),
+	JSON_OBJ_DESCR_PRIM(struct fp_values, d, JSON_TOK_DOUBLE_FP),
+	JSON_OBJ_DESCR_ARRAY(struct fp_values, arr, 8, arr_len, JSON_TOK_DOUBLE_FP),
+};
+
+ZTEST(lib_json_test, test_json_encode_fp)
+{
+	struct fp_values fp = {
+		.f = 0.1f,
+		.d = 1.0 / 3,
+		.arr = { 1e21, 1e20, -0.0, 5e-324, DBL_MAX, 1e-7, 0.000001, 16777216.0 },
+		.arr_len = 8,
+	};
+	const char encoded[] = "{\"f\":0.1,\"d\":0.3333333333333333,"
+		"\"arr\":[1e+21,100000000000000000000,-0,5e-324,"
+		"1.7976931348623157e+308,1e-7,0.000001,16777216]}";
+	char buffer[sizeof(encoded)];
+	int ret;
+
+	ret = json_obj_encode_buf(fp_values_descr, ARRAY_SIZE(fp_values_descr),
+				  &fp, buffer, sizeof(buffer));
+	zassert_equal(ret, 0, "Encoding function failed");
+	zassert_str_equal(buffer, encoded, "Encoded contents not consistent");
+
+	zassert_equal(json_calc_encoded_len(fp_values_descr, ARRAY_SIZE(fp_values_descr), &fp),
+		      strlen(encoded), "encoded size mismatch");
+
+	/* JSON has no representation for NaN and infinities */
+	fp.d = NAN;
+	ret = json_obj_encode_buf(fp_values_descr, ARRAY_SIZE(fp_values_descr),
+				  &fp, buffer, sizeof(buffer));
+	zassert_equal(ret, -EINVAL, "NaN encoded");
+
+	fp.d = 0.0;
+	fp.f = -INFINITY;
+	ret = json_obj_encode_buf(fp_values_descr, ARRAY_SIZE(fp_values_descr),
+				  &fp, buffer, sizeof(buffer));
+	zassert_equal(ret, -EINVAL, "Infinity encoded");
+}
+
+struct flush_output {
+	char buf[512];
+	size_t len;
+	size_t blocks;
+	size_t short_blocks;
+	size_t block_size;
+	int ret;
+};
+
+static int flush_cb(const char *bytes, size_t len, void *data)
+{
+	struct flush_output *out = data;
+
+	if (out->ret < 0) {
+		return out->ret;
+	}
+
+	if (out->len + len > sizeof(out->buf)) {
+		return -ENOMEM;
+	}
+
+	memcpy(&out->buf[out->len], bytes, len);
+	out->len += len;
+	out->blocks++;
+
+	if (len != out->block_size) {
+		out->short_blocks++;
+	}
+
+	return 0;
+}
+
+static void decode_test_struct(struct test_struct *ts)
+{
+	static char encoded[sizeof(test_json)];
+	int64_t ret;
+
+	memcpy(encoded, test_json, sizeof(encoded));
+	ret = json_obj_parse(encoded, sizeof(encoded) - 1, test_descr,
+			     ARRAY_SIZE(test_descr), ts);
+	zassert_true(ret > 0, "Parsing failed");
+}
+
+ZTEST(lib_json_test, test_json_encode_buffered)
+{
+	static struct flush_output out;
+	static char expected[sizeof(test_json)];
+	struct test_struct ts;
+	char block[16];
+	size_t expected_len;
+	int ret;
+
+	decode_test_struct(&ts);
+
+	ret = json_obj_encode_buf(test_descr, ARRAY_SIZE(test_descr), &ts,
+				  expected, sizeof(expected));
+	zassert_equal(ret, 0, "Encoding function failed");
+	expected_len = strlen(expected);
+
+	memset(&out, 0, sizeof(out));
+	out.block_size = sizeof(block);
+
+	ret = json_obj_encode_buffered(test_descr, ARRAY_SIZE(test_descr), &ts,
+				       flush_cb, &out, block, sizeof(block));
+	zassert_equal(ret, 0, "Buffered encoding failed");
+	zassert_equal(out.len, expected_len, "Buffered output length mismatch");
+	zassert_mem_equal(out.buf, expected, expected_len, "Buffered output mismatch");
+
+	/* Only the last block is flushed partially filled */
+	zassert_equal(out.blocks, DIV_ROUND_UP(expected_len, sizeof(block)));
+	zassert_true(out.short_blocks <= 1, "%zu partial blocks", out.short_blocks);
+
+	/* Errors of the flush callback are returned */
+	memset(&out, 0, sizeof(out));
+	out.ret = -EPIPE;
+
+	ret = json_obj_encode_buffered(test_descr, ARRAY_SIZE(test_descr), &ts,
+				       flush_cb, &out, block, sizeof(block));
+	zassert_equal(ret, -EPIPE, "Flush error not returned");
+}
+
+ZTEST(lib_json_test, test_json_arr_encode_buffered)
+{
+	static struct flush_output out;
+	struct obj_array oa = {
+		.elements = {
+			{ .name = "Simón Bolívar", .height = 168 },
+			{ .name = "Muggsy Bogues", .height = 160 },
+			{ .name = "Pelé", .height = 173 },
+		},
+		.num_elements = 3,
+	};
+	const char encoded[] = "[{\"name\":\"Simón Bolívar\",\"height\":168},"
+		"{\"name\":\"Muggsy Bogues\",\"height\":160},"
+		"{\"name\":\"Pelé\",\"height\":173}]";
+	char block[7];
+	int ret;
+
+	memset(&out, 0, sizeof(out));
+	out.block_size = sizeof(block);
+
+	ret = json_arr_encode_buffered(obj_array_descr, &oa, flush_cb, &out,
+				       block, sizeof(block));
+	zassert_equal(ret, 0, "Buffered encoding failed");
+	zassert_equal(out.len, strlen(encoded), "Buffered output length mismatch");
+	zassert_mem_equal(out.buf, encoded, out.len, "Buffered output mismatch");
+	zassert_equal(json_calc_encoded_arr_len(obj_array_descr, &oa), strlen(encoded),
+		      "encoded size mismatch");
+}
+
+static int count_cb(const char *bytes, size_t len, void *data)
+{
+	size_t *calls = data;
+
+	ARG_UNUSED(bytes);
+	ARG_UNUSED(len);
+
+	(*calls)++;
+
+	return 0;
+}
+
+ZTEST(lib_json_test, test_json_encode_benchmark)
+{
+	static struct flush_output out;
+	static char encoded[sizeof(test_json)];
+	const int iterations = 200;
+	struct test_struct ts;
+	size_t calls = 0;
+	uint32_t start;
+	uint64_t callback_ns, buf_ns, buffered_ns, len_ns;
+	ssize_t len = 0;
+	int ret;
+
+	decode_test_struct(&ts);
+
+	/* One callback per fragment, as when writing to a socket directly */
+	start = k_cycle_get_32();
+
+	for (int i = 0; i < iterations; i++) {
+		ret = json_obj_encode(test_descr, ARRAY_SIZE(test_descr), &ts,
+				      count_cb, &calls);
+		zassert_equal(ret, 0, "Encoding function failed");
+	}
+
+	callback_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	start = k_cycle_get_32();
+
+	for (int i = 0; i < iterations; i++) {
+		ret = json_obj_encode_buf(test_descr, ARRAY_SIZE(test_descr), &ts,
+					  encoded, sizeof(encoded));
+		zassert_equal(ret, 0, "Encoding function failed");
+	}
+
+	buf_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	start = k_cycle_get_32();
+
+	for (int i = 0; i < iterations; i++) {
+		char block[256];
+
+		memset(&out, 0, sizeof(out));
+		out.block_size = sizeof(block);
+		ret = json_obj_encode_buffered(test_descr, ARRAY_SIZE(test_descr), &ts,
+					       flush_cb, &out, block, sizeof(block));
+		zassert_equal(ret, 0, "Buffered encoding failed");
+	}
+
+	buffered_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	start = k_cycle_get_32();
+
+	for (int i = 0; i < iterations; i++) {
+		len = json_calc_encoded_len(test_descr, ARRAY_SIZE(test_descr), &ts);
+	}
+
+	len_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	zassert_equal(len, strlen(encoded), "encoded size mismatch");
+
+	TC_PRINT("%zd byte object: %u ns with %zu callbacks, %u ns to a buffer, "
+		 "%u ns in %zu blocks, %u ns to calculate the length\n",
+		 len, (uint32_t)(callback_ns / iterations), calls / iterations,
+		 (uint32_t)(buf_ns / iterations), (uint32_t)(buffered_ns / iterations),
+		 out.blocks, (uint32_t)(len_ns / iterations));
+}
+
 ZTEST_SUITE(lib_json_test, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,353 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/net/coap_service.h>
+#include <zephyr/net/socket.h>
+
+#define SERVER_ADDR "::1"
+#define SERVER_PORT 5683
+
+#define BENCH_RESOURCES 32
+#define BENCH_REQUESTS	1000
+#define BENCH_WINDOW	4
+
+#define SLOW_HANDLER_MS 200
+
+#define SERVER_MODE                                                                                \
+	(CONFIG_COAP_SERVER_WORKERS > 0 ? "workers"                                                \
+	 : CONFIG_COAP_SERVER_DISPATCH_TABLE_SIZE > 0 ? "dispatch table" : "inline")
+
+static int reply_get(struct coap_resource *resource, struct coap_packet *request,
+		     struct sockaddr *addr, socklen_t addr_len)
+{
+	const char *name = resource->user_data;
+	uint8_t buf[64];
+	struct coap_packet response;
+	int ret;
+
+	ret = coap_ack_init(&response, request, buf, sizeof(buf), COAP_RESPONSE_CODE_CONTENT);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = coap_packet_append_payload_marker(&response);
+	if (ret < 0) {
+		return ret;
+	}
+
+	ret = coap_packet_append_payload(&response, name, strlen(name));
+	if (ret < 0) {
+		return ret;
+	}
+
+	return coap_resource_send(resource, &response, addr, addr_len, NULL);
+}
+
+static int slow_get(struct coap_resource *resource, struct coap_packet *request,
+		    struct sockaddr *addr, socklen_t addr_len)
+{
+	k_msleep(SLOW_HANDLER_MS);
+
+	return reply_get(resource, request, addr, addr_len);
+}
+
+static uint16_t server_port = SERVER_PORT;
+COAP_SERVICE_DEFINE(loopback, SERVER_ADDR, &server_port, COAP_SERVICE_AUTOSTART);
+
+#define BENCH_RESOURCE(n, _)                                                                       \
+	static const char *const bench_##n##_path[] = {"bench", STRINGIFY(n), NULL};               \
+	COAP_RESOURCE_DEFINE(bench_##n, loopback,                                                  \
+			     {                                                                     \
+				     .path = bench_##n##_path,                                     \
+				     .get = reply_get,                                             \
+				     .user_data = "bench/" STRINGIFY(n),                           \
+			     })
+
+LISTIFY(BENCH_RESOURCES, BENCH_RESOURCE, (;));
+
+/* Resources are placed in name order, the wildcard comes before the exact match */
+static const char *const order_0_path[] = {"order", "+", NULL};
+COAP_RESOURCE_DEFINE(order_0, loopback, {
+	.path = order_0_path,
+	.get = reply_get,
+	.user_data = "order/+",
+});
+
+static const char *const order_1_path[] = {"order", "exact", NULL};
+COAP_RESOURCE_DEFINE(order_1, loopback, {
+	.path = order_1_path,
+	.get = reply_get,
+	.user_data = "order/exact",
+});
+
+static const char *const slow_path[] = {"slow", NULL};
+COAP_RESOURCE_DEFINE(slow, loopback, {
+	.path = slow_path,
+	.get = slow_get,
+	.user_data = "slow",
+});
+
+static const char *const post_only_path[] = {"post", NULL};
+COAP_RESOURCE_DEFINE(post_only, loopback, {
+	.path = post_only_path,
+	.post = reply_get,
+	.user_data = "post",
+});
+
+struct loopback_fixture {
+	int sock;
+};
+
+static int send_get(int sock, const char *path, uint16_t token)
+{
+	uint8_t buf[64];
+	struct coap_packet request;
+	char segment[16];
+	const char *end;
+	int ret;
+
+	ret = coap_packet_init(&request, buf, sizeof(buf), COAP_VERSION_1, COAP_TYPE_CON,
+			       sizeof(token), (uint8_t *)&token, COAP_METHOD_GET, coap_next_id());
+	if (ret < 0) {
+		return ret;
+	}
+
+	while (*path != '\0') {
+		end = strchr(path, '/');
+		if (end == NULL) {
+			end = path + strlen(path);
+		}
+
+		memcpy(segment, path, end - path);
+		ret = coap_packet_append_option(&request, COAP_OPTION_URI_PATH, segment,
+						end - path);
+		if (ret < 0) {
+			return ret;
+		}
+
+		path = (*end == '/') ? end + 1 : end;
+	}
+
+	ret = zsock_send(sock, request.data, request.offset, 0);
+
+	return ret < 0 ? -errno : 0;
+}
+
+static int recv_reply(int sock, uint16_t *token, uint8_t *code, char *payload, size_t len)
+{
+	uint8_t buf[128];
+	struct coap_packet reply;
+	const uint8_t *data;
+	uint16_t data_len;
+	uint8_t tkn[COAP_TOKEN_MAX_LEN];
+	int ret;
+
+	ret = zsock_recv(sock, buf, sizeof(buf), 0);
+	if (ret < 0) {
+		return -errno;
+	}
+
+	ret = coap_packet_parse(&reply, buf, ret, NULL, 0);
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (coap_header_get_token(&reply, tkn) != sizeof(*token)) {
+		return -EBADMSG;
+	}
+
+	memcpy(token, tkn, sizeof(*token));
+	*code = coap_header_get_code(&reply);
+
+	data = coap_packet_get_payload(&reply, &data_len);
+	data_len = MIN(data_len, len - 1);
+	memcpy(payload, data, data_len);
+	payload[data_len] = '\0';
+
+	return 0;
+}
+
+static void assert_get(int sock, const char *path, uint8_t expected_code,
+		       const char *expected_payload)
+{
+	char payload[32];
+	uint16_t token;
+	uint8_t code;
+
+	zassert_ok(send_get(sock, path, 0x1234));
+	zassert_ok(recv_reply(sock, &token, &code, payload, sizeof(payload)));
+	zassert_equal(token, 0x1234);
+	zassert_equal(code, expected_code, "unexpected code %d for %s", code, path);
+	zassert_str_equal(payload, expected_payload, "unexpected handler for %s", path);
+}
+
+static void *loopback_setup(void)
+{
+	static struct loopback_fixture fixture;
+	struct sockaddr_in6 addr = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(SERVER_PORT),
+	};
+	struct timeval timeout = {
+		.tv_sec = 2,
+	};
+
+	zassert_equal(zsock_inet_pton(AF_INET6, SERVER_ADDR, &addr.sin6_addr), 1);
+
+	/* Wait for the server thread to autostart the service */
+	zassert_true(WAIT_FOR(coap_service_is_running(&loopback) == 1, 1000000, k_msleep(10)));
+
+	fixture.sock = zsock_socket(AF_INET6, SOCK_DGRAM, IPPROTO_UDP);
+	zassert_true(fixture.sock >= 0, "socket() failed: %d", errno);
+	zassert_ok(zsock_setsockopt(fixture.sock, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+				    sizeof(timeout)));
+	zassert_ok(zsock_connect(fixture.sock, (struct sockaddr *)&addr, sizeof(addr)));
+
+	return &fixture;
+}
+
+static void loopback_teardown(void *f)
+{
+	struct loopback_fixture *fixture = f;
+
+	zsock_close(fixture->sock);
+}
+
+ZTEST_F(loopback, test_dispatch)
+{
+	assert_get(fixture->sock, "bench/0", COAP_RESPONSE_CODE_CONTENT, "bench/0");
+	assert_get(fixture->sock, "bench/17", COAP_RESPONSE_CODE_CONTENT, "bench/17");
+	assert_get(fixture->sock, "bench/31", COAP_RESPONSE_CODE_CONTENT, "bench/31");
+	assert_get(fixture->sock, "bench", COAP_RESPONSE_CODE_NOT_FOUND, "");
+	assert_get(fixture->sock, "bench/32", COAP_RESPONSE_CODE_NOT_FOUND, "");
+	assert_get(fixture->sock, "bench/1/0", COAP_RESPONSE_CODE_NOT_FOUND, "");
+	assert_get(fixture->sock, "post", COAP_RESPONSE_CODE_NOT_ALLOWED, "");
+}
+
+/* Sends a confirmable message with the given code and expects a reset for it */
+static void assert_reset(int sock, uint8_t code)
+{
+	uint8_t buf[32];
+	struct coap_packet msg;
+	uint16_t id = coap_next_id();
+	int ret;
+
+	zassert_ok(coap_packet_init(&msg, buf, sizeof(buf), COAP_VERSION_1, COAP_TYPE_CON, 0,
+				    NULL, code, id));
+	zassert_equal(zsock_send(sock, msg.data, msg.offset, 0), msg.offset);
+
+	ret = zsock_recv(sock, buf, sizeof(buf), 0);
+	zassert_true(ret > 0, "no reply to code %d: %d", code, errno);
+	zassert_ok(coap_packet_parse(&msg, buf, ret, NULL, 0));
+	zassert_equal(coap_header_get_type(&msg), COAP_TYPE_RESET, "no reset for code %d", code);
+	zassert_equal(coap_header_get_code(&msg), COAP_CODE_EMPTY, "reset not empty");
+	zassert_equal(coap_header_get_id(&msg), id, "reset for another message");
+}
+
+ZTEST_F(loopback, test_ping_and_stray_response)
+{
+	/* A CoAP ping, and a response the server never asked for */
+	assert_reset(fixture->sock, COAP_CODE_EMPTY);
+	assert_reset(fixture->sock, COAP_RESPONSE_CODE_CONTENT);
+
+	/* Requests are still dispatched afterwards */
+	assert_get(fixture->sock, "bench/0", COAP_RESPONSE_CODE_CONTENT, "bench/0");
+}
+
+ZTEST_F(loopback, test_dispatch_wildcard_order)
+{
+	Z_TEST_SKIP_IFNDEF(CONFIG_COAP_URI_WILDCARD);
+
+	/* The first matching resource wins, as with a linear search */
+	assert_get(fixture->sock, "order/exact", COAP_RESPONSE_CODE_CONTENT, "order/+");
+	assert_get(fixture->sock, "order/other", COAP_RESPONSE_CODE_CONTENT, "order/+");
+}
+
+ZTEST_F(loopback, test_slow_handler_does_not_block)
+{
+	char payload[32];
+	uint16_t token;
+	uint8_t code;
+
+	if (CONFIG_COAP_SERVER_WORKERS < 2) {
+		ztest_test_skip();
+	}
+
+	zassert_ok(send_get(fixture->sock, "slow", 1));
+	zassert_ok(send_get(fixture->sock, "bench/3", 2));
+
+	/* The fast request is answered while the slow handler still sleeps */
+	zassert_ok(recv_reply(fixture->sock, &token, &code, payload, sizeof(payload)));
+	zassert_equal(token, 2);
+	zassert_str_equal(payload, "bench/3");
+
+	zassert_ok(recv_reply(fixture->sock, &token, &code, payload, sizeof(payload)));
+	zassert_equal(token, 1);
+	zassert_str_equal(payload, "slow");
+}
+
+static void sort_latencies(uint32_t *lat, size_t count)
+{
+	for (size_t i = 1; i < count; i++) {
+		uint32_t v = lat[i];
+		size_t j = i;
+
+		for (; j > 0 && lat[j - 1] > v; j--) {
+			lat[j] = lat[j - 1];
+		}
+
+		lat[j] = v;
+	}
+}
+
+ZTEST_F(loopback, test_throughput_benchmark)
+{
+	static uint32_t sent_at[BENCH_REQUESTS];
+	static uint32_t latency[BENCH_REQUESTS];
+	char path[16];
+	char payload[32];
+	uint16_t next = 0;
+	uint16_t done = 0;
+	uint16_t token;
+	uint8_t code;
+	uint32_t start;
+	uint64_t ns;
+
+	start = k_cycle_get_32();
+
+	/* Keep a window of requests in flight, like a simple load generator */
+	while (done < BENCH_REQUESTS) {
+		while (next < BENCH_REQUESTS && next - done < BENCH_WINDOW) {
+			snprintk(path, sizeof(path), "bench/%u", next % BENCH_RESOURCES);
+			sent_at[next] = k_cycle_get_32();
+			zassert_ok(send_get(fixture->sock, path, next));
+			next++;
+		}
+
+		zassert_ok(recv_reply(fixture->sock, &token, &code, payload, sizeof(payload)));
+		zassert_true(token < next, "unexpected token %u", token);
+		zassert_equal(code, COAP_RESPONSE_CODE_CONTENT);
+
+		latency[done++] = k_cycle_get_32() - sent_at[token];
+	}
+
+	ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	sort_latencies(latency, BENCH_REQUESTS);
+
+	TC_PRINT("%s: %u requests over %u resources, %u req/s, p50 %u us, p99 %u us\n",
+		 SERVER_MODE, BENCH_REQUESTS, BENCH_RESOURCES,
+		 ns == 0 ? 0U : (uint32_t)((uint64_t)BENCH_REQUESTS * NSEC_PER_SEC / ns),
+		 (uint32_t)(k_cyc_to_ns_floor64(latency[BENCH_REQUESTS / 2]) / NSEC_PER_USEC),
+		 (uint32_t)(k_cyc_to_ns_floor64(latency[BENCH_REQUESTS * 99 / 100]) /
+			    NSEC_PER_USEC));
+}
+
+ZTEST_SUITE(loopback, NULL, loopback_setup, NULL, NULL, loopback_teardown);
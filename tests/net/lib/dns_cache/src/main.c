@@ -133,3 +133,104 @@ ZTEST(net_dns_cache_test, test_expired_entries_removed)
 	zassert_equal(1, dns_cache_find(&test_dns_cache, query, info_read, 3));
 	zassert_equal(AF_INET, info_read[0].ai_family);
 }
+
+ZTEST(net_dns_cache_test, test_find_family)
+{
+	struct dns_addrinfo info_write4 = {.ai_family = AF_INET};
+	struct dns_addrinfo info_write6 = {.ai_family = AF_INET6};
+	struct dns_addrinfo info_read[2] = {0};
+	const char *query = "example.com";
+
+	zassert_ok(dns_cache_add(&test_dns_cache, query, &info_write4, TEST_DNS_CACHE_DEFAULT_TTL));
+	zassert_ok(dns_cache_add(&test_dns_cache, query, &info_write6, TEST_DNS_CACHE_DEFAULT_TTL));
+	zassert_equal(1, dns_cache_find_family(&test_dns_cache, query, AF_INET6, info_read, 2));
+	zassert_equal(AF_INET6, info_read[0].ai_family);
+	zassert_equal(1, dns_cache_find_family(&test_dns_cache, query, AF_INET, info_read, 2));
+	zassert_equal(AF_INET, info_read[0].ai_family);
+	zassert_equal(2, dns_cache_find(&test_dns_cache, query, info_read, 2));
+}
+
+ZTEST(net_dns_cache_test, test_many_names)
+{
+	struct dns_addrinfo info_write = {.ai_family = AF_INET};
+	struct dns_addrinfo info_read = {0};
+	char query[sizeof("host-00.example.com")];
+
+	for (size_t i = 0; i < TEST_DNS_CACHE_SIZE; i++) {
+		snprintk(query, sizeof(query), "host-%02u.example.com", (unsigned int)i);
+		info_write.ai_addrlen = i;
+		zassert_ok(dns_cache_add(&test_dns_cache, query, &info_write,
+					 TEST_DNS_CACHE_DEFAULT_TTL));
+	}
+
+	for (size_t i = 0; i < TEST_DNS_CACHE_SIZE; i++) {
+		snprintk(query, sizeof(query), "host-%02u.example.com", (unsigned int)i);
+		zassert_equal(1, dns_cache_find(&test_dns_cache, query, &info_read, 1));
+		zassert_equal(i, info_read.ai_addrlen, "Wrong entry for %s", query);
+	}
+
+	snprintk(query, sizeof(query), "host-%02u.example.com", 0U);
+	zassert_ok(dns_cache_remove(&test_dns_cache, query));
+	zassert_equal(0, dns_cache_find(&test_dns_cache, query, &info_read, 1));
+
+	snprintk(query, sizeof(query), "host-%02u.example.com", 1U);
+	zassert_equal(1, dns_cache_find(&test_dns_cache, query, &info_read, 1));
+}
+
+ZTEST(net_dns_cache_test, test_negative_entry)
+{
+	struct dns_addrinfo info_write = {.ai_family = AF_INET};
+	struct dns_addrinfo info_read = {0};
+	const char *nxdomain = "nx.example.com";
+	const char *nodata = "v4only.example.com";
+
+	zassert_ok(dns_cache_add_negative(&test_dns_cache, nxdomain, AF_UNSPEC,
+					  TEST_DNS_CACHE_DEFAULT_TTL));
+	zassert_true(dns_cache_find_negative(&test_dns_cache, nxdomain, AF_INET));
+	zassert_true(dns_cache_find_negative(&test_dns_cache, nxdomain, AF_INET6));
+	zassert_equal(0, dns_cache_find(&test_dns_cache, nxdomain, &info_read, 1));
+
+	zassert_ok(dns_cache_add(&test_dns_cache, nodata, &info_write, TEST_DNS_CACHE_DEFAULT_TTL));
+	zassert_ok(dns_cache_add_negative(&test_dns_cache, nodata, AF_INET6,
+					  TEST_DNS_CACHE_DEFAULT_TTL));
+	zassert_true(dns_cache_find_negative(&test_dns_cache, nodata, AF_INET6));
+	zassert_false(dns_cache_find_negative(&test_dns_cache, nodata, AF_INET));
+	zassert_equal(1, dns_cache_find(&test_dns_cache, nodata, &info_read, 1));
+
+	k_sleep(K_MSEC(TEST_DNS_CACHE_DEFAULT_TTL * 1000 + 1));
+	zassert_false(dns_cache_find_negative(&test_dns_cache, nxdomain, AF_INET));
+}
+
+ZTEST(net_dns_cache_test, test_positive_replaces_negative)
+{
+	struct dns_addrinfo info_write = {.ai_family = AF_INET6};
+	struct dns_addrinfo info_read = {0};
+	const char *query = "example.com";
+
+	zassert_ok(dns_cache_add_negative(&test_dns_cache, query, AF_INET6,
+					  TEST_DNS_CACHE_DEFAULT_TTL));
+	zassert_ok(dns_cache_add(&test_dns_cache, query, &info_write, TEST_DNS_CACHE_DEFAULT_TTL));
+	zassert_false(dns_cache_find_negative(&test_dns_cache, query, AF_INET6));
+	zassert_equal(1, dns_cache_find(&test_dns_cache, query, &info_read, 1));
+}
+
+ZTEST(net_dns_cache_test, test_prefetch)
+{
+	struct dns_addrinfo info_write = {.ai_family = AF_INET};
+	struct dns_addrinfo info_read[2] = {0};
+	const char *query = "example.com";
+
+	zassert_ok(dns_cache_add(&test_dns_cache, query, &info_write, TEST_DNS_CACHE_DEFAULT_TTL));
+	zassert_false(dns_cache_prefetch_due(&test_dns_cache, query, AF_INET));
+
+	k_sleep(K_MSEC(TEST_DNS_CACHE_DEFAULT_TTL * 950));
+	zassert_true(dns_cache_prefetch_due(&test_dns_cache, query, AF_INET));
+	zassert_false(dns_cache_prefetch_due(&test_dns_cache, query, AF_INET),
+		      "Refresh should be requested only once");
+
+	/* The refreshed answer extends the entry instead of adding another */
+	zassert_ok(dns_cache_add(&test_dns_cache, query, &info_write,
+				 TEST_DNS_CACHE_DEFAULT_TTL * 2));
+	k_sleep(K_MSEC(TEST_DNS_CACHE_DEFAULT_TTL * 100));
+	zassert_equal(1, dns_cache_find(&test_dns_cache, query, info_read, 2));
+}
@@ -23,6 +23,7 @@ LOG_MODULE_REGISTER(net_test, CONFIG_DNS_RESOLVER_LOG_LEVEL);
 #include <zephyr/net/net_ip.h>
 #include <zephyr/net/net_if.h>
 #include <zephyr/net/dns_resolve.h>
+#include <zephyr/sys/byteorder.h>
 
 #define NET_LOG_ENABLED 1
 #include "net_private.h"
@@ -120,6 +121,155 @@ static inline int get_slot_by_id(struct dns_resolve_context *ctx,
 	return -1;
 }
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+/* The tests of the cache answer the queries like a DNS server would */
+#define SERVER_MSG_LEN 256
+#define SERVER_ADDR { 192, 0, 2, 10 }
+#define DNS_HEADER_LEN 12
+#define DNS_RCODE_NXDOMAIN 3
+
+static bool server_mode;
+static int server_queries;
+static struct k_sem server_query_sem;
+static uint8_t server_query[SERVER_MSG_LEN];
+static size_t server_query_len;
+
+/* Keep the DNS queries sent over IPv4, returns true if pkt was one */
+static bool server_recv(struct net_pkt *pkt)
+{
+	NET_PKT_DATA_ACCESS_CONTIGUOUS_DEFINE(ip_access, struct net_ipv4_hdr);
+	NET_PKT_DATA_ACCESS_DEFINE(udp_access, struct net_udp_hdr);
+	struct net_ipv4_hdr *ip_hdr;
+	struct net_udp_hdr *udp_hdr;
+	size_t len = net_pkt_get_len(pkt);
+
+	net_pkt_cursor_init(pkt);
+
+	ip_hdr = (struct net_ipv4_hdr *)net_pkt_get_data(pkt, &ip_access);
+	if (!ip_hdr || (ip_hdr->vhl & 0xf0) != 0x40 ||
+	    ip_hdr->proto != IPPROTO_UDP ||
+	    net_pkt_skip(pkt, NET_IPV4H_LEN)) {
+		return false;
+	}
+
+	udp_hdr = (struct net_udp_hdr *)net_pkt_get_data(pkt, &udp_access);
+	if (!udp_hdr || udp_hdr->dst_port != htons(53) ||
+	    len > sizeof(server_query)) {
+		return false;
+	}
+
+	net_pkt_cursor_init(pkt);
+
+	if (net_pkt_read(pkt, server_query, len)) {
+		return false;
+	}
+
+	server_query_len = len;
+	server_queries++;
+	k_sem_give(&server_query_sem);
+
+	return true;
+}
+
+static uint16_t server_ipv4_chksum(const uint8_t *hdr)
+{
+	uint32_t sum = 0;
+
+	for (int i = 0; i < NET_IPV4H_LEN; i += 2) {
+		sum += sys_get_be16(&hdr[i]);
+	}
+
+	while (sum >> 16) {
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return ~sum;
+}
+
+/* Answers the last query with rcode, with an address valid for ttl seconds
+ * if the rcode is NOERROR.
+ */
+static void server_reply(uint8_t rcode, uint32_t ttl)
+{
+	static const uint8_t answer_addr[] = SERVER_ADDR;
+	uint8_t msg[SERVER_MSG_LEN + 16];
+	struct net_ipv4_hdr *ip_hdr = (struct net_ipv4_hdr *)msg;
+	struct net_udp_hdr *udp_hdr = (struct net_udp_hdr *)&msg[NET_IPV4H_LEN];
+	uint8_t *dns_hdr = &msg[NET_IPV4H_LEN + NET_UDPH_LEN];
+	uint8_t addr[NET_IPV4_ADDR_SIZE];
+	size_t len = server_query_len;
+	struct net_pkt *pkt;
+	uint16_t port;
+	int ret;
+
+	memcpy(msg, server_query, len);
+
+	/* Turn the query into a response */
+	dns_hdr[2] |= 0x80;
+	dns_hdr[3] = 0x80 | rcode;
+	sys_put_be16(rcode == 0 ? 1 : 0, &dns_hdr[6]);
+
+	if (rcode == 0) {
+		/* Name pointer to the question, type A, class IN */
+		static const uint8_t answer[] = { 0xc0, DNS_HEADER_LEN,
+						  0x00, 0x01, 0x00, 0x01 };
+
+		memcpy(&msg[len], answer, sizeof(answer));
+		len += sizeof(answer);
+		sys_put_be32(ttl, &msg[len]);
+		len += sizeof(uint32_t);
+		sys_put_be16(sizeof(answer_addr), &msg[len]);
+		len += sizeof(uint16_t);
+		memcpy(&msg[len], answer_addr, sizeof(answer_addr));
+		len += sizeof(answer_addr);
+	}
+
+	memcpy(addr, ip_hdr->src, sizeof(addr));
+	memcpy(ip_hdr->src, ip_hdr->dst, sizeof(addr));
+	memcpy(ip_hdr->dst, addr, sizeof(addr));
+	ip_hdr->len = htons(len);
+	ip_hdr->chksum = 0;
+	ip_hdr->chksum = htons(server_ipv4_chksum(msg));
+
+	port = udp_hdr->src_port;
+	udp_hdr->src_port = udp_hdr->dst_port;
+	udp_hdr->dst_port = port;
+	udp_hdr->len = htons(len - NET_IPV4H_LEN);
+	/* A missing checksum is accepted over IPv4 */
+	udp_hdr->chksum = 0;
+
+	pkt = net_pkt_alloc_with_buffer(iface1, len, AF_UNSPEC, 0, K_FOREVER);
+	zassert_not_null(pkt, "Cannot allocate response");
+
+	ret = net_pkt_write(pkt, msg, len);
+	zassert_equal(ret, 0, "Cannot write response");
+
+	ret = net_recv_data(iface1, pkt);
+	zassert_equal(ret, 0, "Cannot receive response");
+}
+
+static void server_start(void)
+{
+	k_sem_reset(&server_query_sem);
+	server_queries = 0;
+	server_mode = true;
+}
+
+static void server_stop(void)
+{
+	server_mode = false;
+}
+
+/* Waits for a query and answers it */
+static void server_wait_reply(uint8_t rcode, uint32_t ttl)
+{
+	zassert_ok(k_sem_take(&server_query_sem, WAIT_TIME),
+		   "Timeout while waiting query");
+
+	server_reply(rcode, ttl);
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
 static int sender_iface(const struct device *dev, struct net_pkt *pkt)
 {
 	if (!pkt->frags) {
@@ -127,6 +277,12 @@ static int sender_iface(const struct device *dev, struct net_pkt *pkt)
 		return -ENODATA;
 	}
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	if (server_mode && server_recv(pkt)) {
+		goto out;
+	}
+#endif
+
 	if (!timeout_query) {
 		struct net_if_test *data = dev->data;
 		struct dns_resolve_context *ctx;
@@ -199,6 +355,9 @@ static void *test_init(void)
 	/* The semaphore is there to wait the data to be received. */
 	k_sem_init(&wait_data, 0, UINT_MAX);
 	k_sem_init(&wait_data2, 0, UINT_MAX);
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+	k_sem_init(&server_query_sem, 0, UINT_MAX);
+#endif
 
 	iface1 = net_if_get_by_index(0);
 	zassert_is_null(iface1, "iface1");
@@ -427,17 +586,19 @@ ZTEST(dns_resolve, test_dns_query_ipv6_server_count)
 ZTEST(dns_resolve, test_dns_query_too_many)
 {
 	int expected_status = DNS_EAI_CANCELED;
-	int ret;
+	int ret, i;
 
 	timeout_query = true;
 
-	ret = dns_get_addr_info(NAME4,
-				DNS_QUERY_TYPE_A,
-				NULL,
-				dns_result_cb_timeout,
-				INT_TO_POINTER(expected_status),
-				DNS_TIMEOUT);
-	zassert_equal(ret, 0, "Cannot create IPv4 query");
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		ret = dns_get_addr_info(NAME4,
+					DNS_QUERY_TYPE_A,
+					NULL,
+					dns_result_cb_timeout,
+					INT_TO_POINTER(expected_status),
+					DNS_TIMEOUT);
+		zassert_equal(ret, 0, "Cannot create IPv4 query");
+	}
 
 	ret = dns_get_addr_info(NAME4,
 				DNS_QUERY_TYPE_A,
@@ -447,8 +608,10 @@ ZTEST(dns_resolve, test_dns_query_too_many)
 				DNS_TIMEOUT);
 	zassert_equal(ret, -EAGAIN, "Should have run out of space");
 
-	if (k_sem_take(&wait_data, WAIT_TIME)) {
-		zassert_true(false, "Timeout while waiting data");
+	for (i = 0; i < CONFIG_DNS_NUM_CONCUR_QUERIES; i++) {
+		if (k_sem_take(&wait_data, WAIT_TIME)) {
+			zassert_true(false, "Timeout while waiting data");
+		}
 	}
 
 	timeout_query = false;
@@ -751,4 +914,195 @@ static void test_dns_query_ipv6_numeric(void)
 }
 #endif
 
+#if defined(CONFIG_DNS_RESOLVER_CACHE)
+#define NAME_COALESCE "coalesce.zephyr.test"
+#define NAME_COALESCE_TIMEOUT1 "coalesce-timeout1.zephyr.test"
+#define NAME_COALESCE_TIMEOUT2 "coalesce-timeout2.zephyr.test"
+#define NAME_NXDOMAIN "nxdomain.zephyr.test"
+#define NAME_PREFETCH "prefetch.zephyr.test"
+
+#define SHORT_TIMEOUT 100 /* ms */
+#define PREFETCH_TTL 2 /* s */
+
+struct cache_result {
+	struct k_sem done;
+	int status;
+	int addresses;
+};
+
+static void cache_result_init(struct cache_result *result)
+{
+	k_sem_init(&result->done, 0, 1);
+	result->status = 0;
+	result->addresses = 0;
+}
+
+void dns_result_cache_cb(enum dns_resolve_status status,
+			 struct dns_addrinfo *info,
+			 void *user_data)
+{
+	struct cache_result *result = user_data;
+
+	if (status == DNS_EAI_INPROGRESS) {
+		result->addresses++;
+		return;
+	}
+
+	result->status = status;
+	k_sem_give(&result->done);
+}
+
+static void resolve(const char *name, struct cache_result *result,
+		    int32_t timeout)
+{
+	int ret;
+
+	cache_result_init(result);
+
+	ret = dns_get_addr_info(name, DNS_QUERY_TYPE_A, NULL,
+				dns_result_cache_cb, result, timeout);
+	zassert_equal(ret, 0, "Cannot create query for %s", name);
+}
+
+static void resolve_wait(struct cache_result *result, int status)
+{
+	zassert_ok(k_sem_take(&result->done, WAIT_TIME),
+		   "Timeout while waiting data");
+	zassert_equal(result->status, status, "Invalid status");
+	zassert_equal(result->addresses, status == DNS_EAI_ALLDONE ? 1 : 0,
+		      "Invalid number of addresses");
+}
+
+#if defined(CONFIG_DNS_RESOLVER_COALESCE_QUERIES) && CONFIG_DNS_NUM_CONCUR_QUERIES > 1
+ZTEST(dns_resolve, test_dns_cache_coalesce)
+{
+	struct cache_result first, second;
+	struct dns_resolve_stats stats;
+	uint32_t coalesced;
+
+	dns_resolve_get_stats(&stats);
+	coalesced = stats.coalesced;
+
+	server_start();
+
+	resolve(NAME_COALESCE, &first, DNS_TIMEOUT);
+	resolve(NAME_COALESCE, &second, DNS_TIMEOUT);
+
+	server_wait_reply(0, 60);
+
+	resolve_wait(&first, DNS_EAI_ALLDONE);
+	resolve_wait(&second, DNS_EAI_ALLDONE);
+
+	/* The second query waited for the answer to the first one */
+	k_msleep(THREAD_SLEEP);
+	zassert_equal(server_queries, 1, "Expected a single query on the wire");
+
+	dns_resolve_get_stats(&stats);
+	zassert_equal(stats.coalesced, coalesced + 1, "Expected a coalesced query");
+
+	server_stop();
+}
+
+ZTEST(dns_resolve, test_dns_cache_coalesce_timeout)
+{
+	struct cache_result leader, follower;
+
+	server_start();
+
+	/* The query that waits for another one times out on its own */
+	resolve(NAME_COALESCE_TIMEOUT1, &leader, DNS_TIMEOUT);
+	resolve(NAME_COALESCE_TIMEOUT1, &follower, SHORT_TIMEOUT);
+	zassert_ok(k_sem_take(&server_query_sem, WAIT_TIME),
+		   "Timeout while waiting query");
+
+	resolve_wait(&follower, DNS_EAI_CANCELED);
+	zassert_equal(k_sem_count_get(&leader.done), 0,
+		      "Expected first query to be still pending");
+
+	server_reply(0, 60);
+	resolve_wait(&leader, DNS_EAI_ALLDONE);
+
+	/* The query that waits keeps its own timeout after the first one
+	 * timed out
+	 */
+	resolve(NAME_COALESCE_TIMEOUT2, &leader, SHORT_TIMEOUT);
+	resolve(NAME_COALESCE_TIMEOUT2, &follower, DNS_TIMEOUT);
+	zassert_ok(k_sem_take(&server_query_sem, WAIT_TIME),
+		   "Timeout while waiting query");
+
+	resolve_wait(&leader, DNS_EAI_CANCELED);
+	zassert_equal(k_sem_count_get(&follower.done), 0,
+		      "Expected second query to be still pending");
+
+	server_reply(0, 60);
+	resolve_wait(&follower, DNS_EAI_ALLDONE);
+
+	k_msleep(THREAD_SLEEP);
+	zassert_equal(server_queries, 2, "Expected a single query per name on the wire");
+
+	server_stop();
+
+	verify_cancelled();
+}
+#endif /* CONFIG_DNS_RESOLVER_COALESCE_QUERIES && CONFIG_DNS_NUM_CONCUR_QUERIES > 1 */
+
+#if CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL > 0
+ZTEST(dns_resolve, test_dns_cache_negative)
+{
+	struct cache_result result;
+
+	server_start();
+
+	resolve(NAME_NXDOMAIN, &result, DNS_TIMEOUT);
+	server_wait_reply(DNS_RCODE_NXDOMAIN, 0);
+	resolve_wait(&result, DNS_EAI_NODATA);
+
+	/* Served from the negative cache */
+	resolve(NAME_NXDOMAIN, &result, DNS_TIMEOUT);
+	resolve_wait(&result, DNS_EAI_NODATA);
+	zassert_equal(server_queries, 1, "Expected negative answer to be cached");
+
+	/* Asked again once the negative answer expired */
+	k_msleep(CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL * MSEC_PER_SEC + THREAD_SLEEP);
+
+	resolve(NAME_NXDOMAIN, &result, DNS_TIMEOUT);
+	server_wait_reply(DNS_RCODE_NXDOMAIN, 0);
+	resolve_wait(&result, DNS_EAI_NODATA);
+	zassert_equal(server_queries, 2, "Expected negative answer to expire");
+
+	server_stop();
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE_NEGATIVE_TTL > 0 */
+
+#if defined(CONFIG_DNS_RESOLVER_CACHE_PREFETCH)
+ZTEST(dns_resolve, test_dns_cache_prefetch)
+{
+	struct cache_result result;
+
+	server_start();
+
+	resolve(NAME_PREFETCH, &result, DNS_TIMEOUT);
+	server_wait_reply(0, PREFETCH_TTL);
+	resolve_wait(&result, DNS_EAI_ALLDONE);
+
+	/* Past 90% of the TTL a hit refreshes the entry in the background */
+	k_msleep(PREFETCH_TTL * MSEC_PER_SEC * 9 / 10 + 5 * THREAD_SLEEP);
+
+	resolve(NAME_PREFETCH, &result, DNS_TIMEOUT);
+	resolve_wait(&result, DNS_EAI_ALLDONE);
+	server_wait_reply(0, PREFETCH_TTL);
+	zassert_equal(server_queries, 2, "Expected entry to be refreshed");
+
+	/* Still answered from the cache after the first answer expired */
+	k_msleep(PREFETCH_TTL * MSEC_PER_SEC / 10 + 5 * THREAD_SLEEP);
+
+	resolve(NAME_PREFETCH, &result, DNS_TIMEOUT);
+	resolve_wait(&result, DNS_EAI_ALLDONE);
+	zassert_equal(server_queries, 2, "Expected refreshed entry to be used");
+
+	server_stop();
+}
+#endif /* CONFIG_DNS_RESOLVER_CACHE_PREFETCH */
+#endif /* CONFIG_DNS_RESOLVER_CACHE */
+
 ZTEST_SUITE(dns_resolve, NULL, test_init, NULL, NULL, NULL);
@@ -0,0 +1,327 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/net/http/client.h>
+
+#define SERVER_PORT	  8080
+#define SERVER_STACK_SIZE 2048
+#define TIMEOUT_MS	  2000
+
+#define PIPELINE_DEPTH CONFIG_HTTP_CLIENT_PIPELINE_DEPTH
+#define BENCH_REQUESTS 50
+
+struct response {
+	char body[32];
+	uint16_t status;
+	bool final;
+};
+
+static int listen_sock = -1;
+static atomic_t accepted;
+
+static K_THREAD_STACK_DEFINE(server_stack, SERVER_STACK_SIZE);
+static struct k_thread server_thread_data;
+
+static uint8_t recv_buf[256];
+
+static int sendall(int sock, const char *buf, size_t len)
+{
+	while (len > 0) {
+		ssize_t out = zsock_send(sock, buf, len, 0);
+
+		if (out < 0) {
+			return -errno;
+		}
+
+		buf += out;
+		len -= out;
+	}
+
+	return 0;
+}
+
+/* Answer every complete request with the request path as body. Responses to
+ * requests received together are sent together, as a pipelining server
+ * would, so they reach the client in the same segment.
+ */
+static void server_serve(int sock)
+{
+	static char in[512];
+	static char out[512];
+	size_t in_len = 0;
+	size_t out_len;
+	bool close = false;
+	char *end;
+	int ret;
+
+	while (!close) {
+		ret = zsock_recv(sock, in + in_len, sizeof(in) - in_len - 1, 0);
+		if (ret <= 0) {
+			return;
+		}
+
+		in_len += ret;
+		in[in_len] = '\0';
+		out_len = 0;
+
+		while ((end = strstr(in, "\r\n\r\n")) != NULL) {
+			char *path = strchr(in, ' ') + 1;
+			size_t path_len = strchr(path, ' ') - path;
+
+			close = (strncmp(path, "/close", path_len) == 0);
+
+			out_len += snprintk(&out[out_len], sizeof(out) - out_len,
+					    "HTTP/1.1 200 OK\r\n"
+					    "Content-Length: %zu\r\n"
+					    "%s\r\n"
+					    "%.*s",
+					    path_len, close ? "Connection: close\r\n" : "",
+					    (int)path_len, path);
+
+			end += 4;
+			in_len -= end - in;
+			memmove(in, end, in_len + 1);
+		}
+
+		if (out_len > 0 && sendall(sock, out, out_len) < 0) {
+			return;
+		}
+	}
+}
+
+static void server_thread(void *p1, void *p2, void *p3)
+{
+	ARG_UNUSED(p1);
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		int sock = zsock_accept(listen_sock, NULL, NULL);
+
+		if (sock < 0) {
+			continue;
+		}
+
+		atomic_inc(&accepted);
+		server_serve(sock);
+		zsock_close(sock);
+	}
+}
+
+static int client_connect(void)
+{
+	struct sockaddr_in6 addr = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(SERVER_PORT),
+		.sin6_addr = IN6ADDR_LOOPBACK_INIT,
+	};
+	int sock;
+
+	sock = zsock_socket(AF_INET6, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(sock >= 0, "socket() failed: %d", errno);
+	zassert_ok(zsock_connect(sock, (struct sockaddr *)&addr, sizeof(addr)));
+
+	return sock;
+}
+
+static void response_cb(struct http_response *rsp, enum http_final_call final_data,
+			void *user_data)
+{
+	struct response *response = user_data;
+	size_t len;
+
+	if (final_data != HTTP_DATA_FINAL) {
+		return;
+	}
+
+	len = MIN(rsp->body_frag_len, sizeof(response->body) - 1);
+	if (rsp->body_frag_start != NULL) {
+		memcpy(response->body, rsp->body_frag_start, len);
+	}
+
+	response->body[len] = '\0';
+	response->status = rsp->http_status_code;
+	response->final = true;
+}
+
+static void request_init(struct http_request *req, const char *url)
+{
+	memset(req, 0, sizeof(*req));
+
+	req->method = HTTP_GET;
+	req->url = url;
+	req->host = "localhost";
+	req->protocol = "HTTP/1.1";
+	req->response = response_cb;
+	req->recv_buf = recv_buf;
+	req->recv_buf_len = sizeof(recv_buf);
+}
+
+static void assert_response(const struct response *response, const char *url)
+{
+	zassert_true(response->final, "no response for %s", url);
+	zassert_equal(response->status, 200);
+	zassert_str_equal(response->body, url);
+}
+
+static void *http_client_setup(void)
+{
+	struct sockaddr_in6 addr = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(SERVER_PORT),
+		.sin6_addr = IN6ADDR_LOOPBACK_INIT,
+	};
+	int opt = 1;
+
+	listen_sock = zsock_socket(AF_INET6, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(listen_sock >= 0, "socket() failed: %d", errno);
+	zassert_ok(zsock_setsockopt(listen_sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt)));
+	zassert_ok(zsock_bind(listen_sock, (struct sockaddr *)&addr, sizeof(addr)));
+	zassert_ok(zsock_listen(listen_sock, 2));
+
+	k_thread_create(&server_thread_data, server_stack, K_THREAD_STACK_SIZEOF(server_stack),
+			server_thread, NULL, NULL, NULL, K_PRIO_PREEMPT(8), 0, K_NO_WAIT);
+
+	return NULL;
+}
+
+static void http_client_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	atomic_set(&accepted, 0);
+}
+
+ZTEST(http_client, test_sequential_requests_reuse_connection)
+{
+	struct http_client_conn conn;
+	struct http_request req;
+	struct response response;
+	char url[8];
+	int sock = client_connect();
+
+	http_client_conn_init(&conn, sock);
+
+	for (int i = 0; i < 5; i++) {
+		snprintk(url, sizeof(url), "/r%d", i);
+		request_init(&req, url);
+		memset(&response, 0, sizeof(response));
+
+		zassert_true(http_client_conn_req(&conn, &req, TIMEOUT_MS, &response) > 0);
+		assert_response(&response, url);
+		zassert_true(conn.keep_alive);
+	}
+
+	zsock_close(sock);
+
+	zassert_equal(atomic_get(&accepted), 1, "requests used %d connections",
+		      (int)atomic_get(&accepted));
+}
+
+ZTEST(http_client, test_pipelined_requests)
+{
+	static struct http_request req[PIPELINE_DEPTH + 1];
+	static struct response response[PIPELINE_DEPTH];
+	static char url[PIPELINE_DEPTH + 1][8];
+	struct http_client_conn conn;
+	int sock = client_connect();
+
+	http_client_conn_init(&conn, sock);
+
+	for (int i = 0; i <= PIPELINE_DEPTH; i++) {
+		snprintk(url[i], sizeof(url[i]), "/p%d", i);
+		request_init(&req[i], url[i]);
+	}
+
+	/* All requests share one receive buffer, the start of a response
+	 * received along with the previous one is carried over.
+	 */
+	memset(response, 0, sizeof(response));
+
+	for (int i = 0; i < PIPELINE_DEPTH; i++) {
+		zassert_true(http_client_conn_send(&conn, &req[i], &response[i]) > 0);
+	}
+
+	zassert_equal(http_client_conn_send(&conn, &req[PIPELINE_DEPTH], NULL), -EBUSY);
+
+	for (int i = 0; i < PIPELINE_DEPTH; i++) {
+		zassert_true(http_client_conn_recv(&conn, TIMEOUT_MS) > 0);
+		assert_response(&response[i], url[i]);
+	}
+
+	zassert_equal(http_client_conn_recv(&conn, TIMEOUT_MS), -ENOENT);
+	zassert_true(conn.keep_alive);
+
+	zsock_close(sock);
+}
+
+ZTEST(http_client, test_connection_close)
+{
+	struct http_client_conn conn;
+	struct http_request req;
+	struct response response = {0};
+	int sock = client_connect();
+
+	http_client_conn_init(&conn, sock);
+	request_init(&req, "/close");
+
+	zassert_true(http_client_conn_req(&conn, &req, TIMEOUT_MS, &response) > 0);
+	assert_response(&response, "/close");
+
+	/* The server asked to close the connection */
+	zassert_false(conn.keep_alive);
+	zassert_equal(http_client_conn_send(&conn, &req, &response), -ENOTCONN);
+
+	zsock_close(sock);
+}
+
+ZTEST(http_client, test_reuse_benchmark)
+{
+	struct http_client_conn conn;
+	struct http_request req;
+	struct response response;
+	uint32_t start;
+	uint64_t new_conn_ns, reuse_ns;
+	int sock;
+
+	/* A new connection per request, as with http_client_req() */
+	start = k_cycle_get_32();
+
+	for (int i = 0; i < BENCH_REQUESTS; i++) {
+		sock = client_connect();
+		request_init(&req, "/bench");
+		zassert_true(http_client_req(sock, &req, TIMEOUT_MS, &response) > 0);
+		zsock_close(sock);
+	}
+
+	new_conn_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	/* One persistent connection */
+	start = k_cycle_get_32();
+
+	sock = client_connect();
+	http_client_conn_init(&conn, sock);
+
+	for (int i = 0; i < BENCH_REQUESTS; i++) {
+		request_init(&req, "/bench");
+		zassert_true(http_client_conn_req(&conn, &req, TIMEOUT_MS, &response) > 0);
+	}
+
+	zsock_close(sock);
+
+	reuse_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	TC_PRINT("%d requests: %u us per request with a new connection, %u us reused\n",
+		 BENCH_REQUESTS, (uint32_t)(new_conn_ns / BENCH_REQUESTS / NSEC_PER_USEC),
+		 (uint32_t)(reuse_ns / BENCH_REQUESTS / NSEC_PER_USEC));
+}
+
+ZTEST_SUITE(http_client, NULL, http_client_setup, http_client_before, NULL, NULL);
@@ -0,0 +1,528 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/fs/fs_sys.h>
+#include <zephyr/net/http/server.h>
+#include <zephyr/net/http/service.h>
+#include <zephyr/net/socket.h>
+
+#define SERVER_PORT 8080
+#define MAX_CLIENTS CONFIG_HTTP_SERVER_MAX_CLIENTS
+
+#define FILE_MNTP "/tfs"
+#define FILE_PATH FILE_MNTP "/file.txt"
+#define FILE_LEN  1000
+
+#define DYNAMIC_CHUNKS 3
+#define BENCH_REQUESTS 200
+
+struct response {
+	char body[FILE_LEN + 1];
+	size_t body_len;
+	int status;
+	bool chunked;
+	bool close;
+};
+
+struct conn {
+	int sock;
+	char buf[2048];
+	size_t len;
+};
+
+static uint16_t server_port = SERVER_PORT;
+HTTP_SERVICE_DEFINE(loopback, "::1", &server_port, MAX_CLIENTS, 2, NULL);
+
+static const char index_html[] = "<html>index</html>";
+
+static struct http_resource_detail_static index_detail = {
+	.common = {
+		.bitmask_of_supported_http_methods = BIT(HTTP_GET),
+		.type = HTTP_RESOURCE_TYPE_STATIC,
+		.content_type = "text/html",
+	},
+	.static_data = index_html,
+	.static_data_len = sizeof(index_html) - 1,
+};
+HTTP_RESOURCE_DEFINE(index_resource, loopback, "/", &index_detail);
+
+static size_t dynamic_received;
+static int dynamic_sent;
+
+static int dynamic_request(struct http_client_ctx *client, enum http_data_status status,
+			   const uint8_t *data, size_t len, void *user_data)
+{
+	if (status == HTTP_SERVER_DATA_MORE) {
+		dynamic_received += len;
+	} else if (status == HTTP_SERVER_DATA_FINAL) {
+		dynamic_sent = 0;
+	}
+
+	return 0;
+}
+
+static int dynamic_response(struct http_client_ctx *client, uint8_t *buf, size_t len,
+			    void *user_data)
+{
+	if (dynamic_sent == DYNAMIC_CHUNKS) {
+		return 0;
+	}
+
+	return snprintk((char *)buf, len, "chunk%d", dynamic_sent++);
+}
+
+static struct http_resource_detail_dynamic dynamic_detail = {
+	.common = {
+		.bitmask_of_supported_http_methods = BIT(HTTP_GET) | BIT(HTTP_POST),
+		.type = HTTP_RESOURCE_TYPE_DYNAMIC,
+	},
+	.request_cb = dynamic_request,
+	.response_cb = dynamic_response,
+};
+HTTP_RESOURCE_DEFINE(dynamic_resource, loopback, "/dynamic", &dynamic_detail);
+
+static struct http_resource_detail_static_fs file_detail = {
+	.common = {
+		.bitmask_of_supported_http_methods = BIT(HTTP_GET),
+		.type = HTTP_RESOURCE_TYPE_STATIC_FS,
+		.content_type = "text/plain",
+	},
+	.fs_path = FILE_PATH,
+};
+HTTP_RESOURCE_DEFINE(file_resource, loopback, "/file", &file_detail);
+
+/* Read only file system holding a single file, larger than the server
+ * buffers so that it is streamed in several pieces.
+ */
+static size_t file_pos;
+
+static char file_byte(size_t pos)
+{
+	return 'a' + pos % 26;
+}
+
+static int tfs_mount(struct fs_mount_t *mountp)
+{
+	return 0;
+}
+
+static int tfs_open(struct fs_file_t *filp, const char *path, fs_mode_t flags)
+{
+	if (strcmp(path, FILE_PATH) != 0) {
+		return -ENOENT;
+	}
+
+	file_pos = 0;
+	filp->filep = &file_pos;
+
+	return 0;
+}
+
+static ssize_t tfs_read(struct fs_file_t *filp, void *dest, size_t nbytes)
+{
+	size_t *pos = filp->filep;
+	size_t len = MIN(nbytes, FILE_LEN - *pos);
+
+	for (size_t i = 0; i < len; i++) {
+		((char *)dest)[i] = file_byte(*pos + i);
+	}
+
+	*pos += len;
+
+	return len;
+}
+
+static int tfs_close(struct fs_file_t *filp)
+{
+	return 0;
+}
+
+static int tfs_stat(struct fs_mount_t *mountp, const char *path, struct fs_dirent *entry)
+{
+	if (strcmp(path, FILE_PATH) != 0) {
+		return -ENOENT;
+	}
+
+	entry->type = FS_DIR_ENTRY_FILE;
+	entry->size = FILE_LEN;
+
+	return 0;
+}
+
+static const struct fs_file_system_t tfs = {
+	.mount = tfs_mount,
+	.open = tfs_open,
+	.read = tfs_read,
+	.close = tfs_close,
+	.stat = tfs_stat,
+};
+
+static struct fs_mount_t tfs_mnt = {
+	.type = FS_TYPE_EXTERNAL_BASE,
+	.mnt_point = FILE_MNTP,
+};
+
+static void conn_open(struct conn *c)
+{
+	struct sockaddr_in6 addr = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(SERVER_PORT),
+		.sin6_addr = IN6ADDR_LOOPBACK_INIT,
+	};
+	struct timeval timeout = {
+		.tv_sec = 2,
+	};
+
+	c->len = 0;
+	c->sock = zsock_socket(AF_INET6, SOCK_STREAM, IPPROTO_TCP);
+	zassert_true(c->sock >= 0, "socket() failed: %d", errno);
+	zassert_ok(zsock_setsockopt(c->sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)));
+	zassert_ok(zsock_connect(c->sock, (struct sockaddr *)&addr, sizeof(addr)));
+}
+
+static void conn_send(struct conn *c, const char *data)
+{
+	size_t len = strlen(data);
+
+	while (len > 0) {
+		ssize_t out = zsock_send(c->sock, data, len, 0);
+
+		zassert_true(out > 0, "send() failed: %d", errno);
+		data += out;
+		len -= out;
+	}
+}
+
+/* Make sure at least @p len bytes are buffered, 0 if the peer closed first */
+static int conn_fill(struct conn *c, size_t len)
+{
+	while (c->len < len) {
+		ssize_t ret = zsock_recv(c->sock, &c->buf[c->len], sizeof(c->buf) - c->len, 0);
+
+		if (ret <= 0) {
+			return ret < 0 ? -errno : 0;
+		}
+
+		c->len += ret;
+	}
+
+	return 1;
+}
+
+static void conn_consume(struct conn *c, size_t len)
+{
+	c->len -= len;
+	memmove(c->buf, &c->buf[len], c->len);
+}
+
+/* Length of the line at the start of the buffer, CRLF included */
+static int conn_line(struct conn *c)
+{
+	char *end;
+	int ret;
+
+	while (true) {
+		end = memchr(c->buf, '\n', c->len);
+		if (end != NULL) {
+			return end - c->buf + 1;
+		}
+
+		ret = conn_fill(c, c->len + 1);
+		if (ret <= 0) {
+			return ret;
+		}
+	}
+}
+
+static int read_response(struct conn *c, struct response *rsp)
+{
+	size_t content_len = 0;
+	size_t chunk_len;
+	int line;
+	int ret;
+
+	memset(rsp, 0, sizeof(*rsp));
+
+	line = conn_line(c);
+	if (line <= 0) {
+		return line < 0 ? line : -ENOTCONN;
+	}
+
+	rsp->status = atoi(&c->buf[sizeof("HTTP/1.1 ") - 1]);
+	conn_consume(c, line);
+
+	while ((line = conn_line(c)) > 2) {
+		if (strncmp(c->buf, "Content-Length: ", 16) == 0) {
+			content_len = atoi(&c->buf[16]);
+		} else if (strncmp(c->buf, "Transfer-Encoding: chunked", 26) == 0) {
+			rsp->chunked = true;
+		} else if (strncmp(c->buf, "Connection: close", 17) == 0) {
+			rsp->close = true;
+		}
+
+		conn_consume(c, line);
+	}
+
+	if (line <= 0) {
+		return -EBADMSG;
+	}
+
+	conn_consume(c, line);
+
+	if (!rsp->chunked) {
+		ret = conn_fill(c, content_len);
+		if (ret <= 0 || content_len >= sizeof(rsp->body)) {
+			return -EBADMSG;
+		}
+
+		memcpy(rsp->body, c->buf, content_len);
+		rsp->body_len = content_len;
+		conn_consume(c, content_len);
+		return 0;
+	}
+
+	do {
+		line = conn_line(c);
+		if (line <= 0) {
+			return -EBADMSG;
+		}
+
+		chunk_len = strtoul(c->buf, NULL, 16);
+		conn_consume(c, line);
+
+		ret = conn_fill(c, chunk_len + 2);
+		if (ret <= 0 || rsp->body_len + chunk_len >= sizeof(rsp->body)) {
+			return -EBADMSG;
+		}
+
+		memcpy(&rsp->body[rsp->body_len], c->buf, chunk_len);
+		rsp->body_len += chunk_len;
+		conn_consume(c, chunk_len + 2);
+	} while (chunk_len > 0);
+
+	return 0;
+}
+
+static void get(struct conn *c, const char *path, struct response *rsp)
+{
+	char request[64];
+
+	snprintk(request, sizeof(request), "GET %s HTTP/1.1\r\nHost: localhost\r\n\r\n", path);
+	conn_send(c, request);
+	zassert_ok(read_response(c, rsp), "no response for %s", path);
+}
+
+static void *http_server_setup(void)
+{
+	zassert_ok(fs_register(FS_TYPE_EXTERNAL_BASE, &tfs));
+	zassert_ok(fs_mount(&tfs_mnt));
+	zassert_ok(http_server_start());
+	zassert_equal(http_server_start(), -EALREADY);
+
+	return NULL;
+}
+
+static void http_server_teardown(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	zassert_ok(http_server_stop());
+}
+
+ZTEST(http_server, test_static_keep_alive)
+{
+	static struct response rsp;
+	static struct conn c;
+
+	conn_open(&c);
+
+	for (int i = 0; i < 3; i++) {
+		get(&c, "/", &rsp);
+		zassert_equal(rsp.status, 200);
+		zassert_false(rsp.close);
+		zassert_equal(rsp.body_len, strlen(index_html));
+		zassert_mem_equal(rsp.body, index_html, rsp.body_len);
+	}
+
+	zsock_close(c.sock);
+}
+
+ZTEST(http_server, test_errors)
+{
+	static struct response rsp;
+	static struct conn c;
+
+	conn_open(&c);
+
+	get(&c, "/missing", &rsp);
+	zassert_equal(rsp.status, 404);
+
+	conn_send(&c, "DELETE / HTTP/1.1\r\n\r\n");
+	zassert_ok(read_response(&c, &rsp));
+	zassert_equal(rsp.status, 405);
+
+	/* A malformed request is answered, then the connection is closed */
+	conn_send(&c, "NOT A REQUEST\r\n\r\n");
+	zassert_ok(read_response(&c, &rsp));
+	zassert_equal(rsp.status, 400);
+	zassert_true(rsp.close);
+	zassert_equal(conn_fill(&c, 1), 0);
+
+	zsock_close(c.sock);
+}
+
+ZTEST(http_server, test_pipelined)
+{
+	static struct response rsp;
+	static struct conn c;
+
+	conn_open(&c);
+
+	conn_send(&c, "GET / HTTP/1.1\r\n\r\n"
+		      "GET /dynamic HTTP/1.1\r\n\r\n"
+		      "GET /missing HTTP/1.1\r\n\r\n");
+
+	zassert_ok(read_response(&c, &rsp));
+	zassert_equal(rsp.status, 200);
+	zassert_mem_equal(rsp.body, index_html, rsp.body_len);
+
+	zassert_ok(read_response(&c, &rsp));
+	zassert_equal(rsp.status, 200);
+	zassert_true(rsp.chunked);
+
+	zassert_ok(read_response(&c, &rsp));
+	zassert_equal(rsp.status, 404);
+
+	zsock_close(c.sock);
+}
+
+ZTEST(http_server, test_dynamic_chunked)
+{
+	static struct response rsp;
+	static struct conn c;
+
+	conn_open(&c);
+	dynamic_received = 0;
+
+	conn_send(&c, "POST /dynamic HTTP/1.1\r\n"
+		      "Content-Length: 5\r\n"
+		      "\r\n"
+		      "hello");
+
+	zassert_ok(read_response(&c, &rsp));
+	zassert_equal(rsp.status, 200);
+	zassert_true(rsp.chunked);
+	zassert_equal(dynamic_received, 5);
+	zassert_str_equal(rsp.body, "chunk0chunk1chunk2");
+
+	zsock_close(c.sock);
+}
+
+ZTEST(http_server, test_file_streaming)
+{
+	static struct response rsp;
+	static struct conn c;
+
+	conn_open(&c);
+
+	get(&c, "/file", &rsp);
+	zassert_equal(rsp.status, 200);
+	zassert_equal(rsp.body_len, FILE_LEN);
+
+	for (size_t i = 0; i < FILE_LEN; i++) {
+		zassert_equal(rsp.body[i], file_byte(i), "mismatch at %zu", i);
+	}
+
+	/* The connection is still usable after a streamed response */
+	get(&c, "/", &rsp);
+	zassert_equal(rsp.status, 200);
+
+	zsock_close(c.sock);
+}
+
+ZTEST(http_server, test_connection_pool)
+{
+	static struct response rsp;
+	static struct conn c[MAX_CLIENTS + 1];
+
+	/* Let the server notice the connections closed by the previous tests */
+	k_msleep(100);
+
+	for (int i = 0; i < MAX_CLIENTS; i++) {
+		conn_open(&c[i]);
+		get(&c[i], "/", &rsp);
+		zassert_equal(rsp.status, 200);
+	}
+
+	/* The pool is full, the extra connection is closed right away */
+	conn_open(&c[MAX_CLIENTS]);
+	zassert_equal(conn_fill(&c[MAX_CLIENTS], 1), 0);
+	zsock_close(c[MAX_CLIENTS].sock);
+
+	/* Freeing an entry lets a new connection in */
+	zsock_close(c[0].sock);
+	k_msleep(100);
+
+	conn_open(&c[0]);
+	get(&c[0], "/", &rsp);
+	zassert_equal(rsp.status, 200);
+
+	for (int i = 0; i < MAX_CLIENTS; i++) {
+		zsock_close(c[i].sock);
+	}
+
+	k_msleep(100);
+}
+
+ZTEST(http_server, test_benchmark)
+{
+	static struct response rsp;
+	static struct conn c;
+	uint32_t start;
+	uint64_t reuse_ns, new_conn_ns;
+
+	/* A new connection per request, like the ad-hoc socket code */
+	start = k_cycle_get_32();
+
+	for (int i = 0; i < BENCH_REQUESTS; i++) {
+		conn_open(&c);
+		get(&c, "/", &rsp);
+		zassert_equal(rsp.status, 200);
+		zsock_close(c.sock);
+	}
+
+	new_conn_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	/* Keep-alive */
+	start = k_cycle_get_32();
+
+	conn_open(&c);
+
+	for (int i = 0; i < BENCH_REQUESTS; i++) {
+		get(&c, "/", &rsp);
+		zassert_equal(rsp.status, 200);
+	}
+
+	zsock_close(c.sock);
+
+	reuse_ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	TC_PRINT("%d requests: %u req/s with a new connection each, %u req/s keep-alive, "
+		 "%zu bytes per connection\n",
+		 BENCH_REQUESTS,
+		 new_conn_ns == 0 ? 0U
+				  : (uint32_t)((uint64_t)BENCH_REQUESTS * NSEC_PER_SEC / new_conn_ns),
+		 reuse_ns == 0 ? 0U : (uint32_t)((uint64_t)BENCH_REQUESTS * NSEC_PER_SEC / reuse_ns),
+		 sizeof(struct http_client_ctx));
+}
+
+ZTEST_SUITE(http_server, NULL, http_server_setup, NULL, NULL, http_server_teardown);
@@ -253,6 +253,8 @@ ZTEST(lwm2m_engine, test_check_notifications)
 	zassert_equal(generate_notify_message_fake.call_count, 1, "Notify message not generated");
 	zassert_equal(engine_observe_shedule_next_event_fake.call_count, 1,
 		      "Next observe event not scheduled");
+	zassert_equal(engine_observe_coalesce_fake.call_count, 1,
+		      "Coalescing not checked after notify");
 }
 
 ZTEST(lwm2m_engine, test_push_queued_buffers)
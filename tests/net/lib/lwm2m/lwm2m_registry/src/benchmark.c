@@ -0,0 +1,239 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+
+#include "lwm2m_engine.h"
+#include "lwm2m_observation.h"
+
+#define BENCH_OBJ_ID	 32769
+#define BENCH_RES_ID	 0
+#define BENCH_INSTANCES	 500
+#define BENCH_OBSERVERS	 100
+#define BENCH_OBS_STRIDE (BENCH_INSTANCES / BENCH_OBSERVERS)
+#define BENCH_ROUNDS	 10
+
+#define OBSERVER_INDEX (IS_ENABLED(CONFIG_LWM2M_ENGINE_OBSERVER_INDEX) ? "index" : "linear")
+
+static struct lwm2m_engine_obj bench_obj;
+static struct lwm2m_engine_obj_field bench_fields[] = {
+	OBJ_FIELD_DATA(BENCH_RES_ID, RW, U32),
+};
+
+static struct lwm2m_engine_obj_inst bench_inst[BENCH_INSTANCES];
+static struct lwm2m_engine_res bench_res[BENCH_INSTANCES][1];
+static struct lwm2m_engine_res_inst bench_res_inst[BENCH_INSTANCES][1];
+static uint32_t bench_value[BENCH_INSTANCES];
+
+static struct lwm2m_ctx bench_ctx;
+static struct lwm2m_message bench_msg;
+
+static struct lwm2m_engine_obj_inst *bench_obj_create(uint16_t obj_inst_id)
+{
+	int i = 0, j = 0;
+
+	if (obj_inst_id >= BENCH_INSTANCES) {
+		return NULL;
+	}
+
+	init_res_instance(bench_res_inst[obj_inst_id], ARRAY_SIZE(bench_res_inst[obj_inst_id]));
+	INIT_OBJ_RES_DATA(BENCH_RES_ID, bench_res[obj_inst_id], i, bench_res_inst[obj_inst_id], j,
+			  &bench_value[obj_inst_id], sizeof(bench_value[obj_inst_id]));
+
+	bench_inst[obj_inst_id].resources = bench_res[obj_inst_id];
+	bench_inst[obj_inst_id].resource_count = i;
+
+	return &bench_inst[obj_inst_id];
+}
+
+static void *bench_setup(void)
+{
+	struct lwm2m_engine_obj_inst *obj_inst;
+
+	bench_obj.obj_id = BENCH_OBJ_ID;
+	bench_obj.version_major = 1;
+	bench_obj.version_minor = 0;
+	bench_obj.fields = bench_fields;
+	bench_obj.field_count = ARRAY_SIZE(bench_fields);
+	bench_obj.max_instance_count = BENCH_INSTANCES;
+	bench_obj.create_cb = bench_obj_create;
+	lwm2m_register_obj(&bench_obj);
+
+	for (int i = 0; i < BENCH_INSTANCES; i++) {
+		zassert_ok(lwm2m_create_obj_inst(BENCH_OBJ_ID, i, &obj_inst));
+	}
+
+	return NULL;
+}
+
+static void bench_teardown(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	for (int i = 0; i < BENCH_INSTANCES; i++) {
+		(void)lwm2m_delete_obj_inst(BENCH_OBJ_ID, i);
+	}
+
+	lwm2m_unregister_obj(&bench_obj);
+}
+
+static int bench_observe(uint16_t obj_inst_id, uint8_t token)
+{
+	(void)memset(&bench_msg, 0, sizeof(bench_msg));
+	zassert_ok(coap_packet_init(&bench_msg.cpkt, bench_msg.msg_data,
+				    sizeof(bench_msg.msg_data), COAP_VERSION_1, COAP_TYPE_ACK, 0,
+				    NULL, COAP_RESPONSE_CODE_CONTENT, 0));
+
+	bench_msg.ctx = &bench_ctx;
+	bench_msg.out.out_cpkt = &bench_msg.cpkt;
+	bench_msg.path = LWM2M_OBJ(BENCH_OBJ_ID, obj_inst_id, BENCH_RES_ID);
+	bench_msg.token = &token;
+	bench_msg.tkl = sizeof(token);
+
+	return lwm2m_engine_observation_handler(&bench_msg, 0, LWM2M_FORMAT_PLAIN_TEXT, false);
+}
+
+ZTEST_SUITE(lwm2m_registry_bench, NULL, bench_setup, NULL, NULL, bench_teardown);
+
+ZTEST(lwm2m_registry_bench, test_lookup_benchmark)
+{
+	struct lwm2m_engine_obj_inst *obj_inst;
+	struct lwm2m_engine_res *res;
+	uint32_t start;
+	uint64_t cycles;
+
+	start = k_cycle_get_32();
+
+	for (int round = 0; round < BENCH_ROUNDS; round++) {
+		for (int i = 0; i < BENCH_INSTANCES; i++) {
+			obj_inst = NULL;
+			res = NULL;
+			zassert_ok(path_to_objs(&LWM2M_OBJ(BENCH_OBJ_ID, i, BENCH_RES_ID), &obj_inst,
+						NULL, &res, NULL));
+			zassert_equal(obj_inst, &bench_inst[i]);
+			zassert_equal(res, &bench_res[i][0]);
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	TC_PRINT("path lookup: %u instances, %u ns per lookup\n", BENCH_INSTANCES,
+		 (uint32_t)(k_cyc_to_ns_floor64(cycles) / (BENCH_ROUNDS * BENCH_INSTANCES)));
+}
+
+ZTEST(lwm2m_registry_bench, test_notify_benchmark)
+{
+	uint32_t start;
+	uint64_t cycles;
+	int matched = 0;
+	int ret;
+
+	/* Keep the engine thread from sending notifications to the fake peer */
+	lwm2m_registry_lock();
+
+	(void)memset(&bench_ctx, 0, sizeof(bench_ctx));
+	bench_ctx.sock_fd = -1;
+	lwm2m_engine_context_init(&bench_ctx);
+	zassert_ok(lwm2m_socket_add(&bench_ctx));
+
+	for (int i = 0; i < BENCH_OBSERVERS; i++) {
+		zassert_ok(bench_observe(i * BENCH_OBS_STRIDE, i + 1));
+	}
+
+	start = k_cycle_get_32();
+
+	for (int round = 0; round < BENCH_ROUNDS; round++) {
+		for (int i = 0; i < BENCH_INSTANCES; i++) {
+			ret = lwm2m_notify_observer(BENCH_OBJ_ID, i, BENCH_RES_ID);
+			zassert_true(ret >= 0, "notify failed: %d", ret);
+			zassert_equal(ret > 0, (i % BENCH_OBS_STRIDE) == 0,
+				      "unexpected dispatch for instance %d", i);
+			matched += ret > 0;
+		}
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	/* An object level change reaches every observer below it */
+	zassert_true(lwm2m_notify_observer_path(&LWM2M_OBJ(BENCH_OBJ_ID)) > 0);
+
+	lwm2m_engine_context_close(&bench_ctx);
+	lwm2m_socket_del(&bench_ctx);
+	lwm2m_registry_unlock();
+
+	zassert_equal(matched, BENCH_ROUNDS * BENCH_OBSERVERS);
+
+	TC_PRINT("%s notify: %u instances, %u observers, %u ns per resource change\n",
+		 OBSERVER_INDEX, BENCH_INSTANCES, BENCH_OBSERVERS,
+		 (uint32_t)(k_cyc_to_ns_floor64(cycles) / (BENCH_ROUNDS * BENCH_INSTANCES)));
+}
+
+static struct observe_node *bench_obs(uint8_t token)
+{
+	sys_snode_t *prev_node = NULL;
+
+	return engine_observe_node_discover(&bench_ctx.observer, &prev_node, NULL, &token,
+					    sizeof(token));
+}
+
+ZTEST(lwm2m_registry_bench, test_notify_coalescing)
+{
+	const int64_t window = CONFIG_LWM2M_ENGINE_NOTIFY_COALESCE_WINDOW;
+	struct observe_node *obs[3];
+	int64_t now;
+
+	if (window == 0) {
+		ztest_test_skip();
+	}
+
+	lwm2m_registry_lock();
+
+	(void)memset(&bench_ctx, 0, sizeof(bench_ctx));
+	bench_ctx.sock_fd = -1;
+	lwm2m_engine_context_init(&bench_ctx);
+	zassert_ok(lwm2m_socket_add(&bench_ctx));
+
+	for (int i = 0; i < ARRAY_SIZE(obs); i++) {
+		zassert_ok(bench_observe(i, i + 1));
+		obs[i] = bench_obs(i + 1);
+		zassert_not_null(obs[i]);
+	}
+
+	/* The first change opens the window, the next ones are merged into it */
+	now = k_uptime_get();
+	zassert_equal(lwm2m_notify_observer(BENCH_OBJ_ID, 0, BENCH_RES_ID), 1);
+	zassert_true(obs[0]->resource_update);
+	zassert_true(obs[0]->event_timestamp >= now + window);
+	zassert_equal(bench_ctx.notify_merged, 0);
+
+	zassert_equal(lwm2m_notify_observer(BENCH_OBJ_ID, 0, BENCH_RES_ID), 1);
+	zassert_equal(lwm2m_notify_observer(BENCH_OBJ_ID, 0, BENCH_RES_ID), 1);
+	zassert_equal(bench_ctx.notify_merged, 2);
+	zassert_true(obs[0]->event_timestamp <= k_uptime_get() + window);
+
+	/* Notifications due within the window are sent along with the first
+	 * one, the ones due later wait.
+	 */
+	now = k_uptime_get();
+	obs[1]->event_timestamp = now + window / 2;
+	obs[2]->event_timestamp = now + 2 * window;
+
+	zassert_equal(engine_observe_coalesce(&bench_ctx, now), 2);
+	zassert_equal(obs[0]->event_timestamp, now);
+	zassert_equal(obs[1]->event_timestamp, now);
+	zassert_equal(obs[2]->event_timestamp, now + 2 * window);
+
+	/* Nothing is brought forward before pmin has elapsed */
+	zassert_ok(lwm2m_update_observer_min_period(&bench_ctx, &LWM2M_OBJ(BENCH_OBJ_ID, 2,
+									 BENCH_RES_ID), 10));
+	obs[2]->event_timestamp = now + window / 2;
+	obs[2]->last_timestamp = now;
+	zassert_equal(engine_observe_coalesce(&bench_ctx, now), 0);
+
+	lwm2m_engine_context_close(&bench_ctx);
+	lwm2m_socket_del(&bench_ctx);
+	lwm2m_registry_unlock();
+}
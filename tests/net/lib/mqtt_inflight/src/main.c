@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/net/mqtt.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/ztest.h>
+
+#define WINDOW	   CONFIG_MQTT_INFLIGHT_WINDOW
+#define BATCH_SIZE CONFIG_MQTT_PUBLISH_BATCH_SIZE
+
+#define PKT_PUBLISH 0x30
+#define PKT_PUBACK  0x40
+#define PKT_PUBREC  0x50
+#define PKT_PUBREL  0x60
+#define PKT_PUBCOMP 0x70
+#define DUP_FLAG    0x08
+
+#define BENCH_MESSAGES 64
+
+static uint8_t rx_buffer[256];
+static uint8_t tx_buffer[256];
+static struct mqtt_client client;
+
+/* Scripted broker: bytes written by the client and bytes it will read. */
+static uint8_t sent[1024];
+static size_t sent_len;
+static int sent_writes;
+static uint8_t to_recv[256];
+static size_t to_recv_len;
+static size_t to_recv_off;
+
+static int puback_events;
+
+static struct mqtt_topic topic = {
+	.topic = MQTT_UTF8_LITERAL("sensors"),
+};
+static uint8_t payload[] = "21.5";
+
+struct sent_packet {
+	uint8_t type;
+	uint16_t message_id;
+};
+
+int mqtt_client_custom_transport_connect(struct mqtt_client *c)
+{
+	ARG_UNUSED(c);
+
+	return 0;
+}
+
+int mqtt_client_custom_transport_write(struct mqtt_client *c, const uint8_t *data,
+				       uint32_t datalen)
+{
+	ARG_UNUSED(c);
+
+	if (sent_len + datalen > sizeof(sent)) {
+		return -ENOMEM;
+	}
+
+	memcpy(&sent[sent_len], data, datalen);
+	sent_len += datalen;
+	sent_writes++;
+
+	return 0;
+}
+
+int mqtt_client_custom_transport_write_msg(struct mqtt_client *c, const struct msghdr *message)
+{
+	ARG_UNUSED(c);
+
+	for (size_t i = 0; i < message->msg_iovlen; i++) {
+		if (sent_len + message->msg_iov[i].iov_len > sizeof(sent)) {
+			return -ENOMEM;
+		}
+
+		memcpy(&sent[sent_len], message->msg_iov[i].iov_base, message->msg_iov[i].iov_len);
+		sent_len += message->msg_iov[i].iov_len;
+	}
+
+	sent_writes++;
+
+	return 0;
+}
+
+int mqtt_client_custom_transport_read(struct mqtt_client *c, uint8_t *data, uint32_t buflen,
+				      bool shall_block)
+{
+	size_t len = MIN(buflen, to_recv_len - to_recv_off);
+
+	ARG_UNUSED(c);
+	ARG_UNUSED(shall_block);
+
+	if (len == 0) {
+		return -EAGAIN;
+	}
+
+	memcpy(data, &to_recv[to_recv_off], len);
+	to_recv_off += len;
+
+	return len;
+}
+
+int mqtt_client_custom_transport_disconnect(struct mqtt_client *c)
+{
+	ARG_UNUSED(c);
+
+	return 0;
+}
+
+static void evt_handler(struct mqtt_client *const c, const struct mqtt_evt *evt)
+{
+	if (evt->type == MQTT_EVT_PUBACK) {
+		puback_events++;
+	}
+}
+
+static void sent_reset(void)
+{
+	sent_len = 0;
+	sent_writes = 0;
+}
+
+static int sent_parse(struct sent_packet *pkts, int max)
+{
+	size_t off = 0;
+	int count = 0;
+
+	while (off < sent_len && count < max) {
+		const uint8_t *body;
+		uint32_t len = 0;
+		uint8_t shift = 0;
+		uint8_t type = sent[off++];
+		uint16_t topic_len;
+
+		do {
+			len |= (sent[off] & 0x7F) << shift;
+			shift += 7;
+		} while (sent[off++] & 0x80);
+
+		body = &sent[off];
+		off += len;
+
+		pkts[count].type = type;
+		pkts[count].message_id = 0;
+
+		if ((type & 0xF0) == PKT_PUBLISH && (type & 0x06) != 0) {
+			topic_len = sys_get_be16(body);
+			pkts[count].message_id = sys_get_be16(&body[2 + topic_len]);
+		} else if ((type & 0xF0) == PKT_PUBREL) {
+			pkts[count].message_id = sys_get_be16(body);
+		}
+
+		count++;
+	}
+
+	return count;
+}
+
+static void broker_send(const uint8_t *data, size_t len)
+{
+	zassert_true(to_recv_len + len <= sizeof(to_recv));
+	memcpy(&to_recv[to_recv_len], data, len);
+	to_recv_len += len;
+}
+
+static void broker_ack(uint8_t type, uint16_t message_id)
+{
+	uint8_t pkt[] = {type, 0x02, message_id >> 8, message_id & 0xFF};
+
+	broker_send(pkt, sizeof(pkt));
+}
+
+static void client_process(void)
+{
+	while (to_recv_off < to_recv_len) {
+		zassert_ok(mqtt_input(&client));
+	}
+
+	to_recv_len = 0;
+	to_recv_off = 0;
+}
+
+static void client_connect(bool session_present)
+{
+	const uint8_t connack[] = {0x20, 0x02, session_present, 0x00};
+
+	zassert_ok(mqtt_connect(&client));
+	broker_send(connack, sizeof(connack));
+	client_process();
+}
+
+static void publish_param_init(struct mqtt_publish_param *param, uint8_t qos, uint16_t message_id)
+{
+	memset(param, 0, sizeof(*param));
+	param->message.topic = topic;
+	param->message.topic.qos = qos;
+	param->message.payload.data = payload;
+	param->message.payload.len = sizeof(payload) - 1;
+	param->message_id = message_id;
+}
+
+static void inflight_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	mqtt_client_init(&client);
+	client.client_id.utf8 = (uint8_t *)"zephyr";
+	client.client_id.size = strlen("zephyr");
+	client.evt_cb = evt_handler;
+	client.rx_buf = rx_buffer;
+	client.rx_buf_size = sizeof(rx_buffer);
+	client.tx_buf = tx_buffer;
+	client.tx_buf_size = sizeof(tx_buffer);
+	client.transport.type = MQTT_TRANSPORT_CUSTOM;
+
+	puback_events = 0;
+	to_recv_len = 0;
+	to_recv_off = 0;
+
+	client_connect(false);
+	sent_reset();
+}
+
+static void inflight_after(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	(void)mqtt_abort(&client);
+}
+
+ZTEST(mqtt_inflight, test_batch_single_write)
+{
+	struct mqtt_publish_param params[BATCH_SIZE];
+	struct sent_packet pkts[BATCH_SIZE + 1];
+
+	for (int i = 0; i < BATCH_SIZE; i++) {
+		publish_param_init(&params[i], MQTT_QOS_0_AT_MOST_ONCE, 0);
+	}
+
+	zassert_equal(mqtt_publish_batch(&client, params, BATCH_SIZE), BATCH_SIZE);
+	zassert_equal(sent_writes, 1, "batch used %d writes", sent_writes);
+	zassert_equal(sent_parse(pkts, ARRAY_SIZE(pkts)), BATCH_SIZE);
+
+	for (int i = 0; i < BATCH_SIZE; i++) {
+		zassert_equal(pkts[i].type, PKT_PUBLISH);
+	}
+}
+
+ZTEST(mqtt_inflight, test_window_full)
+{
+	struct mqtt_publish_param params[WINDOW + 1];
+	struct sent_packet pkts[WINDOW];
+
+	for (int i = 0; i < ARRAY_SIZE(params); i++) {
+		publish_param_init(&params[i], MQTT_QOS_1_AT_LEAST_ONCE, 0);
+	}
+
+	/* Only the window is published, message ids are assigned */
+	zassert_equal(mqtt_publish_batch(&client, params, ARRAY_SIZE(params)), WINDOW);
+	zassert_equal(mqtt_publish(&client, &params[WINDOW]), -EBUSY);
+	zassert_equal(sent_parse(pkts, ARRAY_SIZE(pkts)), WINDOW);
+
+	for (int i = 0; i < WINDOW; i++) {
+		zassert_equal(pkts[i].type, PKT_PUBLISH | (MQTT_QOS_1_AT_LEAST_ONCE << 1));
+		zassert_not_equal(pkts[i].message_id, 0);
+		zassert_equal(params[i].message_id, pkts[i].message_id,
+			      "assigned message id not returned");
+	}
+
+	/* The message not published keeps no message id */
+	zassert_equal(params[WINDOW].message_id, 0);
+
+	/* An acknowledgment frees a slot */
+	broker_ack(PKT_PUBACK, pkts[1].message_id);
+	client_process();
+	zassert_equal(puback_events, 1);
+
+	zassert_ok(mqtt_publish(&client, &params[WINDOW]));
+	zassert_equal(mqtt_publish(&client, &params[WINDOW]), -EBUSY);
+
+	/* QoS 0 messages are not tracked */
+	publish_param_init(&params[0], MQTT_QOS_0_AT_MOST_ONCE, 0);
+	zassert_ok(mqtt_publish(&client, &params[0]));
+}
+
+ZTEST(mqtt_inflight, test_resend_on_reconnect)
+{
+	struct mqtt_publish_param params[3];
+	struct sent_packet pkts[4];
+
+	publish_param_init(&params[0], MQTT_QOS_1_AT_LEAST_ONCE, 10);
+	publish_param_init(&params[1], MQTT_QOS_2_EXACTLY_ONCE, 11);
+	publish_param_init(&params[2], MQTT_QOS_2_EXACTLY_ONCE, 12);
+
+	zassert_equal(mqtt_publish_batch(&client, params, ARRAY_SIZE(params)), 3);
+
+	/* Message 11 reaches the broker, the connection drops before PUBCOMP */
+	broker_ack(PKT_PUBREC, 11);
+	client_process();
+	zassert_ok(mqtt_abort(&client));
+
+	sent_reset();
+	client_connect(true);
+
+	/* CONNECT, then the window in order: DUP PUBLISH, PUBREL, DUP PUBLISH */
+	zassert_equal(sent_parse(pkts, ARRAY_SIZE(pkts)), 4);
+	zassert_equal(pkts[1].type, PKT_PUBLISH | DUP_FLAG | (MQTT_QOS_1_AT_LEAST_ONCE << 1));
+	zassert_equal(pkts[1].message_id, 10);
+	zassert_equal(pkts[2].type & 0xF0, PKT_PUBREL);
+	zassert_equal(pkts[2].message_id, 11);
+	zassert_equal(pkts[3].type, PKT_PUBLISH | DUP_FLAG | (MQTT_QOS_2_EXACTLY_ONCE << 1));
+	zassert_equal(pkts[3].message_id, 12);
+
+	/* Completed messages are not resent */
+	broker_ack(PKT_PUBACK, 10);
+	broker_ack(PKT_PUBCOMP, 11);
+	client_process();
+	zassert_ok(mqtt_abort(&client));
+
+	sent_reset();
+	client_connect(false);
+
+	/* Without a session, only the unreleased message is published anew */
+	zassert_equal(sent_parse(pkts, ARRAY_SIZE(pkts)), 2);
+	zassert_equal(pkts[1].type, PKT_PUBLISH | (MQTT_QOS_2_EXACTLY_ONCE << 1));
+	zassert_equal(pkts[1].message_id, 12);
+}
+
+ZTEST(mqtt_inflight, test_round_trip_benchmark)
+{
+	struct mqtt_publish_param params[WINDOW];
+	struct sent_packet pkts[WINDOW];
+	int published = 0;
+	int round_trips = 0;
+	int writes = 0;
+	int ret;
+
+	/* Each iteration models one link round trip: fill the window with a
+	 * single write, then receive the acknowledgments for it.
+	 */
+	while (published < BENCH_MESSAGES) {
+		sent_reset();
+
+		for (int i = 0; i < WINDOW; i++) {
+			publish_param_init(&params[i], MQTT_QOS_1_AT_LEAST_ONCE, 0);
+		}
+
+		ret = mqtt_publish_batch(&client, params, MIN(WINDOW, BENCH_MESSAGES - published));
+		zassert_true(ret > 0, "publish failed: %d", ret);
+
+		published += ret;
+		writes += sent_writes;
+		round_trips++;
+
+		zassert_equal(sent_parse(pkts, ARRAY_SIZE(pkts)), ret);
+		for (int i = 0; i < ret; i++) {
+			broker_ack(PKT_PUBACK, pkts[i].message_id);
+		}
+
+		client_process();
+	}
+
+	zassert_equal(puback_events, BENCH_MESSAGES);
+
+	TC_PRINT("%d QoS 1 messages: %d round trips and %d writes, stop-and-wait needs %d\n",
+		 BENCH_MESSAGES, round_trips, writes, BENCH_MESSAGES);
+}
+
+ZTEST_SUITE(mqtt_inflight, NULL, NULL, inflight_before, inflight_after, NULL);
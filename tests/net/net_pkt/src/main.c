@@ -666,6 +666,75 @@ ZTEST(net_pkt_test_suite, test_net_pkt_copy)
 		     "Pkt not properly unreferenced");
 }
 
+static uint16_t chksum_ref(const uint8_t *data, size_t len)
+{
+	uint16_t sum = 0U;
+	uint16_t tmp;
+
+	for (size_t i = 0; i < len; i++) {
+		tmp = (i % 2) ? data[i] : data[i] << 8;
+		sum += tmp;
+		if (sum < tmp) {
+			sum++;
+		}
+	}
+
+	return sum;
+}
+
+#define CHKSUM_TEST_PKT_DATA_SIZE 601
+
+ZTEST(net_pkt_test_suite, test_net_pkt_copy_chksum)
+{
+	static uint8_t data[CHKSUM_TEST_PKT_DATA_SIZE];
+	struct net_pkt *pkt_src;
+	struct net_pkt *pkt_dst;
+	uint16_t chksum;
+	int res;
+
+	for (int i = 0; i < sizeof(data); i++) {
+		data[i] = (uint8_t)(i * 7 + 3);
+	}
+
+	pkt_src = net_pkt_alloc_with_buffer(eth_if, sizeof(data), AF_UNSPEC,
+					    0, K_NO_WAIT);
+	zassert_true(pkt_src != NULL, "Pkt not allocated");
+
+	/* Odd sized first write, so that the following fragments start at
+	 * odd offsets of the checksummed data.
+	 */
+	res = net_pkt_write_chksum(pkt_src, data, 1, &chksum);
+	zassert_equal(res, 0, "Write failed");
+	zassert_equal(chksum, chksum_ref(data, 1), "Wrong checksum");
+
+	res = net_pkt_write_chksum(pkt_src, data + 1, sizeof(data) - 1, &chksum);
+	zassert_equal(res, 0, "Write failed");
+	zassert_equal(chksum, chksum_ref(data + 1, sizeof(data) - 1),
+		      "Wrong checksum");
+
+	pkt_dst = net_pkt_alloc_with_buffer(eth_if, sizeof(data), AF_UNSPEC,
+					    0, K_NO_WAIT);
+	zassert_true(pkt_dst != NULL, "Pkt not allocated");
+
+	net_pkt_cursor_init(pkt_src);
+	net_pkt_set_overwrite(pkt_src, true);
+	net_pkt_skip(pkt_src, 3);
+
+	res = net_pkt_copy_chksum(pkt_dst, pkt_src, sizeof(data) - 3, &chksum);
+	zassert_equal(res, 0, "Copy failed");
+	zassert_equal(chksum, chksum_ref(data + 3, sizeof(data) - 3),
+		      "Wrong checksum");
+
+	net_pkt_cursor_init(pkt_dst);
+	net_pkt_set_overwrite(pkt_dst, true);
+	res = net_pkt_read(pkt_dst, small_buffer, 100);
+	zassert_equal(res, 0, "Read failed");
+	zassert_mem_equal(small_buffer, data + 3, 100, "Data not copied");
+
+	net_pkt_unref(pkt_src);
+	net_pkt_unref(pkt_dst);
+}
+
 #define PULL_TEST_PKT_DATA_SIZE 600
 
 ZTEST(net_pkt_test_suite, test_net_pkt_pull)
@@ -0,0 +1,362 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_SOCKETS_LOG_LEVEL);
+
+#include <zephyr/ztest_assert.h>
+
+#include <zephyr/net/socket_rtio.h>
+
+#include "../../socket_helpers.h"
+
+#define TEST_STR "test"
+#define TEST_STR_LEN (sizeof(TEST_STR) - 1)
+
+#define MY_IPV6_ADDR "::1"
+
+#define ANY_PORT 0
+#define SERVER_PORT 4242
+
+#define NUM_PAIRS 4
+
+#define WAIT_TIME K_MSEC(1000)
+#define NO_CQE_TIME K_MSEC(100)
+
+RTIO_DEFINE_WITH_MEMPOOL(r, 16, 16, 16, 64, 4);
+
+ZSOCK_RTIO_IODEV_DEFINE(listen_iodev);
+ZSOCK_RTIO_IODEV_DEFINE(client_iodev);
+ZSOCK_RTIO_IODEV_DEFINE(server_iodev);
+
+ZSOCK_RTIO_IODEV_DEFINE(pair_tx_0);
+ZSOCK_RTIO_IODEV_DEFINE(pair_tx_1);
+ZSOCK_RTIO_IODEV_DEFINE(pair_tx_2);
+ZSOCK_RTIO_IODEV_DEFINE(pair_tx_3);
+ZSOCK_RTIO_IODEV_DEFINE(pair_rx_0);
+ZSOCK_RTIO_IODEV_DEFINE(pair_rx_1);
+ZSOCK_RTIO_IODEV_DEFINE(pair_rx_2);
+ZSOCK_RTIO_IODEV_DEFINE(pair_rx_3);
+
+static const struct rtio_iodev *const pair_tx[NUM_PAIRS] = {
+	&pair_tx_0, &pair_tx_1, &pair_tx_2, &pair_tx_3,
+};
+
+static const struct rtio_iodev *const pair_rx[NUM_PAIRS] = {
+	&pair_rx_0, &pair_rx_1, &pair_rx_2, &pair_rx_3,
+};
+
+/* Userdata identifying the submissions */
+enum {
+	OP_ACCEPT = 1,
+	OP_CONNECT,
+	OP_SEND,
+	OP_RECV,
+};
+
+struct test_cqe {
+	int32_t result;
+	uintptr_t userdata;
+	uint8_t data[64];
+	uint32_t data_len;
+};
+
+static void submit(void)
+{
+	zassert_ok(rtio_submit(&r, 0), "submit failed");
+}
+
+static struct rtio_sqe *acquire(void)
+{
+	struct rtio_sqe *sqe = rtio_sqe_acquire(&r);
+
+	zassert_not_null(sqe, "no free submission");
+
+	return sqe;
+}
+
+/* Consume a completion, copying out and releasing its mempool buffer */
+static bool get_cqe(struct test_cqe *out, k_timeout_t timeout)
+{
+	k_timepoint_t end = sys_timepoint_calc(timeout);
+	struct rtio_cqe *cqe;
+	uint8_t *buf;
+	uint32_t buf_len;
+
+	while ((cqe = rtio_cqe_consume(&r)) == NULL) {
+		if (sys_timepoint_expired(end)) {
+			return false;
+		}
+
+		k_msleep(1);
+	}
+
+	out->result = cqe->result;
+	out->userdata = (uintptr_t)cqe->userdata;
+	out->data_len = 0;
+
+	if (rtio_cqe_get_mempool_buffer(&r, cqe, &buf, &buf_len) == 0) {
+		if (cqe->result > 0) {
+			zassert_true(cqe->result <= sizeof(out->data), "too much data");
+			memcpy(out->data, buf, cqe->result);
+			out->data_len = cqe->result;
+		}
+
+		rtio_release_buffer(&r, buf, buf_len);
+	}
+
+	rtio_cqe_release(&r, cqe);
+
+	return true;
+}
+
+static void wait_cqe(struct test_cqe *out)
+{
+	zassert_true(get_cqe(out, WAIT_TIME), "timeout waiting for completion");
+}
+
+static void assert_no_cqe(void)
+{
+	struct test_cqe cqe;
+
+	zassert_false(get_cqe(&cqe, NO_CQE_TIME), "unexpected completion (%d)", cqe.result);
+}
+
+static void prepare_udp_pair(int *c_sock, int *s_sock, uint16_t port)
+{
+	struct sockaddr_in6 c_addr;
+	struct sockaddr_in6 s_addr;
+
+	prepare_sock_udp_v6(MY_IPV6_ADDR, ANY_PORT, c_sock, &c_addr);
+	prepare_sock_udp_v6(MY_IPV6_ADDR, port, s_sock, &s_addr);
+
+	zassert_ok(zsock_bind(*s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr)),
+		   "bind failed");
+	zassert_ok(zsock_connect(*c_sock, (struct sockaddr *)&s_addr, sizeof(s_addr)),
+		   "connect failed");
+}
+
+ZTEST(net_socket_rtio, test_tcp_accept_connect_send_recv)
+{
+	struct sockaddr_in6 c_addr;
+	struct sockaddr_in6 s_addr;
+	struct sockaddr_in6 peer;
+	struct test_cqe cqe;
+	int c_sock;
+	int s_sock;
+	int new_sock = -1;
+	bool connected = false;
+
+	prepare_sock_tcp_v6(MY_IPV6_ADDR, ANY_PORT, &c_sock, &c_addr);
+	prepare_sock_tcp_v6(MY_IPV6_ADDR, SERVER_PORT, &s_sock, &s_addr);
+
+	zassert_ok(zsock_bind(s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr)),
+		   "bind failed");
+	zassert_ok(zsock_listen(s_sock, 1), "listen failed");
+
+	zassert_ok(zsock_rtio_iodev_attach(&listen_iodev, s_sock), "attach failed");
+	zassert_ok(zsock_rtio_iodev_attach(&client_iodev, c_sock), "attach failed");
+	zassert_equal(zsock_rtio_iodev_attach(&client_iodev, c_sock), -EBUSY,
+		      "attached twice");
+
+	zsock_rtio_sqe_prep_accept(acquire(), &listen_iodev, (struct sockaddr *)&peer,
+				   sizeof(peer), (void *)OP_ACCEPT);
+	zsock_rtio_sqe_prep_connect(acquire(), &client_iodev, (struct sockaddr *)&s_addr,
+				    sizeof(s_addr), (void *)OP_CONNECT);
+	submit();
+
+	for (int i = 0; i < 2; i++) {
+		wait_cqe(&cqe);
+
+		if (cqe.userdata == OP_ACCEPT) {
+			zassert_true(cqe.result >= 0, "accept failed (%d)", cqe.result);
+			new_sock = cqe.result;
+		} else {
+			zassert_equal(cqe.userdata, OP_CONNECT, "unexpected completion");
+			zassert_ok(cqe.result, "connect failed (%d)", cqe.result);
+			connected = true;
+		}
+	}
+
+	zassert_true(new_sock >= 0 && connected, "not connected");
+	zassert_equal(peer.sin6_family, AF_INET6, "peer address not set");
+	zassert_ok(zsock_rtio_iodev_attach(&server_iodev, new_sock), "attach failed");
+
+	rtio_sqe_prep_read_multishot(acquire(), &server_iodev, RTIO_PRIO_NORM, (void *)OP_RECV);
+	submit();
+
+	/* No data yet, the multishot read must not complete */
+	assert_no_cqe();
+
+	rtio_sqe_prep_write(acquire(), &client_iodev, RTIO_PRIO_NORM, (uint8_t *)TEST_STR,
+			    TEST_STR_LEN, (void *)OP_SEND);
+	submit();
+
+	for (int i = 0; i < 2; i++) {
+		wait_cqe(&cqe);
+
+		if (cqe.userdata == OP_SEND) {
+			zassert_equal(cqe.result, TEST_STR_LEN, "send failed (%d)", cqe.result);
+		} else {
+			zassert_equal(cqe.userdata, OP_RECV, "unexpected completion");
+			zassert_equal(cqe.result, TEST_STR_LEN, "recv failed (%d)", cqe.result);
+			zassert_mem_equal(cqe.data, TEST_STR, TEST_STR_LEN, "wrong data");
+		}
+	}
+
+	/* Closing the client ends the stream, which ends the multishot read */
+	zsock_rtio_iodev_detach(&client_iodev);
+	zassert_ok(zsock_close(c_sock), "close failed");
+
+	wait_cqe(&cqe);
+	zassert_equal(cqe.userdata, OP_RECV, "unexpected completion");
+	zassert_equal(cqe.result, 0, "expected end of stream (%d)", cqe.result);
+	assert_no_cqe();
+
+	zsock_rtio_iodev_detach(&server_iodev);
+	zsock_rtio_iodev_detach(&listen_iodev);
+	zassert_ok(zsock_close(new_sock), "close failed");
+	zassert_ok(zsock_close(s_sock), "close failed");
+}
+
+ZTEST(net_socket_rtio, test_udp_multishot_recv)
+{
+	struct test_cqe cqe;
+	int c_sock;
+	int s_sock;
+	int sent = 0;
+	int received = 0;
+
+	prepare_udp_pair(&c_sock, &s_sock, SERVER_PORT);
+
+	zassert_ok(zsock_rtio_iodev_attach(&client_iodev, c_sock), "attach failed");
+	zassert_ok(zsock_rtio_iodev_attach(&server_iodev, s_sock), "attach failed");
+
+	rtio_sqe_prep_read_multishot(acquire(), &server_iodev, RTIO_PRIO_NORM, (void *)OP_RECV);
+
+	for (int i = 0; i < 3; i++) {
+		rtio_sqe_prep_write(acquire(), &client_iodev, RTIO_PRIO_NORM,
+				    (uint8_t *)TEST_STR, TEST_STR_LEN, (void *)OP_SEND);
+	}
+
+	submit();
+
+	while (sent < 3 || received < 3) {
+		wait_cqe(&cqe);
+
+		if (cqe.userdata == OP_SEND) {
+			zassert_equal(cqe.result, TEST_STR_LEN, "send failed (%d)", cqe.result);
+			sent++;
+		} else {
+			zassert_equal(cqe.userdata, OP_RECV, "unexpected completion");
+			zassert_equal(cqe.result, TEST_STR_LEN, "recv failed (%d)", cqe.result);
+			zassert_mem_equal(cqe.data, TEST_STR, TEST_STR_LEN, "wrong data");
+			received++;
+		}
+	}
+
+	/* Detaching stops the multishot read without a completion */
+	zsock_rtio_iodev_detach(&server_iodev);
+	zsock_rtio_iodev_detach(&client_iodev);
+	assert_no_cqe();
+
+	zassert_ok(zsock_close(c_sock), "close failed");
+	zassert_ok(zsock_close(s_sock), "close failed");
+}
+
+ZTEST(net_socket_rtio, test_detach_cancels)
+{
+	struct sockaddr_in6 s_addr;
+	struct test_cqe cqe;
+	uint8_t buf[8];
+	int s_sock;
+
+	prepare_sock_tcp_v6(MY_IPV6_ADDR, SERVER_PORT, &s_sock, &s_addr);
+	zassert_ok(zsock_bind(s_sock, (struct sockaddr *)&s_addr, sizeof(s_addr)),
+		   "bind failed");
+	zassert_ok(zsock_listen(s_sock, 1), "listen failed");
+
+	zassert_ok(zsock_rtio_iodev_attach(&listen_iodev, s_sock), "attach failed");
+
+	zsock_rtio_sqe_prep_accept(acquire(), &listen_iodev, NULL, 0, (void *)OP_ACCEPT);
+	submit();
+	assert_no_cqe();
+
+	zsock_rtio_iodev_detach(&listen_iodev);
+
+	wait_cqe(&cqe);
+	zassert_equal(cqe.userdata, OP_ACCEPT, "unexpected completion");
+	zassert_equal(cqe.result, -ECANCELED, "expected cancellation (%d)", cqe.result);
+
+	/* Submissions to an unbound device fail right away */
+	rtio_sqe_prep_read(acquire(), &listen_iodev, RTIO_PRIO_NORM, buf, sizeof(buf),
+			   (void *)OP_RECV);
+	submit();
+
+	wait_cqe(&cqe);
+	zassert_equal(cqe.result, -EBADF, "expected -EBADF (%d)", cqe.result);
+
+	zassert_ok(zsock_close(s_sock), "close failed");
+}
+
+ZTEST(net_socket_rtio, test_many_sockets_one_thread)
+{
+	int c_sock[NUM_PAIRS];
+	int s_sock[NUM_PAIRS];
+	uint8_t rx_buf[NUM_PAIRS][TEST_STR_LEN];
+	int pending = 0;
+	struct test_cqe cqe;
+
+	for (int i = 0; i < NUM_PAIRS; i++) {
+		prepare_udp_pair(&c_sock[i], &s_sock[i], SERVER_PORT + i);
+		zassert_ok(zsock_rtio_iodev_attach(pair_tx[i], c_sock[i]), "attach failed");
+		zassert_ok(zsock_rtio_iodev_attach(pair_rx[i], s_sock[i]), "attach failed");
+	}
+
+	/* Queue a receive on every socket before anything is sent */
+	for (int i = 0; i < NUM_PAIRS; i++) {
+		rtio_sqe_prep_read(acquire(), pair_rx[i], RTIO_PRIO_NORM, rx_buf[i],
+				   sizeof(rx_buf[i]), (void *)(uintptr_t)(OP_RECV + (i << 4)));
+		pending++;
+	}
+
+	submit();
+	assert_no_cqe();
+
+	/* Send in reverse order so completions don't follow submissions */
+	for (int i = NUM_PAIRS - 1; i >= 0; i--) {
+		rtio_sqe_prep_write(acquire(), pair_tx[i], RTIO_PRIO_NORM, (uint8_t *)TEST_STR,
+				    TEST_STR_LEN, (void *)(uintptr_t)(OP_SEND + (i << 4)));
+		pending++;
+	}
+
+	submit();
+
+	while (pending > 0) {
+		int i;
+
+		wait_cqe(&cqe);
+		i = cqe.userdata >> 4;
+
+		zassert_true(i < NUM_PAIRS, "unexpected completion");
+		zassert_equal(cqe.result, TEST_STR_LEN, "pair %d failed (%d)", i, cqe.result);
+
+		if ((cqe.userdata & 0xf) == OP_RECV) {
+			zassert_mem_equal(rx_buf[i], TEST_STR, TEST_STR_LEN, "wrong data");
+		}
+
+		pending--;
+	}
+
+	for (int i = 0; i < NUM_PAIRS; i++) {
+		zsock_rtio_iodev_detach(pair_tx[i]);
+		zsock_rtio_iodev_detach(pair_rx[i]);
+		zassert_ok(zsock_close(c_sock[i]), "close failed");
+		zassert_ok(zsock_close(s_sock[i]), "close failed");
+	}
+}
+
+ZTEST_SUITE(net_socket_rtio, NULL, NULL, NULL, NULL, NULL);
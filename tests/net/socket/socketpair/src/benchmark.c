@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "_main.h"
+
+#define PEER_STACK_SIZE 1024
+#define PING_PONG_ROUNDS 1000
+#define PING_PONG_MSG_LEN 16
+#define THROUGHPUT_BYTES (64 * 1024)
+
+#define SPAIR_IMPL (IS_ENABLED(CONFIG_NET_SOCKETPAIR_SPSC) ? "spsc" : "k_pipe")
+
+static K_THREAD_STACK_DEFINE(peer_stack, PEER_STACK_SIZE);
+static struct k_thread peer_thread;
+static uint8_t peer_buf[CONFIG_NET_SOCKETPAIR_BUFFER_SIZE];
+
+static ssize_t recv_all(int fd, uint8_t *buf, size_t len)
+{
+	size_t done = 0;
+	ssize_t res;
+
+	while (done < len) {
+		res = zsock_recv(fd, buf + done, len - done, 0);
+		if (res <= 0) {
+			return -1;
+		}
+		done += res;
+	}
+
+	return done;
+}
+
+static ssize_t send_all(int fd, const uint8_t *buf, size_t len)
+{
+	size_t done = 0;
+	ssize_t res;
+
+	while (done < len) {
+		res = zsock_send(fd, buf + done, len - done, 0);
+		if (res <= 0) {
+			return -1;
+		}
+		done += res;
+	}
+
+	return done;
+}
+
+static void echo_handler(void *p1, void *p2, void *p3)
+{
+	int fd = POINTER_TO_INT(p1);
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	for (int i = 0; i < PING_PONG_ROUNDS; i++) {
+		if (recv_all(fd, peer_buf, PING_PONG_MSG_LEN) < 0 ||
+		    send_all(fd, peer_buf, PING_PONG_MSG_LEN) < 0) {
+			LOG_ERR("echo failed: %d", errno);
+			return;
+		}
+	}
+}
+
+static void sink_handler(void *p1, void *p2, void *p3)
+{
+	int fd = POINTER_TO_INT(p1);
+	size_t total = 0;
+	ssize_t res;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (total < THROUGHPUT_BYTES) {
+		res = zsock_recv(fd, peer_buf, sizeof(peer_buf), 0);
+		if (res <= 0) {
+			LOG_ERR("recv failed: %d", errno);
+			return;
+		}
+		total += res;
+	}
+}
+
+static void start_peer(k_thread_entry_t entry, int fd)
+{
+	k_thread_create(&peer_thread, peer_stack,
+			K_THREAD_STACK_SIZEOF(peer_stack), entry,
+			INT_TO_POINTER(fd), NULL, NULL,
+			k_thread_priority_get(k_current_get()), 0, K_NO_WAIT);
+}
+
+ZTEST_F(net_socketpair, test_ping_pong_benchmark)
+{
+	uint8_t msg[PING_PONG_MSG_LEN];
+	uint8_t reply[PING_PONG_MSG_LEN];
+	uint32_t start;
+	uint64_t cycles;
+
+	start_peer(echo_handler, fixture->sv[1]);
+
+	start = k_cycle_get_32();
+
+	for (int i = 0; i < PING_PONG_ROUNDS; i++) {
+		memset(msg, i, sizeof(msg));
+
+		zassert_equal(send_all(fixture->sv[0], msg, sizeof(msg)),
+			      sizeof(msg), "send() failed: %d", errno);
+		zassert_equal(recv_all(fixture->sv[0], reply, sizeof(reply)),
+			      sizeof(reply), "recv() failed: %d", errno);
+		zassert_mem_equal(msg, reply, sizeof(msg), "bad echo in round %d", i);
+	}
+
+	cycles = k_cycle_get_32() - start;
+
+	zassert_ok(k_thread_join(&peer_thread, K_SECONDS(1)));
+
+	TC_PRINT("%s ping-pong: %u rounds of %u bytes, %u ns per round trip\n",
+		 SPAIR_IMPL, PING_PONG_ROUNDS, PING_PONG_MSG_LEN,
+		 (uint32_t)(k_cyc_to_ns_floor64(cycles) / PING_PONG_ROUNDS));
+}
+
+ZTEST_F(net_socketpair, test_throughput_benchmark)
+{
+	static uint8_t chunk[CONFIG_NET_SOCKETPAIR_BUFFER_SIZE];
+	size_t total = 0;
+	uint32_t start;
+	uint64_t ns;
+
+	start_peer(sink_handler, fixture->sv[1]);
+
+	start = k_cycle_get_32();
+
+	while (total < THROUGHPUT_BYTES) {
+		size_t len = MIN(sizeof(chunk), THROUGHPUT_BYTES - total);
+
+		zassert_equal(send_all(fixture->sv[0], chunk, len), len,
+			      "send() failed: %d", errno);
+		total += len;
+	}
+
+	zassert_ok(k_thread_join(&peer_thread, K_SECONDS(1)));
+
+	ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+
+	TC_PRINT("%s throughput: %u bytes in %u us, %u KiB/s\n",
+		 SPAIR_IMPL, THROUGHPUT_BYTES, (uint32_t)(ns / NSEC_PER_USEC),
+		 ns == 0 ? 0U :
+		 (uint32_t)((uint64_t)THROUGHPUT_BYTES * NSEC_PER_SEC / 1024U / ns));
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "_main.h"
+
+#define READER_STACK_SIZE 1024
+#define NUM_READERS 2
+#define NUM_BYTES 200
+#define POLL_ROUNDS 100
+#define JOIN_TIMEOUT K_SECONDS(2)
+
+static K_THREAD_STACK_ARRAY_DEFINE(reader_stacks, NUM_READERS, READER_STACK_SIZE);
+static struct k_thread reader_threads[NUM_READERS];
+
+struct reader_ctx {
+	int fd;
+	size_t count;
+	uint8_t data[NUM_BYTES];
+	bool failed;
+};
+
+static struct reader_ctx readers[NUM_READERS];
+static atomic_t poll_stop;
+
+/* Reads until the remote end is closed, each recv() with a small buffer */
+static void reader_handler(void *p1, void *p2, void *p3)
+{
+	struct reader_ctx *reader = p1;
+	uint8_t buf[4];
+	ssize_t res;
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (true) {
+		res = zsock_recv(reader->fd, buf, sizeof(buf), 0);
+		if (res == 0 || (res < 0 && errno == EPIPE)) {
+			return;
+		}
+
+		if (res < 0 || reader->count + res > sizeof(reader->data)) {
+			reader->failed = true;
+			return;
+		}
+
+		memcpy(&reader->data[reader->count], buf, res);
+		reader->count += res;
+	}
+}
+
+static void poll_handler(void *p1, void *p2, void *p3)
+{
+	struct zsock_pollfd pfd = {
+		.fd = POINTER_TO_INT(p1),
+		.events = ZSOCK_POLLIN,
+	};
+
+	ARG_UNUSED(p2);
+	ARG_UNUSED(p3);
+
+	while (!atomic_get(&poll_stop)) {
+		(void)zsock_poll(&pfd, 1, 1);
+	}
+}
+
+static size_t read_count(void)
+{
+	size_t total = 0;
+
+	for (int i = 0; i < NUM_READERS; i++) {
+		total += readers[i].count;
+	}
+
+	return total;
+}
+
+/* Wait for the readers to get @p count bytes before closing the remote end */
+static void wait_read(size_t count)
+{
+	for (int i = 0; i < 200 && read_count() < count; i++) {
+		k_sleep(K_MSEC(10));
+	}
+
+	zassert_equal(read_count(), count, "read %zu bytes", read_count());
+}
+
+static void start_thread(int i, k_thread_entry_t entry, void *arg)
+{
+	k_thread_create(&reader_threads[i], reader_stacks[i],
+			K_THREAD_STACK_SIZEOF(reader_stacks[i]), entry, arg, NULL,
+			NULL, k_thread_priority_get(k_current_get()), 0, K_NO_WAIT);
+}
+
+ZTEST_F(net_socketpair, test_concurrent_readers)
+{
+	bool seen[NUM_BYTES] = { false };
+	size_t total = 0;
+	uint8_t c;
+	int res;
+
+	memset(readers, 0, sizeof(readers));
+
+	for (int i = 0; i < NUM_READERS; i++) {
+		readers[i].fd = fixture->sv[1];
+		start_thread(i, reader_handler, &readers[i]);
+	}
+
+	/* let both readers block on the empty endpoint */
+	k_sleep(K_MSEC(10));
+
+	for (int i = 0; i < NUM_BYTES; i++) {
+		c = i;
+		res = zsock_send(fixture->sv[0], &c, 1, 0);
+		zassert_equal(res, 1, "send() failed: %d", errno);
+
+		if ((i % 8) == 0) {
+			k_yield();
+		}
+	}
+
+	wait_read(NUM_BYTES);
+
+	/* wake the readers */
+	zassert_ok(zsock_close(fixture->sv[0]));
+	fixture->sv[0] = -1;
+
+	for (int i = 0; i < NUM_READERS; i++) {
+		zassert_ok(k_thread_join(&reader_threads[i], JOIN_TIMEOUT),
+			   "reader %d hangs", i);
+		zassert_false(readers[i].failed, "reader %d failed", i);
+
+		for (size_t j = 0; j < readers[i].count; j++) {
+			c = readers[i].data[j];
+
+			zassert_false(seen[c], "byte %u read twice", c);
+			seen[c] = true;
+
+			/* every reader sees the stream in order */
+			zassert_true(j == 0 || c > readers[i].data[j - 1],
+				     "reader %d out of order at %u", i, c);
+		}
+
+		total += readers[i].count;
+	}
+
+	zassert_equal(total, NUM_BYTES, "read %zu bytes", total);
+}
+
+ZTEST_F(net_socketpair, test_short_read_while_blocked)
+{
+	static const uint8_t msg[] = "0123456789";
+	uint8_t buf[sizeof(msg)];
+	size_t done = 0;
+	ssize_t res;
+
+	memset(readers, 0, sizeof(readers));
+	readers[0].fd = fixture->sv[1];
+	start_thread(0, reader_handler, &readers[0]);
+
+	k_sleep(K_MSEC(10));
+
+	/* the blocked reader only takes 4 bytes at a time */
+	while (done < sizeof(msg)) {
+		res = zsock_send(fixture->sv[0], &msg[done], sizeof(msg) - done, 0);
+		zassert_true(res > 0, "send() failed: %d", errno);
+		done += res;
+	}
+
+	wait_read(sizeof(msg));
+
+	zassert_ok(zsock_close(fixture->sv[0]));
+	fixture->sv[0] = -1;
+
+	zassert_ok(k_thread_join(&reader_threads[0], JOIN_TIMEOUT), "reader hangs");
+	zassert_false(readers[0].failed, "reader failed");
+	memcpy(buf, readers[0].data, sizeof(buf));
+	zassert_mem_equal(buf, msg, sizeof(msg), "wrong data read");
+}
+
+ZTEST_F(net_socketpair, test_read_while_polled)
+{
+	uint8_t c;
+	int res;
+
+	memset(readers, 0, sizeof(readers));
+	atomic_set(&poll_stop, false);
+
+	/* poll() on the same endpoint must not swallow the reader's wakeup */
+	readers[0].fd = fixture->sv[1];
+	start_thread(0, reader_handler, &readers[0]);
+	start_thread(1, poll_handler, INT_TO_POINTER(fixture->sv[1]));
+
+	for (int i = 0; i < POLL_ROUNDS; i++) {
+		k_sleep(K_MSEC(1));
+
+		c = i;
+		res = zsock_send(fixture->sv[0], &c, 1, 0);
+		zassert_equal(res, 1, "send() failed: %d", errno);
+	}
+
+	/* every byte must reach the reader while the endpoint is still open */
+	wait_read(POLL_ROUNDS);
+
+	atomic_set(&poll_stop, true);
+	zassert_ok(k_thread_join(&reader_threads[1], JOIN_TIMEOUT), "poll hangs");
+
+	zassert_ok(zsock_close(fixture->sv[0]));
+	fixture->sv[0] = -1;
+
+	zassert_ok(k_thread_join(&reader_threads[0], JOIN_TIMEOUT), "reader hangs");
+	zassert_false(readers[0].failed, "reader failed");
+
+	for (int i = 0; i < POLL_ROUNDS; i++) {
+		zassert_equal(readers[0].data[i], i, "wrong byte %d", i);
+	}
+}
@@ -1811,6 +1811,157 @@ ZTEST(net_socket_tls, test_poll_dtls_pollerr)
 	k_msleep(10);
 }
 
+#define WRITE_BUFFER_MSG_COUNT 16
+
+/* Every recv() call on a TLS socket returns data from one record at most. */
+static int recv_count_records(int sock, size_t len)
+{
+	static uint8_t rx_buf[WRITE_BUFFER_MSG_COUNT * sizeof(TEST_STR_SMALL)];
+	size_t received = 0;
+	int records = 0;
+	int ret;
+
+	while (received < len) {
+		ret = zsock_recv(sock, rx_buf, len - received, 0);
+		zassert_true(ret > 0, "recv() failed (%d)", errno);
+		received += ret;
+		records++;
+	}
+
+	return records;
+}
+
+ZTEST(net_socket_tls, test_write_buffer_msg_more)
+{
+	const size_t msg_len = strlen(TEST_STR_SMALL);
+
+	if (CONFIG_NET_SOCKETS_TLS_WRITE_BUFFER_SIZE == 0) {
+		ztest_test_skip();
+	}
+
+	test_prepare_tls_connection(AF_INET);
+
+	for (int i = 0; i < 3; i++) {
+		test_send(c_sock, TEST_STR_SMALL, msg_len, ZSOCK_MSG_MORE);
+	}
+	test_send(c_sock, TEST_STR_SMALL, msg_len, 0);
+
+	zassert_equal(recv_count_records(new_sock, 4 * msg_len), 1,
+		      "Writes should be combined into a single record");
+
+	test_sockets_close();
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+ZTEST(net_socket_tls, test_write_buffer_option)
+{
+	const size_t msg_len = strlen(TEST_STR_SMALL);
+	int optval = 1;
+	socklen_t optlen = sizeof(optval);
+	int ret;
+
+	if (CONFIG_NET_SOCKETS_TLS_WRITE_BUFFER_SIZE == 0) {
+		ztest_test_skip();
+	}
+
+	test_prepare_tls_connection(AF_INET6);
+
+	ret = zsock_setsockopt(c_sock, SOL_TLS, TLS_WRITE_BUFFER, &optval,
+			       sizeof(optval));
+	zassert_equal(ret, 0, "setsockopt failed (%d)", errno);
+
+	optval = 0;
+	ret = zsock_getsockopt(c_sock, SOL_TLS, TLS_WRITE_BUFFER, &optval,
+			       &optlen);
+	zassert_equal(ret, 0, "getsockopt failed (%d)", errno);
+	zassert_equal(optval, 1, "Write buffer should be enabled");
+
+	/* Held data goes out once the delay expires. */
+	for (int i = 0; i < 4; i++) {
+		test_send(c_sock, TEST_STR_SMALL, msg_len, 0);
+	}
+
+	zassert_equal(recv_count_records(new_sock, 4 * msg_len), 1,
+		      "Writes should be combined into a single record");
+
+	test_sockets_close();
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+ZTEST(net_socket_tls, test_write_buffer_sendmsg)
+{
+	struct iovec iov[3] = {
+		{ .iov_base = TEST_STR_SMALL, .iov_len = strlen(TEST_STR_SMALL) },
+		{ .iov_base = TEST_STR_SMALL, .iov_len = strlen(TEST_STR_SMALL) },
+		{ .iov_base = TEST_STR_SMALL, .iov_len = strlen(TEST_STR_SMALL) },
+	};
+	struct msghdr msg = {
+		.msg_iov = iov,
+		.msg_iovlen = ARRAY_SIZE(iov),
+	};
+
+	if (CONFIG_NET_SOCKETS_TLS_WRITE_BUFFER_SIZE == 0) {
+		ztest_test_skip();
+	}
+
+	test_prepare_tls_connection(AF_INET);
+
+	test_sendmsg(c_sock, &msg, 0);
+
+	zassert_equal(recv_count_records(new_sock, 3 * strlen(TEST_STR_SMALL)), 1,
+		      "sendmsg() should produce a single record");
+
+	test_sockets_close();
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+static void write_buffer_measure(const char *name, int flags)
+{
+	const size_t msg_len = strlen(TEST_STR_SMALL);
+	const size_t total = WRITE_BUFFER_MSG_COUNT * msg_len;
+	mbedtls_ssl_context *ssl_ctx;
+	uint32_t start, cycles;
+	int records;
+
+	test_prepare_tls_connection(AF_INET);
+
+	ssl_ctx = ztls_get_mbedtls_ssl_context(c_sock);
+	zassert_not_null(ssl_ctx, "No mbedTLS context");
+
+	start = k_cycle_get_32();
+
+	for (int i = 0; i < WRITE_BUFFER_MSG_COUNT - 1; i++) {
+		test_send(c_sock, TEST_STR_SMALL, msg_len, flags);
+	}
+	test_send(c_sock, TEST_STR_SMALL, msg_len, 0);
+
+	cycles = k_cycle_get_32() - start;
+
+	records = recv_count_records(new_sock, total);
+
+	TC_PRINT("%s: %d messages, %d records, %u bytes on wire, %u ns per message\n",
+		 name, WRITE_BUFFER_MSG_COUNT, records,
+		 (uint32_t)(total + records * mbedtls_ssl_get_record_expansion(ssl_ctx)),
+		 (uint32_t)(k_cyc_to_ns_floor64(cycles) / WRITE_BUFFER_MSG_COUNT));
+
+	test_sockets_close();
+
+	k_sleep(TCP_TEARDOWN_TIMEOUT);
+}
+
+ZTEST(net_socket_tls, test_write_buffer_benchmark)
+{
+	if (CONFIG_NET_SOCKETS_TLS_WRITE_BUFFER_SIZE == 0) {
+		ztest_test_skip();
+	}
+
+	write_buffer_measure("direct", 0);
+	write_buffer_measure("MSG_MORE", ZSOCK_MSG_MORE);
+}
+
 static void *tls_tests_setup(void)
 {
 	k_work_queue_init(&tls_test_work_queue);
@@ -12,6 +12,7 @@ LOG_MODULE_REGISTER(net_test, CONFIG_NET_WEBSOCKET_LOG_LEVEL);
 #include <zephyr/net/net_ip.h>
 #include <zephyr/net/socket.h>
 #include <zephyr/net/websocket.h>
+#include <zephyr/sys/byteorder.h>
 #include <zephyr/sys/fdtable.h>
 
 #include "websocket_internal.h"
@@ -121,7 +122,7 @@ static const unsigned char ping[] = {0x89, 0x00};
 
 static void test_recv(int count)
 {
-	struct websocket_context ctx;
+	static struct websocket_context ctx;
 	uint32_t msg_type = -1;
 	uint64_t remaining = -1;
 	int total_read = 0;
@@ -242,7 +243,7 @@ ZTEST(net_websocket, test_recv_whole_msg)
 
 ZTEST(net_websocket, test_recv_empty_ping)
 {
-	struct websocket_context ctx;
+	static struct websocket_context ctx;
 	int total_read = 0;
 	uint32_t msg_type = -1;
 	uint64_t remaining = -1;
@@ -264,7 +265,7 @@ ZTEST(net_websocket, test_recv_empty_ping)
 
 static void test_recv_2(int count)
 {
-	struct websocket_context ctx;
+	static struct websocket_context ctx;
 	uint32_t msg_type = -1;
 	uint64_t remaining = -1;
 	int total_read = 0;
@@ -308,7 +309,7 @@ ZTEST(net_websocket, test_recv_two_msg)
 	test_recv_2(sizeof(frame1) + FRAME1_HDR_SIZE / 2);
 }
 
-int verify_sent_and_received_msg(struct msghdr *msg, bool split_msg)
+static int verify_frame(struct msghdr *msg, bool split_msg)
 {
 	static struct websocket_context ctx;
 	uint32_t msg_type = -1;
@@ -375,6 +376,66 @@ int verify_sent_and_received_msg(struct msghdr *msg, bool split_msg)
 	return msg->msg_iov[0].iov_len + total_read;
 }
 
+/* The masked payload is sent in chunks of CONFIG_WEBSOCKET_TX_CHUNK_SIZE
+ * bytes, the header going out with the first one. Collect the chunks and
+ * check the frame when it is complete.
+ */
+static uint8_t sent_hdr[MAX_HEADER_LEN];
+static size_t sent_hdr_len;
+static uint8_t sent_payload[sizeof(lorem_ipsum)];
+static size_t sent_len;
+static int sent_chunks;
+
+static size_t frame_payload_len(const uint8_t *hdr)
+{
+	size_t len = hdr[1] & 0x7f;
+
+	/* The test frames are shorter than 64 KiB */
+	if (len == 126) {
+		len = sys_get_be16(&hdr[2]);
+	}
+
+	return len;
+}
+
+int verify_sent_and_received_msg(struct msghdr *msg, bool split_msg)
+{
+	struct iovec io_vector[2];
+	struct msghdr frame = {
+		.msg_iov = io_vector,
+		.msg_iovlen = ARRAY_SIZE(io_vector),
+	};
+	size_t hdr_len = msg->msg_iov[0].iov_len;
+	size_t chunk_len = msg->msg_iov[1].iov_len;
+
+	if (hdr_len > 0) {
+		zassert_true(hdr_len <= sizeof(sent_hdr), "Header too long");
+		memcpy(sent_hdr, msg->msg_iov[0].iov_base, hdr_len);
+		sent_hdr_len = hdr_len;
+		sent_len = 0;
+		sent_chunks = 0;
+	}
+
+	zassert_true(sent_len + chunk_len <= sizeof(sent_payload), "Frame too long");
+	if (chunk_len > 0) {
+		memcpy(&sent_payload[sent_len], msg->msg_iov[1].iov_base, chunk_len);
+	}
+
+	sent_len += chunk_len;
+	sent_chunks++;
+
+	if (sent_len == frame_payload_len(sent_hdr)) {
+		io_vector[0].iov_base = sent_hdr;
+		io_vector[0].iov_len = sent_hdr_len;
+		io_vector[1].iov_base = sent_payload;
+		io_vector[1].iov_len = sent_len;
+
+		(void)verify_frame(&frame, split_msg);
+	}
+
+	return hdr_len + chunk_len;
+}
+
 ZTEST(net_websocket, test_send_and_recv_lorem_ipsum)
 {
 	static struct websocket_context ctx;
@@ -395,6 +456,13 @@ ZTEST(net_websocket, test_send_and_recv_lorem_ipsum)
 		      "Should have sent %zd bytes but sent %d instead",
 		      test_msg_len, ret);
 
+	/* The masking key position carries over from chunk to chunk, else
+	 * the frame would not have unmasked to the original text.
+	 */
+	zassert_equal(sent_chunks, DIV_ROUND_UP(test_msg_len, CONFIG_WEBSOCKET_TX_CHUNK_SIZE),
+		      "Frame sent in %d chunks", sent_chunks);
+	zassert_true(sent_chunks > 1, "Frame not sent in chunks");
+
 	z_free_fd(fd);
 }
 
@@ -444,7 +512,7 @@ ZTEST(net_websocket, test_send_and_recv_empty_pong)
 
 ZTEST(net_websocket, test_recv_in_small_buffer)
 {
-	struct websocket_context ctx;
+	static struct websocket_context ctx;
 	uint32_t msg_type = -1;
 	uint64_t remaining = -1;
 	int total_read = 0;
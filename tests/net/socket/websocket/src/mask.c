@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/net/socket.h>
+
+#include "websocket_internal.h"
+
+#define MASKING_VALUE 0xe17e8eb9
+#define BUF_LEN	      2048
+
+#define BENCH_MIN_FRAME 64
+#define BENCH_MAX_FRAME (64 * 1024)
+#define BENCH_BYTES     (256 * 1024)
+
+static uint8_t src_buf[BUF_LEN + sizeof(unsigned long)];
+static uint8_t dst_buf[BUF_LEN + sizeof(unsigned long)];
+static uint8_t ref_buf[BUF_LEN + sizeof(unsigned long)];
+
+/* The byte at a time masking done before the word kernel */
+static void mask_bytes(uint8_t *dst, const uint8_t *src, size_t len, uint32_t masking_value,
+		       size_t offset)
+{
+	for (size_t i = 0; i < len; i++) {
+		dst[i] = src[i] ^ (uint8_t)(masking_value >> (8 * (3 - (offset + i) % 4)));
+	}
+}
+
+static void *mask_setup(void)
+{
+	for (size_t i = 0; i < sizeof(src_buf); i++) {
+		src_buf[i] = i * 7 + 3;
+	}
+
+	return NULL;
+}
+
+ZTEST(net_websocket_mask, test_mask_matches_bytewise)
+{
+	static const size_t lens[] = {0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 64, 100, 1021};
+
+	/* Every combination of source and destination alignment, frame
+	 * position and length, covering the unaligned heads and tails.
+	 */
+	for (size_t src_off = 0; src_off < sizeof(unsigned long); src_off++) {
+		for (size_t dst_off = 0; dst_off < sizeof(unsigned long); dst_off++) {
+			for (size_t pos = 0; pos < 4; pos++) {
+				ARRAY_FOR_EACH(lens, i) {
+					memset(dst_buf, 0x5a, sizeof(dst_buf));
+					memset(ref_buf, 0x5a, sizeof(ref_buf));
+
+					websocket_mask_payload(&dst_buf[dst_off], &src_buf[src_off],
+							       lens[i], MASKING_VALUE, pos);
+					mask_bytes(&ref_buf[dst_off], &src_buf[src_off], lens[i],
+						   MASKING_VALUE, pos);
+
+					zassert_mem_equal(dst_buf, ref_buf, sizeof(dst_buf),
+							  "src %zu dst %zu pos %zu len %zu",
+							  src_off, dst_off, pos, lens[i]);
+				}
+			}
+		}
+	}
+}
+
+ZTEST(net_websocket_mask, test_mask_in_place_roundtrip)
+{
+	memcpy(dst_buf, src_buf, BUF_LEN);
+
+	/* Unmasking in pieces, as the receive path does, restores the data */
+	websocket_mask_payload(&dst_buf[1], &dst_buf[1], BUF_LEN - 1, MASKING_VALUE, 0);
+	websocket_mask_payload(&dst_buf[1], &dst_buf[1], 5, MASKING_VALUE, 0);
+	websocket_mask_payload(&dst_buf[6], &dst_buf[6], BUF_LEN - 6, MASKING_VALUE, 5);
+
+	zassert_mem_equal(dst_buf, src_buf, BUF_LEN);
+}
+
+static uint32_t bench_mbps(size_t frame_len, bool bytewise)
+{
+	size_t frames = MAX(BENCH_BYTES / frame_len, 1);
+	uint32_t start;
+	uint64_t ns;
+
+	start = k_cycle_get_32();
+
+	for (size_t n = 0; n < frames; n++) {
+		/* Frames longer than the buffer are masked in chunks, as when sending */
+		for (size_t off = 0; off < frame_len; off += BUF_LEN) {
+			size_t len = MIN(frame_len - off, BUF_LEN);
+
+			if (bytewise) {
+				mask_bytes(dst_buf, src_buf, len, MASKING_VALUE, off);
+			} else {
+				websocket_mask_payload(dst_buf, src_buf, len, MASKING_VALUE, off);
+			}
+		}
+	}
+
+	ns = k_cyc_to_ns_floor64(k_cycle_get_32() - start);
+	if (ns == 0) {
+		return 0;
+	}
+
+	/* Bytes per microsecond is MB/s */
+	return (uint32_t)((uint64_t)frames * frame_len * NSEC_PER_USEC / ns);
+}
+
+ZTEST(net_websocket_mask, test_mask_benchmark)
+{
+	for (size_t len = BENCH_MIN_FRAME; len <= BENCH_MAX_FRAME; len *= 4) {
+		TC_PRINT("%6zu byte frames: %u MB/s byte at a time, %u MB/s word at a time\n",
+			 len, bench_mbps(len, true), bench_mbps(len, false));
+	}
+}
+
+ZTEST_SUITE(net_websocket_mask, NULL, mask_setup, NULL, NULL, NULL);
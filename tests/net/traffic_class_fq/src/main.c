@@ -0,0 +1,348 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/logging/log.h>
+LOG_MODULE_REGISTER(net_test, CONFIG_NET_TC_LOG_LEVEL);
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/net/dummy.h>
+#include <zephyr/net/net_if.h>
+#include <zephyr/net/net_ip.h>
+#include <zephyr/net/net_pkt.h>
+
+#include "ipv6.h"
+#include "udp_internal.h"
+#include "net_private.h"
+#include "net_stats.h"
+
+/* One packet is worth exactly one DRR quantum */
+#define PKT_LEN CONFIG_NET_TC_TX_FQ_QUANTUM
+#define PKTS_PER_FLOW 4
+#define FLOW_LIMIT_PKTS (CONFIG_NET_TC_TX_FQ_FLOW_LIMIT / PKT_LEN)
+
+/* The source ports hash to different flows, see tc_fq_flow_index() */
+#define PLUG_PORT 4000
+#define FLOW_A_PORT 4001
+#define FLOW_B_PORT 4002
+#define FLOW_C_PORT 4003
+#define DST_PORT 9999
+
+#define MAX_SENT 16
+#define WAIT_TIME K_SECONDS(1)
+
+BUILD_ASSERT(CONFIG_NET_TC_TX_FQ_FLOWS == 16, "flow ports chosen for 16 flows");
+BUILD_ASSERT(CONFIG_NET_TC_TX_FQ_FLOW_LIMIT % PKT_LEN == 0,
+	     "flow limit must be a multiple of the packet length");
+
+static struct in6_addr my_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 1, 0, 0, 0,
+				       0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+static struct in6_addr dst_addr = { { { 0x20, 0x01, 0x0d, 0xb8, 9, 0, 0, 0,
+					0, 0, 0, 0, 0, 0, 0, 0x1 } } };
+
+static struct net_if *test_iface;
+
+/* The driver blocks the TX thread in every send until the test opens the
+ * gate, so that the test decides when the flow queues are served.
+ */
+static K_SEM_DEFINE(tx_entered, 0, MAX_SENT);
+static K_SEM_DEFINE(tx_gate, 0, MAX_SENT);
+
+static uint16_t sent_ports[MAX_SENT];
+static int sent_count;
+
+static int fq_tx(const struct device *dev, struct net_pkt *pkt)
+{
+	uint16_t port = 0;
+
+	ARG_UNUSED(dev);
+
+	net_pkt_cursor_init(pkt);
+	if (net_pkt_skip(pkt, NET_IPV6H_LEN) == 0) {
+		(void)net_pkt_read_be16(pkt, &port);
+	}
+
+	if (sent_count < MAX_SENT) {
+		sent_ports[sent_count] = port;
+	}
+
+	sent_count++;
+
+	k_sem_give(&tx_entered);
+	k_sem_take(&tx_gate, K_FOREVER);
+
+	return 0;
+}
+
+static void fq_iface_init(struct net_if *iface)
+{
+	static uint8_t mac[] = { 0x00, 0x00, 0x5E, 0x00, 0x53, 0x01 };
+
+	net_if_set_link_addr(iface, mac, sizeof(mac), NET_LINK_DUMMY);
+}
+
+static struct dummy_api fq_api = {
+	.iface_api.init = fq_iface_init,
+	.send = fq_tx,
+};
+
+NET_DEVICE_INIT(fq_test, "fq_test", NULL, NULL, NULL, NULL,
+		CONFIG_KERNEL_INIT_PRIORITY_DEFAULT, &fq_api, DUMMY_L2,
+		NET_L2_GET_CTX_TYPE(DUMMY_L2), NET_IPV6_MTU);
+
+static struct net_pkt *fq_pkt(uint16_t src_port)
+{
+	static const uint8_t payload[PKT_LEN - NET_IPV6UDPH_LEN];
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(test_iface, sizeof(payload), AF_INET6,
+					IPPROTO_UDP, K_NO_WAIT);
+	zassert_not_null(pkt, "Cannot allocate pkt");
+
+	zassert_ok(net_ipv6_create(pkt, &my_addr, &dst_addr));
+	zassert_ok(net_udp_create(pkt, htons(src_port), htons(DST_PORT)));
+	zassert_ok(net_pkt_write(pkt, payload, sizeof(payload)));
+
+	net_pkt_cursor_init(pkt);
+	zassert_ok(net_ipv6_finalize(pkt, IPPROTO_UDP));
+	zassert_equal(net_pkt_get_len(pkt), PKT_LEN, "Wrong pkt length");
+
+	return pkt;
+}
+
+/* Same length as fq_pkt(), with a hop-by-hop options header before UDP */
+static struct net_pkt *fq_pkt_hbho(uint16_t src_port)
+{
+	static const uint8_t payload[PKT_LEN - NET_IPV6UDPH_LEN - 8];
+	struct net_pkt *pkt;
+
+	pkt = net_pkt_alloc_with_buffer(test_iface, 8 + sizeof(payload),
+					AF_INET6, IPPROTO_UDP, K_NO_WAIT);
+	zassert_not_null(pkt, "Cannot allocate pkt");
+
+	zassert_ok(net_ipv6_create(pkt, &my_addr, &dst_addr));
+
+	/* Next header, length, PadN option of 4 bytes */
+	zassert_ok(net_pkt_write_u8(pkt, IPPROTO_UDP));
+	zassert_ok(net_pkt_write_u8(pkt, 0));
+	zassert_ok(net_pkt_write_be16(pkt, 0x0104));
+	zassert_ok(net_pkt_memset(pkt, 0, 4));
+	net_pkt_set_ipv6_ext_len(pkt, 8);
+	net_pkt_set_ipv6_next_hdr(pkt, NET_IPV6_NEXTHDR_HBHO);
+
+	zassert_ok(net_udp_create(pkt, htons(src_port), htons(DST_PORT)));
+	zassert_ok(net_pkt_write(pkt, payload, sizeof(payload)));
+
+	net_pkt_cursor_init(pkt);
+	zassert_ok(net_ipv6_finalize(pkt, IPPROTO_UDP));
+	zassert_equal(net_pkt_get_len(pkt), PKT_LEN, "Wrong pkt length");
+
+	return pkt;
+}
+
+static bool fq_submit(uint16_t src_port)
+{
+	return net_tc_submit_to_tx_queue(0, fq_pkt(src_port));
+}
+
+/* Occupy the TX thread in the driver, so that the packets queued after
+ * this stay in the flow queues.
+ */
+static void fq_plug(void)
+{
+	zassert_true(fq_submit(PLUG_PORT), "Plug pkt dropped");
+	zassert_ok(k_sem_take(&tx_entered, WAIT_TIME), "Plug pkt not sent");
+}
+
+/* Let the plug and the given number of queued packets through the driver */
+static void fq_release(int count)
+{
+	for (int i = 0; i < count; i++) {
+		k_sem_give(&tx_gate);
+		zassert_ok(k_sem_take(&tx_entered, WAIT_TIME),
+			   "Pkt %d not sent", i);
+	}
+
+	k_sem_give(&tx_gate);
+}
+
+static void *fq_setup(void)
+{
+	struct net_if_addr *ifaddr;
+
+	test_iface = net_if_get_first_by_type(&NET_L2_GET_NAME(DUMMY));
+	zassert_not_null(test_iface, "No test interface");
+
+	ifaddr = net_if_ipv6_addr_add(test_iface, &my_addr, NET_ADDR_MANUAL, 0);
+	zassert_not_null(ifaddr, "Cannot add IPv6 address");
+
+	return NULL;
+}
+
+static void fq_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	sent_count = 0;
+	memset(sent_ports, 0, sizeof(sent_ports));
+}
+
+ZTEST(traffic_class_fq, test_drr_fairness)
+{
+	fq_plug();
+
+	/* A bulk flow queued completely before the second one */
+	for (int i = 0; i < PKTS_PER_FLOW; i++) {
+		zassert_true(fq_submit(FLOW_A_PORT), "Flow A pkt %d dropped", i);
+	}
+
+	for (int i = 0; i < PKTS_PER_FLOW; i++) {
+		zassert_true(fq_submit(FLOW_B_PORT), "Flow B pkt %d dropped", i);
+	}
+
+	fq_release(2 * PKTS_PER_FLOW);
+
+	zassert_equal(sent_count, 1 + 2 * PKTS_PER_FLOW, "%d pkts sent", sent_count);
+	zassert_equal(sent_ports[0], PLUG_PORT, "Plug pkt not sent first");
+
+	/* One quantum per flow and round */
+	for (int i = 0; i < 2 * PKTS_PER_FLOW; i++) {
+		zassert_equal(sent_ports[1 + i], (i % 2) ? FLOW_B_PORT : FLOW_A_PORT,
+			      "Pkt %d sent from port %u", i, sent_ports[1 + i]);
+	}
+}
+
+ZTEST(traffic_class_fq, test_new_flow_first)
+{
+	fq_plug();
+
+	for (int i = 0; i < PKTS_PER_FLOW; i++) {
+		zassert_true(fq_submit(FLOW_A_PORT), "Flow A pkt %d dropped", i);
+	}
+
+	/* Flow A moves to the old flows after its first packet */
+	k_sem_give(&tx_gate);
+	zassert_ok(k_sem_take(&tx_entered, WAIT_TIME), "Flow A pkt not sent");
+	k_sem_give(&tx_gate);
+	zassert_ok(k_sem_take(&tx_entered, WAIT_TIME), "Flow A pkt not sent");
+
+	/* A sparse flow becoming active is served before the bulk flow */
+	zassert_true(fq_submit(FLOW_B_PORT), "Flow B pkt dropped");
+
+	fq_release(PKTS_PER_FLOW - 1);
+
+	zassert_equal(sent_count, 2 + PKTS_PER_FLOW, "%d pkts sent", sent_count);
+	zassert_equal(sent_ports[1], FLOW_A_PORT, "Flow A not sent first");
+	zassert_equal(sent_ports[2], FLOW_A_PORT, "Flow A not sent second");
+	zassert_equal(sent_ports[3], FLOW_B_PORT, "New flow B not served first");
+}
+
+ZTEST(traffic_class_fq, test_flow_limit)
+{
+	struct sockaddr_in6 local = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(FLOW_C_PORT),
+		.sin6_addr = my_addr,
+	};
+	struct sockaddr_in6 dst = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(DST_PORT),
+		.sin6_addr = dst_addr,
+	};
+	static const uint8_t data[8];
+	struct net_context *ctx;
+	uint32_t drop_before;
+	int ret;
+
+	ret = net_context_get(AF_INET6, SOCK_DGRAM, IPPROTO_UDP, &ctx);
+	zassert_ok(ret, "Cannot get context (%d)", ret);
+	ret = net_context_bind(ctx, (struct sockaddr *)&local, sizeof(local));
+	zassert_ok(ret, "Cannot bind context (%d)", ret);
+
+	drop_before = GET_STAT(test_iface, tx_fq.drop);
+
+	fq_plug();
+
+	/* A flow takes packets up to its byte limit */
+	for (int i = 0; i < FLOW_LIMIT_PKTS; i++) {
+		zassert_true(fq_submit(FLOW_C_PORT), "Flow C pkt %d dropped", i);
+	}
+
+	zassert_equal(GET_STAT(test_iface, tx_fq.queued), FLOW_LIMIT_PKTS,
+		      "Wrong number of queued pkts");
+	zassert_true(net_tc_tx_flow_is_full(ctx, (struct sockaddr *)&dst),
+		     "Flow C not full");
+
+	/* The socket layer waits when sending would overfill the flow */
+	ret = net_context_sendto(ctx, data, sizeof(data), (struct sockaddr *)&dst,
+				 sizeof(dst), NULL, K_NO_WAIT, NULL);
+	zassert_equal(ret, -ENOBUFS, "Send to a full flow returned %d", ret);
+
+	/* Over the limit packets are dropped and counted */
+	zassert_false(fq_submit(FLOW_C_PORT), "Pkt over the flow limit queued");
+	zassert_equal(GET_STAT(test_iface, tx_fq.drop), drop_before + 1,
+		      "Drop not counted");
+
+	/* Other flows are not affected */
+	zassert_true(fq_submit(FLOW_A_PORT), "Flow A pkt dropped");
+	zassert_false(net_tc_tx_flow_is_full(ctx, (struct sockaddr *)&local),
+		      "Flow of another destination reported full");
+
+	fq_release(FLOW_LIMIT_PKTS + 1);
+
+	zassert_equal(sent_count, FLOW_LIMIT_PKTS + 2, "%d pkts sent", sent_count);
+	zassert_equal(GET_STAT(test_iface, tx_fq.queued), 0,
+		      "Pkts left in the flow queues");
+	zassert_false(net_tc_tx_flow_is_full(ctx, (struct sockaddr *)&dst),
+		      "Flow C still full");
+
+	net_context_put(ctx);
+}
+
+ZTEST(traffic_class_fq, test_flow_limit_ext_hdr)
+{
+	struct sockaddr_in6 local = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(FLOW_C_PORT),
+		.sin6_addr = my_addr,
+	};
+	struct sockaddr_in6 dst = {
+		.sin6_family = AF_INET6,
+		.sin6_port = htons(DST_PORT),
+		.sin6_addr = dst_addr,
+	};
+	struct net_context *ctx;
+	int ret;
+
+	ret = net_context_get(AF_INET6, SOCK_DGRAM, IPPROTO_UDP, &ctx);
+	zassert_ok(ret, "Cannot get context (%d)", ret);
+	ret = net_context_bind(ctx, (struct sockaddr *)&local, sizeof(local));
+	zassert_ok(ret, "Cannot bind context (%d)", ret);
+
+	fq_plug();
+
+	/* The ports after the extension header pick the flow of the socket */
+	for (int i = 0; i < FLOW_LIMIT_PKTS; i++) {
+		zassert_true(net_tc_submit_to_tx_queue(0, fq_pkt_hbho(FLOW_C_PORT)),
+			     "Flow C pkt %d dropped", i);
+	}
+
+	zassert_true(net_tc_tx_flow_is_full(ctx, (struct sockaddr *)&dst),
+		     "Flow C not full");
+	zassert_false(net_tc_submit_to_tx_queue(0, fq_pkt(FLOW_C_PORT)),
+		      "Pkt over the flow limit queued");
+
+	fq_release(FLOW_LIMIT_PKTS);
+
+	zassert_equal(sent_count, FLOW_LIMIT_PKTS + 1, "%d pkts sent", sent_count);
+	zassert_false(net_tc_tx_flow_is_full(ctx, (struct sockaddr *)&dst),
+		      "Flow C still full");
+
+	net_context_put(ctx);
+}
+
+ZTEST_SUITE(traffic_class_fq, NULL, fq_setup, fq_before, NULL, NULL);
@@ -923,4 +923,95 @@ ZTEST(test_utils_fn, test_ip_checksum)
 	}
 }
 
+uint8_t testdst[CHECKSUM_TEST_LENGTH + sizeof(uint64_t)];
+
+ZTEST(test_utils_fn, test_ip_checksum_copy)
+{
+	uint16_t sum_got;
+	uint16_t sum_exp;
+
+	for (int i = 0; i < CHECKSUM_TEST_LENGTH; i++) {
+		testdata[i] = (uint8_t)(i + 7) * 31;
+	}
+
+	/* All source and destination alignments, lengths crossing the
+	 * unrolled word loops.
+	 */
+	for (int src_off = 0; src_off < 8; src_off++) {
+		for (int dst_off = 0; dst_off < 8; dst_off++) {
+			for (int length = 1; length < 80; length++) {
+				memset(testdst, 0, sizeof(testdst));
+
+				sum_got = calc_chksum_ref(length, testdata + src_off, length);
+				sum_exp = calc_chksum_copy(length, testdst + dst_off,
+							   testdata + src_off, length);
+
+				zassert_equal(sum_got, sum_exp,
+					      "Mismatch between reference and copy checksum\n");
+				zassert_mem_equal(testdst + dst_off, testdata + src_off, length,
+						  "Data not copied\n");
+				zassert_equal(testdst[dst_off + length], 0, "Copied too much\n");
+			}
+		}
+	}
+
+	for (int i = 1; i <= CHECKSUM_TEST_LENGTH - 8; i++) {
+		sum_got = calc_chksum_ref(0, testdata + 3, i);
+		sum_exp = calc_chksum_copy(0, testdst + 1, testdata + 3, i);
+
+		zassert_equal(sum_got, sum_exp,
+			      "Mismatch between reference and copy checksum\n");
+	}
+
+	/* Summing in two parts at any split point gives the same result */
+	for (int split = 0; split <= 64; split++) {
+		uint16_t sum = calc_chksum(0, testdata + 1, split);
+
+		sum = net_chksum_add(sum, calc_chksum(0, testdata + 1 + split, 64 - split),
+				     split);
+		zassert_equal(calc_chksum_ref(0, testdata + 1, 64), sum,
+			      "Mismatch when combining partial checksums\n");
+	}
+}
+
+#define CHECKSUM_BENCH_ROUNDS 1000
+#define CHECKSUM_BENCH_LENGTH (CHECKSUM_TEST_LENGTH - 8)
+
+ZTEST(test_utils_fn, test_ip_checksum_benchmark)
+{
+	uint32_t ref_cycles, sum_cycles, memcpy_cycles, copy_cycles;
+	volatile uint16_t sum = 0U;
+	uint32_t start;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < CHECKSUM_BENCH_ROUNDS; i++) {
+		sum += calc_chksum_ref(0, testdata + 2, CHECKSUM_BENCH_LENGTH);
+	}
+	ref_cycles = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < CHECKSUM_BENCH_ROUNDS; i++) {
+		sum += calc_chksum(0, testdata + 2, CHECKSUM_BENCH_LENGTH);
+	}
+	sum_cycles = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < CHECKSUM_BENCH_ROUNDS; i++) {
+		memcpy(testdst + 2, testdata + 2, CHECKSUM_BENCH_LENGTH);
+		sum += calc_chksum(0, testdst + 2, CHECKSUM_BENCH_LENGTH);
+	}
+	memcpy_cycles = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (int i = 0; i < CHECKSUM_BENCH_ROUNDS; i++) {
+		sum += calc_chksum_copy(0, testdst + 2, testdata + 2, CHECKSUM_BENCH_LENGTH);
+	}
+	copy_cycles = k_cycle_get_32() - start;
+
+	TC_PRINT("%d x %d bytes: reference %u, calc_chksum %u, "
+		 "memcpy+calc_chksum %u, calc_chksum_copy %u cycles\n",
+		 CHECKSUM_BENCH_ROUNDS, CHECKSUM_BENCH_LENGTH, ref_cycles, sum_cycles,
+		 memcpy_cycles, copy_cycles);
+}
+
 ZTEST_SUITE(test_utils_fn, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,617 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/*
+ * This test is designed to be run using flash-simulator which provide
+ * functionality for flash property customization and emulating errors in
+ * flash operation in parallel to regular flash API.
+ */
+
+#if !defined(CONFIG_ARCH_POSIX)
+#error "Run only on a posix architecture based target (for ex. native_sim)"
+#endif
+
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/ztest.h>
+
+#include <zephyr/drivers/flash.h>
+#include <zephyr/fs/kvs.h>
+#include <zephyr/stats/stats.h>
+#include <zephyr/storage/flash_map.h>
+#include "kvs_priv.h"
+
+#define TEST_KVS_FLASH_AREA		storage_partition
+#define TEST_KVS_FLASH_AREA_OFFSET	FIXED_PARTITION_OFFSET(TEST_KVS_FLASH_AREA)
+#define TEST_KVS_FLASH_AREA_ID		FIXED_PARTITION_ID(TEST_KVS_FLASH_AREA)
+#define TEST_KVS_FLASH_AREA_DEV \
+	DEVICE_DT_GET(DT_MTD_FROM_FIXED_PARTITION(DT_NODELABEL(TEST_KVS_FLASH_AREA)))
+#define TEST_SECTOR_COUNT		4U
+#define TEST_KEY			"test/key"
+
+static const struct device *const flash_dev = TEST_KVS_FLASH_AREA_DEV;
+
+struct kvs_fixture {
+	struct kvs_fs fs;
+	struct stats_hdr *sim_stats;
+	struct stats_hdr *sim_thresholds;
+};
+
+static void *setup(void)
+{
+	int err;
+	const struct flash_area *fa;
+	struct flash_pages_info info;
+	static struct kvs_fixture fixture;
+
+	__ASSERT_NO_MSG(device_is_ready(flash_dev));
+
+	err = flash_area_open(TEST_KVS_FLASH_AREA_ID, &fa);
+	zassert_true(err == 0, "flash_area_open() fail: %d", err);
+
+	fixture.fs.offset = TEST_KVS_FLASH_AREA_OFFSET;
+	err = flash_get_page_info_by_offs(flash_area_get_device(fa), fixture.fs.offset,
+					  &info);
+	zassert_true(err == 0,  "Unable to get page info: %d", err);
+
+	fixture.fs.sector_size = info.size;
+	fixture.fs.sector_count = TEST_SECTOR_COUNT;
+	fixture.fs.flash_device = flash_area_get_device(fa);
+
+	return &fixture;
+}
+
+static void before(void *data)
+{
+	struct kvs_fixture *fixture = (struct kvs_fixture *)data;
+
+	fixture->sim_stats = stats_group_find("flash_sim_stats");
+	fixture->sim_thresholds = stats_group_find("flash_sim_thresholds");
+}
+
+static void after(void *data)
+{
+	struct kvs_fixture *fixture = (struct kvs_fixture *)data;
+
+	if (fixture->sim_stats) {
+		stats_reset(fixture->sim_stats);
+	}
+	if (fixture->sim_thresholds) {
+		stats_reset(fixture->sim_thresholds);
+	}
+
+	/* Clear KVS */
+	if (fixture->fs.ready) {
+		int err;
+
+		err = kvs_clear(&fixture->fs);
+		zassert_true(err == 0, "kvs_clear call failure: %d", err);
+	}
+
+	fixture->fs.sector_count = TEST_SECTOR_COUNT;
+}
+
+ZTEST_SUITE(kvs, NULL, setup, before, after, NULL);
+
+static int flash_sim_write_calls_find(struct stats_hdr *hdr, void *arg,
+				      const char *name, uint16_t off)
+{
+	if (!strcmp(name, "flash_write_calls")) {
+		uint32_t **flash_write_stat = (uint32_t **) arg;
+		*flash_write_stat = (uint32_t *)((uint8_t *)hdr + off);
+	}
+
+	return 0;
+}
+
+static int flash_sim_max_write_calls_find(struct stats_hdr *hdr, void *arg,
+					  const char *name, uint16_t off)
+{
+	if (!strcmp(name, "max_write_calls")) {
+		uint32_t **max_write_calls = (uint32_t **) arg;
+		*max_write_calls = (uint32_t *)((uint8_t *)hdr + off);
+	}
+
+	return 0;
+}
+
+/* Makes the flash simulator drop the last of as many writes as the last
+ * write_calls_reset() was followed by, to simulate a power down.
+ */
+static uint32_t *flash_write_stat;
+
+static void write_calls_reset(struct kvs_fixture *fixture)
+{
+	stats_walk(fixture->sim_stats, flash_sim_write_calls_find, &flash_write_stat);
+	*flash_write_stat = 0;
+}
+
+static void write_calls_drop_last(struct kvs_fixture *fixture)
+{
+	uint32_t *flash_max_write_calls;
+
+	stats_walk(fixture->sim_thresholds, flash_sim_max_write_calls_find,
+		   &flash_max_write_calls);
+
+	*flash_max_write_calls = *flash_write_stat;
+	*flash_write_stat = 0;
+}
+
+static void remount(struct kvs_fixture *fixture)
+{
+	int err;
+#ifdef CONFIG_KVS_BACKGROUND_GC
+	struct k_work_sync sync;
+
+	/* the gc work must not be queued when the file system is wiped */
+	if (fixture->fs.ready) {
+		(void)k_work_cancel_sync(&fixture->fs.gc_work, &sync);
+	}
+#endif
+
+	stats_reset(fixture->sim_thresholds);
+
+	memset(&fixture->fs, 0, sizeof(fixture->fs));
+	(void)setup();
+	err = kvs_mount(&fixture->fs);
+	zassert_true(err == 0, "kvs_mount call failure: %d", err);
+}
+
+static void fill_pattern(uint8_t *buf, size_t len, uint8_t seed)
+{
+	for (size_t i = 0; i < len; i++) {
+		buf[i] = seed + i;
+	}
+}
+
+static void check_entry(struct kvs_fs *fs, const char *key, const uint8_t *expected,
+			size_t len)
+{
+	uint8_t rd_buf[128];
+	ssize_t rc;
+
+	rc = kvs_read(fs, key, strlen(key), rd_buf, sizeof(rd_buf));
+	zassert_equal(rc, len, "kvs_read of %s unexpected result: %d", key, rc);
+	zassert_mem_equal(rd_buf, expected, len, "wrong data for %s", key);
+}
+
+ZTEST_F(kvs, test_kvs_mount)
+{
+	int err;
+
+	err = kvs_mount(&fixture->fs);
+	zassert_true(err == 0,  "kvs_mount call failure: %d", err);
+
+	fixture->fs.sector_count = 1;
+	err = kvs_mount(&fixture->fs);
+	zassert_true(err == -EINVAL, "kvs_mount accepted a single sector: %d", err);
+}
+
+ZTEST_F(kvs, test_kvs_write)
+{
+	uint8_t wr_buf[100];
+	uint8_t rd_buf[10];
+	char long_key[CONFIG_KVS_KEY_MAX_LEN + 1];
+	ssize_t len;
+	int err;
+
+	err = kvs_mount(&fixture->fs);
+	zassert_true(err == 0,  "kvs_mount call failure: %d", err);
+
+	len = kvs_read(&fixture->fs, TEST_KEY, strlen(TEST_KEY), rd_buf, sizeof(rd_buf));
+	zassert_true(len == -ENOENT,  "kvs_read unexpected failure: %d", len);
+
+	fill_pattern(wr_buf, sizeof(wr_buf), 0);
+	len = kvs_write(&fixture->fs, TEST_KEY, strlen(TEST_KEY), wr_buf, sizeof(wr_buf));
+	zassert_true(len == sizeof(wr_buf), "kvs_write failed: %d", len);
+
+	check_entry(&fixture->fs, TEST_KEY, wr_buf, sizeof(wr_buf));
+
+	/* A shorter read reports the full length */
+	len = kvs_read(&fixture->fs, TEST_KEY, strlen(TEST_KEY), rd_buf, sizeof(rd_buf));
+	zassert_true(len == sizeof(wr_buf), "kvs_read unexpected result: %d", len);
+	zassert_mem_equal(rd_buf, wr_buf, sizeof(rd_buf), "wrong data read");
+
+	/* Keys are compared in full, not by prefix */
+	len = kvs_read(&fixture->fs, TEST_KEY, strlen(TEST_KEY) - 1, rd_buf, sizeof(rd_buf));
+	zassert_true(len == -ENOENT, "kvs_read found a key prefix: %d", len);
+
+	/* Writing the same data again writes nothing */
+	len = kvs_write(&fixture->fs, TEST_KEY, strlen(TEST_KEY), wr_buf, sizeof(wr_buf));
+	zassert_true(len == 0, "kvs_write of unchanged data wrote: %d", len);
+
+	memset(long_key, 'k', sizeof(long_key));
+	len = kvs_write(&fixture->fs, long_key, sizeof(long_key), wr_buf, sizeof(wr_buf));
+	zassert_true(len == -EINVAL, "kvs_write accepted a too long key: %d", len);
+
+	remount(fixture);
+	check_entry(&fixture->fs, TEST_KEY, wr_buf, sizeof(wr_buf));
+
+	err = kvs_delete(&fixture->fs, TEST_KEY, strlen(TEST_KEY));
+	zassert_true(err == 0, "kvs_delete call failure: %d", err);
+
+	len = kvs_read(&fixture->fs, TEST_KEY, strlen(TEST_KEY), rd_buf, sizeof(rd_buf));
+	zassert_true(len == -ENOENT, "kvs_read of a deleted key: %d", len);
+
+	remount(fixture);
+
+	len = kvs_read(&fixture->fs, TEST_KEY, strlen(TEST_KEY), rd_buf, sizeof(rd_buf));
+	zassert_true(len == -ENOENT, "deleted key found after mount: %d", len);
+}
+
+/*
+ * Test entries whose key and data lengths are not multiples of the write block
+ * size, their records are written partly through the write buffer.
+ */
+ZTEST_F(kvs, test_kvs_write_unaligned)
+{
+	uint8_t wr_buf[100];
+	char key[16];
+	ssize_t len;
+	int err;
+
+	err = kvs_mount(&fixture->fs);
+	zassert_true(err == 0,  "kvs_mount call failure: %d", err);
+
+	for (size_t key_len = 1; key_len < sizeof(key); key_len += 2) {
+		memset(key, 'a' + key_len, key_len);
+		key[key_len] = '\0';
+
+		fill_pattern(wr_buf, sizeof(wr_buf) - key_len, key_len);
+		len = kvs_write(&fixture->fs, key, key_len, wr_buf, sizeof(wr_buf) - key_len);
+		zassert_true(len == sizeof(wr_buf) - key_len, "kvs_write failed: %d", len);
+
+		check_entry(&fixture->fs, key, wr_buf, sizeof(wr_buf) - key_len);
+	}
+
+	remount(fixture);
+
+	for (size_t key_len = 1; key_len < sizeof(key); key_len += 2) {
+		memset(key, 'a' + key_len, key_len);
+		key[key_len] = '\0';
+
+		fill_pattern(wr_buf, sizeof(wr_buf) - key_len, key_len);
+		check_entry(&fixture->fs, key, wr_buf, sizeof(wr_buf) - key_len);
+	}
+}
+
+static void write_content(struct kvs_fs *fs, uint16_t max_key, uint16_t begin, uint16_t end)
+{
+	char key[16];
+	uint8_t buf[32];
+	ssize_t len;
+
+	for (uint16_t i = begin; i < end; i++) {
+		snprintf(key, sizeof(key), "data/%u", i % max_key);
+		fill_pattern(buf, sizeof(buf), i);
+
+		len = kvs_write(fs, key, strlen(key), buf, sizeof(buf));
+		zassert_true(len == sizeof(buf), "kvs_write failed: %d", len);
+	}
+}
+
+static void check_content(struct kvs_fs *fs, uint16_t max_key, uint16_t end)
+{
+	char key[16];
+	uint8_t buf[32];
+
+	/* The last max_key writes hold the data of the keys */
+	for (uint16_t i = end - max_key; i < end; i++) {
+		snprintf(key, sizeof(key), "data/%u", i % max_key);
+		fill_pattern(buf, sizeof(buf), i);
+		check_entry(fs, key, buf, sizeof(buf));
+	}
+}
+
+#define TEST_STATIC_COUNT 8
+
+static void write_static_content(struct kvs_fs *fs)
+{
+	char key[16];
+	ssize_t len;
+
+	for (uint16_t i = 0; i < TEST_STATIC_COUNT; i++) {
+		snprintf(key, sizeof(key), "static/%u", i);
+		len = kvs_write(fs, key, strlen(key), &i, sizeof(i));
+		zassert_true(len == sizeof(i), "kvs_write failed: %d", len);
+	}
+}
+
+static void check_static_content(struct kvs_fs *fs)
+{
+	char key[16];
+
+	for (uint16_t i = 0; i < TEST_STATIC_COUNT; i++) {
+		snprintf(key, sizeof(key), "static/%u", i);
+		check_entry(fs, key, (const uint8_t *)&i, sizeof(i));
+	}
+}
+
+ZTEST_F(kvs, test_kvs_gc)
+{
+	struct kvs_stats stats;
+	int err;
+
+	const uint16_t max_key = 10;
+	/* Several times what the file system holds */
+	const uint16_t max_writes = 500;
+
+	err = kvs_mount(&fixture->fs);
+	zassert_true(err == 0,  "kvs_mount call failure: %d", err);
+
+	write_static_content(&fixture->fs);
+	write_content(&fixture->fs, max_key, 0, max_writes);
+
+	check_content(&fixture->fs, max_key, max_writes);
+	check_static_content(&fixture->fs);
+
+	err = kvs_stats_get(&fixture->fs, &stats);
+	zassert_true(err == 0, "kvs_stats_get call failure: %d", err);
+	zassert_equal(stats.keys, max_key + TEST_STATIC_COUNT, "wrong key count");
+	zassert_true(stats.gc_count > 0, "no sector garbage collected");
+	zassert_true(stats.moved > 0, "no entry moved");
+	/* The sectors are used in turn */
+	zassert_true(stats.erase_count_max - stats.erase_count_min <= 1,
+		     "uneven erase counts %u..%u", stats.erase_count_min, stats.erase_count_max);
+
+	remount(fixture);
+
+	check_content(&fixture->fs, max_key, max_writes);
+	check_static_content(&fixture->fs);
+
+	/* The erase counts are kept in flash */
+	err = kvs_stats_get(&fixture->fs, &stats);
+	zassert_true(err == 0, "kvs_stats_get call failure: %d", err);
+	zassert_true(stats.erase_count_min > 1, "erase counts lost");
+}
+
+/*
+ * Test that the last record written is discarded by kvs_mount() when its
+ * value was not completely written.
+ */
+ZTEST_F(kvs, test_kvs_corrupted_write)
+{
+	uint8_t wr_buf_1[100];
+	uint8_t wr_buf_2[100];
+	ssize_t len;
+	int err;
+
+	err = kvs_mount(&fixture->fs);
+	zassert_true(err == 0,  "kvs_mount call failure: %d", err);
+
+	fill_pattern(wr_buf_1, sizeof(wr_buf_1), 0);
+	fill_pattern(wr_buf_2, sizeof(wr_buf_2), 0x80);
+
+	len = kvs_write(&fixture->fs, "other", strlen("other"), wr_buf_2, sizeof(wr_buf_2));
+	zassert_true(len == sizeof(wr_buf_2), "kvs_write failed: %d", len);
+
+	write_calls_reset(fixture);
+	len = kvs_write(&fixture->fs, TEST_KEY, strlen(TEST_KEY), wr_buf_1, sizeof(wr_buf_1));
+	zassert_true(len == sizeof(wr_buf_1), "kvs_write failed: %d", len);
+
+	/* Flash simulator will lose the end of the value of this write,
+	 * the record header and key are written.
+	 */
+	write_calls_drop_last(fixture);
+	len = kvs_write(&fixture->fs, TEST_KEY, strlen(TEST_KEY), wr_buf_2, sizeof(wr_buf_2));
+	zassert_true(len == sizeof(wr_buf_2), "kvs_write failed: %d", len);
+
+	remount(fixture);
+
+	check_entry(&fixture->fs, TEST_KEY, wr_buf_1, sizeof(wr_buf_1));
+	check_entry(&fixture->fs, "other", wr_buf_2, sizeof(wr_buf_2));
+
+	/* Writes go on after the incomplete record */
+	len = kvs_write(&fixture->fs, TEST_KEY, strlen(TEST_KEY), wr_buf_2, sizeof(wr_buf_2));
+	zassert_true(len == sizeof(wr_buf_2), "kvs_write failed: %d", len);
+
+	remount(fixture);
+
+	check_entry(&fixture->fs, TEST_KEY, wr_buf_2, sizeof(wr_buf_2));
+}
+
+ZTEST_F(kvs, test_kvs_batch)
+{
+	uint8_t buf_a[20], buf_b[40];
+	struct kvs_batch_entry entries[] = {
+		{ .key = "batch/a", .key_len = 7, .data = buf_a, .len = sizeof(buf_a) },
+		{ .key = "batch/b", .key_len = 7, .data = buf_b, .len = sizeof(buf_b) },
+		{ .key = TEST_KEY, .key_len = strlen(TEST_KEY), .data = NULL },
+	};
+	struct kvs_stats stats;
+	uint8_t rd_buf[4];
+	ssize_t len;
+	int err;
+
+	err = kvs_mount(&fixture->fs);
+	zassert_true(err == 0,  "kvs_mount call failure: %d", err);
+
+	len = kvs_write(&fixture->fs, TEST_KEY, strlen(TEST_KEY), "x", 1);
+	zassert_true(len == 1, "kvs_write failed: %d", len);
+
+	fill_pattern(buf_a, sizeof(buf_a), 1);
+	fill_pattern(buf_b, sizeof(buf_b), 2);
+
+	err = kvs_write_batch(&fixture->fs, entries, ARRAY_SIZE(entries));
+	zassert_true(err == 0, "kvs_write_batch call failure: %d", err);
+
+	for (int i = 0; i < 2; i++) {
+		check_entry(&fixture->fs, "batch/a", buf_a, sizeof(buf_a));
+		check_entry(&fixture->fs, "batch/b", buf_b, sizeof(buf_b));
+		len = kvs_read(&fixture->fs, TEST_KEY, strlen(TEST_KEY), rd_buf, sizeof(rd_buf));
+		zassert_true(len == -ENOENT, "key deleted by the batch found: %d", len);
+
+		err = kvs_stats_get(&fixture->fs, &stats);
+		zassert_true(err == 0, "kvs_stats_get call failure: %d", err);
+		zassert_equal(stats.keys, 2, "wrong key count");
+
+		remount(fixture);
+	}
+
+	err = kvs_write_batch(&fixture->fs, entries, CONFIG_KVS_BATCH_MAX_ENTRIES + 1);
+	zassert_true(err == -EINVAL, "kvs_write_batch accepted too many entries: %d", err);
+}
+
+/*
+ * Test that a batch whose commit record was not written is discarded by
+ * kvs_mount() as a whole.
+ */
+ZTEST_F(kvs, test_kvs_corrupted_batch)
+{
+	uint8_t buf_1[20], buf_2[20];
+	struct kvs_batch_entry entries[] = {
+		{ .key = "batch/a", .key_len = 7, .data = buf_1, .len = sizeof(buf_1) },
+		{ .key = "batch/b", .key_len = 7, .data = buf_1, .len = sizeof(buf_1) },
+	};
+	int err;
+
+	err = kvs_mount(&fixture->fs);
+	zassert_true(err == 0,  "kvs_mount call failure: %d", err);
+
+	fill_pattern(buf_1, sizeof(buf_1), 1);
+	fill_pattern(buf_2, sizeof(buf_2), 2);
+
+	err = kvs_write_batch(&fixture->fs, entries, ARRAY_SIZE(entries));
+	zassert_true(err == 0, "kvs_write_batch call failure: %d", err);
+
+	write_calls_reset(fixture);
+	err = kvs_write_batch(&fixture->fs, entries, ARRAY_SIZE(entries));
+	zassert_true(err == 0, "kvs_write_batch call failure: %d", err);
+
+	/* Flash simulator will lose the commit record, the last write */
+	entries[0].data = buf_2;
+	entries[1].data = buf_2;
+	write_calls_drop_last(fixture);
+	err = kvs_write_batch(&fixture->fs, entries, ARRAY_SIZE(entries));
+	zassert_true(err == 0, "kvs_write_batch call failure: %d", err);
+
+	remount(fixture);
+
+	check_entry(&fixture->fs, "batch/a", buf_1, sizeof(buf_1));
+	check_entry(&fixture->fs, "batch/b", buf_1, sizeof(buf_1));
+}
+
+struct walk_arg {
+	struct kvs_fs *fs;
+	uint32_t found;
+	uint32_t addr[TEST_STATIC_COUNT];
+};
+
+static int walk_cb(const void *key, size_t key_len, uint32_t addr, size_t len, void *param)
+{
+	struct walk_arg *arg = (struct walk_arg *)param;
+	uint16_t data;
+	unsigned int i;
+	ssize_t rc;
+
+	zassert_equal(key_len, strlen(key), "key not terminated");
+	zassert_equal(sscanf(key, "static/%u", &i), 1, "unexpected key %s", (const char *)key);
+	zassert_true(i < TEST_STATIC_COUNT, "unexpected key %s", (const char *)key);
+
+	rc = kvs_read_addr(arg->fs, key, key_len, addr, &data, sizeof(data));
+	zassert_equal(rc, len, "kvs_read_addr unexpected result: %d", rc);
+	zassert_equal(data, i, "wrong data for %s", (const char *)key);
+
+	zassert_false(arg->found & BIT(i), "key %s walked twice", (const char *)key);
+	arg->found |= BIT(i);
+	arg->addr[i] = addr;
+
+	return 0;
+}
+
+ZTEST_F(kvs, test_kvs_walk)
+{
+	struct walk_arg arg = { .fs = &fixture->fs };
+	char key[16];
+	uint16_t data;
+	ssize_t rc;
+	int err;
+
+	err = kvs_mount(&fixture->fs);
+	zassert_true(err == 0,  "kvs_mount call failure: %d", err);
+
+	write_static_content(&fixture->fs);
+	write_static_content(&fixture->fs);
+
+	snprintf(key, sizeof(key), "static/%u", TEST_STATIC_COUNT);
+	err = kvs_write(&fixture->fs, key, strlen(key), key, 1);
+	zassert_true(err == 1, "kvs_write failed: %d", err);
+	err = kvs_delete(&fixture->fs, key, strlen(key));
+	zassert_true(err == 0, "kvs_delete call failure: %d", err);
+
+	err = kvs_walk(&fixture->fs, walk_cb, &arg);
+	zassert_true(err == 0, "kvs_walk call failure: %d", err);
+	zassert_equal(arg.found, BIT_MASK(TEST_STATIC_COUNT), "keys not walked: %x",
+		      arg.found);
+
+	/* An address walked before the entry was written again, or the
+	 * address of another entry, reads the current data of the key.
+	 */
+	snprintf(key, sizeof(key), "static/%u", 0);
+	data = 100;
+	err = kvs_write(&fixture->fs, key, strlen(key), &data, sizeof(data));
+	zassert_true(err == sizeof(data), "kvs_write failed: %d", err);
+
+	data = 0;
+	rc = kvs_read_addr(&fixture->fs, key, strlen(key), arg.addr[0], &data, sizeof(data));
+	zassert_equal(rc, sizeof(data), "kvs_read_addr unexpected result: %d", rc);
+	zassert_equal(data, 100, "stale data read for %s", key);
+
+	rc = kvs_read_addr(&fixture->fs, key, strlen(key), arg.addr[1], &data, sizeof(data));
+	zassert_equal(rc, sizeof(data), "kvs_read_addr unexpected result: %d", rc);
+	zassert_equal(data, 100, "data of another key read for %s", key);
+
+	/* A deleted entry is not found at its walked address */
+	snprintf(key, sizeof(key), "static/%u", 1);
+	err = kvs_delete(&fixture->fs, key, strlen(key));
+	zassert_true(err == 0, "kvs_delete call failure: %d", err);
+
+	rc = kvs_read_addr(&fixture->fs, key, strlen(key), arg.addr[1], &data, sizeof(data));
+	zassert_equal(rc, -ENOENT, "deleted entry read: %d", rc);
+}
+
+/*
+ * Test that with background garbage collection the sectors are garbage
+ * collected without kvs_write() having to wait for it.
+ */
+ZTEST_F(kvs, test_kvs_background_gc)
+{
+#ifdef CONFIG_KVS_BACKGROUND_GC
+	struct kvs_stats stats;
+	int err;
+
+	const uint16_t max_key = 10;
+	const uint16_t max_writes = 300;
+
+	fixture->fs.sector_count = 3;
+
+	err = kvs_mount(&fixture->fs);
+	zassert_true(err == 0, "kvs_mount call failure: %d", err);
+
+	write_static_content(&fixture->fs);
+
+	/* Give the background gc some time after every couple of writes */
+	for (uint16_t i = 0; i < max_writes; i += 2) {
+		write_content(&fixture->fs, max_key, i, i + 2);
+		k_sleep(K_MSEC(10));
+	}
+
+	check_content(&fixture->fs, max_key, max_writes);
+	check_static_content(&fixture->fs);
+
+	err = kvs_stats_get(&fixture->fs, &stats);
+	zassert_true(err == 0, "kvs_stats_get call failure: %d", err);
+	zassert_true(stats.gc_count > 0, "no sector garbage collected");
+	zassert_equal(stats.blocking_count, 0, "kvs_write waited for gc");
+
+	remount(fixture);
+
+	check_content(&fixture->fs, max_key, max_writes);
+	check_static_content(&fixture->fs);
+#else
+	ztest_test_skip();
+#endif
+}
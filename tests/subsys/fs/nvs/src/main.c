@@ -66,6 +66,21 @@ static void *setup(void)
 	return &fixture;
 }
 
+/* Wipe the file system structure, as after a reboot */
+static void wipe(struct nvs_fs *fs)
+{
+#ifdef CONFIG_NVS_BACKGROUND_GC
+	struct k_work_sync sync;
+
+	/* the gc work must not be queued when the structure is wiped */
+	if (fs->ready) {
+		(void)k_work_cancel_sync(&fs->gc_work, &sync);
+	}
+#endif
+
+	memset(fs, 0, sizeof(*fs));
+}
+
 static void before(void *data)
 {
 	struct nvs_fixture *fixture = (struct nvs_fixture *)data;
@@ -218,7 +233,7 @@ ZTEST_F(nvs, test_nvs_corrupted_write)
 	zassert_true(len == sizeof(wr_buf_2), "nvs_write failed: %d", len);
 
 	/* Reinitialize the NVS. */
-	memset(&fixture->fs, 0, sizeof(fixture->fs));
+	wipe(&fixture->fs);
 	(void)setup();
 	err = nvs_mount(&fixture->fs);
 	zassert_true(err == 0,  "nvs_mount call failure: %d", err);
@@ -934,3 +949,322 @@ ZTEST_F(nvs, test_nvs_cache_hash_quality)
 
 #endif
 }
+
+struct nvs_walk_result {
+	uint32_t addr[10];
+	size_t len[10];
+	bool seen[10];
+	size_t count;
+	size_t stop_after;
+};
+
+static int nvs_walk_record(uint16_t id, uint32_t addr, size_t len, void *param)
+{
+	struct nvs_walk_result *result = param;
+
+	zassert_true(id < ARRAY_SIZE(result->addr), "unexpected id %u", id);
+
+	/* only the newest entry of an id holds its data */
+	if (!result->seen[id]) {
+		result->seen[id] = true;
+		result->addr[id] = addr;
+		result->len[id] = len;
+	}
+
+	result->count++;
+
+	return (result->count == result->stop_after) ? 1 : 0;
+}
+
+/*
+ * Test that walking the entries finds them all, newest first, and that they can
+ * be read by address.
+ */
+ZTEST_F(nvs, test_nvs_walk)
+{
+	struct nvs_walk_result result = {0};
+	int err;
+	ssize_t len;
+	uint16_t data;
+
+	fixture->fs.sector_count = 3;
+
+	err = nvs_mount(&fixture->fs);
+	zassert_true(err == 0, "nvs_mount call failure: %d", err);
+
+	for (uint16_t id = 0; id < ARRAY_SIZE(result.addr); id++) {
+		len = nvs_write(&fixture->fs, id, &id, sizeof(id));
+		zassert_equal(len, sizeof(id), "nvs_write failed: %d", len);
+	}
+
+	data = 100;
+	len = nvs_write(&fixture->fs, 3, &data, sizeof(data));
+	zassert_equal(len, sizeof(data), "nvs_write failed: %d", len);
+
+	err = nvs_delete(&fixture->fs, 5);
+	zassert_true(err == 0, "nvs_delete call failure: %d", err);
+
+	err = nvs_walk(&fixture->fs, nvs_walk_record, &result);
+	zassert_true(err == 0, "nvs_walk call failure: %d", err);
+	zassert_equal(result.count, ARRAY_SIZE(result.addr) + 2, "wrong number of entries");
+
+	for (uint16_t id = 0; id < ARRAY_SIZE(result.addr); id++) {
+		zassert_true(result.seen[id], "entry %u not walked", id);
+
+		len = nvs_read_addr(&fixture->fs, id, result.addr[id], &data, sizeof(data));
+
+		if (id == 5) {
+			zassert_equal(result.len[id], 0, "deleted entry has data");
+			zassert_equal(len, -ENOENT, "deleted entry read: %d", len);
+			continue;
+		}
+
+		zassert_equal(result.len[id], sizeof(data), "wrong entry length");
+		zassert_equal(len, sizeof(data), "nvs_read_addr failed: %d", len);
+		zassert_equal(data, (id == 3) ? 100 : id, "wrong data for entry %u", id);
+	}
+
+	len = nvs_read_addr(&fixture->fs, 4, result.addr[3], &data, sizeof(data));
+	zassert_equal(len, -ENOENT, "read of another entry's address: %d", len);
+
+	/* the walk stops when the callback asks to */
+	memset(&result, 0, sizeof(result));
+	result.stop_after = 1;
+
+	err = nvs_walk(&fixture->fs, nvs_walk_record, &result);
+	zassert_equal(err, 1, "nvs_walk did not stop: %d", err);
+	zassert_equal(result.count, 1, "walk continued");
+	zassert_true(result.seen[5], "newest entry not walked first");
+}
+
+/* Entries written once, that garbage collection has to move */
+#define TEST_STATIC_ID		100
+#define TEST_STATIC_COUNT	5
+
+static void write_static_content(struct nvs_fs *fs)
+{
+	ssize_t len;
+
+	for (uint16_t id = TEST_STATIC_ID; id < TEST_STATIC_ID + TEST_STATIC_COUNT; id++) {
+		len = nvs_write(fs, id, &id, sizeof(id));
+		zassert_true(len == sizeof(id), "nvs_write failed: %d", len);
+	}
+}
+
+static void check_static_content(struct nvs_fs *fs)
+{
+	ssize_t len;
+	uint16_t data;
+
+	for (uint16_t id = TEST_STATIC_ID; id < TEST_STATIC_ID + TEST_STATIC_COUNT; id++) {
+		len = nvs_read(fs, id, &data, sizeof(data));
+		zassert_true(len == sizeof(data), "nvs_read unexpected failure: %d", len);
+		zassert_equal(data, id, "wrong data for entry %u", id);
+	}
+}
+
+/*
+ * Test that with background garbage collection the sectors are garbage
+ * collected without nvs_write() having to wait for it.
+ */
+ZTEST_F(nvs, test_nvs_background_gc)
+{
+#ifdef CONFIG_NVS_BACKGROUND_GC
+	struct nvs_gc_stats stats;
+	int err;
+
+	const uint16_t max_id = 10;
+	/* Once all 3 sectors are in use */
+	const uint16_t first_write = 100;
+	/* Keeps the data of write_content() below 256 */
+	const uint16_t max_writes = 250;
+
+	fixture->fs.sector_count = 3;
+
+	err = nvs_mount(&fixture->fs);
+	zassert_true(err == 0, "nvs_mount call failure: %d", err);
+
+	write_static_content(&fixture->fs);
+
+	/* Give the background gc some time after every few writes */
+	for (uint16_t i = 0; i < max_writes; i += 5) {
+		if (i == first_write) {
+			/* Start over with the statistics */
+			err = nvs_mount(&fixture->fs);
+			zassert_true(err == 0, "nvs_mount call failure: %d", err);
+		}
+
+		write_content(max_id, i, i + 5, &fixture->fs);
+		k_sleep(K_MSEC(10));
+	}
+
+	check_content(max_id, &fixture->fs);
+	check_static_content(&fixture->fs);
+
+	err = nvs_gc_stats_get(&fixture->fs, &stats);
+	zassert_true(err == 0, "nvs_gc_stats_get call failure: %d", err);
+	zassert_true(stats.count > 0, "no sector garbage collected");
+	zassert_equal(stats.blocking_count, 0, "nvs_write waited for gc");
+	zassert_true(stats.moved > 0, "no entry moved");
+	zassert_true(stats.written >= (max_writes - first_write) * 32U,
+		     "writes not accounted");
+
+	err = nvs_mount(&fixture->fs);
+	zassert_true(err == 0, "nvs_mount call failure: %d", err);
+
+	check_content(max_id, &fixture->fs);
+	check_static_content(&fixture->fs);
+#endif
+}
+
+/*
+ * Test that a background garbage collection interrupted by a power down is
+ * resumed on nvs_mount().
+ */
+ZTEST_F(nvs, test_nvs_background_gc_interrupted)
+{
+#ifdef CONFIG_NVS_BACKGROUND_GC
+	int err;
+	uint16_t i;
+	uint32_t threshold;
+	uint32_t *flash_write_stat;
+	uint32_t *flash_erase_stat;
+	uint32_t *flash_max_write_calls;
+	uint32_t *flash_max_erase_calls;
+
+	const uint16_t max_id = 10;
+
+	stats_walk(fixture->sim_thresholds, flash_sim_max_write_calls_find,
+		   &flash_max_write_calls);
+	stats_walk(fixture->sim_thresholds, flash_sim_max_erase_calls_find,
+		   &flash_max_erase_calls);
+	stats_walk(fixture->sim_stats, flash_sim_write_calls_find, &flash_write_stat);
+	stats_walk(fixture->sim_stats, flash_sim_erase_calls_find, &flash_erase_stat);
+
+	fixture->fs.sector_count = 3;
+
+	err = nvs_mount(&fixture->fs);
+	zassert_true(err == 0, "nvs_mount call failure: %d", err);
+
+	write_static_content(&fixture->fs);
+
+	/* Fill the first sector, then the second one up to the gc threshold.
+	 * The background gc doesn't get to run in between.
+	 */
+	threshold = fixture->fs.sector_size * CONFIG_NVS_BACKGROUND_GC_THRESHOLD / 100U;
+	i = 0;
+	while (((fixture->fs.ate_wra >> ADDR_SECT_SHIFT) == 0) ||
+	       ((fixture->fs.ate_wra - fixture->fs.data_wra) >= threshold)) {
+		write_content(max_id, i, i + 1, &fixture->fs);
+		i++;
+	}
+	zassert_equal(fixture->fs.ate_wra >> ADDR_SECT_SHIFT, 1,
+		      "unexpected write sector");
+
+	/* Simulate a power down once the second sector is closed and one
+	 * entry of the first sector is copied.
+	 */
+	*flash_write_stat = 0;
+	*flash_erase_stat = 0;
+	*flash_max_write_calls = 4;
+	*flash_max_erase_calls = 1;
+
+	k_sleep(K_MSEC(100));
+
+	/* Make the flash simulator functional again. */
+	*flash_max_write_calls = 0;
+	*flash_max_erase_calls = 0;
+
+	wipe(&fixture->fs);
+	(void)setup();
+	fixture->fs.sector_count = 3;
+
+	err = nvs_mount(&fixture->fs);
+	zassert_true(err == 0, "nvs_mount call failure: %d", err);
+	zassert_equal(fixture->fs.ate_wra >> ADDR_SECT_SHIFT, 2,
+		      "unexpected write sector");
+
+	check_content(max_id, &fixture->fs);
+	check_static_content(&fixture->fs);
+
+	err = nvs_mount(&fixture->fs);
+	zassert_true(err == 0, "nvs_mount call failure: %d", err);
+
+	check_content(max_id, &fixture->fs);
+	check_static_content(&fixture->fs);
+	execute_long_pattern_write(max_id, &fixture->fs);
+#endif
+}
+
+#ifdef CONFIG_NVS_BACKGROUND_GC
+static void write_counter(struct nvs_fs *fs, uint16_t max_id, uint32_t *counter)
+{
+	ssize_t len;
+
+	len = nvs_write(fs, *counter % max_id, counter, sizeof(*counter));
+	zassert_true(len == sizeof(*counter), "nvs_write failed: %d", len);
+	(*counter)++;
+
+	/* Give the background gc some time */
+	k_sleep(K_MSEC(1));
+}
+#endif
+
+/*
+ * Test that a write sector the background garbage collection skipped is
+ * garbage collected in the background again once it is the write sector anew.
+ */
+ZTEST_F(nvs, test_nvs_background_gc_skip_wrap)
+{
+#ifdef CONFIG_NVS_BACKGROUND_GC
+	struct nvs_gc_stats stats;
+	uint32_t blocking_count;
+	uint32_t counter = 0;
+	uint32_t data;
+	ssize_t len;
+	int err;
+
+	const uint16_t max_id = 10;
+
+	fixture->fs.sector_count = 3;
+
+	err = nvs_mount(&fixture->fs);
+	zassert_true(err == 0, "nvs_mount call failure: %d", err);
+
+	write_static_content(&fixture->fs);
+
+	/* The sector after the next one is still empty while the first sector
+	 * is filled, so the background gc skips the first sector and
+	 * nvs_write() closes it.
+	 */
+	while ((fixture->fs.ate_wra >> ADDR_SECT_SHIFT) == 0) {
+		write_counter(&fixture->fs, max_id, &counter);
+	}
+
+	err = nvs_gc_stats_get(&fixture->fs, &stats);
+	zassert_true(err == 0, "nvs_gc_stats_get call failure: %d", err);
+	zassert_true(stats.blocking_count > 0, "first sector not skipped");
+	blocking_count = stats.blocking_count;
+
+	/* Wrap the write sector around to the first sector and past it */
+	while ((fixture->fs.ate_wra >> ADDR_SECT_SHIFT) != 0) {
+		write_counter(&fixture->fs, max_id, &counter);
+	}
+
+	while ((fixture->fs.ate_wra >> ADDR_SECT_SHIFT) == 0) {
+		write_counter(&fixture->fs, max_id, &counter);
+	}
+
+	err = nvs_gc_stats_get(&fixture->fs, &stats);
+	zassert_true(err == 0, "nvs_gc_stats_get call failure: %d", err);
+	zassert_equal(stats.blocking_count, blocking_count, "nvs_write waited for gc");
+
+	for (uint32_t i = counter - max_id; i < counter; i++) {
+		len = nvs_read(&fixture->fs, i % max_id, &data, sizeof(data));
+		zassert_true(len == sizeof(data), "nvs_read unexpected failure: %d", len);
+		zassert_equal(data, i, "wrong data for entry %u", i % max_id);
+	}
+
+	check_static_content(&fixture->fs);
+#endif
+}
@@ -0,0 +1,543 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/fs/fs_sys.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/net/buf.h>
+#include <zephyr/mgmt/mcumgr/mgmt/mgmt.h>
+#include <zephyr/mgmt/mcumgr/transport/smp_dummy.h>
+#include <zephyr/mgmt/mcumgr/grp/fs_mgmt/fs_mgmt.h>
+#include <zcbor_common.h>
+#include <zcbor_decode.h>
+#include <zcbor_encode.h>
+#include <mgmt/mcumgr/util/zcbor_bulk.h>
+#include <mgmt/mcumgr/transport/smp_internal.h>
+#include <string.h>
+
+#define SMP_RESPONSE_WAIT_TIME 3
+#define ZCBOR_BUFFER_SIZE 256
+#define OUTPUT_BUFFER_SIZE 256
+#define ZCBOR_HISTORY_ARRAY_SIZE 4
+
+#define SHA256_SIZE 32
+
+#define RAM_FS_MNTP "/ram"
+#define RAM_FS_FILE_SIZE 256
+#define RAM_FS_FILES 2
+#define RAM_FS_HANDLES 4
+
+#define UPLOAD_FILE RAM_FS_MNTP "/upload.bin"
+#define REFERENCE_FILE RAM_FS_MNTP "/reference.bin"
+
+#define TEST_CHUNK_SIZE 64
+#define TEST_FILE_SIZE (TEST_CHUNK_SIZE * 2)
+
+/* Minimal RAM file system which counts the reads of file data */
+struct ram_fs_file {
+	char path[CONFIG_MCUMGR_GRP_FS_PATH_LEN + 1];
+	uint8_t data[RAM_FS_FILE_SIZE];
+	size_t size;
+	bool used;
+};
+
+struct ram_fs_handle {
+	struct ram_fs_file *file;
+	size_t pos;
+};
+
+static struct ram_fs_file ram_fs_files[RAM_FS_FILES];
+static struct ram_fs_handle ram_fs_handles[RAM_FS_HANDLES];
+static uint32_t ram_fs_reads;
+
+static struct net_buf *nb;
+static uint8_t test_data[TEST_FILE_SIZE + TEST_CHUNK_SIZE];
+
+static struct ram_fs_file *ram_fs_find(const char *path)
+{
+	for (int i = 0; i < ARRAY_SIZE(ram_fs_files); i++) {
+		if (ram_fs_files[i].used && strcmp(ram_fs_files[i].path, path) == 0) {
+			return &ram_fs_files[i];
+		}
+	}
+
+	return NULL;
+}
+
+static int ram_fs_open(struct fs_file_t *filp, const char *fs_path, fs_mode_t flags)
+{
+	struct ram_fs_file *file = ram_fs_find(fs_path);
+	struct ram_fs_handle *handle = NULL;
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(ram_fs_handles); i++) {
+		if (ram_fs_handles[i].file == NULL) {
+			handle = &ram_fs_handles[i];
+			break;
+		}
+	}
+
+	if (handle == NULL) {
+		return -ENFILE;
+	}
+
+	if (file == NULL) {
+		if (!(flags & FS_O_CREATE)) {
+			return -ENOENT;
+		}
+
+		for (i = 0; i < ARRAY_SIZE(ram_fs_files); i++) {
+			if (!ram_fs_files[i].used) {
+				file = &ram_fs_files[i];
+				break;
+			}
+		}
+
+		if (file == NULL || strlen(fs_path) >= sizeof(file->path)) {
+			return -ENOSPC;
+		}
+
+		strcpy(file->path, fs_path);
+		file->size = 0;
+		file->used = true;
+	}
+
+	handle->file = file;
+	handle->pos = 0;
+	filp->filep = handle;
+
+	return 0;
+}
+
+static ssize_t ram_fs_read(struct fs_file_t *filp, void *dest, size_t nbytes)
+{
+	struct ram_fs_handle *handle = filp->filep;
+	size_t len = 0;
+
+	if (handle->pos < handle->file->size) {
+		len = MIN(nbytes, handle->file->size - handle->pos);
+		memcpy(dest, &handle->file->data[handle->pos], len);
+		handle->pos += len;
+	}
+
+	ram_fs_reads++;
+
+	return len;
+}
+
+static ssize_t ram_fs_write(struct fs_file_t *filp, const void *src, size_t nbytes)
+{
+	struct ram_fs_handle *handle = filp->filep;
+	struct ram_fs_file *file = handle->file;
+
+	if (handle->pos + nbytes > sizeof(file->data)) {
+		return -ENOSPC;
+	}
+
+	if (handle->pos > file->size) {
+		memset(&file->data[file->size], 0, handle->pos - file->size);
+	}
+
+	memcpy(&file->data[handle->pos], src, nbytes);
+	handle->pos += nbytes;
+	file->size = MAX(file->size, handle->pos);
+
+	return nbytes;
+}
+
+static int ram_fs_lseek(struct fs_file_t *filp, off_t off, int whence)
+{
+	struct ram_fs_handle *handle = filp->filep;
+	off_t pos;
+
+	switch (whence) {
+	case FS_SEEK_SET:
+		pos = off;
+		break;
+	case FS_SEEK_CUR:
+		pos = handle->pos + off;
+		break;
+	case FS_SEEK_END:
+		pos = handle->file->size + off;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	if (pos < 0 || pos > RAM_FS_FILE_SIZE) {
+		return -EINVAL;
+	}
+
+	handle->pos = pos;
+
+	return 0;
+}
+
+static off_t ram_fs_tell(struct fs_file_t *filp)
+{
+	struct ram_fs_handle *handle = filp->filep;
+
+	return handle->pos;
+}
+
+static int ram_fs_truncate(struct fs_file_t *filp, off_t length)
+{
+	struct ram_fs_handle *handle = filp->filep;
+	struct ram_fs_file *file = handle->file;
+
+	if (length < 0 || length > RAM_FS_FILE_SIZE) {
+		return -EINVAL;
+	}
+
+	if (length > file->size) {
+		memset(&file->data[file->size], 0, length - file->size);
+	}
+
+	file->size = length;
+
+	return 0;
+}
+
+static int ram_fs_sync(struct fs_file_t *filp)
+{
+	return 0;
+}
+
+static int ram_fs_close(struct fs_file_t *filp)
+{
+	struct ram_fs_handle *handle = filp->filep;
+
+	handle->file = NULL;
+	filp->filep = NULL;
+
+	return 0;
+}
+
+static int ram_fs_mount(struct fs_mount_t *mountp)
+{
+	return 0;
+}
+
+static int ram_fs_unmount(struct fs_mount_t *mountp)
+{
+	return 0;
+}
+
+static int ram_fs_unlink(struct fs_mount_t *mountp, const char *name)
+{
+	struct ram_fs_file *file = ram_fs_find(name);
+
+	if (file == NULL) {
+		return -ENOENT;
+	}
+
+	file->used = false;
+
+	return 0;
+}
+
+static int ram_fs_stat(struct fs_mount_t *mountp, const char *path, struct fs_dirent *entry)
+{
+	struct ram_fs_file *file = ram_fs_find(path);
+
+	if (file == NULL) {
+		return -ENOENT;
+	}
+
+	entry->type = FS_DIR_ENTRY_FILE;
+	entry->size = file->size;
+	strncpy(entry->name, strrchr(path, '/') + 1, sizeof(entry->name) - 1);
+	entry->name[sizeof(entry->name) - 1] = '\0';
+
+	return 0;
+}
+
+static const struct fs_file_system_t ram_fs = {
+	.open = ram_fs_open,
+	.close = ram_fs_close,
+	.read = ram_fs_read,
+	.write = ram_fs_write,
+	.lseek = ram_fs_lseek,
+	.tell = ram_fs_tell,
+	.truncate = ram_fs_truncate,
+	.sync = ram_fs_sync,
+	.mount = ram_fs_mount,
+	.unmount = ram_fs_unmount,
+	.unlink = ram_fs_unlink,
+	.stat = ram_fs_stat,
+};
+
+static struct fs_mount_t ram_fs_mnt = {
+	.type = FS_TYPE_EXTERNAL_BASE,
+	.mnt_point = RAM_FS_MNTP,
+};
+
+static void cleanup_test(void *p)
+{
+	if (nb != NULL) {
+		net_buf_unref(nb);
+		nb = NULL;
+	}
+}
+
+/* Sends an fs group command, the response is left in nb with the SMP header removed */
+static void smp_send(const uint8_t *payload, size_t len, uint8_t id, bool write)
+{
+	uint8_t buffer_out[OUTPUT_BUFFER_SIZE];
+	struct smp_hdr *smp_header = (struct smp_hdr *)buffer_out;
+	bool received;
+
+	cleanup_test(NULL);
+
+	*smp_header = (struct smp_hdr) {
+		.nh_len = sys_cpu_to_be16(len),
+		.nh_flags = 0,
+		.nh_op = (write ? MGMT_OP_WRITE : MGMT_OP_READ),
+		.nh_group = sys_cpu_to_be16(MGMT_GROUP_ID_FS),
+		.nh_seq = 1,
+		.nh_id = id,
+		.nh_version = 1,
+	};
+	memcpy(&buffer_out[sizeof(struct smp_hdr)], payload, len);
+
+	/* Enable dummy SMP backend and ready for usage */
+	smp_dummy_enable();
+	smp_dummy_clear_state();
+
+	/* Send command to dummy SMP backend */
+	(void)smp_dummy_tx_pkt(buffer_out, sizeof(struct smp_hdr) + len);
+	smp_dummy_add_data();
+
+	/* For a short duration to see if response has been received */
+	received = smp_dummy_wait_for_data(SMP_RESPONSE_WAIT_TIME);
+	zassert_true(received, "Expected to receive data but timed out");
+
+	/* Retrieve response buffer */
+	nb = smp_dummy_get_outgoing();
+	smp_dummy_disable();
+
+	zassert_true(nb->len > sizeof(struct smp_hdr), "SMP response mismatch");
+
+	smp_header = net_buf_pull_mem(nb, sizeof(struct smp_hdr));
+
+	zassert_equal(smp_header->nh_op, (write ? MGMT_OP_WRITE_RSP : MGMT_OP_READ_RSP),
+		      "SMP header operation mismatch");
+	zassert_equal(smp_header->nh_group, sys_cpu_to_be16(MGMT_GROUP_ID_FS),
+		      "SMP header group mismatch");
+	zassert_equal(smp_header->nh_id, id, "SMP header command ID mismatch");
+}
+
+/* Uploads len bytes of the test data at off, returns whether the upload accepted them */
+static bool upload_data(size_t off, size_t len)
+{
+	uint8_t buffer[ZCBOR_BUFFER_SIZE];
+	zcbor_state_t zse[ZCBOR_HISTORY_ARRAY_SIZE] = { 0 };
+	zcbor_state_t zsd[ZCBOR_HISTORY_ARRAY_SIZE] = { 0 };
+	uint64_t rsp_off = 0;
+	size_t decoded = 0;
+	bool ok;
+
+	struct zcbor_map_decode_key_val output_decode[] = {
+		ZCBOR_MAP_DECODE_KEY_DECODER("off", zcbor_uint64_decode, &rsp_off),
+	};
+
+	zcbor_new_encode_state(zse, 2, buffer, ARRAY_SIZE(buffer), 0);
+
+	ok = zcbor_map_start_encode(zse, 4)					&&
+	     zcbor_tstr_put_lit(zse, "name")					&&
+	     zcbor_tstr_put_term(zse, UPLOAD_FILE, CONFIG_MCUMGR_GRP_FS_PATH_LEN)	&&
+	     zcbor_tstr_put_lit(zse, "off")					&&
+	     zcbor_uint64_put(zse, off)						&&
+	     (off != 0 || (zcbor_tstr_put_lit(zse, "len")			&&
+			   zcbor_uint64_put(zse, TEST_FILE_SIZE)))		&&
+	     zcbor_tstr_put_lit(zse, "data")					&&
+	     zcbor_bstr_encode_ptr(zse, &test_data[off], len)			&&
+	     zcbor_map_end_encode(zse, 4);
+	zassert_true(ok, "Expected packet creation to be successful");
+
+	smp_send(buffer, zse->payload_mut - buffer, FS_MGMT_ID_FILE, true);
+
+	zcbor_new_decode_state(zsd, 4, nb->data, nb->len, 1, NULL, 0);
+	ok = zcbor_map_decode_bulk(zsd, output_decode, ARRAY_SIZE(output_decode), &decoded) == 0;
+	zassert_true(ok, "Expected decode to be successful");
+
+	if (decoded == 0) {
+		return false;
+	}
+
+	zassert_equal(rsp_off, off + len, "Expected data to be written");
+
+	return true;
+}
+
+/* Uploads the test file */
+static void upload_file(void)
+{
+	for (size_t off = 0; off < TEST_FILE_SIZE; off += TEST_CHUNK_SIZE) {
+		zassert_true(upload_data(off, TEST_CHUNK_SIZE), "Expected chunk to be accepted");
+	}
+}
+
+/*
+ * Requests the hash/checksum of type for the whole of file, returns the output and the
+ * number of file reads the request took.
+ */
+static uint32_t hash_request(const char *type, const char *file, uint8_t *output,
+			     size_t output_size)
+{
+	uint8_t buffer[ZCBOR_BUFFER_SIZE];
+	zcbor_state_t zse[ZCBOR_HISTORY_ARRAY_SIZE] = { 0 };
+	zcbor_state_t zsd[ZCBOR_HISTORY_ARRAY_SIZE] = { 0 };
+	struct zcbor_string bstr_output = { 0 };
+	uint32_t uint_output = 0;
+	uint32_t reads = ram_fs_reads;
+	size_t decoded = 0;
+	bool ok;
+
+	/* Checksums are output as a number, hashes as a byte string */
+	struct zcbor_map_decode_key_val checksum_decode[] = {
+		ZCBOR_MAP_DECODE_KEY_DECODER("output", zcbor_uint32_decode, &uint_output),
+	};
+
+	struct zcbor_map_decode_key_val hash_decode[] = {
+		ZCBOR_MAP_DECODE_KEY_DECODER("output", zcbor_bstr_decode, &bstr_output),
+	};
+
+	zcbor_new_encode_state(zse, 2, buffer, ARRAY_SIZE(buffer), 0);
+
+	ok = zcbor_map_start_encode(zse, 2)					&&
+	     zcbor_tstr_put_lit(zse, "type")					&&
+	     zcbor_tstr_put_term(zse, type, CONFIG_ZCBOR_MAX_STR_LEN)		&&
+	     zcbor_tstr_put_lit(zse, "name")					&&
+	     zcbor_tstr_put_term(zse, file, CONFIG_MCUMGR_GRP_FS_PATH_LEN)	&&
+	     zcbor_map_end_encode(zse, 2);
+	zassert_true(ok, "Expected packet creation to be successful");
+
+	smp_send(buffer, zse->payload_mut - buffer, FS_MGMT_ID_HASH_CHECKSUM, false);
+
+	zcbor_new_decode_state(zsd, 4, nb->data, nb->len, 1, NULL, 0);
+	if (output_size == sizeof(uint32_t)) {
+		ok = zcbor_map_decode_bulk(zsd, checksum_decode, ARRAY_SIZE(checksum_decode),
+					   &decoded) == 0;
+	} else {
+		ok = zcbor_map_decode_bulk(zsd, hash_decode, ARRAY_SIZE(hash_decode),
+					   &decoded) == 0;
+	}
+
+	zassert_true(ok, "Expected decode to be successful");
+	zassert_equal(decoded, 1, "Expected %s output in response", type);
+
+	if (output_size == sizeof(uint32_t)) {
+		memcpy(output, &uint_output, sizeof(uint_output));
+	} else {
+		zassert_equal(bstr_output.len, output_size, "Unexpected %s output size", type);
+		memcpy(output, bstr_output.value, output_size);
+	}
+
+	return ram_fs_reads - reads;
+}
+
+/* Writes the reference file with the same contents as the upload file, through the fs API */
+static void reference_write(void)
+{
+	struct fs_file_t file;
+	struct fs_dirent entry;
+	int rc;
+
+	rc = fs_stat(UPLOAD_FILE, &entry);
+	zassert_ok(rc, "Expected uploaded file to exist");
+
+	fs_file_t_init(&file);
+	rc = fs_open(&file, REFERENCE_FILE, FS_O_CREATE | FS_O_WRITE);
+	zassert_ok(rc, "Expected reference file to open");
+	zassert_ok(fs_truncate(&file, 0), "Expected reference file to be truncated");
+	zassert_equal(fs_write(&file, test_data, entry.size), entry.size,
+		      "Expected reference file to be written");
+	zassert_ok(fs_close(&file), "Expected reference file to close");
+}
+
+/* Checks the hash/checksum outputs for the upload file against the reference file */
+static void hash_check(bool cached)
+{
+	uint8_t sha256[SHA256_SIZE];
+	uint8_t sha256_reference[SHA256_SIZE];
+	uint32_t crc32;
+	uint32_t crc32_reference;
+	uint32_t reads;
+
+	reference_write();
+
+	reads = hash_request("crc32", UPLOAD_FILE, (uint8_t *)&crc32, sizeof(crc32));
+	zassert_equal(reads == 0, cached, "Unexpected crc32 file reads: %u", reads);
+	reads = hash_request("crc32", REFERENCE_FILE, (uint8_t *)&crc32_reference,
+			     sizeof(crc32_reference));
+	zassert_true(reads > 0, "Expected reference file to be read");
+	zassert_equal(crc32, crc32_reference, "Expected crc32 to match reference");
+
+	reads = hash_request("sha256", UPLOAD_FILE, sha256, sizeof(sha256));
+	zassert_equal(reads == 0, cached, "Unexpected sha256 file reads: %u", reads);
+	reads = hash_request("sha256", REFERENCE_FILE, sha256_reference,
+			     sizeof(sha256_reference));
+	zassert_true(reads > 0, "Expected reference file to be read");
+	zassert_mem_equal(sha256, sha256_reference, sizeof(sha256),
+			  "Expected sha256 to match reference");
+}
+
+ZTEST(fs_mgmt_hash_upload, test_cached)
+{
+	upload_file();
+
+	/* Calculated while the file was uploaded */
+	hash_check(true);
+}
+
+ZTEST(fs_mgmt_hash_upload, test_mismatched_upload)
+{
+	upload_file();
+
+	/* A new upload of the file that has not finished */
+	test_data[0]++;
+	zassert_true(upload_data(0, TEST_CHUNK_SIZE), "Expected chunk to be accepted");
+	hash_check(false);
+
+	/* Data at an offset other than the end of the file is rejected */
+	zassert_false(upload_data(TEST_CHUNK_SIZE / 2, TEST_CHUNK_SIZE),
+		      "Expected chunk at mismatched offset to be rejected");
+	hash_check(false);
+}
+
+ZTEST(fs_mgmt_hash_upload, test_resumed_upload)
+{
+	upload_file();
+
+	/* Data appended to the file after the upload had finished */
+	zassert_true(upload_data(TEST_FILE_SIZE, TEST_CHUNK_SIZE),
+		     "Expected appended chunk to be accepted");
+	hash_check(false);
+}
+
+static void *setup_test(void)
+{
+	int rc;
+
+	rc = fs_register(FS_TYPE_EXTERNAL_BASE, &ram_fs);
+	zassert_ok(rc, "Expected RAM file system to register");
+
+	rc = fs_mount(&ram_fs_mnt);
+	zassert_ok(rc, "Expected RAM file system to mount");
+
+	return NULL;
+}
+
+static void before_test(void *p)
+{
+	for (int i = 0; i < sizeof(test_data); i++) {
+		test_data[i] = (uint8_t)(i * 13 + 5);
+	}
+}
+
+ZTEST_SUITE(fs_mgmt_hash_upload, NULL, setup_test, before_test, cleanup_test, NULL);
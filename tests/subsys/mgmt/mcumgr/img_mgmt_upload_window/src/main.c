@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/ztest.h>
+#include <zephyr/net/buf.h>
+#include <zephyr/mgmt/mcumgr/mgmt/mgmt.h>
+#include <zephyr/mgmt/mcumgr/transport/smp_dummy.h>
+#include <zephyr/mgmt/mcumgr/grp/img_mgmt/img_mgmt.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/stats/stats.h>
+#include <zcbor_common.h>
+#include <zcbor_decode.h>
+#include <zcbor_encode.h>
+#include <mgmt/mcumgr/util/zcbor_bulk.h>
+#include <string.h>
+#include <zephyr/sys/byteorder.h>
+#include <smp_internal.h>
+#include "smp_test_util.h"
+
+#ifdef CONFIG_IMG_ENABLE_IMAGE_CHECK
+#include <tinycrypt/constants.h>
+#include <tinycrypt/sha256.h>
+#endif
+
+#define SMP_RESPONSE_WAIT_TIME 3
+#define ZCBOR_BUFFER_SIZE 384
+#define OUTPUT_BUFFER_SIZE 384
+#define ZCBOR_HISTORY_ARRAY_SIZE 4
+
+/* MCUboot image header magic, the only part of the header that is checked on upload */
+#define TEST_IMAGE_MAGIC 0x96f3b83d
+
+#define TEST_CHUNK_SIZE CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW_CHUNK_SIZE
+#define TEST_IMAGE_SIZE (TEST_CHUNK_SIZE * 8)
+#define TEST_WINDOW (CONFIG_MCUMGR_GRP_IMG_UPLOAD_WINDOW_CHUNKS + 1)
+
+static struct net_buf *nb;
+static uint8_t test_image[TEST_IMAGE_SIZE];
+static uint8_t test_image_sha[IMG_MGMT_DATA_SHA_LEN];
+static bool rsp_match;
+static struct stats_hdr *flash_sim_stats;
+
+static void cleanup_test(void *p)
+{
+	if (nb != NULL) {
+		net_buf_unref(nb);
+		nb = NULL;
+	}
+}
+
+/* Sends len bytes of the test image at off and returns the response "off" and "win" values */
+static void upload_data(size_t off, size_t len, size_t *rsp_off, uint32_t *rsp_win)
+{
+	uint8_t buffer[ZCBOR_BUFFER_SIZE];
+	uint8_t buffer_out[OUTPUT_BUFFER_SIZE];
+	bool ok;
+	uint16_t buffer_size;
+	zcbor_state_t zse[ZCBOR_HISTORY_ARRAY_SIZE] = { 0 };
+	zcbor_state_t zsd[ZCBOR_HISTORY_ARRAY_SIZE] = { 0 };
+	bool received;
+	struct smp_hdr *smp_header;
+	size_t decoded = 0;
+	int32_t rc = 0;
+
+	struct zcbor_map_decode_key_val output_decode[] = {
+		ZCBOR_MAP_DECODE_KEY_DECODER("off", zcbor_size_decode, rsp_off),
+		ZCBOR_MAP_DECODE_KEY_DECODER("win", zcbor_uint32_decode, rsp_win),
+		ZCBOR_MAP_DECODE_KEY_DECODER("rc", zcbor_int32_decode, &rc),
+		ZCBOR_MAP_DECODE_KEY_DECODER("match", zcbor_bool_decode, &rsp_match),
+	};
+
+	cleanup_test(NULL);
+	*rsp_off = SIZE_MAX;
+	*rsp_win = 0;
+	rsp_match = false;
+
+	memset(buffer, 0, sizeof(buffer));
+	memset(buffer_out, 0, sizeof(buffer_out));
+	buffer_size = 0;
+
+	zcbor_new_encode_state(zse, 2, buffer, ARRAY_SIZE(buffer), 0);
+
+	ok = create_img_mgmt_upload_packet(zse, buffer, buffer_out, &buffer_size, off,
+					   sizeof(test_image), &test_image[off], len,
+					   (IS_ENABLED(CONFIG_IMG_ENABLE_IMAGE_CHECK) ?
+					    test_image_sha : NULL));
+	zassert_true(ok, "Expected packet creation to be successful");
+
+	/* Enable dummy SMP backend and ready for usage */
+	smp_dummy_enable();
+	smp_dummy_clear_state();
+
+	/* Send query command to dummy SMP backend */
+	(void)smp_dummy_tx_pkt(buffer_out, buffer_size);
+	smp_dummy_add_data();
+
+	/* For a short duration to see if response has been received */
+	received = smp_dummy_wait_for_data(SMP_RESPONSE_WAIT_TIME);
+	zassert_true(received, "Expected to receive data but timed out");
+
+	/* Retrieve response buffer */
+	nb = smp_dummy_get_outgoing();
+	smp_dummy_disable();
+
+	/* Check response is as expected */
+	zassert_true(nb->len > sizeof(struct smp_hdr), "SMP response mismatch");
+
+	smp_header = net_buf_pull_mem(nb, sizeof(struct smp_hdr));
+
+	zassert_equal(smp_header->nh_op, MGMT_OP_WRITE_RSP, "SMP header operation mismatch");
+	zassert_equal(smp_header->nh_group, sys_cpu_to_be16(MGMT_GROUP_ID_IMAGE),
+		      "SMP header group mismatch");
+	zassert_equal(smp_header->nh_id, IMG_MGMT_ID_UPLOAD, "SMP header command ID mismatch");
+
+	zcbor_new_decode_state(zsd, 4, nb->data, nb->len, 1, NULL, 0);
+	ok = zcbor_map_decode_bulk(zsd, output_decode, ARRAY_SIZE(output_decode), &decoded) == 0;
+	zassert_true(ok, "Expected decode to be successful");
+	zassert_equal(rc, 0, "Expected upload to be accepted");
+	zassert_not_equal(*rsp_off, SIZE_MAX, "Expected offset in response");
+}
+
+/* Sends the chunk of the test image at off */
+static void upload_chunk(size_t off, size_t *rsp_off, uint32_t *rsp_win)
+{
+	upload_data(off, TEST_CHUNK_SIZE, rsp_off, rsp_win);
+}
+
+static int flash_sim_read_calls_find(struct stats_hdr *hdr, void *arg, const char *name,
+				     uint16_t off)
+{
+	if (!strcmp(name, "flash_read_calls")) {
+		uint32_t **flash_read_stat = (uint32_t **)arg;
+		*flash_read_stat = (uint32_t *)((uint8_t *)hdr + off);
+	}
+
+	return 0;
+}
+
+/* Sends the chunk of the test image at off and returns the number of flash reads it took */
+static uint32_t upload_chunk_reads(size_t off, size_t *rsp_off, uint32_t *rsp_win)
+{
+	uint32_t *flash_read_stat = NULL;
+	uint32_t reads;
+
+	stats_walk(flash_sim_stats, flash_sim_read_calls_find, &flash_read_stat);
+	zassert_not_null(flash_read_stat, "Expected flash read statistic");
+
+	reads = *flash_read_stat;
+	upload_chunk(off, rsp_off, rsp_win);
+
+	return *flash_read_stat - reads;
+}
+
+ZTEST(img_mgmt_upload_window, test_image_check_reads)
+{
+	uint32_t chunk_reads = 0;
+	uint32_t last_reads = 0;
+	size_t off;
+	uint32_t win;
+
+	if (!IS_ENABLED(CONFIG_IMG_ENABLE_IMAGE_CHECK)) {
+		ztest_test_skip();
+	}
+
+	for (size_t i = 0; i < TEST_IMAGE_SIZE; i += TEST_CHUNK_SIZE) {
+		if (i == TEST_IMAGE_SIZE - TEST_CHUNK_SIZE) {
+			last_reads = upload_chunk_reads(i, &off, &win);
+		} else if (i == TEST_IMAGE_SIZE - TEST_CHUNK_SIZE * 2) {
+			chunk_reads = upload_chunk_reads(i, &off, &win);
+		} else {
+			upload_chunk(i, &off, &win);
+		}
+
+		zassert_equal(off, i + TEST_CHUNK_SIZE, "Expected chunk at %zu to be written", i);
+	}
+
+	zassert_true(rsp_match, "Expected uploaded image to match its hash");
+
+	if (IS_ENABLED(CONFIG_MCUMGR_GRP_IMG_UPLOAD_HASH)) {
+		/* Checked against the hash calculated while the image was written */
+		zassert_equal(last_reads, chunk_reads,
+			      "Expected the image not to be read back (%u reads, %u for a chunk)",
+			      last_reads, chunk_reads);
+	} else {
+		zassert_true(last_reads > chunk_reads,
+			     "Expected the image to be read back (%u reads, %u for a chunk)",
+			     last_reads, chunk_reads);
+	}
+}
+
+ZTEST(img_mgmt_upload_window, test_no_upload_in_progress)
+{
+	size_t off;
+	uint32_t win;
+
+	/* Without an upload in progress the data is not held, the client has to start over */
+	upload_chunk(TEST_CHUNK_SIZE * 2, &off, &win);
+	zassert_equal(off, 0, "Expected upload to restart from the beginning");
+}
+
+ZTEST(img_mgmt_upload_window, test_out_of_order)
+{
+	static const struct {
+		size_t off;
+		size_t expected;
+	} steps[] = {
+		{ 0, TEST_CHUNK_SIZE },
+		/* Held */
+		{ TEST_CHUNK_SIZE * 2, TEST_CHUNK_SIZE },
+		{ TEST_CHUNK_SIZE * 3, TEST_CHUNK_SIZE },
+		/* No room left, dropped */
+		{ TEST_CHUNK_SIZE * 4, TEST_CHUNK_SIZE },
+		/* Retransmission of held data */
+		{ TEST_CHUNK_SIZE * 2, TEST_CHUNK_SIZE },
+		/* Fills the gap, the held chunks are written */
+		{ TEST_CHUNK_SIZE, TEST_CHUNK_SIZE * 4 },
+		{ TEST_CHUNK_SIZE * 5, TEST_CHUNK_SIZE * 4 },
+		/* Already written */
+		{ TEST_CHUNK_SIZE * 3, TEST_CHUNK_SIZE * 4 },
+		{ TEST_CHUNK_SIZE * 4, TEST_CHUNK_SIZE * 6 },
+		{ TEST_CHUNK_SIZE * 7, TEST_CHUNK_SIZE * 6 },
+		/* Completes the image through the held last chunk */
+		{ TEST_CHUNK_SIZE * 6, TEST_IMAGE_SIZE },
+	};
+	const struct flash_area *fa;
+	uint8_t read_buffer[TEST_CHUNK_SIZE];
+	size_t off;
+	uint32_t win;
+	int rc;
+
+	for (int i = 0; i < ARRAY_SIZE(steps); i++) {
+		upload_chunk(steps[i].off, &off, &win);
+		zassert_equal(off, steps[i].expected, "Unexpected offset after step %d", i);
+		zassert_equal(win, TEST_WINDOW, "Unexpected window after step %d", i);
+	}
+
+	if (IS_ENABLED(CONFIG_IMG_ENABLE_IMAGE_CHECK)) {
+		zassert_true(rsp_match, "Expected uploaded image to match its hash");
+	}
+
+	rc = flash_area_open(FIXED_PARTITION_ID(slot1_partition), &fa);
+	zassert_ok(rc, "Expected flash area to open");
+
+	for (off = 0; off < sizeof(test_image); off += sizeof(read_buffer)) {
+		rc = flash_area_read(fa, off, read_buffer, sizeof(read_buffer));
+		zassert_ok(rc, "Expected flash area read to succeed");
+		zassert_mem_equal(read_buffer, &test_image[off], sizeof(read_buffer),
+				  "Image data mismatch at %zu", off);
+	}
+
+	flash_area_close(fa);
+}
+
+ZTEST(img_mgmt_upload_window, test_window_large_chunk)
+{
+	size_t off;
+	uint32_t win;
+
+	/* Chunks too large to be held out of order are sent one at a time */
+	upload_data(0, TEST_CHUNK_SIZE * 2, &off, &win);
+	zassert_equal(off, TEST_CHUNK_SIZE * 2, "Expected large chunk to be written");
+	zassert_equal(win, 1, "Expected a single request in flight for large chunks");
+
+	upload_chunk(TEST_CHUNK_SIZE * 2, &off, &win);
+	zassert_equal(off, TEST_CHUNK_SIZE * 3, "Expected chunk to be written");
+	zassert_equal(win, TEST_WINDOW, "Expected the window back for chunks that can be held");
+}
+
+static void *setup_test(void)
+{
+	uint32_t magic = TEST_IMAGE_MAGIC;
+
+	for (int i = 0; i < sizeof(test_image); i++) {
+		test_image[i] = (uint8_t)(i * 7 + i / 256);
+	}
+
+	memcpy(test_image, &magic, sizeof(magic));
+
+	flash_sim_stats = stats_group_find("flash_sim_stats");
+	zassert_not_null(flash_sim_stats, "Expected flash simulator statistics");
+
+#ifdef CONFIG_IMG_ENABLE_IMAGE_CHECK
+	struct tc_sha256_state_struct sha;
+
+	zassert_equal(tc_sha256_init(&sha), TC_CRYPTO_SUCCESS, "Expected hash init to succeed");
+	zassert_equal(tc_sha256_update(&sha, test_image, sizeof(test_image)), TC_CRYPTO_SUCCESS,
+		      "Expected hash update to succeed");
+	zassert_equal(tc_sha256_final(test_image_sha, &sha), TC_CRYPTO_SUCCESS,
+		      "Expected hash final to succeed");
+#endif
+
+	return NULL;
+}
+
+ZTEST_SUITE(img_mgmt_upload_window, NULL, setup_test, NULL, cleanup_test, NULL);
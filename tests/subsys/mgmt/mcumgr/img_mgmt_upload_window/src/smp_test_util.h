@@ -0,0 +1,22 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef H_SMP_TEST_UTIL_
+#define H_SMP_TEST_UTIL_
+
+#include <zephyr/ztest.h>
+#include <zephyr/mgmt/mcumgr/mgmt/mgmt.h>
+#include <zcbor_common.h>
+#include <smp_internal.h>
+
+/* Function for creating an img_mgmt upload command, len and sha (if not NULL) are only sent
+ * when off is 0
+ */
+bool create_img_mgmt_upload_packet(zcbor_state_t *zse, uint8_t *buffer, uint8_t *output_buffer,
+				   uint16_t *buffer_size, size_t off, size_t len,
+				   const uint8_t *data, size_t data_size, const uint8_t *sha);
+
+#endif
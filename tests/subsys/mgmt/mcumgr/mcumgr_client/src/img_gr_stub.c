@@ -24,6 +24,15 @@ static struct mcumgr_image_data image_dummy_info[2];
 static size_t test_offset;
 static uint8_t *image_hash_ptr;
 
+/* Windowed upload server: chunks ahead of test_offset held as offset and length */
+static struct {
+	size_t off;
+	size_t len;
+} window_held[4];
+static uint32_t window_size;
+static int window_drop_request;
+static int window_requests;
+
 #ifdef CONFIG_MCUMGR_GRP_IMG_UPDATABLE_IMAGE_NUMBER
 #define IMG_UPDATABLE_IMAGE_COUNT CONFIG_MCUMGR_GRP_IMG_UPDATABLE_IMAGE_NUMBER
 #else
@@ -38,6 +47,40 @@ void img_upload_stub_init(void)
 	test_offset = 0;
 }
 
+void img_upload_window_stub_init(uint32_t window, int drop_request)
+{
+	test_offset = 0;
+	window_size = MIN(window, ARRAY_SIZE(window_held) + 1);
+	window_drop_request = drop_request;
+	window_requests = 0;
+	memset(window_held, 0, sizeof(window_held));
+}
+
+static void img_upload_window_response(size_t offset)
+{
+	struct net_buf *nb;
+	zcbor_state_t zse[CONFIG_MCUMGR_SMP_CBOR_MAX_DECODING_LEVELS + 2];
+	bool ok;
+
+	nb = smp_response_buf_allocation();
+
+	if (!nb) {
+		return;
+	}
+
+	zcbor_new_encode_state(zse, ARRAY_SIZE(zse), nb->data, net_buf_tailroom(nb), 0);
+
+	ok = zcbor_map_start_encode(zse, 4) && zcbor_tstr_put_lit(zse, "off") &&
+	     zcbor_size_put(zse, offset) && zcbor_tstr_put_lit(zse, "win") &&
+	     zcbor_uint32_put(zse, window_size) && zcbor_map_end_encode(zse, 4);
+
+	if (!ok) {
+		smp_client_response_buf_clean();
+	} else {
+		nb->len = zse->payload - nb->data;
+	}
+}
+
 void img_upload_response(size_t offset, int status)
 {
 	struct net_buf *nb;
@@ -278,6 +321,68 @@ void img_upload_init_verify(struct net_buf *nb)
 	}
 }
 
+void img_upload_window_verify(struct net_buf *nb)
+{
+	zcbor_state_t zsd[CONFIG_MCUMGR_SMP_CBOR_MAX_DECODING_LEVELS + 2];
+	int rc;
+	uint32_t image;
+	struct zcbor_string data;
+	size_t decoded, offset;
+	bool progress;
+	struct zcbor_map_decode_key_val list_res_decode[] = {
+		ZCBOR_MAP_DECODE_KEY_DECODER("image", zcbor_uint32_decode, &image),
+		ZCBOR_MAP_DECODE_KEY_DECODER("data", zcbor_bstr_decode, &data),
+		ZCBOR_MAP_DECODE_KEY_DECODER("off", zcbor_size_decode, &offset)
+		};
+
+	zcbor_new_decode_state(zsd, ARRAY_SIZE(zsd), nb->data + sizeof(struct smp_hdr), nb->len, 1,
+				NULL, 0);
+
+	decoded = 0;
+	data.len = 0;
+	offset = SIZE_MAX;
+	image = UINT32_MAX;
+
+	rc = zcbor_map_decode_bulk(zsd, list_res_decode, ARRAY_SIZE(list_res_decode), &decoded);
+	if (rc || data.len == 0 || offset == SIZE_MAX || image != TEST_IMAGE_NUM) {
+		printf("Corrupted data %d or %d data len\r\n", rc, data.len);
+		img_upload_response(0, MGMT_ERR_EINVAL);
+		return;
+	}
+
+	if (window_requests++ == window_drop_request) {
+		/* Not received, the next chunks are held until it is sent again */
+		printf("Drop chunk at %d\r\n", offset);
+	} else if (offset == test_offset) {
+		test_offset += data.len;
+	} else if (offset > test_offset) {
+		for (int i = 0; i < window_size - 1; i++) {
+			if (window_held[i].len == 0) {
+				window_held[i].off = offset;
+				window_held[i].len = data.len;
+				break;
+			}
+		}
+	}
+
+	/* Write the held chunks that now follow */
+	do {
+		progress = false;
+
+		for (int i = 0; i < ARRAY_SIZE(window_held); i++) {
+			if (window_held[i].len != 0 && window_held[i].off <= test_offset) {
+				test_offset = MAX(test_offset,
+						  window_held[i].off + window_held[i].len);
+				window_held[i].len = 0;
+				progress = true;
+			}
+		}
+	} while (progress);
+
+	printf("Windowed upload offset %d\r\n", test_offset);
+	img_upload_window_response(test_offset);
+}
+
 void img_gr_stub_data_init(uint8_t *hash_ptr)
 {
 	image_hash_ptr = hash_ptr;
@@ -20,6 +20,8 @@ extern "C" {
 
 void img_upload_stub_init(void);
 void img_upload_response(size_t offset, int status);
+void img_upload_window_stub_init(uint32_t window, int drop_request);
+void img_upload_window_verify(struct net_buf *nb);
 void img_fail_response(int status);
 void img_read_response(int count);
 void img_erase_response(int status);
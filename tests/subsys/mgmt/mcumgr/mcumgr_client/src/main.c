@@ -108,6 +108,57 @@ ZTEST(mcumgr_client, test_img_upload)
 		      response.image_upload_offset);
 }
 
+/* Uploads the test image in two calls, with responses delivered out of order */
+static void img_upload_window_run(void)
+{
+	int rc;
+	struct mcumgr_image_upload response;
+
+	smp_client_send_status_stub(MGMT_ERR_EOK);
+	smp_client_response_buf_clean();
+	smp_stub_set_rx_data_verify(img_upload_window_verify);
+	smp_stub_reorder_responses(true);
+
+	rc = img_mgmt_client_upload_init(&img_client, TEST_IMAGE_SIZE, TEST_IMAGE_NUM, image_hash);
+	zassert_equal(MGMT_ERR_EOK, rc, "Expected to receive %d response %d", MGMT_ERR_EOK, rc);
+
+	rc = img_mgmt_client_upload(&img_client, image_dummy, 1024, &response);
+	zassert_equal(MGMT_ERR_EOK, rc, "Expected to receive %d response %d", MGMT_ERR_EOK, rc);
+	zassert_equal(1024, response.image_upload_offset,
+		      "Expected to receive offset %d response %d", 1024,
+		      response.image_upload_offset);
+
+	rc = img_mgmt_client_upload(&img_client, image_dummy, 1024, &response);
+	zassert_equal(MGMT_ERR_EOK, rc, "Expected to receive %d response %d", MGMT_ERR_EOK, rc);
+	zassert_equal(TEST_IMAGE_SIZE, response.image_upload_offset,
+		      "Expected to receive offset %d response %d", TEST_IMAGE_SIZE,
+		      response.image_upload_offset);
+
+	/* Several requests were in flight at once */
+	zassert_true(smp_stub_held_max() > 1, "Upload requests sent one at a time");
+}
+
+ZTEST(mcumgr_client, test_img_upload_window)
+{
+	img_upload_window_stub_init(CONFIG_MCUMGR_GRP_IMG_CLIENT_UPLOAD_WINDOW, -1);
+	img_upload_window_run();
+}
+
+ZTEST(mcumgr_client, test_img_upload_window_drop_chunk)
+{
+	/* The chunks after the dropped one are held, the client sends it again */
+	img_upload_window_stub_init(CONFIG_MCUMGR_GRP_IMG_CLIENT_UPLOAD_WINDOW, 2);
+	img_upload_window_run();
+}
+
+ZTEST(mcumgr_client, test_img_upload_window_drop_response)
+{
+	/* The SMP client sends the request again once its retry time is over */
+	img_upload_window_stub_init(CONFIG_MCUMGR_GRP_IMG_CLIENT_UPLOAD_WINDOW, -1);
+	smp_stub_drop_response(2);
+	img_upload_window_run();
+}
+
 ZTEST(mcumgr_client, test_img_erase)
 {
 	int rc;
@@ -250,6 +301,8 @@ static void cleanup_test(void *p)
 {
 	smp_client_response_buf_clean();
 	smp_stub_set_rx_data_verify(NULL);
+	smp_stub_reorder_responses(false);
+	smp_stub_drop_response(-1);
 }
 
 /* Main test set */
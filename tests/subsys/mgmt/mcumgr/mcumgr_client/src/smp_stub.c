@@ -24,6 +24,22 @@ static struct smp_client_transport_entry smp_client_transport;
 static struct k_work_q smp_work_queue;
 static struct k_work stub_work;
 
+/* Responses held back to be delivered together, in reverse order */
+#define HELD_RESPONSES_MAX 8
+#define HELD_RESPONSES_DELAY K_MSEC(20)
+
+static struct {
+	struct net_buf *nb;
+	struct smp_hdr hdr;
+} held_responses[HELD_RESPONSES_MAX];
+static int held_count;
+static int held_max;
+static bool reorder_responses;
+static int drop_response_index = -1;
+static int tx_count;
+static struct k_spinlock held_lock;
+static struct k_work_delayable held_work;
+
 static const struct k_work_queue_config smp_work_queue_config = {
 	.name = "mcumgr smp"
 };
@@ -38,6 +54,23 @@ void smp_client_send_status_stub(int status)
 	send_client_failure = status;
 }
 
+void smp_stub_reorder_responses(bool reorder)
+{
+	reorder_responses = reorder;
+	held_max = 0;
+}
+
+void smp_stub_drop_response(int index)
+{
+	drop_response_index = index;
+	tx_count = 0;
+}
+
+int smp_stub_held_max(void)
+{
+	return held_max;
+}
+
 struct net_buf *smp_response_buf_allocation(void)
 {
 	smp_client_response_buf_clean();
@@ -88,6 +121,28 @@ static int smp_uart_tx_pkt(struct net_buf *nb)
 	/* Free tx buf */
 	net_buf_unref(nb);
 
+	if (response_buf && tx_count++ == drop_response_index) {
+		/* Lost on the way, the client sends the request again */
+		smp_client_response_buf_clean();
+	}
+
+	if (response_buf && reorder_responses) {
+		k_spinlock_key_t key = k_spin_lock(&held_lock);
+
+		if (held_count < HELD_RESPONSES_MAX) {
+			held_responses[held_count].nb = response_buf;
+			held_responses[held_count].hdr = res_hdr;
+			held_count++;
+			held_max = MAX(held_max, held_count);
+			response_buf = NULL;
+		}
+
+		k_spin_unlock(&held_lock, key);
+
+		/* Wait for the requests sent right after this one */
+		k_work_reschedule_for_queue(&smp_work_queue, &held_work, HELD_RESPONSES_DELAY);
+	}
+
 	if (response_buf) {
 		k_work_submit_to_queue(&smp_work_queue, &stub_work);
 	}
@@ -102,6 +157,29 @@ static void smp_client_handle_reqs(struct k_work *work)
 	}
 }
 
+static void smp_client_handle_held_reqs(struct k_work *work)
+{
+	struct net_buf *nb;
+	struct smp_hdr hdr;
+	k_spinlock_key_t key;
+
+	key = k_spin_lock(&held_lock);
+
+	while (held_count > 0) {
+		held_count--;
+		nb = held_responses[held_count].nb;
+		hdr = held_responses[held_count].hdr;
+		k_spin_unlock(&held_lock, key);
+
+		smp_client_single_response(nb, &hdr);
+		smp_client_buf_free(nb);
+
+		key = k_spin_lock(&held_lock);
+	}
+
+	k_spin_unlock(&held_lock, key);
+}
+
 void stub_smp_client_transport_register(void)
 {
 
@@ -121,4 +199,5 @@ void stub_smp_client_transport_register(void)
 			   CONFIG_MCUMGR_TRANSPORT_WORKQUEUE_THREAD_PRIO, &smp_work_queue_config);
 
 	k_work_init(&stub_work, smp_client_handle_reqs);
+	k_work_init_delayable(&held_work, smp_client_handle_held_reqs);
 }
@@ -19,6 +19,12 @@ typedef void (*mcmgr_client_data_check_fn)(struct net_buf *nb);
 
 void smp_stub_set_rx_data_verify(mcmgr_client_data_check_fn cb);
 void smp_client_send_status_stub(int status);
+/* Hold the responses and deliver them together, last first */
+void smp_stub_reorder_responses(bool reorder);
+/* Drop the response to the request of the given index counted from now, -1 for none */
+void smp_stub_drop_response(int index);
+/* Largest number of responses held at once since reordering was enabled */
+int smp_stub_held_max(void);
 void smp_client_response_buf_clean(void);
 struct net_buf *smp_response_buf_allocation(void);
 void stub_smp_client_transport_register(void);
@@ -0,0 +1,28 @@
+/* SPDX-License-Identifier: Apache-2.0 */
+/* Copyright (c) 2024 The Zephyr Project Contributors */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <errno.h>
+#include <string.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/fs/kvs.h>
+
+ZTEST(settings_functional, test_setting_storage_get)
+{
+	int rc;
+	void *storage;
+	uint16_t data = 0x5a5a;
+	ssize_t kvs_rc;
+
+	rc = settings_storage_get(&storage);
+	zassert_equal(0, rc, "Can't fetch storage reference (err=%d)", rc);
+
+	zassert_not_null(storage, "Null reference.");
+
+	kvs_rc = kvs_write((struct kvs_fs *)storage, "test", strlen("test"), &data,
+			   sizeof(data));
+
+	zassert_true(kvs_rc >= 0, "Can't write kvs entry (err=%d).", (int)kvs_rc);
+}
+ZTEST_SUITE(settings_functional, NULL, NULL, NULL, NULL, NULL);
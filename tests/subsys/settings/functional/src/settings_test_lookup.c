@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2024 The Zephyr Project Contributors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <zephyr/ztest.h>
+#include <zephyr/settings/settings.h>
+
+static int lookup_set(const char *name, size_t len, settings_read_cb read_cb, void *cb_arg)
+{
+	return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(lookup_root, "lk", NULL, lookup_set, NULL, NULL);
+SETTINGS_STATIC_HANDLER_DEFINE(lookup_a, "lk/a", NULL, lookup_set, NULL, NULL);
+SETTINGS_STATIC_HANDLER_DEFINE(lookup_a_b, "lk/a/b", NULL, lookup_set, NULL, NULL);
+SETTINGS_STATIC_HANDLER_DEFINE(lookup_ab, "lk/ab", NULL, lookup_set, NULL, NULL);
+SETTINGS_STATIC_HANDLER_DEFINE(lookup_c_d, "lk/c/d", NULL, lookup_set, NULL, NULL);
+
+static void check_lookup(const char *name, const struct settings_handler_static *expected,
+			 const char *expected_next)
+{
+	struct settings_handler_static *ch;
+	const char *next;
+
+	ch = settings_parse_and_lookup(name, &next);
+
+	zassert_equal_ptr(ch, expected, "wrong handler for %s", name);
+
+	if (expected_next == NULL) {
+		zassert_is_null(next, "unexpected key for %s", name);
+	} else {
+		zassert_not_null(next, "no key for %s", name);
+		zassert_true(strcmp(next, expected_next) == 0, "wrong key for %s", name);
+	}
+}
+
+/* The handler with the longest name matching whole name components is used */
+ZTEST(settings_functional, test_static_handler_lookup)
+{
+	int rc;
+
+	rc = settings_subsys_init();
+	zassert_true(rc == 0, "subsys init failed");
+
+	check_lookup("lk", &settings_handler_lookup_root, NULL);
+	check_lookup("lk/x", &settings_handler_lookup_root, "x");
+	check_lookup("lk/a", &settings_handler_lookup_a, NULL);
+	check_lookup("lk/a/x/y", &settings_handler_lookup_a, "x/y");
+	check_lookup("lk/a/b", &settings_handler_lookup_a_b, NULL);
+	check_lookup("lk/a/b/x", &settings_handler_lookup_a_b, "x");
+	check_lookup("lk/ab/x", &settings_handler_lookup_ab, "x");
+	check_lookup("lk/abc", &settings_handler_lookup_root, "abc");
+	check_lookup("lk/c", &settings_handler_lookup_root, "c");
+	check_lookup("lk/c/d/x", &settings_handler_lookup_c_d, "x");
+	check_lookup("lkx/a", NULL, NULL);
+	check_lookup("l", NULL, NULL);
+
+	/* Names read from storage can end with '=' */
+	check_lookup("lk/a=", &settings_handler_lookup_a, NULL);
+}
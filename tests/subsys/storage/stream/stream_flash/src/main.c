@@ -463,6 +463,209 @@ ZTEST(lib_stream_flash, test_stream_flash_buffered_write_whole_page)
 }
 #endif
 
+#ifdef CONFIG_STREAM_FLASH_ASYNC
+#define ASYNC_BUF_COUNT 3
+
+static uint8_t async_bufs[ASYNC_BUF_COUNT * BUF_LEN];
+static size_t async_cb_offset;
+static size_t async_cb_count;
+static int async_cb_result;
+
+static void stream_flash_async_callback(struct stream_flash_ctx *cb_ctx, size_t offset,
+					size_t len, int result)
+{
+	/* Record the next expected offset, or 0 if the buffers came out of order */
+	if (result == 0) {
+		async_cb_offset = (offset == async_cb_offset) ? offset + len : 0;
+	}
+	async_cb_result = result;
+	async_cb_count++;
+}
+
+static void init_async_target(void)
+{
+	int rc;
+
+	init_target();
+
+	async_cb_offset = FLASH_BASE;
+	async_cb_count = 0;
+	async_cb_result = 0;
+
+	rc = stream_flash_async_enable(&ctx, async_bufs, ASYNC_BUF_COUNT,
+				       stream_flash_async_callback);
+	zassert_equal(rc, 0, "expected success");
+}
+
+ZTEST(lib_stream_flash, test_stream_flash_async_enable)
+{
+	int rc;
+
+	init_target();
+
+	rc = stream_flash_async_enable(NULL, async_bufs, ASYNC_BUF_COUNT, NULL);
+	zassert_equal(rc, -EFAULT, "should fail as ctx is NULL");
+
+	rc = stream_flash_async_enable(&ctx, NULL, ASYNC_BUF_COUNT, NULL);
+	zassert_equal(rc, -EFAULT, "should fail as buffers are NULL");
+
+	rc = stream_flash_async_enable(&ctx, async_bufs, 1, NULL);
+	zassert_equal(rc, -EINVAL, "should fail with a single buffer");
+
+	rc = stream_flash_buffered_write(&ctx, write_buf, 1, false);
+	zassert_equal(rc, 0, "expected success");
+
+	rc = stream_flash_async_enable(&ctx, async_bufs, ASYNC_BUF_COUNT, NULL);
+	zassert_equal(rc, -EBUSY, "should fail as data is buffered");
+}
+
+ZTEST(lib_stream_flash, test_stream_flash_async_buffered_write)
+{
+	int rc;
+	size_t chunk = BUF_LEN / 3;
+	size_t total = page_size * 2 + BUF_LEN / 2;
+
+	init_async_target();
+
+	/* Write in chunks not aligned to the buffers */
+	for (size_t off = 0; off < total; off += chunk) {
+		rc = stream_flash_buffered_write(&ctx, write_buf, MIN(chunk, total - off),
+						 false);
+		zassert_equal(rc, 0, "expected success");
+		zassert_true(stream_flash_bytes_written(&ctx) <= off + chunk,
+			     "bytes written before being passed");
+	}
+
+	rc = stream_flash_buffered_write(&ctx, NULL, 0, true);
+	zassert_equal(rc, 0, "expected success");
+
+	zassert_equal(stream_flash_bytes_written(&ctx), total, "expected all bytes written");
+	zassert_equal(async_cb_offset, FLASH_BASE + total, "buffers written out of order");
+	zassert_equal(async_cb_count, DIV_ROUND_UP(total, BUF_LEN), "unexpected callbacks");
+	VERIFY_WRITTEN(0, total);
+}
+
+ZTEST(lib_stream_flash, test_stream_flash_async_verify_callback)
+{
+	int rc;
+
+	init_async_target();
+
+	/* The verification callback gets each buffer in turn */
+	cb_buf = async_bufs;
+	cb_len = BUF_LEN;
+	cb_offset = FLASH_BASE;
+
+	rc = stream_flash_buffered_write(&ctx, write_buf, BUF_LEN, true);
+	zassert_equal(rc, 0, "expected success");
+
+	cb_buf = async_bufs + BUF_LEN;
+	cb_len = BUF_LEN / 2;
+	cb_offset = FLASH_BASE + BUF_LEN;
+
+	rc = stream_flash_buffered_write(&ctx, write_buf, BUF_LEN / 2, true);
+	zassert_equal(rc, 0, "expected success");
+	VERIFY_WRITTEN(0, BUF_LEN + BUF_LEN / 2);
+
+	/* A failing callback stops the writes */
+	cb_buf = NULL;
+	cb_ret = -EFAULT;
+
+	rc = stream_flash_buffered_write(&ctx, write_buf, BUF_LEN, false);
+	zassert_true(rc == 0 || rc == -EFAULT, "unexpected error %d", rc);
+
+	rc = stream_flash_async_wait(&ctx);
+	zassert_equal(rc, -EFAULT, "expected failure from callback");
+	zassert_equal(async_cb_result, -EFAULT, "expected failure reported");
+	zassert_equal(stream_flash_bytes_written(&ctx), BUF_LEN + BUF_LEN / 2,
+		      "expected bytes_written not modified");
+
+	rc = stream_flash_buffered_write(&ctx, write_buf, 1, true);
+	zassert_equal(rc, -EFAULT, "expected failure to be kept");
+}
+
+ZTEST(lib_stream_flash, test_stream_flash_async_write_error)
+{
+	int rc;
+	struct device fake_dev = *fdev;
+	struct flash_driver_api fake_api = *(struct flash_driver_api *)fdev->api;
+
+	init_async_target();
+
+	fake_api.write = bad_write;
+	fake_dev.api = &fake_api;
+	ctx.fdev = &fake_dev;
+
+	rc = stream_flash_buffered_write(&ctx, write_buf, BUF_LEN * 2, true);
+	zassert_equal(rc, -EINVAL, "expected failure from flash_write");
+	zassert_equal(async_cb_result, -EINVAL, "expected failure reported");
+	zassert_equal(async_cb_count, 1, "expected the writes to stop");
+	zassert_equal(stream_flash_bytes_written(&ctx), 0, "expected nothing written");
+}
+
+#ifdef CONFIG_STREAM_FLASH_ERASE
+ZTEST(lib_stream_flash, test_stream_flash_async_erase_ahead)
+{
+	int rc;
+
+	init_async_target();
+
+	/* Make the second page dirty */
+	rc = flash_write(fdev, FLASH_BASE + page_size, write_buf, BUF_LEN);
+	zassert_equal(rc, 0, "expected success");
+
+	/* Filling the first page erases the second one ahead of time */
+	rc = stream_flash_buffered_write(&ctx, write_buf, page_size, false);
+	zassert_equal(rc, 0, "expected success");
+
+	rc = stream_flash_async_wait(&ctx);
+	zassert_equal(rc, 0, "expected success");
+	VERIFY_WRITTEN(0, page_size);
+	VERIFY_ERASED(page_size, page_size);
+
+	/* The page following a flushed stream is not erased */
+	init_async_target();
+
+	rc = flash_write(fdev, FLASH_BASE + page_size, write_buf, BUF_LEN);
+	zassert_equal(rc, 0, "expected success");
+
+	rc = stream_flash_buffered_write(&ctx, write_buf, page_size, true);
+	zassert_equal(rc, 0, "expected success");
+	VERIFY_WRITTEN(0, page_size + BUF_LEN);
+}
+#else
+ZTEST(lib_stream_flash, test_stream_flash_async_erase_ahead)
+{
+	ztest_test_skip();
+}
+#endif /* CONFIG_STREAM_FLASH_ERASE */
+#else
+ZTEST(lib_stream_flash, test_stream_flash_async_enable)
+{
+	ztest_test_skip();
+}
+
+ZTEST(lib_stream_flash, test_stream_flash_async_buffered_write)
+{
+	ztest_test_skip();
+}
+
+ZTEST(lib_stream_flash, test_stream_flash_async_verify_callback)
+{
+	ztest_test_skip();
+}
+
+ZTEST(lib_stream_flash, test_stream_flash_async_write_error)
+{
+	ztest_test_skip();
+}
+
+ZTEST(lib_stream_flash, test_stream_flash_async_erase_ahead)
+{
+	ztest_test_skip();
+}
+#endif /* CONFIG_STREAM_FLASH_ASYNC */
+
 static size_t write_and_save_progress(size_t bytes, const char *save_key)
 {
 	int rc;